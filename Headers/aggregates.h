@@ -0,0 +1,158 @@
+/**
+ * @file aggregates.h
+ * @brief Header file for the materialized route and day aggregates (flights, seats sold, load factor).
+ *
+ * Dashboards read per-route and per-day totals. Instead of scanning every
+ * flight for each read, the totals are kept in two hash tables, one keyed by
+ * route and one by departure day, and updated by delta. Adding or deleting a
+ * flight adds or subtracts its row, and booking or cancelling a seat moves
+ * one seat between sold and free. A read is one hash lookup.
+ *
+ * Seats sold are the booked seats of each flight's seat map (a popcount, as
+ * in the reports of reports.h), and a flight's capacity is its booked plus
+ * its free seats, so flights with fewer than MAX_PASSENGERS_PER_FLIGHT
+ * seats are not counted as partly sold. Changes made without the hooks (a reload,
+ * a table filled directly) and seat changes in the shared inventory make
+ * the views stale, and the next read recomputes them in O(n).
+ * verifyAggregates recomputes them from scratch and reports every row that
+ * drifted. getBusiestRoutes picks the K routes with the most seats sold with
+ * a bounded heap over the route rows, without sorting them.
+ */
+
+#ifndef AGGREGATES_H
+#define AGGREGATES_H
+
+#include "common.h" // For Flight and DateTime
+
+/**
+ * @struct AggregateView
+ * @brief Totals over a group of flights.
+ */
+typedef struct {
+    int flights;            /**< Number of flights. */
+    long long seatsSold;    /**< Seats booked on them. */
+    long long seatCapacity; /**< Seats on them (booked plus free seats of each flight). */
+} AggregateView;
+
+/**
+ * @struct RouteAggregate
+ * @brief The totals of one route, as returned by getBusiestRoutes.
+ */
+typedef struct {
+    char origin[MAX_NAME_LEN];      /**< Origin. */
+    char destination[MAX_NAME_LEN]; /**< Destination. */
+    AggregateView view;             /**< Totals. */
+} RouteAggregate;
+
+/**
+ * @brief Returns the load factor of a group of flights.
+ *
+ * @param view The totals.
+ * @return seatsSold / seatCapacity, or 0 if the group has no seats.
+ */
+double aggregateLoadFactor(const AggregateView *view);
+
+/**
+ * @brief Reads the totals of one route.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The origin.
+ * @param destination The destination.
+ * @param out Receives the totals (all zero if no flight has that route).
+ * @return 1 on success, 0 if the views could not be rebuilt (memory allocation failed).
+ */
+int getRouteAggregate(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                      AggregateView *out);
+
+/**
+ * @brief Reads the totals of one departure day.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param day The day (the time of day is ignored).
+ * @param out Receives the totals (all zero if no flight departs that day).
+ * @return 1 on success, 0 if the views could not be rebuilt (memory allocation failed).
+ */
+int getDayAggregate(const Flight *flights, int flightCount, const DateTime *day, AggregateView *out);
+
+/**
+ * @brief Reads the totals over every flight.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param out Receives the totals.
+ * @return 1 on success, 0 if the views could not be rebuilt (memory allocation failed).
+ */
+int getTotalAggregate(const Flight *flights, int flightCount, AggregateView *out);
+
+/**
+ * @brief Finds the routes with the most seats sold.
+ *
+ * Ties go to the route with more flights, then by origin and destination.
+ * Routes without flights are skipped.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param out Receives up to k routes, busiest first (capacity k).
+ * @param k The number of routes wanted.
+ * @return The number of routes written, or -1 if the views could not be rebuilt (memory allocation failed).
+ */
+int getBusiestRoutes(const Flight *flights, int flightCount, RouteAggregate *out, int k);
+
+/**
+ * @brief Recomputes the views from the flight table and compares them with the maintained ones.
+ *
+ * Every route or day whose maintained totals differ is printed. The
+ * maintained views are then replaced by the recomputed ones.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return The number of rows (routes, days and the total) that drifted, or -1 if memory allocation failed.
+ */
+int verifyAggregates(const Flight *flights, int flightCount);
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights, including the new one.
+ * @param flight The new flight.
+ */
+void aggregateFlightInserted(const Flight *flights, int flightCount, const Flight *flight);
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights once it is removed.
+ * @param flight The flight being removed (still in the array).
+ */
+void aggregateFlightRemoved(const Flight *flights, int flightCount, const Flight *flight);
+
+/**
+ * @brief Hook: the flights were reordered. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+void aggregateFlightsReordered(const Flight *flights, int flightCount);
+
+/**
+ * @brief Hook: one seat of a flight was booked or cancelled.
+ *
+ * Called by claimFlightSeat and releaseFlightSeat after they increment
+ * flightSeatVersion.
+ *
+ * @param flight The flight (a flight outside the table, e.g. in the shared segment, makes the views stale).
+ * @param sold +1 for a booking, -1 for a cancellation.
+ * @param seatVersion The value flightSeatVersion was incremented to.
+ */
+void aggregateSeatsChanged(const Flight *flight, int sold, unsigned long seatVersion);
+
+/**
+ * @brief Frees the views.
+ */
+void cleanupAggregates();
+
+#endif // AGGREGATES_H
@@ -0,0 +1,77 @@
+/**
+ * @file availability.h
+ * @brief Header file for the seat availability index ("flights with at least N free seats").
+ *
+ * Flights are grouped by route, and within a route into buckets of
+ * AVAIL_BUCKET_WIDTH seat counts (0-7 free seats, 8-15, ...). A global group
+ * holds every flight the same way. "At least N seats on route X" reads the
+ * buckets above N's bucket whole and filters only N's own bucket, so it never
+ * touches flights that are too full or on other routes. Each bucket keeps a
+ * count, so the total number of bookable flights is known without listing
+ * them. Results come back as the top K by free seats or by departure.
+ *
+ * claimFlightSeat and releaseFlightSeat move a flight between buckets as
+ * seats are booked and cancelled. Anything else that changes seat counts in
+ * bulk (a sync from the shared inventory, a reload, added or deleted flights)
+ * makes the index stale, and the next lookup rebuilds it in O(n).
+ */
+
+#ifndef AVAILABILITY_H
+#define AVAILABILITY_H
+
+#include "common.h" // For Flight and MAX_PASSENGERS_PER_FLIGHT
+
+/**
+ * @def AVAIL_BUCKET_WIDTH
+ * @brief Free-seat counts that share one bucket.
+ */
+#define AVAIL_BUCKET_WIDTH 8
+
+/**
+ * @def AVAIL_BUCKET_COUNT
+ * @brief Buckets per route (the last one holds MAX_PASSENGERS_PER_FLIGHT).
+ */
+#define AVAIL_BUCKET_COUNT (MAX_PASSENGERS_PER_FLIGHT / AVAIL_BUCKET_WIDTH + 1)
+
+/**
+ * @enum AvailOrder
+ * @brief Order of the flights returned by findAvailableFlights.
+ */
+typedef enum {
+    AVAIL_BY_SEATS,     /**< Most free seats first, then earliest departure. */
+    AVAIL_BY_DEPARTURE  /**< Earliest departure first, then flight ID. */
+} AvailOrder;
+
+/**
+ * @brief Finds the flights with at least a number of free seats, on one route or on all.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The origin, or NULL for every route.
+ * @param destination The destination (ignored if origin is NULL).
+ * @param minSeats The free seats needed (e.g., the group size).
+ * @param order The order of the returned flights.
+ * @param indexes Receives the positions of the first k flights in that order (may be NULL to only count).
+ * @param k The capacity of indexes.
+ * @return The total number of flights with enough seats (may exceed k), or -1 if memory allocation failed.
+ */
+int findAvailableFlights(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                         int minSeats, AvailOrder order, int *indexes, int k);
+
+/**
+ * @brief Hook: a flight's free-seat count changed by one booking or cancellation.
+ *
+ * Called by claimFlightSeat and releaseFlightSeat after they increment
+ * flightSeatVersion.
+ *
+ * @param flight The flight (in the local table or the shared segment).
+ * @param seatVersion The value flightSeatVersion was incremented to.
+ */
+void availabilitySeatsChanged(const Flight *flight, unsigned long seatVersion);
+
+/**
+ * @brief Frees the availability index.
+ */
+void cleanupAvailability();
+
+#endif // AVAILABILITY_H
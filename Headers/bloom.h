@@ -0,0 +1,107 @@
+/**
+ * @file bloom.h
+ * @brief Header file for the Bloom filters in front of the passport and ticket ID lookups.
+ *
+ * Many lookups are for passports or ticket IDs that do not exist (typos,
+ * stale references), and findPassengerIndex and findTicketIndex would scan
+ * the whole table to find that out. A blocked Bloom filter answers most of
+ * them first: every key sets one bit in each of the 8 words of one 64-byte
+ * block, so a lookup reads a single cache line, and a key whose bits are not
+ * all set is certainly absent.
+ *
+ * The hooks keep each filter in step with its table: an added key is set, and
+ * a removed one stays set (it only makes a false positive) until enough have
+ * piled up to rebuild the filter. A filter is trusted only while its table's
+ * version and record count are the ones it was last synced with; any other
+ * change (the table filled or trimmed directly) makes the lookups scan until
+ * the next hook or load rebuilds it. Rebuilds of large tables hash the keys
+ * on one thread per online CPU.
+ */
+
+#ifndef BLOOM_H
+#define BLOOM_H
+
+/**
+ * @def BLOOM_BITS_PER_KEY
+ * @brief Filter bits per key (about 0.2% false positives when the filter is full).
+ */
+#define BLOOM_BITS_PER_KEY 16
+
+/**
+ * @def BLOOM_MIN_KEYS
+ * @brief Keys a filter is sized for at least.
+ */
+#define BLOOM_MIN_KEYS 1024
+
+/**
+ * @def BLOOM_PARALLEL_MIN
+ * @brief Keys below which a rebuild runs on the calling thread.
+ */
+#define BLOOM_PARALLEL_MIN 65536
+
+/**
+ * @def BLOOM_MAX_THREADS
+ * @brief Maximum threads hashing keys during a rebuild.
+ */
+#define BLOOM_MAX_THREADS 64
+
+/**
+ * @brief Reports whether a passenger with a passport may exist.
+ *
+ * @param passport The passport number.
+ * @return 0 if there is certainly no such passenger, 1 if there may be (or the filter is not in sync).
+ */
+int passportMayExist(const char *passport);
+
+/**
+ * @brief Reports whether a ticket may exist.
+ *
+ * @param ticketID The ticket ID.
+ * @return 0 if there is certainly no such ticket, 1 if there may be (or the filter is not in sync).
+ */
+int ticketMayExist(int ticketID);
+
+/**
+ * @brief Hook: a passenger was appended. Call before incrementing passengerTableVersion.
+ *
+ * @param passport The passport of the new passenger.
+ */
+void bloomPassengerAdded(const char *passport);
+
+/**
+ * @brief Hook: a passenger was removed. Call before incrementing passengerTableVersion.
+ */
+void bloomPassengerRemoved();
+
+/**
+ * @brief Hook: a ticket was appended. Call before incrementing ticketTableVersion.
+ *
+ * @param ticketID The ID of the new ticket.
+ */
+void bloomTicketAdded(int ticketID);
+
+/**
+ * @brief Hook: a ticket was removed. Call before incrementing ticketTableVersion.
+ */
+void bloomTicketRemoved();
+
+/**
+ * @brief Rebuilds the passport filter from globalPassengers (e.g., after a load).
+ *
+ * @return 1 on success, 0 if memory allocation failed (lookups then scan).
+ */
+int rebuildPassportFilter();
+
+/**
+ * @brief Rebuilds the ticket filter from globalTickets (e.g., after a load).
+ *
+ * @return 1 on success, 0 if memory allocation failed (lookups then scan).
+ */
+int rebuildTicketFilter();
+
+/**
+ * @brief Frees both filters.
+ */
+void cleanupBloomFilters();
+
+#endif // BLOOM_H
@@ -14,8 +14,12 @@
 /**
  * @def MAX_FLIGHTS
  * @brief Maximum number of flights the system can manage.
+ *
+ * May be overridden at compile time (e.g., -DMAX_FLIGHTS=10000000 for the benchmark build).
  */
+#ifndef MAX_FLIGHTS
 #define MAX_FLIGHTS 100
+#endif
 
 /**
  * @def MAX_NAME_LEN
@@ -29,6 +33,30 @@
  */
 #define MAX_PASSENGERS_PER_FLIGHT 250 // Example: Max passengers per flight for bitfield seats
 
+/**
+ * @def SEAT_MAP_BYTES
+ * @brief Number of bytes in a Flight seat map (one bit per seat).
+ */
+#define SEAT_MAP_BYTES ((MAX_PASSENGERS_PER_FLIGHT + 7) / 8)
+
+/**
+ * @def SEAT_BYTE(seatNo)
+ * @brief Index of the seat map byte holding the bit for a 1-based seat number.
+ */
+#define SEAT_BYTE(seatNo) (((seatNo) - 1) / 8)
+
+/**
+ * @def SEAT_MASK(seatNo)
+ * @brief Bit mask selecting a 1-based seat number within its seat map byte.
+ */
+#define SEAT_MASK(seatNo) ((unsigned char)(1u << (((seatNo) - 1) % 8)))
+
+/**
+ * @def SEAT_IS_BOOKED(seatMap, seatNo)
+ * @brief Evaluates to non-zero if the given 1-based seat is marked booked in the seat map.
+ */
+#define SEAT_IS_BOOKED(seatMap, seatNo) ((seatMap)[SEAT_BYTE(seatNo)] & SEAT_MASK(seatNo))
+
 /**
  * @enum FlightStatus
  * @brief Represents the current status of a flight.
@@ -72,7 +100,7 @@ typedef struct {
      * Each bit corresponds to a seat (0 = free, 1 = booked).
      * Size calculated to hold MAX_PASSENGERS_PER_FLIGHT bits.
      */
-    unsigned char seatMap[(MAX_PASSENGERS_PER_FLIGHT + 7) / 8];
+    unsigned char seatMap[SEAT_MAP_BYTES];
 } Flight;
 
 /**
@@ -13,6 +13,101 @@
 
 #include "common.h" // Ensure common.h is included here for Flight structure and macros
 
+/**
+ * @var flightTableVersion
+ * @brief Incremented whenever flights are added, removed, reordered or reloaded (indexes compare it to detect stale state).
+ */
+extern unsigned long flightTableVersion;
+
+/**
+ * @var flightStatusVersion
+ * @brief Incremented whenever a flight's status changes in place (setFlightStatus).
+ */
+extern unsigned long flightStatusVersion;
+
+/**
+ * @brief Finds the position of a flight in the array by its ID.
+ *
+ * Unlike searchFlight, this function never prints, so it can be used by
+ * benchmarks and batch tools.
+ *
+ * @param flights A pointer to the array of Flight structures to search within.
+ * @param flightCount The current number of flights in the array.
+ * @param flightID The ID of the flight to search for.
+ * @return The index of the flight, or -1 if not found.
+ */
+int findFlightIndex(const Flight *flights, int flightCount, int flightID);
+
+/**
+ * @brief Collects the positions of all flights on a route, in array order.
+ *
+ * @param flights A pointer to the array of Flight structures to search within.
+ * @param flightCount The current number of flights in the array.
+ * @param origin The origin to match (exact, case-sensitive).
+ * @param destination The destination to match (exact, case-sensitive).
+ * @param indexes Receives up to maxIndexes positions (may be NULL to only count).
+ * @param maxIndexes The capacity of indexes.
+ * @return The total number of matching flights (may exceed maxIndexes).
+ */
+int findFlightsByRoute(const Flight *flights, int flightCount, const char *origin,
+                       const char *destination, int *indexes, int maxIndexes);
+
+/**
+ * @brief Binds a check every flight must pass before insertFlight accepts it.
+ *
+ * Recurring schedules (schedule.h) bind scheduleAllowsFlight here, so a
+ * flight cannot take an ID reserved for one of their dated flights.
+ *
+ * @param check Returns 1 if a flight may be inserted, 0 if its ID is reserved; NULL accepts every flight.
+ */
+void bindFlightIDCheck(int (*check)(const Flight *flight));
+
+/**
+ * @brief Reports whether the bound ID check (see bindFlightIDCheck) accepts a flight.
+ *
+ * @param flight A pointer to the flight.
+ * @return 1 if it may be inserted (or no check is bound), 0 if its ID is reserved.
+ */
+int flightIDAllowed(const Flight *flight);
+
+/**
+ * @brief Appends a fully populated flight to the array without prompting.
+ *
+ * This is the non-interactive core of addFlight, including the duplicate ID check.
+ *
+ * @param flights A pointer to the array of Flight structures (capacity MAX_FLIGHTS).
+ * @param flightCount A pointer to the current flight count, incremented on success.
+ * @param flight A pointer to the flight to copy into the array.
+ * @return 1 on success, 0 on failure (e.g., flight limit reached, duplicate ID, ID reserved by a schedule).
+ */
+int insertFlight(Flight *flights, int *flightCount, const Flight *flight);
+
+/**
+ * @brief Removes a flight from the array by its ID without printing.
+ *
+ * This is the non-interactive core of deleteFlight.
+ *
+ * @param flights A pointer to the array of Flight structures.
+ * @param flightCount A pointer to the current flight count, decremented on success.
+ * @param flightID The ID of the flight to remove.
+ * @return 1 on success, 0 if the flight was not found.
+ */
+int removeFlight(Flight *flights, int *flightCount, int flightID);
+
+/**
+ * @brief Changes the status of a flight by its ID without printing.
+ *
+ * Updates the status bitmaps of flightindex.h incrementally and bumps
+ * flightStatusVersion instead of flightTableVersion, because no flight moves.
+ *
+ * @param flights A pointer to the array of Flight structures.
+ * @param flightCount The current number of flights in the array.
+ * @param flightID The ID of the flight to update.
+ * @param status The new status.
+ * @return 1 on success, 0 if the flight was not found or the status is invalid.
+ */
+int setFlightStatus(Flight *flights, int flightCount, int flightID, FlightStatus status);
+
 /**
  * @brief Adds a new flight to the flight list.
  *
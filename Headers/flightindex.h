@@ -0,0 +1,127 @@
+/**
+ * @file flightindex.h
+ * @brief Header file for the bitmap secondary indexes on flight status and departure day.
+ *
+ * Status and departure day have few distinct values, and most filters use
+ * them. The index keeps one compressed bitmap (see roaring.h) of flight IDs
+ * per status and one per departure day, so "DELAYED on these days" is
+ * answered with bitmap OR (statuses, days) and AND (statuses with days)
+ * instead of a table scan. The query planner uses it when the result is
+ * small (see query.h).
+ *
+ * The bitmaps hold flight IDs, not array positions, so they stay valid when
+ * flights are shifted or sorted. The core flight functions update them
+ * incrementally through the hooks below. Bulk changes, such as a reload or
+ * a table filled directly, make the index stale, and the next
+ * refreshFlightIndex rebuilds it in O(n).
+ */
+
+#ifndef FLIGHTINDEX_H
+#define FLIGHTINDEX_H
+
+#include "common.h"  // For Flight, FlightStatus and DateTime
+#include "roaring.h" // For Roaring
+
+/**
+ * @def FLIGHT_STATUS_ALL
+ * @brief Status mask with every FlightStatus bit set (bit s stands for status s).
+ */
+#define FLIGHT_STATUS_ALL 0x7
+
+/**
+ * @def FLIGHT_INDEX_KEY
+ * @brief Bitmap value of a flight ID (biased so negative IDs sort first).
+ */
+#define FLIGHT_INDEX_KEY(flightID) ((uint32_t)(flightID) ^ 0x80000000u)
+
+/**
+ * @def FLIGHT_INDEX_ID
+ * @brief Flight ID of a bitmap value (inverse of FLIGHT_INDEX_KEY).
+ */
+#define FLIGHT_INDEX_ID(key) ((int)((uint32_t)(key) ^ 0x80000000u))
+
+/**
+ * @brief Returns the day number of a date: consecutive days get increasing numbers.
+ *
+ * @param dateTime The date (the time of day is ignored).
+ * @return Days counted from 1900 with 31-day months (dateTimeMinutes / 1440).
+ */
+int departureDay(const DateTime *dateTime);
+
+/**
+ * @brief Makes the index current for a flight table, rebuilding it if stale.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+int refreshFlightIndex(const Flight *flights, int flightCount);
+
+/**
+ * @brief Returns an upper bound on the size of a selection, without computing it.
+ *
+ * Call after refreshFlightIndex.
+ *
+ * @param statusMask The statuses to include (bit s for status s).
+ * @param firstDay The first departure day (INT_MIN for no bound).
+ * @param lastDay The last departure day (INT_MAX for no bound).
+ * @return The smaller of the flights with those statuses and the flights on those days.
+ */
+long long estimateFlightSelection(int statusMask, int firstDay, int lastDay);
+
+/**
+ * @brief Selects the flights with one of the statuses departing on one of the days.
+ *
+ * Call after refreshFlightIndex. The days are OR-ed, the statuses are OR-ed,
+ * and the two sets are AND-ed.
+ *
+ * @param statusMask The statuses to include (bit s for status s).
+ * @param firstDay The first departure day (INT_MIN for no bound).
+ * @param lastDay The last departure day (INT_MAX for no bound).
+ * @param result Receives the flight IDs as FLIGHT_INDEX_KEY values (must be initialized; replaced).
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+int selectFlights(int statusMask, int firstDay, int lastDay, Roaring *result);
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights, including the new one.
+ * @param flight The new flight.
+ */
+void indexFlightInserted(const Flight *flights, int flightCount, const Flight *flight);
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights once it is removed.
+ * @param flight The flight being removed (still in the array).
+ */
+void indexFlightRemoved(const Flight *flights, int flightCount, const Flight *flight);
+
+/**
+ * @brief Hook: a flight's status changed.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flight The flight, with its new status.
+ * @param previous Its previous status.
+ */
+void indexFlightStatusChanged(const Flight *flights, int flightCount, const Flight *flight, FlightStatus previous);
+
+/**
+ * @brief Hook: the flights were reordered. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+void indexFlightsReordered(const Flight *flights, int flightCount);
+
+/**
+ * @brief Frees the index.
+ */
+void cleanupFlightIndex();
+
+#endif // FLIGHTINDEX_H
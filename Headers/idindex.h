@@ -0,0 +1,83 @@
+/**
+ * @file idindex.h
+ * @brief Header file for the flight ID and ticket ID hash indexes and their batched lookups.
+ *
+ * findFlightIndex and findTicketIndex scan the table for one ID. Callers that
+ * resolve many IDs at once (an itinerary of tickets and their flights, a
+ * report joining tickets to flights) use the batch functions here instead:
+ * each looks up an array of IDs in an open-addressing hash index of
+ * (ID, position) pairs.
+ *
+ * The lookups run in groups of ID_INDEX_GROUP keys. The first pass over a
+ * group hashes every key and prefetches its slot, and the second pass probes
+ * the slots (which have arrived in the cache by then) and prefetches the
+ * records found. The cache misses of a whole group thus overlap instead of
+ * being paid one after another.
+ *
+ * As in page.c, an index is rebuilt on first use after the table's version
+ * (flightTableVersion, ticketTableVersion) changes. When an ID repeats, the
+ * first position wins, as in findFlightIndex.
+ */
+
+#ifndef IDINDEX_H
+#define IDINDEX_H
+
+#include "common.h" // For Flight
+#include "ticket.h" // For Ticket
+
+/**
+ * @def ID_INDEX_GROUP
+ * @brief Keys whose slot and record fetches are overlapped.
+ */
+#define ID_INDEX_GROUP 16
+
+/**
+ * @brief Finds the positions of many flights by ID.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param positions Receives the position of each ID, or -1 if it is not in the table.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int findFlightIndexes(const Flight *flights, int flightCount, const int *flightIDs, int count, int *positions);
+
+/**
+ * @brief Finds many flights by ID.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param out Receives a pointer to each flight (prefetched), or NULL if it is not in the table.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int searchFlights(const Flight *flights, int flightCount, const int *flightIDs, int count, const Flight **out);
+
+/**
+ * @brief Finds the positions of many tickets in globalTickets by ID.
+ *
+ * @param ticketIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param positions Receives the position of each ID, or -1 if there is no such ticket.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int findTicketIndexes(const int *ticketIDs, int count, int *positions);
+
+/**
+ * @brief Finds many tickets by ID.
+ *
+ * @param ticketIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param out Receives a pointer into globalTickets for each ID (prefetched), or NULL if there is no such ticket.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int searchTickets(const int *ticketIDs, int count, const Ticket **out);
+
+/**
+ * @brief Frees both indexes.
+ */
+void cleanupIDIndexes();
+
+#endif // IDINDEX_H
@@ -0,0 +1,295 @@
+/**
+ * @file inventory.h
+ * @brief Header file for seat inventory functions, including the shared-memory segment.
+ *
+ * This file declares the atomic seat claim/release operations used by ticket
+ * booking, and a POSIX shared-memory segment that holds the Flight table so
+ * several front-end processes can book against one seat inventory. The segment
+ * layout is position-independent: the header stores byte offsets from the
+ * segment base instead of pointers, so every process may map it at a
+ * different address. Next to the Flight slots, the segment records which
+ * ticket holds each seat, so a process cancelling its stale copy of a ticket
+ * another process already cancelled cannot free a seat sold again since.
+ */
+
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include <stddef.h>  // For size_t
+#include <pthread.h> // For pthread_mutex_t
+
+#include "common.h" // For Flight and seat map macros
+
+/**
+ * @def INVENTORY_MAGIC
+ * @brief Marker stored at the start of a valid inventory segment ("FLTI").
+ */
+#define INVENTORY_MAGIC 0x464C5449u
+
+/**
+ * @def INVENTORY_VERSION
+ * @brief Layout version of the inventory segment; bumped on incompatible changes.
+ */
+#define INVENTORY_VERSION 4u
+
+/**
+ * @def INVENTORY_NAME_LEN
+ * @brief Maximum length of a shared-memory segment name (including the leading '/').
+ */
+#define INVENTORY_NAME_LEN 64
+
+/**
+ * @def INVENTORY_DELETED_ID
+ * @brief Flight ID left in a slot whose flight was deleted (slots are never reused, so pointers stay valid).
+ */
+#define INVENTORY_DELETED_ID (-2147483647 - 1)
+
+/**
+ * @def INVENTORY_SEAT_RELEASED
+ * @brief Seat owner left behind once a seat was released; 0 means the seat was never released since the segment was created.
+ */
+#define INVENTORY_SEAT_RELEASED (-1)
+
+/**
+ * @struct InventoryHeader
+ * @brief Fixed header at offset 0 of the shared-memory segment.
+ *
+ * Contains only plain integers and offsets, never pointers.
+ */
+typedef struct {
+    unsigned int magic;     /**< Always INVENTORY_MAGIC once the segment is initialized. */
+    unsigned int version;   /**< Layout version (INVENTORY_VERSION). */
+    int capacity;           /**< Number of Flight slots reserved in the segment. */
+    int flightCount;        /**< Number of published flights (read/written atomically). */
+    pthread_mutex_t addLock; /**< Robust, process-shared lock held by inventoryAddFlight. */
+    int published;          /**< 1 once the creator has published its flights (atomic). */
+    int nextTicketID;       /**< Next ticket ID for every attached process (atomic). */
+    size_t flightsOffset;   /**< Byte offset from the segment base to the first Flight slot. */
+    size_t ownersOffset;    /**< Byte offset to the seat owners: MAX_PASSENGERS_PER_FLIGHT ticket IDs per slot. */
+    size_t segmentSize;     /**< Total size of the segment in bytes. */
+} InventoryHeader;
+
+/**
+ * @struct SharedInventory
+ * @brief Process-local handle to a mapped inventory segment.
+ */
+typedef struct {
+    InventoryHeader *base;            /**< Address the segment is mapped at in this process (NULL if detached). */
+    size_t size;                      /**< Size of the mapping in bytes. */
+    char name[INVENTORY_NAME_LEN];    /**< Name of the shared-memory object (e.g., "/flight_inventory"). */
+} SharedInventory;
+
+/**
+ * @var flightSeatVersion
+ * @brief Incremented (atomically) whenever a seat count in this process changes through the inventory functions.
+ */
+extern unsigned long flightSeatVersion;
+
+/**
+ * @brief Atomically claims a seat on a flight.
+ *
+ * Decrements availableSeats and sets the seat's bit in the seat map using
+ * atomic operations, so concurrent callers (threads or processes sharing the
+ * Flight through shared memory) can never both win the same seat.
+ *
+ * @param flight A pointer to the Flight to book on.
+ * @param seatNo The 1-based seat number to claim.
+ * @return 1 on success, 0 on failure (e.g., invalid seat, seat already booked, no seats left).
+ */
+int claimFlightSeat(Flight *flight, int seatNo);
+
+/**
+ * @brief Atomically releases a previously claimed seat on a flight.
+ *
+ * @param flight A pointer to the Flight the seat belongs to.
+ * @param seatNo The 1-based seat number to release.
+ * @return 1 on success, 0 on failure (e.g., invalid seat or seat not booked).
+ */
+int releaseFlightSeat(Flight *flight, int seatNo);
+
+/**
+ * @brief Records which ticket holds a seat just claimed on a flight of the segment.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flight The flight, a slot of the segment.
+ * @param seatNo The 1-based seat number.
+ * @param ticketID The ID of the ticket that holds the seat.
+ */
+void inventorySetSeatOwner(SharedInventory *inv, const Flight *flight, int seatNo, int ticketID);
+
+/**
+ * @brief Releases a seat of a flight in the segment on behalf of the ticket that holds it.
+ *
+ * The seat is released only if the segment still names the ticket as its
+ * holder (or names none because the seat was booked before the segment was
+ * created and never released since). A copy of a ticket that another
+ * process already cancelled therefore leaves the seat alone, even if it was
+ * sold again in between.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flight The flight, a slot of the segment.
+ * @param seatNo The 1-based seat number.
+ * @param ticketID The ID of the ticket being cancelled.
+ * @return 1 if the seat was released, 0 if the ticket no longer holds it (or the seat is invalid).
+ */
+int inventoryReleaseSeat(SharedInventory *inv, Flight *flight, int seatNo, int ticketID);
+
+/**
+ * @brief Claims the same seat on several flights (the legs of one trip), on all of them or on none.
+ *
+ * The legs are claimed in order with claimFlightSeat; if one fails, the
+ * ones already claimed are released again, so no seat is ever held twice
+ * and a failed call leaves every leg as it was.
+ *
+ * @param flights The flights (NULL entries make the call fail).
+ * @param count The number of flights.
+ * @param seatNo The 1-based seat number to claim.
+ * @return 1 if the seat was claimed on every flight, 0 otherwise.
+ */
+int claimFlightSeats(Flight *const *flights, int count, int seatNo);
+
+/**
+ * @brief Creates a shared-memory inventory segment that does not exist yet.
+ *
+ * Creation is exclusive: if another process created the segment first, this
+ * fails without touching it and the caller attaches instead, so a live
+ * segment and its seat claims are never re-initialized.
+ *
+ * @param inv A pointer to the handle to initialize.
+ * @param name The shared-memory object name (must start with '/').
+ * @param capacity The number of Flight slots to reserve.
+ * @return 1 on success, 0 on failure (e.g., segment already exists, shm_open/mmap failed, unsupported platform).
+ */
+int createInventory(SharedInventory *inv, const char *name, int capacity);
+
+/**
+ * @brief Attaches to an existing shared-memory inventory segment.
+ *
+ * Waits up to about two seconds for a segment that is still being created
+ * to be published by its creator.
+ *
+ * @param inv A pointer to the handle to initialize.
+ * @param name The shared-memory object name.
+ * @return 1 on success, 0 on failure (e.g., segment missing or not a valid inventory).
+ */
+int attachInventory(SharedInventory *inv, const char *name);
+
+/**
+ * @brief Copies a Flight table into the shared segment.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flights A pointer to the array of Flight structures to publish.
+ * @param flightCount The number of flights in the array.
+ * @return 1 on success, 0 on failure (e.g., segment too small).
+ */
+int publishFlights(SharedInventory *inv, const Flight *flights, int flightCount);
+
+/**
+ * @brief Appends one flight to the segment (e.g., after addFlight in one process).
+ *
+ * The duplicate check and the append happen under a lock in the segment, so
+ * two processes adding the same ID cannot both succeed. The lock is robust:
+ * if a process dies while holding it, the next caller takes it over and
+ * overwrites the slot that was never published.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flight The flight to copy into a new slot.
+ * @return 1 on success, 0 on failure (e.g., segment full, ID already in the segment).
+ */
+int inventoryAddFlight(SharedInventory *inv, const Flight *flight);
+
+/**
+ * @brief Deletes a flight from the segment; its slot is marked INVENTORY_DELETED_ID and never reused.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flightID The ID of the flight to delete.
+ * @return 1 on success, 0 if the flight is not in the segment.
+ */
+int inventoryRemoveFlight(SharedInventory *inv, int flightID);
+
+/**
+ * @brief Copies the flights of the segment (without deleted slots) into a local array.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flights Receives the flights.
+ * @param capacity The capacity of flights.
+ * @return The number of flights copied.
+ */
+int copyInventoryFlights(const SharedInventory *inv, Flight *flights, int capacity);
+
+/**
+ * @brief Raises the segment's next ticket ID to at least a given value.
+ *
+ * Every attaching process calls this with the ID after the highest one it
+ * loaded, so shared IDs stay above every ticket on file.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param nextTicketID The lowest ID the segment may hand out next.
+ */
+void seedInventoryTicketIDs(SharedInventory *inv, int nextTicketID);
+
+/**
+ * @brief Hands out a ticket ID that is unique across every attached process.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @return The ticket ID.
+ */
+int takeInventoryTicketID(SharedInventory *inv);
+
+/**
+ * @brief Returns the number of flights currently published in the segment.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @return The published flight count, or 0 if the handle is detached.
+ */
+int inventoryFlightCount(const SharedInventory *inv);
+
+/**
+ * @brief Resolves a flight slot of the segment to an address in this process.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param index The slot index (0 to inventoryFlightCount() - 1).
+ * @return A pointer to the Flight in the segment, or NULL if the index is out of range.
+ */
+Flight *inventoryFlightAt(const SharedInventory *inv, int index);
+
+/**
+ * @brief Finds a flight in the segment by its ID.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flightID The ID of the flight to look up.
+ * @return A pointer to the Flight in the segment, or NULL if not found.
+ */
+Flight *inventoryFindFlight(const SharedInventory *inv, int flightID);
+
+/**
+ * @brief Copies seat maps and seat counts from the segment back into a local Flight table.
+ *
+ * Flights are matched by ID through the flight ID index; local flights not
+ * present in the segment are left untouched. A flight whose seats changed
+ * bumps flightSeatVersion and goes through the availability, aggregate and
+ * response cache hooks, like a local claim or release.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flights A pointer to the local array of Flight structures.
+ * @param flightCount The number of flights in the local array.
+ * @return The number of flights updated.
+ */
+int syncFlightsFromInventory(const SharedInventory *inv, Flight *flights, int flightCount);
+
+/**
+ * @brief Unmaps the segment from this process. The segment itself persists.
+ *
+ * @param inv A pointer to the handle to detach.
+ */
+void detachInventory(SharedInventory *inv);
+
+/**
+ * @brief Removes the named shared-memory object from the system.
+ *
+ * @param name The shared-memory object name.
+ * @return 1 on success, 0 on failure.
+ */
+int destroyInventory(const char *name);
+
+#endif // INVENTORY_H
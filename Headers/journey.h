@@ -0,0 +1,177 @@
+/**
+ * @file journey.h
+ * @brief Header file for multi-leg journey search (the Connection Scan Algorithm and RAPTOR).
+ *
+ * Every flight that is not cancelled is one connection: from its origin at
+ * its departure to its destination at its arrival. The connections are kept
+ * in one array sorted by departure, and a query is a single pass over part
+ * of it:
+ *   - findEarliestArrival scans forward from the earliest departure, keeping
+ *     for every airport the earliest time a passenger can leave it, and stops
+ *     as soon as no connection can arrive earlier than the best found;
+ *   - findJourneyProfile scans backward over a departure window, keeping for
+ *     every airport the Pareto front of (leave by, arrive at destination)
+ *     pairs, and returns every journey that no other one beats on both
+ *     departure (later) and arrival (earlier);
+ *   - findParetoJourneys runs RAPTOR rounds (round k finds the journeys of k
+ *     flights) over routes, the flights between one pair of airports, and
+ *     returns every journey that no other one beats on arrival, number of
+ *     flights and fare together. Only airports reached better in a round are
+ *     scanned in the next, and only flights with a free seat in their seat
+ *     map are taken, so every journey it returns can be booked.
+ *
+ * A passenger changing flights needs the airport's minimum connection time
+ * between the arrival of one leg and the departure of the next
+ * (JOURNEY_DEFAULT_CONNECTION unless set with setMinConnectionTime). Times
+ * are minutes on a real calendar, so legs crossing midnight or a month end
+ * are timed correctly. Journeys are limited to JOURNEY_MAX_LEGS legs, and
+ * the scans ignore flights departing more than JOURNEY_MAX_SPAN minutes
+ * after the first possible departure.
+ *
+ * Flights have no stored fare, so a leg costs journeyFare: a base fare plus
+ * a rate per hour in the air, raised with the share of seats sold.
+ *
+ * The connection array and the routes are rebuilt on first use after the
+ * flight table, a flight's status or a connection time changes.
+ */
+
+#ifndef JOURNEY_H
+#define JOURNEY_H
+
+#include "common.h" // For Flight and DateTime
+
+/**
+ * @def JOURNEY_MAX_LEGS
+ * @brief Maximum flights in one journey.
+ */
+#define JOURNEY_MAX_LEGS 8
+
+/**
+ * @def JOURNEY_DEFAULT_CONNECTION
+ * @brief Minimum connection time in minutes at airports without their own.
+ */
+#define JOURNEY_DEFAULT_CONNECTION 45
+
+/**
+ * @def JOURNEY_MAX_RULES
+ * @brief Maximum airports with their own minimum connection time.
+ */
+#define JOURNEY_MAX_RULES 64
+
+/**
+ * @def JOURNEY_MAX_SPAN
+ * @brief Minutes after the first possible departure within which a journey must depart its last leg (2 days).
+ */
+#define JOURNEY_MAX_SPAN (2 * 1440)
+
+/**
+ * @def JOURNEY_BASE_FARE
+ * @brief Fare of any flight before its time in the air and its load are added.
+ */
+#define JOURNEY_BASE_FARE 40
+
+/**
+ * @def JOURNEY_FARE_PER_HOUR
+ * @brief Fare added per hour in the air.
+ */
+#define JOURNEY_FARE_PER_HOUR 60
+
+/**
+ * @struct Journey
+ * @brief One itinerary: its flights in travel order and its overall times.
+ */
+typedef struct {
+    int legCount;                       /**< Number of flights. */
+    int flightIDs[JOURNEY_MAX_LEGS];    /**< Flight IDs, first leg first. */
+    int positions[JOURNEY_MAX_LEGS];    /**< Positions of the flights in the table. */
+    int departure;                      /**< Departure of the first leg (see journeyMinutes). */
+    int arrival;                        /**< Arrival of the last leg (see journeyMinutes). */
+    int seatNos[JOURNEY_MAX_LEGS];      /**< A free seat on each flight when found, or 0 if it is full. */
+    int price;                          /**< Sum of the legs' fares (see journeyFare). */
+} Journey;
+
+/**
+ * @brief Returns the minutes between 01-01-1970 00:00 and a date and time.
+ *
+ * @param dateTime The date and time.
+ * @return The minute number (differences are real durations).
+ */
+int journeyMinutes(const DateTime *dateTime);
+
+/**
+ * @brief Returns the fare of one flight: the base fare plus its time in the air, up to twice that when full.
+ *
+ * @param flight The flight.
+ * @return The fare.
+ */
+int journeyFare(const Flight *flight);
+
+/**
+ * @brief Sets the minimum connection time of an airport, or the default for all others.
+ *
+ * @param airport The airport, or NULL for the default.
+ * @param minutes The minimum minutes between an arrival and the next departure (0 or more).
+ * @return 1 on success, 0 if minutes is negative or JOURNEY_MAX_RULES airports already have one.
+ */
+int setMinConnectionTime(const char *airport, int minutes);
+
+/**
+ * @brief Finds the journey arriving earliest at a destination.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The airport the journey starts from.
+ * @param destination The airport the journey ends at.
+ * @param earliest The earliest departure from the origin.
+ * @param out Receives the journey.
+ * @return 1 if a journey was found, 0 if none, -1 if memory allocation failed.
+ */
+int findEarliestArrival(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                        const DateTime *earliest, Journey *out);
+
+/**
+ * @brief Finds the best journeys departing within a window (the Pareto front of departure and arrival).
+ *
+ * A journey is kept unless another one departs no earlier and arrives no
+ * later. The journeys are returned by departure; each arrives later than
+ * the one before.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The airport the journeys start from.
+ * @param destination The airport the journeys end at.
+ * @param first The earliest departure from the origin.
+ * @param last The latest departure from the origin.
+ * @param out Receives the journeys.
+ * @param maxJourneys The capacity of out.
+ * @return The number of journeys written (the earliest departing first), or -1 if memory allocation failed.
+ */
+int findJourneyProfile(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                       const DateTime *first, const DateTime *last, Journey *out, int maxJourneys);
+
+/**
+ * @brief Finds the journeys no other one beats on arrival, number of flights and fare together.
+ *
+ * A journey is kept unless another one arrives no later, with no more
+ * flights and for no more money. Every leg has a free seat (its first one
+ * is in seatNos). The journeys are returned by arrival, then fare.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The airport the journeys start from.
+ * @param destination The airport the journeys end at.
+ * @param earliest The earliest departure from the origin.
+ * @param maxLegs The most flights per journey (1 to JOURNEY_MAX_LEGS).
+ * @param out Receives the journeys.
+ * @param maxJourneys The capacity of out.
+ * @return The number of journeys written (the earliest arriving if there are more), or -1 if memory allocation failed.
+ */
+int findParetoJourneys(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                       const DateTime *earliest, int maxLegs, Journey *out, int maxJourneys);
+
+/**
+ * @brief Frees the connection array and the search state.
+ */
+void cleanupJourneys();
+
+#endif // JOURNEY_H
@@ -0,0 +1,98 @@
+/**
+ * @file memstats.h
+ * @brief Header file for per-subsystem allocation accounting.
+ *
+ * The flight, passenger and ticket tables are allocated through
+ * trackedMalloc/trackedRealloc/trackedFree instead of the raw C functions.
+ * Each subsystem counts live and peak bytes, allocations, frees, reallocs and
+ * reallocs that had to move (copy) the block, so the memory report can show
+ * how much each table uses and how much is slack capacity.
+ */
+
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <stddef.h> // For size_t
+
+/**
+ * @enum MemSubsystem
+ * @brief Owners of tracked allocations.
+ */
+typedef enum {
+    MEM_FLIGHTS,            /**< The flight table. */
+    MEM_PASSENGERS,         /**< globalPassengers. */
+    MEM_TICKETS,            /**< globalTickets. */
+    MEM_OTHER,              /**< Anything else allocated through the wrapper. */
+    MEM_SUBSYSTEM_COUNT     /**< Number of subsystems (not a subsystem). */
+} MemSubsystem;
+
+/**
+ * @struct MemoryUsage
+ * @brief Snapshot of one subsystem's counters.
+ */
+typedef struct {
+    long long liveBytes;     /**< Bytes currently allocated (requested sizes, excluding bookkeeping). */
+    long long peakBytes;     /**< Highest liveBytes seen. */
+    long long allocations;   /**< trackedMalloc calls, plus trackedRealloc calls on NULL. */
+    long long frees;         /**< trackedFree calls on non-NULL pointers. */
+    long long reallocs;      /**< trackedRealloc calls on existing blocks. */
+    long long reallocCopies; /**< Reallocs that moved the block to a new address. */
+    long long copiedBytes;   /**< Bytes moved by those reallocs. */
+} MemoryUsage;
+
+/**
+ * @brief Allocates memory charged to a subsystem.
+ *
+ * @param subsystem The owner of the block.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the block, or NULL if the allocation failed.
+ */
+void *trackedMalloc(MemSubsystem subsystem, size_t size);
+
+/**
+ * @brief Resizes a block allocated with trackedMalloc or trackedRealloc.
+ *
+ * Behaves like realloc: on failure NULL is returned and the old block is left untouched.
+ *
+ * @param subsystem The owner of the block.
+ * @param ptr The block to resize (NULL allocates a new block).
+ * @param size The new size in bytes.
+ * @return A pointer to the resized block, or NULL if the allocation failed.
+ */
+void *trackedRealloc(MemSubsystem subsystem, void *ptr, size_t size);
+
+/**
+ * @brief Frees a block allocated with trackedMalloc or trackedRealloc.
+ *
+ * @param subsystem The owner of the block.
+ * @param ptr The block to free (NULL is ignored).
+ */
+void trackedFree(MemSubsystem subsystem, void *ptr);
+
+/**
+ * @brief Reads a subsystem's counters.
+ *
+ * @param subsystem The subsystem.
+ * @param usage Receives the counters.
+ * @return 1 on success, 0 if the subsystem is out of range.
+ */
+int summarizeMemory(MemSubsystem subsystem, MemoryUsage *usage);
+
+/**
+ * @brief Returns the display name of a subsystem.
+ *
+ * @param subsystem The subsystem.
+ * @return A constant string such as "flights".
+ */
+const char *memSubsystemName(MemSubsystem subsystem);
+
+/**
+ * @brief Prints live, used, slack and peak bytes plus allocation counts for every subsystem.
+ *
+ * @param usedBytes Bytes actually holding records, indexed by MemSubsystem; a negative
+ * entry (or a NULL array) means unknown and no slack is shown.
+ * @return 1 on success.
+ */
+int printMemoryReport(const long long *usedBytes);
+
+#endif // MEMSTATS_H
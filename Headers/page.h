@@ -0,0 +1,197 @@
+/**
+ * @file page.h
+ * @brief Header file for cursor (keyset) pagination over the flight, passenger and ticket tables.
+ *
+ * A page is requested as "the next N records after the last one I saw", never
+ * as "page number P". The cursor remembers the sort key of the last record
+ * returned, and the next page starts with a binary search for that key in a
+ * sorted index, so page 10,000 costs the same O(log n + N) as page 1, and
+ * records added or removed between pages neither repeat nor shift the pages.
+ *
+ * Orders:
+ *   flights     by flight ID, or by departure time (ties broken by flight ID)
+ *   passengers  by passport number
+ *   tickets     by ticket ID
+ *
+ * Each index is a sorted array of keys and table positions. insertFlight,
+ * removeFlight, passenger and ticket inserts and removals keep it current
+ * through the hooks below: a binary search and one memmove per change, plus
+ * an O(n) renumbering of positions after a removal, never a re-sort. It is
+ * rebuilt lazily, in O(n log n), only on the first page after a change the
+ * hooks do not see (a load or a sort; see flightTableVersion,
+ * passengerTableVersion and ticketTableVersion). Paging is thread-safe:
+ * concurrent callers (e.g., server connections holding the service reader
+ * lock) are serialized on the index.
+ */
+
+#ifndef PAGE_H
+#define PAGE_H
+
+#include <stddef.h> // For size_t
+
+#include "common.h" // For Flight and DateTime
+
+/**
+ * @def PAGE_MAX_LIMIT
+ * @brief Largest page a single call returns.
+ */
+#define PAGE_MAX_LIMIT 1000
+
+/**
+ * @def PAGE_CURSOR_TEXT_SIZE
+ * @brief Buffer size large enough for any formatted cursor.
+ */
+#define PAGE_CURSOR_TEXT_SIZE 48
+
+/**
+ * @enum PageOrder
+ * @brief Sort orders of flight pages.
+ */
+typedef enum {
+    PAGE_BY_ID,         /**< Ascending flight ID. */
+    PAGE_BY_DEPARTURE   /**< Ascending departure time, then flight ID. */
+} PageOrder;
+
+/**
+ * @struct PageCursor
+ * @brief Where the next page starts.
+ *
+ * Initialize with initPageCursor to start at the first record, or with
+ * pageCursorAfter / parsePageCursor to resume after a known key.
+ */
+typedef struct {
+    int started;        /**< 0 before the first record, 1 once a key is set. */
+    int done;           /**< 1 once a page reached the end of the table. */
+    long long key;      /**< Key of the last record returned: flight or ticket ID, or departure key. */
+    int flightID;       /**< Flight ID of the last flight returned (breaks departure ties). */
+    char passport[20];  /**< Passport of the last passenger returned. */
+} PageCursor;
+
+/**
+ * @brief Positions a cursor before the first record.
+ *
+ * @param cursor The cursor.
+ */
+void initPageCursor(PageCursor *cursor);
+
+/**
+ * @brief Positions a cursor after a known key, e.g. "after flight ID 1200".
+ *
+ * @param cursor The cursor.
+ * @param key A flight or ticket ID, or a departure key (see departureKey).
+ * @param flightID For PAGE_BY_DEPARTURE, the flight ID of the last flight seen; ignored otherwise.
+ */
+void pageCursorAfter(PageCursor *cursor, long long key, int flightID);
+
+/**
+ * @brief Returns the sort key of a departure time: the decimal number YYYYMMDDHHMM.
+ *
+ * @param dateTime The date and time.
+ * @return The key (e.g., 202503071405 for 07-03-2025 14:05).
+ */
+long long departureKey(const DateTime *dateTime);
+
+/**
+ * @brief Returns the next page of flights.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param order The sort order (must stay the same for every page of a cursor).
+ * @param cursor Where the page starts; advanced past the returned flights.
+ * @param limit The maximum number of flights (capped at PAGE_MAX_LIMIT).
+ * @param indexes Receives the array positions of the returned flights, in order.
+ * @return The number of flights returned (0 at the end), or -1 if the index could not be allocated.
+ */
+int pageFlights(const Flight *flights, int flightCount, PageOrder order, PageCursor *cursor, int limit, int *indexes);
+
+/**
+ * @brief Returns the next page of passengers in passport order.
+ *
+ * @param cursor Where the page starts; advanced past the returned passengers.
+ * @param limit The maximum number of passengers (capped at PAGE_MAX_LIMIT).
+ * @param indexes Receives the positions in globalPassengers, in order.
+ * @return The number of passengers returned (0 at the end), or -1 if the index could not be allocated.
+ */
+int pagePassengers(PageCursor *cursor, int limit, int *indexes);
+
+/**
+ * @brief Returns the next page of tickets in ticket ID order.
+ *
+ * @param cursor Where the page starts; advanced past the returned tickets.
+ * @param limit The maximum number of tickets (capped at PAGE_MAX_LIMIT).
+ * @param indexes Receives the positions in globalTickets, in order.
+ * @return The number of tickets returned (0 at the end), or -1 if the index could not be allocated.
+ */
+int pageTickets(PageCursor *cursor, int limit, int *indexes);
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights, including the new one.
+ * @param flight The new flight.
+ */
+void pageFlightInserted(const Flight *flights, int flightCount, const Flight *flight);
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights once it is removed.
+ * @param flight The flight being removed (still in the array).
+ */
+void pageFlightRemoved(const Flight *flights, int flightCount, const Flight *flight);
+
+/**
+ * @brief Hook: a passenger was appended. Call before incrementing passengerTableVersion.
+ */
+void pagePassengerAdded();
+
+/**
+ * @brief Hook: a passenger is being removed. Call before shifting the table and incrementing passengerTableVersion.
+ *
+ * @param position The position of the passenger (still in the table).
+ */
+void pagePassengerRemoved(int position);
+
+/**
+ * @brief Hook: a ticket was appended. Call before incrementing ticketTableVersion.
+ */
+void pageTicketAdded();
+
+/**
+ * @brief Hook: a ticket is being removed. Call before shifting the table and incrementing ticketTableVersion.
+ *
+ * @param position The position of the ticket (still in the table).
+ */
+void pageTicketRemoved(int position);
+
+/**
+ * @brief Formats a flight cursor as a token for a client to send back.
+ *
+ * Tokens are "-" (start), "<flightID>" (PAGE_BY_ID) or
+ * "<departureKey>.<flightID>" (PAGE_BY_DEPARTURE); "end" once done.
+ *
+ * @param cursor The cursor.
+ * @param order The order it pages in.
+ * @param text Receives the token.
+ * @param size The size of text (PAGE_CURSOR_TEXT_SIZE is always enough).
+ */
+void formatPageCursor(const PageCursor *cursor, PageOrder order, char *text, size_t size);
+
+/**
+ * @brief Parses a token written by formatPageCursor.
+ *
+ * @param text The token.
+ * @param order The order it pages in.
+ * @param cursor Receives the cursor.
+ * @return 1 on success, 0 if the token is malformed.
+ */
+int parsePageCursor(const char *text, PageOrder order, PageCursor *cursor);
+
+/**
+ * @brief Frees the pagination indexes.
+ */
+void cleanupPageIndexes();
+
+#endif // PAGE_H
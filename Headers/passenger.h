@@ -40,6 +40,11 @@ extern int globalPassengerCount;
  * @brief Maximum capacity of the globalPassengers array before reallocation is needed.
  */
 extern int globalPassengerCapacity;
+/**
+ * @var passengerTableVersion
+ * @brief Incremented whenever passengers are added, removed or reloaded (indexes compare it to detect stale state).
+ */
+extern unsigned long passengerTableVersion;
 
 /**
  * @def INITIAL_PASSENGER_CAPACITY
@@ -57,6 +62,37 @@ extern int globalPassengerCapacity;
  */
 int initializePassengers();
 
+/**
+ * @brief Finds the position of a passenger by passport number.
+ *
+ * Unknown passports are usually rejected by the passport filter without a scan.
+ *
+ * @param passport The passport number to look up.
+ * @return The index of the passenger in globalPassengers, or -1 if not found.
+ */
+int findPassengerIndex(const char *passport);
+
+/**
+ * @brief Appends a fully populated passenger without prompting.
+ *
+ * This is the non-interactive core of addPassenger: it rejects duplicate
+ * passport numbers and grows the array as needed.
+ *
+ * @param passenger A pointer to the passenger to copy into the global array.
+ * @return 1 on success, 0 on failure (e.g., duplicate passport, memory reallocation failed).
+ */
+int insertPassenger(const Passenger *passenger);
+
+/**
+ * @brief Removes a passenger by passport number without prompting.
+ *
+ * This is the non-interactive core of removePassenger.
+ *
+ * @param passport The passport number of the passenger to remove.
+ * @return 1 on success, 0 if the passenger was not found.
+ */
+int erasePassenger(const char *passport);
+
 /**
  * @brief Adds a new passenger to the system.
  *
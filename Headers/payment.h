@@ -8,6 +8,15 @@
 #ifndef PAYMENT_H
 #define PAYMENT_H
 
+/**
+ * @brief Processes a payment without prompting.
+ *
+ * @param method The payment method (e.g., "Cash", "Card", "Online"); must not be empty.
+ * @param amount The amount to pay; must be positive.
+ * @return 1 on success, 0 on failure (e.g., empty method, non-positive amount).
+ */
+int processPayment(const char *method, float amount);
+
 /**
  * @brief Handles a payment transaction.
  *
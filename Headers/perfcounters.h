@@ -0,0 +1,102 @@
+/**
+ * @file perfcounters.h
+ * @brief Header file for hardware performance counters (Linux perf_event_open).
+ *
+ * Opens cycles, instructions, cache misses and branch misses as one counter
+ * group for the calling thread (user space only), so they are scheduled on
+ * the PMU together and their ratios (IPC, misses per operation) are
+ * consistent. Events the CPU or hypervisor does not expose are left out of
+ * the group. On other platforms, or when the kernel refuses the events (e.g.,
+ * perf_event_paranoid, a seccomp filter, or no PMU in a virtual machine),
+ * openPerfCounters fails with errno set and callers report wall-clock time
+ * only.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+/**
+ * @enum PerfCounterKind
+ * @brief The counted hardware events.
+ */
+typedef enum {
+    PERF_CYCLES,            /**< CPU cycles (the group leader). */
+    PERF_INSTRUCTIONS,      /**< Retired instructions. */
+    PERF_CACHE_MISSES,      /**< Last-level cache misses. */
+    PERF_BRANCH_MISSES,     /**< Mispredicted branches. */
+    PERF_COUNTER_COUNT      /**< Number of events (not an event). */
+} PerfCounterKind;
+
+/**
+ * @struct PerfCounters
+ * @brief An open counter group.
+ */
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];    /**< File descriptor per event, -1 if the event is unavailable. */
+    int groupIndex[PERF_COUNTER_COUNT]; /**< Position of each event in the group read, -1 if unavailable. */
+    int members;                    /**< Number of events in the group. */
+} PerfCounters;
+
+/**
+ * @struct PerfCounterValues
+ * @brief Counts read from a group, scaled for multiplexing.
+ */
+typedef struct {
+    long long values[PERF_COUNTER_COUNT]; /**< Count per event, -1 if the event is unavailable. */
+} PerfCounterValues;
+
+/**
+ * @brief Opens the counter group for the calling thread, initially disabled.
+ *
+ * @param counters Receives the group.
+ * @return 1 if at least the cycle counter could be opened, 0 otherwise with
+ *         errno set (ENOSYS outside Linux).
+ */
+int openPerfCounters(PerfCounters *counters);
+
+/**
+ * @brief Zeroes every counter in the group.
+ *
+ * @param counters The group.
+ */
+void resetPerfCounters(PerfCounters *counters);
+
+/**
+ * @brief Starts counting (all events of the group at once).
+ *
+ * @param counters The group.
+ */
+void enablePerfCounters(PerfCounters *counters);
+
+/**
+ * @brief Stops counting (all events of the group at once).
+ *
+ * @param counters The group.
+ */
+void disablePerfCounters(PerfCounters *counters);
+
+/**
+ * @brief Reads the accumulated counts.
+ *
+ * @param counters The group.
+ * @param values Receives the counts.
+ * @return 1 on success, 0 on failure.
+ */
+int readPerfCounters(const PerfCounters *counters, PerfCounterValues *values);
+
+/**
+ * @brief Closes the group.
+ *
+ * @param counters The group.
+ */
+void closePerfCounters(PerfCounters *counters);
+
+/**
+ * @brief Returns the display name of an event.
+ *
+ * @param kind The event.
+ * @return A constant string such as "cycles".
+ */
+const char *perfCounterName(PerfCounterKind kind);
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,90 @@
+/**
+ * @file profiler.h
+ * @brief Header file for the built-in SIGPROF sampling profiler.
+ *
+ * While running, a profiling timer interrupts the process at a fixed rate of
+ * consumed CPU time; the signal handler walks the frame-pointer chain of the
+ * interrupted thread and stores the stack in a preallocated lock-free sample
+ * buffer. The samples can be written at any time as folded stacks
+ * ("main;bookTicket;appendTicket 42"), the input format of flamegraph.pl and
+ * speedscope. Build with -fno-omit-frame-pointer (and -rdynamic for symbol
+ * names) to get complete stacks. POSIX only; on Windows the functions report
+ * that profiling is unsupported.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/**
+ * @def PROFILE_MAX_DEPTH
+ * @brief Deepest stack recorded per sample; deeper frames are cut off.
+ */
+#define PROFILE_MAX_DEPTH 48
+
+/**
+ * @def PROFILE_MAX_SAMPLES
+ * @brief Capacity of the sample buffer; samples taken once it is full are counted as dropped.
+ */
+#ifndef PROFILE_MAX_SAMPLES
+#define PROFILE_MAX_SAMPLES 100000
+#endif
+
+/**
+ * @def PROFILE_DEFAULT_HZ
+ * @brief Sampling rate used when none is given.
+ */
+#define PROFILE_DEFAULT_HZ 997
+
+/**
+ * @brief Starts sampling the whole process at the given rate of CPU time.
+ *
+ * Samples already in the buffer are kept, so a profile can be paused and resumed.
+ *
+ * @param hz Samples per second of CPU time (values <= 0 use PROFILE_DEFAULT_HZ).
+ * @return 1 on success, 0 on failure (e.g., already running, unsupported platform).
+ */
+int startProfiler(int hz);
+
+/**
+ * @brief Stops sampling; the collected samples stay in the buffer.
+ *
+ * @return 1 on success, 0 if the profiler was not running.
+ */
+int stopProfiler();
+
+/**
+ * @brief Records the calling thread's stack bounds so samples taken on it include full stacks.
+ *
+ * Samples from unregistered threads contain only the interrupted frame. The
+ * thread calling startProfiler is registered automatically; worker threads
+ * call this once when they start.
+ *
+ * @return 1 on success, 0 if the bounds could not be determined.
+ */
+int profilerRegisterThread();
+
+/**
+ * @brief Reports whether the profiler is currently sampling.
+ *
+ * @return 1 if running, 0 otherwise.
+ */
+int isProfilerRunning();
+
+/**
+ * @brief Discards all collected samples. Only allowed while the profiler is stopped.
+ *
+ * @return 1 on success, 0 if the profiler is running.
+ */
+int resetProfiler();
+
+/**
+ * @brief Writes the collected samples as folded stacks, one unique stack per line with its count.
+ *
+ * Frames are symbolized with dladdr; addresses without a symbol are written as hex.
+ *
+ * @param filename The file to write (e.g., "profile.folded").
+ * @return 1 on success, 0 on failure (e.g., no samples, file cannot be opened).
+ */
+int writeFoldedStacks(const char *filename);
+
+#endif // PROFILER_H
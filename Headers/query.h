@@ -0,0 +1,195 @@
+/**
+ * @file query.h
+ * @brief Header file for the flight filter query engine.
+ *
+ * Queries are conjunctions of predicates over flight fields, e.g.
+ *   origin=DAC AND status=DELAYED AND departure in today AND seats>=4
+ *
+ * Grammar (keywords and field names are case-insensitive, values are not):
+ *   query      := predicate { AND predicate }
+ *   predicate  := field op value | departure IN day
+ *   field      := id | name | origin | destination | status | seats | departure
+ *   op         := = | != | < | <= | > | >=
+ *   day        := today | tomorrow | YYYY-MM-DD
+ * name, origin and destination accept only = and !=. status takes ON_TIME,
+ * DELAYED or CANCELLED. departure takes a day, now or YYYY-MM-DDTHH:MM; a
+ * day compared with = means the whole day, with < or >= its first minute,
+ * and with <= or > its last minute.
+ *
+ * compileQuery turns the text into one range check per predicate. runQuery
+ * evaluates them over a columnar copy of the flight table: every field is an
+ * int column (strings are dictionary codes, departures are minute numbers),
+ * and rows are filtered in blocks of 64 with SIMD range compares (SSE2, or
+ * AVX2 when compiled with -mavx2) that produce a 64-bit selection mask per
+ * predicate; a block stops being evaluated as soon as its mask is empty.
+ *
+ * The planner also keeps a route index (rows sorted by origin, destination)
+ * and a time index (rows sorted by departure). When an origin or departure
+ * predicate selects fewer than 1 / QUERY_INDEX_FACTOR of the rows, it reads
+ * just those candidates from the index and checks the remaining predicates
+ * on them instead of scanning. Status and departure predicates can also be
+ * answered together by AND-ing the status and day bitmaps of flightindex.h,
+ * which pays off when neither is selective alone (e.g. CANCELLED today).
+ * Results are always positions in array order.
+ *
+ * runTopKQuery returns only the first K matches in departure or fullness
+ * order, without sorting the matches or touching the flight array. Ordered
+ * by departure, it walks the time index from the first departure allowed and
+ * stops after K matches, unless route or bitmap candidates are so few that
+ * checking all of them is expected to be cheaper. Otherwise
+ * it keeps the best K candidates in a bounded binary heap (O(n log K)) and
+ * heapsorts those K at the end.
+ *
+ * The columns and indexes are rebuilt lazily when flightTableVersion changes;
+ * the seats and status columns are refreshed when flightSeatVersion and
+ * flightStatusVersion change.
+ */
+
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <stddef.h> // For size_t
+
+#include "common.h" // For Flight, DateTime and MAX_NAME_LEN
+
+/**
+ * @def QUERY_MAX_PREDICATES
+ * @brief Maximum predicates in one query.
+ */
+#define QUERY_MAX_PREDICATES 16
+
+/**
+ * @def QUERY_INDEX_FACTOR
+ * @brief An index is used when it leaves fewer than 1 / QUERY_INDEX_FACTOR of the rows to check.
+ */
+#define QUERY_INDEX_FACTOR 16
+
+/**
+ * @enum QueryField
+ * @brief Queryable flight fields (one column each).
+ */
+typedef enum {
+    QUERY_ID,           /**< flightID. */
+    QUERY_NAME,         /**< flightName (dictionary code). */
+    QUERY_ORIGIN,       /**< origin (dictionary code). */
+    QUERY_DESTINATION,  /**< destination (dictionary code). */
+    QUERY_STATUS,       /**< status. */
+    QUERY_SEATS,        /**< availableSeats. */
+    QUERY_DEPARTURE,    /**< departure (minute number, see dateTimeMinutes). */
+    QUERY_FIELD_COUNT   /**< Number of fields (not a field). */
+} QueryField;
+
+/**
+ * @struct QueryPredicate
+ * @brief One compiled predicate: lo <= field <= hi, or its negation.
+ */
+typedef struct {
+    QueryField field;           /**< The column tested. */
+    int lo;                     /**< Inclusive lower bound. */
+    int hi;                     /**< Inclusive upper bound. */
+    int negate;                 /**< 1 for !=: the row matches outside [lo, hi]. */
+    char text[MAX_NAME_LEN];    /**< The string for name, origin and destination (bound to a code at run time). */
+} QueryPredicate;
+
+/**
+ * @struct Query
+ * @brief A compiled query.
+ */
+typedef struct {
+    QueryPredicate predicates[QUERY_MAX_PREDICATES]; /**< The predicates, all of which must hold. */
+    int predicateCount;         /**< Number of predicates. */
+} Query;
+
+/**
+ * @enum QueryPlanKind
+ * @brief How a query was executed.
+ */
+typedef enum {
+    QUERY_PLAN_SCAN,        /**< Block scan of every row. */
+    QUERY_PLAN_ROUTE_INDEX, /**< Candidates from the route index. */
+    QUERY_PLAN_TIME_INDEX,  /**< Candidates from the time index. */
+    QUERY_PLAN_BITMAP_INDEX, /**< Candidates from the status and day bitmaps (flightindex.h). */
+    QUERY_PLAN_EMPTY        /**< A predicate can never hold (e.g., unknown origin). */
+} QueryPlanKind;
+
+/**
+ * @struct QueryPlan
+ * @brief What runQuery did, for EXPLAIN-style output.
+ */
+typedef struct {
+    QueryPlanKind kind;     /**< The access path. */
+    int candidates;         /**< Rows checked against the predicates. */
+    int matches;            /**< Rows that matched. */
+} QueryPlan;
+
+/**
+ * @enum QueryOrder
+ * @brief Result orders of runTopKQuery.
+ */
+typedef enum {
+    QUERY_ORDER_DEPARTURE,  /**< Earliest departure first. */
+    QUERY_ORDER_FULLEST     /**< Fewest free seats first, then earliest departure. */
+} QueryOrder;
+
+/**
+ * @brief Compiles query text, printing the reason if it is invalid.
+ *
+ * @param text The query text.
+ * @param query Receives the compiled query.
+ * @return 1 on success, 0 on a syntax error.
+ */
+int compileQuery(const char *text, Query *query);
+
+/**
+ * @brief Runs a compiled query over a flight table.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param query The compiled query.
+ * @param indexes Receives up to maxIndexes matching positions, in array order (may be NULL to only count).
+ * @param maxIndexes The capacity of indexes.
+ * @param plan Receives the plan and counts (may be NULL).
+ * @return The total number of matches (may exceed maxIndexes), or -1 if memory allocation failed.
+ */
+int runQuery(const Flight *flights, int flightCount, const Query *query, int *indexes, int maxIndexes, QueryPlan *plan);
+
+/**
+ * @brief Runs a compiled query and returns only its first K matches in a given order.
+ *
+ * Ties are broken by array position. plan->matches counts the matches seen,
+ * which is K when the time index walk stopped early.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param query The compiled query.
+ * @param order The result order.
+ * @param indexes Receives up to k matching positions, best first (capacity k).
+ * @param k The number of matches wanted.
+ * @param plan Receives the plan and counts (may be NULL).
+ * @return The number of positions written (at most k), or -1 if the columns could not be built.
+ */
+int runTopKQuery(const Flight *flights, int flightCount, const Query *query, QueryOrder order, int *indexes, int k,
+                 QueryPlan *plan);
+
+/**
+ * @brief Returns the minute number of a date and time, increasing with time.
+ *
+ * @param dateTime The date and time.
+ * @return Minutes counted from 1900 with 31-day months (only the order is meaningful).
+ */
+int dateTimeMinutes(const DateTime *dateTime);
+
+/**
+ * @brief Returns the display name of a plan kind.
+ *
+ * @param kind The plan kind.
+ * @return A constant string such as "route index".
+ */
+const char *queryPlanName(QueryPlanKind kind);
+
+/**
+ * @brief Frees the query columns and indexes.
+ */
+void cleanupQueryColumns();
+
+#endif // QUERY_H
@@ -0,0 +1,165 @@
+/**
+ * @file render.h
+ * @brief Header file for the buffered table renderer.
+ *
+ * Listing a large table with a handful of printf calls per record spends
+ * most of its time in format-string parsing and small stdio writes. The
+ * renderer instead formats records into one large buffer with hand-written
+ * integer and date formatting and a precomputed table of status strings, and
+ * writes the buffer out in RENDER_BUFFER_SIZE chunks.
+ *
+ * Three formats are supported:
+ *   RENDER_PLAIN  the human-readable listing of the menus
+ *   RENDER_CSV    a header row, then one row per record (RFC 4180 quoting)
+ *   RENDER_JSON   an array with one object per record and line
+ * CSV and JSON write dates as ISO 8601 ("2025-03-07T14:05") and statuses as
+ * ON_TIME, DELAYED or CANCELLED.
+ */
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdio.h>  // For FILE
+#include <stddef.h> // For size_t
+
+#include "common.h" // For Flight
+#include "passenger.h" // For Passenger
+#include "ticket.h" // For Ticket
+
+/**
+ * @def RENDER_BUFFER_SIZE
+ * @brief Bytes formatted before each write to the output stream.
+ */
+#define RENDER_BUFFER_SIZE (1 << 20)
+
+/**
+ * @enum RenderFormat
+ * @brief Output formats.
+ */
+typedef enum {
+    RENDER_PLAIN,   /**< Human-readable listing. */
+    RENDER_CSV,     /**< Comma-separated values with a header row. */
+    RENDER_JSON     /**< JSON array of objects. */
+} RenderFormat;
+
+/**
+ * @enum RenderTable
+ * @brief The kind of records being rendered (selects headers and titles).
+ */
+typedef enum {
+    RENDER_FLIGHTS,     /**< Flight records. */
+    RENDER_PASSENGERS,  /**< Passenger records. */
+    RENDER_TICKETS      /**< Ticket records. */
+} RenderTable;
+
+/**
+ * @struct Renderer
+ * @brief A listing in progress.
+ */
+typedef struct {
+    FILE *out;              /**< Destination stream. */
+    RenderFormat format;    /**< Output format. */
+    RenderTable table;      /**< Kind of records. */
+    char *buffer;           /**< RENDER_BUFFER_SIZE bytes of pending output. */
+    size_t length;          /**< Bytes pending in buffer. */
+    long long records;      /**< Records rendered so far. */
+    int failed;             /**< 1 once a write to out failed. */
+} Renderer;
+
+/**
+ * @brief Starts a listing and writes its title (plain), header row (CSV) or opening bracket (JSON).
+ *
+ * @param renderer Receives the listing state.
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param table The kind of records.
+ * @return 1 on success, 0 if the buffer could not be allocated.
+ */
+int beginRender(Renderer *renderer, FILE *out, RenderFormat format, RenderTable table);
+
+/**
+ * @brief Appends one flight.
+ *
+ * @param renderer A listing of RENDER_FLIGHTS.
+ * @param flight The flight.
+ */
+void renderFlight(Renderer *renderer, const Flight *flight);
+
+/**
+ * @brief Appends one passenger (numbered in plain format).
+ *
+ * @param renderer A listing of RENDER_PASSENGERS.
+ * @param passenger The passenger.
+ */
+void renderPassenger(Renderer *renderer, const Passenger *passenger);
+
+/**
+ * @brief Appends one ticket.
+ *
+ * @param renderer A listing of RENDER_TICKETS.
+ * @param ticket The ticket.
+ */
+void renderTicket(Renderer *renderer, const Ticket *ticket);
+
+/**
+ * @brief Finishes the listing, writes everything pending, flushes the stream and frees the buffer.
+ *
+ * @param renderer The listing.
+ * @return 1 on success, 0 if any write failed.
+ */
+int endRender(Renderer *renderer);
+
+/**
+ * @brief Renders a whole flight table.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param flights The flights.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderFlights(FILE *out, RenderFormat format, const Flight *flights, int flightCount);
+
+/**
+ * @brief Renders selected flights, e.g. the matches of a query.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param flights The flights.
+ * @param indexes The positions of the flights to render, in order.
+ * @param count The number of positions.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderFlightSelection(FILE *out, RenderFormat format, const Flight *flights, const int *indexes, int count);
+
+/**
+ * @brief Renders a whole passenger table.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param passengers The passengers.
+ * @param passengerCount The number of passengers.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderPassengers(FILE *out, RenderFormat format, const Passenger *passengers, int passengerCount);
+
+/**
+ * @brief Renders a whole ticket table.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param tickets The tickets.
+ * @param ticketCount The number of tickets.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderTickets(FILE *out, RenderFormat format, const Ticket *tickets, int ticketCount);
+
+/**
+ * @brief Returns the usual file extension of a format.
+ *
+ * @param format The format.
+ * @return "txt", "csv" or "json".
+ */
+const char *renderFormatExtension(RenderFormat format);
+
+#endif // RENDER_H
@@ -0,0 +1,56 @@
+/**
+ * @file reports.h
+ * @brief Header file for the nightly analytics reports (load factor, occupancy, ages, tickets per flight).
+ *
+ * writeAnalyticsReports writes four CSV files (with a header row) into a
+ * directory:
+ *   report_load_factor.csv        one row per flight: seats booked (seat map popcount), capacity and load factor
+ *   report_occupancy.csv          one row per route and departure day: flights, seats booked, capacity, occupancy
+ *
+ * A flight's capacity is its booked plus its free seats, as in the aggregate
+ * views (aggregates.h), so both report the same load factors.
+ *   report_ages.csv               passengers per 10-year age band
+ *   report_tickets_per_flight.csv one row per flight: tickets issued for it
+ *
+ * The work is split across threads. Each thread first copies the fields it
+ * needs from its range of records into flat integer columns, then
+ * aggregates those columns in tight loops (popcounts, histogram updates,
+ * hash probes) into its own partial results, which are merged at the end.
+ */
+
+#ifndef REPORTS_H
+#define REPORTS_H
+
+#include "common.h"    // For Flight
+#include "passenger.h" // For Passenger
+#include "ticket.h"    // For Ticket
+
+/**
+ * @def REPORT_MAX_THREADS
+ * @brief Upper bound on report worker threads.
+ */
+#define REPORT_MAX_THREADS 64
+
+/**
+ * @def REPORT_AGE_BANDS
+ * @brief Age bands in report_ages.csv (0-9, 10-19, ..., 90 and over).
+ */
+#define REPORT_AGE_BANDS 10
+
+/**
+ * @brief Computes the analytics reports and writes them as CSV files.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param passengers The passenger array.
+ * @param passengerCount The number of passengers.
+ * @param tickets The ticket array.
+ * @param ticketCount The number of tickets.
+ * @param directory The directory the files are written to.
+ * @param threads Worker threads (0 for one per online CPU, at most REPORT_MAX_THREADS).
+ * @return 1 on success, 0 on failure (e.g., memory allocation failed, a file could not be written).
+ */
+int writeAnalyticsReports(const Flight *flights, int flightCount, const Passenger *passengers, int passengerCount,
+                          const Ticket *tickets, int ticketCount, const char *directory, int threads);
+
+#endif // REPORTS_H
@@ -0,0 +1,179 @@
+/**
+ * @file resultcache.h
+ * @brief Header file for the versioned cache of rendered protocol responses.
+ *
+ * The server answers the same SEARCH, ROUTE, AVAIL and LIST requests many
+ * times a minute. The cache keeps the finished response text of each one,
+ * keyed by the request in a normalized form (e.g., "LIST ID - 100" for both
+ * "LIST" and "LIST ID"), so a hit is one hash lookup and a memcpy.
+ *
+ * Every response is stored with the versions of what it was computed from:
+ * a flight, a route, the set of flights, their array order or all of them.
+ * The mutation hooks (flight added or removed, flights reordered, a seat
+ * booked or cancelled, a status change) bump the versions of the flight, its
+ * route and the groups it belongs to. A response is served only if none of
+ * its versions changed. Versions live in a fixed array indexed by a hash of
+ * the key, so two keys may share a slot; that only makes extra misses.
+ *
+ * Changes made without the hooks (a reload, a table filled directly, seats
+ * synced from the shared inventory) move flightTableVersion,
+ * flightSeatVersion or flightStatusVersion past the cache, and the next
+ * lookup drops every entry.
+ */
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <stddef.h> // For size_t
+
+#include "common.h" // For Flight
+
+/**
+ * @def RESULT_CACHE_SETS
+ * @brief Hash sets of cached responses (a power of two).
+ */
+#define RESULT_CACHE_SETS 256
+
+/**
+ * @def RESULT_CACHE_WAYS
+ * @brief Responses per set; a full set replaces its least recently used one.
+ */
+#define RESULT_CACHE_WAYS 4
+
+/**
+ * @def RESULT_CACHE_KEY_LEN
+ * @brief Maximum length of a normalized request, including the terminator (longer ones are not cached).
+ */
+#define RESULT_CACHE_KEY_LEN 128
+
+/**
+ * @def RESULT_CACHE_VERSION_SLOTS
+ * @brief Version counters shared by all flights, routes and groups (a power of two).
+ */
+#define RESULT_CACHE_VERSION_SLOTS 16384
+
+/**
+ * @typedef CacheKey
+ * @brief The version slot of something a response depends on.
+ */
+typedef unsigned int CacheKey;
+
+/**
+ * @enum CacheGroup
+ * @brief Dependencies on more than one flight.
+ */
+typedef enum {
+    CACHE_ALL_FLIGHTS,  /**< Any change to any flight. */
+    CACHE_MEMBERSHIP,   /**< Flights added or removed. */
+    CACHE_ARRAY_ORDER   /**< Flights reordered in the array. */
+} CacheGroup;
+
+/**
+ * @brief Returns the key of one flight.
+ *
+ * @param flightID The ID of the flight.
+ * @return Its version slot.
+ */
+CacheKey cacheFlightKey(int flightID);
+
+/**
+ * @brief Returns the key of one route.
+ *
+ * @param origin The origin.
+ * @param destination The destination.
+ * @return Its version slot.
+ */
+CacheKey cacheRouteKey(const char *origin, const char *destination);
+
+/**
+ * @brief Returns the key of a group of flights.
+ *
+ * @param group The group.
+ * @return Its version slot.
+ */
+CacheKey cacheGroupKey(CacheGroup group);
+
+/**
+ * @brief Copies the cached response of a normalized request, if it is still valid.
+ *
+ * @param request The normalized request.
+ * @param response Receives the response text.
+ * @param size The size of response.
+ * @return 1 on a hit, 0 on a miss (not cached, stale or larger than size).
+ */
+int lookupCachedResult(const char *request, char *response, size_t size);
+
+/**
+ * @brief Returns the token to pass to storeCachedResult; take it before computing the response.
+ *
+ * @return The number of changes seen so far.
+ */
+unsigned long resultCacheToken();
+
+/**
+ * @brief Caches the response of a normalized request.
+ *
+ * Nothing is stored if any change happened since the token was taken, since
+ * the response may predate it.
+ *
+ * @param request The normalized request.
+ * @param response The response text.
+ * @param keys What the response was computed from.
+ * @param keyCount The number of keys.
+ * @param token The value resultCacheToken returned before the response was computed.
+ */
+void storeCachedResult(const char *request, const char *response, const CacheKey *keys, int keyCount,
+                       unsigned long token);
+
+/**
+ * @brief Reads the cache counters.
+ *
+ * @param hits Receives the number of hits.
+ * @param misses Receives the number of misses.
+ * @param entries Receives the number of cached responses.
+ */
+void getResultCacheCounts(long long *hits, long long *misses, int *entries);
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flight The new flight.
+ */
+void cacheFlightInserted(const Flight *flight);
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flight The flight being removed.
+ */
+void cacheFlightRemoved(const Flight *flight);
+
+/**
+ * @brief Hook: the flights were reordered. Call before incrementing flightTableVersion.
+ */
+void cacheFlightsReordered();
+
+/**
+ * @brief Hook: the status of a flight changed. Call before incrementing flightStatusVersion.
+ *
+ * @param flight The flight.
+ */
+void cacheFlightStatusChanged(const Flight *flight);
+
+/**
+ * @brief Hook: one seat of a flight was booked or cancelled.
+ *
+ * Called by claimFlightSeat and releaseFlightSeat after they increment
+ * flightSeatVersion.
+ *
+ * @param flight The flight.
+ * @param seatVersion The value flightSeatVersion was incremented to.
+ */
+void cacheSeatsChanged(const Flight *flight, unsigned long seatVersion);
+
+/**
+ * @brief Frees every cached response.
+ */
+void cleanupResultCache();
+
+#endif // RESULTCACHE_H
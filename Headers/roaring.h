@@ -0,0 +1,141 @@
+/**
+ * @file roaring.h
+ * @brief Header file for compressed (roaring-style) bitmaps of 32-bit values.
+ *
+ * A Roaring splits each value into a 16-bit key (high half) and a 16-bit low
+ * half. Values sharing a key live in one container, and containers are kept
+ * sorted by key. A container holds either a sorted array of low halves (at
+ * most ROARING_ARRAY_MAX values, 2 bytes each) or, once it grows past that,
+ * a 65536-bit bitmap (8 KiB), so sparse and dense sets both stay compact.
+ * Intersections and unions work container by container: bitmap-bitmap pairs
+ * are word-wise AND/OR, and array pairs are merges.
+ *
+ * All memory is allocated through trackedMalloc under MEM_OTHER.
+ */
+
+#ifndef ROARING_H
+#define ROARING_H
+
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint16_t, uint32_t, uint64_t
+
+/**
+ * @def ROARING_ARRAY_MAX
+ * @brief Largest array container; one more value converts it to a bitmap container.
+ */
+#define ROARING_ARRAY_MAX 4096
+
+/**
+ * @def ROARING_BITMAP_WORDS
+ * @brief 64-bit words in a bitmap container (65536 bits).
+ */
+#define ROARING_BITMAP_WORDS 1024
+
+/**
+ * @struct RoaringContainer
+ * @brief The values of one 16-bit key, as an array or a bitmap.
+ */
+typedef struct {
+    uint16_t key;       /**< High 16 bits shared by every value in the container. */
+    int cardinality;    /**< Number of values in the container (never 0). */
+    int capacity;       /**< Allocated entries of values (array containers only). */
+    uint16_t *values;   /**< Sorted low halves (array container), or NULL. */
+    uint64_t *words;    /**< Bit per low half (bitmap container), or NULL. */
+} RoaringContainer;
+
+/**
+ * @struct Roaring
+ * @brief A compressed set of 32-bit values.
+ *
+ * Initialize with initRoaring (or zero it) and release with freeRoaring.
+ */
+typedef struct {
+    RoaringContainer *containers; /**< Containers sorted by key. */
+    int count;                    /**< Containers in use. */
+    int capacity;                 /**< Allocated containers. */
+} Roaring;
+
+/**
+ * @brief Initializes an empty bitmap.
+ *
+ * @param r The bitmap.
+ */
+void initRoaring(Roaring *r);
+
+/**
+ * @brief Frees a bitmap's memory and leaves it empty.
+ *
+ * @param r The bitmap.
+ */
+void freeRoaring(Roaring *r);
+
+/**
+ * @brief Adds a value.
+ *
+ * @param r The bitmap.
+ * @param value The value.
+ * @return 1 on success (also if already present), 0 if memory allocation failed.
+ */
+int roaringAdd(Roaring *r, uint32_t value);
+
+/**
+ * @brief Removes a value if present.
+ *
+ * @param r The bitmap.
+ * @param value The value.
+ */
+void roaringRemove(Roaring *r, uint32_t value);
+
+/**
+ * @brief Tests whether a value is present.
+ *
+ * @param r The bitmap.
+ * @param value The value.
+ * @return 1 if present, 0 otherwise.
+ */
+int roaringContains(const Roaring *r, uint32_t value);
+
+/**
+ * @brief Counts the values.
+ *
+ * @param r The bitmap.
+ * @return The number of values.
+ */
+long long roaringCardinality(const Roaring *r);
+
+/**
+ * @brief Adds every value of src to dst (dst |= src).
+ *
+ * @param dst The bitmap to extend.
+ * @param src The bitmap to add.
+ * @return 1 on success, 0 if memory allocation failed (dst then holds part of the union).
+ */
+int roaringOrInPlace(Roaring *dst, const Roaring *src);
+
+/**
+ * @brief Keeps only the values of dst that are also in src (dst &= src).
+ *
+ * @param dst The bitmap to narrow.
+ * @param src The bitmap to intersect with.
+ */
+void roaringAndInPlace(Roaring *dst, const Roaring *src);
+
+/**
+ * @brief Copies the values out in ascending order.
+ *
+ * @param r The bitmap.
+ * @param out Receives up to max values.
+ * @param max The capacity of out.
+ * @return The number of values written.
+ */
+int roaringToArray(const Roaring *r, uint32_t *out, int max);
+
+/**
+ * @brief Returns the bytes a bitmap occupies.
+ *
+ * @param r The bitmap.
+ * @return The bytes of its containers and their arrays or bitmaps.
+ */
+size_t roaringBytes(const Roaring *r);
+
+#endif // ROARING_H
@@ -0,0 +1,188 @@
+/**
+ * @file schedule.h
+ * @brief Header file for recurring flight schedules that are expanded into dated flights on demand.
+ *
+ * Most flights repeat: the same flight name, route and times on some days
+ * of the week across a season. Storing each day as a Flight costs a full
+ * record (names, seat map) and one of the MAX_FLIGHTS table slots per date.
+ * A schedule pattern stores the flight once, with the weekdays it operates,
+ * its validity period and its times, and stands for every dated flight it
+ * implies:
+ *   - findScheduledFlights lists the dated flights of one day without
+ *     creating anything (seat counts come from the table for the dates
+ *     already booked, and are full capacity otherwise);
+ *   - materializeScheduledFlight inserts the Flight of one date into the
+ *     table (through insertFlight) when it is first booked or changed.
+ *
+ * A pattern reserves one flight ID per day of its validity period, from
+ * firstFlightID on, so the flight of day d is firstFlightID + d whether it
+ * exists yet or not. The IDs are allocated above every flight and pattern
+ * known when the pattern is added, and scheduleAllowsFlight (bound with
+ * bindFlightIDCheck) keeps insertFlight from giving them to other flights.
+ *
+ * The interactive program allocates its flight table for MAX_FLIGHTS
+ * records up front, so dates that are never booked save table slots (and
+ * the scans, indexes and files that grow with the flight count), not heap
+ * memory of that process; scheduleMemory reports the bytes such Flight
+ * records would take.
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stddef.h> // For size_t
+
+#include "common.h"    // For Flight and DateTime
+#include "inventory.h" // For SharedInventory
+
+/**
+ * @def SCHEDULE_MAX_DAYS
+ * @brief Longest validity period of one pattern, in days.
+ */
+#define SCHEDULE_MAX_DAYS 400
+
+/**
+ * @def SCHEDULE_DAILY
+ * @brief Weekday mask of a pattern that operates every day (bit 0 = Monday ... bit 6 = Sunday).
+ */
+#define SCHEDULE_DAILY 0x7F
+
+/**
+ * @struct SchedulePattern
+ * @brief One recurring flight: where, when in the day, on which weekdays, between which dates.
+ */
+typedef struct {
+    int firstFlightID;              /**< ID of the flight on validFrom (set by addSchedulePattern). */
+    char flightName[MAX_NAME_LEN];  /**< Name or code of the flight. */
+    char origin[MAX_NAME_LEN];      /**< Departure airport. */
+    char destination[MAX_NAME_LEN]; /**< Arrival airport. */
+    DateTime validFrom;             /**< First date of the period (time ignored). */
+    DateTime validTo;               /**< Last date of the period (time ignored). */
+    int weekdays;                   /**< Days operated: bit 0 = Monday ... bit 6 = Sunday. */
+    int departureMinute;            /**< Departure, in minutes after midnight. */
+    int duration;                   /**< Minutes from departure to arrival. */
+} SchedulePattern;
+
+/**
+ * @struct ScheduledFlight
+ * @brief One dated flight of a pattern, whether it is in the flight table yet or not.
+ */
+typedef struct {
+    int flightID;                   /**< Its flight ID. */
+    const SchedulePattern *pattern; /**< The pattern (valid until the next add or remove). */
+    DateTime departure;             /**< Departure date and time. */
+    DateTime arrival;               /**< Arrival date and time. */
+    int availableSeats;             /**< Free seats (from the table if it is there). */
+    int materialized;               /**< 1 if the flight is in the table. */
+} ScheduledFlight;
+
+/**
+ * @brief Adds a recurring flight.
+ *
+ * @param flights The flight array (to allocate IDs above its flights).
+ * @param flightCount The number of flights.
+ * @param pattern The pattern; its firstFlightID is set on success.
+ * @return 1 on success, 0 on failure (e.g., bad period or times, no weekday, memory reallocation failed).
+ */
+int addSchedulePattern(const Flight *flights, int flightCount, SchedulePattern *pattern);
+
+/**
+ * @brief Removes a recurring flight (its dated flights already in the table stay).
+ *
+ * @param firstFlightID The pattern's firstFlightID.
+ * @return 1 on success, 0 if there is no such pattern.
+ */
+int removeSchedulePattern(int firstFlightID);
+
+/**
+ * @brief Lists the dated flights operating on one day.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The departure airport, or NULL for any.
+ * @param destination The arrival airport, or NULL for any.
+ * @param date The day (time ignored).
+ * @param out Receives the flights, by departure.
+ * @param maxFlights The capacity of out.
+ * @return The number of flights operating that day (may exceed maxFlights), or -1 if the flight ID index could not be built.
+ */
+int findScheduledFlights(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                         const DateTime *date, ScheduledFlight *out, int maxFlights);
+
+/**
+ * @brief Reports whether a flight may be inserted under the IDs the patterns reserve.
+ *
+ * Bind it with bindFlightIDCheck. An ID outside every pattern's range is
+ * free; an ID inside one is accepted only for that pattern's dated flight
+ * (same name, route and departure, on a weekday it operates).
+ *
+ * @param flight The flight about to be inserted.
+ * @return 1 if it may be inserted, 0 if its ID is reserved for another flight.
+ */
+int scheduleAllowsFlight(const Flight *flight);
+
+/**
+ * @brief Reports whether a pattern operates a dated flight with an ID.
+ *
+ * @param flightID The flight ID.
+ * @return 1 if it does, 0 otherwise.
+ */
+int isScheduledFlightID(int flightID);
+
+/**
+ * @brief Makes sure the dated flight with an ID is in the flight table, inserting it if needed.
+ *
+ * In shared mode the flight is also published to the segment, so bookings
+ * (which go through the segment) find it; if that fails, the insert is
+ * undone.
+ *
+ * @param flights The flight array (capacity MAX_FLIGHTS).
+ * @param flightCount A pointer to the flight count, incremented if the flight is inserted.
+ * @param flightID The flight ID.
+ * @param shared The shared inventory, or NULL if not in shared mode.
+ * @return Its position in the table; -1 if no pattern operates a flight with that ID; -2 if one does but
+ *         it could not be put in the table (e.g., the ID is taken by another flight, the table is full;
+ *         the reason is printed).
+ */
+int materializeScheduledFlight(Flight *flights, int *flightCount, int flightID, SharedInventory *shared);
+
+/**
+ * @brief Lists every pattern with the number of dated flights it stands for.
+ *
+ * @return The number of patterns listed.
+ */
+int listSchedulePatterns();
+
+/**
+ * @brief Returns the memory the patterns take and the memory their dated flights would take as Flight records.
+ *
+ * The second figure is what storing every date as a Flight would cost; the
+ * interactive program's table is preallocated for MAX_FLIGHTS records either way.
+ *
+ * @param datedBytes Receives the bytes of one Flight per dated flight.
+ * @return The bytes of the patterns.
+ */
+size_t scheduleMemory(size_t *datedBytes);
+
+/**
+ * @brief Saves the patterns to a file.
+ *
+ * @param filename The name of the file to save to.
+ * @return 1 on success, 0 on failure (e.g., file could not be opened).
+ */
+int saveSchedulePatterns(const char *filename);
+
+/**
+ * @brief Loads the patterns from a file, replacing the current ones.
+ *
+ * @param filename The name of the file to load from.
+ * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
+ */
+int loadSchedulePatterns(const char *filename);
+
+/**
+ * @brief Frees the patterns.
+ */
+void cleanupSchedulePatterns();
+
+#endif // SCHEDULE_H
@@ -0,0 +1,142 @@
+/**
+ * @file segment.h
+ * @brief Header file for multi-leg flights and their origin-destination seat inventory.
+ *
+ * A Flight has one origin, one destination and one seat map, so a flight
+ * number that stops on the way (A -> B -> C) is kept as one Flight per leg,
+ * each with its own seat map, plus a segmented flight here that lists the
+ * legs in order under the flight number. A passenger from A to C holds the
+ * same seat on every leg in between, so the seat is free from A to C only
+ * if it is free on each leg: the origin-destination seat map is the OR of
+ * the legs' seat maps, one 32-byte vector (AVX2) or two 16-byte ones (SSE2)
+ * per leg. Booking claims the seat on all of those legs or on none.
+ *
+ * Segmented flights are kept sorted by flight number. Each one remembers
+ * the table positions of its legs, which are looked up again on first use
+ * after the flight table changes.
+ */
+
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+#include "common.h" // For Flight and SEAT_MAP_BYTES
+
+/**
+ * @def SEGMENT_MAX_LEGS
+ * @brief Maximum legs of one segmented flight.
+ */
+#define SEGMENT_MAX_LEGS 16
+
+/**
+ * @struct SegmentedFlight
+ * @brief One flight number flown as consecutive legs.
+ */
+typedef struct {
+    char flightNumber[MAX_NAME_LEN];    /**< The flight number (e.g., "AI101"). */
+    int legCount;                       /**< Number of legs. */
+    int legIDs[SEGMENT_MAX_LEGS];       /**< Flight IDs of the legs, first leg first. */
+    int positions[SEGMENT_MAX_LEGS];    /**< Table positions of the legs when resolved. */
+    const Flight *table;                /**< Table the positions were resolved in. */
+    int flightCount;                    /**< The table's flight count when resolved. */
+    unsigned long version;              /**< flightTableVersion when resolved. */
+} SegmentedFlight;
+
+/**
+ * @brief Defines (or redefines) a flight number flown as consecutive legs.
+ *
+ * Every leg must exist, depart from the airport the previous leg arrives at,
+ * and depart no earlier than it arrives.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightNumber The flight number.
+ * @param legIDs The flight IDs of the legs, first leg first.
+ * @param legCount The number of legs (2 to SEGMENT_MAX_LEGS).
+ * @return 1 on success, 0 on failure (e.g., missing leg, legs not connected, memory reallocation failed).
+ */
+int defineSegmentedFlight(const Flight *flights, int flightCount, const char *flightNumber,
+                          const int *legIDs, int legCount);
+
+/**
+ * @brief Removes a segmented flight (its leg flights stay).
+ *
+ * @param flightNumber The flight number.
+ * @return 1 on success, 0 if there is no such segmented flight.
+ */
+int removeSegmentedFlight(const char *flightNumber);
+
+/**
+ * @brief Finds a segmented flight by flight number.
+ *
+ * @param flightNumber The flight number.
+ * @return A pointer to it (valid until the next define or remove), or NULL if not found.
+ */
+const SegmentedFlight *findSegmentedFlight(const char *flightNumber);
+
+/**
+ * @brief Computes the seat map of one origin-destination of a segmented flight.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightNumber The flight number.
+ * @param origin The airport the passenger boards at.
+ * @param destination The airport the passenger leaves at (a later stop).
+ * @param seatMap Receives the seat map (a seat is booked if it is booked on any leg travelled).
+ * @return The number of free seats, or -1 if the flight does not serve origin to destination or a leg no longer exists.
+ */
+int segmentSeatMap(const Flight *flights, int flightCount, const char *flightNumber, const char *origin,
+                   const char *destination, unsigned char seatMap[SEAT_MAP_BYTES]);
+
+/**
+ * @brief Books one seat from an origin to a destination of a segmented flight, on every leg in between.
+ *
+ * One ticket is issued per leg travelled. Either the seat is claimed on all
+ * of those legs or on none of them.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param passengerName The name of the passenger.
+ * @param flightNumber The flight number.
+ * @param origin The airport the passenger boards at.
+ * @param destination The airport the passenger leaves at.
+ * @param seatNo The 1-based seat number.
+ * @param ticketIDs Receives the ticket IDs, one per leg travelled (SEGMENT_MAX_LEGS entries).
+ * @return The number of tickets issued, or 0 on failure (e.g., no such origin-destination, seat taken on a leg).
+ */
+int bookSegmentSeat(const Flight *flights, int flightCount, const char *passengerName, const char *flightNumber,
+                    const char *origin, const char *destination, int seatNo, int *ticketIDs);
+
+/**
+ * @brief Lists every segmented flight with its stops.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return The number of segmented flights listed.
+ */
+int listSegmentedFlights(const Flight *flights, int flightCount);
+
+/**
+ * @brief Saves the segmented flights to a file.
+ *
+ * @param filename The name of the file to save to.
+ * @return 1 on success, 0 on failure (e.g., file could not be opened).
+ */
+int saveSegmentedFlights(const char *filename);
+
+/**
+ * @brief Loads the segmented flights from a file, replacing the current ones.
+ *
+ * The legs are checked on first use, not here, so the file may be loaded
+ * before or after the flights.
+ *
+ * @param filename The name of the file to load from.
+ * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
+ */
+int loadSegmentedFlights(const char *filename);
+
+/**
+ * @brief Frees the segmented flights.
+ */
+void cleanupSegmentedFlights();
+
+#endif // SEGMENT_H
@@ -0,0 +1,59 @@
+/**
+ * @file server.h
+ * @brief Header file for the loopback TCP server speaking the service protocol.
+ *
+ * The server listens on 127.0.0.1 only, reads newline-terminated requests on
+ * each connection and answers them with executeRequest (see service.h). Each
+ * connection is served by its own thread, so a connection's requests are
+ * handled in order while different clients proceed concurrently. POSIX only;
+ * on Windows startServer reports that server mode is unsupported.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <pthread.h> // For pthread_t
+
+/**
+ * @def SERVER_BACKLOG
+ * @brief Pending connections queued by listen().
+ */
+#define SERVER_BACKLOG 128
+
+/**
+ * @struct ServerHandle
+ * @brief A running server.
+ */
+typedef struct {
+    int listenFd;       /**< Listening socket, -1 when closed. */
+    int port;           /**< Bound port (useful when 0 was requested). */
+    int running;        /**< 1 until SHUTDOWN or stopServer. */
+    int activeConnections; /**< Connections currently being served. */
+    pthread_t acceptThread; /**< Thread accepting connections. */
+    int acceptJoinable; /**< 1 until acceptThread has been joined. */
+} ServerHandle;
+
+/**
+ * @brief Starts listening on 127.0.0.1 and accepting connections in a background thread.
+ *
+ * @param server Receives the server state; must stay valid until waitServer or stopServer returns.
+ * @param port The TCP port, or 0 for any free port (read server->port afterwards).
+ * @return 1 on success, 0 on failure (e.g., port in use, unsupported platform).
+ */
+int startServer(ServerHandle *server, int port);
+
+/**
+ * @brief Blocks until a client sends SHUTDOWN or stopServer is called, then closes the listener.
+ *
+ * @param server The server.
+ */
+void waitServer(ServerHandle *server);
+
+/**
+ * @brief Stops accepting connections and waits for open connections to finish.
+ *
+ * @param server The server.
+ */
+void stopServer(ServerHandle *server);
+
+#endif // SERVER_H
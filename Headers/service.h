@@ -0,0 +1,206 @@
+/**
+ * @file service.h
+ * @brief Header file for the thread-safe service layer and its text protocol.
+ *
+ * The core functions (findFlightIndex, issueTicket, revokeTicket, ...) assume
+ * one caller at a time. The service layer lets many threads (load-test
+ * agents, server connections) use them concurrently: read-only operations
+ * share a reader lock, and operations that change the ticket table take the
+ * writer lock. Seats themselves are still claimed atomically by the inventory,
+ * so several processes sharing a seat inventory stay consistent.
+ *
+ * executeRequest implements the one-line text protocol spoken by the
+ * loopback server:
+ *   SEARCH <flightID>                      -> OK <id> <origin> <destination> <seats> <status>
+ *   ROUTE <origin> <destination>           -> OK <count> <id> <id> ...
+ *   AVAIL <origin|*> <destination|*> <minSeats> [SEATS|DEPARTURE] [<k>]
+ *                                          -> OK <count> <id> <id> ...
+ *   AGG ROUTE <origin> <destination> | AGG DAY <YYYY-MM-DD> | AGG ALL
+ *                                          -> OK <flights> <seats sold> <seat capacity> <load factor>
+ *   LIST [ID|DEPARTURE] [<cursor> [<limit>]]
+ *                                          -> OK <count> <next cursor>, then <count> flight lines, then "."
+ *   BOOK <flightID> <seatNo> <name...>     -> OK <ticketID>
+ *   CANCEL <ticketID>                      -> OK
+ *   STATUS <flightID> <ON_TIME|DELAYED|CANCELLED>
+ *                                          -> OK
+ *   PAY <ticketID> <method> <amount>       -> OK
+ *   ITINERARY <ticketID> [<ticketID> ...]  -> OK <count>, then <count> ticket lines, then "."
+ *   CACHE                                  -> OK <hits> <misses> <cached responses>
+ *   SHUTDOWN                               -> OK (the server stops accepting)
+ * Failures answer "ERR <reason>". Every response line ends with '\n'.
+ * LIST pages in flight ID (default) or departure order: a request without a
+ * cursor returns the first page, and sending back the returned cursor returns
+ * the next one, until the cursor is "end" (see page.h).
+ * AVAIL counts the flights with at least minSeats free seats on a route ("* *"
+ * for all) and returns the first k (default and cap SERVICE_ROUTE_LIMIT) by
+ * free seats (default) or by departure (see availability.h).
+ * ITINERARY resolves up to SERVICE_ITINERARY_LIMIT tickets and their flights
+ * with one batched lookup each (see idindex.h); unknown tickets are left out.
+ * Successful SEARCH, ROUTE, AVAIL and LIST responses are cached and served
+ * again until a flight they were computed from changes (see resultcache.h).
+ */
+
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <stddef.h> // For size_t
+
+#include "common.h" // For Flight and MAX_NAME_LEN
+#include "page.h" // For PageCursor
+#include "availability.h" // For AvailOrder
+#include "aggregates.h" // For AggregateView
+
+/**
+ * @def SERVICE_LIST_LIMIT
+ * @brief Maximum flights rendered by one LIST page (also the default page size).
+ */
+#define SERVICE_LIST_LIMIT 100
+
+/**
+ * @def SERVICE_ROUTE_LIMIT
+ * @brief Maximum flight IDs returned by one ROUTE or AVAIL.
+ */
+#define SERVICE_ROUTE_LIMIT 16
+
+/**
+ * @def SERVICE_ITINERARY_LIMIT
+ * @brief Maximum tickets resolved by one ITINERARY.
+ */
+#define SERVICE_ITINERARY_LIMIT 32
+
+/**
+ * @def SERVICE_RESPONSE_SIZE
+ * @brief Buffer size large enough for any response, including a full LIST.
+ */
+#define SERVICE_RESPONSE_SIZE (64 + SERVICE_LIST_LIMIT * (3 * MAX_NAME_LEN + 64))
+
+/**
+ * @brief Binds the flight table the service operates on.
+ *
+ * The ticket system must be bound to the same table (bindTicketInventory)
+ * so bookings claim seats.
+ *
+ * @param flights A pointer to the caller's flight array pointer.
+ * @param flightCount A pointer to the caller's flight count.
+ */
+void bindService(Flight **flights, int *flightCount);
+
+/**
+ * @brief Copies a flight by ID.
+ *
+ * @param flightID The ID of the flight.
+ * @param out Receives a copy of the flight.
+ * @return 1 if found, 0 otherwise.
+ */
+int serviceSearchFlight(int flightID, Flight *out);
+
+/**
+ * @brief Finds the flights on a route.
+ *
+ * @param origin The origin.
+ * @param destination The destination.
+ * @param flightIDs Receives up to maxIDs flight IDs.
+ * @param maxIDs The capacity of flightIDs.
+ * @return The total number of flights on the route.
+ */
+int serviceFindRoute(const char *origin, const char *destination, int *flightIDs, int maxIDs);
+
+/**
+ * @brief Finds the flights with at least a number of free seats.
+ *
+ * @param origin The origin, or NULL for every route.
+ * @param destination The destination (ignored if origin is NULL).
+ * @param minSeats The free seats needed.
+ * @param order The order of the returned flights.
+ * @param flightIDs Receives up to maxIDs flight IDs in that order.
+ * @param maxIDs The capacity of flightIDs (capped at SERVICE_ROUTE_LIMIT).
+ * @return The total number of flights with enough seats, or -1 if the index could not be built.
+ */
+int serviceFindAvailable(const char *origin, const char *destination, int minSeats, AvailOrder order,
+                         int *flightIDs, int maxIDs);
+
+/**
+ * @brief Reads the totals of a route, of a departure day or of every flight.
+ *
+ * @param origin The origin of the route, or NULL.
+ * @param destination The destination of the route (ignored if origin is NULL).
+ * @param day The departure day if origin is NULL, or NULL for every flight.
+ * @param out Receives the totals.
+ * @return 1 on success, 0 if the views could not be rebuilt.
+ */
+int serviceGetAggregate(const char *origin, const char *destination, const DateTime *day, AggregateView *out);
+
+/**
+ * @brief Renders the next page of flights, one line each, into a buffer.
+ *
+ * @param order The page order.
+ * @param cursor Where the page starts; advanced past the rendered flights.
+ * @param limit The maximum number of flights (capped at SERVICE_LIST_LIMIT).
+ * @param buffer Receives the lines.
+ * @param size The size of buffer.
+ * @return The number of flights rendered, or -1 if the page index could not be built.
+ */
+int serviceListFlights(PageOrder order, PageCursor *cursor, int limit, char *buffer, size_t size);
+
+/**
+ * @brief Books a seat on an existing flight.
+ *
+ * @param passengerName The name of the passenger.
+ * @param flightID The ID of the flight.
+ * @param seatNo The 1-based seat number.
+ * @return The new ticket ID, or 0 on failure (e.g., unknown flight, seat taken).
+ */
+int serviceBookTicket(const char *passengerName, int flightID, int seatNo);
+
+/**
+ * @brief Cancels a ticket and releases its seat.
+ *
+ * @param ticketID The ID of the ticket.
+ * @return 1 on success, 0 if the ticket was not found.
+ */
+int serviceCancelTicket(int ticketID);
+
+/**
+ * @brief Changes the status of a flight.
+ *
+ * @param flightID The ID of the flight.
+ * @param status The new status.
+ * @return 1 on success, 0 if the flight was not found.
+ */
+int serviceSetFlightStatus(int flightID, FlightStatus status);
+
+/**
+ * @brief Pays for an existing ticket.
+ *
+ * @param ticketID The ID of the ticket.
+ * @param method The payment method.
+ * @param amount The amount to pay.
+ * @return 1 on success, 0 on failure (e.g., unknown ticket, invalid payment).
+ */
+int servicePay(int ticketID, const char *method, float amount);
+
+/**
+ * @brief Renders tickets with their flights, one line each, into a buffer.
+ *
+ * Each line reads "ticketID,flightID,origin,destination,DD-MM-YYYY HH:MM,seatNo".
+ * Tickets that do not exist, or whose flight no longer does, are left out.
+ *
+ * @param ticketIDs The IDs of the tickets.
+ * @param count The number of IDs (at most SERVICE_ITINERARY_LIMIT are used).
+ * @param buffer Receives the lines.
+ * @param size The size of buffer.
+ * @return The number of tickets rendered, or -1 if an ID index could not be built.
+ */
+int serviceGetItinerary(const int *ticketIDs, int count, char *buffer, size_t size);
+
+/**
+ * @brief Executes one protocol request line and writes its response.
+ *
+ * @param request The request line (a trailing newline is ignored).
+ * @param response Receives the response (SERVICE_RESPONSE_SIZE bytes is always enough).
+ * @param size The size of response.
+ * @return 1 if the request succeeded, 0 if it failed, -1 for SHUTDOWN.
+ */
+int executeRequest(const char *request, char *response, size_t size);
+
+#endif // SERVICE_H
@@ -0,0 +1,181 @@
+/**
+ * @file session.h
+ * @brief Header file for recording and replaying operator sessions.
+ *
+ * While recording, every core operation (insertFlight, removeFlight,
+ * searchFlight, sortFlightsByDeparture, insertPassenger, erasePassenger,
+ * issueTicket, revokeTicket, processPayment, setFlightStatus) appends one record to a compact
+ * binary log: its arguments, its result and when it started. Because the
+ * interactive menus, the server and the tools all end in these functions,
+ * the log captures exactly the work a session did, without the typing.
+ *
+ * replaySession re-executes a log against the core API, either as fast as
+ * possible or at the recorded pace, and counts calls whose result differs
+ * from the recording. Replaying against the data files the session started
+ * from reproduces it exactly (ticket IDs included), so two builds can be
+ * compared on the same real workload.
+ *
+ * Log format (integers are LEB128 varints, signed ones zigzag-encoded first;
+ * strings are a varint length followed by the bytes):
+ *   header: "FSSESS01", flight count, passenger count, ticket count at start
+ *   record: op byte, signed start-time delta in ns from the previous record,
+ *           signed result, then the op's arguments in declaration order
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "common.h" // For Flight
+
+struct Passenger;
+
+/**
+ * @enum SessionOp
+ * @brief The recorded operations (the op byte of each record).
+ */
+typedef enum {
+    SESSION_FLIGHT_ADD,         /**< insertFlight(flight). */
+    SESSION_FLIGHT_DELETE,      /**< removeFlight(flightID). */
+    SESSION_FLIGHT_SEARCH,      /**< searchFlight(flightID); the result is 1 if found. */
+    SESSION_FLIGHT_SORT,        /**< sortFlightsByDeparture(). */
+    SESSION_PASSENGER_ADD,      /**< insertPassenger(passenger). */
+    SESSION_PASSENGER_REMOVE,   /**< erasePassenger(passport). */
+    SESSION_TICKET_BOOK,        /**< issueTicket(name, flightID, seatNo); the result is the ticket ID. */
+    SESSION_TICKET_CANCEL,      /**< revokeTicket(ticketID). */
+    SESSION_PAYMENT,            /**< processPayment(method, amount). */
+    SESSION_FLIGHT_STATUS,      /**< setFlightStatus(flightID, status). */
+    SESSION_OP_COUNT            /**< Number of operations (not an operation). */
+} SessionOp;
+
+/**
+ * @struct SessionReplayStats
+ * @brief Outcome of a replay.
+ */
+typedef struct {
+    long long operations[SESSION_OP_COUNT]; /**< Calls replayed per operation. */
+    long long diverged[SESSION_OP_COUNT];   /**< Calls whose result differed from the recording. */
+    long long recordedNs;       /**< Time between the first and last recorded call. */
+    long long elapsedNs;        /**< Wall time the replay took. */
+    int complete;               /**< 0 if the log ended in a truncated or corrupt record. */
+} SessionReplayStats;
+
+/**
+ * @brief Starts recording to a new log file.
+ *
+ * The table sizes are stored in the header so a replay can warn when it
+ * starts from different data.
+ *
+ * @param filename The log file (overwritten).
+ * @param flightCount Flights loaded when recording starts.
+ * @param passengerCount Passengers loaded when recording starts.
+ * @param ticketCount Tickets loaded when recording starts.
+ * @return 1 on success, 0 on failure (e.g., already recording, file cannot be opened).
+ */
+int startSessionRecording(const char *filename, int flightCount, int passengerCount, int ticketCount);
+
+/**
+ * @brief Stops recording and closes the log.
+ *
+ * @return 1 on success, 0 if no recording was running.
+ */
+int stopSessionRecording();
+
+/**
+ * @brief Reports whether a recording is running.
+ *
+ * @return 1 if recording, 0 otherwise.
+ */
+int isSessionRecording();
+
+/**
+ * @brief Records an insertFlight call.
+ *
+ * @param flight The flight passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionFlightAdd(const Flight *flight, int result, long long start);
+
+/**
+ * @brief Records a call that takes only an ID (delete, search, cancel) or nothing (sort).
+ *
+ * @param op SESSION_FLIGHT_DELETE, SESSION_FLIGHT_SEARCH, SESSION_TICKET_CANCEL or SESSION_FLIGHT_SORT.
+ * @param id The flight or ticket ID (ignored for SESSION_FLIGHT_SORT).
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionID(SessionOp op, int id, int result, long long start);
+
+/**
+ * @brief Records an insertPassenger call.
+ *
+ * @param passenger The passenger passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionPassengerAdd(const struct Passenger *passenger, int result, long long start);
+
+/**
+ * @brief Records an erasePassenger call.
+ *
+ * @param passport The passport passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionPassengerRemove(const char *passport, int result, long long start);
+
+/**
+ * @brief Records an issueTicket call.
+ *
+ * @param passengerName The name passed in.
+ * @param flightID The flight ID passed in.
+ * @param seatNo The seat number passed in.
+ * @param ticketID The issued ticket ID, or 0.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionTicketBook(const char *passengerName, int flightID, int seatNo, int ticketID, long long start);
+
+/**
+ * @brief Records a processPayment call (stamped with the current time).
+ *
+ * @param method The method passed in.
+ * @param amount The amount passed in.
+ * @param result The call's return value.
+ */
+void logSessionPayment(const char *method, float amount, int result);
+
+/**
+ * @brief Records a setFlightStatus call.
+ *
+ * @param flightID The flight ID passed in.
+ * @param status The status passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionFlightStatus(int flightID, FlightStatus status, int result, long long start);
+
+/**
+ * @brief Re-executes a recorded session against the core API.
+ *
+ * The passenger and ticket systems must be initialized and the ticket system
+ * bound to the same flight table (bindTicketInventory). The flight table needs
+ * room for MAX_FLIGHTS entries.
+ *
+ * @param filename The log file.
+ * @param flights The flight table.
+ * @param flightCount The number of flights, updated by adds and deletes.
+ * @param paced 1 to wait between calls as recorded, 0 to replay as fast as possible.
+ * @param stats Receives the outcome.
+ * @return 1 on success, 0 if the log cannot be read or is not a session log.
+ */
+int replaySession(const char *filename, Flight *flights, int *flightCount, int paced, SessionReplayStats *stats);
+
+/**
+ * @brief Returns the display name of an operation.
+ *
+ * @param op The operation.
+ * @return A constant string such as "issueTicket".
+ */
+const char *sessionOpName(SessionOp op);
+
+#endif // SESSION_H
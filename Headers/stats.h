@@ -0,0 +1,145 @@
+/**
+ * @file stats.h
+ * @brief Header file for per-operation latency histograms.
+ *
+ * Every core operation (add, search, delete, sort, book, cancel, load and
+ * save) records its latency into an HDR-style log-bucketed histogram. Each
+ * thread records into its own set of histograms without locking; the sets
+ * are merged only when statistics are requested.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+/**
+ * @enum StatOp
+ * @brief Operations whose latency is recorded.
+ */
+typedef enum {
+    STAT_FLIGHT_ADD,        /**< insertFlight (core of addFlight). */
+    STAT_FLIGHT_SEARCH,     /**< searchFlight. */
+    STAT_FLIGHT_DELETE,     /**< removeFlight (core of deleteFlight). */
+    STAT_FLIGHT_SORT,       /**< sortFlightsByDeparture. */
+    STAT_FLIGHT_QUERY,      /**< runQuery. */
+    STAT_FLIGHT_STATUS,     /**< setFlightStatus. */
+    STAT_PASSENGER_ADD,     /**< insertPassenger (core of addPassenger). */
+    STAT_PASSENGER_REMOVE,  /**< erasePassenger (core of removePassenger). */
+    STAT_TICKET_BOOK,       /**< issueTicket (core of bookTicket). */
+    STAT_TICKET_CANCEL,     /**< revokeTicket (core of cancelTicket). */
+    STAT_LOAD_FLIGHTS,      /**< loadFlights. */
+    STAT_LOAD_PASSENGERS,   /**< loadPassengers. */
+    STAT_LOAD_TICKETS,      /**< loadTickets. */
+    STAT_SAVE_FLIGHTS,      /**< saveFlights. */
+    STAT_SAVE_PASSENGERS,   /**< savePassengers. */
+    STAT_SAVE_TICKETS,      /**< saveTickets. */
+    STAT_OP_COUNT           /**< Number of operations (not an operation). */
+} StatOp;
+
+/**
+ * @def STAT_SUB_BUCKET_BITS
+ * @brief log2 of the number of linear sub-buckets per power of two (16 → about 6% resolution).
+ */
+#define STAT_SUB_BUCKET_BITS 4
+
+/**
+ * @def STAT_MAX_EXPONENT
+ * @brief Largest power of two tracked; longer latencies (about 39 hours) land in the last bucket.
+ */
+#define STAT_MAX_EXPONENT 47
+
+/**
+ * @def STAT_BUCKETS
+ * @brief Number of buckets in one histogram.
+ */
+#define STAT_BUCKETS ((STAT_MAX_EXPONENT - STAT_SUB_BUCKET_BITS + 2) << STAT_SUB_BUCKET_BITS)
+
+/**
+ * @struct LatencySummary
+ * @brief Merged view of one operation's histogram across all threads.
+ */
+typedef struct {
+    long long count;    /**< Number of recorded operations. */
+    long long p50;      /**< Median latency in nanoseconds. */
+    long long p90;      /**< 90th percentile latency in nanoseconds. */
+    long long p99;      /**< 99th percentile latency in nanoseconds. */
+    long long p999;     /**< 99.9th percentile latency in nanoseconds. */
+    long long max;      /**< Largest recorded latency in nanoseconds (bucket upper bound). */
+} LatencySummary;
+
+/**
+ * @struct LatencyHistogram
+ * @brief A standalone histogram with the same buckets, for callers that keep
+ * their own (e.g., one per load-test step).
+ */
+typedef struct {
+    long long buckets[STAT_BUCKETS]; /**< Bucket counts. */
+} LatencyHistogram;
+
+/**
+ * @brief Adds one latency to a standalone histogram (not thread-safe).
+ *
+ * @param histogram The histogram.
+ * @param nanos The latency in nanoseconds.
+ */
+void histogramRecord(LatencyHistogram *histogram, long long nanos);
+
+/**
+ * @brief Adds every count of one histogram into another.
+ *
+ * @param into The histogram receiving the counts.
+ * @param from The histogram to add.
+ */
+void histogramMerge(LatencyHistogram *into, const LatencyHistogram *from);
+
+/**
+ * @brief Computes count and percentiles of a standalone histogram.
+ *
+ * @param histogram The histogram.
+ * @param summary Receives the counts and percentiles.
+ * @return 1 if the histogram holds at least one value, 0 otherwise.
+ */
+int histogramSummarize(const LatencyHistogram *histogram, LatencySummary *summary);
+
+/**
+ * @brief Records one operation's latency in the calling thread's histogram.
+ *
+ * Lock-free: only the calling thread writes its histograms.
+ *
+ * @param op The operation.
+ * @param nanos The latency in nanoseconds.
+ */
+void recordLatency(StatOp op, long long nanos);
+
+/**
+ * @brief Merges every thread's histogram of an operation and computes its percentiles.
+ *
+ * @param op The operation.
+ * @param summary Receives the merged counts and percentiles.
+ * @return 1 if the operation was recorded at least once, 0 otherwise.
+ */
+int summarizeLatency(StatOp op, LatencySummary *summary);
+
+/**
+ * @brief Clears every thread's histograms.
+ *
+ * Counts recorded concurrently may survive the reset; call it while no other
+ * thread is recording for an exact restart.
+ */
+void resetLatencyStats();
+
+/**
+ * @brief Returns the display name of an operation.
+ *
+ * @param op The operation.
+ * @return A constant string such as "bookTicket".
+ */
+const char *statOpName(StatOp op);
+
+/**
+ * @brief Prints count and p50/p90/p99/p999 for every recorded operation.
+ *
+ * @return 1 on success, 0 if nothing has been recorded yet.
+ */
+int printLatencyStats();
+
+#endif // STATS_H
@@ -11,6 +11,7 @@
 #define TICKET_H
 
 #include "common.h" // Ensure common.h is included here for MAX_NAME_LEN
+#include "inventory.h" // For SharedInventory
 
 /**
  * @struct Ticket
@@ -38,6 +39,11 @@ extern int globalTicketCount;
  * @brief Maximum capacity of the globalTickets array before reallocation is needed.
  */
 extern int globalTicketCapacity;
+/**
+ * @var ticketTableVersion
+ * @brief Incremented whenever tickets are issued, revoked or reloaded (indexes compare it to detect stale state).
+ */
+extern unsigned long ticketTableVersion;
 
 /**
  * @def INITIAL_TICKET_CAPACITY
@@ -55,13 +61,87 @@ extern int globalTicketCapacity;
  */
 int initializeTickets();
 
+/**
+ * @brief Binds the ticket system to the flight inventory it books against.
+ *
+ * Once bound, booking checks that the flight exists and atomically claims the
+ * seat in its seat map, and cancelling releases it. When a shared inventory is
+ * given, seats are claimed in the shared segment instead of the local table.
+ *
+ * @param flights A pointer to the caller's Flight array pointer (may be reallocated by loadFlights).
+ * @param flightCount A pointer to the caller's flight count.
+ * @param shared A pointer to an attached shared inventory, or NULL for a process-local inventory.
+ */
+void bindTicketInventory(Flight **flights, int *flightCount, SharedInventory *shared);
+
+/**
+ * @brief Finds the position of a ticket by its ID.
+ *
+ * Unknown IDs are usually rejected by the ticket filter without a scan.
+ *
+ * @param ticketID The ID of the ticket to look up.
+ * @return The index of the ticket in globalTickets, or -1 if not found.
+ */
+int findTicketIndex(int ticketID);
+
+/**
+ * @brief Books a ticket without prompting.
+ *
+ * This is the non-interactive core of bookTicket. If an inventory is bound,
+ * the flight must exist and the seat is claimed atomically.
+ *
+ * @param passengerName The name of the passenger holding the ticket.
+ * @param flightID The ID of the flight to book on.
+ * @param seatNo The 1-based seat number to book.
+ * @return The new ticket ID on success, 0 on failure (e.g., seat unavailable, memory reallocation failed).
+ */
+int issueTicket(const char *passengerName, int flightID, int seatNo);
+
+/**
+ * @brief Books the same seat on several flights (the legs of one trip) without prompting, one ticket per flight.
+ *
+ * If an inventory is bound, every flight must exist and the seat is claimed
+ * on all of them or on none (claimFlightSeats) before any ticket is recorded.
+ *
+ * @param passengerName The name of the passenger holding the tickets.
+ * @param flightIDs The IDs of the flights.
+ * @param count The number of flights.
+ * @param seatNo The 1-based seat number to book.
+ * @param ticketIDs Receives the new ticket IDs, one per flight.
+ * @return count on success, 0 on failure (e.g., seat unavailable on a flight, memory reallocation failed).
+ */
+int issueLegTickets(const char *passengerName, const int *flightIDs, int count, int seatNo, int *ticketIDs);
+
+/**
+ * @brief Cancels a ticket by its ID without prompting.
+ *
+ * This is the non-interactive core of cancelTicket. With a shared inventory,
+ * a copy of a ticket that another process already cancelled is dropped
+ * without releasing the seat.
+ *
+ * @param ticketID The ID of the ticket to cancel.
+ * @return 1 on success, 0 if the ticket was not found or was already cancelled by another process.
+ */
+int revokeTicket(int ticketID);
+
+/**
+ * @brief Counts the tickets booked on a flight.
+ *
+ * This is the scan performed by seatManagement, without the output.
+ *
+ * @param flightID The ID of the flight.
+ * @return The number of tickets whose flightID matches.
+ */
+int countFlightTickets(int flightID);
+
 /**
  * @brief Books a new ticket for a passenger on a specific flight and seat.
  *
  * This function prompts for passenger name, flight ID, and seat number.
  * It assigns a unique ticket ID and dynamically reallocates memory if needed.
+ * If an inventory is bound, the seat is claimed atomically on the flight.
  *
- * @return 1 on success, 0 on failure (e.g., ticket limit reached, invalid input, memory reallocation failed).
+ * @return 1 on success, 0 on failure (e.g., invalid input, seat unavailable, memory reallocation failed).
  */
 int bookTicket();
 
@@ -111,6 +191,18 @@ void cleanupTickets();
  */
 int saveTickets(const char *filename);
 
+/**
+ * @brief Merges this process's bookings and cancellations into a ticket file other processes also save to.
+ *
+ * Used instead of saveTickets with a shared inventory: the file is locked,
+ * re-read and rewritten with the tickets cancelled here removed and the
+ * ones booked here added, so tickets booked by other processes are kept.
+ *
+ * @param filename The name of the shared ticket file.
+ * @return 1 on success, 0 on failure (e.g., file cannot be opened or locked, memory allocation error).
+ */
+int saveSharedTickets(const char *filename);
+
 /**
  * @brief Loads ticket data from a specified file.
  *
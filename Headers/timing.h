@@ -0,0 +1,19 @@
+/**
+ * @file timing.h
+ * @brief Header file for the monotonic clock used by benchmarks and instrumentation.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+/**
+ * @brief Reads a monotonic clock.
+ *
+ * The absolute value is meaningless; only differences between two readings
+ * are. The clock never jumps backwards when the wall clock is adjusted.
+ *
+ * @return The current reading in nanoseconds.
+ */
+long long nowNanos(void);
+
+#endif // TIMING_H
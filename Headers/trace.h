@@ -0,0 +1,85 @@
+/**
+ * @file trace.h
+ * @brief Header file for compile-time toggled hot-path tracing.
+ *
+ * Build with -DENABLE_TRACE to turn the TRACE_SCOPE macros into timestamped
+ * begin/end events recorded in per-thread ring buffers. Without the flag the
+ * macros expand to nothing and cost nothing. The recorded events can be
+ * written out on demand in Chrome Trace Event JSON (open in chrome://tracing
+ * or Perfetto).
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * @def TRACE_RING_EVENTS
+ * @brief Events kept per running thread, and for all exited threads together; when a ring is full the oldest events are overwritten.
+ */
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 65536
+#endif
+
+/**
+ * @brief Records a begin event for the calling thread.
+ *
+ * @param name A string literal naming the traced region.
+ */
+void traceBegin(const char *name);
+
+/**
+ * @brief Records an end event for the calling thread.
+ *
+ * @param name The same string literal passed to traceBegin.
+ */
+void traceEnd(const char *name);
+
+/**
+ * @brief Cleanup handler closing a TRACE_SCOPE region when its variable goes out of scope.
+ *
+ * @param name A pointer to the scope variable holding the region name.
+ */
+void traceScopeEnd(const char *const *name);
+
+/**
+ * @brief Writes every thread's recorded events as Chrome Trace Event JSON.
+ *
+ * @param filename The file to write (e.g., "trace.json").
+ * @return 1 on success, 0 on failure (e.g., tracing not compiled in, file cannot be opened).
+ */
+int dumpTrace(const char *filename);
+
+#ifdef ENABLE_TRACE
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+/**
+ * @def TRACE_SCOPE(name)
+ * @brief Traces the rest of the enclosing block: begins now, ends on every exit from the block.
+ */
+#define TRACE_SCOPE(name)                                                          \
+    const char *const TRACE_CONCAT(traceScope_, __LINE__)                          \
+        __attribute__((cleanup(traceScopeEnd), unused)) = (traceBegin(name), (name))
+
+/**
+ * @def TRACE_BEGIN(name)
+ * @brief Begins a traced region that is closed explicitly with TRACE_END.
+ */
+#define TRACE_BEGIN(name) traceBegin(name)
+
+/**
+ * @def TRACE_END(name)
+ * @brief Ends a region opened with TRACE_BEGIN.
+ */
+#define TRACE_END(name) traceEnd(name)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+
+#endif // ENABLE_TRACE
+
+#endif // TRACE_H
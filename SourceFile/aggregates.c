@@ -0,0 +1,722 @@
+/**
+ * @file aggregates.c
+ * @brief Implementation of the materialized route and day aggregates.
+ *
+ * Routes and days each live in an open-addressing hash table of rows that
+ * hold the totals. The tables only grow: a route or day whose last flight is
+ * deleted keeps a row of zeros. The hooks follow the same rule as the flight
+ * index (flightindex.c): a delta is applied only when the views match the
+ * table up to that change, otherwise the views are left stale and the next
+ * read recomputes them.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h> // For uint32_t, uint64_t, uintptr_t
+#include <pthread.h>
+
+#include "aggregates.h"
+#include "flight.h"
+#include "flightindex.h"
+#include "inventory.h"
+#include "memstats.h"
+
+/**
+ * @struct RouteRow
+ * @brief The totals of one route.
+ */
+typedef struct {
+    int used;                               /**< 1 if the slot holds a route. */
+    char origin[MAX_NAME_LEN];              /**< Origin. */
+    char destination[MAX_NAME_LEN];         /**< Destination. */
+    AggregateView view;                     /**< Totals. */
+} RouteRow;
+
+/**
+ * @struct DayRow
+ * @brief The totals of one departure day.
+ */
+typedef struct {
+    int used;               /**< 1 if the slot holds a day. */
+    int day;                /**< Day number (see departureDay). */
+    AggregateView view;     /**< Totals. */
+} DayRow;
+
+/**
+ * @struct AggregateViews
+ * @brief The route, day and overall totals of one flight table.
+ */
+typedef struct {
+    int built;                  /**< 1 once computed. */
+    const Flight *table;        /**< Table the views describe. */
+    int count;                  /**< Flights counted. */
+    unsigned long version;      /**< flightTableVersion the views match. */
+    unsigned long seatVersion;  /**< flightSeatVersion the seat counts match. */
+    RouteRow *routes;           /**< Route rows (a power-of-two number of slots). */
+    int routeSlots;             /**< Slots in routes. */
+    int routeCount;             /**< Slots in use. */
+    DayRow *days;               /**< Day rows (a power-of-two number of slots). */
+    int daySlots;               /**< Slots in days. */
+    int dayCount;               /**< Slots in use. */
+    AggregateView total;        /**< Totals over every flight. */
+} AggregateViews;
+
+static AggregateViews views;   /**< The views of the last read table. */
+static pthread_mutex_t viewsLock = PTHREAD_MUTEX_INITIALIZER; /**< Guards views. */
+
+/**
+ * @brief Returns the load factor of a group of flights.
+ *
+ * @param view The totals.
+ * @return seatsSold / seatCapacity, or 0 if the group has no seats.
+ */
+double aggregateLoadFactor(const AggregateView *view) {
+    return view->seatCapacity > 0 ? (double)view->seatsSold / (double)view->seatCapacity : 0.0;
+}
+
+/**
+ * @brief Hashes a route (FNV-1a over origin, a separator and destination).
+ *
+ * @param origin The origin.
+ * @param destination The destination.
+ * @return The hash.
+ */
+static uint32_t hashRoute(const char *origin, const char *destination) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = origin; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    hash = (hash ^ 0xFFu) * 16777619u;
+    for (const char *p = destination; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the seats sold on a flight and its capacity.
+ *
+ * Sold seats are the bits set in the seat map, counted eight bytes at a
+ * time like the reports do; the capacity adds the free seats to them.
+ *
+ * @param flight The flight.
+ * @param capacity Receives the booked plus free seats (at most MAX_PASSENGERS_PER_FLIGHT).
+ * @return The number of booked seats.
+ */
+static int seatsSold(const Flight *flight, int *capacity) {
+    int sold = 0;
+    int b = 0;
+    for (; b + 8 <= SEAT_MAP_BYTES; b += 8) {
+        uint64_t word;
+        memcpy(&word, flight->seatMap + b, sizeof(word));
+        sold += __builtin_popcountll(word);
+    }
+    for (; b < SEAT_MAP_BYTES; b++) {
+        sold += __builtin_popcount(flight->seatMap[b]);
+    }
+    int available = __atomic_load_n(&flight->availableSeats, __ATOMIC_ACQUIRE);
+    if (available < 0) {
+        available = 0;
+    } else if (available > MAX_PASSENGERS_PER_FLIGHT - sold) {
+        available = MAX_PASSENGERS_PER_FLIGHT - sold;
+    }
+    *capacity = sold + available;
+    return sold;
+}
+
+/**
+ * @brief Frees a set of views and leaves it unbuilt.
+ *
+ * @param v The views.
+ */
+static void freeViews(AggregateViews *v) {
+    trackedFree(MEM_OTHER, v->routes);
+    trackedFree(MEM_OTHER, v->days);
+    memset(v, 0, sizeof(*v));
+}
+
+/**
+ * @brief Finds a route's row.
+ *
+ * @param v The views.
+ * @param origin The origin.
+ * @param destination The destination.
+ * @return The row, or NULL if the route has none.
+ */
+static RouteRow *findRouteRow(const AggregateViews *v, const char *origin, const char *destination) {
+    uint32_t mask = (uint32_t)v->routeSlots - 1;
+    for (uint32_t i = hashRoute(origin, destination) & mask; v->routes[i].used; i = (i + 1) & mask) {
+        RouteRow *row = v->routes + i;
+        if (strcmp(row->origin, origin) == 0 && strcmp(row->destination, destination) == 0) {
+            return row;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds a day's row.
+ *
+ * @param v The views.
+ * @param day The day number.
+ * @return The row, or NULL if the day has none.
+ */
+static DayRow *findDayRow(const AggregateViews *v, int day) {
+    uint32_t mask = (uint32_t)v->daySlots - 1;
+    for (uint32_t i = ((uint32_t)day * 2654435761u) & mask; v->days[i].used; i = (i + 1) & mask) {
+        if (v->days[i].day == day) {
+            return v->days + i;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Doubles the route table once it is half full.
+ *
+ * @param v The views.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int growRoutes(AggregateViews *v) {
+    if (v->routeCount * 2 < v->routeSlots) {
+        return 1;
+    }
+    int slots = v->routeSlots * 2;
+    RouteRow *rows = (RouteRow *)trackedMalloc(MEM_OTHER, (size_t)slots * sizeof(RouteRow));
+    if (rows == NULL) {
+        return 0;
+    }
+    memset(rows, 0, (size_t)slots * sizeof(RouteRow));
+    for (int r = 0; r < v->routeSlots; r++) {
+        if (v->routes[r].used) {
+            uint32_t i = hashRoute(v->routes[r].origin, v->routes[r].destination) & (uint32_t)(slots - 1);
+            while (rows[i].used) {
+                i = (i + 1) & (uint32_t)(slots - 1);
+            }
+            rows[i] = v->routes[r];
+        }
+    }
+    trackedFree(MEM_OTHER, v->routes);
+    v->routes = rows;
+    v->routeSlots = slots;
+    return 1;
+}
+
+/**
+ * @brief Doubles the day table once it is half full.
+ *
+ * @param v The views.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int growDays(AggregateViews *v) {
+    if (v->dayCount * 2 < v->daySlots) {
+        return 1;
+    }
+    int slots = v->daySlots * 2;
+    DayRow *rows = (DayRow *)trackedMalloc(MEM_OTHER, (size_t)slots * sizeof(DayRow));
+    if (rows == NULL) {
+        return 0;
+    }
+    memset(rows, 0, (size_t)slots * sizeof(DayRow));
+    for (int d = 0; d < v->daySlots; d++) {
+        if (v->days[d].used) {
+            uint32_t i = ((uint32_t)v->days[d].day * 2654435761u) & (uint32_t)(slots - 1);
+            while (rows[i].used) {
+                i = (i + 1) & (uint32_t)(slots - 1);
+            }
+            rows[i] = v->days[d];
+        }
+    }
+    trackedFree(MEM_OTHER, v->days);
+    v->days = rows;
+    v->daySlots = slots;
+    return 1;
+}
+
+/**
+ * @brief Returns a route's row, adding a row of zeros if the route is new.
+ *
+ * @param v The views.
+ * @param origin The origin.
+ * @param destination The destination.
+ * @return The row, or NULL if memory allocation failed.
+ */
+static RouteRow *addRouteRow(AggregateViews *v, const char *origin, const char *destination) {
+    RouteRow *row = findRouteRow(v, origin, destination);
+    if (row != NULL || !growRoutes(v)) {
+        return row;
+    }
+    uint32_t mask = (uint32_t)v->routeSlots - 1;
+    uint32_t i = hashRoute(origin, destination) & mask;
+    while (v->routes[i].used) {
+        i = (i + 1) & mask;
+    }
+    row = v->routes + i;
+    row->used = 1;
+    snprintf(row->origin, MAX_NAME_LEN, "%s", origin);
+    snprintf(row->destination, MAX_NAME_LEN, "%s", destination);
+    v->routeCount++;
+    return row;
+}
+
+/**
+ * @brief Returns a day's row, adding a row of zeros if the day is new.
+ *
+ * @param v The views.
+ * @param day The day number.
+ * @return The row, or NULL if memory allocation failed.
+ */
+static DayRow *addDayRow(AggregateViews *v, int day) {
+    DayRow *row = findDayRow(v, day);
+    if (row != NULL || !growDays(v)) {
+        return row;
+    }
+    uint32_t mask = (uint32_t)v->daySlots - 1;
+    uint32_t i = ((uint32_t)day * 2654435761u) & mask;
+    while (v->days[i].used) {
+        i = (i + 1) & mask;
+    }
+    row = v->days + i;
+    row->used = 1;
+    row->day = day;
+    v->dayCount++;
+    return row;
+}
+
+/**
+ * @brief Adds a delta to one set of totals.
+ *
+ * @param view The totals.
+ * @param flights The change in flights.
+ * @param sold The change in seats sold.
+ * @param capacity The change in seat capacity.
+ */
+static void addDelta(AggregateView *view, int flights, int sold, int capacity) {
+    view->flights += flights;
+    view->seatsSold += sold;
+    view->seatCapacity += capacity;
+}
+
+/**
+ * @brief Adds a flight's seats to, or subtracts them from, its route, its day and the total.
+ *
+ * @param v The views.
+ * @param flight The flight.
+ * @param flights +1 to add the flight, -1 to subtract it.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int applyDelta(AggregateViews *v, const Flight *flight, int flights) {
+    RouteRow *route = addRouteRow(v, flight->origin, flight->destination);
+    DayRow *day = addDayRow(v, departureDay(&flight->departure));
+    if (route == NULL || day == NULL) {
+        return 0;
+    }
+    int capacity;
+    int sold = seatsSold(flight, &capacity);
+    addDelta(&route->view, flights, flights * sold, flights * capacity);
+    addDelta(&day->view, flights, flights * sold, flights * capacity);
+    addDelta(&v->total, flights, flights * sold, flights * capacity);
+    return 1;
+}
+
+/**
+ * @brief Computes a set of views from a flight table.
+ *
+ * @param v The views (freed and replaced).
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int buildViews(AggregateViews *v, const Flight *flights, int flightCount) {
+    freeViews(v);
+    v->routeSlots = 64;
+    v->daySlots = 64;
+    v->routes = (RouteRow *)trackedMalloc(MEM_OTHER, (size_t)v->routeSlots * sizeof(RouteRow));
+    v->days = (DayRow *)trackedMalloc(MEM_OTHER, (size_t)v->daySlots * sizeof(DayRow));
+    if (v->routes == NULL || v->days == NULL) {
+        freeViews(v);
+        return 0;
+    }
+    memset(v->routes, 0, (size_t)v->routeSlots * sizeof(RouteRow));
+    memset(v->days, 0, (size_t)v->daySlots * sizeof(DayRow));
+    v->seatVersion = __atomic_load_n(&flightSeatVersion, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < flightCount; i++) {
+        if (!applyDelta(v, flights + i, 1)) {
+            freeViews(v);
+            return 0;
+        }
+    }
+    v->built = 1;
+    v->table = flights;
+    v->count = flightCount;
+    v->version = flightTableVersion;
+    return 1;
+}
+
+/**
+ * @brief Tells whether the views match a table (same table, no changes missed).
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 if current, 0 if stale.
+ */
+static int isCurrent(const Flight *flights, int flightCount) {
+    return views.built && views.table == flights && views.count == flightCount &&
+           views.version == flightTableVersion &&
+           views.seatVersion == __atomic_load_n(&flightSeatVersion, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Recomputes the views if they are stale. Call with viewsLock held.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int refreshViews(const Flight *flights, int flightCount) {
+    if (isCurrent(flights, flightCount) || buildViews(&views, flights, flightCount)) {
+        return 1;
+    }
+    printf("Error: Could not allocate memory for the aggregate views.\n");
+    return 0;
+}
+
+/**
+ * @brief Reads the totals of one route.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The origin.
+ * @param destination The destination.
+ * @param out Receives the totals (all zero if no flight has that route).
+ * @return 1 on success, 0 if the views could not be rebuilt (memory allocation failed).
+ */
+int getRouteAggregate(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                      AggregateView *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&viewsLock);
+    int ok = refreshViews(flights, flightCount);
+    if (ok) {
+        const RouteRow *row = findRouteRow(&views, origin, destination);
+        if (row != NULL) {
+            *out = row->view;
+        }
+    }
+    pthread_mutex_unlock(&viewsLock);
+    return ok;
+}
+
+/**
+ * @brief Reads the totals of one departure day.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param day The day (the time of day is ignored).
+ * @param out Receives the totals (all zero if no flight departs that day).
+ * @return 1 on success, 0 if the views could not be rebuilt (memory allocation failed).
+ */
+int getDayAggregate(const Flight *flights, int flightCount, const DateTime *day, AggregateView *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&viewsLock);
+    int ok = refreshViews(flights, flightCount);
+    if (ok) {
+        const DayRow *row = findDayRow(&views, departureDay(day));
+        if (row != NULL) {
+            *out = row->view;
+        }
+    }
+    pthread_mutex_unlock(&viewsLock);
+    return ok;
+}
+
+/**
+ * @brief Reads the totals over every flight.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param out Receives the totals.
+ * @return 1 on success, 0 if the views could not be rebuilt (memory allocation failed).
+ */
+int getTotalAggregate(const Flight *flights, int flightCount, AggregateView *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&viewsLock);
+    int ok = refreshViews(flights, flightCount);
+    if (ok) {
+        *out = views.total;
+    }
+    pthread_mutex_unlock(&viewsLock);
+    return ok;
+}
+
+/**
+ * @brief Tells whether one route is busier than another (see getBusiestRoutes).
+ *
+ * @param a The first route.
+ * @param b The second route.
+ * @return 1 if a ranks before b, 0 otherwise.
+ */
+static int routeBusier(const RouteAggregate *a, const RouteAggregate *b) {
+    if (a->view.seatsSold != b->view.seatsSold) return a->view.seatsSold > b->view.seatsSold;
+    if (a->view.flights != b->view.flights) return a->view.flights > b->view.flights;
+    int order = strcmp(a->origin, b->origin);
+    return order != 0 ? order < 0 : strcmp(a->destination, b->destination) < 0;
+}
+
+/**
+ * @brief Moves a route down from the root of a bounded heap to its place.
+ *
+ * @param heap The heap, whose root is the least busy route kept (the root slot is overwritten).
+ * @param count The routes in the heap.
+ * @param route The route to place.
+ */
+static void siftDownRoute(RouteAggregate *heap, int count, const RouteAggregate *route) {
+    RouteAggregate moving = *route;
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && routeBusier(heap + child, heap + child + 1)) child++;
+        if (!routeBusier(&moving, heap + child)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = moving;
+}
+
+/**
+ * @brief Finds the routes with the most seats sold.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param out Receives up to k routes, busiest first (capacity k).
+ * @param k The number of routes wanted.
+ * @return The number of routes written, or -1 if the views could not be rebuilt (memory allocation failed).
+ */
+int getBusiestRoutes(const Flight *flights, int flightCount, RouteAggregate *out, int k) {
+    int count = 0;
+    pthread_mutex_lock(&viewsLock);
+    if (!refreshViews(flights, flightCount)) {
+        pthread_mutex_unlock(&viewsLock);
+        return -1;
+    }
+    // out is a heap of the k busiest routes so far, least busy at the root
+    for (int i = 0; i < views.routeSlots && k > 0; i++) {
+        const RouteRow *row = views.routes + i;
+        if (!row->used || row->view.flights == 0) continue;
+        RouteAggregate route;
+        memcpy(route.origin, row->origin, sizeof(route.origin));
+        memcpy(route.destination, row->destination, sizeof(route.destination));
+        route.view = row->view;
+        if (count < k) {
+            int j = count++;
+            while (j > 0 && routeBusier(out + (j - 1) / 2, &route)) {
+                out[j] = out[(j - 1) / 2];
+                j = (j - 1) / 2;
+            }
+            out[j] = route;
+        } else if (routeBusier(&route, out)) {
+            siftDownRoute(out, count, &route);
+        }
+    }
+    pthread_mutex_unlock(&viewsLock);
+
+    // Heapsort in place: the least busy route goes to the end
+    for (int n = count; n > 1; n--) {
+        RouteAggregate last = out[0];
+        siftDownRoute(out, n - 1, out + n - 1);
+        out[n - 1] = last;
+    }
+    return count;
+}
+
+/**
+ * @brief Tells whether two sets of totals differ.
+ *
+ * @param a The first totals (NULL means all zero).
+ * @param b The second totals (NULL means all zero).
+ * @return 1 if they differ, 0 if they are equal.
+ */
+static int viewsDiffer(const AggregateView *a, const AggregateView *b) {
+    static const AggregateView zero = { 0, 0, 0 };
+    if (a == NULL) a = &zero;
+    if (b == NULL) b = &zero;
+    return a->flights != b->flights || a->seatsSold != b->seatsSold || a->seatCapacity != b->seatCapacity;
+}
+
+/**
+ * @brief Prints one drifted row.
+ *
+ * @param label What the row is (e.g., "route DAC-CGP").
+ * @param kept The maintained totals (NULL if the row was missing).
+ * @param fresh The recomputed totals (NULL if the row was missing).
+ */
+static void printDrift(const char *label, const AggregateView *kept, const AggregateView *fresh) {
+    static const AggregateView zero = { 0, 0, 0 };
+    if (kept == NULL) kept = &zero;
+    if (fresh == NULL) fresh = &zero;
+    printf("Drift in %s: kept %d flights, %lld sold, %lld seats; recomputed %d flights, %lld sold, %lld seats.\n",
+           label, kept->flights, kept->seatsSold, kept->seatCapacity,
+           fresh->flights, fresh->seatsSold, fresh->seatCapacity);
+}
+
+/**
+ * @brief Recomputes the views from the flight table and compares them with the maintained ones.
+ *
+ * Views that are stale (a change was made without the hooks) are not
+ * compared: they are known to be out of date and would be recomputed by the
+ * next read anyway.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return The number of rows (routes, days and the total) that drifted, or -1 if memory allocation failed.
+ */
+int verifyAggregates(const Flight *flights, int flightCount) {
+    AggregateViews fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    pthread_mutex_lock(&viewsLock);
+    if (!buildViews(&fresh, flights, flightCount)) {
+        pthread_mutex_unlock(&viewsLock);
+        printf("Error: Could not allocate memory for the aggregate views.\n");
+        return -1;
+    }
+    int drifted = 0;
+    if (isCurrent(flights, flightCount)) {
+        char label[2 * MAX_NAME_LEN + 16];
+        for (int r = 0; r < fresh.routeSlots; r++) {
+            const RouteRow *row = fresh.routes + r;
+            const RouteRow *kept = row->used ? findRouteRow(&views, row->origin, row->destination) : NULL;
+            if (row->used && viewsDiffer(kept != NULL ? &kept->view : NULL, &row->view)) {
+                snprintf(label, sizeof(label), "route %s-%s", row->origin, row->destination);
+                printDrift(label, kept != NULL ? &kept->view : NULL, &row->view);
+                drifted++;
+            }
+        }
+        for (int r = 0; r < views.routeSlots; r++) {
+            const RouteRow *row = views.routes + r;
+            if (row->used && findRouteRow(&fresh, row->origin, row->destination) == NULL &&
+                viewsDiffer(&row->view, NULL)) {
+                snprintf(label, sizeof(label), "route %s-%s", row->origin, row->destination);
+                printDrift(label, &row->view, NULL);
+                drifted++;
+            }
+        }
+        for (int d = 0; d < fresh.daySlots; d++) {
+            const DayRow *row = fresh.days + d;
+            const DayRow *kept = row->used ? findDayRow(&views, row->day) : NULL;
+            if (row->used && viewsDiffer(kept != NULL ? &kept->view : NULL, &row->view)) {
+                snprintf(label, sizeof(label), "day %d", row->day);
+                printDrift(label, kept != NULL ? &kept->view : NULL, &row->view);
+                drifted++;
+            }
+        }
+        for (int d = 0; d < views.daySlots; d++) {
+            const DayRow *row = views.days + d;
+            if (row->used && findDayRow(&fresh, row->day) == NULL && viewsDiffer(&row->view, NULL)) {
+                snprintf(label, sizeof(label), "day %d", row->day);
+                printDrift(label, &row->view, NULL);
+                drifted++;
+            }
+        }
+        if (viewsDiffer(&views.total, &fresh.total)) {
+            printDrift("the total", &views.total, &fresh.total);
+            drifted++;
+        }
+    }
+    freeViews(&views);
+    views = fresh;
+    pthread_mutex_unlock(&viewsLock);
+    return drifted;
+}
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights, including the new one.
+ * @param flight The new flight.
+ */
+void aggregateFlightInserted(const Flight *flights, int flightCount, const Flight *flight) {
+    pthread_mutex_lock(&viewsLock);
+    if (views.built && views.table == flights && views.version == flightTableVersion &&
+        views.count == flightCount - 1) {
+        if (applyDelta(&views, flight, 1)) {
+            views.count = flightCount;
+            views.version = flightTableVersion + 1;
+        } else {
+            views.built = 0; // Recomputed on the next read
+        }
+    }
+    pthread_mutex_unlock(&viewsLock);
+}
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights once it is removed.
+ * @param flight The flight being removed (still in the array).
+ */
+void aggregateFlightRemoved(const Flight *flights, int flightCount, const Flight *flight) {
+    pthread_mutex_lock(&viewsLock);
+    if (views.built && views.table == flights && views.version == flightTableVersion &&
+        views.count == flightCount + 1) {
+        if (applyDelta(&views, flight, -1)) { // The rows exist, so this does not allocate
+            views.count = flightCount;
+            views.version = flightTableVersion + 1;
+        } else {
+            views.built = 0;
+        }
+    }
+    pthread_mutex_unlock(&viewsLock);
+}
+
+/**
+ * @brief Hook: the flights were reordered. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+void aggregateFlightsReordered(const Flight *flights, int flightCount) {
+    pthread_mutex_lock(&viewsLock);
+    if (views.built && views.table == flights && views.version == flightTableVersion &&
+        views.count == flightCount) {
+        views.version = flightTableVersion + 1; // Totals do not depend on the order
+    }
+    pthread_mutex_unlock(&viewsLock);
+}
+
+/**
+ * @brief Hook: one seat of a flight was booked or cancelled.
+ *
+ * @param flight The flight (a flight outside the table, e.g. in the shared segment, makes the views stale).
+ * @param sold +1 for a booking, -1 for a cancellation.
+ * @param seatVersion The value flightSeatVersion was incremented to.
+ */
+void aggregateSeatsChanged(const Flight *flight, int sold, unsigned long seatVersion) {
+    pthread_mutex_lock(&viewsLock);
+    // Only flights in the table are counted; a change to any other copy (such as the
+    // shared segment's) leaves the views stale until the next read recomputes them
+    uintptr_t offset = (uintptr_t)flight - (uintptr_t)views.table;
+    if (views.built && views.seatVersion == seatVersion - 1 &&
+        offset < (uintptr_t)views.count * sizeof(Flight)) {
+        RouteRow *route = findRouteRow(&views, flight->origin, flight->destination);
+        DayRow *day = findDayRow(&views, departureDay(&flight->departure));
+        if (route != NULL && day != NULL) {
+            route->view.seatsSold += sold;
+            day->view.seatsSold += sold;
+            views.total.seatsSold += sold;
+            views.seatVersion = seatVersion;
+        }
+    }
+    pthread_mutex_unlock(&viewsLock);
+}
+
+/**
+ * @brief Frees the views.
+ */
+void cleanupAggregates() {
+    pthread_mutex_lock(&viewsLock);
+    freeViews(&views);
+    pthread_mutex_unlock(&viewsLock);
+}
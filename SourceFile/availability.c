@@ -0,0 +1,528 @@
+/**
+ * @file availability.c
+ * @brief Implementation of the seat availability index.
+ *
+ * Every flight has one record, stored at its table position, with its free
+ * seats, its departure and where it sits in two buckets: one in its route's
+ * group and one in the global group (route 0). A bucket is an unordered array
+ * of table positions, so moving a flight between buckets is a swap-remove and
+ * an append; the record remembers both slots so the swap can be undone in
+ * O(1). Routes are found through a hash of origin and destination, and the
+ * hooks find a flight's record through a hash of flight IDs.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For qsort
+#include <string.h>
+#include <stdint.h> // For uint32_t, uintptr_t
+#include <pthread.h>
+
+#include "availability.h"
+#include "flight.h"
+#include "flightindex.h"
+#include "inventory.h"
+#include "memstats.h"
+
+/**
+ * @struct AvailBucket
+ * @brief The table positions of the flights in one seat-count range.
+ */
+typedef struct {
+    int *rows;          /**< Table positions, unordered. */
+    int count;          /**< Positions in use. */
+    int capacity;       /**< Allocated positions. */
+} AvailBucket;
+
+/**
+ * @struct AvailRoute
+ * @brief The buckets of one route (or of every flight, for route 0).
+ */
+typedef struct {
+    const char *origin;         /**< Origin (points into the table; NULL for route 0). */
+    const char *destination;    /**< Destination (points into the table; NULL for route 0). */
+    AvailBucket buckets[AVAIL_BUCKET_COUNT]; /**< Flights by free seats / AVAIL_BUCKET_WIDTH. */
+} AvailRoute;
+
+/**
+ * @struct AvailRecord
+ * @brief What the index knows about the flight at one table position.
+ */
+typedef struct {
+    int seats;          /**< Free seats as of the last update. */
+    int departure;      /**< Departure in minutes (day number * 1440 + minute of the day). */
+    int flightID;       /**< Flight ID (breaks ties without reading the table). */
+    int route;          /**< Route number (1 and up). */
+    int routeSlot;      /**< Slot in the route's bucket. */
+    int globalSlot;     /**< Slot in route 0's bucket. */
+} AvailRecord;
+
+/**
+ * @struct AvailIndex
+ * @brief The availability index of one flight table.
+ */
+typedef struct {
+    int built;                  /**< 1 once built. */
+    const Flight *table;        /**< Table the index describes. */
+    int count;                  /**< Flights indexed. */
+    unsigned long version;      /**< flightTableVersion when built. */
+    unsigned long seatVersion;  /**< flightSeatVersion the seat counts match. */
+    AvailRecord *records;       /**< One record per table position. */
+    AvailRoute *routes;         /**< Route 0 (every flight), then one per distinct route. */
+    int routeCount;             /**< Routes in use. */
+    int routeCapacity;          /**< Allocated routes. */
+    int *routeSlots;            /**< Open-addressing table of route number (0 = empty). */
+    int routeHashSize;          /**< Slots in routeSlots (a power of two). */
+    int *idSlots;               /**< Open-addressing table of table position + 1 (0 = empty). */
+    int idHashSize;             /**< Slots in idSlots (a power of two). */
+} AvailIndex;
+
+static AvailIndex availIndex;  /**< The index of the last searched table. */
+static pthread_mutex_t availLock = PTHREAD_MUTEX_INITIALIZER; /**< Guards availIndex. */
+
+/**
+ * @brief Returns the bucket of a free-seat count.
+ *
+ * @param seats The free seats.
+ * @return The bucket (counts outside 0..MAX_PASSENGERS_PER_FLIGHT are clamped).
+ */
+static int bucketOf(int seats) {
+    if (seats < 0) {
+        return 0;
+    }
+    if (seats > MAX_PASSENGERS_PER_FLIGHT) {
+        return AVAIL_BUCKET_COUNT - 1;
+    }
+    return seats / AVAIL_BUCKET_WIDTH;
+}
+
+/**
+ * @brief Hashes a route (FNV-1a over origin, a separator and destination).
+ *
+ * @param origin The origin.
+ * @param destination The destination.
+ * @return The hash.
+ */
+static uint32_t hashRoute(const char *origin, const char *destination) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = origin; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    hash = (hash ^ 0xFFu) * 16777619u;
+    for (const char *p = destination; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hashes a flight ID.
+ *
+ * @param flightID The flight ID.
+ * @return The hash.
+ */
+static uint32_t hashID(int flightID) {
+    return (uint32_t)flightID * 2654435761u;
+}
+
+/**
+ * @brief Frees every bucket and table and leaves the index unbuilt.
+ */
+static void freeIndex() {
+    AvailIndex *x = &availIndex;
+    for (int r = 0; r < x->routeCount; r++) {
+        for (int b = 0; b < AVAIL_BUCKET_COUNT; b++) {
+            trackedFree(MEM_OTHER, x->routes[r].buckets[b].rows);
+        }
+    }
+    trackedFree(MEM_OTHER, x->routes);
+    trackedFree(MEM_OTHER, x->records);
+    trackedFree(MEM_OTHER, x->routeSlots);
+    trackedFree(MEM_OTHER, x->idSlots);
+    memset(x, 0, sizeof(*x));
+}
+
+/**
+ * @brief Finds a route's number.
+ *
+ * @param origin The origin.
+ * @param destination The destination.
+ * @return The route number, or -1 if no flight has that route.
+ */
+static int findRoute(const char *origin, const char *destination) {
+    const AvailIndex *x = &availIndex;
+    uint32_t mask = (uint32_t)x->routeHashSize - 1;
+    for (uint32_t i = hashRoute(origin, destination) & mask; x->routeSlots[i] != 0; i = (i + 1) & mask) {
+        const AvailRoute *r = x->routes + x->routeSlots[i];
+        if (strcmp(r->origin, origin) == 0 && strcmp(r->destination, destination) == 0) {
+            return x->routeSlots[i];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Returns a route's number, adding the route if it is new.
+ *
+ * The route hash is sized for one route per flight when the index is built,
+ * so it never needs to grow.
+ *
+ * @param origin The origin (must outlive the index: it points into the table).
+ * @param destination The destination (likewise).
+ * @return The route number, or -1 if memory allocation failed.
+ */
+static int internRoute(const char *origin, const char *destination) {
+    AvailIndex *x = &availIndex;
+    uint32_t mask = (uint32_t)x->routeHashSize - 1;
+    uint32_t i = hashRoute(origin, destination) & mask;
+    for (; x->routeSlots[i] != 0; i = (i + 1) & mask) {
+        const AvailRoute *r = x->routes + x->routeSlots[i];
+        if (strcmp(r->origin, origin) == 0 && strcmp(r->destination, destination) == 0) {
+            return x->routeSlots[i];
+        }
+    }
+    if (x->routeCount == x->routeCapacity) {
+        int capacity = x->routeCapacity * 2;
+        AvailRoute *grown = (AvailRoute *)trackedRealloc(MEM_OTHER, x->routes, (size_t)capacity * sizeof(AvailRoute));
+        if (grown == NULL) {
+            return -1;
+        }
+        x->routes = grown;
+        x->routeCapacity = capacity;
+    }
+    AvailRoute *r = x->routes + x->routeCount;
+    memset(r, 0, sizeof(*r));
+    r->origin = origin;
+    r->destination = destination;
+    x->routeSlots[i] = x->routeCount;
+    return x->routeCount++;
+}
+
+/**
+ * @brief Finds the table position of a flight ID.
+ *
+ * @param flightID The flight ID.
+ * @return The position, or -1 if the table has no such flight.
+ */
+static int findRow(int flightID) {
+    const AvailIndex *x = &availIndex;
+    uint32_t mask = (uint32_t)x->idHashSize - 1;
+    for (uint32_t i = hashID(flightID) & mask; x->idSlots[i] != 0; i = (i + 1) & mask) {
+        int row = x->idSlots[i] - 1;
+        if (x->table[row].flightID == flightID) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Appends a table position to a bucket.
+ *
+ * @param bucket The bucket.
+ * @param row The table position.
+ * @return Its slot in the bucket, or -1 if memory allocation failed.
+ */
+static int pushRow(AvailBucket *bucket, int row) {
+    if (bucket->count == bucket->capacity) {
+        int capacity = bucket->capacity > 0 ? bucket->capacity * 2 : 8;
+        int *grown = (int *)trackedRealloc(MEM_OTHER, bucket->rows, (size_t)capacity * sizeof(int));
+        if (grown == NULL) {
+            return -1;
+        }
+        bucket->rows = grown;
+        bucket->capacity = capacity;
+    }
+    bucket->rows[bucket->count] = row;
+    return bucket->count++;
+}
+
+/**
+ * @brief Removes the entry at a slot by moving the bucket's last entry into it.
+ *
+ * @param bucket The bucket.
+ * @param slot The slot to empty.
+ * @param global 1 for a route 0 bucket (the moved record's globalSlot changes), 0 otherwise.
+ */
+static void removeSlot(AvailBucket *bucket, int slot, int global) {
+    int last = bucket->rows[--bucket->count];
+    if (slot < bucket->count) {
+        bucket->rows[slot] = last;
+        if (global) {
+            availIndex.records[last].globalSlot = slot;
+        } else {
+            availIndex.records[last].routeSlot = slot;
+        }
+    }
+}
+
+/**
+ * @brief Puts a record into the buckets of its seat count.
+ *
+ * @param row The table position.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int placeRecord(int row) {
+    AvailRecord *rec = availIndex.records + row;
+    int b = bucketOf(rec->seats);
+    rec->routeSlot = pushRow(&availIndex.routes[rec->route].buckets[b], row);
+    rec->globalSlot = pushRow(&availIndex.routes[0].buckets[b], row);
+    return rec->routeSlot >= 0 && rec->globalSlot >= 0;
+}
+
+/**
+ * @brief Rebuilds the index from a flight table.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int buildIndex(const Flight *flights, int flightCount) {
+    AvailIndex *x = &availIndex;
+    freeIndex();
+    x->idHashSize = 16;
+    while (x->idHashSize < flightCount * 2 + 2) {
+        x->idHashSize *= 2;
+    }
+    x->routeHashSize = x->idHashSize; // At most one route per flight
+    x->routeCapacity = 64;
+    x->records = (AvailRecord *)trackedMalloc(MEM_OTHER, (size_t)(flightCount > 0 ? flightCount : 1) * sizeof(AvailRecord));
+    x->routes = (AvailRoute *)trackedMalloc(MEM_OTHER, (size_t)x->routeCapacity * sizeof(AvailRoute));
+    x->idSlots = (int *)trackedMalloc(MEM_OTHER, (size_t)x->idHashSize * sizeof(int));
+    x->routeSlots = (int *)trackedMalloc(MEM_OTHER, (size_t)x->routeHashSize * sizeof(int));
+    if (x->records == NULL || x->routes == NULL || x->idSlots == NULL || x->routeSlots == NULL) {
+        freeIndex();
+        return 0;
+    }
+    memset(x->idSlots, 0, (size_t)x->idHashSize * sizeof(int));
+    memset(x->routeSlots, 0, (size_t)x->routeHashSize * sizeof(int));
+    memset(x->routes, 0, sizeof(AvailRoute)); // Route 0: every flight
+    x->routeCount = 1;
+    x->table = flights;
+    x->seatVersion = __atomic_load_n(&flightSeatVersion, __ATOMIC_ACQUIRE);
+
+    uint32_t idMask = (uint32_t)x->idHashSize - 1;
+    for (int row = 0; row < flightCount; row++) {
+        const Flight *f = flights + row;
+        AvailRecord *rec = x->records + row;
+        rec->seats = __atomic_load_n(&f->availableSeats, __ATOMIC_ACQUIRE);
+        rec->departure = departureDay(&f->departure) * 1440 + (int)f->departure.hour * 60 + (int)f->departure.minute;
+        rec->flightID = f->flightID;
+        rec->route = internRoute(f->origin, f->destination);
+        if (rec->route < 0 || !placeRecord(row)) {
+            freeIndex();
+            return 0;
+        }
+        // The first row of a repeated ID wins, as in findFlightIndex
+        uint32_t i = hashID(f->flightID) & idMask;
+        while (x->idSlots[i] != 0 && flights[x->idSlots[i] - 1].flightID != f->flightID) {
+            i = (i + 1) & idMask;
+        }
+        if (x->idSlots[i] == 0) {
+            x->idSlots[i] = row + 1;
+        }
+    }
+    x->built = 1;
+    x->count = flightCount;
+    x->version = flightTableVersion;
+    return 1;
+}
+
+/**
+ * @brief Orders table positions by free seats (descending), departure, then flight ID (qsort callback).
+ *
+ * @param a A pointer to the first position.
+ * @param b A pointer to the second position.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareBySeats(const void *a, const void *b) {
+    const AvailRecord *x = availIndex.records + *(const int *)a;
+    const AvailRecord *y = availIndex.records + *(const int *)b;
+    if (x->seats != y->seats) return x->seats > y->seats ? -1 : 1;
+    if (x->departure != y->departure) return x->departure < y->departure ? -1 : 1;
+    return (x->flightID > y->flightID) - (x->flightID < y->flightID);
+}
+
+/**
+ * @brief Orders table positions by departure, then flight ID (qsort callback).
+ *
+ * @param a A pointer to the first position.
+ * @param b A pointer to the second position.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareByDeparture(const void *a, const void *b) {
+    const AvailRecord *x = availIndex.records + *(const int *)a;
+    const AvailRecord *y = availIndex.records + *(const int *)b;
+    if (x->departure != y->departure) return x->departure < y->departure ? -1 : 1;
+    return (x->flightID > y->flightID) - (x->flightID < y->flightID);
+}
+
+/**
+ * @struct AvailSelection
+ * @brief The best k table positions seen so far, in indexes[start..kept).
+ *
+ * Positions are appended unsorted until the selection is full. It is then
+ * sorted once, and each later candidate either loses to the last kept
+ * position (one comparison, the common case) or is inserted in order.
+ */
+typedef struct {
+    int *indexes;       /**< The caller's result array. */
+    int start;          /**< First position of the part being selected. */
+    int kept;           /**< End of the kept positions. */
+    int k;              /**< Capacity of indexes. */
+    int sorted;         /**< 1 once indexes[start..kept) is in order. */
+    int (*compare)(const void *, const void *); /**< The order. */
+} AvailSelection;
+
+/**
+ * @brief Offers a table position to a selection.
+ *
+ * @param s The selection.
+ * @param row The table position.
+ */
+static void offerRow(AvailSelection *s, int row) {
+    if (s->kept < s->k) {
+        s->indexes[s->kept++] = row;
+        return;
+    }
+    if (!s->sorted) {
+        qsort(s->indexes + s->start, (size_t)(s->kept - s->start), sizeof(int), s->compare);
+        s->sorted = 1;
+    }
+    if (s->compare(&row, &s->indexes[s->k - 1]) >= 0) {
+        return; // Loses to every kept position
+    }
+    int j = s->k - 1;
+    while (j > s->start && s->compare(&row, &s->indexes[j - 1]) < 0) {
+        s->indexes[j] = s->indexes[j - 1];
+        j--;
+    }
+    s->indexes[j] = row;
+}
+
+/**
+ * @brief Puts the positions kept by a selection in order.
+ *
+ * @param s The selection.
+ */
+static void finishSelection(AvailSelection *s) {
+    if (!s->sorted) {
+        qsort(s->indexes + s->start, (size_t)(s->kept - s->start), sizeof(int), s->compare);
+        s->sorted = 1;
+    }
+}
+
+/**
+ * @brief Finds the flights with at least a number of free seats, on one route or on all.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The origin, or NULL for every route.
+ * @param destination The destination (ignored if origin is NULL).
+ * @param minSeats The free seats needed (e.g., the group size).
+ * @param order The order of the returned flights.
+ * @param indexes Receives the positions of the first k flights in that order (may be NULL to only count).
+ * @param k The capacity of indexes.
+ * @return The total number of flights with enough seats (may exceed k), or -1 if memory allocation failed.
+ */
+int findAvailableFlights(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                         int minSeats, AvailOrder order, int *indexes, int k) {
+    pthread_mutex_lock(&availLock);
+    AvailIndex *x = &availIndex;
+    if (!x->built || x->table != flights || x->count != flightCount || x->version != flightTableVersion ||
+        x->seatVersion != __atomic_load_n(&flightSeatVersion, __ATOMIC_ACQUIRE)) {
+        if (!buildIndex(flights, flightCount)) {
+            pthread_mutex_unlock(&availLock);
+            printf("Error: Could not allocate memory for the availability index.\n");
+            return -1;
+        }
+    }
+    int route = origin == NULL ? 0 : findRoute(origin, destination != NULL ? destination : "");
+    if (route < 0 || minSeats > MAX_PASSENGERS_PER_FLIGHT) {
+        pthread_mutex_unlock(&availLock);
+        return 0;
+    }
+
+    // Buckets above the first hold only flights with enough seats; the first is filtered.
+    // By seats, every flight in a bucket beats every flight in the buckets below it, so
+    // each bucket is selected on its own and selection stops once k flights are kept.
+    AvailSelection s = { indexes, 0, 0, indexes != NULL ? k : 0, 0,
+                         order == AVAIL_BY_SEATS ? compareBySeats : compareByDeparture };
+    const AvailRoute *r = x->routes + route;
+    int firstBucket = bucketOf(minSeats);
+    int total = 0;
+    for (int b = AVAIL_BUCKET_COUNT - 1; b >= firstBucket; b--) {
+        const AvailBucket *bucket = r->buckets + b;
+        int filter = b == firstBucket;
+        if (s.kept == s.k && (order == AVAIL_BY_SEATS || s.k == 0)) {
+            // Nothing more can be kept: only count
+            if (!filter) {
+                total += bucket->count;
+            } else {
+                for (int i = 0; i < bucket->count; i++) {
+                    total += x->records[bucket->rows[i]].seats >= minSeats;
+                }
+            }
+            continue;
+        }
+        if (order == AVAIL_BY_SEATS) {
+            s.start = s.kept;
+            s.sorted = 0;
+        }
+        for (int i = 0; i < bucket->count; i++) {
+            int row = bucket->rows[i];
+            if (!filter || x->records[row].seats >= minSeats) {
+                total++;
+                offerRow(&s, row);
+            }
+        }
+        if (order == AVAIL_BY_SEATS) {
+            finishSelection(&s);
+        }
+    }
+    finishSelection(&s);
+    pthread_mutex_unlock(&availLock);
+    return total;
+}
+
+/**
+ * @brief Hook: a flight's free-seat count changed by one booking or cancellation.
+ *
+ * @param flight The flight (in the local table or the shared segment).
+ * @param seatVersion The value flightSeatVersion was incremented to.
+ */
+void availabilitySeatsChanged(const Flight *flight, unsigned long seatVersion) {
+    pthread_mutex_lock(&availLock);
+    AvailIndex *x = &availIndex;
+    if (x->built && x->seatVersion == seatVersion - 1) {
+        // In sync up to this change, so apply it; otherwise the next lookup rebuilds
+        // A flight in the table is its own row; one in the shared segment is found by ID
+        uintptr_t offset = (uintptr_t)flight - (uintptr_t)x->table;
+        int row = offset < (uintptr_t)x->count * sizeof(Flight) ? (int)(offset / sizeof(Flight))
+                                                                : findRow(flight->flightID);
+        if (row >= 0) {
+            AvailRecord *rec = x->records + row;
+            int seats = __atomic_load_n(&flight->availableSeats, __ATOMIC_ACQUIRE);
+            int from = bucketOf(rec->seats), to = bucketOf(seats);
+            if (from != to) {
+                removeSlot(&x->routes[rec->route].buckets[from], rec->routeSlot, 0);
+                removeSlot(&x->routes[0].buckets[from], rec->globalSlot, 1);
+            }
+            rec->seats = seats;
+            if (from != to && !placeRecord(row)) {
+                x->built = 0;
+            }
+        }
+        x->seatVersion = seatVersion;
+    }
+    pthread_mutex_unlock(&availLock);
+}
+
+/**
+ * @brief Frees the availability index.
+ */
+void cleanupAvailability() {
+    pthread_mutex_lock(&availLock);
+    freeIndex();
+    pthread_mutex_unlock(&availLock);
+}
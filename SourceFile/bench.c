@@ -0,0 +1,1422 @@
+/**
+ * @file bench.c
+ * @brief Microbenchmark harness for the Flight Management System hot paths.
+ *
+ * Builds synthetic flight, passenger and ticket tables of a given size and
+ * times the hot paths against them. Single-record operations (lookups, adds,
+ * deletes, bookings, one page of a listing, index and cache queries, journey
+ * searches) are timed one call at a time; whole-table operations (sort,
+ * load, save, listings, scans, reports) one pass at a time. Each case runs
+ * untimed warmup iterations, then timed repetitions whose median and p99 are
+ * printed and written to a JSON file for comparison between builds. With
+ * --counters (Linux), hardware counters are read around every repetition.
+ * The README lists every case.
+ *
+ * Build it separately from the interactive program, with a MAX_FLIGHTS
+ * large enough for the biggest table (see README for the full command):
+ *   gcc -O2 -pthread -DMAX_FLIGHTS=20000000 bench.c perfcounters.c \
+ *       flight.c passenger.c ticket.c ... reports.c -o bench.exe
+ *
+ * Usage:
+ *   bench.exe [--sizes 1000,100000,10000000] [--reps N] [--bulk-reps N]
+ *             [--warmup N] [--filter NAME] [--seed N] [--out FILE]
+ *             [--profile FILE] [--counters]
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For malloc, free, qsort, strtol
+#include <string.h>
+#include <errno.h>  // For errno, EACCES, EPERM
+
+#include "flight.h"
+#include "passenger.h"
+#include "ticket.h"
+#include "timing.h"
+#include "memstats.h"
+#include "profiler.h"
+#include "perfcounters.h"
+#include "render.h"
+#include "page.h"
+#include "query.h"
+#include "flightindex.h"
+#include "availability.h"
+#include "aggregates.h"
+#include "reports.h"
+#include "service.h"
+#include "resultcache.h"
+#include "idindex.h"
+#include "bloom.h"
+#include "journey.h"
+#include "segment.h"
+#include "schedule.h"
+
+/**
+ * @def BENCH_MAX_SIZES
+ * @brief Maximum number of table sizes accepted by --sizes.
+ */
+#define BENCH_MAX_SIZES 8
+
+/**
+ * @def BENCH_TICKETS_PER_FLIGHT
+ * @brief Tickets generated per flight when building ticket tables.
+ */
+#define BENCH_TICKETS_PER_FLIGHT 100
+
+/**
+ * @def BENCH_PAGE_SIZE
+ * @brief Records per page in the pagination cases.
+ */
+#define BENCH_PAGE_SIZE 50
+
+/**
+ * @def BENCH_BATCH_SIZE
+ * @brief IDs resolved per run in the batched lookup cases.
+ */
+#define BENCH_BATCH_SIZE 1000
+
+/**
+ * @def BENCH_JOURNEY_AIRPORTS
+ * @brief Airports of the daily schedule used by the journey cases (the first 10 are hubs).
+ */
+#define BENCH_JOURNEY_AIRPORTS 200
+
+/**
+ * @def BENCH_SEGMENT_LEGS
+ * @brief Legs of every multi-stop flight in the segment case.
+ */
+#define BENCH_SEGMENT_LEGS 10
+
+/**
+ * @def BENCH_SCHEDULE_DAYS
+ * @brief Days of the season (01-03-2025 to 31-08-2025) every pattern of the schedule case operates daily.
+ */
+#define BENCH_SCHEDULE_DAYS 184
+
+/**
+ * @struct BenchCase
+ * @brief One benchmarked operation and the hooks that drive it.
+ */
+typedef struct {
+    const char *name;           /**< Name reported in the results (matches the function measured). */
+    int bulk;                   /**< 1 if one run processes the whole table (uses --bulk-reps). */
+    int (*setup)(int records);  /**< Builds the tables; returns 0 to skip this size. */
+    void (*prepare)(void);      /**< Untimed work before each run (restore state, pick a key). May be NULL. */
+    void (*run)(void);          /**< The timed operation. */
+    void (*teardown)(void);     /**< Releases everything setup built. */
+} BenchCase;
+
+/**
+ * @struct BenchResult
+ * @brief Summary statistics of one case at one table size.
+ */
+typedef struct {
+    const char *name;   /**< Case name. */
+    int records;        /**< Table size. */
+    int reps;           /**< Number of timed repetitions. */
+    int skipped;        /**< 1 if setup declined this size (e.g., out of memory). */
+    double minNs;       /**< Fastest repetition. */
+    double medianNs;    /**< Median repetition. */
+    double p99Ns;       /**< 99th percentile repetition. */
+    double meanNs;      /**< Mean repetition. */
+    int counted;        /**< 1 if hardware counters were read for this case. */
+    double perOp[PERF_COUNTER_COUNT]; /**< Counter value per repetition, -1 if unavailable. */
+} BenchResult;
+
+static Flight *benchFlights = NULL;      /**< Flight table under test. */
+static int benchFlightCount = 0;         /**< Number of flights in benchFlights. */
+static Flight *pristineFlights = NULL;   /**< Unsorted copy restored before each sort run. */
+static int benchRecords = 0;             /**< Table size requested by the current setup. */
+static unsigned long long rngState = 88172645463325252ULL; /**< xorshift64 state. */
+
+static int pendingKey = 0;               /**< Key chosen by prepare for the next run. */
+static int pendingRestore = 0;           /**< 1 if the previous run removed a record that must be put back. */
+static Flight savedFlight;               /**< Flight removed by the previous deleteFlight run. */
+static Passenger savedPassenger;         /**< Passenger removed/added by the previous run. */
+static Ticket savedTicket;               /**< Ticket removed by the previous cancelTicket run. */
+static int newPassengerSerial = 0;       /**< Makes passports created by addPassenger runs unique. */
+static PageCursor pendingCursor;         /**< Cursor chosen by prepare for the next page run. */
+static int pageIndexes[BENCH_PAGE_SIZE]; /**< Positions returned by page and query runs. */
+static Query pendingQuery;               /**< Query compiled by prepare for the next query run. */
+static QueryOrder pendingOrder = QUERY_ORDER_DEPARTURE; /**< Result order of the next top-K run. */
+static FlightStatus pendingStatus = ON_TIME; /**< Status chosen by prepare for the next status run. */
+static const Flight *pendingRoute = NULL; /**< Flight whose route the next availability run searches (NULL for all). */
+static int batchIDs[BENCH_BATCH_SIZE];   /**< IDs chosen by prepare for the next batched lookup run. */
+static const Flight *batchFlights[BENCH_BATCH_SIZE]; /**< Flights returned by batched lookup runs. */
+static const Ticket *batchTickets[BENCH_BATCH_SIZE]; /**< Tickets returned by batched lookup runs. */
+static char journeyFrom[8];              /**< Origin chosen by prepare for the next journey run. */
+static char journeyTo[8];                /**< Destination chosen by prepare for the next journey run. */
+static DateTime journeyStart;            /**< Earliest departure chosen by prepare for the next journey run. */
+static DateTime journeyEnd;              /**< Latest departure of the next profile run. */
+static int segmentCount;                 /**< Multi-stop flights defined by setupSegments. */
+static char segmentNumber[16];           /**< Multi-stop flight chosen by prepare for the next run. */
+static char segmentFrom[16];             /**< Its first stop. */
+static char segmentTo[16];               /**< Its last stop. */
+static char scheduleFrom[8];             /**< Airport chosen by prepare for the next schedule run. */
+static DateTime scheduleDate;            /**< Day chosen by prepare for the next schedule run. */
+
+static volatile long long benchSink = 0; /**< Keeps results observable so calls are not optimized away. */
+
+static const char *const benchAirports[] = {
+    "DAC", "CGP", "ZYL", "CXB", "JSR", "DXB", "DOH", "SIN", "KUL", "BKK",
+    "LHR", "JFK", "CCU", "DEL", "IST", "NRT"
+}; /**< Airport codes used for generated routes. */
+
+static const char *benchFlightsFile = "bench_flights.txt";       /**< Scratch file for flight load/save. */
+static const char *benchPassengersFile = "bench_passengers.txt"; /**< Scratch file for passenger load/save. */
+static const char *benchTicketsFile = "bench_tickets.txt";       /**< Scratch file for ticket load/save. */
+static const char *benchRenderFile = "bench_render.txt";         /**< Scratch file for rendered listings. */
+
+/**
+ * @brief Returns the next pseudo-random number (xorshift64).
+ *
+ * @return A 64-bit pseudo-random value.
+ */
+static unsigned long long nextRandom(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+/**
+ * @brief Returns a pseudo-random integer in [0, bound).
+ *
+ * @param bound The exclusive upper bound (must be positive).
+ * @return A value from 0 to bound - 1.
+ */
+static int randomBelow(int bound) {
+    return (int)(nextRandom() % (unsigned long long)bound);
+}
+
+/**
+ * @brief Fills a flight with plausible synthetic data and an empty seat map.
+ *
+ * @param f A pointer to the flight to fill.
+ * @param flightID The ID to give the flight.
+ */
+static void makeFlight(Flight *f, int flightID) {
+    int airports = (int)(sizeof(benchAirports) / sizeof(benchAirports[0]));
+    int from = randomBelow(airports);
+    int to = (from + 1 + randomBelow(airports - 1)) % airports;
+
+    memset(f, 0, sizeof(*f));
+    f->flightID = flightID;
+    snprintf(f->flightName, MAX_NAME_LEN, "BG%d", flightID);
+    strcpy(f->origin, benchAirports[from]);
+    strcpy(f->destination, benchAirports[to]);
+    f->departure.day = 1 + randomBelow(28);
+    f->departure.month = 1 + randomBelow(12);
+    f->departure.year = 2025;
+    f->departure.hour = randomBelow(22);
+    f->departure.minute = randomBelow(60);
+    f->arrival = f->departure;
+    f->arrival.hour = f->departure.hour + 1 + randomBelow(23 - f->departure.hour);
+    f->status = (FlightStatus)randomBelow(3);
+    f->availableSeats = MAX_PASSENGERS_PER_FLIGHT;
+}
+
+/**
+ * @brief Fills a passenger with synthetic data and a passport derived from a serial number.
+ *
+ * @param p A pointer to the passenger to fill.
+ * @param serial Serial number that makes the passport unique.
+ * @param prefix Single-letter passport prefix keeping generated and added passports apart.
+ */
+static void makePassenger(Passenger *p, int serial, char prefix) {
+    snprintf(p->name, MAX_NAME_LEN, "Passenger %d", serial);
+    p->age = 1 + randomBelow(90);
+    snprintf(p->passport, sizeof(p->passport), "%c%09d", prefix, serial);
+    p->assignedFlightID = 0;
+    p->assignedSeatNo = 0;
+}
+
+/**
+ * @brief Builds a flight table with IDs 1..records in random order.
+ *
+ * Room for one extra flight is reserved so deleteFlight runs can put a flight back.
+ *
+ * @param records The number of flights to generate.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failed, MAX_FLIGHTS too small).
+ */
+static int buildFlights(int records) {
+    if (records >= MAX_FLIGHTS) {
+        return 0; // Rebuild with a larger -DMAX_FLIGHTS
+    }
+    benchFlights = (Flight *)trackedMalloc(MEM_FLIGHTS, (size_t)(records + 1) * sizeof(Flight));
+    if (benchFlights == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < records; i++) {
+        makeFlight(benchFlights + i, i + 1);
+    }
+    for (int i = records - 1; i > 0; i--) { // Shuffle so IDs are not positions
+        int j = randomBelow(i + 1);
+        Flight tmp = benchFlights[i];
+        benchFlights[i] = benchFlights[j];
+        benchFlights[j] = tmp;
+    }
+    benchFlightCount = records;
+    benchRecords = records;
+    flightTableVersion++; // Filled directly, not through insertFlight
+    return 1;
+}
+
+/**
+ * @brief Builds the global passenger table directly (no per-insert duplicate scan).
+ *
+ * @param records The number of passengers to generate.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failed).
+ */
+static int buildPassengers(int records) {
+    cleanupPassengers();
+    globalPassengers = (Passenger *)trackedMalloc(MEM_PASSENGERS, (size_t)(records + 1) * sizeof(Passenger));
+    if (globalPassengers == NULL) {
+        return 0;
+    }
+    for (int i = 0; i < records; i++) {
+        makePassenger(globalPassengers + i, i, 'P');
+    }
+    globalPassengerCount = records;
+    globalPassengerCapacity = records + 1;
+    benchRecords = records;
+    return 1;
+}
+
+/**
+ * @brief Builds a ticket table of the given size over records / BENCH_TICKETS_PER_FLIGHT flights.
+ *
+ * Seats 1..BENCH_TICKETS_PER_FLIGHT of every flight are booked and marked in
+ * its seat map, and the ticket system is bound to the flight table so book and
+ * cancel runs go through the seat inventory like the interactive program.
+ *
+ * @param records The number of tickets to generate.
+ * @return 1 on success, 0 on failure (e.g., memory allocation failed).
+ */
+static int buildTickets(int records) {
+    int flights = records / BENCH_TICKETS_PER_FLIGHT > 0 ? records / BENCH_TICKETS_PER_FLIGHT : 1;
+    if (!buildFlights(flights)) {
+        return 0;
+    }
+    cleanupTickets();
+    bindTicketInventory(NULL, NULL, NULL); // Generate without per-ticket flight lookups
+    char name[MAX_NAME_LEN];
+    for (int i = 0; i < records; i++) {
+        Flight *f = benchFlights + i % flights;
+        int seatNo = 1 + i / flights;
+        snprintf(name, sizeof(name), "Passenger %d", i);
+        if (issueTicket(name, f->flightID, seatNo) == 0) {
+            return 0;
+        }
+        f->seatMap[SEAT_BYTE(seatNo)] |= SEAT_MASK(seatNo);
+        f->availableSeats--;
+    }
+    bindTicketInventory(&benchFlights, &benchFlightCount, NULL);
+    benchRecords = records;
+    return 1;
+}
+
+/**
+ * @brief Frees the flight tables built by buildFlights.
+ */
+static void freeFlights(void) {
+    trackedFree(MEM_FLIGHTS, benchFlights);
+    trackedFree(MEM_FLIGHTS, pristineFlights);
+    benchFlights = NULL;
+    pristineFlights = NULL;
+    benchFlightCount = 0;
+    pendingRestore = 0;
+}
+
+/**
+ * @brief Frees all tables and unbinds the ticket inventory.
+ */
+static void freeAll(void) {
+    bindTicketInventory(NULL, NULL, NULL);
+    freeFlights();
+    cleanupPassengers();
+    cleanupTickets();
+    cleanupBloomFilters();
+    pendingRestore = 0;
+}
+
+
+/** @brief Picks a random existing flight ID for the next run. */
+static void prepareRandomFlightID(void) {
+    pendingKey = 1 + randomBelow(benchRecords);
+}
+
+/** @brief Timed: searchFlight for the chosen ID. */
+static void runSearchFlight(void) {
+    benchSink += (long long)(size_t)searchFlight(benchFlights, benchFlightCount, pendingKey);
+}
+
+
+/** @brief Timed: insertFlight with an existing ID, i.e. the addFlight duplicate check. */
+static void runAddFlightDuplicate(void) {
+    Flight probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.flightID = pendingKey; // Existing ID: insertFlight scans and rejects it
+    benchSink += insertFlight(benchFlights, &benchFlightCount, &probe);
+}
+
+
+/** @brief Puts back the flight deleted by the previous run and picks the next one to delete. */
+static void prepareDeleteFlight(void) {
+    if (pendingRestore) {
+        insertFlight(benchFlights, &benchFlightCount, &savedFlight);
+    }
+    int index = randomBelow(benchFlightCount);
+    savedFlight = benchFlights[index];
+    pendingKey = savedFlight.flightID;
+    pendingRestore = 1;
+}
+
+/** @brief Timed: removeFlight, the core of deleteFlight. */
+static void runDeleteFlight(void) {
+    benchSink += removeFlight(benchFlights, &benchFlightCount, pendingKey);
+}
+
+
+/** @brief Builds the flight table plus an unsorted copy to restore before each run. */
+static int setupSortFlights(int records) {
+    if (!buildFlights(records)) {
+        return 0;
+    }
+    pristineFlights = (Flight *)trackedMalloc(MEM_FLIGHTS, (size_t)records * sizeof(Flight));
+    if (pristineFlights == NULL) {
+        return 0;
+    }
+    memcpy(pristineFlights, benchFlights, (size_t)records * sizeof(Flight));
+    return 1;
+}
+
+/** @brief Restores the unsorted flight order. */
+static void prepareSortFlights(void) {
+    memcpy(benchFlights, pristineFlights, (size_t)benchFlightCount * sizeof(Flight));
+}
+
+/** @brief Timed: sortFlightsByDeparture over the whole table. */
+static void runSortFlights(void) {
+    benchSink += sortFlightsByDeparture(benchFlights, benchFlightCount);
+}
+
+
+/** @brief Drops the passenger added by the previous run and makes a new unique one. */
+static void prepareAddPassenger(void) {
+    if (pendingRestore) {
+        erasePassenger(savedPassenger.passport); // Through the API, so the passport filter stays in sync
+    }
+    makePassenger(&savedPassenger, newPassengerSerial++, 'N');
+    pendingRestore = 1;
+}
+
+/** @brief Timed: insertPassenger, the core of addPassenger (duplicate check plus append). */
+static void runAddPassenger(void) {
+    benchSink += insertPassenger(&savedPassenger);
+}
+
+
+/** @brief Puts back the passenger removed by the previous run and picks the next one. */
+static void prepareRemovePassenger(void) {
+    if (pendingRestore) {
+        insertPassenger(&savedPassenger); // Through the API, so the passport filter stays in sync
+    }
+    savedPassenger = globalPassengers[randomBelow(globalPassengerCount)];
+    pendingRestore = 1;
+}
+
+/** @brief Timed: erasePassenger, the core of removePassenger. */
+static void runRemovePassenger(void) {
+    benchSink += erasePassenger(savedPassenger.passport);
+}
+
+/** @brief Builds the passenger table and its passport filter (buildPassengers fills the table directly). */
+static int setupPassportFilter(int records) {
+    return buildPassengers(records) && rebuildPassportFilter();
+}
+
+/** @brief Makes a passport that no passenger has for the next run. */
+static void prepareUnknownPassport(void) {
+    makePassenger(&savedPassenger, randomBelow(benchRecords), 'U');
+}
+
+/** @brief Timed: findPassengerIndex for an unknown passport (a typo or stale reference). */
+static void runFindUnknownPassport(void) {
+    benchSink += findPassengerIndex(savedPassenger.passport);
+}
+
+/** @brief Picks a ticket ID past every issued one for the next run. */
+static void prepareUnknownTicketID(void) {
+    pendingKey = globalTickets[globalTicketCount - 1].ticketID + 1 + randomBelow(benchRecords);
+}
+
+/** @brief Timed: findTicketIndex for an unknown ticket ID. */
+static void runFindUnknownTicket(void) {
+    benchSink += findTicketIndex(pendingKey);
+}
+
+
+/** @brief Cancels the ticket booked by the previous run and picks a free seat. */
+static void prepareBookTicket(void) {
+    if (pendingRestore) {
+        revokeTicket(savedTicket.ticketID);
+    }
+    const Flight *f = benchFlights + randomBelow(benchFlightCount);
+    savedTicket.flightID = f->flightID;
+    savedTicket.seatNo = BENCH_TICKETS_PER_FLIGHT + 1 +
+                         randomBelow(MAX_PASSENGERS_PER_FLIGHT - BENCH_TICKETS_PER_FLIGHT); // Always free
+    pendingRestore = 1;
+}
+
+/** @brief Timed: issueTicket, the core of bookTicket (flight lookup, seat claim, append). */
+static void runBookTicket(void) {
+    savedTicket.ticketID = issueTicket("Bench Passenger", savedTicket.flightID, savedTicket.seatNo);
+    benchSink += savedTicket.ticketID;
+}
+
+
+/** @brief Rebooks the ticket cancelled by the previous run and picks the next one. */
+static void prepareCancelTicket(void) {
+    if (pendingRestore) {
+        issueTicket(savedTicket.passengerName, savedTicket.flightID, savedTicket.seatNo);
+    }
+    savedTicket = globalTickets[randomBelow(globalTicketCount)];
+    pendingRestore = 1;
+}
+
+/** @brief Timed: revokeTicket, the core of cancelTicket. */
+static void runCancelTicket(void) {
+    benchSink += revokeTicket(savedTicket.ticketID);
+}
+
+
+/** @brief Picks a random flight of the ticket table. */
+static void prepareRandomTicketFlight(void) {
+    pendingKey = benchFlights[randomBelow(benchFlightCount)].flightID;
+    pendingStatus = (FlightStatus)randomBelow(3);
+}
+
+/** @brief Timed: countFlightTickets, the scan behind seatManagement. */
+static void runSeatManagement(void) {
+    benchSink += countFlightTickets(pendingKey);
+}
+
+
+/** @brief Timed: saveFlights of the whole table. */
+static void runSaveFlights(void) {
+    benchSink += saveFlights(benchFlights, benchFlightCount, benchFlightsFile);
+}
+
+/** @brief Builds and saves a flight table for the load runs. */
+static int setupLoadFlights(int records) {
+    return buildFlights(records) && saveFlights(benchFlights, benchFlightCount, benchFlightsFile);
+}
+
+/** @brief Timed: loadFlights of the saved table. */
+static void runLoadFlights(void) {
+    benchSink += loadFlights(&benchFlights, &benchFlightCount, benchFlightsFile);
+}
+
+/** @brief Timed: savePassengers of the whole table. */
+static void runSavePassengers(void) {
+    benchSink += savePassengers(benchPassengersFile);
+}
+
+/** @brief Builds and saves a passenger table for the load runs. */
+static int setupLoadPassengers(int records) {
+    return buildPassengers(records) && savePassengers(benchPassengersFile);
+}
+
+/** @brief Timed: loadPassengers of the saved table. */
+static void runLoadPassengers(void) {
+    benchSink += loadPassengers(benchPassengersFile);
+}
+
+/** @brief Timed: saveTickets of the whole table. */
+static void runSaveTickets(void) {
+    benchSink += saveTickets(benchTicketsFile);
+}
+
+/** @brief Builds and saves a ticket table for the load runs. */
+static int setupLoadTickets(int records) {
+    return buildTickets(records) && saveTickets(benchTicketsFile);
+}
+
+/** @brief Timed: loadTickets of the saved table. */
+static void runLoadTickets(void) {
+    benchSink += loadTickets(benchTicketsFile);
+}
+
+/**
+ * @brief Renders the whole flight table into the render scratch file.
+ *
+ * @param format The output format.
+ */
+static void renderFlightsToFile(RenderFormat format) {
+    FILE *fp = fopen(benchRenderFile, "w");
+    if (fp != NULL) {
+        benchSink += renderFlights(fp, format, benchFlights, benchFlightCount);
+        fclose(fp);
+    }
+}
+
+/** @brief Timed: listFlights output (plain rendering) of the whole table. */
+static void runListFlights(void) {
+    renderFlightsToFile(RENDER_PLAIN);
+}
+
+/** @brief Timed: CSV rendering of the whole table. */
+static void runRenderFlightsCsv(void) {
+    renderFlightsToFile(RENDER_CSV);
+}
+
+/** @brief Timed: JSON rendering of the whole table. */
+static void runRenderFlightsJson(void) {
+    renderFlightsToFile(RENDER_JSON);
+}
+
+/** @brief Starts the next page run at the first flight. */
+static void prepareFirstPage(void) {
+    initPageCursor(&pendingCursor);
+}
+
+/** @brief Starts the next page run after a random flight, i.e. at a random depth. */
+static void prepareDeepFlightPage(void) {
+    const Flight *f = benchFlights + randomBelow(benchFlightCount);
+    pageCursorAfter(&pendingCursor, departureKey(&f->departure), f->flightID);
+}
+
+/** @brief Timed: one page of flights in departure order. */
+static void runPageFlights(void) {
+    benchSink += pageFlights(benchFlights, benchFlightCount, PAGE_BY_DEPARTURE, &pendingCursor, BENCH_PAGE_SIZE, pageIndexes);
+}
+
+/** @brief Starts the next page run after a random ticket. */
+static void prepareDeepTicketPage(void) {
+    pageCursorAfter(&pendingCursor, globalTickets[randomBelow(globalTicketCount)].ticketID, 0);
+}
+
+/** @brief Timed: one page of tickets in ID order. */
+static void runPageTickets(void) {
+    benchSink += pageTickets(&pendingCursor, BENCH_PAGE_SIZE, pageIndexes);
+}
+
+/** @brief Frees all tables and the page indexes. */
+static void teardownPages(void) {
+    freeAll();
+    cleanupPageIndexes();
+}
+
+/** @brief Compiles the next query run: delayed flights with at least 4 free seats (no index applies). */
+static void prepareScanQuery(void) {
+    compileQuery("status=DELAYED AND seats>=4", &pendingQuery);
+}
+
+/** @brief Compiles the next query run: the route of a random flight (route index). */
+static void prepareRouteQuery(void) {
+    const Flight *f = benchFlights + randomBelow(benchFlightCount);
+    char text[2 * MAX_NAME_LEN + 48];
+    snprintf(text, sizeof(text), "origin=%s AND destination=%s AND seats>=4", f->origin, f->destination);
+    compileQuery(text, &pendingQuery);
+}
+
+/** @brief Compiles the next query run: the departure day of a random flight (time index). */
+static void prepareTimeQuery(void) {
+    const Flight *f = benchFlights + randomBelow(benchFlightCount);
+    char text[64];
+    snprintf(text, sizeof(text), "departure in %04d-%02d-%02d AND status!=CANCELLED",
+             f->departure.year, f->departure.month, f->departure.day);
+    compileQuery(text, &pendingQuery);
+}
+
+/** @brief Compiles the next query run: one status on the day of a random flight (status and day bitmaps). */
+static void prepareBitmapQuery(void) {
+    const Flight *f = benchFlights + randomBelow(benchFlightCount);
+    char text[64];
+    snprintf(text, sizeof(text), "status=CANCELLED AND departure in %04d-%02d-%02d",
+             f->departure.year, f->departure.month, f->departure.day);
+    compileQuery(text, &pendingQuery);
+}
+
+/** @brief Timed: one filter query, keeping the first page of matches. */
+static void runQueryFlights(void) {
+    benchSink += runQuery(benchFlights, benchFlightCount, &pendingQuery, pageIndexes, BENCH_PAGE_SIZE, NULL);
+}
+
+/** @brief Builds the flight table with random free seats for the top-K cases. */
+static int setupTopK(int records) {
+    if (!buildFlights(records)) {
+        return 0;
+    }
+    for (int i = 0; i < benchFlightCount; i++) {
+        benchFlights[i].availableSeats = randomBelow(MAX_PASSENGERS_PER_FLIGHT + 1);
+    }
+    return 1;
+}
+
+/** @brief Compiles the next top-K run: the next departures from the origin of a random flight after its departure. */
+static void prepareTopKDepartures(void) {
+    const Flight *f = benchFlights + randomBelow(benchFlightCount);
+    char text[MAX_NAME_LEN + 64];
+    snprintf(text, sizeof(text), "origin=%s AND departure>=%04d-%02d-%02dT%02d:%02d", f->origin,
+             f->departure.year, f->departure.month, f->departure.day, f->departure.hour, f->departure.minute);
+    compileQuery(text, &pendingQuery);
+    pendingOrder = QUERY_ORDER_DEPARTURE;
+}
+
+/** @brief Compiles the next top-K run: the fullest flights on the departure day of a random flight. */
+static void prepareTopKFullest(void) {
+    const Flight *f = benchFlights + randomBelow(benchFlightCount);
+    char text[64];
+    snprintf(text, sizeof(text), "departure in %04d-%02d-%02d", f->departure.year, f->departure.month, f->departure.day);
+    compileQuery(text, &pendingQuery);
+    pendingOrder = QUERY_ORDER_FULLEST;
+}
+
+/** @brief Timed: the first 20 matches of one query in the chosen order. */
+static void runTopKFlights(void) {
+    benchSink += runTopKQuery(benchFlights, benchFlightCount, &pendingQuery, pendingOrder, pageIndexes, 20, NULL);
+}
+
+/** @brief Builds the flight table and its status and day bitmaps. */
+static int setupFlightIndex(int records) {
+    return buildFlights(records) && refreshFlightIndex(benchFlights, benchFlightCount);
+}
+
+/** @brief Picks a random flight and a new status for the next run. */
+static void prepareSetFlightStatus(void) {
+    pendingKey = benchFlights[randomBelow(benchFlightCount)].flightID;
+}
+
+/** @brief Timed: one status change (the lookup plus the incremental bitmap update). */
+static void runSetFlightStatus(void) {
+    benchSink += setFlightStatus(benchFlights, benchFlightCount, pendingKey, pendingStatus);
+}
+
+/** @brief Frees all tables, the query columns and the bitmap index. */
+static void teardownQuery(void) {
+    freeAll();
+    cleanupQueryColumns();
+    cleanupFlightIndex();
+}
+
+/** @brief Builds the flight table with random free seats and its availability index. */
+static int setupAvailability(int records) {
+    if (!buildFlights(records)) {
+        return 0;
+    }
+    for (int i = 0; i < benchFlightCount; i++) {
+        benchFlights[i].availableSeats = randomBelow(MAX_PASSENGERS_PER_FLIGHT + 1);
+    }
+    return findAvailableFlights(benchFlights, benchFlightCount, NULL, NULL, 0, AVAIL_BY_SEATS, NULL, 0) >= 0;
+}
+
+/** @brief Picks the route of a random flight and a group of 1-10 seats for the next run. */
+static void prepareRouteAvailability(void) {
+    pendingRoute = benchFlights + randomBelow(benchFlightCount);
+    pendingKey = 1 + randomBelow(10);
+}
+
+/** @brief Picks a group of 1-10 seats on any route for the next run. */
+static void prepareGlobalAvailability(void) {
+    pendingRoute = NULL;
+    pendingKey = 1 + randomBelow(10);
+}
+
+/** @brief Timed: the 10 earliest flights on a route with enough seats. */
+static void runRouteAvailability(void) {
+    benchSink += findAvailableFlights(benchFlights, benchFlightCount, pendingRoute->origin, pendingRoute->destination,
+                                      pendingKey, AVAIL_BY_DEPARTURE, pageIndexes, 10);
+}
+
+/** @brief Timed: the 10 flights with the most free seats among those with enough. */
+static void runGlobalAvailability(void) {
+    benchSink += findAvailableFlights(benchFlights, benchFlightCount, NULL, NULL,
+                                      pendingKey, AVAIL_BY_SEATS, pageIndexes, 10);
+}
+
+/** @brief Frees all tables and the availability index. */
+static void teardownAvailability(void) {
+    freeAll();
+    cleanupAvailability();
+}
+
+/** @brief Builds the flight table and its route and day aggregates. */
+static int setupAggregates(int records) {
+    AggregateView view;
+    return buildFlights(records) && getTotalAggregate(benchFlights, benchFlightCount, &view);
+}
+
+/** @brief Picks the route of a random flight for the next run. */
+static void prepareRouteAggregate(void) {
+    pendingRoute = benchFlights + randomBelow(benchFlightCount);
+}
+
+/** @brief Timed: one dashboard read of a route's totals. */
+static void runRouteAggregate(void) {
+    AggregateView view;
+    getRouteAggregate(benchFlights, benchFlightCount, pendingRoute->origin, pendingRoute->destination, &view);
+    benchSink += view.seatsSold;
+}
+
+/** @brief Timed: the 10 routes with the most seats sold. */
+static void runBusiestRoutes(void) {
+    RouteAggregate routes[10];
+    benchSink += getBusiestRoutes(benchFlights, benchFlightCount, routes, 10);
+}
+
+/** @brief Timed: a full recompute of the views, compared with the maintained ones. */
+static void runVerifyAggregates(void) {
+    benchSink += verifyAggregates(benchFlights, benchFlightCount);
+}
+
+/** @brief Frees all tables and the aggregate views. */
+static void teardownAggregates(void) {
+    freeAll();
+    cleanupAggregates();
+}
+
+/** @brief Builds the ticket table with its flights, and as many passengers as tickets. */
+static int setupReports(int records) {
+    return buildTickets(records) && buildPassengers(records);
+}
+
+/** @brief Timed: all four analytics reports, computed and written to CSV. */
+static void runWriteReports(void) {
+    benchSink += writeAnalyticsReports(benchFlights, benchFlightCount, globalPassengers, globalPassengerCount,
+                                       globalTickets, globalTicketCount, ".", 0);
+}
+
+/** @brief Frees all tables and removes the report files. */
+static void teardownReports(void) {
+    freeAll();
+    remove("report_load_factor.csv");
+    remove("report_occupancy.csv");
+    remove("report_ages.csv");
+    remove("report_tickets_per_flight.csv");
+}
+
+/** @brief Frees all tables and removes the scratch files. */
+static void teardownFiles(void) {
+    freeAll();
+    remove(benchFlightsFile);
+    remove(benchPassengersFile);
+    remove(benchTicketsFile);
+    remove(benchRenderFile);
+}
+
+/** @brief Builds the flight table and serves it through the protocol layer. */
+static int setupRequests(int records) {
+    if (!buildFlights(records)) {
+        return 0;
+    }
+    bindService(&benchFlights, &benchFlightCount);
+    return 1;
+}
+
+/** @brief Changes the status of a flight on the first LIST page, so the next run misses the cache. */
+static void prepareListMiss(void) {
+    pendingStatus = (FlightStatus)((pendingStatus + 1) % 3);
+    setFlightStatus(benchFlights, benchFlightCount, 1 + randomBelow(SERVICE_LIST_LIMIT), pendingStatus);
+}
+
+/** @brief Timed: the first LIST page over the protocol (a cache hit unless prepare changed one of its flights). */
+static void runListRequest(void) {
+    static char response[SERVICE_RESPONSE_SIZE];
+    benchSink += executeRequest("LIST", response, sizeof(response));
+}
+
+/** @brief Unbinds the protocol layer and frees all tables and cached responses. */
+static void teardownRequests(void) {
+    bindService(NULL, NULL);
+    cleanupResultCache();
+    teardownQuery();
+}
+
+/** @brief Picks BENCH_BATCH_SIZE random existing flight IDs for the next run. */
+static void prepareFlightBatch(void) {
+    for (int i = 0; i < BENCH_BATCH_SIZE; i++) {
+        batchIDs[i] = 1 + randomBelow(benchRecords);
+    }
+}
+
+/** @brief Timed: searchFlights for the whole batch in one call. */
+static void runSearchFlightsBatch(void) {
+    searchFlights(benchFlights, benchFlightCount, batchIDs, BENCH_BATCH_SIZE, batchFlights);
+    for (int i = 0; i < BENCH_BATCH_SIZE; i++) {
+        benchSink += batchFlights[i]->availableSeats;
+    }
+}
+
+/** @brief Timed: searchFlights for the batch one ID per call (no overlapped misses). */
+static void runSearchFlightsSingle(void) {
+    for (int i = 0; i < BENCH_BATCH_SIZE; i++) {
+        searchFlights(benchFlights, benchFlightCount, batchIDs + i, 1, batchFlights + i);
+        benchSink += batchFlights[i]->availableSeats;
+    }
+}
+
+/** @brief Picks BENCH_BATCH_SIZE random existing ticket IDs for the next run. */
+static void prepareTicketBatch(void) {
+    for (int i = 0; i < BENCH_BATCH_SIZE; i++) {
+        batchIDs[i] = globalTickets[randomBelow(globalTicketCount)].ticketID;
+    }
+}
+
+/** @brief Timed: searchTickets for the whole batch in one call. */
+static void runSearchTicketsBatch(void) {
+    searchTickets(batchIDs, BENCH_BATCH_SIZE, batchTickets);
+    for (int i = 0; i < BENCH_BATCH_SIZE; i++) {
+        benchSink += batchTickets[i]->seatNo;
+    }
+}
+
+/** @brief Timed: searchTickets for the batch one ID per call (no overlapped misses). */
+static void runSearchTicketsSingle(void) {
+    for (int i = 0; i < BENCH_BATCH_SIZE; i++) {
+        searchTickets(batchIDs + i, 1, batchTickets + i);
+        benchSink += batchTickets[i]->seatNo;
+    }
+}
+
+/** @brief Frees all tables and both ID indexes. */
+static void teardownIDIndexes(void) {
+    freeAll();
+    cleanupIDIndexes();
+}
+
+/**
+ * @brief Returns the DateTime a number of minutes after 01-03-2025 00:00 (within March).
+ *
+ * @param minutes The minutes.
+ * @return The date and time.
+ */
+static DateTime journeyTime(int minutes) {
+    DateTime dt;
+    memset(&dt, 0, sizeof(dt));
+    dt.day = 1 + minutes / 1440;
+    dt.month = 3;
+    dt.year = 2025;
+    dt.hour = minutes % 1440 / 60;
+    dt.minute = minutes % 60;
+    return dt;
+}
+
+/** @brief Returns a journey airport, a hub one time in four. */
+static int randomJourneyAirport(void) {
+    return randomBelow(4) == 0 ? randomBelow(10) : randomBelow(BENCH_JOURNEY_AIRPORTS);
+}
+
+/** @brief Builds a one-day schedule of records flights between BENCH_JOURNEY_AIRPORTS airports, partly sold. */
+static int setupJourneys(int records) {
+    if (!buildFlights(records)) {
+        return 0;
+    }
+    for (int i = 0; i < benchFlightCount; i++) {
+        Flight *f = benchFlights + i;
+        int from = randomJourneyAirport();
+        int to = (from + 1 + randomBelow(BENCH_JOURNEY_AIRPORTS - 1)) % BENCH_JOURNEY_AIRPORTS;
+        if (randomBelow(2) == 0) {
+            to = randomJourneyAirport();
+        }
+        snprintf(f->origin, MAX_NAME_LEN, "J%03d", from);
+        snprintf(f->destination, MAX_NAME_LEN, "J%03d", to);
+        int departure = randomBelow(1440);
+        f->departure = journeyTime(departure);
+        f->arrival = journeyTime(departure + 45 + randomBelow(600));
+        f->status = ON_TIME;
+        int sold = randomBelow(10) == 0 ? MAX_PASSENGERS_PER_FLIGHT : randomBelow(MAX_PASSENGERS_PER_FLIGHT);
+        for (int seatNo = 1; seatNo <= sold; seatNo++) {
+            f->seatMap[SEAT_BYTE(seatNo)] |= SEAT_MASK(seatNo);
+        }
+        f->availableSeats = MAX_PASSENGERS_PER_FLIGHT - sold; // One in ten full
+    }
+    flightTableVersion++;
+    return 1;
+}
+
+/** @brief Picks two different airports and a departure time (with a two-hour window) for the next run. */
+static void prepareJourney(void) {
+    int from = randomJourneyAirport();
+    int to = (from + 1 + randomBelow(BENCH_JOURNEY_AIRPORTS - 1)) % BENCH_JOURNEY_AIRPORTS;
+    snprintf(journeyFrom, sizeof(journeyFrom), "J%03d", from);
+    snprintf(journeyTo, sizeof(journeyTo), "J%03d", to);
+    int start = randomBelow(18 * 60);
+    journeyStart = journeyTime(start);
+    journeyEnd = journeyTime(start + 120);
+}
+
+/** @brief Timed: findEarliestArrival between the chosen airports. */
+static void runEarliestArrival(void) {
+    Journey journey;
+    if (findEarliestArrival(benchFlights, benchFlightCount, journeyFrom, journeyTo, &journeyStart, &journey) > 0) {
+        benchSink += journey.arrival;
+    }
+}
+
+/** @brief Timed: findJourneyProfile between the chosen airports over a two-hour window. */
+static void runJourneyProfile(void) {
+    Journey journeys[16];
+    benchSink += findJourneyProfile(benchFlights, benchFlightCount, journeyFrom, journeyTo, &journeyStart, &journeyEnd,
+                                    journeys, 16);
+}
+
+/** @brief Timed: findParetoJourneys of up to 3 flights between the chosen airports. */
+static void runParetoJourneys(void) {
+    Journey journeys[16];
+    benchSink += findParetoJourneys(benchFlights, benchFlightCount, journeyFrom, journeyTo, &journeyStart, 3,
+                                    journeys, 16);
+}
+
+/** @brief Frees all tables and the connection array. */
+static void teardownJourneys(void) {
+    freeAll();
+    cleanupJourneys();
+}
+
+/**
+ * @brief Chains groups of BENCH_SEGMENT_LEGS flights into multi-stop flights (up to 1000), partly sold.
+ *
+ * @param records The number of flights.
+ * @return 1 on success, 0 on failure.
+ */
+static int setupSegments(int records) {
+    if (!buildFlights(records)) {
+        return 0;
+    }
+    segmentCount = records / BENCH_SEGMENT_LEGS < 1000 ? records / BENCH_SEGMENT_LEGS : 1000;
+    for (int s = 0; s < segmentCount; s++) {
+        for (int l = 0; l < BENCH_SEGMENT_LEGS; l++) {
+            Flight *f = benchFlights + s * BENCH_SEGMENT_LEGS + l;
+            snprintf(f->origin, MAX_NAME_LEN, "S%d.%d", s, l);
+            snprintf(f->destination, MAX_NAME_LEN, "S%d.%d", s, l + 1);
+            f->departure = journeyTime(l * 120);
+            f->arrival = journeyTime(l * 120 + 90);
+            for (int seatNo = 1; seatNo <= MAX_PASSENGERS_PER_FLIGHT; seatNo++) {
+                if (randomBelow(4) == 0) {
+                    f->seatMap[SEAT_BYTE(seatNo)] |= SEAT_MASK(seatNo);
+                    f->availableSeats--;
+                }
+            }
+        }
+    }
+    flightTableVersion++;
+    for (int s = 0; s < segmentCount; s++) {
+        int legIDs[BENCH_SEGMENT_LEGS];
+        for (int l = 0; l < BENCH_SEGMENT_LEGS; l++) {
+            legIDs[l] = benchFlights[s * BENCH_SEGMENT_LEGS + l].flightID;
+        }
+        char flightNumber[16];
+        snprintf(flightNumber, sizeof(flightNumber), "SEG%04d", s);
+        if (!defineSegmentedFlight(benchFlights, benchFlightCount, flightNumber, legIDs, BENCH_SEGMENT_LEGS)) {
+            return 0;
+        }
+    }
+    return segmentCount > 0;
+}
+
+/** @brief Picks a multi-stop flight for the next run. */
+static void prepareSegment(void) {
+    int s = randomBelow(segmentCount);
+    snprintf(segmentNumber, sizeof(segmentNumber), "SEG%04d", s);
+    snprintf(segmentFrom, sizeof(segmentFrom), "S%d.0", s);
+    snprintf(segmentTo, sizeof(segmentTo), "S%d.%d", s, BENCH_SEGMENT_LEGS);
+}
+
+/** @brief Timed: segmentSeatMap from the first stop to the last (all legs ORed). */
+static void runSegmentSeatMap(void) {
+    unsigned char seatMap[SEAT_MAP_BYTES];
+    benchSink += segmentSeatMap(benchFlights, benchFlightCount, segmentNumber, segmentFrom, segmentTo, seatMap);
+}
+
+/** @brief Frees all tables, the multi-stop flights and the flight ID index. */
+static void teardownSegments(void) {
+    freeAll();
+    cleanupSegmentedFlights();
+    cleanupIDIndexes();
+}
+
+/**
+ * @brief Adds daily patterns over one season standing for about records dated flights (up to 1000 patterns).
+ *
+ * @param records The number of flights (also the table the dated flights are looked up in).
+ * @return 1 on success, 0 on failure.
+ */
+static int setupSchedules(int records) {
+    if (!buildFlights(records)) {
+        return 0;
+    }
+    int count = records / BENCH_SCHEDULE_DAYS;
+    count = count < 1 ? 1 : count > 1000 ? 1000 : count;
+    for (int i = 0; i < count; i++) {
+        SchedulePattern pattern;
+        memset(&pattern, 0, sizeof(pattern));
+        int from = randomBelow(16);
+        int to = (from + 1 + randomBelow(15)) % 16;
+        snprintf(pattern.flightName, MAX_NAME_LEN, "SCH%04d", i);
+        strcpy(pattern.origin, benchAirports[from]);
+        strcpy(pattern.destination, benchAirports[to]);
+        pattern.validFrom = journeyTime(0);
+        pattern.validTo = journeyTime(0);
+        pattern.validTo.day = 31;
+        pattern.validTo.month = 8;
+        pattern.weekdays = SCHEDULE_DAILY;
+        pattern.departureMinute = randomBelow(1440);
+        pattern.duration = 60 + randomBelow(600);
+        // The first pattern's IDs are above the table; later ones are above the previous pattern anyway
+        if (!addSchedulePattern(benchFlights, i == 0 ? benchFlightCount : 0, &pattern)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** @brief Picks an airport and a day of the season for the next run. */
+static void prepareSchedule(void) {
+    strcpy(scheduleFrom, benchAirports[randomBelow(16)]);
+    scheduleDate = journeyTime(0);
+    scheduleDate.month = 3 + randomBelow(6);
+    scheduleDate.day = 1 + randomBelow(28);
+}
+
+/** @brief Timed: findScheduledFlights of one day from the chosen airport (dated on the fly, seats looked up). */
+static void runScheduledFlights(void) {
+    ScheduledFlight dated[64];
+    benchSink += findScheduledFlights(benchFlights, benchFlightCount, scheduleFrom, NULL, &scheduleDate, dated, 64);
+}
+
+/** @brief Frees all tables, the patterns and the flight ID index. */
+static void teardownSchedules(void) {
+    freeAll();
+    cleanupSchedulePatterns();
+    cleanupIDIndexes();
+}
+
+/**
+ * @var benchCases
+ * @brief Every benchmarked operation, in report order.
+ */
+static const BenchCase benchCases[] = {
+    { "searchFlight",           0, buildFlights,        prepareRandomFlightID,     runSearchFlight,       freeAll },
+    { "addFlight.duplicate",    0, buildFlights,        prepareRandomFlightID,     runAddFlightDuplicate, freeAll },
+    { "deleteFlight",           0, buildFlights,        prepareDeleteFlight,       runDeleteFlight,       freeAll },
+    { "sortFlightsByDeparture", 1, setupSortFlights,    prepareSortFlights,        runSortFlights,        freeAll },
+    { "addPassenger",           0, buildPassengers,     prepareAddPassenger,       runAddPassenger,       freeAll },
+    { "removePassenger",        0, buildPassengers,     prepareRemovePassenger,    runRemovePassenger,    freeAll },
+    { "findPassengerIndex.unknown",0, setupPassportFilter, prepareUnknownPassport,  runFindUnknownPassport, freeAll },
+    { "findTicketIndex.unknown",0, buildTickets,        prepareUnknownTicketID,    runFindUnknownTicket,  freeAll },
+    { "bookTicket",             0, buildTickets,        prepareBookTicket,         runBookTicket,         freeAll },
+    { "cancelTicket",           0, buildTickets,        prepareCancelTicket,       runCancelTicket,       freeAll },
+    { "seatManagement",         0, buildTickets,        prepareRandomTicketFlight, runSeatManagement,     freeAll },
+    { "saveFlights",            1, buildFlights,        NULL,                      runSaveFlights,        teardownFiles },
+    { "loadFlights",            1, setupLoadFlights,    NULL,                      runLoadFlights,        teardownFiles },
+    { "savePassengers",         1, buildPassengers,     NULL,                      runSavePassengers,     teardownFiles },
+    { "loadPassengers",         1, setupLoadPassengers, NULL,                      runLoadPassengers,     teardownFiles },
+    { "saveTickets",            1, buildTickets,        NULL,                      runSaveTickets,        teardownFiles },
+    { "loadTickets",            1, setupLoadTickets,    NULL,                      runLoadTickets,        teardownFiles },
+    { "listFlights",            1, buildFlights,        NULL,                      runListFlights,        teardownFiles },
+    { "renderFlights.csv",      1, buildFlights,        NULL,                      runRenderFlightsCsv,   teardownFiles },
+    { "renderFlights.json",     1, buildFlights,        NULL,                      runRenderFlightsJson,  teardownFiles },
+    { "pageFlights.first",      0, buildFlights,        prepareFirstPage,          runPageFlights,        teardownPages },
+    { "pageFlights.deep",       0, buildFlights,        prepareDeepFlightPage,     runPageFlights,        teardownPages },
+    { "pageTickets.deep",       0, buildTickets,        prepareDeepTicketPage,     runPageTickets,        teardownPages },
+    { "queryFlights.scan",      1, buildFlights,        prepareScanQuery,          runQueryFlights,       teardownQuery },
+    { "queryFlights.route",     0, buildFlights,        prepareRouteQuery,         runQueryFlights,       teardownQuery },
+    { "queryFlights.time",      0, buildFlights,        prepareTimeQuery,          runQueryFlights,       teardownQuery },
+    { "queryFlights.bitmap",    0, buildFlights,        prepareBitmapQuery,        runQueryFlights,       teardownQuery },
+    { "setFlightStatus",        0, setupFlightIndex,    prepareSetFlightStatus,    runSetFlightStatus,    teardownQuery },
+    { "topKFlights.departures", 0, setupTopK,           prepareTopKDepartures,     runTopKFlights,        teardownQuery },
+    { "topKFlights.fullest",    0, setupTopK,           prepareTopKFullest,        runTopKFlights,        teardownQuery },
+    { "availableFlights.route", 0, setupAvailability,   prepareRouteAvailability,  runRouteAvailability,  teardownAvailability },
+    { "availableFlights.global",0, setupAvailability,   prepareGlobalAvailability, runGlobalAvailability, teardownAvailability },
+    { "getRouteAggregate",      0, setupAggregates,     prepareRouteAggregate,     runRouteAggregate,     teardownAggregates },
+    { "getBusiestRoutes",       0, setupAggregates,     NULL,                      runBusiestRoutes,      teardownAggregates },
+    { "verifyAggregates",       1, setupAggregates,     NULL,                      runVerifyAggregates,   teardownAggregates },
+    { "writeAnalyticsReports",  1, setupReports,        NULL,                      runWriteReports,       teardownReports },
+    { "listRequest.cached",     0, setupRequests,       NULL,                      runListRequest,        teardownRequests },
+    { "listRequest.uncached",   0, setupRequests,       prepareListMiss,           runListRequest,        teardownRequests },
+    { "searchFlights.batch",    0, buildFlights,        prepareFlightBatch,        runSearchFlightsBatch, teardownIDIndexes },
+    { "searchFlights.single",   0, buildFlights,        prepareFlightBatch,        runSearchFlightsSingle,teardownIDIndexes },
+    { "searchTickets.batch",    0, buildTickets,        prepareTicketBatch,        runSearchTicketsBatch, teardownIDIndexes },
+    { "searchTickets.single",   0, buildTickets,        prepareTicketBatch,        runSearchTicketsSingle,teardownIDIndexes },
+    { "findEarliestArrival",    0, setupJourneys,       prepareJourney,            runEarliestArrival,    teardownJourneys },
+    { "findJourneyProfile",     0, setupJourneys,       prepareJourney,            runJourneyProfile,     teardownJourneys },
+    { "findParetoJourneys",     0, setupJourneys,       prepareJourney,            runParetoJourneys,     teardownJourneys },
+    { "segmentSeatMap.10legs",  0, setupSegments,       prepareSegment,            runSegmentSeatMap,     teardownSegments },
+    { "findScheduledFlights",   0, setupSchedules,      prepareSchedule,           runScheduledFlights,   teardownSchedules },
+};
+
+/**
+ * @brief Comparison function for qsort to order timing samples.
+ */
+static int compareSamples(const void *a, const void *b) {
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Runs one case at one table size and summarizes its timings.
+ *
+ * @param bc A pointer to the case to run.
+ * @param records The table size.
+ * @param warmup Number of untimed iterations.
+ * @param reps Number of timed iterations.
+ * @param counters Hardware counters to read around every timed iteration, or NULL.
+ * @param result Receives the summary.
+ */
+static void runCase(const BenchCase *bc, int records, int warmup, int reps,
+                    PerfCounters *counters, BenchResult *result) {
+    memset(result, 0, sizeof(*result));
+    result->name = bc->name;
+    result->records = records;
+
+    long long *samples = (long long *)malloc((size_t)reps * sizeof(long long));
+    if (samples == NULL || !bc->setup(records)) {
+        result->skipped = 1;
+        bc->teardown();
+        free(samples);
+        return;
+    }
+
+    for (int i = 0; i < warmup; i++) {
+        if (bc->prepare != NULL) bc->prepare();
+        bc->run();
+    }
+    if (counters != NULL) {
+        resetPerfCounters(counters);
+    }
+    for (int i = 0; i < reps; i++) {
+        if (bc->prepare != NULL) bc->prepare();
+        if (counters != NULL) enablePerfCounters(counters); // Outside the timed region
+        long long start = nowNanos();
+        bc->run();
+        samples[i] = nowNanos() - start;
+        if (counters != NULL) disablePerfCounters(counters);
+    }
+    bc->teardown();
+
+    PerfCounterValues values;
+    if (counters != NULL && readPerfCounters(counters, &values)) {
+        result->counted = 1;
+        for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+            result->perOp[k] = values.values[k] >= 0 ? (double)values.values[k] / reps : -1.0;
+        }
+    }
+
+    qsort(samples, (size_t)reps, sizeof(long long), compareSamples);
+    double total = 0.0;
+    for (int i = 0; i < reps; i++) {
+        total += (double)samples[i];
+    }
+    int p99Index = (reps * 99 + 99) / 100 - 1; // ceil(0.99 * reps) - 1
+    result->reps = reps;
+    result->minNs = (double)samples[0];
+    result->medianNs = (double)samples[reps / 2];
+    result->p99Ns = (double)samples[p99Index];
+    result->meanNs = total / reps;
+    free(samples);
+}
+
+/**
+ * @brief Writes all results as JSON for regression comparison.
+ *
+ * @param filename The file to write.
+ * @param results The results to write.
+ * @param count The number of results.
+ * @return 1 on success, 0 on failure (e.g., file cannot be opened).
+ */
+static int writeResultsJson(const char *filename, const BenchResult *results, int count) {
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open file %s for writing.\n", filename);
+        return 0;
+    }
+    fprintf(fp, "{\n  \"suite\": \"flight-system\",\n  \"unit\": \"ns\",\n  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = results + i;
+        fprintf(fp, "    {\"name\": \"%s\", \"records\": %d, ", r->name, r->records);
+        if (r->skipped) {
+            fprintf(fp, "\"skipped\": true}");
+        } else {
+            fprintf(fp, "\"reps\": %d, \"min\": %.0f, \"median\": %.0f, \"p99\": %.0f, \"mean\": %.1f",
+                    r->reps, r->minNs, r->medianNs, r->p99Ns, r->meanNs);
+            if (r->counted) {
+                fprintf(fp, ", \"perOp\": {");
+                for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+                    fprintf(fp, "%s\"%s\": ", k > 0 ? ", " : "", perfCounterName((PerfCounterKind)k));
+                    if (r->perOp[k] >= 0) {
+                        fprintf(fp, "%.2f", r->perOp[k]);
+                    } else {
+                        fprintf(fp, "null");
+                    }
+                }
+                fprintf(fp, "}");
+                if (r->perOp[PERF_CYCLES] > 0 && r->perOp[PERF_INSTRUCTIONS] >= 0) {
+                    fprintf(fp, ", \"ipc\": %.3f", r->perOp[PERF_INSTRUCTIONS] / r->perOp[PERF_CYCLES]);
+                }
+            }
+            fprintf(fp, "}");
+        }
+        fprintf(fp, "%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return 1;
+}
+
+/**
+ * @brief Parses a comma-separated list of table sizes.
+ *
+ * @param text The list (e.g., "1000,100000").
+ * @param sizes Receives the sizes.
+ * @return The number of sizes parsed (0 if the list is invalid).
+ */
+static int parseSizes(const char *text, int *sizes) {
+    int count = 0;
+    while (*text != '\0' && count < BENCH_MAX_SIZES) {
+        char *end;
+        long value = strtol(text, &end, 10);
+        if (end == text || value <= 0 || value > 2000000000L) {
+            return 0;
+        }
+        sizes[count++] = (int)value;
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return 0;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Entry point of the benchmark harness.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
+ * @return 0 on success, 1 on invalid arguments or output failure.
+ */
+int main(int argc, char *argv[]) {
+    int sizes[BENCH_MAX_SIZES] = { 1000, 100000, 10000000 };
+    int sizeCount = 3;
+    int reps = 101;
+    int bulkReps = 5;
+    int warmup = 10;
+    const char *filter = NULL;
+    const char *outFile = "bench_results.json";
+    const char *profileFile = NULL;
+    int useCounters = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--counters") == 0) {
+            useCounters = 1; // The only option without a value
+            continue;
+        }
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            printf("Missing value for %s.\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizeCount = parseSizes(value, sizes);
+            if (sizeCount == 0) {
+                printf("Invalid --sizes list: %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--reps") == 0) {
+            reps = atoi(value);
+        } else if (strcmp(argv[i], "--bulk-reps") == 0) {
+            bulkReps = atoi(value);
+        } else if (strcmp(argv[i], "--warmup") == 0) {
+            warmup = atoi(value);
+        } else if (strcmp(argv[i], "--filter") == 0) {
+            filter = value;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            rngState = strtoull(value, NULL, 10) | 1ULL; // xorshift state must be non-zero
+        } else if (strcmp(argv[i], "--out") == 0) {
+            outFile = value;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profileFile = value;
+        } else {
+            printf("Unknown option %s.\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    if (reps <= 0 || bulkReps <= 0 || warmup < 0) {
+        printf("Repetition counts must be positive.\n");
+        return 1;
+    }
+
+    int caseCount = (int)(sizeof(benchCases) / sizeof(benchCases[0]));
+    BenchResult *results = (BenchResult *)malloc((size_t)(caseCount * sizeCount) * sizeof(BenchResult));
+    if (results == NULL) {
+        printf("Error: Could not allocate memory for results.\n");
+        return 1;
+    }
+    int resultCount = 0;
+
+    PerfCounters counters;
+    PerfCounters *activeCounters = NULL;
+    if (useCounters) {
+        if (openPerfCounters(&counters)) {
+            activeCounters = &counters;
+            for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+                if (counters.fds[k] < 0) {
+                    printf("Counter %s is not available on this machine.\n", perfCounterName((PerfCounterKind)k));
+                }
+            }
+        } else {
+            int error = errno;
+            printf("Hardware counters unavailable (%s); timing only.\n", strerror(error));
+            if (error == EACCES || error == EPERM) {
+                printf("Access was denied: check /proc/sys/kernel/perf_event_paranoid (needs <= 2) or the "
+                       "container's seccomp profile.\n");
+            }
+        }
+    }
+    if (profileFile != NULL) {
+        startProfiler(PROFILE_DEFAULT_HZ);
+    }
+    for (int c = 0; c < caseCount; c++) {
+        const BenchCase *bc = benchCases + c;
+        if (filter != NULL && strstr(bc->name, filter) == NULL) {
+            continue;
+        }
+        for (int s = 0; s < sizeCount; s++) {
+            BenchResult *r = results + resultCount++;
+            runCase(bc, sizes[s], bc->bulk ? (warmup > 0) : warmup, bc->bulk ? bulkReps : reps, activeCounters, r);
+            if (r->skipped) {
+                printf("[bench] %-24s %10d  skipped\n", r->name, r->records);
+            } else {
+                printf("[bench] %-24s %10d  median %14.0f ns  p99 %14.0f ns\n",
+                       r->name, r->records, r->medianNs, r->p99Ns);
+            }
+            if (r->counted) {
+                const double *op = r->perOp;
+                printf("        %-24s %10s  cycles/op %.0f  IPC %.2f  cache-misses/op %.2f  branch-misses/op %.2f\n",
+                       "", "", op[PERF_CYCLES],
+                       op[PERF_CYCLES] > 0 && op[PERF_INSTRUCTIONS] >= 0 ? op[PERF_INSTRUCTIONS] / op[PERF_CYCLES] : 0.0,
+                       op[PERF_CACHE_MISSES], op[PERF_BRANCH_MISSES]);
+            }
+            fflush(stdout);
+        }
+    }
+
+    if (profileFile != NULL) {
+        stopProfiler();
+        writeFoldedStacks(profileFile);
+    }
+
+    if (activeCounters != NULL) {
+        closePerfCounters(activeCounters);
+    }
+
+    int ok = writeResultsJson(outFile, results, resultCount);
+    if (ok) {
+        printf("Results written to %s.\n", outFile);
+    }
+    free(results);
+    return ok ? 0 : 1;
+}
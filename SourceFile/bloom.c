@@ -0,0 +1,405 @@
+/**
+ * @file bloom.c
+ * @brief Implementation of the Bloom filters in front of the passport and ticket ID lookups.
+ *
+ * A filter is an array of 64-byte blocks of 8 words, aligned to a cache line.
+ * A key's 64-bit hash picks its block with the upper 32 bits and, for each
+ * word of the block, one bit with the lower 32 bits times a per-word odd
+ * constant (a split-block Bloom filter). Filters are sized for twice the
+ * keys they are built with and rebuilt once they fill up, so the false
+ * positive rate stays near that of BLOOM_BITS_PER_KEY bits per key.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h> // For uint32_t, uint64_t, uintptr_t
+#include <pthread.h>
+#if !defined(_WIN32)
+#include <unistd.h> // For sysconf
+#endif
+
+#include "bloom.h"
+#include "passenger.h"
+#include "ticket.h"
+#include "memstats.h"
+
+/**
+ * @def BLOOM_BLOCK_WORDS
+ * @brief 64-bit words per block (one cache line).
+ */
+#define BLOOM_BLOCK_WORDS 8
+
+/**
+ * @struct BloomFilter
+ * @brief A filter and the table state it is in sync with.
+ */
+typedef struct {
+    uint64_t *blocks;       /**< BLOOM_BLOCK_WORDS words per block, cache-line aligned. */
+    void *allocation;       /**< The block allocation (blocks points into it). */
+    uint64_t blockCount;    /**< Blocks in use. */
+    uint64_t allocated;     /**< Blocks allocated. */
+    int capacity;           /**< Keys the filter is sized for. */
+    int keys;               /**< Keys set, including removed ones. */
+    int removed;            /**< Keys removed from the table but still set. */
+    int count;              /**< The table's record count when last synced. */
+    unsigned long version;  /**< The table's version when last synced. */
+    int built;              /**< 1 while the filter is usable. */
+} BloomFilter;
+
+/**
+ * @var blockSalts
+ * @brief Odd multipliers picking the bit of each word of a block.
+ */
+static const uint32_t blockSalts[BLOOM_BLOCK_WORDS] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+static BloomFilter passportFilter;  /**< Passports of globalPassengers. */
+static BloomFilter ticketFilter;    /**< Ticket IDs of globalTickets. */
+
+/**
+ * @brief Mixes the bits of a 64-bit value (the splitmix64 finalizer).
+ *
+ * @param x The value.
+ * @return The mixed value.
+ */
+static uint64_t mixBits(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Hashes a passport (FNV-1a, then mixed).
+ *
+ * @param passport The passport number.
+ * @return The hash.
+ */
+static uint64_t hashPassport(const char *passport) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *p = passport; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 1099511628211ULL;
+    }
+    return mixBits(hash);
+}
+
+/**
+ * @brief Hashes a ticket ID.
+ *
+ * @param ticketID The ticket ID.
+ * @return The hash.
+ */
+static uint64_t hashTicketID(int ticketID) {
+    return mixBits((uint64_t)(uint32_t)ticketID);
+}
+
+/**
+ * @brief Returns the hash of the passenger at a position of globalPassengers.
+ *
+ * @param position The position.
+ * @return The hash of its passport.
+ */
+static uint64_t passengerHashAt(int position) {
+    return hashPassport(globalPassengers[position].passport);
+}
+
+/**
+ * @brief Returns the hash of the ticket at a position of globalTickets.
+ *
+ * @param position The position.
+ * @return The hash of its ID.
+ */
+static uint64_t ticketHashAt(int position) {
+    return hashTicketID(globalTickets[position].ticketID);
+}
+
+/**
+ * @brief Returns the block of a hash.
+ *
+ * @param filter The filter.
+ * @param hash The hash.
+ * @return A pointer to the first word of the block.
+ */
+static uint64_t *blockOf(const BloomFilter *filter, uint64_t hash) {
+    return filter->blocks + ((hash >> 32) * filter->blockCount >> 32) * BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * @brief Sets the bits of a hash.
+ *
+ * @param filter The filter.
+ * @param hash The hash.
+ * @param atomic 1 if other threads set bits at the same time.
+ */
+static void setBits(BloomFilter *filter, uint64_t hash, int atomic) {
+    uint64_t *block = blockOf(filter, hash);
+    uint32_t low = (uint32_t)hash;
+    for (int w = 0; w < BLOOM_BLOCK_WORDS; w++) {
+        uint64_t bit = 1ULL << ((low * blockSalts[w]) >> 26);
+        if (atomic) {
+            __atomic_fetch_or(block + w, bit, __ATOMIC_RELAXED);
+        } else {
+            block[w] |= bit;
+        }
+    }
+}
+
+/**
+ * @brief Reports whether every bit of a hash is set.
+ *
+ * @param filter The filter.
+ * @param hash The hash.
+ * @return 1 if the key may have been added, 0 if it certainly was not.
+ */
+static int testBits(const BloomFilter *filter, uint64_t hash) {
+    const uint64_t *block = blockOf(filter, hash);
+    uint32_t low = (uint32_t)hash;
+    uint64_t missing = 0;
+    for (int w = 0; w < BLOOM_BLOCK_WORDS; w++) {
+        missing |= ~block[w] & (1ULL << ((low * blockSalts[w]) >> 26));
+    }
+    return missing == 0;
+}
+
+/**
+ * @brief Reports whether a filter is in sync with its table.
+ *
+ * @param filter The filter.
+ * @param count The table's record count.
+ * @param version The table's version.
+ * @return 1 if in sync, 0 otherwise.
+ */
+static int isSynced(const BloomFilter *filter, int count, unsigned long version) {
+    return filter->built && filter->count == count && filter->version == version;
+}
+
+/**
+ * @struct BloomTask
+ * @brief The range of records one rebuild thread hashes.
+ */
+typedef struct {
+    BloomFilter *filter;            /**< The filter being built. */
+    uint64_t (*hashAt)(int);        /**< Hash of the record at a position. */
+    int first;                      /**< First position. */
+    int last;                       /**< One past the last position. */
+} BloomTask;
+
+/**
+ * @brief Sets the bits of one range of records (thread entry point).
+ *
+ * @param arg A pointer to the BloomTask.
+ * @return NULL.
+ */
+static void *bloomWorker(void *arg) {
+    BloomTask *task = (BloomTask *)arg;
+    for (int i = task->first; i < task->last; i++) {
+        setBits(task->filter, task->hashAt(i), 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Rebuilds a filter from every record of its table.
+ *
+ * @param filter The filter.
+ * @param count The table's record count.
+ * @param version The table version to mark the filter as synced with.
+ * @param hashAt Hash of the record at a position.
+ * @return 1 on success, 0 if memory allocation failed (the filter is left unusable).
+ */
+static int rebuildFilter(BloomFilter *filter, int count, unsigned long version, uint64_t (*hashAt)(int)) {
+    int capacity = count * 2 > BLOOM_MIN_KEYS ? count * 2 : BLOOM_MIN_KEYS;
+    uint64_t blocks = ((uint64_t)capacity * BLOOM_BITS_PER_KEY + 511) / 512;
+    if (blocks > filter->allocated) {
+        trackedFree(MEM_OTHER, filter->allocation);
+        filter->allocation = trackedMalloc(MEM_OTHER, (size_t)blocks * 64 + 63);
+        if (filter->allocation == NULL) {
+            printf("Error: Could not allocate memory for the Bloom filter.\n");
+            filter->allocated = 0;
+            filter->built = 0;
+            return 0;
+        }
+        filter->blocks = (uint64_t *)(((uintptr_t)filter->allocation + 63) & ~(uintptr_t)63);
+        filter->allocated = blocks;
+    }
+    filter->blockCount = blocks;
+    memset(filter->blocks, 0, (size_t)blocks * 64);
+
+    int threads = 1;
+#if !defined(_WIN32)
+    if (count >= BLOOM_PARALLEL_MIN) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+#endif
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > BLOOM_MAX_THREADS) {
+        threads = BLOOM_MAX_THREADS;
+    }
+    if (threads == 1) {
+        for (int i = 0; i < count; i++) {
+            setBits(filter, hashAt(i), 0);
+        }
+    } else {
+        BloomTask tasks[BLOOM_MAX_THREADS];
+        pthread_t handles[BLOOM_MAX_THREADS];
+        for (int t = 0; t < threads; t++) {
+            tasks[t].filter = filter;
+            tasks[t].hashAt = hashAt;
+            tasks[t].first = (int)((long long)count * t / threads);
+            tasks[t].last = (int)((long long)count * (t + 1) / threads);
+        }
+        int started = 0;
+        for (int t = 1; t < threads; t++) {
+            if (pthread_create(&handles[t], NULL, bloomWorker, &tasks[t]) != 0) {
+                break;
+            }
+            started = t;
+        }
+        bloomWorker(&tasks[0]);
+        for (int t = 1; t <= started; t++) {
+            pthread_join(handles[t], NULL);
+        }
+        for (int t = started + 1; t < threads; t++) { // Threads that could not be started
+            bloomWorker(&tasks[t]);
+        }
+    }
+
+    filter->capacity = capacity;
+    filter->keys = count;
+    filter->removed = 0;
+    filter->count = count;
+    filter->version = version;
+    filter->built = 1;
+    return 1;
+}
+
+/**
+ * @brief Sets a new key, or rebuilds the filter if it is out of sync or full.
+ *
+ * @param filter The filter.
+ * @param hash The hash of the new key.
+ * @param count The table's record count, including the new record.
+ * @param version The table's version before the increment.
+ * @param hashAt Hash of the record at a position.
+ */
+static void keyAdded(BloomFilter *filter, uint64_t hash, int count, unsigned long version, uint64_t (*hashAt)(int)) {
+    if (!isSynced(filter, count - 1, version) || filter->keys >= filter->capacity) {
+        rebuildFilter(filter, count, version + 1, hashAt);
+        return;
+    }
+    setBits(filter, hash, 0);
+    filter->keys++;
+    filter->count = count;
+    filter->version = version + 1;
+}
+
+/**
+ * @brief Counts a removed key, or rebuilds the filter if it is out of sync or mostly stale.
+ *
+ * @param filter The filter.
+ * @param count The table's record count, without the removed record.
+ * @param version The table's version before the increment.
+ * @param hashAt Hash of the record at a position.
+ */
+static void keyRemoved(BloomFilter *filter, int count, unsigned long version, uint64_t (*hashAt)(int)) {
+    if (!isSynced(filter, count + 1, version) || filter->removed + 1 > filter->keys / 2) {
+        rebuildFilter(filter, count, version + 1, hashAt);
+        return;
+    }
+    filter->removed++;
+    filter->count = count;
+    filter->version = version + 1;
+}
+
+/**
+ * @brief Reports whether a passenger with a passport may exist.
+ *
+ * @param passport The passport number.
+ * @return 0 if there is certainly no such passenger, 1 if there may be (or the filter is not in sync).
+ */
+int passportMayExist(const char *passport) {
+    if (!isSynced(&passportFilter, globalPassengerCount, passengerTableVersion)) {
+        return 1;
+    }
+    return testBits(&passportFilter, hashPassport(passport));
+}
+
+/**
+ * @brief Reports whether a ticket may exist.
+ *
+ * @param ticketID The ticket ID.
+ * @return 0 if there is certainly no such ticket, 1 if there may be (or the filter is not in sync).
+ */
+int ticketMayExist(int ticketID) {
+    if (!isSynced(&ticketFilter, globalTicketCount, ticketTableVersion)) {
+        return 1;
+    }
+    return testBits(&ticketFilter, hashTicketID(ticketID));
+}
+
+/**
+ * @brief Hook: a passenger was appended. Call before incrementing passengerTableVersion.
+ *
+ * @param passport The passport of the new passenger.
+ */
+void bloomPassengerAdded(const char *passport) {
+    keyAdded(&passportFilter, hashPassport(passport), globalPassengerCount, passengerTableVersion, passengerHashAt);
+}
+
+/**
+ * @brief Hook: a passenger was removed. Call before incrementing passengerTableVersion.
+ */
+void bloomPassengerRemoved() {
+    keyRemoved(&passportFilter, globalPassengerCount, passengerTableVersion, passengerHashAt);
+}
+
+/**
+ * @brief Hook: a ticket was appended. Call before incrementing ticketTableVersion.
+ *
+ * @param ticketID The ID of the new ticket.
+ */
+void bloomTicketAdded(int ticketID) {
+    keyAdded(&ticketFilter, hashTicketID(ticketID), globalTicketCount, ticketTableVersion, ticketHashAt);
+}
+
+/**
+ * @brief Hook: a ticket was removed. Call before incrementing ticketTableVersion.
+ */
+void bloomTicketRemoved() {
+    keyRemoved(&ticketFilter, globalTicketCount, ticketTableVersion, ticketHashAt);
+}
+
+/**
+ * @brief Rebuilds the passport filter from globalPassengers (e.g., after a load).
+ *
+ * @return 1 on success, 0 if memory allocation failed (lookups then scan).
+ */
+int rebuildPassportFilter() {
+    return rebuildFilter(&passportFilter, globalPassengerCount, passengerTableVersion, passengerHashAt);
+}
+
+/**
+ * @brief Rebuilds the ticket filter from globalTickets (e.g., after a load).
+ *
+ * @return 1 on success, 0 if memory allocation failed (lookups then scan).
+ */
+int rebuildTicketFilter() {
+    return rebuildFilter(&ticketFilter, globalTicketCount, ticketTableVersion, ticketHashAt);
+}
+
+/**
+ * @brief Frees both filters.
+ */
+void cleanupBloomFilters() {
+    BloomFilter *filters[2] = { &passportFilter, &ticketFilter };
+    for (int i = 0; i < 2; i++) {
+        trackedFree(MEM_OTHER, filters[i]->allocation);
+        memset(filters[i], 0, sizeof(*filters[i]));
+    }
+}
@@ -0,0 +1,690 @@
+/**
+ * @file datagen.c
+ * @brief Synthetic airline-scale dataset generator for flights.txt, passengers.txt and tickets.txt.
+ *
+ * Generates a consistent schedule: a set of routes between airports, each
+ * flown a number of times per day over a number of days. Every flight gets a
+ * seeded share of booked seats around a target load factor; each booked seat
+ * becomes a ticket, its bit is set in the flight's seat map and
+ * availableSeats reflects it. Tickets are handed to passengers round-robin,
+ * and each passenger's assigned flight/seat is that of their first ticket.
+ *
+ * Output uses the exact text formats read by loadFlights, loadPassengers and
+ * loadTickets. Every record is derived from (seed, record index) only, so the
+ * output is byte-identical for a given seed whatever the thread count.
+ * Records are formatted in parallel, one chunk of flights at a time, with
+ * hand-written formatting into per-thread buffers that are then written in
+ * order.
+ *
+ * The defaults generate 11,200 flights, more than the default MAX_FLIGHTS
+ * (100) of the interactive program, which keeps only the first MAX_FLIGHTS
+ * flights of a file. The generator warns when its output exceeds the
+ * MAX_FLIGHTS it was built with, so build it with the same -DMAX_FLIGHTS as
+ * the program that loads the files. --out-dir is created if it does not
+ * exist yet (its parent must exist).
+ *
+ * Build (see README):
+ *   gcc -O2 -pthread datagen.c -o datagen.exe
+ *
+ * Usage:
+ *   datagen.exe [--airports N] [--routes N] [--days N] [--daily N] [--seats N]
+ *               [--load-factor F] [--passengers N] [--start DD-MM-YYYY]
+ *               [--seed N] [--threads N] [--out-dir DIR]
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For malloc, free, strtol, strtod
+#include <string.h>
+#include <pthread.h>
+#include <errno.h>    // For errno, EEXIST
+#include <sys/stat.h> // For mkdir
+
+/**
+ * @def DATAGEN_CHUNK_FLIGHTS
+ * @brief Number of flights formatted per parallel round.
+ */
+#define DATAGEN_CHUNK_FLIGHTS 65536
+
+/**
+ * @def DATAGEN_MAX_THREADS
+ * @brief Upper bound on worker threads.
+ */
+#define DATAGEN_MAX_THREADS 64
+
+/**
+ * @struct GenConfig
+ * @brief Generator parameters taken from the command line.
+ */
+typedef struct {
+    int airports;           /**< Number of airports. */
+    int routes;             /**< Number of distinct origin/destination pairs. */
+    int days;               /**< Number of days in the schedule. */
+    int daily;              /**< Departures per route per day. */
+    int seats;              /**< Seats per flight (at most MAX_PASSENGERS_PER_FLIGHT). */
+    double loadFactor;      /**< Target fraction of seats booked (0.0 to 1.0). */
+    int passengers;         /**< Number of passengers. */
+    int startDay;           /**< First day of the schedule (1-31). */
+    int startMonth;         /**< First month of the schedule (1-12). */
+    int startYear;          /**< First year of the schedule. */
+    unsigned long long seed;/**< Seed every record is derived from. */
+    int threads;            /**< Worker threads. */
+    const char *outDir;     /**< Directory the three files are written to. */
+} GenConfig;
+
+/**
+ * @struct GenBuffer
+ * @brief Growable output buffer owned by one worker.
+ */
+typedef struct {
+    char *data;     /**< Buffer contents. */
+    size_t length;  /**< Bytes used. */
+    size_t capacity;/**< Bytes allocated. */
+    int failed;     /**< 1 if an allocation failed. */
+} GenBuffer;
+
+/**
+ * @struct GenTask
+ * @brief Range of records one worker handles in a round.
+ */
+typedef struct {
+    int first;              /**< First flight index of the range. */
+    int last;               /**< One past the last flight index of the range. */
+    GenBuffer flights;      /**< Formatted flight lines. */
+    GenBuffer tickets;      /**< Formatted ticket lines. */
+    GenBuffer passengers;   /**< Formatted passenger lines. */
+} GenTask;
+
+static GenConfig config;            /**< Active configuration. */
+static int totalFlights = 0;        /**< routes * days * daily. */
+static int *bookedPerFlight = NULL; /**< Seats booked on each flight (pass 1). */
+static int *ticketBase = NULL;      /**< Index of each flight's first ticket (prefix sums of bookedPerFlight). */
+static int totalTickets = 0;        /**< Sum of bookedPerFlight. */
+
+static const char *const knownAirports[] = {
+    "DAC", "CGP", "ZYL", "CXB", "JSR", "RJH", "SPD", "BZL", "DXB", "DOH",
+    "AUH", "JED", "RUH", "MCT", "KWI", "SIN", "KUL", "BKK", "HKG", "CAN",
+    "PEK", "PVG", "NRT", "ICN", "DEL", "BOM", "CCU", "MAA", "KTM", "CMB",
+    "MLE", "IST", "LHR", "CDG", "FRA", "AMS", "FCO", "JFK", "YYZ", "SYD"
+}; /**< Real airport codes used before synthetic ones. */
+
+static char (*airportCodes)[4] = NULL; /**< Code of every airport index, built by buildAirportCodes. */
+
+static const char *const firstNames[] = {
+    "Rahim", "Karim", "Fatima", "Ayesha", "Nusrat", "Tanvir", "Sadia", "Imran",
+    "Farhan", "Nabila", "Arif", "Mim", "Rafi", "Tasnim", "Sabbir", "Jannat"
+}; /**< First names for generated passengers. */
+
+static const char *const lastNames[] = {
+    "Ahmed", "Hossain", "Rahman", "Islam", "Khan", "Chowdhury", "Akter", "Hasan",
+    "Uddin", "Sarkar", "Mia", "Begum", "Alam", "Karim", "Das", "Roy"
+}; /**< Last names for generated passengers. */
+
+/**
+ * @brief Mixes a 64-bit value (splitmix64 finalizer); used to derive per-record seeds.
+ *
+ * @param x The value to mix.
+ * @return A well-distributed 64-bit value.
+ */
+static unsigned long long mix64(unsigned long long x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Advances a per-record random state (xorshift64) and returns a value below a bound.
+ *
+ * @param state A pointer to the random state (must be non-zero).
+ * @param bound The exclusive upper bound (must be positive).
+ * @return A value from 0 to bound - 1.
+ */
+static int nextBelow(unsigned long long *state, int bound) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (int)(*state % (unsigned long long)bound);
+}
+
+/**
+ * @brief Returns the random state for one record of a stream.
+ *
+ * @param stream Distinguishes flights from passengers.
+ * @param index The record index.
+ * @return A non-zero random state.
+ */
+static unsigned long long recordState(unsigned long long stream, unsigned long long index) {
+    return mix64(config.seed ^ mix64(stream * 0x100000001B3ULL + index)) | 1ULL;
+}
+
+/**
+ * @brief Builds the code of every airport: real codes first, then synthetic codes that are not real ones.
+ *
+ * Synthetic codes count down from "ZAA"; any that equals one of the real
+ * codes (e.g., "ZYL") is skipped, so no two airports share a code.
+ *
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int buildAirportCodes(void) {
+    int known = (int)(sizeof(knownAirports) / sizeof(knownAirports[0]));
+    airportCodes = (char (*)[4])malloc((size_t)config.airports * sizeof(*airportCodes));
+    if (airportCodes == NULL) {
+        printf("Error: Could not allocate memory for %d airports.\n", config.airports);
+        return 0;
+    }
+    int next = 0; // Next synthetic candidate
+    for (int index = 0; index < config.airports; index++) {
+        if (index < known) {
+            memcpy(airportCodes[index], knownAirports[index], 4);
+            continue;
+        }
+        int real;
+        do {
+            char *out = airportCodes[index];
+            out[0] = (char)('Z' - next / 676 % 26);
+            out[1] = (char)('A' + next / 26 % 26);
+            out[2] = (char)('A' + next % 26);
+            out[3] = '\0';
+            next++;
+            real = 0;
+            for (int k = 0; k < known && !real; k++) {
+                real = strcmp(out, knownAirports[k]) == 0;
+            }
+        } while (real);
+    }
+    return 1;
+}
+
+/**
+ * @brief Writes an airport code for an airport index (real codes first, then synthetic).
+ *
+ * @param index The airport index.
+ * @param out Receives a NUL-terminated 3-letter code.
+ */
+static void airportCode(int index, char out[4]) {
+    memcpy(out, airportCodes[index], 4);
+}
+
+/**
+ * @brief Returns the number of days in a month.
+ */
+static int daysInMonth(int month, int year) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return days[month - 1] + (month == 2 && leap);
+}
+
+/**
+ * @brief Builds the DateTime lying a number of minutes after a day of the schedule.
+ *
+ * @param dayOffset Days after the schedule start.
+ * @param minutes Minutes after midnight of that day (may exceed one day).
+ * @return The resulting DateTime.
+ */
+static DateTime scheduleTime(int dayOffset, int minutes) {
+    int day = config.startDay, month = config.startMonth, year = config.startYear;
+    dayOffset += minutes / 1440;
+    minutes %= 1440;
+    while (dayOffset > 0) {
+        int left = daysInMonth(month, year) - day;
+        if (dayOffset <= left) {
+            day += dayOffset;
+            break;
+        }
+        dayOffset -= left + 1;
+        day = 1;
+        if (++month > 12) {
+            month = 1;
+            year++;
+        }
+    }
+    DateTime dt;
+    dt.day = day;
+    dt.month = month;
+    dt.year = year;
+    dt.hour = minutes / 60;
+    dt.minute = minutes % 60;
+    return dt;
+}
+
+/**
+ * @brief Describes one generated flight.
+ */
+typedef struct {
+    int route;          /**< Route index. */
+    int day;            /**< Day offset in the schedule. */
+    int departMinute;   /**< Departure minute of the day. */
+    int duration;       /**< Block time in minutes. */
+    FlightStatus status;/**< Operational status. */
+    int booked;         /**< Seats booked. */
+} GenFlight;
+
+/**
+ * @brief Derives a flight's schedule and booking count from its index alone.
+ *
+ * @param index The flight index (0 to totalFlights - 1).
+ * @param state Receives the flight's random state, positioned for seat selection.
+ * @return The flight description.
+ */
+static GenFlight describeFlight(int index, unsigned long long *state) {
+    GenFlight g;
+    int slot = index % config.daily;
+    g.route = index / config.daily % config.routes;
+    g.day = index / config.daily / config.routes;
+
+    *state = recordState(1, (unsigned long long)index);
+    int slotWidth = 1440 / config.daily;
+    g.departMinute = slot * slotWidth + nextBelow(state, slotWidth > 1 ? slotWidth : 1);
+    g.duration = 45 + (int)(mix64((unsigned long long)g.route ^ config.seed) % 660); // Same for every flight of a route
+
+    int roll = nextBelow(state, 100);
+    g.status = roll < 2 ? CANCELLED : (roll < 10 ? DELAYED : ON_TIME);
+
+    int target = (int)(config.loadFactor * config.seats + 0.5);
+    int jitter = config.seats / 10;
+    g.booked = target + (jitter > 0 ? nextBelow(state, 2 * jitter + 1) - jitter : 0);
+    if (g.booked < 0) g.booked = 0;
+    if (g.booked > config.seats) g.booked = config.seats;
+    if (g.status == CANCELLED) g.booked = 0;
+    return g;
+}
+
+/**
+ * @brief Makes sure a buffer can take more bytes.
+ */
+static int reserve(GenBuffer *b, size_t extra) {
+    if (b->length + extra <= b->capacity) {
+        return 1;
+    }
+    size_t capacity = b->capacity ? b->capacity : 1 << 16;
+    while (capacity < b->length + extra) {
+        capacity *= 2;
+    }
+    char *data = (char *)realloc(b->data, capacity);
+    if (data == NULL) {
+        b->failed = 1;
+        return 0;
+    }
+    b->data = data;
+    b->capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Appends a string to a buffer (space must be reserved).
+ */
+static void appendStr(GenBuffer *b, const char *s) {
+    size_t n = strlen(s);
+    memcpy(b->data + b->length, s, n);
+    b->length += n;
+}
+
+/**
+ * @brief Appends one character to a buffer (space must be reserved).
+ */
+static void appendChar(GenBuffer *b, char c) {
+    b->data[b->length++] = c;
+}
+
+/**
+ * @brief Appends a non-negative integer in decimal to a buffer (space must be reserved).
+ */
+static void appendUInt(GenBuffer *b, unsigned int value) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n > 0) {
+        b->data[b->length++] = digits[--n];
+    }
+}
+
+/**
+ * @brief Appends a DateTime in the "D M YYYY H M" form used by flights.txt.
+ */
+static void appendDateTime(GenBuffer *b, DateTime dt) {
+    appendUInt(b, dt.day);    appendChar(b, ' ');
+    appendUInt(b, dt.month);  appendChar(b, ' ');
+    appendUInt(b, dt.year);   appendChar(b, ' ');
+    appendUInt(b, dt.hour);   appendChar(b, ' ');
+    appendUInt(b, dt.minute);
+}
+
+/**
+ * @brief Writes a passenger's name for a passenger index.
+ */
+static void passengerName(int passenger, char *out, size_t size) {
+    unsigned long long h = mix64(config.seed ^ ((unsigned long long)passenger << 1));
+    int firsts = (int)(sizeof(firstNames) / sizeof(firstNames[0]));
+    int lasts = (int)(sizeof(lastNames) / sizeof(lastNames[0]));
+    snprintf(out, size, "%s %s", firstNames[h % firsts], lastNames[(h >> 16) % lasts]);
+}
+
+/**
+ * @brief Appends a passenger line ("name,age,passport,flightID,seatNo").
+ */
+static void appendPassenger(GenBuffer *b, int passenger, int flightID, int seatNo) {
+    char name[MAX_NAME_LEN];
+    passengerName(passenger, name, sizeof(name));
+    unsigned long long state = recordState(2, (unsigned long long)passenger);
+    if (!reserve(b, MAX_NAME_LEN + 64)) {
+        return;
+    }
+    appendStr(b, name);                             appendChar(b, ',');
+    appendUInt(b, (unsigned int)(1 + nextBelow(&state, 85))); appendChar(b, ',');
+    appendStr(b, "BD");
+    appendUInt(b, (unsigned int)(10000000 + passenger)); appendChar(b, ',');
+    appendUInt(b, (unsigned int)flightID);          appendChar(b, ',');
+    appendUInt(b, (unsigned int)seatNo);            appendChar(b, '\n');
+}
+
+/**
+ * @brief Pass 1 worker: computes how many seats each flight in the range books.
+ */
+static void *countWorker(void *arg) {
+    GenTask *task = (GenTask *)arg;
+    for (int i = task->first; i < task->last; i++) {
+        unsigned long long state;
+        bookedPerFlight[i] = describeFlight(i, &state).booked;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Pass 2 worker: formats the flights of the range with their tickets and passengers.
+ */
+static void *formatWorker(void *arg) {
+    static const char hex[] = "0123456789ABCDEF";
+    GenTask *task = (GenTask *)arg;
+    char origin[4], destination[4];
+
+    for (int i = task->first; i < task->last; i++) {
+        unsigned long long state;
+        GenFlight g = describeFlight(i, &state);
+        int flightID = i + 1;
+
+        // Choose g.booked distinct seats (partial Fisher-Yates)
+        int seatsLeft[MAX_PASSENGERS_PER_FLIGHT];
+        unsigned char seatMap[SEAT_MAP_BYTES];
+        memset(seatMap, 0, sizeof(seatMap));
+        for (int s = 0; s < config.seats; s++) {
+            seatsLeft[s] = s + 1;
+        }
+        for (int k = 0; k < g.booked; k++) {
+            int j = k + nextBelow(&state, config.seats - k);
+            int seatNo = seatsLeft[j];
+            seatsLeft[j] = seatsLeft[k];
+            seatsLeft[k] = seatNo;
+            seatMap[SEAT_BYTE(seatNo)] |= SEAT_MASK(seatNo);
+        }
+
+        int originIndex = g.route % config.airports;
+        airportCode(originIndex, origin);
+        airportCode((originIndex + 1 + g.route / config.airports % (config.airports - 1)) % config.airports,
+                    destination);
+
+        GenBuffer *fb = &task->flights;
+        if (!reserve(fb, 160 + 2 * SEAT_MAP_BYTES)) {
+            return NULL;
+        }
+        appendUInt(fb, (unsigned int)flightID);   appendChar(fb, ',');
+        appendStr(fb, "BG");
+        appendUInt(fb, (unsigned int)(100 + g.route)); appendChar(fb, ',');
+        appendStr(fb, origin);                     appendChar(fb, ',');
+        appendStr(fb, destination);                appendChar(fb, ',');
+        appendDateTime(fb, scheduleTime(g.day, g.departMinute)); appendChar(fb, ',');
+        appendDateTime(fb, scheduleTime(g.day, g.departMinute + g.duration)); appendChar(fb, ',');
+        appendUInt(fb, (unsigned int)g.status);    appendChar(fb, ',');
+        appendUInt(fb, (unsigned int)(config.seats - g.booked)); appendChar(fb, ',');
+        for (int j = 0; j < SEAT_MAP_BYTES; j++) {
+            appendChar(fb, hex[seatMap[j] >> 4]);
+            appendChar(fb, hex[seatMap[j] & 0xF]);
+        }
+        appendChar(fb, '\n');
+
+        // One ticket per booked seat; ticket t belongs to passenger t % passengers
+        char name[MAX_NAME_LEN];
+        for (int k = 0; k < g.booked; k++) {
+            int ticket = ticketBase[i] + k;
+            int passenger = ticket % config.passengers;
+            GenBuffer *tb = &task->tickets;
+            passengerName(passenger, name, sizeof(name));
+            if (!reserve(tb, MAX_NAME_LEN + 40)) {
+                return NULL;
+            }
+            appendUInt(tb, (unsigned int)(ticket + 1)); appendChar(tb, ',');
+            appendStr(tb, name);                        appendChar(tb, ',');
+            appendUInt(tb, (unsigned int)flightID);     appendChar(tb, ',');
+            appendUInt(tb, (unsigned int)seatsLeft[k]); appendChar(tb, '\n');
+
+            if (ticket < config.passengers) { // First ticket of this passenger: emit them in order
+                appendPassenger(&task->passengers, passenger, flightID, seatsLeft[k]);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs a worker over [first, last) split evenly across the configured threads.
+ *
+ * @param worker The worker function.
+ * @param tasks The per-thread tasks (buffers are kept between rounds).
+ * @param first First flight index.
+ * @param last One past the last flight index.
+ * @return The number of tasks used.
+ */
+static int runParallel(void *(*worker)(void *), GenTask *tasks, int first, int last) {
+    pthread_t threads[DATAGEN_MAX_THREADS];
+    int count = config.threads;
+    int span = last - first;
+    if (count > span) count = span > 0 ? span : 1;
+
+    for (int t = 0; t < count; t++) {
+        tasks[t].first = first + (int)((long long)span * t / count);
+        tasks[t].last = first + (int)((long long)span * (t + 1) / count);
+        tasks[t].flights.length = tasks[t].tickets.length = tasks[t].passengers.length = 0;
+    }
+    int started = 0;
+    for (int t = 1; t < count; t++) {
+        if (pthread_create(&threads[t], NULL, worker, &tasks[t]) != 0) {
+            break;
+        }
+        started = t;
+    }
+    worker(&tasks[0]);
+    for (int t = 1; t <= started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    for (int t = started + 1; t < count; t++) { // Threads that could not be started
+        worker(&tasks[t]);
+    }
+    return count;
+}
+
+/**
+ * @brief Opens one of the output files in the output directory.
+ */
+static FILE *openOutput(const char *name) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", config.outDir, name);
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        printf("Error: Could not open file %s for writing.\n", path);
+    }
+    return fp;
+}
+
+/**
+ * @brief Parses a "DD-MM-YYYY" start date into the configuration.
+ */
+static int parseStartDate(const char *text) {
+    int d, m, y;
+    if (sscanf(text, "%d-%d-%d", &d, &m, &y) != 3 || m < 1 || m > 12 || y < 1 || y > 4000 ||
+        d < 1 || d > daysInMonth(m, y)) {
+        return 0;
+    }
+    config.startDay = d;
+    config.startMonth = m;
+    config.startYear = y;
+    return 1;
+}
+
+/**
+ * @brief Entry point of the dataset generator.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
+ * @return 0 on success, 1 on invalid arguments, allocation or I/O failure.
+ */
+int main(int argc, char *argv[]) {
+    config.airports = 40;
+    config.routes = 400;
+    config.days = 7;
+    config.daily = 4;
+    config.seats = 180;
+    config.loadFactor = 0.8;
+    config.passengers = 1000000;
+    config.startDay = 1;
+    config.startMonth = 1;
+    config.startYear = 2026;
+    config.seed = 42;
+    config.threads = 4;
+    config.outDir = ".";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *opt = argv[i], *value = argv[i + 1];
+        if (strcmp(opt, "--airports") == 0) config.airports = atoi(value);
+        else if (strcmp(opt, "--routes") == 0) config.routes = atoi(value);
+        else if (strcmp(opt, "--days") == 0) config.days = atoi(value);
+        else if (strcmp(opt, "--daily") == 0) config.daily = atoi(value);
+        else if (strcmp(opt, "--seats") == 0) config.seats = atoi(value);
+        else if (strcmp(opt, "--load-factor") == 0) config.loadFactor = strtod(value, NULL);
+        else if (strcmp(opt, "--passengers") == 0) config.passengers = atoi(value);
+        else if (strcmp(opt, "--seed") == 0) config.seed = strtoull(value, NULL, 10);
+        else if (strcmp(opt, "--threads") == 0) config.threads = atoi(value);
+        else if (strcmp(opt, "--out-dir") == 0) config.outDir = value;
+        else if (strcmp(opt, "--start") == 0) {
+            if (!parseStartDate(value)) {
+                printf("Invalid --start date %s (expected DD-MM-YYYY).\n", value);
+                return 1;
+            }
+        } else {
+            printf("Unknown option %s.\n", opt);
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        printf("Missing value for %s.\n", argv[argc - 1]);
+        return 1;
+    }
+
+    // Corner cases: parameters that cannot describe a schedule
+    if (config.airports < 2 || config.airports > 17576 || config.routes <= 0 ||
+        config.routes > config.airports * (config.airports - 1) || config.days <= 0 ||
+        config.daily <= 0 || config.daily > 1440 || config.seats <= 0 ||
+        config.seats > MAX_PASSENGERS_PER_FLIGHT || config.loadFactor < 0.0 ||
+        config.loadFactor > 1.0 || config.passengers <= 0 || config.passengers > 89999999 ||
+        config.threads <= 0 || config.threads > DATAGEN_MAX_THREADS) {
+        printf("Invalid generator parameters.\n");
+        return 1;
+    }
+    long long flights = (long long)config.routes * config.days * config.daily;
+    if (flights > 2000000000LL) {
+        printf("Schedule too large: %lld flights.\n", flights);
+        return 1;
+    }
+    totalFlights = (int)flights;
+    if (totalFlights > MAX_FLIGHTS) {
+        printf("Warning: %d flights exceed MAX_FLIGHTS (%d); a program built with that limit keeps only "
+               "the first %d. Build it with -DMAX_FLIGHTS=%d or more to load them all.\n",
+               totalFlights, MAX_FLIGHTS, MAX_FLIGHTS, totalFlights);
+    }
+    if (!buildAirportCodes()) {
+        return 1;
+    }
+
+    GenTask tasks[DATAGEN_MAX_THREADS];
+    memset(tasks, 0, sizeof(tasks));
+    bookedPerFlight = (int *)malloc((size_t)totalFlights * sizeof(int));
+    ticketBase = (int *)malloc((size_t)totalFlights * sizeof(int));
+    if (bookedPerFlight == NULL || ticketBase == NULL) {
+        printf("Error: Could not allocate memory for %d flights.\n", totalFlights);
+        return 1;
+    }
+
+    // Pass 1: bookings per flight, then ticket numbering
+    runParallel(countWorker, tasks, 0, totalFlights);
+    long long tickets = 0;
+    for (int i = 0; i < totalFlights; i++) {
+        ticketBase[i] = (int)tickets;
+        tickets += bookedPerFlight[i];
+        if (tickets > 2000000000LL) {
+            printf("Too many tickets for 32-bit ticket IDs.\n");
+            return 1;
+        }
+    }
+    totalTickets = (int)tickets;
+
+    if (mkdir(config.outDir, 0755) != 0 && errno != EEXIST) {
+        printf("Error: Could not create directory %s (%s).\n", config.outDir, strerror(errno));
+        return 1;
+    }
+    FILE *flightFile = openOutput("flights.txt");
+    FILE *ticketFile = openOutput("tickets.txt");
+    FILE *passengerFile = openOutput("passengers.txt");
+    if (flightFile == NULL || ticketFile == NULL || passengerFile == NULL) {
+        return 1;
+    }
+    fprintf(flightFile, "%d\n", totalFlights);
+    fprintf(ticketFile, "%d\n", totalTickets);
+    fprintf(passengerFile, "%d\n", config.passengers);
+
+    // Pass 2: format chunk by chunk in parallel, write in flight order
+    int failed = 0;
+    for (int first = 0; first < totalFlights && !failed; first += DATAGEN_CHUNK_FLIGHTS) {
+        int last = first + DATAGEN_CHUNK_FLIGHTS < totalFlights ? first + DATAGEN_CHUNK_FLIGHTS : totalFlights;
+        int used = runParallel(formatWorker, tasks, first, last);
+        for (int t = 0; t < used; t++) {
+            failed |= tasks[t].flights.failed | tasks[t].tickets.failed | tasks[t].passengers.failed;
+            fwrite(tasks[t].flights.data, 1, tasks[t].flights.length, flightFile);
+            fwrite(tasks[t].tickets.data, 1, tasks[t].tickets.length, ticketFile);
+            fwrite(tasks[t].passengers.data, 1, tasks[t].passengers.length, passengerFile);
+        }
+    }
+
+    // Passengers who hold no ticket
+    GenBuffer *rest = &tasks[0].passengers;
+    rest->length = 0;
+    for (int p = totalTickets; p < config.passengers && !failed; p++) {
+        appendPassenger(rest, p, 0, 0);
+        failed |= rest->failed;
+        if (rest->length >= (1 << 20) || p + 1 == config.passengers) {
+            fwrite(rest->data, 1, rest->length, passengerFile);
+            rest->length = 0;
+        }
+    }
+
+    failed |= fclose(flightFile) != 0;
+    failed |= fclose(ticketFile) != 0;
+    failed |= fclose(passengerFile) != 0;
+    for (int t = 0; t < DATAGEN_MAX_THREADS; t++) {
+        free(tasks[t].flights.data);
+        free(tasks[t].tickets.data);
+        free(tasks[t].passengers.data);
+    }
+    free(bookedPerFlight);
+    free(ticketBase);
+    free(airportCodes);
+
+    if (failed) {
+        printf("Error: Dataset generation failed (out of memory or disk).\n");
+        return 1;
+    }
+    printf("Generated %d flights, %d tickets and %d passengers in %s.\n",
+           totalFlights, totalTickets, config.passengers, config.outDir);
+    return 0;
+}
@@ -11,7 +11,36 @@
 #include "common.h" // MUST BE FIRST for shared macros/definitions
 #include <stdio.h>
 #include <string.h>
-#include <stdlib.h> // For qsort, malloc, realloc, free
+#include <stdlib.h> // For qsort, atoi
+
+#include "stats.h"
+#include "timing.h"
+#include "trace.h"
+#include "memstats.h"
+#include "session.h"
+#include "render.h"
+#include "flightindex.h"
+#include "aggregates.h"
+#include "resultcache.h"
+#include "page.h"
+
+/**
+ * @var flightTableVersion
+ * @brief Incremented whenever flights are added, removed, reordered or reloaded.
+ */
+unsigned long flightTableVersion = 0;
+
+/**
+ * @var flightStatusVersion
+ * @brief Incremented whenever a flight's status changes in place.
+ */
+unsigned long flightStatusVersion = 0;
+
+/**
+ * @var flightIDCheck
+ * @brief Check bound with bindFlightIDCheck (NULL accepts every flight).
+ */
+static int (*flightIDCheck)(const Flight *flight) = NULL;
 
 /**
  * @brief Clears the input buffer.
@@ -61,6 +90,151 @@ int compareFlightsByDeparture(const void *a, const void *b) {
     return compareDateTime(&flightA->departure, &flightB->departure);
 }
 
+/**
+ * @brief Finds the position of a flight in the array by its ID.
+ *
+ * This is the silent lookup shared by the interactive functions and by
+ * callers that must not print (benchmarks, batch tools).
+ *
+ * @param flights A pointer to the array of Flight structures to search within.
+ * @param flightCount The current number of flights in the array.
+ * @param flightID The ID of the flight to search for.
+ * @return The index of the flight, or -1 if not found.
+ */
+int findFlightIndex(const Flight *flights, int flightCount, int flightID) {
+    for (int i = 0; i < flightCount; i++) {
+        if ((flights + i)->flightID == flightID) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Collects the positions of all flights on a route, in array order.
+ *
+ * @param flights A pointer to the array of Flight structures to search within.
+ * @param flightCount The current number of flights in the array.
+ * @param origin The origin to match (exact, case-sensitive).
+ * @param destination The destination to match (exact, case-sensitive).
+ * @param indexes Receives up to maxIndexes positions (may be NULL to only count).
+ * @param maxIndexes The capacity of indexes.
+ * @return The total number of matching flights (may exceed maxIndexes).
+ */
+int findFlightsByRoute(const Flight *flights, int flightCount, const char *origin,
+                       const char *destination, int *indexes, int maxIndexes) {
+    int matches = 0;
+    for (int i = 0; i < flightCount; i++) {
+        const Flight *f = flights + i;
+        if (strcmp(f->origin, origin) == 0 && strcmp(f->destination, destination) == 0) {
+            if (indexes != NULL && matches < maxIndexes) {
+                indexes[matches] = i;
+            }
+            matches++;
+        }
+    }
+    return matches;
+}
+
+/**
+ * @brief Binds a check every flight must pass before insertFlight accepts it.
+ *
+ * @param check Returns 1 if a flight may be inserted, 0 if its ID is reserved; NULL accepts every flight.
+ */
+void bindFlightIDCheck(int (*check)(const Flight *flight)) {
+    flightIDCheck = check;
+}
+
+/**
+ * @brief Reports whether the bound ID check accepts a flight.
+ *
+ * @param flight A pointer to the flight.
+ * @return 1 if it may be inserted (or no check is bound), 0 if its ID is reserved.
+ */
+int flightIDAllowed(const Flight *flight) {
+    return flightIDCheck == NULL || flightIDCheck(flight);
+}
+
+/**
+ * @brief Appends a fully populated flight to the array without prompting.
+ *
+ * @param flights A pointer to the array of Flight structures (capacity MAX_FLIGHTS).
+ * @param flightCount A pointer to the current flight count, incremented on success.
+ * @param flight A pointer to the flight to copy into the array.
+ * @return 1 on success, 0 on failure (e.g., flight limit reached, duplicate ID, ID reserved by a schedule).
+ */
+int insertFlight(Flight *flights, int *flightCount, const Flight *flight) {
+    long long start = nowNanos();
+    // Fails if there is no room, the ID is a duplicate or a schedule reserved it for another flight
+    int inserted = *flightCount < MAX_FLIGHTS &&
+                   findFlightIndex(flights, *flightCount, flight->flightID) == -1 && flightIDAllowed(flight);
+    if (inserted) {
+        *(flights + *flightCount) = *flight;
+        (*flightCount)++;
+        indexFlightInserted(flights, *flightCount, flights + *flightCount - 1);
+        aggregateFlightInserted(flights, *flightCount, flights + *flightCount - 1);
+        pageFlightInserted(flights, *flightCount, flights + *flightCount - 1);
+        cacheFlightInserted(flights + *flightCount - 1);
+        flightTableVersion++;
+    }
+    recordLatency(STAT_FLIGHT_ADD, nowNanos() - start);
+    logSessionFlightAdd(flight, inserted, start);
+    return inserted;
+}
+
+/**
+ * @brief Removes a flight from the array by its ID without printing.
+ *
+ * @param flights A pointer to the array of Flight structures.
+ * @param flightCount A pointer to the current flight count, decremented on success.
+ * @param flightID The ID of the flight to remove.
+ * @return 1 on success, 0 if the flight was not found.
+ */
+int removeFlight(Flight *flights, int *flightCount, int flightID) {
+    long long start = nowNanos();
+    int foundIndex = findFlightIndex(flights, *flightCount, flightID);
+    if (foundIndex != -1) {
+        indexFlightRemoved(flights, *flightCount - 1, flights + foundIndex);
+        aggregateFlightRemoved(flights, *flightCount - 1, flights + foundIndex);
+        pageFlightRemoved(flights, *flightCount - 1, flights + foundIndex);
+        cacheFlightRemoved(flights + foundIndex);
+        // Shift elements to fill the gap (using pointer arithmetic)
+        for (int i = foundIndex; i < *flightCount - 1; i++) {
+            *(flights + i) = *(flights + i + 1);
+        }
+        (*flightCount)--;
+        flightTableVersion++;
+    }
+    recordLatency(STAT_FLIGHT_DELETE, nowNanos() - start);
+    logSessionID(SESSION_FLIGHT_DELETE, flightID, foundIndex != -1, start);
+    return foundIndex != -1;
+}
+
+/**
+ * @brief Changes the status of a flight by its ID without printing.
+ *
+ * @param flights A pointer to the array of Flight structures.
+ * @param flightCount The current number of flights in the array.
+ * @param flightID The ID of the flight to update.
+ * @param status The new status.
+ * @return 1 on success, 0 if the flight was not found or the status is invalid.
+ */
+int setFlightStatus(Flight *flights, int flightCount, int flightID, FlightStatus status) {
+    long long start = nowNanos();
+    int foundIndex = status >= ON_TIME && status <= CANCELLED ? findFlightIndex(flights, flightCount, flightID) : -1;
+    if (foundIndex != -1) {
+        Flight *f = flights + foundIndex;
+        FlightStatus previous = f->status;
+        f->status = status;
+        indexFlightStatusChanged(flights, flightCount, f, previous);
+        cacheFlightStatusChanged(f);
+        flightStatusVersion++;
+    }
+    recordLatency(STAT_FLIGHT_STATUS, nowNanos() - start);
+    logSessionFlightStatus(flightID, status, foundIndex != -1, start);
+    return foundIndex != -1;
+}
+
 /**
  * @brief Adds a new flight to the flight list.
  *
@@ -80,7 +254,8 @@ int addFlight(Flight *flights, int *flightCount) {
         return 0; // Failure
     }
 
-    Flight *newFlight = flights + *flightCount; // Pointer to the new flight location
+    Flight entered;             // Filled from input, then inserted by insertFlight
+    Flight *newFlight = &entered;
 
     printf("Enter flight ID: ");
     fflush(stdout); // Flush output before scanf
@@ -94,12 +269,10 @@ int addFlight(Flight *flights, int *flightCount) {
     clearInputBuffer(); // Consume newline after scanf
 
     // Corner case: check for duplicate flight ID
-    for (int i = 0; i < *flightCount; i++) {
-        if ((flights + i)->flightID == newFlight->flightID) {
-            printf("Error: Flight with ID %d already exists.\n", newFlight->flightID);
-            fflush(stdout); // Flush output
-            return 0; // Failure
-        }
+    if (findFlightIndex(flights, *flightCount, newFlight->flightID) != -1) {
+        printf("Error: Flight with ID %d already exists.\n", newFlight->flightID);
+        fflush(stdout); // Flush output
+        return 0; // Failure
     }
 
     printf("Enter flight name: ");
@@ -182,13 +355,23 @@ int addFlight(Flight *flights, int *flightCount) {
         return 0;
     }
     clearInputBuffer(); // Consume newline after scanf
+    newFlight->status = (FlightStatus)statusInput;
 
     // Initialize seat map (all seats available)
-    for (int i = 0; i < (MAX_PASSENGERS_PER_FLIGHT + 7) / 8; i++) {
+    for (int i = 0; i < SEAT_MAP_BYTES; i++) {
         newFlight->seatMap[i] = 0; // All bits to 0, indicating seats are free
     }
 
-    (*flightCount)++;
+    if (!flightIDAllowed(newFlight)) {
+        printf("Error: Flight ID %d is reserved by a recurring schedule.\n", newFlight->flightID);
+        fflush(stdout); // Flush output
+        return 0; // Failure
+    }
+    if (!insertFlight(flights, flightCount, newFlight)) {
+        printf("Error: Flight could not be added.\n");
+        fflush(stdout); // Flush output
+        return 0; // Failure
+    }
     printf("Flight added successfully.\n");
     fflush(stdout); // Flush output
     return 1; // Success
@@ -211,40 +394,8 @@ int listFlights(const Flight *flights, int flightCount) {
         return 0; // Failure (no flights to list)
     }
 
-    printf("\n---- All Available Flights ----\n");
-    for (int i = 0; i < flightCount; i++) {
-        const Flight *f = flights + i; // Pointer arithmetic instead of array indexing
-        printf("\nFlight ID      : %d\n", f->flightID);
-        printf("Name           : %s\n", f->flightName);
-        printf("From           : %s\n", f->origin);
-        printf("To             : %s\n", f->destination);
-        printf("Departure      : %02hu-%02hu-%04hu %02hu:%02hu\n",
-               f->departure.day, f->departure.month, f->departure.year,
-               f->departure.hour, f->departure.minute);
-        printf("Arrival        : %02hu-%02hu-%04hu %02hu:%02hu\n",
-               f->arrival.day, f->arrival.month, f->arrival.year,
-               f->arrival.hour, f->arrival.minute);
-
-        printf("Status         : ");
-        switch (f->status) {
-            case ON_TIME:
-                printf("On Time\n");
-                break;
-            case DELAYED:
-                printf("Delayed\n");
-                break;
-            case CANCELLED:
-                printf("Cancelled\n");
-                break;
-            default:
-                printf("Unknown\n");
-                break;
-        }
-
-        printf("Seats Available: %d\n", f->availableSeats);
-    }
-    fflush(stdout); // Flush output
-    return 1; // Success
+    // One buffered pass instead of about ten printf calls per flight
+    return renderFlights(stdout, RENDER_PLAIN, flights, flightCount);
 }
 
 /**
@@ -260,14 +411,17 @@ int listFlights(const Flight *flights, int flightCount) {
  */
 Flight *searchFlight(const Flight *flights, int flightCount, int flightID) {
     if (flightCount == 0) {
+        logSessionID(SESSION_FLIGHT_SEARCH, flightID, 0, nowNanos());
         printf("No flights to search.\n");
         fflush(stdout); // Flush output
         return NULL;
     }
-    for (int i = 0; i < flightCount; i++) {
-        if ((flights + i)->flightID == flightID) {
-            return (Flight *)(flights + i); // Return pointer to found flight
-        }
+    long long start = nowNanos();
+    int index = findFlightIndex(flights, flightCount, flightID);
+    recordLatency(STAT_FLIGHT_SEARCH, nowNanos() - start);
+    logSessionID(SESSION_FLIGHT_SEARCH, flightID, index != -1, start);
+    if (index != -1) {
+        return (Flight *)(flights + index); // Return pointer to found flight
     }
     printf("Flight with ID %d not found.\n", flightID);
     fflush(stdout); // Flush output
@@ -292,26 +446,12 @@ int deleteFlight(Flight *flights, int *flightCount, int flightID) {
         return 0;
     }
 
-    int foundIndex = -1;
-    for (int i = 0; i < *flightCount; i++) {
-        if ((flights + i)->flightID == flightID) {
-            foundIndex = i;
-            break;
-        }
-    }
-
-    if (foundIndex == -1) {
+    if (!removeFlight(flights, flightCount, flightID)) {
         printf("Flight with ID %d not found.\n", flightID);
         fflush(stdout); // Flush output
         return 0; // Failure
     }
 
-    // Shift elements to fill the gap (using pointer arithmetic)
-    for (int i = foundIndex; i < *flightCount - 1; i++) {
-        *(flights + i) = *(flights + i + 1);
-    }
-
-    (*flightCount)--;
     printf("Flight ID %d deleted successfully.\n", flightID);
     fflush(stdout); // Flush output
     return 1; // Success
@@ -329,19 +469,28 @@ int deleteFlight(Flight *flights, int *flightCount, int flightID) {
  */
 int sortFlightsByDeparture(Flight *flights, int flightCount) {
     if (flightCount <= 1) {
+        logSessionID(SESSION_FLIGHT_SORT, 0, 0, nowNanos());
         printf("Not enough flights to sort.\n");
         fflush(stdout); // Flush output
         return 0; // Failure
     }
     // Use qsort for efficient sorting
+    TRACE_SCOPE("sortFlightsByDeparture");
+    long long start = nowNanos();
     qsort(flights, flightCount, sizeof(Flight), compareFlightsByDeparture);
+    indexFlightsReordered(flights, flightCount);
+    aggregateFlightsReordered(flights, flightCount);
+    cacheFlightsReordered();
+    flightTableVersion++;
+    recordLatency(STAT_FLIGHT_SORT, nowNanos() - start);
+    logSessionID(SESSION_FLIGHT_SORT, 0, 1, start);
     printf("Flights sorted by departure time.\n");
     fflush(stdout); // Flush output
     return 1; // Success
 }
 
 /**
- * @brief Saves all flight data to a specified file.
+ * @brief Saves all flight data to a specified file (untimed body of saveFlights).
  *
  * This function writes the current state of all flights to a text file.
  * Each flight's data is written on a new line, with components separated by commas.
@@ -352,7 +501,8 @@ int sortFlightsByDeparture(Flight *flights, int flightCount) {
  * @param filename The name of the file to save to.
  * @return 1 on success, 0 on failure (e.g., file cannot be opened).
  */
-int saveFlights(const Flight *flights, int flightCount, const char *filename) {
+static int writeFlightsFile(const Flight *flights, int flightCount, const char *filename) {
+    TRACE_SCOPE("saveFlights");
     FILE *fp = fopen(filename, "w");
     if (fp == NULL) {
         printf("Error: Could not open file %s for writing.\n", filename);
@@ -376,20 +526,39 @@ int saveFlights(const Flight *flights, int flightCount, const char *filename) {
         fprintf(fp, "%d,%d,", f->status, f->availableSeats);
 
         // Save seatMap as hex string
-        for (int j = 0; j < (MAX_PASSENGERS_PER_FLIGHT + 7) / 8; j++) {
+        for (int j = 0; j < SEAT_MAP_BYTES; j++) {
             fprintf(fp, "%02X", f->seatMap[j]); // Print each byte as two hex characters
         }
         fprintf(fp, "\n");
     }
 
+    TRACE_BEGIN("saveFlights.close");
     fclose(fp);
+    TRACE_END("saveFlights.close");
     printf("Flights saved to %s successfully.\n", filename);
     fflush(stdout); // Flush output
     return 1; // Success
 }
 
 /**
- * @brief Loads flight data from a specified file.
+ * @brief Saves all flight data to a specified file.
+ *
+ * Records the latency of the whole call under STAT_SAVE_FLIGHTS.
+ *
+ * @param flights A pointer to the array of Flight structures to save.
+ * @param flightCount The current number of flights in the array.
+ * @param filename The name of the file to save to.
+ * @return 1 on success, 0 on failure (e.g., file cannot be opened).
+ */
+int saveFlights(const Flight *flights, int flightCount, const char *filename) {
+    long long start = nowNanos();
+    int result = writeFlightsFile(flights, flightCount, filename);
+    recordLatency(STAT_SAVE_FLIGHTS, nowNanos() - start);
+    return result;
+}
+
+/**
+ * @brief Loads flight data from a specified file (untimed body of loadFlights).
  *
  * This function reads flight data from a text file and populates the
  * flights array. It reallocates memory as needed. It expects the first
@@ -402,12 +571,14 @@ int saveFlights(const Flight *flights, int flightCount, const char *filename) {
  * @param filename The name of the file to load from.
  * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
  */
-int loadFlights(Flight **flights, int *flightCount, const char *filename) {
+static int readFlightsFile(Flight **flights, int *flightCount, const char *filename) {
+    TRACE_SCOPE("loadFlights");
     FILE *fp = fopen(filename, "r");
     if (fp == NULL) {
         printf("No flight data file found (%s). Starting with empty flight list.\n", filename);
         fflush(stdout); // Flush output
         *flightCount = 0; // Ensure count is zero if file doesn't exist
+        flightTableVersion++;
         return 0; // Not a critical failure, just means no data to load
     }
 
@@ -428,20 +599,26 @@ int loadFlights(Flight **flights, int *flightCount, const char *filename) {
     }
 
     // Free existing memory if any, and allocate for loaded data
+    TRACE_BEGIN("loadFlights.alloc");
     if (*flights != NULL) {
-        free(*flights);
+        trackedFree(MEM_FLIGHTS, *flights);
         *flights = NULL; // Defensive programming
     }
-    *flights = (Flight *)malloc(loadedCount * sizeof(Flight));
+    *flights = (Flight *)trackedMalloc(MEM_FLIGHTS, loadedCount * sizeof(Flight));
     if (*flights == NULL) {
         printf("Error: Could not allocate memory for loading flights.\n");
         fflush(stdout); // Flush output
+        TRACE_END("loadFlights.alloc");
         fclose(fp);
         return 0;
     }
 
+    TRACE_END("loadFlights.alloc");
+
     *flightCount = 0; // Reset count before loading
+    flightTableVersion++;
 
+    TRACE_BEGIN("loadFlights.parse");
     char line_buffer[512]; // Buffer to read each line
     while (*flightCount < loadedCount && fgets(line_buffer, sizeof(line_buffer), fp) != NULL) {
         Flight *f = *flights + *flightCount; // Pointer to current flight location
@@ -505,7 +682,7 @@ int loadFlights(Flight **flights, int *flightCount, const char *filename) {
         token = strtok(rest, "\n"); // Read till newline
         if (token == NULL) { printf("Error reading seatMap.\n"); fflush(stdout); break; }
 
-        for (int j = 0; j < (MAX_PASSENGERS_PER_FLIGHT + 7) / 8; j++) {
+        for (int j = 0; j < SEAT_MAP_BYTES; j++) {
             unsigned int byte_val;
             // Read two hex characters and convert to byte
             if (sscanf(token + (j * 2), "%2x", &byte_val) != 1) {
@@ -519,9 +696,29 @@ int loadFlights(Flight **flights, int *flightCount, const char *filename) {
         }
         (*flightCount)++;
     }
+    TRACE_END("loadFlights.parse");
 
     fclose(fp);
     printf("Loaded %d flights from %s.\n", *flightCount, filename);
     fflush(stdout); // Flush output
     return 1; // Success
+}
+
+/**
+ * @brief Loads flight data from a specified file.
+ *
+ * Records the latency of the whole call under STAT_LOAD_FLIGHTS.
+ *
+ * @param flights A pointer to a pointer to the Flight array. This allows the function
+ * to update the base address of the dynamically allocated array.
+ * @param flightCount A pointer to the current flight count, which will be updated
+ * with the number of loaded flights.
+ * @param filename The name of the file to load from.
+ * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
+ */
+int loadFlights(Flight **flights, int *flightCount, const char *filename) {
+    long long start = nowNanos();
+    int result = readFlightsFile(flights, flightCount, filename);
+    recordLatency(STAT_LOAD_FLIGHTS, nowNanos() - start);
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,345 @@
+/**
+ * @file flightindex.c
+ * @brief Implementation of the bitmap secondary indexes on flight status and departure day.
+ *
+ * The day bitmaps are kept in an array sorted by day number, so a date range
+ * is a binary search followed by a walk over consecutive entries. A day whose
+ * last flight leaves keeps its (empty) entry until the next rebuild.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <string.h>
+#include <limits.h> // For INT_MIN, INT_MAX
+#include <pthread.h>
+
+#include "flightindex.h"
+#include "flight.h"
+#include "memstats.h"
+
+/**
+ * @struct DayBitmap
+ * @brief The flights departing on one day.
+ */
+typedef struct {
+    int day;        /**< Day number (see departureDay). */
+    Roaring ids;    /**< FLIGHT_INDEX_KEY of every flight departing that day. */
+} DayBitmap;
+
+/**
+ * @struct FlightIndex
+ * @brief The status and day bitmaps of one flight table.
+ */
+typedef struct {
+    int built;                  /**< 1 once built. */
+    const Flight *table;        /**< Table the index describes. */
+    int count;                  /**< Flights indexed. */
+    unsigned long version;      /**< flightTableVersion the index matches. */
+    Roaring statuses[3];        /**< Flights per FlightStatus. */
+    DayBitmap *days;            /**< Day bitmaps sorted by day. */
+    int dayCount;               /**< Entries in days. */
+    int dayCapacity;            /**< Allocated entries of days. */
+} FlightIndex;
+
+static FlightIndex flightIndex; /**< The index of the last refreshed table. */
+static pthread_mutex_t flightIndexLock = PTHREAD_MUTEX_INITIALIZER; /**< Guards flightIndex. */
+
+/**
+ * @brief Returns the day number of a date: consecutive days get increasing numbers.
+ *
+ * @param dateTime The date (the time of day is ignored).
+ * @return Days counted from 1900 with 31-day months (dateTimeMinutes / 1440).
+ */
+int departureDay(const DateTime *dateTime) {
+    int months = ((int)dateTime->year - 1900) * 12 + (int)dateTime->month - 1;
+    return months * 31 + (int)dateTime->day - 1;
+}
+
+/**
+ * @brief Frees every bitmap and leaves the index unbuilt.
+ */
+static void freeIndex() {
+    FlightIndex *x = &flightIndex;
+    for (int s = 0; s < 3; s++) {
+        freeRoaring(x->statuses + s);
+    }
+    for (int i = 0; i < x->dayCount; i++) {
+        freeRoaring(&x->days[i].ids);
+    }
+    trackedFree(MEM_OTHER, x->days);
+    memset(x, 0, sizeof(*x));
+}
+
+/**
+ * @brief Finds the first day entry at or after a day.
+ *
+ * @param day The day number.
+ * @return The position of that entry (dayCount if every day is earlier).
+ */
+static int lowerDay(int day) {
+    int low = 0, high = flightIndex.dayCount;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (flightIndex.days[mid].day < day) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Returns the bitmap of a day, creating it if needed.
+ *
+ * @param day The day number.
+ * @return The bitmap, or NULL if memory allocation failed.
+ */
+static Roaring *dayBitmap(int day) {
+    FlightIndex *x = &flightIndex;
+    int position = lowerDay(day);
+    if (position < x->dayCount && x->days[position].day == day) {
+        return &x->days[position].ids;
+    }
+    if (x->dayCount == x->dayCapacity) {
+        int capacity = x->dayCapacity > 0 ? x->dayCapacity * 2 : 64;
+        DayBitmap *grown = (DayBitmap *)trackedRealloc(MEM_OTHER, x->days, (size_t)capacity * sizeof(DayBitmap));
+        if (grown == NULL) {
+            return NULL;
+        }
+        x->days = grown;
+        x->dayCapacity = capacity;
+    }
+    memmove(x->days + position + 1, x->days + position, (size_t)(x->dayCount - position) * sizeof(DayBitmap));
+    x->dayCount++;
+    x->days[position].day = day;
+    initRoaring(&x->days[position].ids);
+    return &x->days[position].ids;
+}
+
+/**
+ * @brief Adds a flight to its status and day bitmaps.
+ *
+ * @param f The flight.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int addToIndex(const Flight *f) {
+    uint32_t key = FLIGHT_INDEX_KEY(f->flightID);
+    if (f->status >= ON_TIME && f->status <= CANCELLED && !roaringAdd(flightIndex.statuses + f->status, key)) {
+        return 0;
+    }
+    Roaring *day = dayBitmap(departureDay(&f->departure));
+    return day != NULL && roaringAdd(day, key);
+}
+
+/**
+ * @brief Removes a flight from its status and day bitmaps.
+ *
+ * @param f The flight.
+ */
+static void removeFromIndex(const Flight *f) {
+    uint32_t key = FLIGHT_INDEX_KEY(f->flightID);
+    if (f->status >= ON_TIME && f->status <= CANCELLED) {
+        roaringRemove(flightIndex.statuses + f->status, key);
+    }
+    int day = departureDay(&f->departure);
+    int position = lowerDay(day);
+    if (position < flightIndex.dayCount && flightIndex.days[position].day == day) {
+        roaringRemove(&flightIndex.days[position].ids, key);
+    }
+}
+
+/**
+ * @brief Makes the index current for a flight table, rebuilding it if stale.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+int refreshFlightIndex(const Flight *flights, int flightCount) {
+    pthread_mutex_lock(&flightIndexLock);
+    FlightIndex *x = &flightIndex;
+    int ok = 1;
+    if (!x->built || x->table != flights || x->count != flightCount || x->version != flightTableVersion) {
+        freeIndex();
+        for (int i = 0; i < flightCount && ok; i++) {
+            ok = addToIndex(flights + i);
+        }
+        if (ok) {
+            x->built = 1;
+            x->table = flights;
+            x->count = flightCount;
+            x->version = flightTableVersion;
+        } else {
+            freeIndex();
+        }
+    }
+    pthread_mutex_unlock(&flightIndexLock);
+    return ok;
+}
+
+/**
+ * @brief Returns an upper bound on the size of a selection, without computing it.
+ *
+ * @param statusMask The statuses to include (bit s for status s).
+ * @param firstDay The first departure day (INT_MIN for no bound).
+ * @param lastDay The last departure day (INT_MAX for no bound).
+ * @return The smaller of the flights with those statuses and the flights on those days.
+ */
+long long estimateFlightSelection(int statusMask, int firstDay, int lastDay) {
+    pthread_mutex_lock(&flightIndexLock);
+    long long statusRows = 0, dayRows = 0;
+    for (int s = 0; s < 3; s++) {
+        if (statusMask & (1 << s)) {
+            statusRows += roaringCardinality(flightIndex.statuses + s);
+        }
+    }
+    for (int i = lowerDay(firstDay); i < flightIndex.dayCount && flightIndex.days[i].day <= lastDay; i++) {
+        dayRows += roaringCardinality(&flightIndex.days[i].ids);
+    }
+    pthread_mutex_unlock(&flightIndexLock);
+    return statusRows < dayRows ? statusRows : dayRows;
+}
+
+/**
+ * @brief Selects the flights with one of the statuses departing on one of the days.
+ *
+ * @param statusMask The statuses to include (bit s for status s).
+ * @param firstDay The first departure day (INT_MIN for no bound).
+ * @param lastDay The last departure day (INT_MAX for no bound).
+ * @param result Receives the flight IDs as FLIGHT_INDEX_KEY values (must be initialized; replaced).
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+int selectFlights(int statusMask, int firstDay, int lastDay, Roaring *result) {
+    pthread_mutex_lock(&flightIndexLock);
+    freeRoaring(result);
+    int ok = 1;
+    if (firstDay == INT_MIN && lastDay == INT_MAX) {
+        // No day bound: the union of the statuses
+        for (int s = 0; s < 3 && ok; s++) {
+            if (statusMask & (1 << s)) {
+                ok = roaringOrInPlace(result, flightIndex.statuses + s);
+            }
+        }
+    } else {
+        // OR the days, then AND with each status and OR those parts together
+        Roaring days, part;
+        initRoaring(&days);
+        initRoaring(&part);
+        for (int i = lowerDay(firstDay); ok && i < flightIndex.dayCount && flightIndex.days[i].day <= lastDay; i++) {
+            ok = roaringOrInPlace(&days, &flightIndex.days[i].ids);
+        }
+        if ((statusMask & FLIGHT_STATUS_ALL) == FLIGHT_STATUS_ALL) {
+            *result = days; // Every status: the days alone
+            initRoaring(&days);
+        } else {
+            for (int s = 0; s < 3 && ok; s++) {
+                if (statusMask & (1 << s)) {
+                    ok = roaringOrInPlace(&part, &days);
+                    roaringAndInPlace(&part, flightIndex.statuses + s);
+                    ok = ok && roaringOrInPlace(result, &part);
+                    freeRoaring(&part);
+                }
+            }
+        }
+        freeRoaring(&days);
+        freeRoaring(&part);
+    }
+    pthread_mutex_unlock(&flightIndexLock);
+    if (!ok) {
+        freeRoaring(result);
+    }
+    return ok;
+}
+
+/**
+ * @brief Reports whether the index matches a table as of the current flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @return 1 if an incremental update keeps it current, 0 if it must be rebuilt anyway.
+ */
+static int inSync(const Flight *flights) {
+    return flightIndex.built && flightIndex.table == flights && flightIndex.version == flightTableVersion;
+}
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights, including the new one.
+ * @param flight The new flight.
+ */
+void indexFlightInserted(const Flight *flights, int flightCount, const Flight *flight) {
+    pthread_mutex_lock(&flightIndexLock);
+    if (inSync(flights) && flightIndex.count == flightCount - 1) {
+        if (addToIndex(flight)) {
+            flightIndex.count = flightCount;
+            flightIndex.version = flightTableVersion + 1;
+        } else {
+            flightIndex.built = 0; // Rebuilt on the next refresh
+        }
+    }
+    pthread_mutex_unlock(&flightIndexLock);
+}
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights once it is removed.
+ * @param flight The flight being removed (still in the array).
+ */
+void indexFlightRemoved(const Flight *flights, int flightCount, const Flight *flight) {
+    pthread_mutex_lock(&flightIndexLock);
+    if (inSync(flights) && flightIndex.count == flightCount + 1) {
+        removeFromIndex(flight);
+        flightIndex.count = flightCount;
+        flightIndex.version = flightTableVersion + 1;
+    }
+    pthread_mutex_unlock(&flightIndexLock);
+}
+
+/**
+ * @brief Hook: a flight's status changed.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flight The flight, with its new status.
+ * @param previous Its previous status.
+ */
+void indexFlightStatusChanged(const Flight *flights, int flightCount, const Flight *flight, FlightStatus previous) {
+    pthread_mutex_lock(&flightIndexLock);
+    if (inSync(flights) && flightIndex.count == flightCount) {
+        uint32_t key = FLIGHT_INDEX_KEY(flight->flightID);
+        if (previous >= ON_TIME && previous <= CANCELLED) {
+            roaringRemove(flightIndex.statuses + previous, key);
+        }
+        if (flight->status >= ON_TIME && flight->status <= CANCELLED &&
+            !roaringAdd(flightIndex.statuses + flight->status, key)) {
+            flightIndex.built = 0;
+        }
+    }
+    pthread_mutex_unlock(&flightIndexLock);
+}
+
+/**
+ * @brief Hook: the flights were reordered. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+void indexFlightsReordered(const Flight *flights, int flightCount) {
+    pthread_mutex_lock(&flightIndexLock);
+    if (inSync(flights) && flightIndex.count == flightCount) {
+        flightIndex.version = flightTableVersion + 1; // IDs do not move with their rows
+    }
+    pthread_mutex_unlock(&flightIndexLock);
+}
+
+/**
+ * @brief Frees the index.
+ */
+void cleanupFlightIndex() {
+    pthread_mutex_lock(&flightIndexLock);
+    freeIndex();
+    pthread_mutex_unlock(&flightIndexLock);
+}
@@ -0,0 +1,312 @@
+/**
+ * @file idindex.c
+ * @brief Implementation of the flight ID and ticket ID hash indexes.
+ *
+ * An index is an open-addressing table of (ID, position) slots with linear
+ * probing, at most half full, addressed by the top bits of a multiplicative
+ * hash of the ID. A lookup is done for ID_INDEX_GROUP keys at a time: every
+ * key of the group is hashed and its slot prefetched before any slot is
+ * probed, and every record found is prefetched before the group is returned.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h> // For uint32_t
+#include <pthread.h>
+
+#include "idindex.h"
+#include "flight.h"
+#include "ticket.h"
+#include "memstats.h"
+
+/**
+ * @struct IDSlot
+ * @brief One slot of an index.
+ */
+typedef struct {
+    int key;            /**< Flight or ticket ID. */
+    int position;       /**< Position of the record in its table, or -1 if the slot is empty. */
+} IDSlot;
+
+/**
+ * @struct IDIndex
+ * @brief A hash index and the table state it was built for.
+ */
+typedef struct {
+    IDSlot *slots;          /**< Slots (a power of two of them). */
+    int shift;              /**< 32 minus log2 of the slot count. */
+    int capacity;           /**< Allocated slots. */
+    int count;              /**< The table's record count when built. */
+    const void *table;      /**< Table the index was built over. */
+    unsigned long version;  /**< Table version the index was built for. */
+    int built;              /**< 1 once the index has been built. */
+    pthread_mutex_t lock;   /**< Serializes rebuilds and lookups. */
+} IDIndex;
+
+static IDIndex flightIDIndex = { .lock = PTHREAD_MUTEX_INITIALIZER }; /**< Flights by flight ID. */
+static IDIndex ticketIDIndex = { .lock = PTHREAD_MUTEX_INITIALIZER }; /**< Tickets by ticket ID. */
+
+/**
+ * @brief Returns the home slot of an ID (Fibonacci hashing).
+ *
+ * @param index The index.
+ * @param key The ID.
+ * @return The slot number.
+ */
+static uint32_t homeSlot(const IDIndex *index, int key) {
+    return ((uint32_t)key * 2654435769u) >> index->shift;
+}
+
+/**
+ * @brief Reports whether an index needs rebuilding for the given table state.
+ *
+ * @param index The index.
+ * @param table The table.
+ * @param count The table's record count.
+ * @param version The table's version.
+ * @return 1 if stale, 0 if current.
+ */
+static int isStale(const IDIndex *index, const void *table, int count, unsigned long version) {
+    return !index->built || index->table != table || index->count != count || index->version != version;
+}
+
+/**
+ * @brief Empties an index sized for count records and records the table state.
+ *
+ * @param index The index.
+ * @param table The table.
+ * @param count The table's record count.
+ * @param version The table's version.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int prepareIndex(IDIndex *index, const void *table, int count, unsigned long version) {
+    int size = 16, shift = 28;
+    while (size < count * 2) {
+        size *= 2;
+        shift--;
+    }
+    if (size > index->capacity) {
+        trackedFree(MEM_OTHER, index->slots);
+        index->slots = (IDSlot *)trackedMalloc(MEM_OTHER, (size_t)size * sizeof(IDSlot));
+        if (index->slots == NULL) {
+            printf("Error: Could not allocate memory for the ID index.\n");
+            index->capacity = 0;
+            index->built = 0;
+            return 0;
+        }
+        index->capacity = size;
+    }
+    memset(index->slots, 0xFF, (size_t)size * sizeof(IDSlot)); // Every position -1
+    index->shift = shift;
+    index->table = table;
+    index->count = count;
+    index->version = version;
+    index->built = 1;
+    return 1;
+}
+
+/**
+ * @brief Adds an ID unless it is already present (the first position wins).
+ *
+ * @param index The index.
+ * @param key The ID.
+ * @param position The position of its record.
+ */
+static void insertID(IDIndex *index, int key, int position) {
+    uint32_t mask = (uint32_t)(1u << (32 - index->shift)) - 1;
+    uint32_t i = homeSlot(index, key);
+    while (index->slots[i].position >= 0) {
+        if (index->slots[i].key == key) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    index->slots[i].key = key;
+    index->slots[i].position = position;
+}
+
+/**
+ * @brief Looks up IDs one group at a time, overlapping the slot and record fetches of a group.
+ *
+ * @param index The index (built and locked).
+ * @param keys The IDs to look up.
+ * @param count The number of IDs.
+ * @param positions Receives the position of each ID, or -1.
+ * @param records The table, for prefetching the records found.
+ * @param recordSize The size of one record.
+ * @return The number of IDs found.
+ */
+static int lookupIDs(const IDIndex *index, const int *keys, int count, int *positions,
+                     const char *records, size_t recordSize) {
+    uint32_t mask = (uint32_t)(1u << (32 - index->shift)) - 1;
+    uint32_t home[ID_INDEX_GROUP];
+    int found = 0;
+    for (int start = 0; start < count; start += ID_INDEX_GROUP) {
+        int n = count - start < ID_INDEX_GROUP ? count - start : ID_INDEX_GROUP;
+        for (int g = 0; g < n; g++) {
+            home[g] = homeSlot(index, keys[start + g]);
+            __builtin_prefetch(index->slots + home[g], 0, 1);
+        }
+        for (int g = 0; g < n; g++) {
+            int key = keys[start + g];
+            int position = -1;
+            for (uint32_t i = home[g]; index->slots[i].position >= 0; i = (i + 1) & mask) {
+                if (index->slots[i].key == key) {
+                    position = index->slots[i].position;
+                    __builtin_prefetch(records + (size_t)position * recordSize, 0, 1);
+                    found++;
+                    break;
+                }
+            }
+            positions[start + g] = position;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Rebuilds the flight index if the flight table changed.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 if the index is current, 0 if memory allocation failed.
+ */
+static int syncFlightIndex(const Flight *flights, int flightCount) {
+    IDIndex *index = &flightIDIndex;
+    if (!isStale(index, flights, flightCount, flightTableVersion)) {
+        return 1;
+    }
+    if (!prepareIndex(index, flights, flightCount, flightTableVersion)) {
+        return 0;
+    }
+    for (int i = 0; i < flightCount; i++) {
+        insertID(index, flights[i].flightID, i);
+    }
+    return 1;
+}
+
+/**
+ * @brief Rebuilds the ticket index if the ticket table changed.
+ *
+ * @return 1 if the index is current, 0 if memory allocation failed.
+ */
+static int syncTicketIndex() {
+    IDIndex *index = &ticketIDIndex;
+    if (!isStale(index, globalTickets, globalTicketCount, ticketTableVersion)) {
+        return 1;
+    }
+    if (!prepareIndex(index, globalTickets, globalTicketCount, ticketTableVersion)) {
+        return 0;
+    }
+    for (int i = 0; i < globalTicketCount; i++) {
+        insertID(index, globalTickets[i].ticketID, i);
+    }
+    return 1;
+}
+
+/**
+ * @brief Finds the positions of many flights by ID.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param positions Receives the position of each ID, or -1 if it is not in the table.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int findFlightIndexes(const Flight *flights, int flightCount, const int *flightIDs, int count, int *positions) {
+    pthread_mutex_lock(&flightIDIndex.lock);
+    int found = -1;
+    if (syncFlightIndex(flights, flightCount)) {
+        found = lookupIDs(&flightIDIndex, flightIDs, count, positions, (const char *)flights, sizeof(Flight));
+    }
+    pthread_mutex_unlock(&flightIDIndex.lock);
+    return found;
+}
+
+/**
+ * @brief Finds many flights by ID.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param out Receives a pointer to each flight (prefetched), or NULL if it is not in the table.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int searchFlights(const Flight *flights, int flightCount, const int *flightIDs, int count, const Flight **out) {
+    int positions[ID_INDEX_GROUP];
+    int found = 0;
+    for (int start = 0; start < count; start += ID_INDEX_GROUP) {
+        int n = count - start < ID_INDEX_GROUP ? count - start : ID_INDEX_GROUP;
+        int hits = findFlightIndexes(flights, flightCount, flightIDs + start, n, positions);
+        if (hits < 0) {
+            return -1;
+        }
+        for (int g = 0; g < n; g++) {
+            out[start + g] = positions[g] >= 0 ? flights + positions[g] : NULL;
+        }
+        found += hits;
+    }
+    return found;
+}
+
+/**
+ * @brief Finds the positions of many tickets in globalTickets by ID.
+ *
+ * @param ticketIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param positions Receives the position of each ID, or -1 if there is no such ticket.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int findTicketIndexes(const int *ticketIDs, int count, int *positions) {
+    pthread_mutex_lock(&ticketIDIndex.lock);
+    int found = -1;
+    if (syncTicketIndex()) {
+        found = lookupIDs(&ticketIDIndex, ticketIDs, count, positions, (const char *)globalTickets, sizeof(Ticket));
+    }
+    pthread_mutex_unlock(&ticketIDIndex.lock);
+    return found;
+}
+
+/**
+ * @brief Finds many tickets by ID.
+ *
+ * @param ticketIDs The IDs to look up.
+ * @param count The number of IDs.
+ * @param out Receives a pointer into globalTickets for each ID (prefetched), or NULL if there is no such ticket.
+ * @return The number of IDs found, or -1 if the index could not be built (memory allocation failed).
+ */
+int searchTickets(const int *ticketIDs, int count, const Ticket **out) {
+    int positions[ID_INDEX_GROUP];
+    int found = 0;
+    for (int start = 0; start < count; start += ID_INDEX_GROUP) {
+        int n = count - start < ID_INDEX_GROUP ? count - start : ID_INDEX_GROUP;
+        int hits = findTicketIndexes(ticketIDs + start, n, positions);
+        if (hits < 0) {
+            return -1;
+        }
+        for (int g = 0; g < n; g++) {
+            out[start + g] = positions[g] >= 0 ? globalTickets + positions[g] : NULL;
+        }
+        found += hits;
+    }
+    return found;
+}
+
+/**
+ * @brief Frees both indexes.
+ */
+void cleanupIDIndexes() {
+    IDIndex *indexes[2] = { &flightIDIndex, &ticketIDIndex };
+    for (int i = 0; i < 2; i++) {
+        pthread_mutex_lock(&indexes[i]->lock);
+        trackedFree(MEM_OTHER, indexes[i]->slots);
+        indexes[i]->slots = NULL;
+        indexes[i]->capacity = 0;
+        indexes[i]->built = 0;
+        pthread_mutex_unlock(&indexes[i]->lock);
+    }
+}
@@ -0,0 +1,688 @@
+/**
+ * @file inventory.c
+ * @brief Implementation of seat inventory functions and the shared-memory segment.
+ *
+ * Seat claims use GCC atomic builtins on the Flight's availableSeats counter
+ * and seat map bytes, so they are safe whether the Flight lives in this
+ * process's heap or in a segment shared with other processes. The segment
+ * is created with POSIX shm_open/mmap; on platforms without POSIX shared
+ * memory the segment functions report failure and the system runs with a
+ * process-local inventory only.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <errno.h>    // For EEXIST, EOWNERDEAD
+#include <fcntl.h>    // For O_CREAT, O_EXCL, O_RDWR
+#include <sys/mman.h> // For shm_open, mmap, munmap, shm_unlink
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For ftruncate, close, usleep
+#endif
+
+#include "inventory.h"
+#include "availability.h" // For availabilitySeatsChanged
+#include "aggregates.h"   // For aggregateSeatsChanged
+#include "resultcache.h"  // For cacheSeatsChanged
+#include "idindex.h"      // For findFlightIndexes
+#include "memstats.h"
+
+/**
+ * @var flightSeatVersion
+ * @brief Incremented whenever a seat is claimed, released or synced from the segment.
+ */
+unsigned long flightSeatVersion = 0;
+
+/**
+ * @brief Atomically decrements a seat counter if it is still positive.
+ *
+ * @param seats A pointer to the availableSeats counter.
+ * @return 1 if a seat was taken from the counter, 0 if it was already zero.
+ */
+static int takeSeatCount(int *seats) {
+    int current = __atomic_load_n(seats, __ATOMIC_ACQUIRE);
+    while (current > 0) {
+        if (__atomic_compare_exchange_n(seats, &current, current - 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Atomically claims a seat on a flight.
+ *
+ * The seat bit is the single point of arbitration: the counter is reserved
+ * first, and given back if another claimant already owns the bit.
+ *
+ * @param flight A pointer to the Flight to book on.
+ * @param seatNo The 1-based seat number to claim.
+ * @return 1 on success, 0 on failure (e.g., invalid seat, seat already booked, no seats left).
+ */
+int claimFlightSeat(Flight *flight, int seatNo) {
+    if (flight == NULL || seatNo <= 0 || seatNo > MAX_PASSENGERS_PER_FLIGHT) {
+        return 0; // Failure
+    }
+    if (!takeSeatCount(&flight->availableSeats)) {
+        return 0; // Failure: flight is full
+    }
+
+    unsigned char mask = SEAT_MASK(seatNo);
+    unsigned char old = __atomic_fetch_or(&flight->seatMap[SEAT_BYTE(seatNo)], mask, __ATOMIC_ACQ_REL);
+    if (old & mask) {
+        __atomic_add_fetch(&flight->availableSeats, 1, __ATOMIC_ACQ_REL); // Give the count back
+        return 0; // Failure: someone else holds this seat
+    }
+    unsigned long version = __atomic_add_fetch(&flightSeatVersion, 1, __ATOMIC_RELEASE);
+    availabilitySeatsChanged(flight, version);
+    aggregateSeatsChanged(flight, 1, version);
+    cacheSeatsChanged(flight, version);
+    return 1; // Success
+}
+
+/**
+ * @brief Atomically releases a previously claimed seat on a flight.
+ *
+ * @param flight A pointer to the Flight the seat belongs to.
+ * @param seatNo The 1-based seat number to release.
+ * @return 1 on success, 0 on failure (e.g., invalid seat or seat not booked).
+ */
+int releaseFlightSeat(Flight *flight, int seatNo) {
+    if (flight == NULL || seatNo <= 0 || seatNo > MAX_PASSENGERS_PER_FLIGHT) {
+        return 0; // Failure
+    }
+
+    unsigned char mask = SEAT_MASK(seatNo);
+    unsigned char old = __atomic_fetch_and(&flight->seatMap[SEAT_BYTE(seatNo)],
+                                           (unsigned char)~mask, __ATOMIC_ACQ_REL);
+    if (!(old & mask)) {
+        return 0; // Failure: seat was not booked
+    }
+    __atomic_add_fetch(&flight->availableSeats, 1, __ATOMIC_ACQ_REL);
+    unsigned long version = __atomic_add_fetch(&flightSeatVersion, 1, __ATOMIC_RELEASE);
+    availabilitySeatsChanged(flight, version);
+    aggregateSeatsChanged(flight, -1, version);
+    cacheSeatsChanged(flight, version);
+    return 1; // Success
+}
+
+/**
+ * @brief Finds the owner entry of a seat of a flight in the segment.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flight The flight, a slot of the segment.
+ * @param seatNo The 1-based seat number.
+ * @return A pointer to the owning ticket ID, or NULL if the flight is not a slot of the segment or the seat is invalid.
+ */
+static int *seatOwner(const SharedInventory *inv, const Flight *flight, int seatNo) {
+    if (inv == NULL || inv->base == NULL || flight == NULL || seatNo <= 0 || seatNo > MAX_PASSENGERS_PER_FLIGHT) {
+        return NULL;
+    }
+    const Flight *slots = (const Flight *)((const char *)inv->base + inv->base->flightsOffset);
+    if (flight < slots || flight >= slots + inv->base->capacity) {
+        return NULL;
+    }
+    int *owners = (int *)((char *)inv->base + inv->base->ownersOffset);
+    return owners + (size_t)(flight - slots) * MAX_PASSENGERS_PER_FLIGHT + (seatNo - 1);
+}
+
+/**
+ * @brief Records which ticket holds a seat just claimed on a flight of the segment.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flight The flight, a slot of the segment.
+ * @param seatNo The 1-based seat number.
+ * @param ticketID The ID of the ticket that holds the seat.
+ */
+void inventorySetSeatOwner(SharedInventory *inv, const Flight *flight, int seatNo, int ticketID) {
+    int *owner = seatOwner(inv, flight, seatNo);
+    if (owner != NULL) {
+        __atomic_store_n(owner, ticketID, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief Releases a seat of a flight in the segment on behalf of the ticket that holds it.
+ *
+ * The owner entry is swapped to INVENTORY_SEAT_RELEASED before the seat bit
+ * is cleared, so of several processes cancelling copies of one ticket only
+ * the first releases the seat. Ticket IDs are unique across processes and
+ * a released entry never returns to 0, so a later holder is never mistaken
+ * for the cancelled ticket.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flight The flight, a slot of the segment.
+ * @param seatNo The 1-based seat number.
+ * @param ticketID The ID of the ticket being cancelled.
+ * @return 1 if the seat was released, 0 if the ticket no longer holds it (or the seat is invalid).
+ */
+int inventoryReleaseSeat(SharedInventory *inv, Flight *flight, int seatNo, int ticketID) {
+    int *owner = seatOwner(inv, flight, seatNo);
+    if (owner == NULL) {
+        return 0; // Failure
+    }
+    int current = __atomic_load_n(owner, __ATOMIC_ACQUIRE);
+    if (current != ticketID && current != 0) { // 0: booked before the segment existed
+        return 0; // Failure: released already, or held by a later ticket
+    }
+    if (!__atomic_compare_exchange_n(owner, &current, INVENTORY_SEAT_RELEASED, 0, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE)) {
+        return 0; // Failure: another process cancelled the same ticket first
+    }
+    return releaseFlightSeat(flight, seatNo);
+}
+
+/**
+ * @brief Claims the same seat on several flights (the legs of one trip), on all of them or on none.
+ *
+ * @param flights The flights (NULL entries make the call fail).
+ * @param count The number of flights.
+ * @param seatNo The 1-based seat number to claim.
+ * @return 1 if the seat was claimed on every flight, 0 otherwise.
+ */
+int claimFlightSeats(Flight *const *flights, int count, int seatNo) {
+    for (int i = 0; i < count; i++) {
+        if (!claimFlightSeat(flights[i], seatNo)) {
+            while (--i >= 0) {
+                releaseFlightSeat(flights[i], seatNo); // Undo the legs already held
+            }
+            return 0; // Failure
+        }
+    }
+    return 1; // Success
+}
+
+/**
+ * @brief Computes the segment size needed for a given number of Flight slots.
+ *
+ * The Flight array starts at the first offset after the header that is
+ * suitably aligned for a Flight; the seat owners follow it.
+ *
+ * @param capacity The number of Flight slots.
+ * @param flightsOffset Receives the byte offset of the first Flight slot.
+ * @param ownersOffset Receives the byte offset of the seat owners.
+ * @return The total segment size in bytes.
+ */
+static size_t inventorySegmentSize(int capacity, size_t *flightsOffset, size_t *ownersOffset) {
+    size_t align = _Alignof(Flight) > 64 ? _Alignof(Flight) : 64; // Start slots on a cache line
+    size_t offset = (sizeof(InventoryHeader) + align - 1) / align * align;
+    *flightsOffset = offset;
+    offset += (size_t)capacity * sizeof(Flight);
+    *ownersOffset = (offset + align - 1) / align * align;
+    return *ownersOffset + (size_t)capacity * MAX_PASSENGERS_PER_FLIGHT * sizeof(int);
+}
+
+/**
+ * @brief Copies a segment name into a handle, rejecting names that do not fit.
+ *
+ * @param inv A pointer to the handle.
+ * @param name The shared-memory object name.
+ * @return 1 on success, 0 if the name is NULL, empty or too long.
+ */
+static int setInventoryName(SharedInventory *inv, const char *name) {
+    if (name == NULL || name[0] == '\0' || strlen(name) >= INVENTORY_NAME_LEN) {
+        printf("Error: Invalid shared inventory name.\n");
+        return 0;
+    }
+    strcpy(inv->name, name);
+    return 1;
+}
+
+#if !defined(_WIN32)
+
+/**
+ * @brief Creates a shared-memory inventory segment that does not exist yet.
+ *
+ * O_EXCL makes exactly one process the creator; attachers wait until the
+ * creator has published its flights (see attachInventory).
+ *
+ * @param inv A pointer to the handle to initialize.
+ * @param name The shared-memory object name (must start with '/').
+ * @param capacity The number of Flight slots to reserve.
+ * @return 1 on success, 0 on failure (e.g., segment already exists, shm_open/mmap failed, unsupported platform).
+ */
+int createInventory(SharedInventory *inv, const char *name, int capacity) {
+    inv->base = NULL;
+    inv->size = 0;
+    if (capacity <= 0 || !setInventoryName(inv, name)) {
+        return 0; // Failure
+    }
+
+    size_t flightsOffset, ownersOffset;
+    size_t size = inventorySegmentSize(capacity, &flightsOffset, &ownersOffset); // ftruncate zeroes the owners
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        if (errno != EEXIST) { // EEXIST: another process created it first, the caller attaches
+            printf("Error: Could not create shared inventory %s (%s).\n", name, strerror(errno));
+        }
+        return 0;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        printf("Error: Could not size shared inventory %s.\n", name);
+        close(fd);
+        shm_unlink(name); // Let the next process create it again
+        return 0;
+    }
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the object alive
+    if (base == MAP_FAILED) {
+        printf("Error: Could not map shared inventory %s.\n", name);
+        shm_unlink(name);
+        return 0;
+    }
+
+    InventoryHeader *header = (InventoryHeader *)base;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED); // Locked through every process's mapping
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);    // Not held forever by a process that died
+    int locked = pthread_mutex_init(&header->addLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (locked != 0) {
+        printf("Error: Could not set up the lock of shared inventory %s.\n", name);
+        munmap(base, size);
+        shm_unlink(name);
+        return 0;
+    }
+    header->version = INVENTORY_VERSION;
+    header->nextTicketID = 1;
+    header->capacity = capacity;
+    header->flightsOffset = flightsOffset;
+    header->ownersOffset = ownersOffset;
+    header->segmentSize = size;
+    __atomic_store_n(&header->flightCount, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->published, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->magic, INVENTORY_MAGIC, __ATOMIC_RELEASE); // Publish last
+
+    inv->base = header;
+    inv->size = size;
+    return 1; // Success
+}
+
+/**
+ * @brief Attaches to an existing shared-memory inventory segment.
+ *
+ * @param inv A pointer to the handle to initialize.
+ * @param name The shared-memory object name.
+ * @return 1 on success, 0 on failure (e.g., segment missing or not a valid inventory).
+ */
+int attachInventory(SharedInventory *inv, const char *name) {
+    inv->base = NULL;
+    inv->size = 0;
+    if (!setInventoryName(inv, name)) {
+        return 0; // Failure
+    }
+
+    int fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0) {
+        return 0; // Not an error worth reporting: the caller may create it instead
+    }
+    // A segment that was just created may not be sized or published yet
+    struct stat st;
+    int waited = 0;
+    while ((fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(InventoryHeader)) && waited < 200) {
+        usleep(10000);
+        waited++;
+    }
+    if ((size_t)st.st_size < sizeof(InventoryHeader)) {
+        printf("Error: Shared inventory %s was never initialized.\n", name);
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Error: Could not map shared inventory %s.\n", name);
+        return 0;
+    }
+
+    InventoryHeader *header = (InventoryHeader *)base;
+    while ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != INVENTORY_MAGIC ||
+            !__atomic_load_n(&header->published, __ATOMIC_ACQUIRE)) && waited < 200) {
+        usleep(10000);
+        waited++;
+    }
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != INVENTORY_MAGIC ||
+        header->version != INVENTORY_VERSION || header->segmentSize > size ||
+        !__atomic_load_n(&header->published, __ATOMIC_ACQUIRE)) {
+        printf("Error: %s is not a compatible flight inventory.\n", name);
+        munmap(base, size);
+        return 0;
+    }
+
+    inv->base = header;
+    inv->size = size;
+    return 1; // Success
+}
+
+/**
+ * @brief Takes the segment's add lock, taking it over from a process that died holding it.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @return 1 once the lock is held, 0 on failure.
+ */
+static int lockInventoryAdds(SharedInventory *inv) {
+    int locked = pthread_mutex_lock(&inv->base->addLock);
+    if (locked == EOWNERDEAD) {
+        // The holder died before publishing; its unpublished slot is simply reused
+        pthread_mutex_consistent(&inv->base->addLock);
+        locked = 0;
+    }
+    if (locked != 0) {
+        printf("Error: Could not lock shared inventory %s (%s).\n", inv->name, strerror(locked));
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Releases the segment's add lock.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ */
+static void unlockInventoryAdds(SharedInventory *inv) {
+    pthread_mutex_unlock(&inv->base->addLock);
+}
+
+/**
+ * @brief Unmaps the segment from this process. The segment itself persists.
+ *
+ * @param inv A pointer to the handle to detach.
+ */
+void detachInventory(SharedInventory *inv) {
+    if (inv != NULL && inv->base != NULL) {
+        munmap(inv->base, inv->size);
+        inv->base = NULL;
+        inv->size = 0;
+    }
+}
+
+/**
+ * @brief Removes the named shared-memory object from the system.
+ *
+ * @param name The shared-memory object name.
+ * @return 1 on success, 0 on failure.
+ */
+int destroyInventory(const char *name) {
+    return shm_unlink(name) == 0;
+}
+
+#else // _WIN32
+
+int createInventory(SharedInventory *inv, const char *name, int capacity) {
+    (void)name; (void)capacity;
+    inv->base = NULL;
+    inv->size = 0;
+    printf("Shared inventory is not supported on this platform.\n");
+    return 0;
+}
+
+int attachInventory(SharedInventory *inv, const char *name) {
+    (void)name;
+    inv->base = NULL;
+    inv->size = 0;
+    return 0;
+}
+
+void detachInventory(SharedInventory *inv) {
+    (void)inv;
+}
+
+int destroyInventory(const char *name) {
+    (void)name;
+    return 0;
+}
+
+static int lockInventoryAdds(SharedInventory *inv) {
+    (void)inv;
+    return 0;
+}
+
+static void unlockInventoryAdds(SharedInventory *inv) {
+    (void)inv;
+}
+
+#endif // _WIN32
+
+/**
+ * @brief Copies a Flight table into the shared segment.
+ *
+ * The count is stored with release ordering after the slots are written, so
+ * an attached reader never observes a slot before its contents.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flights A pointer to the array of Flight structures to publish.
+ * @param flightCount The number of flights in the array.
+ * @return 1 on success, 0 on failure (e.g., segment too small).
+ */
+int publishFlights(SharedInventory *inv, const Flight *flights, int flightCount) {
+    if (inv == NULL || inv->base == NULL) {
+        return 0; // Failure
+    }
+    if (flightCount > inv->base->capacity) {
+        printf("Error: Shared inventory holds %d flights, cannot publish %d.\n",
+               inv->base->capacity, flightCount);
+        return 0; // Failure
+    }
+
+    Flight *slots = (Flight *)((char *)inv->base + inv->base->flightsOffset);
+    if (flightCount > 0) {
+        memcpy(slots, flights, (size_t)flightCount * sizeof(Flight));
+    }
+    __atomic_store_n(&inv->base->flightCount, flightCount, __ATOMIC_RELEASE);
+    __atomic_store_n(&inv->base->published, 1, __ATOMIC_RELEASE); // Attachers may proceed
+    return 1; // Success
+}
+
+/**
+ * @brief Appends one flight to the segment (e.g., after addFlight in one process).
+ *
+ * Under the add lock, the ID is checked against the published flights and
+ * the next slot is filled before the count is stored with release ordering,
+ * so readers never see a slot before its contents. Readers do not take the
+ * lock.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flight The flight to copy into a new slot.
+ * @return 1 on success, 0 on failure (e.g., segment full, ID already in the segment).
+ */
+int inventoryAddFlight(SharedInventory *inv, const Flight *flight) {
+    if (inv == NULL || inv->base == NULL || flight->flightID == INVENTORY_DELETED_ID) {
+        return 0; // Failure
+    }
+    if (!lockInventoryAdds(inv)) {
+        return 0; // Failure
+    }
+    int added = 0;
+    int slot = __atomic_load_n(&inv->base->flightCount, __ATOMIC_ACQUIRE);
+    if (inventoryFindFlight(inv, flight->flightID) != NULL) {
+        printf("Error: Flight %d is already in the shared inventory.\n", flight->flightID);
+    } else if (slot >= inv->base->capacity) {
+        printf("Error: Shared inventory is full (%d flights).\n", inv->base->capacity);
+    } else {
+        Flight *slots = (Flight *)((char *)inv->base + inv->base->flightsOffset);
+        slots[slot] = *flight;
+        __atomic_store_n(&inv->base->flightCount, slot + 1, __ATOMIC_RELEASE);
+        added = 1;
+    }
+    unlockInventoryAdds(inv);
+    return added;
+}
+
+/**
+ * @brief Deletes a flight from the segment; its slot is marked INVENTORY_DELETED_ID and never reused.
+ *
+ * Other processes may still hold a pointer to the slot, so it is not
+ * compacted; its seats are emptied so no claim can succeed on it.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flightID The ID of the flight to delete.
+ * @return 1 on success, 0 if the flight is not in the segment.
+ */
+int inventoryRemoveFlight(SharedInventory *inv, int flightID) {
+    Flight *f = flightID == INVENTORY_DELETED_ID ? NULL : inventoryFindFlight(inv, flightID);
+    if (f == NULL) {
+        return 0; // Failure
+    }
+    __atomic_store_n(&f->availableSeats, 0, __ATOMIC_RELEASE);
+    return __atomic_compare_exchange_n(&f->flightID, &flightID, INVENTORY_DELETED_ID, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Copies the flights of the segment (without deleted slots) into a local array.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flights Receives the flights.
+ * @param capacity The capacity of flights.
+ * @return The number of flights copied.
+ */
+int copyInventoryFlights(const SharedInventory *inv, Flight *flights, int capacity) {
+    int count = inventoryFlightCount(inv), copied = 0;
+    for (int i = 0; i < count && copied < capacity; i++) {
+        const Flight *f = inventoryFlightAt(inv, i);
+        if (__atomic_load_n(&f->flightID, __ATOMIC_ACQUIRE) != INVENTORY_DELETED_ID) {
+            flights[copied++] = *f;
+        }
+    }
+    return copied;
+}
+
+/**
+ * @brief Raises the segment's next ticket ID to at least a given value.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param nextTicketID The lowest ID the segment may hand out next.
+ */
+void seedInventoryTicketIDs(SharedInventory *inv, int nextTicketID) {
+    int current = __atomic_load_n(&inv->base->nextTicketID, __ATOMIC_ACQUIRE);
+    while (current < nextTicketID &&
+           !__atomic_compare_exchange_n(&inv->base->nextTicketID, &current, nextTicketID, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        // current was reloaded; retry while it is still lower
+    }
+}
+
+/**
+ * @brief Hands out a ticket ID that is unique across every attached process.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @return The ticket ID.
+ */
+int takeInventoryTicketID(SharedInventory *inv) {
+    return __atomic_fetch_add(&inv->base->nextTicketID, 1, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * @brief Returns the number of flights currently published in the segment.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @return The published flight count, or 0 if the handle is detached.
+ */
+int inventoryFlightCount(const SharedInventory *inv) {
+    if (inv == NULL || inv->base == NULL) {
+        return 0;
+    }
+    return __atomic_load_n(&inv->base->flightCount, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Resolves a flight slot of the segment to an address in this process.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param index The slot index (0 to inventoryFlightCount() - 1).
+ * @return A pointer to the Flight in the segment, or NULL if the index is out of range.
+ */
+Flight *inventoryFlightAt(const SharedInventory *inv, int index) {
+    if (index < 0 || index >= inventoryFlightCount(inv)) {
+        return NULL;
+    }
+    return (Flight *)((char *)inv->base + inv->base->flightsOffset) + index;
+}
+
+/**
+ * @brief Finds a flight in the segment by its ID.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flightID The ID of the flight to look up.
+ * @return A pointer to the Flight in the segment, or NULL if not found.
+ */
+Flight *inventoryFindFlight(const SharedInventory *inv, int flightID) {
+    int count = inventoryFlightCount(inv);
+    for (int i = 0; i < count; i++) {
+        Flight *f = inventoryFlightAt(inv, i);
+        if (__atomic_load_n(&f->flightID, __ATOMIC_ACQUIRE) == flightID) {
+            return f;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Copies seat maps and seat counts from the segment back into a local Flight table.
+ *
+ * The segment's flights are matched to the table in one batched ID lookup.
+ * Each flight whose seats changed goes through the same hooks as a local
+ * claim or release, so the derived views are patched rather than rebuilt.
+ *
+ * @param inv A pointer to an attached inventory handle.
+ * @param flights A pointer to the local array of Flight structures.
+ * @param flightCount The number of flights in the local array.
+ * @return The number of flights updated.
+ */
+int syncFlightsFromInventory(const SharedInventory *inv, Flight *flights, int flightCount) {
+    int count = inventoryFlightCount(inv);
+    if (count == 0) {
+        return 0;
+    }
+    int *ids = (int *)trackedMalloc(MEM_OTHER, (size_t)count * 2 * sizeof(int));
+    if (ids == NULL) {
+        printf("Error: Could not allocate memory to sync seats from the shared inventory.\n");
+        return 0;
+    }
+    int *positions = ids + count;
+    for (int i = 0; i < count; i++) {
+        ids[i] = __atomic_load_n(&inventoryFlightAt(inv, i)->flightID, __ATOMIC_ACQUIRE);
+    }
+    if (findFlightIndexes(flights, flightCount, ids, count, positions) < 0) {
+        printf("Error: Could not allocate memory for the flight ID index.\n");
+        trackedFree(MEM_OTHER, ids);
+        return 0;
+    }
+    int updated = 0;
+    for (int i = 0; i < count; i++) {
+        if (positions[i] < 0 || ids[i] == INVENTORY_DELETED_ID) {
+            continue; // Not in this table
+        }
+        const Flight *shared = inventoryFlightAt(inv, i);
+        Flight *local = flights + positions[i];
+        int sold = 0, changed = 0;
+        for (int j = 0; j < SEAT_MAP_BYTES; j++) {
+            unsigned char seats = __atomic_load_n(&shared->seatMap[j], __ATOMIC_ACQUIRE);
+            if (seats != local->seatMap[j]) {
+                sold += __builtin_popcount(seats) - __builtin_popcount(local->seatMap[j]);
+                local->seatMap[j] = seats;
+                changed = 1;
+            }
+        }
+        int available = __atomic_load_n(&shared->availableSeats, __ATOMIC_ACQUIRE);
+        if (available != local->availableSeats) {
+            local->availableSeats = available;
+            changed = 1;
+        }
+        if (changed) {
+            unsigned long version = __atomic_add_fetch(&flightSeatVersion, 1, __ATOMIC_RELEASE);
+            availabilitySeatsChanged(local, version);
+            aggregateSeatsChanged(local, sold, version);
+            cacheSeatsChanged(local, version);
+        }
+        updated++;
+    }
+    trackedFree(MEM_OTHER, ids);
+    return updated;
+}
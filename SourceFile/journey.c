@@ -0,0 +1,974 @@
+/**
+ * @file journey.c
+ * @brief Implementation of multi-leg journey search (the Connection Scan Algorithm and RAPTOR).
+ *
+ * Airports are numbered in a hash of their names (the names point into the
+ * flight table), and every connection is 20 bytes: departure, arrival, the
+ * two airport numbers and the flight's table position, sorted by departure
+ * and then arrival. The per-airport search state is stamped with the number
+ * of the query that wrote it, so a query never clears it.
+ *
+ * An earliest-arrival query keeps, per airport, the earliest time a
+ * connection may leave it (the arrival plus the minimum connection time) and
+ * the connection that got there, which is followed back to list the legs.
+ * A profile query keeps, per airport, a list of (leave by, arrive) pairs in
+ * an arena, newest (earliest departure) first; each pair remembers its
+ * connection and the pair it continues with at the next airport.
+ *
+ * RAPTOR reads the same connections grouped into routes: two stable
+ * counting sorts (by destination, then origin) order them by origin,
+ * destination and departure, so the routes leaving an airport are adjacent
+ * and each route's flights are in departure order. A Pareto query keeps one
+ * bag of labels (arrival, fare, the label it extends) per round and airport;
+ * a label is dropped if any label of the same or an earlier round at that
+ * airport, or at the destination, arrives no later for no more. The airports
+ * whose bags changed in a round are bits in a word array, which the next
+ * round walks with count-trailing-zeros.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For qsort
+#include <string.h>
+#include <stdint.h> // For uint32_t, uint64_t
+#include <limits.h> // For INT_MAX
+#include <pthread.h>
+
+#include "journey.h"
+#include "flight.h"
+#include "memstats.h"
+
+/**
+ * @struct JourneyConnection
+ * @brief One flight as a connection between two airports.
+ */
+typedef struct {
+    int departure;      /**< Departure (see journeyMinutes). */
+    int arrival;        /**< Arrival (see journeyMinutes). */
+    int from;           /**< Origin airport number. */
+    int to;             /**< Destination airport number. */
+    int position;       /**< Position of the flight in the table. */
+} JourneyConnection;
+
+/**
+ * @struct JourneyPair
+ * @brief One entry of an airport's profile: leave by departure, reach the destination at arrival.
+ */
+typedef struct {
+    int departure;      /**< Departure of the connection leaving the airport. */
+    int arrival;        /**< Arrival at the destination. */
+    int connection;     /**< The connection leaving the airport. */
+    int onward;         /**< The pair continued with at the next airport, or -1 if the connection reaches the destination. */
+    int next;           /**< The next pair of the same airport (later departure), or -1. */
+} JourneyPair;
+
+/**
+ * @struct JourneyLabel
+ * @brief One way of reaching an airport in a Pareto query.
+ */
+typedef struct {
+    int arrival;        /**< Arrival at the airport. */
+    int ready;          /**< Earliest departure onward (arrival plus the connection time). */
+    int price;          /**< Fare of the journey so far. */
+    int connection;     /**< The connection that arrived, or -1 at the origin. */
+    int parent;         /**< The label the connection extended, or -1 at the origin. */
+    int next;           /**< The next label in the same bag, or -1. */
+} JourneyLabel;
+
+/**
+ * @struct JourneyRule
+ * @brief The minimum connection time of one airport.
+ */
+typedef struct {
+    char airport[MAX_NAME_LEN]; /**< The airport. */
+    int minutes;                /**< Its minimum connection time. */
+} JourneyRule;
+
+/**
+ * @struct JourneyIndex
+ * @brief The connection array, the airports and the search state, with the table state they were built for.
+ */
+typedef struct {
+    JourneyConnection *connections; /**< Connections by departure, then arrival. */
+    int connectionCount;            /**< Connections in use. */
+    int connectionCapacity;         /**< Allocated connections. */
+    JourneyPair *pairs;             /**< Profile arena (one pair per connection at most). */
+    const char **names;             /**< Airport names by number (point into the table). */
+    int *connectionTimes;           /**< Minimum connection time by airport. */
+    int *ready;                     /**< Earliest departure, or first profile pair, by airport. */
+    int *via;                       /**< Connection reaching the airport (earliest-arrival queries). */
+    unsigned int *stamps;           /**< Query that last wrote the airport's state. */
+    int stopCount;                  /**< Airports in use. */
+    int stopCapacity;               /**< Allocated airports. */
+    int *routeTrips;                /**< Connections by origin, destination, then departure. */
+    int *routeStarts;               /**< Start of each route in routeTrips (routeCount + 1 entries). */
+    int *routeTo;                   /**< Destination of each route. */
+    int *stopRoutes;                /**< First route leaving each airport (stopCount + 1 entries). */
+    int routeCount;                 /**< Routes in use. */
+    JourneyLabel *labels;           /**< Pareto label arena. */
+    int labelCount;                 /**< Labels in use. */
+    int labelCapacity;              /**< Allocated labels. */
+    int *bagHeads;                  /**< First label by round and airport. */
+    unsigned int *bagStamps;        /**< Query that last wrote the bag. */
+    uint64_t *marked;               /**< Airports improved in the last round, then in this one (2 * markWords words). */
+    int markWords;                  /**< Words per set of airports. */
+    int *slots;                     /**< Airport hash: airport number + 1, or 0 if empty. */
+    int slotCount;                  /**< Slots in slots (a power of two). */
+    unsigned int query;             /**< Number of the current query (never 0). */
+    const Flight *table;            /**< Table the index was built over. */
+    int flightCount;                /**< The table's flight count when built. */
+    unsigned long version;          /**< flightTableVersion when built. */
+    unsigned long statusVersion;    /**< flightStatusVersion when built. */
+    unsigned long rulesVersion;     /**< rulesVersion when built. */
+    int built;                      /**< 1 once the index has been built. */
+} JourneyIndex;
+
+static JourneyIndex journeyIndex;                              /**< The only index. */
+static JourneyRule rules[JOURNEY_MAX_RULES];                   /**< Airports with their own connection time. */
+static int ruleCount = 0;                                      /**< Rules in use. */
+static int defaultConnection = JOURNEY_DEFAULT_CONNECTION;     /**< Connection time of every other airport. */
+static unsigned long rulesVersion = 0;                         /**< Incremented whenever a connection time changes. */
+static pthread_mutex_t journeyLock = PTHREAD_MUTEX_INITIALIZER; /**< Serializes rebuilds and queries. */
+
+/**
+ * @brief Returns the minutes between 01-01-1970 00:00 and a date and time.
+ *
+ * @param dateTime The date and time.
+ * @return The minute number (differences are real durations).
+ */
+int journeyMinutes(const DateTime *dateTime) {
+    // Days from the civil date (March-based years put the leap day last)
+    int year = (int)dateTime->year - ((int)dateTime->month <= 2);
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int month = (int)dateTime->month;
+    int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + (int)dateTime->day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int days = era * 146097 + dayOfEra - 719468;
+    return days * 1440 + (int)dateTime->hour * 60 + (int)dateTime->minute;
+}
+
+/**
+ * @brief Returns the fare of one flight: the base fare plus its time in the air, up to twice that when full.
+ *
+ * @param flight The flight.
+ * @return The fare.
+ */
+int journeyFare(const Flight *flight) {
+    int minutes = journeyMinutes(&flight->arrival) - journeyMinutes(&flight->departure);
+    int fare = JOURNEY_BASE_FARE + (minutes > 0 ? minutes : 0) * JOURNEY_FARE_PER_HOUR / 60;
+    int sold = MAX_PASSENGERS_PER_FLIGHT - flight->availableSeats;
+    if (sold < 0) {
+        sold = 0;
+    } else if (sold > MAX_PASSENGERS_PER_FLIGHT) {
+        sold = MAX_PASSENGERS_PER_FLIGHT;
+    }
+    return fare + fare * sold / MAX_PASSENGERS_PER_FLIGHT;
+}
+
+/**
+ * @brief Finds the first free seat of a flight in its seat map.
+ *
+ * @param flight The flight.
+ * @return The 1-based seat number, or 0 if every seat is booked.
+ */
+static int firstFreeSeat(const Flight *flight) {
+    for (int b = 0; b < SEAT_MAP_BYTES; b++) {
+        unsigned int free = ~(unsigned int)flight->seatMap[b] & 0xFFu;
+        if (free != 0) {
+            int seatNo = b * 8 + __builtin_ctz(free) + 1;
+            return seatNo <= MAX_PASSENGERS_PER_FLIGHT ? seatNo : 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Sets the minimum connection time of an airport, or the default for all others.
+ *
+ * @param airport The airport, or NULL for the default.
+ * @param minutes The minimum minutes between an arrival and the next departure (0 or more).
+ * @return 1 on success, 0 if minutes is negative or JOURNEY_MAX_RULES airports already have one.
+ */
+int setMinConnectionTime(const char *airport, int minutes) {
+    if (minutes < 0) {
+        return 0;
+    }
+    pthread_mutex_lock(&journeyLock);
+    int set = 1;
+    if (airport == NULL) {
+        defaultConnection = minutes;
+    } else {
+        int r = 0;
+        while (r < ruleCount && strcmp(rules[r].airport, airport) != 0) {
+            r++;
+        }
+        if (r == ruleCount && ruleCount == JOURNEY_MAX_RULES) {
+            set = 0;
+        } else {
+            if (r == ruleCount) {
+                strncpy(rules[r].airport, airport, MAX_NAME_LEN - 1);
+                rules[r].airport[MAX_NAME_LEN - 1] = '\0';
+                ruleCount++;
+            }
+            rules[r].minutes = minutes;
+        }
+    }
+    if (set) {
+        rulesVersion++;
+    }
+    pthread_mutex_unlock(&journeyLock);
+    return set;
+}
+
+/**
+ * @brief Hashes an airport name (FNV-1a).
+ *
+ * @param name The name.
+ * @return The hash.
+ */
+static uint32_t hashAirport(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = name; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Finds the number of an airport.
+ *
+ * @param x The index.
+ * @param name The airport name.
+ * @return The airport number, or -1 if no connection touches it.
+ */
+static int findStop(const JourneyIndex *x, const char *name) {
+    uint32_t mask = (uint32_t)x->slotCount - 1;
+    for (uint32_t i = hashAirport(name) & mask; x->slots[i] != 0; i = (i + 1) & mask) {
+        if (strcmp(x->names[x->slots[i] - 1], name) == 0) {
+            return x->slots[i] - 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Returns the number of an airport, numbering it if it is new.
+ *
+ * The hash is sized for two airports per flight when the index is built,
+ * so it never fills up.
+ *
+ * @param x The index.
+ * @param name The airport name (must stay valid while the index is).
+ * @return The airport number, or -1 if memory allocation failed.
+ */
+static int internStop(JourneyIndex *x, const char *name) {
+    uint32_t mask = (uint32_t)x->slotCount - 1;
+    uint32_t i = hashAirport(name) & mask;
+    for (; x->slots[i] != 0; i = (i + 1) & mask) {
+        if (strcmp(x->names[x->slots[i] - 1], name) == 0) {
+            return x->slots[i] - 1;
+        }
+    }
+    if (x->stopCount == x->stopCapacity) {
+        int capacity = x->stopCapacity > 0 ? x->stopCapacity * 2 : 64;
+        const char **names = (const char **)trackedRealloc(MEM_OTHER, x->names, (size_t)capacity * sizeof(*names));
+        if (names == NULL) {
+            return -1;
+        }
+        x->names = names;
+        x->stopCapacity = capacity;
+    }
+    x->names[x->stopCount] = name;
+    x->slots[i] = ++x->stopCount;
+    return x->stopCount - 1;
+}
+
+/**
+ * @brief Compares two connections by departure, then arrival.
+ *
+ * @param a A pointer to the first JourneyConnection.
+ * @param b A pointer to the second JourneyConnection.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareConnections(const void *a, const void *b) {
+    const JourneyConnection *x = (const JourneyConnection *)a;
+    const JourneyConnection *y = (const JourneyConnection *)b;
+    if (x->departure != y->departure) {
+        return (x->departure > y->departure) - (x->departure < y->departure);
+    }
+    return (x->arrival > y->arrival) - (x->arrival < y->arrival);
+}
+
+/**
+ * @brief Frees everything the index holds and leaves it unbuilt.
+ */
+static void freeIndex() {
+    JourneyIndex *x = &journeyIndex;
+    trackedFree(MEM_OTHER, x->connections);
+    trackedFree(MEM_OTHER, x->pairs);
+    trackedFree(MEM_OTHER, x->names);
+    trackedFree(MEM_OTHER, x->connectionTimes);
+    trackedFree(MEM_OTHER, x->ready);
+    trackedFree(MEM_OTHER, x->via);
+    trackedFree(MEM_OTHER, x->stamps);
+    trackedFree(MEM_OTHER, x->routeTrips);
+    trackedFree(MEM_OTHER, x->routeStarts);
+    trackedFree(MEM_OTHER, x->routeTo);
+    trackedFree(MEM_OTHER, x->stopRoutes);
+    trackedFree(MEM_OTHER, x->labels);
+    trackedFree(MEM_OTHER, x->bagHeads);
+    trackedFree(MEM_OTHER, x->bagStamps);
+    trackedFree(MEM_OTHER, x->marked);
+    trackedFree(MEM_OTHER, x->slots);
+    memset(x, 0, sizeof(*x));
+}
+
+/**
+ * @brief Groups the sorted connections into routes (one per origin and destination).
+ *
+ * @param x The index (connections sorted, airports numbered).
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int buildRoutes(JourneyIndex *x) {
+    int n = x->connectionCount, stops = x->stopCount;
+    int *order = (int *)trackedMalloc(MEM_OTHER, (size_t)(n > 0 ? n : 1) * sizeof(int));
+    int *counts = (int *)trackedMalloc(MEM_OTHER, (size_t)(stops + 1) * sizeof(int));
+    x->routeTrips = (int *)trackedMalloc(MEM_OTHER, (size_t)(n > 0 ? n : 1) * sizeof(int));
+    x->routeStarts = (int *)trackedMalloc(MEM_OTHER, (size_t)(n + 1) * sizeof(int));
+    x->routeTo = (int *)trackedMalloc(MEM_OTHER, (size_t)(n > 0 ? n : 1) * sizeof(int));
+    x->stopRoutes = (int *)trackedMalloc(MEM_OTHER, (size_t)(stops + 1) * sizeof(int));
+    if (order == NULL || counts == NULL || x->routeTrips == NULL || x->routeStarts == NULL || x->routeTo == NULL ||
+        x->stopRoutes == NULL) {
+        trackedFree(MEM_OTHER, order);
+        trackedFree(MEM_OTHER, counts);
+        return 0;
+    }
+
+    // Stable counting sort by destination, then by origin: departure order survives within a route
+    for (int pass = 0; pass < 2; pass++) {
+        int *source = pass == 0 ? NULL : order;
+        int *target = pass == 0 ? order : x->routeTrips;
+        memset(counts, 0, (size_t)(stops + 1) * sizeof(int));
+        for (int i = 0; i < n; i++) {
+            const JourneyConnection *c = x->connections + (source != NULL ? source[i] : i);
+            counts[(pass == 0 ? c->to : c->from) + 1]++;
+        }
+        for (int s = 0; s < stops; s++) {
+            counts[s + 1] += counts[s];
+        }
+        for (int i = 0; i < n; i++) {
+            int connection = source != NULL ? source[i] : i;
+            const JourneyConnection *c = x->connections + connection;
+            target[counts[pass == 0 ? c->to : c->from]++] = connection;
+        }
+    }
+    trackedFree(MEM_OTHER, order);
+    trackedFree(MEM_OTHER, counts);
+
+    x->routeCount = 0;
+    int stop = 0;
+    for (int i = 0; i < n; i++) {
+        const JourneyConnection *c = x->connections + x->routeTrips[i];
+        if (i > 0) {
+            const JourneyConnection *previous = x->connections + x->routeTrips[i - 1];
+            if (previous->from == c->from && previous->to == c->to) {
+                continue;
+            }
+        }
+        while (stop <= c->from) {
+            x->stopRoutes[stop++] = x->routeCount;
+        }
+        x->routeStarts[x->routeCount] = i;
+        x->routeTo[x->routeCount++] = c->to;
+    }
+    while (stop <= stops) {
+        x->stopRoutes[stop++] = x->routeCount;
+    }
+    x->routeStarts[x->routeCount] = n;
+    return 1;
+}
+
+/**
+ * @brief Rebuilds the connection array and the airport numbering from a flight table.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int buildIndex(const Flight *flights, int flightCount) {
+    freeIndex();
+    JourneyIndex *x = &journeyIndex;
+    x->slotCount = 16;
+    while (x->slotCount < flightCount * 4 + 2) {
+        x->slotCount *= 2;
+    }
+    x->slots = (int *)trackedMalloc(MEM_OTHER, (size_t)x->slotCount * sizeof(int));
+    x->connectionCapacity = flightCount > 0 ? flightCount : 1;
+    x->connections = (JourneyConnection *)trackedMalloc(MEM_OTHER, (size_t)x->connectionCapacity * sizeof(JourneyConnection));
+    if (x->slots == NULL || x->connections == NULL) {
+        freeIndex();
+        return 0;
+    }
+    memset(x->slots, 0, (size_t)x->slotCount * sizeof(int));
+
+    for (int i = 0; i < flightCount; i++) {
+        const Flight *f = flights + i;
+        if (f->status == CANCELLED) {
+            continue;
+        }
+        JourneyConnection *c = x->connections + x->connectionCount;
+        c->departure = journeyMinutes(&f->departure);
+        c->arrival = journeyMinutes(&f->arrival);
+        if (c->arrival <= c->departure) {
+            continue; // No usable timing
+        }
+        c->from = internStop(x, f->origin);
+        c->to = internStop(x, f->destination);
+        if (c->from < 0 || c->to < 0) {
+            freeIndex();
+            return 0;
+        }
+        if (c->from == c->to) {
+            continue;
+        }
+        c->position = i;
+        x->connectionCount++;
+    }
+    qsort(x->connections, (size_t)x->connectionCount, sizeof(JourneyConnection), compareConnections);
+
+    int stops = x->stopCount > 0 ? x->stopCount : 1;
+    x->pairs = (JourneyPair *)trackedMalloc(MEM_OTHER, (size_t)x->connectionCapacity * sizeof(JourneyPair));
+    x->connectionTimes = (int *)trackedMalloc(MEM_OTHER, (size_t)stops * sizeof(int));
+    x->ready = (int *)trackedMalloc(MEM_OTHER, (size_t)stops * sizeof(int));
+    x->via = (int *)trackedMalloc(MEM_OTHER, (size_t)stops * sizeof(int));
+    x->stamps = (unsigned int *)trackedMalloc(MEM_OTHER, (size_t)stops * sizeof(unsigned int));
+    size_t bags = (size_t)(JOURNEY_MAX_LEGS + 1) * (size_t)stops;
+    x->bagHeads = (int *)trackedMalloc(MEM_OTHER, bags * sizeof(int));
+    x->bagStamps = (unsigned int *)trackedMalloc(MEM_OTHER, bags * sizeof(unsigned int));
+    x->markWords = (stops + 63) / 64;
+    x->marked = (uint64_t *)trackedMalloc(MEM_OTHER, (size_t)x->markWords * 2 * sizeof(uint64_t));
+    if (x->pairs == NULL || x->connectionTimes == NULL || x->ready == NULL || x->via == NULL || x->stamps == NULL ||
+        x->bagHeads == NULL || x->bagStamps == NULL || x->marked == NULL || !buildRoutes(x)) {
+        freeIndex();
+        return 0;
+    }
+    memset(x->stamps, 0, (size_t)stops * sizeof(unsigned int));
+    memset(x->bagStamps, 0, bags * sizeof(unsigned int));
+    x->table = flights;
+    x->flightCount = flightCount;
+    x->version = flightTableVersion;
+    x->statusVersion = flightStatusVersion;
+    x->built = 1;
+    return 1;
+}
+
+/**
+ * @brief Makes the index current for a flight table and the connection time rules.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int syncIndex(const Flight *flights, int flightCount) {
+    JourneyIndex *x = &journeyIndex;
+    if (!x->built || x->table != flights || x->flightCount != flightCount || x->version != flightTableVersion ||
+        x->statusVersion != flightStatusVersion) {
+        if (!buildIndex(flights, flightCount)) {
+            printf("Error: Could not allocate memory for the journey index.\n");
+            return 0;
+        }
+        x->rulesVersion = rulesVersion - 1; // Apply the rules below
+    }
+    if (x->rulesVersion != rulesVersion) {
+        for (int s = 0; s < x->stopCount; s++) {
+            x->connectionTimes[s] = defaultConnection;
+        }
+        for (int r = 0; r < ruleCount; r++) {
+            int stop = findStop(x, rules[r].airport);
+            if (stop >= 0) {
+                x->connectionTimes[stop] = rules[r].minutes;
+            }
+        }
+        x->rulesVersion = rulesVersion;
+    }
+    return 1;
+}
+
+/**
+ * @brief Starts a query: invalidates every airport's search state.
+ *
+ * @param x The index.
+ */
+static void beginQuery(JourneyIndex *x) {
+    if (++x->query == 0) { // Wrapped: clear the stamps once
+        int stops = x->stopCount > 0 ? x->stopCount : 1;
+        memset(x->stamps, 0, (size_t)stops * sizeof(unsigned int));
+        memset(x->bagStamps, 0, (size_t)(JOURNEY_MAX_LEGS + 1) * (size_t)stops * sizeof(unsigned int));
+        x->query = 1;
+    }
+}
+
+/**
+ * @brief Finds the first connection departing at or after a minute.
+ *
+ * @param x The index.
+ * @param minute The minute.
+ * @return Its position in the connection array (connectionCount if none).
+ */
+static int firstDeparting(const JourneyIndex *x, int minute) {
+    int low = 0, high = x->connectionCount;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (x->connections[mid].departure < minute) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Appends a connection to a journey.
+ *
+ * @param x The index.
+ * @param journey The journey.
+ * @param connection The connection.
+ * @return 1 on success, 0 if the journey already has JOURNEY_MAX_LEGS legs.
+ */
+static int addLeg(const JourneyIndex *x, Journey *journey, int connection) {
+    if (journey->legCount == JOURNEY_MAX_LEGS) {
+        return 0;
+    }
+    int position = x->connections[connection].position;
+    journey->positions[journey->legCount] = position;
+    journey->flightIDs[journey->legCount] = x->table[position].flightID;
+    journey->seatNos[journey->legCount] = firstFreeSeat(x->table + position);
+    journey->price += journeyFare(x->table + position);
+    journey->legCount++;
+    return 1;
+}
+
+/**
+ * @brief Finds the journey arriving earliest at a destination.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The airport the journey starts from.
+ * @param destination The airport the journey ends at.
+ * @param earliest The earliest departure from the origin.
+ * @param out Receives the journey.
+ * @return 1 if a journey was found, 0 if none, -1 if memory allocation failed.
+ */
+int findEarliestArrival(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                        const DateTime *earliest, Journey *out) {
+    pthread_mutex_lock(&journeyLock);
+    if (!syncIndex(flights, flightCount)) {
+        pthread_mutex_unlock(&journeyLock);
+        return -1;
+    }
+    JourneyIndex *x = &journeyIndex;
+    int from = findStop(x, origin), to = findStop(x, destination);
+    if (from < 0 || to < 0 || from == to) {
+        pthread_mutex_unlock(&journeyLock);
+        return 0;
+    }
+
+    beginQuery(x);
+    int start = journeyMinutes(earliest);
+    int limit = start + JOURNEY_MAX_SPAN;
+    int bestArrival = INT_MAX, bestConnection = -1;
+    x->ready[from] = start;
+    x->via[from] = -1;
+    x->stamps[from] = x->query;
+    for (int i = firstDeparting(x, start); i < x->connectionCount; i++) {
+        const JourneyConnection *c = x->connections + i;
+        if (c->departure >= bestArrival || c->departure > limit) {
+            break; // Nothing departing now can arrive earlier
+        }
+        if (x->stamps[c->from] != x->query || x->ready[c->from] > c->departure || c->from == to) {
+            continue; // Cannot be at the airport in time
+        }
+        if (c->to == to) {
+            if (c->arrival < bestArrival) {
+                bestArrival = c->arrival;
+                bestConnection = i;
+            }
+            continue;
+        }
+        int ready = c->arrival + x->connectionTimes[c->to];
+        if (x->stamps[c->to] != x->query || ready < x->ready[c->to]) {
+            x->ready[c->to] = ready;
+            x->via[c->to] = i;
+            x->stamps[c->to] = x->query;
+        }
+    }
+
+    int found = 0;
+    if (bestConnection >= 0) {
+        // Follow the connections back to the origin, then put the legs in travel order
+        int legs[JOURNEY_MAX_LEGS];
+        int legCount = 0;
+        for (int i = bestConnection; i >= 0 && legCount < JOURNEY_MAX_LEGS; i = x->via[x->connections[i].from]) {
+            legs[legCount++] = i;
+            if (x->connections[i].from == from) {
+                found = 1;
+                break;
+            }
+        }
+        if (found) {
+            out->legCount = 0;
+            out->price = 0;
+            for (int l = legCount - 1; l >= 0; l--) {
+                addLeg(x, out, legs[l]);
+            }
+            out->departure = x->connections[legs[legCount - 1]].departure;
+            out->arrival = bestArrival;
+        }
+    }
+    pthread_mutex_unlock(&journeyLock);
+    return found;
+}
+
+/**
+ * @brief Finds the best journeys departing within a window (the Pareto front of departure and arrival).
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The airport the journeys start from.
+ * @param destination The airport the journeys end at.
+ * @param first The earliest departure from the origin.
+ * @param last The latest departure from the origin.
+ * @param out Receives the journeys.
+ * @param maxJourneys The capacity of out.
+ * @return The number of journeys written (the earliest departing first), or -1 if memory allocation failed.
+ */
+int findJourneyProfile(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                       const DateTime *first, const DateTime *last, Journey *out, int maxJourneys) {
+    pthread_mutex_lock(&journeyLock);
+    if (!syncIndex(flights, flightCount)) {
+        pthread_mutex_unlock(&journeyLock);
+        return -1;
+    }
+    JourneyIndex *x = &journeyIndex;
+    int from = findStop(x, origin), to = findStop(x, destination);
+    int windowStart = journeyMinutes(first), windowEnd = journeyMinutes(last);
+    if (from < 0 || to < 0 || from == to || windowEnd < windowStart || maxJourneys <= 0) {
+        pthread_mutex_unlock(&journeyLock);
+        return 0;
+    }
+
+    beginQuery(x);
+    int pairCount = 0;
+    int low = firstDeparting(x, windowStart);
+    int high = firstDeparting(x, windowEnd + JOURNEY_MAX_SPAN + 1);
+    for (int i = high - 1; i >= low; i--) {
+        const JourneyConnection *c = x->connections + i;
+        if (c->from == to || c->to == from || (c->from == from && c->departure > windowEnd)) {
+            continue;
+        }
+        int arrival = INT_MAX, onward = -1;
+        if (c->to == to) {
+            arrival = c->arrival;
+        } else if (x->stamps[c->to] == x->query) {
+            // The next airport's pairs run from the earliest departure on, arriving later and later
+            int ready = c->arrival + x->connectionTimes[c->to];
+            for (int p = x->ready[c->to]; p >= 0; p = x->pairs[p].next) {
+                if (x->pairs[p].departure >= ready) {
+                    arrival = x->pairs[p].arrival;
+                    onward = p;
+                    break;
+                }
+            }
+        }
+        if (arrival == INT_MAX) {
+            continue;
+        }
+        int head = x->stamps[c->from] == x->query ? x->ready[c->from] : -1;
+        if (head >= 0 && x->pairs[head].arrival <= arrival) {
+            continue; // Leaving later gets there as early
+        }
+        JourneyPair *pair = x->pairs + pairCount;
+        pair->departure = c->departure;
+        pair->arrival = arrival;
+        pair->connection = i;
+        pair->onward = onward;
+        pair->next = head;
+        x->ready[c->from] = pairCount++;
+        x->stamps[c->from] = x->query;
+    }
+
+    int count = 0, lastDeparture = INT_MAX;
+    int p = x->stamps[from] == x->query ? x->ready[from] : -1;
+    for (; p >= 0 && count < maxJourneys; p = x->pairs[p].next) {
+        if (x->pairs[p].departure == lastDeparture) {
+            continue; // A pair found earlier for the same departure, arriving later
+        }
+        lastDeparture = x->pairs[p].departure;
+        Journey *journey = out + count;
+        journey->legCount = 0;
+        journey->price = 0;
+        int complete = 1;
+        for (int q = p; q >= 0 && complete; q = x->pairs[q].onward) {
+            complete = addLeg(x, journey, x->pairs[q].connection);
+        }
+        if (complete) {
+            journey->departure = x->pairs[p].departure;
+            journey->arrival = x->pairs[p].arrival;
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&journeyLock);
+    return count;
+}
+
+/**
+ * @brief Returns the first label of a bag.
+ *
+ * @param x The index.
+ * @param round The round (flights taken).
+ * @param stop The airport.
+ * @return The label, or -1 if the bag is empty.
+ */
+static int bagHead(const JourneyIndex *x, int round, int stop) {
+    size_t bag = (size_t)round * (size_t)x->stopCount + (size_t)stop;
+    return x->bagStamps[bag] == x->query ? x->bagHeads[bag] : -1;
+}
+
+/**
+ * @brief Reports whether a label of an airport up to a round arrives no later for no more.
+ *
+ * @param x The index.
+ * @param round The last round to look at.
+ * @param stop The airport.
+ * @param arrival The arrival to beat.
+ * @param price The fare to beat.
+ * @return 1 if such a label exists, 0 otherwise.
+ */
+static int bagsDominate(const JourneyIndex *x, int round, int stop, int arrival, int price) {
+    for (int k = 0; k <= round; k++) {
+        for (int l = bagHead(x, k, stop); l >= 0; l = x->labels[l].next) {
+            if (x->labels[l].arrival <= arrival && x->labels[l].price <= price) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the earliest arrival at an airport up to a round for no more than a fare.
+ *
+ * @param x The index.
+ * @param round The last round to look at.
+ * @param stop The airport.
+ * @param price The fare.
+ * @return The arrival, or INT_MAX if none.
+ */
+static int cheapestArrival(const JourneyIndex *x, int round, int stop, int price) {
+    int arrival = INT_MAX;
+    for (int k = 0; k <= round; k++) {
+        for (int l = bagHead(x, k, stop); l >= 0; l = x->labels[l].next) {
+            if (x->labels[l].price <= price && x->labels[l].arrival < arrival) {
+                arrival = x->labels[l].arrival;
+            }
+        }
+    }
+    return arrival;
+}
+
+/**
+ * @brief Adds a label to a bag, dropping the labels of that bag it beats.
+ *
+ * @param x The index.
+ * @param round The round.
+ * @param stop The airport.
+ * @param label The label (its next is set here).
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int addLabel(JourneyIndex *x, int round, int stop, const JourneyLabel *label) {
+    if (x->labelCount == x->labelCapacity) {
+        int capacity = x->labelCapacity > 0 ? x->labelCapacity * 2 : 1024;
+        JourneyLabel *labels = (JourneyLabel *)trackedRealloc(MEM_OTHER, x->labels, (size_t)capacity * sizeof(JourneyLabel));
+        if (labels == NULL) {
+            return 0;
+        }
+        x->labels = labels;
+        x->labelCapacity = capacity;
+    }
+    size_t bag = (size_t)round * (size_t)x->stopCount + (size_t)stop;
+    int head = bagHead(x, round, stop);
+    int *link = &head;
+    while (*link >= 0) {
+        const JourneyLabel *old = x->labels + *link;
+        if (old->arrival >= label->arrival && old->price >= label->price) {
+            *link = old->next;
+        } else {
+            link = &x->labels[*link].next;
+        }
+    }
+    int l = x->labelCount++;
+    x->labels[l] = *label;
+    x->labels[l].next = head;
+    x->bagHeads[bag] = l;
+    x->bagStamps[bag] = x->query;
+    return 1;
+}
+
+/**
+ * @brief Finds the journeys no other one beats on arrival, number of flights and fare together.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The airport the journeys start from.
+ * @param destination The airport the journeys end at.
+ * @param earliest The earliest departure from the origin.
+ * @param maxLegs The most flights per journey (1 to JOURNEY_MAX_LEGS).
+ * @param out Receives the journeys.
+ * @param maxJourneys The capacity of out.
+ * @return The number of journeys written (the earliest arriving if there are more), or -1 if memory allocation failed.
+ */
+int findParetoJourneys(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                       const DateTime *earliest, int maxLegs, Journey *out, int maxJourneys) {
+    pthread_mutex_lock(&journeyLock);
+    if (!syncIndex(flights, flightCount)) {
+        pthread_mutex_unlock(&journeyLock);
+        return -1;
+    }
+    JourneyIndex *x = &journeyIndex;
+    int from = findStop(x, origin), to = findStop(x, destination);
+    if (from < 0 || to < 0 || from == to || maxJourneys <= 0) {
+        pthread_mutex_unlock(&journeyLock);
+        return 0;
+    }
+    if (maxLegs > JOURNEY_MAX_LEGS) {
+        maxLegs = JOURNEY_MAX_LEGS;
+    }
+
+    beginQuery(x);
+    x->labelCount = 0;
+    int start = journeyMinutes(earliest);
+    int limit = start + JOURNEY_MAX_SPAN;
+    JourneyLabel label = { start, start, 0, -1, -1, -1 };
+    if (!addLabel(x, 0, from, &label)) {
+        pthread_mutex_unlock(&journeyLock);
+        return -1;
+    }
+    uint64_t *current = x->marked, *next = x->marked + x->markWords;
+    memset(current, 0, (size_t)x->markWords * sizeof(uint64_t));
+    current[from / 64] |= 1ull << (from % 64);
+
+    int failed = 0;
+    for (int round = 1; round <= maxLegs && !failed; round++) {
+        memset(next, 0, (size_t)x->markWords * sizeof(uint64_t));
+        int improved = 0;
+        for (int w = 0; w < x->markWords && !failed; w++) {
+            for (uint64_t bits = current[w]; bits != 0 && !failed; bits &= bits - 1) {
+                int stop = w * 64 + __builtin_ctzll(bits);
+                for (int r = x->stopRoutes[stop]; r < x->stopRoutes[stop + 1] && !failed; r++) {
+                    int target = x->routeTo[r];
+                    const int *trips = x->routeTrips + x->routeStarts[r];
+                    int tripCount = x->routeStarts[r + 1] - x->routeStarts[r];
+                    for (int l = bagHead(x, round - 1, stop); l >= 0 && !failed; l = x->labels[l].next) {
+                        int ready = x->labels[l].ready, price = x->labels[l].price;
+                        // Arriving after the destination's best for no more money can only lose
+                        int cutoff = cheapestArrival(x, round, to, price);
+                        int low = 0, high = tripCount;
+                        while (low < high) {
+                            int mid = low + (high - low) / 2;
+                            if (x->connections[trips[mid]].departure < ready) {
+                                low = mid + 1;
+                            } else {
+                                high = mid;
+                            }
+                        }
+                        for (int t = low; t < tripCount; t++) {
+                            const JourneyConnection *c = x->connections + trips[t];
+                            if (c->departure > limit || c->departure >= cutoff) {
+                                break;
+                            }
+                            if (c->arrival >= cutoff || bagsDominate(x, round, target, c->arrival, price)) {
+                                continue;
+                            }
+                            const Flight *f = x->table + c->position;
+                            if (firstFreeSeat(f) == 0) {
+                                continue; // Not bookable
+                            }
+                            int total = price + journeyFare(f);
+                            if (bagsDominate(x, round, target, c->arrival, total) ||
+                                (target != to && bagsDominate(x, round, to, c->arrival, total))) {
+                                continue;
+                            }
+                            JourneyLabel reached = { c->arrival, c->arrival + x->connectionTimes[target], total,
+                                                     trips[t], l, -1 };
+                            if (!addLabel(x, round, target, &reached)) {
+                                failed = 1;
+                                break;
+                            }
+                            if (target != to) {
+                                next[target / 64] |= 1ull << (target % 64);
+                                improved = 1;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        uint64_t *swap = current;
+        current = next;
+        next = swap;
+        if (!improved) {
+            break;
+        }
+    }
+    if (failed) {
+        pthread_mutex_unlock(&journeyLock);
+        return -1;
+    }
+
+    // Keep the earliest arriving journeys (then the cheapest), in that order
+    int count = 0;
+    for (int round = 1; round <= maxLegs; round++) {
+        for (int l = bagHead(x, round, to); l >= 0; l = x->labels[l].next) {
+            const JourneyLabel *found = x->labels + l;
+            int slot = count;
+            while (slot > 0 && (out[slot - 1].arrival > found->arrival ||
+                                (out[slot - 1].arrival == found->arrival && out[slot - 1].price > found->price))) {
+                slot--;
+            }
+            if (slot == maxJourneys) {
+                continue;
+            }
+            if (count < maxJourneys) {
+                count++;
+            }
+            memmove(out + slot + 1, out + slot, (size_t)(count - 1 - slot) * sizeof(Journey));
+            int legs[JOURNEY_MAX_LEGS];
+            int legCount = 0;
+            for (int p = l; x->labels[p].connection >= 0; p = x->labels[p].parent) {
+                legs[legCount++] = x->labels[p].connection;
+            }
+            Journey *journey = out + slot;
+            journey->legCount = 0;
+            journey->price = 0;
+            for (int leg = legCount - 1; leg >= 0; leg--) {
+                addLeg(x, journey, legs[leg]);
+            }
+            journey->departure = x->connections[legs[legCount - 1]].departure;
+            journey->arrival = found->arrival;
+            journey->price = found->price;
+        }
+    }
+    pthread_mutex_unlock(&journeyLock);
+    return count;
+}
+
+/**
+ * @brief Frees the connection array and the search state.
+ */
+void cleanupJourneys() {
+    pthread_mutex_lock(&journeyLock);
+    freeIndex();
+    pthread_mutex_unlock(&journeyLock);
+}
@@ -0,0 +1,1245 @@
+/**
+ * @file loadtest.c
+ * @brief Closed-loop concurrent load tester for the service layer.
+ *
+ * A number of agent threads issue a realistic mix of requests (search by ID,
+ * route lookup, listing, booking, cancelling and paying for their own
+ * tickets) either directly against the service layer (--mode inproc) or over
+ * the loopback protocol (--mode server). The run is a series of steps, one
+ * per target rate; each step warms up, measures for a fixed duration and
+ * reports achieved throughput, error counts and per-operation latency
+ * percentiles, which are also written to a CSV file for throughput-vs-latency
+ * curves.
+ *
+ * Throttled steps avoid coordinated omission: every agent follows a fixed
+ * schedule of intended start times and latency is measured from the intended
+ * start, not from when the request was actually sent, so a stall also counts
+ * against the requests that queued up behind it. An agent that falls more
+ * than one step duration behind stops sending; its remaining scheduled
+ * requests are reported as missed and recorded with the latency they had
+ * accumulated so far. Rate 0 means unthrottled: each agent sends its next
+ * request as soon as the previous one returns, which measures peak
+ * throughput. Without --rates, one unthrottled step is followed by steps at
+ * 25%, 50%, 75%, 90%, 100% and 110% of the peak it measured.
+ *
+ * Without --port, the data lives in this process: --flights N generates N
+ * flights (default and limit MAX_FLIGHTS), --load reads flights.txt,
+ * passengers.txt and tickets.txt from the working directory (they are not
+ * written back), and server mode starts an in-process server on a free
+ * loopback port. With --port, server mode drives
+ * an already running "flight_system --serve PORT" and picks its targets from
+ * that server's LIST.
+ *
+ * --mode shared is a multi-process stress test of the shared-memory seat
+ * inventory instead: --agents processes are forked, each books and cancels
+ * random seats for --duration seconds through its own mapping of one
+ * segment and merges its tickets into one ticket file, as separate
+ * "flight_system --shared" processes do. Every process also starts with a
+ * copy of the same tickets "loaded at startup", cancels each of them at its
+ * own pace and rebooks their seats, so stale copies of a ticket another
+ * process already cancelled are exercised too. The run fails unless every ticket
+ * ID is unique, no seat is sold twice, and the tickets on file match the
+ * seats claimed in the segment and the bookings the processes made.
+ *
+ * POSIX only (threads, sockets, clock_nanosleep). Build it separately from
+ * the interactive program (see README):
+ *   gcc -O2 -pthread loadtest.c flight.c passenger.c ticket.c inventory.c timing.c stats.c trace.c memstats.c profiler.c payment.c service.c server.c session.c render.c page.c roaring.c flightindex.c availability.c aggregates.c resultcache.c idindex.c bloom.c -o loadtest.exe
+ *
+ * Usage:
+ *   loadtest.exe [--agents N] [--duration S] [--warmup S] [--rates 0,5000,...]
+ *                [--mix search=40,route=15,list=5,book=15,cancel=15,pay=10]
+ *                [--mode inproc|server|shared] [--port P] [--flights N | --load]
+ *                [--seed N] [--out FILE] [--profile FILE]
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For malloc, calloc, free, strtol, strtod
+#include <string.h>
+#include <time.h>         // For clock_nanosleep
+#include <pthread.h>
+#include <unistd.h>       // For close, fork, getpid, unlink
+#include <sys/mman.h>     // For mmap (results shared with the stress processes)
+#include <sys/wait.h>     // For waitpid
+#include <sys/socket.h>   // For socket, connect, send, recv
+#include <netinet/in.h>   // For sockaddr_in
+#include <netinet/tcp.h>  // For TCP_NODELAY
+#include <arpa/inet.h>    // For htonl, htons
+
+#include "flight.h"
+#include "passenger.h"
+#include "ticket.h"
+#include "service.h"
+#include "server.h"
+#include "stats.h"
+#include "timing.h"
+#include "memstats.h"
+#include "profiler.h"
+#include "resultcache.h"
+#include "idindex.h"
+#include "bloom.h"
+#include "inventory.h"
+
+/**
+ * @def LOAD_MAX_RATES
+ * @brief Maximum number of steps accepted by --rates.
+ */
+#define LOAD_MAX_RATES 16
+
+/**
+ * @def LOAD_MAX_AGENTS
+ * @brief Maximum number of agent threads.
+ */
+#define LOAD_MAX_AGENTS 1024
+
+/**
+ * @def LOAD_AGENT_TICKETS
+ * @brief Tickets one agent holds at most; a booking beyond this cancels instead.
+ */
+#define LOAD_AGENT_TICKETS 4096
+
+/**
+ * @def LOAD_STARTUP_TICKETS
+ * @brief Tickets every shared stress process holds a copy of when it starts, as if loaded from tickets.txt.
+ */
+#define LOAD_STARTUP_TICKETS 64
+
+/**
+ * @def LOAD_LINE_SIZE
+ * @brief Longest request or response line exchanged in server mode.
+ */
+#define LOAD_LINE_SIZE 512
+
+/**
+ * @enum LoadOp
+ * @brief The operations in the request mix.
+ */
+typedef enum {
+    LOAD_SEARCH,    /**< SEARCH a random flight by ID. */
+    LOAD_ROUTE,     /**< ROUTE lookup for a random flight's origin and destination. */
+    LOAD_LIST,      /**< LIST the first page of flights. */
+    LOAD_BOOK,      /**< BOOK a random seat on a random flight. */
+    LOAD_CANCEL,    /**< CANCEL one of the agent's tickets (books if it holds none). */
+    LOAD_PAY,       /**< PAY for one of the agent's tickets (books if it holds none). */
+    LOAD_OP_COUNT   /**< Number of operations (not an operation). */
+} LoadOp;
+
+/**
+ * @var loadOpNames
+ * @brief Names used by --mix and in reports, indexed by LoadOp.
+ */
+static const char *const loadOpNames[LOAD_OP_COUNT] = {
+    "search", "route", "list", "book", "cancel", "pay"
+};
+
+/**
+ * @struct CatalogEntry
+ * @brief A flight agents can target.
+ */
+typedef struct {
+    int flightID;                       /**< The flight's ID. */
+    char origin[MAX_NAME_LEN];          /**< Its origin (for ROUTE). */
+    char destination[MAX_NAME_LEN];     /**< Its destination (for ROUTE). */
+} CatalogEntry;
+
+/**
+ * @struct Agent
+ * @brief State of one load-generating thread; it persists across steps.
+ */
+typedef struct {
+    int index;                  /**< Agent number, 0-based. */
+    pthread_t thread;           /**< The thread running the current step. */
+    unsigned long long rng;     /**< Private xorshift64 state. */
+    int fd;                     /**< Server mode: the agent's connection, -1 if closed. */
+    char *pending;              /**< Server mode: bytes received but not consumed yet. */
+    size_t pendingLength;       /**< Number of bytes in pending. */
+    char *response;             /**< In-process LIST buffer (SERVICE_RESPONSE_SIZE bytes). */
+    int tickets[LOAD_AGENT_TICKETS]; /**< IDs of the tickets this agent booked and still holds. */
+    int ticketCount;            /**< Number of entries in tickets. */
+    LatencyHistogram histograms[LOAD_OP_COUNT]; /**< Latency of measured requests per operation. */
+    long long errors[LOAD_OP_COUNT];   /**< Measured requests that failed, per operation. */
+    long long missed;           /**< Scheduled requests never sent because the agent fell too far behind. */
+    long long lastEnd;          /**< When the agent's last measured request finished. */
+} Agent;
+
+/**
+ * @struct StepResult
+ * @brief Merged results of one step.
+ */
+typedef struct {
+    double targetRate;          /**< Target total ops/s, 0 for unthrottled. */
+    double achievedRate;        /**< Measured requests completed per second. */
+    long long missed;           /**< Scheduled requests never sent. */
+    LatencySummary ops[LOAD_OP_COUNT + 1]; /**< Per operation, then all operations. */
+    long long errors[LOAD_OP_COUNT + 1];   /**< Per operation, then all operations. */
+} StepResult;
+
+static Flight *testFlights = NULL;       /**< In-process flight table. */
+static int testFlightCount = 0;          /**< Number of flights in testFlights. */
+static CatalogEntry *catalog = NULL;     /**< Flights agents pick targets from. */
+static int catalogCount = 0;             /**< Number of entries in catalog. */
+static int mixWeights[LOAD_OP_COUNT] = { 40, 15, 5, 15, 15, 10 }; /**< Relative frequency of each operation. */
+static int mixTotal = 100;               /**< Sum of mixWeights. */
+static int useServer = 0;                /**< 1 to send requests over the loopback protocol. */
+static int serverPort = 0;               /**< Port of the server in server mode. */
+static int useShared = 0;                /**< 1 for the multi-process shared inventory stress test. */
+
+static long long stepStart = 0;          /**< When the current step's warmup begins. */
+static long long measureStart = 0;       /**< When its measured window begins. */
+static long long stepEnd = 0;            /**< When its measured window ends. */
+static long long stepDeadline = 0;       /**< When lagging agents give up on their schedule. */
+static long long agentInterval = 0;      /**< Nanoseconds between an agent's requests, 0 if unthrottled. */
+static int agentCount = 8;               /**< Number of agents. */
+
+static const char *const loadAirports[] = {
+    "DAC", "CGP", "ZYL", "CXB", "JSR", "DXB", "DOH", "SIN", "KUL", "BKK",
+    "LHR", "JFK", "CCU", "DEL", "IST", "NRT"
+}; /**< Airport codes used for generated routes. */
+
+/**
+ * @brief Returns the next pseudo-random number of an agent (xorshift64).
+ *
+ * @param state The generator state.
+ * @return A 64-bit pseudo-random value.
+ */
+static unsigned long long nextRandom(unsigned long long *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * @brief Returns a pseudo-random integer in [0, bound).
+ *
+ * @param state The generator state.
+ * @param bound The exclusive upper bound (must be positive).
+ * @return A value from 0 to bound - 1.
+ */
+static int randomBelow(unsigned long long *state, int bound) {
+    return (int)(nextRandom(state) % (unsigned long long)bound);
+}
+
+/**
+ * @brief Sleeps until an absolute CLOCK_MONOTONIC time (the clock nowNanos reads).
+ *
+ * @param when The wake-up time in nanoseconds.
+ */
+static void sleepUntil(long long when) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(when / 1000000000LL);
+    ts.tv_nsec = (long)(when % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+        // Interrupted (e.g., by the profiler's SIGPROF): sleep the rest
+    }
+}
+
+/**
+ * @brief Sends a whole buffer, retrying short writes.
+ *
+ * @param fd The socket.
+ * @param data The bytes to send.
+ * @param length The number of bytes.
+ * @return 1 on success, 0 if the peer went away.
+ */
+static int sendAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return 0;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 1;
+}
+
+/**
+ * @brief Opens a connection to the server on 127.0.0.1:serverPort.
+ *
+ * @return The socket, or -1 on failure.
+ */
+static int connectToServer(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((unsigned short)serverPort);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+/**
+ * @brief Reads one response line from an agent's connection.
+ *
+ * @param agent The agent.
+ * @param line Receives the line without its newline (truncated to size).
+ * @param size The size of line.
+ * @return 1 on success, 0 if the connection failed or a line was too long.
+ */
+static int readLine(Agent *agent, char *line, size_t size) {
+    while (1) {
+        char *newline = memchr(agent->pending, '\n', agent->pendingLength);
+        if (newline != NULL) {
+            size_t length = (size_t)(newline - agent->pending);
+            size_t copied = length < size - 1 ? length : size - 1;
+            memcpy(line, agent->pending, copied);
+            line[copied] = '\0';
+            agent->pendingLength -= length + 1;
+            memmove(agent->pending, newline + 1, agent->pendingLength);
+            return 1;
+        }
+        if (agent->pendingLength == LOAD_LINE_SIZE) {
+            return 0;
+        }
+        ssize_t received = recv(agent->fd, agent->pending + agent->pendingLength,
+                                LOAD_LINE_SIZE - agent->pendingLength, 0);
+        if (received <= 0) {
+            return 0;
+        }
+        agent->pendingLength += (size_t)received;
+    }
+}
+
+/**
+ * @brief Sends one request over the agent's connection and reads its response.
+ *
+ * A LIST response is read through its terminating "." line. If the connection
+ * fails it is closed, and the next request reconnects.
+ *
+ * @param agent The agent.
+ * @param request The request line, including its newline.
+ * @param status Receives the first response line.
+ * @param size The size of status.
+ * @return 1 if the server answered OK, 0 otherwise.
+ */
+static int exchange(Agent *agent, const char *request, char *status, size_t size) {
+    status[0] = '\0';
+    if (agent->fd < 0) {
+        agent->fd = connectToServer();
+        agent->pendingLength = 0;
+        if (agent->fd < 0) {
+            return 0;
+        }
+    }
+    int ok = sendAll(agent->fd, request, strlen(request)) && readLine(agent, status, size);
+    if (ok && strncmp(request, "LIST", 4) == 0 && strncmp(status, "OK", 2) == 0) {
+        char line[LOAD_LINE_SIZE];
+        do {
+            ok = readLine(agent, line, sizeof(line));
+        } while (ok && strcmp(line, ".") != 0);
+    }
+    if (!ok) {
+        close(agent->fd);
+        agent->fd = -1;
+        return 0;
+    }
+    return strncmp(status, "OK", 2) == 0;
+}
+
+/**
+ * @brief Picks the next operation according to the mix.
+ *
+ * @param agent The agent.
+ * @return The operation.
+ */
+static LoadOp pickOp(Agent *agent) {
+    int r = randomBelow(&agent->rng, mixTotal);
+    for (int op = 0; op < LOAD_OP_COUNT; op++) {
+        if (r < mixWeights[op]) {
+            return (LoadOp)op;
+        }
+        r -= mixWeights[op];
+    }
+    return LOAD_SEARCH;
+}
+
+/**
+ * @brief Performs one request.
+ *
+ * Cancel and pay need a ticket the agent holds; without one they book
+ * instead, and a booking by an agent holding LOAD_AGENT_TICKETS tickets
+ * cancels instead, so op is updated to what was actually done.
+ *
+ * @param agent The agent.
+ * @param op The operation to perform; receives the operation performed.
+ * @return 1 if the request succeeded, 0 otherwise.
+ */
+static int performOp(Agent *agent, LoadOp *op) {
+    if ((*op == LOAD_CANCEL || *op == LOAD_PAY) && agent->ticketCount == 0) {
+        *op = LOAD_BOOK;
+    } else if (*op == LOAD_BOOK && agent->ticketCount == LOAD_AGENT_TICKETS) {
+        *op = LOAD_CANCEL;
+    }
+
+    const CatalogEntry *target = catalog + randomBelow(&agent->rng, catalogCount);
+    int held = agent->ticketCount > 0 ? randomBelow(&agent->rng, agent->ticketCount) : 0;
+    char request[LOAD_LINE_SIZE];
+    char status[LOAD_LINE_SIZE];
+    int ok = 0;
+
+    switch (*op) {
+        case LOAD_SEARCH:
+            if (useServer) {
+                snprintf(request, sizeof(request), "SEARCH %d\n", target->flightID);
+                ok = exchange(agent, request, status, sizeof(status));
+            } else {
+                Flight f;
+                ok = serviceSearchFlight(target->flightID, &f);
+            }
+            break;
+        case LOAD_ROUTE:
+            if (useServer) {
+                snprintf(request, sizeof(request), "ROUTE %s %s\n", target->origin, target->destination);
+                ok = exchange(agent, request, status, sizeof(status));
+            } else {
+                int ids[SERVICE_ROUTE_LIMIT];
+                ok = serviceFindRoute(target->origin, target->destination, ids, SERVICE_ROUTE_LIMIT) > 0;
+            }
+            break;
+        case LOAD_LIST:
+            if (useServer) {
+                ok = exchange(agent, "LIST\n", status, sizeof(status));
+            } else {
+                PageCursor cursor;
+                initPageCursor(&cursor);
+                ok = serviceListFlights(PAGE_BY_ID, &cursor, SERVICE_LIST_LIMIT, agent->response, SERVICE_RESPONSE_SIZE) > 0;
+            }
+            break;
+        case LOAD_BOOK: {
+            int seatNo = 1 + randomBelow(&agent->rng, MAX_PASSENGERS_PER_FLIGHT);
+            int ticketID = 0;
+            if (useServer) {
+                snprintf(request, sizeof(request), "BOOK %d %d Agent %d\n", target->flightID, seatNo, agent->index);
+                if (exchange(agent, request, status, sizeof(status))) {
+                    ticketID = atoi(status + 2);
+                }
+            } else {
+                char name[MAX_NAME_LEN];
+                snprintf(name, sizeof(name), "Agent %d", agent->index);
+                ticketID = serviceBookTicket(name, target->flightID, seatNo);
+            }
+            if (ticketID > 0) {
+                agent->tickets[agent->ticketCount++] = ticketID;
+                ok = 1;
+            }
+            break;
+        }
+        case LOAD_CANCEL: {
+            int ticketID = agent->tickets[held];
+            if (useServer) {
+                snprintf(request, sizeof(request), "CANCEL %d\n", ticketID);
+                ok = exchange(agent, request, status, sizeof(status));
+            } else {
+                ok = serviceCancelTicket(ticketID);
+            }
+            agent->tickets[held] = agent->tickets[--agent->ticketCount]; // Forget it even on failure
+            break;
+        }
+        case LOAD_PAY: {
+            float amount = 50.0f + (float)randomBelow(&agent->rng, 950);
+            if (useServer) {
+                snprintf(request, sizeof(request), "PAY %d Card %.2f\n", agent->tickets[held], amount);
+                ok = exchange(agent, request, status, sizeof(status));
+            } else {
+                ok = servicePay(agent->tickets[held], "Card", amount);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return ok;
+}
+
+/**
+ * @brief Runs one agent through the current step.
+ *
+ * @param arg The Agent.
+ * @return NULL.
+ */
+static void *runAgent(void *arg) {
+    Agent *agent = (Agent *)arg;
+    profilerRegisterThread();
+
+    // Stagger the agents' schedules evenly across one interval
+    long long intended = stepStart + agentInterval * agent->index / agentCount;
+    while (1) {
+        long long now = nowNanos();
+        long long start;
+        if (agentInterval > 0) {
+            if (intended >= stepEnd) {
+                break;
+            }
+            if (now >= stepDeadline) {
+                // Too far behind: what is left of the schedule was never sent
+                for (; intended < stepEnd; intended += agentInterval) {
+                    if (intended >= measureStart) {
+                        histogramRecord(&agent->histograms[pickOp(agent)], now - intended);
+                        agent->missed++;
+                    }
+                }
+                break;
+            }
+            if (now < intended) {
+                sleepUntil(intended);
+            }
+            start = intended; // Measure from the intended start, not the actual send
+            intended += agentInterval;
+        } else {
+            if (now >= stepEnd) {
+                break;
+            }
+            start = now;
+        }
+
+        LoadOp op = pickOp(agent);
+        int ok = performOp(agent, &op);
+        long long end = nowNanos();
+        if (start >= measureStart) {
+            histogramRecord(&agent->histograms[op], end - start);
+            if (!ok) {
+                agent->errors[op]++;
+            }
+            agent->lastEnd = end;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs every agent through one step and merges their results.
+ *
+ * @param agents The agents.
+ * @param targetRate Target total ops/s, 0 for unthrottled.
+ * @param warmupNs Warmup before the measured window.
+ * @param durationNs Length of the measured window.
+ * @param result Receives the merged results.
+ * @return 1 on success, 0 if the agent threads could not be started.
+ */
+static int runStep(Agent *agents, double targetRate, long long warmupNs, long long durationNs, StepResult *result) {
+    for (int a = 0; a < agentCount; a++) {
+        memset(agents[a].histograms, 0, sizeof(agents[a].histograms));
+        memset(agents[a].errors, 0, sizeof(agents[a].errors));
+        agents[a].missed = 0;
+        agents[a].lastEnd = 0;
+    }
+    agentInterval = targetRate > 0 ? (long long)((double)agentCount * 1e9 / targetRate) : 0;
+    if (targetRate > 0 && agentInterval == 0) {
+        agentInterval = 1;
+    }
+    stepStart = nowNanos() + 10000000LL; // Time for every thread to start
+    measureStart = stepStart + warmupNs;
+    stepEnd = measureStart + durationNs;
+    stepDeadline = stepEnd + durationNs;
+
+    int started = 0;
+    for (; started < agentCount; started++) {
+        if (pthread_create(&agents[started].thread, NULL, runAgent, agents + started) != 0) {
+            printf("Error: Could not start agent %d.\n", started);
+            stepEnd = 0; // Make the started agents stop at once
+            break;
+        }
+    }
+    for (int a = 0; a < started; a++) {
+        pthread_join(agents[a].thread, NULL);
+    }
+    if (started < agentCount) {
+        return 0;
+    }
+
+    LatencyHistogram *merged = (LatencyHistogram *)calloc(LOAD_OP_COUNT + 1, sizeof(LatencyHistogram));
+    if (merged == NULL) {
+        printf("Error: Could not allocate memory for step results.\n");
+        return 0;
+    }
+    memset(result, 0, sizeof(*result));
+    result->targetRate = targetRate;
+    long long lastEnd = stepEnd;
+    for (int a = 0; a < agentCount; a++) {
+        for (int op = 0; op < LOAD_OP_COUNT; op++) {
+            histogramMerge(&merged[op], &agents[a].histograms[op]);
+            histogramMerge(&merged[LOAD_OP_COUNT], &agents[a].histograms[op]);
+            result->errors[op] += agents[a].errors[op];
+            result->errors[LOAD_OP_COUNT] += agents[a].errors[op];
+        }
+        result->missed += agents[a].missed;
+        if (agents[a].lastEnd > lastEnd) {
+            lastEnd = agents[a].lastEnd; // Throttled agents may finish their schedule late
+        }
+    }
+    for (int op = 0; op <= LOAD_OP_COUNT; op++) {
+        histogramSummarize(&merged[op], &result->ops[op]);
+    }
+    free(merged);
+
+    long long completed = result->ops[LOAD_OP_COUNT].count - result->missed;
+    result->achievedRate = (double)completed * 1e9 / (double)(lastEnd - measureStart);
+    return 1;
+}
+
+/**
+ * @brief Prints one step's results.
+ *
+ * @param result The step.
+ */
+static void printStep(const StepResult *result) {
+    char target[32];
+    if (result->targetRate > 0) {
+        snprintf(target, sizeof(target), "%.0f ops/s", result->targetRate);
+    } else {
+        snprintf(target, sizeof(target), "unthrottled");
+    }
+    printf("[load] target %-14s achieved %10.0f ops/s  errors %lld  missed %lld\n",
+           target, result->achievedRate, result->errors[LOAD_OP_COUNT], result->missed);
+    printf("       %-8s %10s %8s %10s %10s %10s %10s %10s  (us)\n",
+           "op", "count", "errors", "p50", "p90", "p99", "p99.9", "max");
+    for (int op = 0; op <= LOAD_OP_COUNT; op++) {
+        const LatencySummary *s = &result->ops[op];
+        if (s->count == 0) {
+            continue;
+        }
+        printf("       %-8s %10lld %8lld %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+               op < LOAD_OP_COUNT ? loadOpNames[op] : "all", s->count, result->errors[op],
+               s->p50 / 1e3, s->p90 / 1e3, s->p99 / 1e3, s->p999 / 1e3, s->max / 1e3);
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Writes every step's results as CSV, one row per step and operation.
+ *
+ * @param filename The output file.
+ * @param results The steps.
+ * @param stepCount The number of steps.
+ * @return 1 on success, 0 on failure (e.g., file cannot be opened).
+ */
+static int writeCurveCsv(const char *filename, const StepResult *results, int stepCount) {
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open %s for writing.\n", filename);
+        return 0;
+    }
+    fprintf(fp, "mode,agents,target_ops,achieved_ops,missed,op,count,errors,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n");
+    for (int s = 0; s < stepCount; s++) {
+        const StepResult *r = results + s;
+        for (int op = 0; op <= LOAD_OP_COUNT; op++) {
+            const LatencySummary *o = &r->ops[op];
+            fprintf(fp, "%s,%d,%.0f,%.1f,%lld,%s,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n",
+                    useServer ? "server" : "inproc", agentCount, r->targetRate, r->achievedRate, r->missed,
+                    op < LOAD_OP_COUNT ? loadOpNames[op] : "all", o->count, r->errors[op],
+                    o->p50, o->p90, o->p99, o->p999, o->max);
+        }
+    }
+    fclose(fp);
+    return 1;
+}
+
+/**
+ * @brief Parses a comma-separated list of target rates.
+ *
+ * @param text The list (e.g., "0,5000,10000").
+ * @param rates Receives the rates.
+ * @return The number of rates parsed (0 if the list is invalid).
+ */
+static int parseRates(const char *text, double *rates) {
+    int count = 0;
+    while (*text != '\0' && count < LOAD_MAX_RATES) {
+        char *end;
+        double value = strtod(text, &end);
+        if (end == text || value < 0) {
+            return 0;
+        }
+        rates[count++] = value;
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return 0;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Parses a request mix such as "search=40,book=20"; unnamed operations get weight 0.
+ *
+ * @param text The mix.
+ * @return 1 on success, 0 if the mix is invalid or all weights are zero.
+ */
+static int parseMix(const char *text) {
+    int weights[LOAD_OP_COUNT] = { 0 };
+    int total = 0;
+    while (*text != '\0') {
+        const char *equals = strchr(text, '=');
+        if (equals == NULL) {
+            return 0;
+        }
+        int op = 0;
+        while (op < LOAD_OP_COUNT && (strlen(loadOpNames[op]) != (size_t)(equals - text) ||
+                                      strncmp(loadOpNames[op], text, (size_t)(equals - text)) != 0)) {
+            op++;
+        }
+        char *end;
+        long weight = strtol(equals + 1, &end, 10);
+        if (op == LOAD_OP_COUNT || end == equals + 1 || weight < 0 || weight > 1000000L ||
+            (*end != ',' && *end != '\0')) {
+            return 0;
+        }
+        weights[op] = (int)weight;
+        total += (int)weight;
+        text = (*end == ',') ? end + 1 : end;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    memcpy(mixWeights, weights, sizeof(weights));
+    mixTotal = total;
+    return 1;
+}
+
+/**
+ * @brief Generates an in-process flight table with empty seat maps.
+ *
+ * @param count The number of flights.
+ * @param rng The generator state.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int generateFlights(int count, unsigned long long *rng) {
+    int airports = (int)(sizeof(loadAirports) / sizeof(loadAirports[0]));
+    testFlights = (Flight *)trackedMalloc(MEM_FLIGHTS, (size_t)count * sizeof(Flight));
+    if (testFlights == NULL) {
+        printf("Error: Could not allocate memory for %d flights.\n", count);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        Flight *f = testFlights + i;
+        int from = randomBelow(rng, airports);
+        int to = (from + 1 + randomBelow(rng, airports - 1)) % airports;
+        memset(f, 0, sizeof(*f));
+        f->flightID = i + 1;
+        snprintf(f->flightName, MAX_NAME_LEN, "LT%d", i + 1);
+        strcpy(f->origin, loadAirports[from]);
+        strcpy(f->destination, loadAirports[to]);
+        f->departure.day = 1 + randomBelow(rng, 28);
+        f->departure.month = 1 + randomBelow(rng, 12);
+        f->departure.year = 2025;
+        f->departure.hour = randomBelow(rng, 22);
+        f->departure.minute = randomBelow(rng, 60);
+        f->arrival = f->departure;
+        f->arrival.hour = f->departure.hour + 1;
+        f->status = ON_TIME;
+        f->availableSeats = MAX_PASSENGERS_PER_FLIGHT;
+    }
+    testFlightCount = count;
+    return 1;
+}
+
+/**
+ * @brief Builds the target catalog from the in-process flight table.
+ *
+ * @return 1 on success, 0 if there are no flights or memory ran out.
+ */
+static int catalogFromFlights(void) {
+    if (testFlightCount == 0) {
+        printf("Error: There are no flights to load-test against.\n");
+        return 0;
+    }
+    catalog = (CatalogEntry *)malloc((size_t)testFlightCount * sizeof(CatalogEntry));
+    if (catalog == NULL) {
+        printf("Error: Could not allocate memory for the catalog.\n");
+        return 0;
+    }
+    for (int i = 0; i < testFlightCount; i++) {
+        catalog[i].flightID = testFlights[i].flightID;
+        strcpy(catalog[i].origin, testFlights[i].origin);
+        strcpy(catalog[i].destination, testFlights[i].destination);
+    }
+    catalogCount = testFlightCount;
+    return 1;
+}
+
+/**
+ * @struct StressResult
+ * @brief What one stress process did, written where the parent can read it.
+ */
+typedef struct {
+    long long bookings;         /**< Tickets booked. */
+    long long cancellations;    /**< Tickets cancelled again. */
+    int saved;                  /**< 1 once its tickets were merged into the ticket file. */
+} StressResult;
+
+/**
+ * @var startupTickets
+ * @brief The tickets on file before the stress processes start; each process inherits a copy.
+ */
+static Ticket startupTickets[LOAD_STARTUP_TICKETS];
+static int startupTicketCount = 0; /**< Entries in startupTickets. */
+
+/**
+ * @brief Books the startup tickets into the flight table and the ticket table before the segment is created.
+ *
+ * The seats are marked in the seat maps directly, as a ticket file loaded
+ * together with its flights file would have them.
+ */
+static void seedStartupTickets(void) {
+    startupTicketCount = 0;
+    for (int i = 0; i < LOAD_STARTUP_TICKETS && i / testFlightCount < MAX_PASSENGERS_PER_FLIGHT; i++) {
+        Flight *f = testFlights + i % testFlightCount;
+        int seatNo = MAX_PASSENGERS_PER_FLIGHT - i / testFlightCount;
+        f->seatMap[SEAT_BYTE(seatNo)] |= SEAT_MASK(seatNo);
+        f->availableSeats--;
+        int ticketID = issueTicket("startup", f->flightID, seatNo); // No inventory bound: only recorded
+        if (ticketID > 0) {
+            startupTickets[startupTicketCount++] = globalTickets[globalTicketCount - 1];
+        }
+    }
+}
+
+/**
+ * @brief Body of one stress process: books and cancels random seats, then merges its tickets into the file.
+ *
+ * @param index The process number, 0-based.
+ * @param segmentName The shared inventory to attach to.
+ * @param ticketFile The ticket file every process merges into.
+ * @param durationNs How long to book and cancel.
+ * @param seed The process's generator seed (non-zero).
+ * @param result Receives what the process did.
+ * @return 0 on success, 1 on failure (the process exit status).
+ */
+static int runStressProcess(int index, const char *segmentName, const char *ticketFile, long long durationNs,
+                            unsigned long long seed, StressResult *result) {
+    SharedInventory inv;
+    int *held = (int *)malloc(LOAD_AGENT_TICKETS * sizeof(int));
+    if (held == NULL || !attachInventory(&inv, segmentName)) { // A mapping of its own, like a separate program
+        free(held);
+        return 1;
+    }
+    bindTicketInventory(&testFlights, &testFlightCount, &inv);
+    char name[MAX_NAME_LEN];
+    snprintf(name, sizeof(name), "stress%d", index);
+    int heldCount = 0, nextStartup = 0;
+    long long end = nowNanos() + durationNs;
+    while (nowNanos() < end) {
+        if (nextStartup < startupTicketCount && randomBelow(&seed, 16) == 0) {
+            // Only the first process to cancel a startup ticket frees its seat; the others hold a stale copy
+            if (revokeTicket(startupTickets[nextStartup].ticketID)) {
+                result->cancellations++;
+            }
+            nextStartup++;
+        } else if (heldCount > 0 && (heldCount == LOAD_AGENT_TICKETS || randomBelow(&seed, 4) == 0)) {
+            int pick = randomBelow(&seed, heldCount);
+            if (revokeTicket(held[pick])) {
+                result->cancellations++;
+            }
+            held[pick] = held[--heldCount];
+        } else if (startupTicketCount > 0 && randomBelow(&seed, 2) == 0) {
+            const Ticket *s = startupTickets + randomBelow(&seed, startupTicketCount); // Rebook a startup seat
+            int ticketID = issueTicket(name, s->flightID, s->seatNo);
+            if (ticketID > 0) {
+                held[heldCount++] = ticketID;
+                result->bookings++;
+            }
+        } else {
+            int ticketID = issueTicket(name, catalog[randomBelow(&seed, catalogCount)].flightID,
+                                       1 + randomBelow(&seed, MAX_PASSENGERS_PER_FLIGHT));
+            if (ticketID > 0) {
+                held[heldCount++] = ticketID;
+                result->bookings++;
+            }
+        }
+    }
+    result->saved = saveSharedTickets(ticketFile);
+    bindTicketInventory(NULL, NULL, NULL);
+    detachInventory(&inv);
+    free(held);
+    return result->saved ? 0 : 1;
+}
+
+/**
+ * @brief Comparison function for qsort: orders tickets by ID.
+ */
+static int compareTicketsByID(const void *a, const void *b) {
+    const Ticket *x = (const Ticket *)a;
+    const Ticket *y = (const Ticket *)b;
+    return (x->ticketID > y->ticketID) - (x->ticketID < y->ticketID);
+}
+
+/**
+ * @brief Comparison function for qsort: orders tickets by flight, then seat.
+ */
+static int compareTicketsBySeat(const void *a, const void *b) {
+    const Ticket *x = (const Ticket *)a;
+    const Ticket *y = (const Ticket *)b;
+    if (x->flightID != y->flightID) {
+        return (x->flightID > y->flightID) - (x->flightID < y->flightID);
+    }
+    return (x->seatNo > y->seatNo) - (x->seatNo < y->seatNo);
+}
+
+/**
+ * @brief Checks the ticket file against the segment after every stress process has exited.
+ *
+ * @param inv The shared inventory.
+ * @param expected The bookings minus cancellations of every process.
+ * @return The number of problems found (0 if the inventory held up).
+ */
+static int verifySharedTickets(const SharedInventory *inv, long long expected) {
+    int problems = 0;
+    if (globalTicketCount != expected) {
+        printf("FAIL: %d tickets on file, but the processes hold %lld (lost or extra tickets).\n",
+               globalTicketCount, expected);
+        problems++;
+    }
+    qsort(globalTickets, (size_t)globalTicketCount, sizeof(Ticket), compareTicketsByID);
+    for (int i = 1; i < globalTicketCount; i++) {
+        if (globalTickets[i].ticketID == globalTickets[i - 1].ticketID) {
+            printf("FAIL: Ticket ID %d was issued twice.\n", globalTickets[i].ticketID);
+            problems++;
+        }
+    }
+    qsort(globalTickets, (size_t)globalTicketCount, sizeof(Ticket), compareTicketsBySeat);
+    for (int i = 1; i < globalTicketCount; i++) {
+        if (globalTickets[i].flightID == globalTickets[i - 1].flightID &&
+            globalTickets[i].seatNo == globalTickets[i - 1].seatNo) {
+            printf("FAIL: Seat %d of flight %d was sold twice.\n", globalTickets[i].seatNo, globalTickets[i].flightID);
+            problems++;
+        }
+    }
+    // Every claimed seat has exactly one ticket and every ticket a claimed seat
+    int next = 0;
+    for (int i = 0; i < inventoryFlightCount(inv); i++) {
+        const Flight *f = inventoryFlightAt(inv, i);
+        int claimed = 0, ticketed = 0;
+        for (int seatNo = 1; seatNo <= MAX_PASSENGERS_PER_FLIGHT; seatNo++) {
+            claimed += SEAT_IS_BOOKED(f->seatMap, seatNo) != 0;
+        }
+        while (next < globalTicketCount && globalTickets[next].flightID == f->flightID) {
+            if (!SEAT_IS_BOOKED(f->seatMap, globalTickets[next].seatNo)) {
+                printf("FAIL: Ticket %d holds seat %d of flight %d, which is not claimed.\n",
+                       globalTickets[next].ticketID, globalTickets[next].seatNo, f->flightID);
+                problems++;
+            }
+            ticketed++;
+            next++;
+        }
+        if (claimed != ticketed || f->availableSeats != MAX_PASSENGERS_PER_FLIGHT - claimed) {
+            printf("FAIL: Flight %d has %d seats claimed, %d tickets and %d seats available.\n",
+                   f->flightID, claimed, ticketed, f->availableSeats);
+            problems++;
+        }
+    }
+    return problems;
+}
+
+/**
+ * @brief Runs the multi-process stress test of the shared-memory seat inventory (--mode shared).
+ *
+ * @param processes The number of booking processes to fork.
+ * @param durationNs How long each one books and cancels.
+ * @param seed The generator seed.
+ * @return 1 if the inventory held up, 0 on a failed check or setup error.
+ */
+static int runSharedStress(int processes, long long durationNs, unsigned long long seed) {
+    char segmentName[INVENTORY_NAME_LEN], ticketFile[64];
+    snprintf(segmentName, sizeof(segmentName), "/flight_loadtest_%d", (int)getpid());
+    snprintf(ticketFile, sizeof(ticketFile), "loadtest_tickets_%d.txt", (int)getpid());
+    SharedInventory inv;
+    destroyInventory(segmentName); // Left over from a crashed run
+    seedStartupTickets();
+    if (!createInventory(&inv, segmentName, testFlightCount) || !publishFlights(&inv, testFlights, testFlightCount)) {
+        printf("Error: Could not create the shared inventory %s.\n", segmentName);
+        detachInventory(&inv);
+        return 0;
+    }
+    StressResult *results = (StressResult *)mmap(NULL, (size_t)processes * sizeof(StressResult),
+                                                 PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int ok = results != MAP_FAILED && saveTickets(ticketFile); // Start from the startup tickets
+    if (!ok) {
+        printf("Error: Could not set up the stress processes.\n");
+    }
+    printf("Shared inventory stress: %d processes, %d flights, %d tickets loaded at startup, %.1f s.\n", processes,
+           testFlightCount, startupTicketCount, durationNs / 1e9);
+    int started = 0;
+    for (int p = 0; ok && p < processes; p++) {
+        fflush(stdout); // Do not let the children repeat buffered output
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(runStressProcess(p, segmentName, ticketFile, durationNs,
+                                   (seed + 0x9E3779B97F4A7C15ULL * (unsigned long long)(p + 1)) | 1ULL,
+                                   results + p));
+        }
+        if (pid < 0) {
+            printf("Error: Could not fork stress process %d.\n", p);
+            ok = 0;
+        } else {
+            started++;
+        }
+    }
+    for (int p = 0; p < started; p++) {
+        int status;
+        if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("FAIL: A stress process did not finish cleanly.\n");
+            ok = 0;
+        }
+    }
+
+    if (ok) {
+        long long bookings = 0, cancellations = 0;
+        for (int p = 0; p < processes; p++) {
+            bookings += results[p].bookings;
+            cancellations += results[p].cancellations;
+        }
+        ok = loadTickets(ticketFile) && verifySharedTickets(&inv, startupTicketCount + bookings - cancellations) == 0;
+        printf("%lld bookings, %lld cancellations, %d tickets on file: %s\n", bookings, cancellations,
+               globalTicketCount, ok ? "OK (no double-sold seats, no lost or duplicate tickets)" : "FAILED");
+    }
+    if (results != MAP_FAILED) {
+        munmap(results, (size_t)processes * sizeof(StressResult));
+    }
+    detachInventory(&inv);
+    destroyInventory(segmentName);
+    unlink(ticketFile);
+    return ok;
+}
+
+/**
+ * @brief Builds the target catalog from a remote server's LIST.
+ *
+ * @param agent An agent whose connection is used for the request.
+ * @return 1 on success, 0 if the server could not be reached or lists no flights.
+ */
+static int catalogFromServer(Agent *agent) {
+    char line[LOAD_LINE_SIZE];
+    agent->fd = connectToServer();
+    catalog = (CatalogEntry *)malloc(SERVICE_LIST_LIMIT * sizeof(CatalogEntry));
+    if (agent->fd < 0 || catalog == NULL || !sendAll(agent->fd, "LIST\n", 5) ||
+        !readLine(agent, line, sizeof(line)) || strncmp(line, "OK", 2) != 0) {
+        printf("Error: Could not LIST flights from 127.0.0.1:%d.\n", serverPort);
+        return 0;
+    }
+    while (readLine(agent, line, sizeof(line)) && strcmp(line, ".") != 0) {
+        CatalogEntry *e = catalog + catalogCount;
+        if (catalogCount < SERVICE_LIST_LIMIT &&
+            sscanf(line, "%d,%*[^,],%99[^,],%99[^,]", &e->flightID, e->origin, e->destination) == 3) {
+            catalogCount++;
+        }
+    }
+    if (catalogCount == 0) {
+        printf("Error: The server at 127.0.0.1:%d lists no flights.\n", serverPort);
+    }
+    return catalogCount > 0;
+}
+
+/**
+ * @brief Entry point of the load tester.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
+ * @return 0 on success, 1 on invalid arguments or failure.
+ */
+int main(int argc, char *argv[]) {
+    double rates[LOAD_MAX_RATES];
+    int rateCount = 0;
+    double durationSeconds = 5.0;
+    double warmupSeconds = 1.0;
+    int flightCount = MAX_FLIGHTS;
+    int loadFiles = 0;
+    int remotePort = 0;
+    unsigned long long seed = 88172645463325252ULL;
+    const char *outFile = "loadtest_curve.csv";
+    const char *profileFile = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--load") == 0) {
+            loadFiles = 1; // The only option without a value
+            continue;
+        }
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL) {
+            printf("Missing value for %s.\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--agents") == 0) {
+            agentCount = atoi(value);
+        } else if (strcmp(argv[i], "--duration") == 0) {
+            durationSeconds = atof(value);
+        } else if (strcmp(argv[i], "--warmup") == 0) {
+            warmupSeconds = atof(value);
+        } else if (strcmp(argv[i], "--rates") == 0) {
+            rateCount = parseRates(value, rates);
+            if (rateCount == 0) {
+                printf("Invalid --rates list: %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--mix") == 0) {
+            if (!parseMix(value)) {
+                printf("Invalid --mix: %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--mode") == 0) {
+            if (strcmp(value, "server") == 0) {
+                useServer = 1;
+            } else if (strcmp(value, "shared") == 0) {
+                useShared = 1;
+            } else if (strcmp(value, "inproc") != 0) {
+                printf("Unknown mode %s (use inproc, server or shared).\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--port") == 0) {
+            remotePort = atoi(value);
+        } else if (strcmp(argv[i], "--flights") == 0) {
+            flightCount = atoi(value);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(value, NULL, 10) | 1ULL; // xorshift state must be non-zero
+        } else if (strcmp(argv[i], "--out") == 0) {
+            outFile = value;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profileFile = value;
+        } else {
+            printf("Unknown option %s.\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    if (agentCount <= 0 || agentCount > LOAD_MAX_AGENTS || durationSeconds <= 0 || warmupSeconds < 0 ||
+        flightCount <= 0 || flightCount > MAX_FLIGHTS || remotePort < 0 || remotePort > 65535) {
+        printf("Invalid arguments: agents 1-%d, positive duration and flights (at most %d), port 0-65535.\n",
+               LOAD_MAX_AGENTS, MAX_FLIGHTS);
+        return 1;
+    }
+    if (remotePort > 0 && !useServer) {
+        printf("--port needs --mode server.\n");
+        return 1;
+    }
+    if (useShared) {
+        int ok = initializeTickets() && generateFlights(flightCount, &seed) && catalogFromFlights() &&
+                 runSharedStress(agentCount, (long long)(durationSeconds * 1e9), seed);
+        trackedFree(MEM_FLIGHTS, testFlights);
+        cleanupTickets();
+        free(catalog);
+        return ok ? 0 : 1;
+    }
+
+    Agent *agents = (Agent *)calloc((size_t)agentCount, sizeof(Agent));
+    if (agents == NULL) {
+        printf("Error: Could not allocate memory for %d agents.\n", agentCount);
+        return 1;
+    }
+    int ok = 1;
+    for (int a = 0; a < agentCount && ok; a++) {
+        agents[a].index = a;
+        agents[a].rng = (seed + 0x9E3779B97F4A7C15ULL * (unsigned long long)(a + 1)) | 1ULL;
+        agents[a].fd = -1;
+        agents[a].pending = (char *)malloc(LOAD_LINE_SIZE);
+        agents[a].response = useServer ? NULL : (char *)malloc(SERVICE_RESPONSE_SIZE);
+        ok = agents[a].pending != NULL && (useServer || agents[a].response != NULL);
+    }
+    if (!ok) {
+        printf("Error: Could not allocate agent buffers.\n");
+    }
+
+    // In-process data (also served by the in-process server)
+    ServerHandle server;
+    int serverStarted = 0;
+    if (ok && remotePort == 0) {
+        if (loadFiles) {
+            ok = initializePassengers() && initializeTickets() &&
+                 loadFlights(&testFlights, &testFlightCount, "flights.txt") &&
+                 loadPassengers("passengers.txt") && loadTickets("tickets.txt");
+        } else {
+            ok = initializeTickets() && generateFlights(flightCount, &seed);
+        }
+        if (ok) {
+            bindTicketInventory(&testFlights, &testFlightCount, NULL);
+            bindService(&testFlights, &testFlightCount);
+            ok = catalogFromFlights();
+        }
+        if (ok && useServer) {
+            ok = serverStarted = startServer(&server, 0);
+            serverPort = server.port;
+        }
+    } else if (ok) {
+        serverPort = remotePort;
+        ok = catalogFromServer(&agents[0]);
+    }
+
+    int stepCount = rateCount > 0 ? rateCount : 7;
+    StepResult *results = ok ? (StepResult *)calloc((size_t)stepCount, sizeof(StepResult)) : NULL;
+    if (ok && results == NULL) {
+        printf("Error: Could not allocate memory for results.\n");
+        ok = 0;
+    }
+    if (ok) {
+        printf("Load test: %d agents, %s mode (127.0.0.1:%d), %d target flights, %.1f s warmup + %.1f s per step.\n",
+               agentCount, useServer ? "server" : "in-process", useServer ? serverPort : 0, catalogCount,
+               warmupSeconds, durationSeconds);
+        if (profileFile != NULL) {
+            startProfiler(PROFILE_DEFAULT_HZ);
+        }
+    }
+
+    long long warmupNs = (long long)(warmupSeconds * 1e9);
+    long long durationNs = (long long)(durationSeconds * 1e9);
+    static const double autoFractions[] = { 0.25, 0.50, 0.75, 0.90, 1.00, 1.10 };
+    int completedSteps = 0;
+    for (int s = 0; ok && s < stepCount; s++) {
+        double target;
+        if (rateCount > 0) {
+            target = rates[s];
+        } else if (s == 0) {
+            target = 0; // Find the peak first
+        } else {
+            target = results[0].achievedRate * autoFractions[s - 1];
+        }
+        ok = runStep(agents, target, warmupNs, durationNs, results + s);
+        if (ok) {
+            printStep(results + s);
+            completedSteps++;
+        }
+    }
+
+    if (profileFile != NULL && stopProfiler()) {
+        writeFoldedStacks(profileFile);
+    }
+    if (completedSteps > 0 && useServer) {
+        // Only protocol requests go through the response cache
+        long long hits, misses;
+        int entries;
+        getResultCacheCounts(&hits, &misses, &entries);
+        printf("Response cache: %lld hits, %lld misses, %d responses cached.\n", hits, misses, entries);
+    }
+    if (completedSteps > 0 && writeCurveCsv(outFile, results, completedSteps)) {
+        printf("Results written to %s.\n", outFile);
+    }
+
+    for (int a = 0; a < agentCount; a++) {
+        if (agents[a].fd >= 0) {
+            close(agents[a].fd);
+        }
+        free(agents[a].pending);
+        free(agents[a].response);
+    }
+    if (serverStarted) {
+        stopServer(&server);
+    }
+    bindService(NULL, NULL);
+    bindTicketInventory(NULL, NULL, NULL);
+    cleanupResultCache();
+    cleanupIDIndexes();
+    cleanupBloomFilters();
+    trackedFree(MEM_FLIGHTS, testFlights);
+    cleanupPassengers();
+    cleanupTickets();
+    free(catalog);
+    free(results);
+    free(agents);
+    return ok ? 0 : 1;
+}
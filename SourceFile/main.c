@@ -11,12 +11,35 @@
 #include "common.h" // MUST BE FIRST for shared macros/definitions
 #include <stdio.h>
 #include <stdlib.h> // For exit
+#include <string.h> // For strcmp
 
 #include "flight.h"
 #include "passenger.h"
 #include "crew.h"
 #include "ticket.h"
 #include "payment.h"
+#include "inventory.h"
+#include "stats.h"
+#include "trace.h"
+#include "memstats.h"
+#include "profiler.h"
+#include "service.h"
+#include "server.h"
+#include "session.h"
+#include "render.h"
+#include "page.h"
+#include "query.h"
+#include "flightindex.h"
+#include "availability.h"
+#include "aggregates.h"
+#include "reports.h"
+#include "resultcache.h"
+#include "idindex.h"
+#include "bloom.h"
+#include "journey.h"
+#include "segment.h"
+#include "schedule.h"
+#include "timing.h"
 
 /**
  * @brief Clears the input buffer.
@@ -30,6 +53,794 @@ static void clearInputBuffer() {
     while ((c = getchar()) != '\n' && c != EOF);
 }
 
+/**
+ * @brief Writes one table to "<name>.csv" or "<name>.json".
+ *
+ * @param name The base file name.
+ * @param format RENDER_CSV or RENDER_JSON.
+ * @param table The kind of records.
+ * @param records The records (Flight, Passenger or Ticket array).
+ * @param count The number of records.
+ */
+static void exportTable(const char *name, RenderFormat format, RenderTable table, const void *records, int count) {
+    char filename[64];
+    snprintf(filename, sizeof(filename), "%s.%s", name, renderFormatExtension(format));
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open %s for writing.\n", filename);
+        return;
+    }
+    int ok = 0;
+    switch (table) {
+        case RENDER_FLIGHTS: ok = renderFlights(fp, format, (const Flight *)records, count); break;
+        case RENDER_PASSENGERS: ok = renderPassengers(fp, format, (const Passenger *)records, count); break;
+        case RENDER_TICKETS: ok = renderTickets(fp, format, (const Ticket *)records, count); break;
+    }
+    fclose(fp);
+    if (ok) {
+        printf("Exported %d records to %s.\n", count, filename);
+    } else {
+        printf("Error: Could not write %s.\n", filename);
+    }
+}
+
+/**
+ * @brief Prompts for a filter query and lists the matching flights with the plan used.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+static void queryFlights(const Flight *flights, int flightCount) {
+    char text[256];
+    Query query;
+    printf("Enter query (e.g., origin=DAC AND status=DELAYED AND departure in today AND seats>=4): ");
+    GET_STRING(text, sizeof(text));
+    if (!compileQuery(text, &query)) {
+        return;
+    }
+    int *indexes = (int *)trackedMalloc(MEM_OTHER, (size_t)(flightCount > 0 ? flightCount : 1) * sizeof(int));
+    if (indexes == NULL) {
+        printf("Error: Could not allocate memory for the query results.\n");
+        return;
+    }
+    QueryPlan plan;
+    int matches = runQuery(flights, flightCount, &query, indexes, flightCount, &plan);
+    if (matches >= 0) {
+        printf("Plan: %s, %d candidate(s) checked, %d match(es).\n", queryPlanName(plan.kind), plan.candidates, matches);
+        if (matches > 0) {
+            renderFlightSelection(stdout, RENDER_PLAIN, flights, indexes, matches);
+        }
+    }
+    trackedFree(MEM_OTHER, indexes);
+}
+
+/**
+ * @brief Prompts for a route, a group size and an order, and lists the top K bookable flights.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+static void findAvailable(const Flight *flights, int flightCount) {
+    char origin[MAX_NAME_LEN], destination[MAX_NAME_LEN] = "";
+    int minSeats, orderChoice, k;
+    printf("Enter origin (* for all routes): ");
+    GET_STRING(origin, MAX_NAME_LEN);
+    int allRoutes = strcmp(origin, "*") == 0;
+    if (!allRoutes) {
+        printf("Enter destination: ");
+        GET_STRING(destination, MAX_NAME_LEN);
+    }
+    printf("Enter seats needed: ");
+    if (scanf("%d", &minSeats) != 1) {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return;
+    }
+    printf("Order (1 = most free seats, 2 = earliest departure): ");
+    if (scanf("%d", &orderChoice) != 1 || (orderChoice != 1 && orderChoice != 2)) {
+        printf("Invalid input! Please enter 1 or 2.\n");
+        clearInputBuffer();
+        return;
+    }
+    printf("How many flights to show: ");
+    if (scanf("%d", &k) != 1 || k < 1) {
+        printf("Invalid input! Please enter a positive number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+
+    if (k > flightCount) {
+        k = flightCount > 0 ? flightCount : 1;
+    }
+    int *indexes = (int *)trackedMalloc(MEM_OTHER, (size_t)k * sizeof(int));
+    if (indexes == NULL) {
+        printf("Error: Could not allocate memory for the results.\n");
+        return;
+    }
+    int matches = findAvailableFlights(flights, flightCount, allRoutes ? NULL : origin, destination, minSeats,
+                                       orderChoice == 1 ? AVAIL_BY_SEATS : AVAIL_BY_DEPARTURE, indexes, k);
+    if (matches >= 0) {
+        printf("%d flight(s) with at least %d free seat(s).\n", matches, minSeats);
+        if (matches > 0) {
+            renderFlightSelection(stdout, RENDER_PLAIN, flights, indexes, matches < k ? matches : k);
+        }
+    }
+    trackedFree(MEM_OTHER, indexes);
+}
+
+/**
+ * @brief Prints one set of aggregate totals.
+ *
+ * @param label What the totals cover.
+ * @param view The totals.
+ */
+static void printAggregate(const char *label, const AggregateView *view) {
+    printf("%s: %d flight(s), %lld of %lld seats sold, load factor %.1f%%\n",
+           label, view->flights, view->seatsSold, view->seatCapacity, 100.0 * aggregateLoadFactor(view));
+}
+
+/**
+ * @brief Shows the route, day or overall totals, or verifies them against a full recompute.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+static void showDashboard(const Flight *flights, int flightCount) {
+    int subChoice;
+    AggregateView view;
+    printf("\n--- Dashboard ---\n");
+    printf("1. Route Totals\n");
+    printf("2. Day Totals\n");
+    printf("3. All Flights\n");
+    printf("4. Verify Against Full Recompute\n");
+    printf("Enter your choice: ");
+    if (scanf("%d", &subChoice) != 1) {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+
+    switch (subChoice) {
+        case 1: {
+            char origin[MAX_NAME_LEN], destination[MAX_NAME_LEN];
+            printf("Enter origin: ");
+            GET_STRING(origin, MAX_NAME_LEN);
+            printf("Enter destination: ");
+            GET_STRING(destination, MAX_NAME_LEN);
+            if (getRouteAggregate(flights, flightCount, origin, destination, &view)) {
+                printAggregate("Route", &view);
+            }
+            break;
+        }
+        case 2: {
+            unsigned int day, month, year;
+            printf("Enter day (DD MM YYYY): ");
+            if (scanf("%u %u %u", &day, &month, &year) != 3) {
+                printf("Invalid date format.\n");
+                clearInputBuffer();
+                return;
+            }
+            clearInputBuffer(); // Consume newline after scanf
+            DateTime date = { 0 };
+            date.day = day;
+            date.month = month;
+            date.year = year;
+            if (getDayAggregate(flights, flightCount, &date, &view)) {
+                printAggregate("Day", &view);
+            }
+            break;
+        }
+        case 3:
+            if (getTotalAggregate(flights, flightCount, &view)) {
+                printAggregate("All flights", &view);
+            }
+            break;
+        case 4: {
+            int drifted = verifyAggregates(flights, flightCount);
+            if (drifted >= 0) {
+                printf("%d row(s) drifted from a full recompute.\n", drifted);
+            }
+            break;
+        }
+        default:
+            printf("Invalid dashboard option!\n");
+            break;
+    }
+}
+
+/**
+ * @brief Lists the next departures from an airport, the fullest flights of a day or the busiest routes.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+static void showTopFlights(const Flight *flights, int flightCount) {
+    int subChoice, k;
+    printf("\n--- Top Flights ---\n");
+    printf("1. Next Departures From an Airport\n");
+    printf("2. Fullest Flights on a Day\n");
+    printf("3. Busiest Routes\n");
+    printf("Enter your choice: ");
+    if (scanf("%d", &subChoice) != 1) {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+    if (subChoice < 1 || subChoice > 3) {
+        printf("Invalid top flights option!\n");
+        return;
+    }
+
+    char value[MAX_NAME_LEN] = "";
+    if (subChoice == 1) {
+        printf("Enter origin: ");
+        GET_STRING(value, MAX_NAME_LEN);
+    } else if (subChoice == 2) {
+        printf("Enter day (today, tomorrow or YYYY-MM-DD): ");
+        GET_STRING(value, MAX_NAME_LEN);
+    }
+    printf("How many to show: ");
+    if (scanf("%d", &k) != 1 || k < 1) {
+        printf("Invalid input! Please enter a positive number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+
+    if (subChoice == 3) {
+        RouteAggregate *routes = (RouteAggregate *)trackedMalloc(MEM_OTHER, (size_t)k * sizeof(RouteAggregate));
+        if (routes == NULL) {
+            printf("Error: Could not allocate memory for the results.\n");
+            return;
+        }
+        int count = getBusiestRoutes(flights, flightCount, routes, k);
+        for (int i = 0; i < count; i++) {
+            char label[2 * MAX_NAME_LEN + 8];
+            snprintf(label, sizeof(label), "%d. %s -> %s", i + 1, routes[i].origin, routes[i].destination);
+            printAggregate(label, &routes[i].view);
+        }
+        if (count == 0) {
+            printf("No routes found.\n");
+        }
+        trackedFree(MEM_OTHER, routes);
+        return;
+    }
+
+    char text[MAX_NAME_LEN + 48];
+    Query query;
+    if (subChoice == 1) {
+        snprintf(text, sizeof(text), "origin=%s AND departure>=now", value);
+    } else {
+        snprintf(text, sizeof(text), "departure in %s", value);
+    }
+    if (!compileQuery(text, &query)) {
+        return;
+    }
+    if (k > flightCount) {
+        k = flightCount > 0 ? flightCount : 1;
+    }
+    int *indexes = (int *)trackedMalloc(MEM_OTHER, (size_t)k * sizeof(int));
+    if (indexes == NULL) {
+        printf("Error: Could not allocate memory for the results.\n");
+        return;
+    }
+    QueryPlan plan;
+    int found = runTopKQuery(flights, flightCount, &query, subChoice == 1 ? QUERY_ORDER_DEPARTURE : QUERY_ORDER_FULLEST,
+                             indexes, k, &plan);
+    if (found >= 0) {
+        printf("Plan: %s, %d candidate(s) checked, %d shown.\n", queryPlanName(plan.kind), plan.candidates, found);
+        if (found > 0) {
+            renderFlightSelection(stdout, RENDER_PLAIN, flights, indexes, found);
+        }
+    }
+    trackedFree(MEM_OTHER, indexes);
+}
+
+/**
+ * @brief Prompts for a date and time.
+ *
+ * @param prompt The prompt.
+ * @param out Receives the date and time.
+ * @return 1 on success, 0 on invalid input.
+ */
+static int readDateTime(const char *prompt, DateTime *out) {
+    unsigned int day, month, year, hour, minute;
+    printf("%s (DD MM YYYY HH MM): ", prompt);
+    if (scanf("%u %u %u %u %u", &day, &month, &year, &hour, &minute) != 5 || day < 1 || day > 31 ||
+        month < 1 || month > 12 || hour > 23 || minute > 59) {
+        printf("Invalid date/time format.\n");
+        clearInputBuffer();
+        return 0;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+    memset(out, 0, sizeof(*out));
+    out->day = day;
+    out->month = month;
+    out->year = year;
+    out->hour = hour;
+    out->minute = minute;
+    return 1;
+}
+
+/**
+ * @brief Prints a journey, one line per leg.
+ *
+ * @param flights The flight array the journey was found in.
+ * @param journey The journey.
+ */
+static void printJourney(const Flight *flights, const Journey *journey) {
+    int minutes = journey->arrival - journey->departure;
+    printf("%d leg(s), %dh %02dm, fare %d:\n", journey->legCount, minutes / 60, minutes % 60, journey->price);
+    for (int l = 0; l < journey->legCount; l++) {
+        const Flight *f = flights + journey->positions[l];
+        printf("  Flight %d (%s) %s -> %s, %02u-%02u-%04u %02u:%02u -> %02u-%02u-%04u %02u:%02u, ",
+               f->flightID, f->flightName, f->origin, f->destination,
+               f->departure.day, f->departure.month, f->departure.year, f->departure.hour, f->departure.minute,
+               f->arrival.day, f->arrival.month, f->arrival.year, f->arrival.hour, f->arrival.minute);
+        if (journey->seatNos[l] > 0) {
+            printf("seat %d free\n", journey->seatNos[l]);
+        } else {
+            printf("full\n");
+        }
+    }
+}
+
+/**
+ * @brief Plans journeys between two airports, changing flights where needed.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+static void planJourney(const Flight *flights, int flightCount) {
+    int subChoice;
+    printf("\n--- Plan a Journey ---\n");
+    printf("1. Earliest Arrival\n");
+    printf("2. Best Departures in a Time Window\n");
+    printf("3. Set Minimum Connection Time\n");
+    printf("4. Trade-offs: Arrival, Stops and Fare (bookable only)\n");
+    printf("Enter your choice: ");
+    if (scanf("%d", &subChoice) != 1) {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+    if (subChoice < 1 || subChoice > 4) {
+        printf("Invalid journey option!\n");
+        return;
+    }
+
+    if (subChoice == 3) {
+        char airport[MAX_NAME_LEN];
+        int minutes;
+        printf("Enter airport (* for all others): ");
+        GET_STRING(airport, MAX_NAME_LEN);
+        printf("Enter minimum connection time in minutes: ");
+        if (scanf("%d", &minutes) != 1) {
+            printf("Invalid input! Please enter a number.\n");
+            clearInputBuffer();
+            return;
+        }
+        clearInputBuffer(); // Consume newline after scanf
+        if (!setMinConnectionTime(strcmp(airport, "*") == 0 ? NULL : airport, minutes)) {
+            printf("Error: Connection time must be 0 or more, for at most %d airports.\n", JOURNEY_MAX_RULES);
+            return;
+        }
+        printf("Minimum connection time set.\n");
+        return;
+    }
+
+    char origin[MAX_NAME_LEN], destination[MAX_NAME_LEN];
+    DateTime first, last;
+    printf("Enter origin: ");
+    GET_STRING(origin, MAX_NAME_LEN);
+    printf("Enter destination: ");
+    GET_STRING(destination, MAX_NAME_LEN);
+    if (!readDateTime("Enter earliest departure", &first)) {
+        return;
+    }
+    if (subChoice == 1) {
+        Journey journey;
+        int found = findEarliestArrival(flights, flightCount, origin, destination, &first, &journey);
+        if (found > 0) {
+            printJourney(flights, &journey);
+        } else if (found == 0) {
+            printf("No journey found from %s to %s.\n", origin, destination);
+        }
+        return;
+    }
+    if (subChoice == 4) {
+        int maxLegs;
+        printf("Enter maximum flights per journey (1-%d): ", JOURNEY_MAX_LEGS);
+        if (scanf("%d", &maxLegs) != 1 || maxLegs < 1 || maxLegs > JOURNEY_MAX_LEGS) {
+            printf("Invalid input! Please enter a number from 1 to %d.\n", JOURNEY_MAX_LEGS);
+            clearInputBuffer();
+            return;
+        }
+        clearInputBuffer(); // Consume newline after scanf
+        Journey journeys[20];
+        int count = findParetoJourneys(flights, flightCount, origin, destination, &first, maxLegs, journeys, 20);
+        for (int i = 0; i < count; i++) {
+            printf("%d. ", i + 1);
+            printJourney(flights, journeys + i);
+        }
+        if (count == 0) {
+            printf("No bookable journey found from %s to %s.\n", origin, destination);
+        }
+        return;
+    }
+
+    if (!readDateTime("Enter latest departure", &last)) {
+        return;
+    }
+    Journey journeys[20];
+    int count = findJourneyProfile(flights, flightCount, origin, destination, &first, &last, journeys, 20);
+    for (int i = 0; i < count; i++) {
+        printf("%d. ", i + 1);
+        printJourney(flights, journeys + i);
+    }
+    if (count == 0) {
+        printf("No journey found from %s to %s in that window.\n", origin, destination);
+    }
+}
+
+/**
+ * @brief Defines, lists and books multi-stop flights whose legs are separate flights.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ */
+static void manageSegmentedFlights(const Flight *flights, int flightCount) {
+    int subChoice;
+    printf("\n--- Multi-Stop Flights ---\n");
+    printf("1. Define a Multi-Stop Flight\n");
+    printf("2. Remove a Multi-Stop Flight\n");
+    printf("3. List Multi-Stop Flights\n");
+    printf("4. Seats from Origin to Destination\n");
+    printf("5. Book a Seat from Origin to Destination\n");
+    printf("Enter your choice: ");
+    if (scanf("%d", &subChoice) != 1) {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+    if (subChoice < 1 || subChoice > 5) {
+        printf("Invalid multi-stop option!\n");
+        return;
+    }
+    if (subChoice == 3) {
+        listSegmentedFlights(flights, flightCount);
+        return;
+    }
+
+    char flightNumber[MAX_NAME_LEN];
+    printf("Enter flight number: ");
+    GET_STRING(flightNumber, MAX_NAME_LEN);
+    if (subChoice == 1) {
+        int legIDs[SEGMENT_MAX_LEGS];
+        int legCount;
+        printf("Enter number of legs (2-%d): ", SEGMENT_MAX_LEGS);
+        if (scanf("%d", &legCount) != 1 || legCount < 2 || legCount > SEGMENT_MAX_LEGS) {
+            printf("Invalid input! Please enter a number from 2 to %d.\n", SEGMENT_MAX_LEGS);
+            clearInputBuffer();
+            return;
+        }
+        printf("Enter the flight ID of each leg in order: ");
+        for (int l = 0; l < legCount; l++) {
+            if (scanf("%d", legIDs + l) != 1) {
+                printf("Invalid Flight ID. Please enter a number.\n");
+                clearInputBuffer();
+                return;
+            }
+        }
+        clearInputBuffer(); // Consume newline after scanf
+        if (defineSegmentedFlight(flights, flightCount, flightNumber, legIDs, legCount)) {
+            printf("Multi-stop flight %s defined with %d legs.\n", flightNumber, legCount);
+        }
+        return;
+    }
+    if (subChoice == 2) {
+        if (removeSegmentedFlight(flightNumber)) {
+            printf("Multi-stop flight %s removed.\n", flightNumber);
+        } else {
+            printf("No multi-stop flight %s.\n", flightNumber);
+        }
+        return;
+    }
+
+    char origin[MAX_NAME_LEN], destination[MAX_NAME_LEN];
+    printf("Enter origin: ");
+    GET_STRING(origin, MAX_NAME_LEN);
+    printf("Enter destination: ");
+    GET_STRING(destination, MAX_NAME_LEN);
+    if (subChoice == 4) {
+        unsigned char seatMap[SEAT_MAP_BYTES];
+        int free = segmentSeatMap(flights, flightCount, flightNumber, origin, destination, seatMap);
+        if (free < 0) {
+            printf("Flight %s does not fly from %s to %s.\n", flightNumber, origin, destination);
+            return;
+        }
+        printf("%d seat(s) free on every leg from %s to %s", free, origin, destination);
+        int shown = 0;
+        for (int seatNo = 1; seatNo <= MAX_PASSENGERS_PER_FLIGHT && shown < 20; seatNo++) {
+            if (!SEAT_IS_BOOKED(seatMap, seatNo)) {
+                printf("%s%d", shown++ == 0 ? ": " : " ", seatNo);
+            }
+        }
+        printf(free > shown ? " ...\n" : "\n");
+        return;
+    }
+
+    char passengerName[MAX_NAME_LEN];
+    int seatNo;
+    int ticketIDs[SEGMENT_MAX_LEGS];
+    printf("Enter passenger name for ticket: ");
+    GET_STRING(passengerName, MAX_NAME_LEN);
+    printf("Enter seat number for ticket: ");
+    if (scanf("%d", &seatNo) != 1 || seatNo <= 0) {
+        printf("Invalid seat number. Please enter a positive number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+    int count = bookSegmentSeat(flights, flightCount, passengerName, flightNumber, origin, destination, seatNo, ticketIDs);
+    if (count == 0) {
+        printf("Seat %d is not available on every leg of %s from %s to %s.\n", seatNo, flightNumber, origin, destination);
+        return;
+    }
+    printf("Seat %d booked on %d leg(s). Ticket ID(s):", seatNo, count);
+    for (int i = 0; i < count; i++) {
+        printf(" %d", ticketIDs[i]);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Adds, lists and books recurring flights that are stored as patterns and dated on demand.
+ *
+ * @param flights The flight array.
+ * @param flightCount A pointer to the flight count (a booked date is added to the table).
+ * @param sharedInventory The attached shared inventory, or NULL (a booked date is added to it too).
+ */
+static void manageSchedules(Flight *flights, int *flightCount, SharedInventory *sharedInventory) {
+    int subChoice;
+    printf("\n--- Recurring Schedules ---\n");
+    printf("1. Add a Recurring Flight\n");
+    printf("2. Remove a Recurring Flight\n");
+    printf("3. List Recurring Flights (with Table Slots Saved)\n");
+    printf("4. Departures on a Date\n");
+    printf("5. Book a Seat on a Dated Flight\n");
+    printf("Enter your choice: ");
+    if (scanf("%d", &subChoice) != 1) {
+        printf("Invalid input! Please enter a number.\n");
+        clearInputBuffer();
+        return;
+    }
+    clearInputBuffer(); // Consume newline after scanf
+
+    switch (subChoice) {
+        case 1: {
+            SchedulePattern pattern;
+            unsigned int fromDay, fromMonth, fromYear, toDay, toMonth, toYear, hour, minute;
+            char days[16];
+            memset(&pattern, 0, sizeof(pattern));
+            printf("Enter flight name: ");
+            GET_STRING(pattern.flightName, MAX_NAME_LEN);
+            printf("Enter origin: ");
+            GET_STRING(pattern.origin, MAX_NAME_LEN);
+            printf("Enter destination: ");
+            GET_STRING(pattern.destination, MAX_NAME_LEN);
+            printf("Enter first and last date (DD MM YYYY DD MM YYYY): ");
+            if (scanf("%u %u %u %u %u %u", &fromDay, &fromMonth, &fromYear, &toDay, &toMonth, &toYear) != 6 ||
+                fromYear > 4095 || toYear > 4095 || fromMonth > 15 || toMonth > 15 || fromDay > 31 || toDay > 31) {
+                printf("Invalid date format.\n");
+                clearInputBuffer();
+                return;
+            }
+            clearInputBuffer(); // Consume newline after scanf
+            pattern.validFrom.day = fromDay;
+            pattern.validFrom.month = fromMonth;
+            pattern.validFrom.year = fromYear;
+            pattern.validTo.day = toDay;
+            pattern.validTo.month = toMonth;
+            pattern.validTo.year = toYear;
+            printf("Enter weekdays operated, Monday first (e.g., 1010100 for Mon Wed Fri): ");
+            GET_STRING(days, sizeof(days));
+            for (int w = 0; w < 7 && days[w] != '\0'; w++) {
+                if (days[w] == '1') {
+                    pattern.weekdays |= 1 << w;
+                }
+            }
+            printf("Enter departure time (HH MM): ");
+            if (scanf("%u %u", &hour, &minute) != 2 || hour > 23 || minute > 59) {
+                printf("Invalid time format.\n");
+                clearInputBuffer();
+                return;
+            }
+            pattern.departureMinute = (int)(hour * 60 + minute);
+            printf("Enter flight duration in minutes: ");
+            if (scanf("%d", &pattern.duration) != 1) {
+                printf("Invalid input! Please enter a number.\n");
+                clearInputBuffer();
+                return;
+            }
+            clearInputBuffer(); // Consume newline after scanf
+            if (addSchedulePattern(flights, *flightCount, &pattern)) {
+                printf("Recurring flight %s added with flight IDs from %d.\n", pattern.flightName,
+                       pattern.firstFlightID);
+            }
+            break;
+        }
+        case 2: {
+            int firstFlightID;
+            printf("Enter the first flight ID of the recurring flight: ");
+            if (scanf("%d", &firstFlightID) != 1) {
+                printf("Invalid input! Please enter a number.\n");
+                clearInputBuffer();
+                return;
+            }
+            clearInputBuffer(); // Consume newline after scanf
+            if (removeSchedulePattern(firstFlightID)) {
+                printf("Recurring flight removed (dated flights already booked stay).\n");
+            } else {
+                printf("No recurring flight starts at flight ID %d.\n", firstFlightID);
+            }
+            break;
+        }
+        case 3:
+            listSchedulePatterns();
+            break;
+        case 4: {
+            char origin[MAX_NAME_LEN], destination[MAX_NAME_LEN];
+            unsigned int day, month, year;
+            printf("Enter origin (* for any): ");
+            GET_STRING(origin, MAX_NAME_LEN);
+            printf("Enter destination (* for any): ");
+            GET_STRING(destination, MAX_NAME_LEN);
+            printf("Enter day (DD MM YYYY): ");
+            if (scanf("%u %u %u", &day, &month, &year) != 3 || day < 1 || day > 31 || month < 1 || month > 12 ||
+                year < 1970 || year > 4095) {
+                printf("Invalid date format.\n");
+                clearInputBuffer();
+                return;
+            }
+            clearInputBuffer(); // Consume newline after scanf
+            DateTime date = { 0 };
+            date.day = day;
+            date.month = month;
+            date.year = year;
+            ScheduledFlight dated[20];
+            int total = findScheduledFlights(flights, *flightCount, strcmp(origin, "*") == 0 ? NULL : origin,
+                                             strcmp(destination, "*") == 0 ? NULL : destination, &date, dated, 20);
+            int shown = total < 20 ? total : 20;
+            for (int i = 0; i < shown; i++) {
+                const ScheduledFlight *s = dated + i;
+                printf("ID %d: %s %s -> %s %02hu:%02hu - %02hu-%02hu-%04hu %02hu:%02hu, %d seat(s) free%s\n",
+                       s->flightID, s->pattern->flightName, s->pattern->origin, s->pattern->destination,
+                       s->departure.hour, s->departure.minute, s->arrival.day, s->arrival.month, s->arrival.year,
+                       s->arrival.hour, s->arrival.minute, s->availableSeats, s->materialized ? " (booked before)" : "");
+            }
+            if (total == 0) {
+                printf("No recurring flights on that day.\n");
+            } else if (total > shown) {
+                printf("... and %d more.\n", total - shown);
+            }
+            break;
+        }
+        case 5: {
+            char passengerName[MAX_NAME_LEN];
+            int flightID, seatNo;
+            printf("Enter flight ID of the dated flight: ");
+            if (scanf("%d", &flightID) != 1) {
+                printf("Invalid Flight ID. Please enter a number.\n");
+                clearInputBuffer();
+                return;
+            }
+            clearInputBuffer(); // Consume newline after scanf
+            if (!isScheduledFlightID(flightID)) {
+                printf("No recurring flight operates with flight ID %d.\n", flightID);
+                return;
+            }
+            printf("Enter passenger name for ticket: ");
+            GET_STRING(passengerName, MAX_NAME_LEN);
+            printf("Enter seat number for ticket: ");
+            if (scanf("%d", &seatNo) != 1 || seatNo <= 0 || seatNo > MAX_PASSENGERS_PER_FLIGHT) {
+                printf("Invalid seat number. Please enter a number from 1 to %d.\n", MAX_PASSENGERS_PER_FLIGHT);
+                clearInputBuffer();
+                return;
+            }
+            clearInputBuffer(); // Consume newline after scanf
+            int before = *flightCount;
+            if (materializeScheduledFlight(flights, flightCount, flightID, sharedInventory) < 0) {
+                return; // The reason is printed
+            }
+            int ticketID = issueTicket(passengerName, flightID, seatNo);
+            if (ticketID > 0) {
+                printf("Seat %d booked on flight %d. Ticket ID: %d\n", seatNo, flightID, ticketID);
+            } else {
+                printf("Seat %d is not available on flight %d.\n", seatNo, flightID);
+                if (*flightCount > before) { // Dated just now: drop it again, the date stays bookable
+                    removeFlight(flights, flightCount, flightID);
+                    if (sharedInventory != NULL) {
+                        inventoryRemoveFlight(sharedInventory, flightID);
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            printf("Invalid schedule option!\n");
+            break;
+    }
+}
+
+/**
+ * @brief Writes the analytics reports into a directory and prints how long they took.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param directory The output directory.
+ */
+static void writeReports(const Flight *flights, int flightCount, const char *directory) {
+    long long start = nowNanos();
+    if (writeAnalyticsReports(flights, flightCount, globalPassengers, globalPassengerCount,
+                              globalTickets, globalTicketCount, directory, 0)) {
+        printf("Reports for %d flights, %d passengers and %d tickets written to %s in %.3f s.\n",
+               flightCount, globalPassengerCount, globalTicketCount, directory, (nowNanos() - start) / 1e9);
+    }
+}
+
+/**
+ * @brief Saves all data and releases every resource before the program ends.
+ *
+ * @param flights The flight array (freed here).
+ * @param flightCount The number of flights.
+ * @param sharedInventory The attached shared inventory, or NULL.
+ * @param profileFile Where to write the profile if the profiler is running.
+ */
+static void shutdownSystem(Flight *flights, int flightCount, SharedInventory *sharedInventory,
+                           const char *profileFile) {
+    if (stopProfiler()) {
+        writeFoldedStacks(profileFile);
+    }
+    stopSessionRecording();
+    // Save data before exiting
+    if (sharedInventory != NULL) {
+        // Save the segment's flights (with every process's adds, deletes and seats), not this process's copy
+        flightCount = copyInventoryFlights(sharedInventory, flights, MAX_FLIGHTS);
+        detachInventory(sharedInventory);
+    }
+    saveFlights(flights, flightCount, "flights.txt");
+    savePassengers("passengers.txt");
+    if (sharedInventory != NULL) {
+        saveSharedTickets("tickets.txt"); // Other processes save their tickets to the same file
+    } else {
+        saveTickets("tickets.txt");
+    }
+    saveSegmentedFlights("segments.txt");
+    saveSchedulePatterns("schedules.txt");
+
+    // Clean up dynamically allocated memory
+    trackedFree(MEM_FLIGHTS, flights); // Free flights array
+    cleanupPassengers();
+    cleanupTickets();
+    cleanupPageIndexes();
+    cleanupQueryColumns();
+    cleanupFlightIndex();
+    cleanupAvailability();
+    cleanupAggregates();
+    cleanupResultCache();
+    cleanupIDIndexes();
+    cleanupBloomFilters();
+    cleanupJourneys();
+    cleanupSegmentedFlights();
+    cleanupSchedulePatterns();
+}
+
 /**
  * @brief Main function of the Flight Management System.
  *
@@ -37,14 +848,52 @@ static void clearInputBuffer() {
  * interface to the user, and calls appropriate functions based on user input.
  * Handles system cleanup and saves data to files upon exit.
  *
+ * Passing "--shared NAME" joins the shared-memory seat inventory NAME (e.g.,
+ * "/flight_inventory"), creating and publishing it from flights.txt if no
+ * other process has done so yet. Seats are then claimed in the shared segment.
+ * Passing "--profile FILE" starts the sampling profiler at launch; its folded
+ * stacks are written to FILE when the profiler is stopped or the program exits.
+ * Passing "--serve PORT" skips the menu and serves the text protocol (see
+ * service.h) on 127.0.0.1:PORT until a client sends SHUTDOWN.
+ * Passing "--record FILE" records every core operation of the session to FILE
+ * (see session.h) from the moment the data files are loaded.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
  * @return 0 on successful program termination, 1 on initialization failure.
  */
-int main() {
+int main(int argc, char *argv[]) {
     // Dynamically allocated array for flights
     Flight *flights = NULL; // Initialize to NULL for loadFlights
     int flightCount = 0;
     int choice;
 
+    // Optional shared-memory seat inventory
+    SharedInventory shared = { NULL, 0, "" };
+    SharedInventory *sharedInventory = NULL;
+    const char *sharedName = NULL;
+    const char *profileFile = "profile.folded";
+    int servePort = -1;
+    const char *recordFile = "session.rec";
+    int recordAtStart = 0;
+    const char *reportDirectory = NULL;
+
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--shared") == 0) {
+            sharedName = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profileFile = argv[++i];
+            startProfiler(PROFILE_DEFAULT_HZ);
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            servePort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0) {
+            recordFile = argv[++i];
+            recordAtStart = 1;
+        } else if (strcmp(argv[i], "--reports") == 0) {
+            reportDirectory = argv[++i];
+        }
+    }
+
     // Initialize passenger and ticket systems (allocates initial memory)
     if (!initializePassengers() || !initializeTickets()) {
         printf("System initialization failed. Exiting.\n");
@@ -59,6 +908,70 @@ int main() {
     loadFlights(&flights, &flightCount, "flights.txt");
     loadPassengers("passengers.txt");
     loadTickets("tickets.txt");
+    loadSegmentedFlights("segments.txt");
+    loadSchedulePatterns("schedules.txt");
+
+    // addFlight appends in place, so the table needs room for MAX_FLIGHTS entries
+    Flight *table = (Flight *)trackedRealloc(MEM_FLIGHTS, flights, MAX_FLIGHTS * sizeof(Flight));
+    if (table == NULL) {
+        printf("Error: Could not allocate memory for flights. Exiting.\n");
+        trackedFree(MEM_FLIGHTS, flights);
+        cleanupPassengers();
+        cleanupTickets();
+        return 1;
+    }
+    flights = table;
+
+    if (sharedName != NULL) {
+        // Another process may create the segment between the attach and the create: attach again
+        if (attachInventory(&shared, sharedName) ||
+            (!createInventory(&shared, sharedName, MAX_FLIGHTS) && attachInventory(&shared, sharedName))) {
+            sharedInventory = &shared;
+            // The segment is the source of truth: take the flights others added or deleted
+            flightCount = copyInventoryFlights(&shared, flights, MAX_FLIGHTS);
+            flightTableVersion++; // Filled directly, not through insertFlight
+            printf("Attached to shared inventory %s (%d flights).\n", sharedName, flightCount);
+        } else if (shared.base != NULL && publishFlights(&shared, flights, flightCount)) {
+            sharedInventory = &shared;
+            printf("Created shared inventory %s with %d flights.\n", sharedName, flightCount);
+        } else {
+            detachInventory(&shared);
+            printf("Continuing with a local seat inventory.\n");
+        }
+    }
+    bindTicketInventory(&flights, &flightCount, sharedInventory);
+    bindService(&flights, &flightCount);
+    bindFlightIDCheck(scheduleAllowsFlight); // IDs reserved by recurring schedules
+    if (recordAtStart) {
+        startSessionRecording(recordFile, flightCount, globalPassengerCount, globalTicketCount);
+    }
+
+    if (reportDirectory != NULL) {
+        if (sharedInventory != NULL) {
+            syncFlightsFromInventory(sharedInventory, flights, flightCount); // Report live seats
+        }
+        writeReports(flights, flightCount, reportDirectory);
+        shutdownSystem(flights, flightCount, sharedInventory, profileFile);
+        return 0;
+    }
+
+    if (servePort >= 0) {
+        ServerHandle server;
+        if (!startServer(&server, servePort)) {
+            // Nothing was served, so nothing is saved: the files stay as loaded
+            printf("Error: The server did not start; exiting without saving.\n");
+            if (sharedInventory != NULL) {
+                detachInventory(sharedInventory);
+            }
+            return 1;
+        }
+        printf("Serving on 127.0.0.1:%d (send SHUTDOWN to stop).\n", server.port);
+        fflush(stdout); // Flush output
+        waitServer(&server);
+        printf("Server stopped.\n");
+        shutdownSystem(flights, flightCount, sharedInventory, profileFile);
+        return 0;
+    }
 
     while (1) {
         printf("\n========== Flight Management System ==========\n");
@@ -71,6 +984,20 @@ int main() {
         printf("7. Sort Flights by Departure Time\n");
         printf("8. Delete Flight\n");
         printf("9. Search Flight\n");
+        printf("10. Operation Statistics (STATS)\n");
+        printf("11. Dump Trace (trace.json)\n");
+        printf("12. Memory Usage Report (MEM)\n");
+        printf("13. %s Sampling Profiler\n", isProfilerRunning() ? "Stop" : "Start");
+        printf("14. %s Session Recording (%s)\n", isSessionRecording() ? "Stop" : "Start", recordFile);
+        printf("15. Export Data (CSV/JSON)\n");
+        printf("16. Query Flights\n");
+        printf("17. Find Available Flights\n");
+        printf("18. Dashboard (Route/Day Totals)\n");
+        printf("19. Analytics Reports (CSV)\n");
+        printf("20. Top Flights (Next Departures/Fullest/Busiest Routes)\n");
+        printf("21. Plan a Journey (Connections)\n");
+        printf("22. Multi-Stop Flights (Seats by Origin-Destination)\n");
+        printf("23. Recurring Schedules (Patterns)\n");
         printf("0. Exit\n");
         printf("Enter your choice: ");
 
@@ -84,10 +1011,17 @@ int main() {
 
         switch (choice) {
             case 1:
-                addFlight(flights, &flightCount);
+                if (addFlight(flights, &flightCount) && sharedInventory != NULL &&
+                    !inventoryAddFlight(sharedInventory, flights + flightCount - 1)) {
+                    removeFlight(flights, &flightCount, flights[flightCount - 1].flightID); // Keep both in step
+                    printf("The flight was not added to the shared inventory, so it was removed again.\n");
+                }
                 break;
 
             case 2:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Show live seats
+                }
                 listFlights(flights, flightCount);
                 break;
 
@@ -163,7 +1097,9 @@ int main() {
                 }
                 clearInputBuffer(); // Consume newline after scanf
 
-                deleteFlight(flights, &flightCount, flightIDToDelete);
+                if (deleteFlight(flights, &flightCount, flightIDToDelete) && sharedInventory != NULL) {
+                    inventoryRemoveFlight(sharedInventory, flightIDToDelete);
+                }
                 break;
             }
             case 9: { // Case for searching flights
@@ -176,6 +1112,9 @@ int main() {
                 }
                 clearInputBuffer(); // Consume newline after scanf
 
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Show live seats
+                }
                 Flight *foundFlight = searchFlight(flights, flightCount, flightIDToSearch);
                 if (foundFlight != NULL) {
                     printf("\n--- Flight Found ---\n");
@@ -201,17 +1140,116 @@ int main() {
                 }
                 break;
             }
+            case 10:
+                printLatencyStats();
+                break;
+
+            case 11:
+                dumpTrace("trace.json");
+                break;
+
+            case 12: {
+                // Bytes holding records; the rest of each live table is slack capacity
+                long long usedBytes[MEM_SUBSYSTEM_COUNT] = { 0 };
+                usedBytes[MEM_FLIGHTS] = (long long)flightCount * (long long)sizeof(Flight);
+                usedBytes[MEM_PASSENGERS] = (long long)globalPassengerCount * (long long)sizeof(Passenger);
+                usedBytes[MEM_TICKETS] = (long long)globalTicketCount * (long long)sizeof(Ticket);
+                usedBytes[MEM_OTHER] = -1;
+                printMemoryReport(usedBytes);
+                break;
+            }
+
+            case 13:
+                if (isProfilerRunning()) {
+                    stopProfiler();
+                    writeFoldedStacks(profileFile);
+                } else {
+                    startProfiler(PROFILE_DEFAULT_HZ);
+                }
+                break;
+
+            case 14:
+                if (!stopSessionRecording()) {
+                    startSessionRecording(recordFile, flightCount, globalPassengerCount, globalTicketCount);
+                }
+                break;
+
+            case 15: {
+                int formatChoice;
+                printf("Export format (1 = CSV, 2 = JSON): ");
+                if (scanf("%d", &formatChoice) != 1 || (formatChoice != 1 && formatChoice != 2)) {
+                    printf("Invalid input! Please enter 1 or 2.\n");
+                    clearInputBuffer();
+                    break;
+                }
+                clearInputBuffer(); // Consume newline after scanf
+
+                RenderFormat format = formatChoice == 1 ? RENDER_CSV : RENDER_JSON;
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Export live seats
+                }
+                exportTable("flights", format, RENDER_FLIGHTS, flights, flightCount);
+                exportTable("passengers", format, RENDER_PASSENGERS, globalPassengers, globalPassengerCount);
+                exportTable("tickets", format, RENDER_TICKETS, globalTickets, globalTicketCount);
+                break;
+            }
+
+            case 16:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Filter on live seats
+                }
+                queryFlights(flights, flightCount);
+                break;
+
+            case 17:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Search live seats
+                }
+                findAvailable(flights, flightCount);
+                break;
+
+            case 18:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Count live seats
+                }
+                showDashboard(flights, flightCount);
+                break;
+
+            case 19:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Report live seats
+                }
+                writeReports(flights, flightCount, ".");
+                break;
+
+            case 20:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Rank by live seats
+                }
+                showTopFlights(flights, flightCount);
+                break;
+
+            case 21:
+                planJourney(flights, flightCount);
+                break;
+
+            case 22:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Show live seats
+                }
+                manageSegmentedFlights(flights, flightCount);
+                break;
+
+            case 23:
+                if (sharedInventory != NULL) {
+                    syncFlightsFromInventory(sharedInventory, flights, flightCount); // Show live seats
+                }
+                manageSchedules(flights, &flightCount, sharedInventory);
+                break;
+
             case 0:
                 printf("Exiting system. Goodbye!\n");
-                // Save data before exiting
-                saveFlights(flights, flightCount, "flights.txt");
-                savePassengers("passengers.txt");
-                saveTickets("tickets.txt");
-
-                // Clean up dynamically allocated memory
-                free(flights); // Free flights array
-                cleanupPassengers();
-                cleanupTickets();
+                shutdownSystem(flights, flightCount, sharedInventory, profileFile);
                 return 0;
 
             default:
@@ -0,0 +1,230 @@
+/**
+ * @file memstats.c
+ * @brief Implementation of per-subsystem allocation accounting.
+ *
+ * Every tracked block is preceded by a small header holding its requested
+ * size, so frees and reallocs can update the counters without the caller
+ * passing sizes. Counters are updated with relaxed atomics because the
+ * tables may be grown from several threads (e.g., the bench or load tester).
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For malloc, realloc, free
+#include <stddef.h> // For max_align_t
+
+#include "memstats.h"
+
+/**
+ * @struct BlockHeader
+ * @brief Prefix of every tracked block; its alignment keeps the payload maximally aligned.
+ */
+typedef struct {
+    _Alignas(max_align_t) size_t size; /**< Requested size of the payload in bytes. */
+} BlockHeader;
+
+/**
+ * @var memoryCounters
+ * @brief Counters per subsystem, updated atomically.
+ */
+static MemoryUsage memoryCounters[MEM_SUBSYSTEM_COUNT];
+
+/**
+ * @var memSubsystemNames
+ * @brief Display names, indexed by MemSubsystem.
+ */
+static const char *const memSubsystemNames[MEM_SUBSYSTEM_COUNT] = {
+    "flights", "passengers", "tickets", "other"
+};
+
+/**
+ * @brief Adds a delta to a subsystem's live bytes and raises its peak if needed.
+ *
+ * @param c The subsystem's counters.
+ * @param delta The change in live bytes (negative on free or shrink).
+ */
+static void adjustLive(MemoryUsage *c, long long delta) {
+    long long live = __atomic_add_fetch(&c->liveBytes, delta, __ATOMIC_RELAXED);
+    long long peak = __atomic_load_n(&c->peakBytes, __ATOMIC_RELAXED);
+    while (live > peak &&
+           !__atomic_compare_exchange_n(&c->peakBytes, &peak, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // peak was reloaded by the failed exchange
+    }
+}
+
+/**
+ * @brief Maps a subsystem to its counters, folding out-of-range values into MEM_OTHER.
+ *
+ * @param subsystem The subsystem.
+ * @return A pointer to the counters.
+ */
+static MemoryUsage *countersFor(MemSubsystem subsystem) {
+    if (subsystem < 0 || subsystem >= MEM_SUBSYSTEM_COUNT) {
+        subsystem = MEM_OTHER;
+    }
+    return &memoryCounters[subsystem];
+}
+
+/**
+ * @brief Allocates memory charged to a subsystem.
+ *
+ * @param subsystem The owner of the block.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the block, or NULL if the allocation failed.
+ */
+void *trackedMalloc(MemSubsystem subsystem, size_t size) {
+    BlockHeader *h = (BlockHeader *)malloc(sizeof(BlockHeader) + size);
+    if (h == NULL) {
+        return NULL;
+    }
+    h->size = size;
+    MemoryUsage *c = countersFor(subsystem);
+    __atomic_add_fetch(&c->allocations, 1, __ATOMIC_RELAXED);
+    adjustLive(c, (long long)size);
+    return h + 1;
+}
+
+/**
+ * @brief Resizes a block allocated with trackedMalloc or trackedRealloc.
+ *
+ * A realloc that returns a different address is counted as a copy of
+ * min(old, new) bytes, which is what realloc had to move.
+ *
+ * @param subsystem The owner of the block.
+ * @param ptr The block to resize (NULL allocates a new block).
+ * @param size The new size in bytes.
+ * @return A pointer to the resized block, or NULL if the allocation failed.
+ */
+void *trackedRealloc(MemSubsystem subsystem, void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return trackedMalloc(subsystem, size);
+    }
+    BlockHeader *old = (BlockHeader *)ptr - 1;
+    size_t oldSize = old->size;
+    BlockHeader *h = (BlockHeader *)realloc(old, sizeof(BlockHeader) + size);
+    if (h == NULL) {
+        return NULL; // Old block (and its header) untouched
+    }
+    h->size = size;
+
+    MemoryUsage *c = countersFor(subsystem);
+    __atomic_add_fetch(&c->reallocs, 1, __ATOMIC_RELAXED);
+    if (h != old) {
+        __atomic_add_fetch(&c->reallocCopies, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&c->copiedBytes, (long long)(oldSize < size ? oldSize : size), __ATOMIC_RELAXED);
+    }
+    adjustLive(c, (long long)size - (long long)oldSize);
+    return h + 1;
+}
+
+/**
+ * @brief Frees a block allocated with trackedMalloc or trackedRealloc.
+ *
+ * @param subsystem The owner of the block.
+ * @param ptr The block to free (NULL is ignored).
+ */
+void trackedFree(MemSubsystem subsystem, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    BlockHeader *h = (BlockHeader *)ptr - 1;
+    MemoryUsage *c = countersFor(subsystem);
+    __atomic_add_fetch(&c->frees, 1, __ATOMIC_RELAXED);
+    adjustLive(c, -(long long)h->size);
+    free(h);
+}
+
+/**
+ * @brief Reads a subsystem's counters.
+ *
+ * @param subsystem The subsystem.
+ * @param usage Receives the counters.
+ * @return 1 on success, 0 if the subsystem is out of range.
+ */
+int summarizeMemory(MemSubsystem subsystem, MemoryUsage *usage) {
+    if (subsystem < 0 || subsystem >= MEM_SUBSYSTEM_COUNT) {
+        return 0;
+    }
+    const MemoryUsage *c = &memoryCounters[subsystem];
+    usage->liveBytes = __atomic_load_n(&c->liveBytes, __ATOMIC_RELAXED);
+    usage->peakBytes = __atomic_load_n(&c->peakBytes, __ATOMIC_RELAXED);
+    usage->allocations = __atomic_load_n(&c->allocations, __ATOMIC_RELAXED);
+    usage->frees = __atomic_load_n(&c->frees, __ATOMIC_RELAXED);
+    usage->reallocs = __atomic_load_n(&c->reallocs, __ATOMIC_RELAXED);
+    usage->reallocCopies = __atomic_load_n(&c->reallocCopies, __ATOMIC_RELAXED);
+    usage->copiedBytes = __atomic_load_n(&c->copiedBytes, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/**
+ * @brief Returns the display name of a subsystem.
+ *
+ * @param subsystem The subsystem.
+ * @return A constant string such as "flights".
+ */
+const char *memSubsystemName(MemSubsystem subsystem) {
+    if (subsystem < 0 || subsystem >= MEM_SUBSYSTEM_COUNT) {
+        return "unknown";
+    }
+    return memSubsystemNames[subsystem];
+}
+
+/**
+ * @brief Formats a byte count with a readable unit (B, KiB, MiB or GiB).
+ *
+ * @param bytes The byte count.
+ * @param out Receives the text.
+ * @param size The size of out.
+ */
+static void formatBytes(long long bytes, char *out, size_t size) {
+    if (bytes < 0) {
+        snprintf(out, size, "-");
+    } else if (bytes < 1024) {
+        snprintf(out, size, "%lldB", bytes);
+    } else if (bytes < 1024LL * 1024) {
+        snprintf(out, size, "%.1fKiB", bytes / 1024.0);
+    } else if (bytes < 1024LL * 1024 * 1024) {
+        snprintf(out, size, "%.1fMiB", bytes / (1024.0 * 1024));
+    } else {
+        snprintf(out, size, "%.2fGiB", bytes / (1024.0 * 1024 * 1024));
+    }
+}
+
+/**
+ * @brief Prints live, used, slack and peak bytes plus allocation counts for every subsystem.
+ *
+ * @param usedBytes Bytes actually holding records, indexed by MemSubsystem; a negative
+ * entry (or a NULL array) means unknown and no slack is shown.
+ * @return 1 on success.
+ */
+int printMemoryReport(const long long *usedBytes) {
+    printf("\n---- Memory Usage by Subsystem ----\n");
+    printf("%-11s %10s %10s %10s %10s %8s %8s %8s %8s %10s\n",
+           "Subsystem", "Live", "Used", "Slack", "Peak", "Allocs", "Frees", "Reallocs", "Copies", "Copied");
+    long long totalLive = 0, totalPeak = 0;
+    for (int s = 0; s < MEM_SUBSYSTEM_COUNT; s++) {
+        MemoryUsage u;
+        summarizeMemory((MemSubsystem)s, &u);
+        long long used = usedBytes != NULL ? usedBytes[s] : -1;
+        long long slack = used >= 0 && u.liveBytes >= used ? u.liveBytes - used : -1;
+
+        char live[24], usedText[24], slackText[24], peak[24], copied[24];
+        formatBytes(u.liveBytes, live, sizeof(live));
+        formatBytes(used, usedText, sizeof(usedText));
+        formatBytes(slack, slackText, sizeof(slackText));
+        formatBytes(u.peakBytes, peak, sizeof(peak));
+        formatBytes(u.copiedBytes, copied, sizeof(copied));
+        printf("%-11s %10s %10s %10s %10s %8lld %8lld %8lld %8lld %10s\n",
+               memSubsystemName((MemSubsystem)s), live, usedText, slackText, peak,
+               u.allocations, u.frees, u.reallocs, u.reallocCopies, copied);
+        totalLive += u.liveBytes;
+        totalPeak += u.peakBytes;
+    }
+    char live[24], peak[24];
+    formatBytes(totalLive, live, sizeof(live));
+    formatBytes(totalPeak, peak, sizeof(peak));
+    printf("Total live %s (sum of per-subsystem peaks %s); each block also carries a %d-byte header.\n",
+           live, peak, (int)sizeof(BlockHeader));
+    fflush(stdout); // Flush output
+    return 1;
+}
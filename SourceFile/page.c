@@ -0,0 +1,636 @@
+/**
+ * @file page.c
+ * @brief Implementation of cursor (keyset) pagination.
+ *
+ * Every paged order keeps a PageIndex: the table's records as (key, position)
+ * entries sorted by key. The index remembers which table, record count and
+ * table version it matches. Single inserts and removals update it through
+ * hooks (a binary search and one memmove, plus renumbering the positions
+ * behind a removed record), like the flight index and the aggregate views;
+ * it is rebuilt only when it is out of sync, e.g. after a load or a sort.
+ * A page is a binary search for the first entry after the cursor followed by
+ * a copy of up to limit positions.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For qsort, strtoll
+#include <string.h>
+#include <pthread.h>
+
+#include "page.h"
+#include "flight.h"
+#include "passenger.h"
+#include "ticket.h"
+#include "memstats.h"
+
+/**
+ * @struct PageEntry
+ * @brief One record of a sorted index.
+ */
+typedef struct {
+    long long key;      /**< Flight or ticket ID, or departure key (unused for passengers). */
+    int flightID;       /**< Flight ID breaking ties between equal departures. */
+    int position;       /**< Position of the record in its table. */
+} PageEntry;
+
+/**
+ * @struct PageIndex
+ * @brief A sorted index and the table state it was built for.
+ */
+typedef struct {
+    PageEntry *entries;     /**< Entries in key order. */
+    int capacity;           /**< Allocated entries. */
+    int count;              /**< Entries in use (the table's record count when built). */
+    const void *table;      /**< Table the index was built over. */
+    unsigned long version;  /**< Table version the index was built for. */
+    int built;              /**< 1 once the index has been built. */
+} PageIndex;
+
+static PageIndex flightIndexes[2];  /**< Flight indexes by PageOrder. */
+static PageIndex passengerIndex;    /**< Passengers by passport. */
+static PageIndex ticketIndex;       /**< Tickets by ticket ID. */
+static pthread_mutex_t pageLock = PTHREAD_MUTEX_INITIALIZER; /**< Serializes index updates, rebuilds and searches. */
+
+/**
+ * @brief Positions a cursor before the first record.
+ *
+ * @param cursor The cursor.
+ */
+void initPageCursor(PageCursor *cursor) {
+    memset(cursor, 0, sizeof(*cursor));
+}
+
+/**
+ * @brief Positions a cursor after a known key, e.g. "after flight ID 1200".
+ *
+ * @param cursor The cursor.
+ * @param key A flight or ticket ID, or a departure key (see departureKey).
+ * @param flightID For PAGE_BY_DEPARTURE, the flight ID of the last flight seen; ignored otherwise.
+ */
+void pageCursorAfter(PageCursor *cursor, long long key, int flightID) {
+    initPageCursor(cursor);
+    cursor->started = 1;
+    cursor->key = key;
+    cursor->flightID = flightID;
+}
+
+/**
+ * @brief Returns the sort key of a departure time: the decimal number YYYYMMDDHHMM.
+ *
+ * @param dateTime The date and time.
+ * @return The key (e.g., 202503071405 for 07-03-2025 14:05).
+ */
+long long departureKey(const DateTime *dateTime) {
+    return (long long)dateTime->year * 100000000LL + (long long)dateTime->month * 1000000LL +
+           (long long)dateTime->day * 10000LL + (long long)dateTime->hour * 100LL + dateTime->minute;
+}
+
+/**
+ * @brief Compares two entries by key, then by flight ID.
+ *
+ * @param a A pointer to the first PageEntry.
+ * @param b A pointer to the second PageEntry.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareEntries(const void *a, const void *b) {
+    const PageEntry *x = (const PageEntry *)a;
+    const PageEntry *y = (const PageEntry *)b;
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return (x->flightID > y->flightID) - (x->flightID < y->flightID);
+}
+
+/**
+ * @brief Compares two passenger entries by passport.
+ *
+ * @param a A pointer to the first PageEntry.
+ * @param b A pointer to the second PageEntry.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int comparePassengerEntries(const void *a, const void *b) {
+    const PageEntry *x = (const PageEntry *)a;
+    const PageEntry *y = (const PageEntry *)b;
+    return strncmp(globalPassengers[x->position].passport, globalPassengers[y->position].passport,
+                   sizeof(globalPassengers->passport));
+}
+
+/**
+ * @brief Reports whether an index needs rebuilding for the given table state.
+ *
+ * @param index The index.
+ * @param table The table.
+ * @param count The table's record count.
+ * @param version The table's version.
+ * @return 1 if stale, 0 if current.
+ */
+static int isStale(const PageIndex *index, const void *table, int count, unsigned long version) {
+    return !index->built || index->table != table || index->count != count || index->version != version;
+}
+
+/**
+ * @brief Grows an index to hold count entries and records the table state.
+ *
+ * @param index The index.
+ * @param table The table.
+ * @param count The table's record count.
+ * @param version The table's version.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int prepareIndex(PageIndex *index, const void *table, int count, unsigned long version) {
+    if (count > index->capacity) {
+        PageEntry *entries = (PageEntry *)trackedRealloc(MEM_OTHER, index->entries, (size_t)count * sizeof(PageEntry));
+        if (entries == NULL) {
+            printf("Error: Could not allocate memory for the page index.\n");
+            index->built = 0;
+            return 0;
+        }
+        index->entries = entries;
+        index->capacity = count;
+    }
+    index->table = table;
+    index->count = count;
+    index->version = version;
+    index->built = 1;
+    return 1;
+}
+
+/**
+ * @brief Sorts an index unless it is already in order.
+ *
+ * Tables are usually loaded and appended in key order (ticket IDs always are),
+ * so one linear check often saves the sort.
+ *
+ * @param index The index.
+ * @param compare The entry comparison.
+ */
+static void sortIndex(PageIndex *index, int (*compare)(const void *, const void *)) {
+    for (int i = 1; i < index->count; i++) {
+        if (compare(index->entries + i - 1, index->entries + i) > 0) {
+            qsort(index->entries, (size_t)index->count, sizeof(PageEntry), compare);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Reports whether an index matches a table as of the current version, before one change.
+ *
+ * @param index The index.
+ * @param count The record count the index must have.
+ * @param version The table's version before the change.
+ * @return 1 if a hook may update the index, 0 if it is rebuilt on the next page anyway.
+ */
+static int isCurrent(const PageIndex *index, int count, unsigned long version) {
+    return index->built && index->count == count && index->version == version;
+}
+
+/**
+ * @brief Finds where an entry sorts: the first entry not before it.
+ *
+ * @param index The index.
+ * @param entry The entry.
+ * @param compare The entry comparison.
+ * @return The position in the index (count if every entry sorts before it).
+ */
+static int lowerBound(const PageIndex *index, const PageEntry *entry, int (*compare)(const void *, const void *)) {
+    int low = 0, high = index->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (compare(index->entries + mid, entry) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Inserts an entry for a record appended to the table, keeping the key order.
+ *
+ * @param index The index (must be current).
+ * @param entry The new entry.
+ * @param compare The entry comparison.
+ * @param version The table's version before the append.
+ */
+static void insertEntry(PageIndex *index, const PageEntry *entry, int (*compare)(const void *, const void *),
+                        unsigned long version) {
+    if (index->count == index->capacity) {
+        int capacity = index->capacity > 0 ? index->capacity * 2 : 16;
+        PageEntry *entries = (PageEntry *)trackedRealloc(MEM_OTHER, index->entries, (size_t)capacity * sizeof(PageEntry));
+        if (entries == NULL) {
+            index->built = 0; // Rebuilt (or reported) on the next page
+            return;
+        }
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+    int at = lowerBound(index, entry, compare);
+    memmove(index->entries + at + 1, index->entries + at, (size_t)(index->count - at) * sizeof(PageEntry));
+    index->entries[at] = *entry;
+    index->count++;
+    index->version = version + 1;
+}
+
+/**
+ * @brief Removes the entry of a record about to be removed from the table.
+ *
+ * The table shifts every later record down by one, so their positions are
+ * renumbered here as well.
+ *
+ * @param index The index (must be current).
+ * @param entry The removed record's entry (key, flight ID and position).
+ * @param compare The entry comparison.
+ * @param version The table's version before the removal.
+ */
+static void removeEntry(PageIndex *index, const PageEntry *entry, int (*compare)(const void *, const void *),
+                        unsigned long version) {
+    int at = lowerBound(index, entry, compare);
+    while (at < index->count && index->entries[at].position != entry->position &&
+           compare(index->entries + at, entry) == 0) {
+        at++; // Equal keys (e.g., duplicates in a loaded file)
+    }
+    if (at == index->count || index->entries[at].position != entry->position) {
+        index->built = 0; // Not where it should be: rebuild on the next page
+        return;
+    }
+    memmove(index->entries + at, index->entries + at + 1, (size_t)(index->count - at - 1) * sizeof(PageEntry));
+    index->count--;
+    for (int i = 0; i < index->count; i++) {
+        if (index->entries[i].position > entry->position) {
+            index->entries[i].position--;
+        }
+    }
+    index->version = version + 1;
+}
+
+/**
+ * @brief Fills the entry of a flight for one of the flight orders.
+ *
+ * @param flight The flight.
+ * @param position Its position in the table.
+ * @param order The order.
+ * @param entry Receives the entry.
+ */
+static void flightEntry(const Flight *flight, int position, PageOrder order, PageEntry *entry) {
+    entry->key = order == PAGE_BY_DEPARTURE ? departureKey(&flight->departure) : flight->flightID;
+    entry->flightID = flight->flightID;
+    entry->position = position;
+}
+
+/**
+ * @brief Finds the first entry after a key.
+ *
+ * @param index The index.
+ * @param key The key of the last record seen.
+ * @param flightID The flight ID of the last record seen (compared only if useFlightID).
+ * @param useFlightID 1 to break key ties by flight ID, 0 if keys are unique.
+ * @return The position in the index of the first later entry (count if none).
+ */
+static int firstAfterKey(const PageIndex *index, long long key, int flightID, int useFlightID) {
+    int low = 0, high = index->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        const PageEntry *e = index->entries + mid;
+        int after = e->key > key || (e->key == key && useFlightID && e->flightID > flightID);
+        if (after) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Finds the first passenger entry whose passport sorts after a passport.
+ *
+ * @param index The passenger index.
+ * @param passport The passport of the last passenger seen.
+ * @return The position in the index of the first later entry (count if none).
+ */
+static int firstAfterPassport(const PageIndex *index, const char *passport) {
+    int low = 0, high = index->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        const char *p = globalPassengers[index->entries[mid].position].passport;
+        if (strncmp(p, passport, sizeof(globalPassengers->passport)) > 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief Copies up to limit positions starting at an index position and marks the cursor done at the end.
+ *
+ * @param index The index.
+ * @param from The first index position to return.
+ * @param limit The maximum number of positions.
+ * @param cursor The cursor (done is set if the end is reached).
+ * @param indexes Receives the table positions.
+ * @return The number of positions copied.
+ */
+static int copyPage(const PageIndex *index, int from, int limit, PageCursor *cursor, int *indexes) {
+    if (limit > PAGE_MAX_LIMIT) {
+        limit = PAGE_MAX_LIMIT;
+    }
+    int returned = 0;
+    while (returned < limit && from + returned < index->count) {
+        indexes[returned] = index->entries[from + returned].position;
+        returned++;
+    }
+    if (from + returned >= index->count) {
+        cursor->done = 1;
+    }
+    return returned;
+}
+
+/**
+ * @brief Returns the next page of flights.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param order The sort order (must stay the same for every page of a cursor).
+ * @param cursor Where the page starts; advanced past the returned flights.
+ * @param limit The maximum number of flights (capped at PAGE_MAX_LIMIT).
+ * @param indexes Receives the array positions of the returned flights, in order.
+ * @return The number of flights returned (0 at the end), or -1 if the index could not be allocated.
+ */
+int pageFlights(const Flight *flights, int flightCount, PageOrder order, PageCursor *cursor, int limit, int *indexes) {
+    if (cursor->done || limit <= 0) {
+        return 0;
+    }
+    PageIndex *index = flightIndexes + (order == PAGE_BY_DEPARTURE ? 1 : 0);
+    pthread_mutex_lock(&pageLock);
+    if (isStale(index, flights, flightCount, flightTableVersion)) {
+        if (!prepareIndex(index, flights, flightCount, flightTableVersion)) {
+            pthread_mutex_unlock(&pageLock);
+            return -1;
+        }
+        for (int i = 0; i < flightCount; i++) {
+            flightEntry(flights + i, i, order, index->entries + i);
+        }
+        sortIndex(index, compareEntries);
+    }
+    int from = cursor->started ? firstAfterKey(index, cursor->key, cursor->flightID, order == PAGE_BY_DEPARTURE) : 0;
+    int returned = copyPage(index, from, limit, cursor, indexes);
+    if (returned > 0) {
+        const PageEntry *last = index->entries + from + returned - 1;
+        cursor->started = 1;
+        cursor->key = last->key;
+        cursor->flightID = last->flightID;
+    }
+    pthread_mutex_unlock(&pageLock);
+    return returned;
+}
+
+/**
+ * @brief Returns the next page of passengers in passport order.
+ *
+ * @param cursor Where the page starts; advanced past the returned passengers.
+ * @param limit The maximum number of passengers (capped at PAGE_MAX_LIMIT).
+ * @param indexes Receives the positions in globalPassengers, in order.
+ * @return The number of passengers returned (0 at the end), or -1 if the index could not be allocated.
+ */
+int pagePassengers(PageCursor *cursor, int limit, int *indexes) {
+    if (cursor->done || limit <= 0) {
+        return 0;
+    }
+    PageIndex *index = &passengerIndex;
+    pthread_mutex_lock(&pageLock);
+    if (isStale(index, globalPassengers, globalPassengerCount, passengerTableVersion)) {
+        if (!prepareIndex(index, globalPassengers, globalPassengerCount, passengerTableVersion)) {
+            pthread_mutex_unlock(&pageLock);
+            return -1;
+        }
+        for (int i = 0; i < globalPassengerCount; i++) {
+            index->entries[i].key = 0;
+            index->entries[i].flightID = 0;
+            index->entries[i].position = i;
+        }
+        sortIndex(index, comparePassengerEntries);
+    }
+    int from = cursor->started ? firstAfterPassport(index, cursor->passport) : 0;
+    int returned = copyPage(index, from, limit, cursor, indexes);
+    if (returned > 0) {
+        const Passenger *last = globalPassengers + index->entries[from + returned - 1].position;
+        cursor->started = 1;
+        memcpy(cursor->passport, last->passport, sizeof(cursor->passport));
+    }
+    pthread_mutex_unlock(&pageLock);
+    return returned;
+}
+
+/**
+ * @brief Returns the next page of tickets in ticket ID order.
+ *
+ * @param cursor Where the page starts; advanced past the returned tickets.
+ * @param limit The maximum number of tickets (capped at PAGE_MAX_LIMIT).
+ * @param indexes Receives the positions in globalTickets, in order.
+ * @return The number of tickets returned (0 at the end), or -1 if the index could not be allocated.
+ */
+int pageTickets(PageCursor *cursor, int limit, int *indexes) {
+    if (cursor->done || limit <= 0) {
+        return 0;
+    }
+    PageIndex *index = &ticketIndex;
+    pthread_mutex_lock(&pageLock);
+    if (isStale(index, globalTickets, globalTicketCount, ticketTableVersion)) {
+        if (!prepareIndex(index, globalTickets, globalTicketCount, ticketTableVersion)) {
+            pthread_mutex_unlock(&pageLock);
+            return -1;
+        }
+        for (int i = 0; i < globalTicketCount; i++) {
+            index->entries[i].key = globalTickets[i].ticketID;
+            index->entries[i].flightID = 0;
+            index->entries[i].position = i;
+        }
+        sortIndex(index, compareEntries);
+    }
+    int from = cursor->started ? firstAfterKey(index, cursor->key, 0, 0) : 0;
+    int returned = copyPage(index, from, limit, cursor, indexes);
+    if (returned > 0) {
+        cursor->started = 1;
+        cursor->key = index->entries[from + returned - 1].key;
+    }
+    pthread_mutex_unlock(&pageLock);
+    return returned;
+}
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights, including the new one.
+ * @param flight The new flight.
+ */
+void pageFlightInserted(const Flight *flights, int flightCount, const Flight *flight) {
+    pthread_mutex_lock(&pageLock);
+    for (int order = PAGE_BY_ID; order <= PAGE_BY_DEPARTURE; order++) {
+        PageIndex *index = flightIndexes + order;
+        if (index->table == flights && isCurrent(index, flightCount - 1, flightTableVersion)) {
+            PageEntry entry;
+            flightEntry(flight, (int)(flight - flights), (PageOrder)order, &entry);
+            insertEntry(index, &entry, compareEntries, flightTableVersion);
+        }
+    }
+    pthread_mutex_unlock(&pageLock);
+}
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights once it is removed.
+ * @param flight The flight being removed (still in the array).
+ */
+void pageFlightRemoved(const Flight *flights, int flightCount, const Flight *flight) {
+    pthread_mutex_lock(&pageLock);
+    for (int order = PAGE_BY_ID; order <= PAGE_BY_DEPARTURE; order++) {
+        PageIndex *index = flightIndexes + order;
+        if (index->table == flights && isCurrent(index, flightCount + 1, flightTableVersion)) {
+            PageEntry entry;
+            flightEntry(flight, (int)(flight - flights), (PageOrder)order, &entry);
+            removeEntry(index, &entry, compareEntries, flightTableVersion);
+        }
+    }
+    pthread_mutex_unlock(&pageLock);
+}
+
+/**
+ * @brief Hook: a passenger was appended. Call before incrementing passengerTableVersion.
+ */
+void pagePassengerAdded() {
+    pthread_mutex_lock(&pageLock);
+    if (isCurrent(&passengerIndex, globalPassengerCount - 1, passengerTableVersion)) {
+        PageEntry entry = { 0, 0, globalPassengerCount - 1 };
+        passengerIndex.table = globalPassengers; // Positions survive a reallocation of the table
+        insertEntry(&passengerIndex, &entry, comparePassengerEntries, passengerTableVersion);
+    }
+    pthread_mutex_unlock(&pageLock);
+}
+
+/**
+ * @brief Hook: a passenger is being removed. Call before shifting the table and incrementing passengerTableVersion.
+ *
+ * @param position The position of the passenger (still in the table).
+ */
+void pagePassengerRemoved(int position) {
+    pthread_mutex_lock(&pageLock);
+    if (passengerIndex.table == globalPassengers &&
+        isCurrent(&passengerIndex, globalPassengerCount, passengerTableVersion)) {
+        PageEntry entry = { 0, 0, position };
+        removeEntry(&passengerIndex, &entry, comparePassengerEntries, passengerTableVersion);
+    }
+    pthread_mutex_unlock(&pageLock);
+}
+
+/**
+ * @brief Hook: a ticket was appended. Call before incrementing ticketTableVersion.
+ */
+void pageTicketAdded() {
+    pthread_mutex_lock(&pageLock);
+    if (isCurrent(&ticketIndex, globalTicketCount - 1, ticketTableVersion)) {
+        PageEntry entry = { globalTickets[globalTicketCount - 1].ticketID, 0, globalTicketCount - 1 };
+        ticketIndex.table = globalTickets; // Positions survive a reallocation of the table
+        insertEntry(&ticketIndex, &entry, compareEntries, ticketTableVersion);
+    }
+    pthread_mutex_unlock(&pageLock);
+}
+
+/**
+ * @brief Hook: a ticket is being removed. Call before shifting the table and incrementing ticketTableVersion.
+ *
+ * @param position The position of the ticket (still in the table).
+ */
+void pageTicketRemoved(int position) {
+    pthread_mutex_lock(&pageLock);
+    if (ticketIndex.table == globalTickets && isCurrent(&ticketIndex, globalTicketCount, ticketTableVersion)) {
+        PageEntry entry = { globalTickets[position].ticketID, 0, position };
+        removeEntry(&ticketIndex, &entry, compareEntries, ticketTableVersion);
+    }
+    pthread_mutex_unlock(&pageLock);
+}
+
+/**
+ * @brief Formats a flight cursor as a token for a client to send back.
+ *
+ * Tokens are "-" (start), "<flightID>" (PAGE_BY_ID) or
+ * "<departureKey>.<flightID>" (PAGE_BY_DEPARTURE); "end" once done.
+ *
+ * @param cursor The cursor.
+ * @param order The order it pages in.
+ * @param text Receives the token.
+ * @param size The size of text (PAGE_CURSOR_TEXT_SIZE is always enough).
+ */
+void formatPageCursor(const PageCursor *cursor, PageOrder order, char *text, size_t size) {
+    if (cursor->done) {
+        snprintf(text, size, "end");
+    } else if (!cursor->started) {
+        snprintf(text, size, "-");
+    } else if (order == PAGE_BY_DEPARTURE) {
+        snprintf(text, size, "%lld.%d", cursor->key, cursor->flightID);
+    } else {
+        snprintf(text, size, "%lld", cursor->key);
+    }
+}
+
+/**
+ * @brief Parses a token written by formatPageCursor.
+ *
+ * @param text The token.
+ * @param order The order it pages in.
+ * @param cursor Receives the cursor.
+ * @return 1 on success, 0 if the token is malformed.
+ */
+int parsePageCursor(const char *text, PageOrder order, PageCursor *cursor) {
+    initPageCursor(cursor);
+    if (strcmp(text, "-") == 0) {
+        return 1;
+    }
+    if (strcmp(text, "end") == 0) {
+        cursor->started = 1;
+        cursor->done = 1;
+        return 1;
+    }
+    char *end;
+    long long key = strtoll(text, &end, 10);
+    if (end == text) {
+        return 0;
+    }
+    int flightID = 0;
+    if (order == PAGE_BY_DEPARTURE) {
+        char *idEnd;
+        if (*end != '.') {
+            return 0;
+        }
+        flightID = (int)strtol(end + 1, &idEnd, 10);
+        if (idEnd == end + 1) {
+            return 0;
+        }
+        end = idEnd;
+    }
+    if (*end != '\0') {
+        return 0;
+    }
+    pageCursorAfter(cursor, key, flightID);
+    return 1;
+}
+
+/**
+ * @brief Frees the pagination indexes.
+ */
+void cleanupPageIndexes() {
+    pthread_mutex_lock(&pageLock);
+    PageIndex *indexes[] = { flightIndexes, flightIndexes + 1, &passengerIndex, &ticketIndex };
+    for (int i = 0; i < 4; i++) {
+        trackedFree(MEM_OTHER, indexes[i]->entries);
+        memset(indexes[i], 0, sizeof(PageIndex));
+    }
+    pthread_mutex_unlock(&pageLock);
+}
@@ -10,10 +10,18 @@
 
 #include "common.h" // MUST BE FIRST for shared macros/definitions
 #include <stdio.h>
-#include <stdlib.h> // For malloc, realloc, free
+#include <stdlib.h> // For atoi
 #include <string.h>
 
 #include "passenger.h"
+#include "stats.h"
+#include "timing.h"
+#include "trace.h"
+#include "memstats.h"
+#include "session.h"
+#include "render.h"
+#include "bloom.h"
+#include "page.h"
 
 /**
  * @brief Clears the input buffer.
@@ -42,6 +50,11 @@ int globalPassengerCount = 0;
  * @brief Maximum capacity of the globalPassengers array before reallocation is needed.
  */
 int globalPassengerCapacity = 0;
+/**
+ * @var passengerTableVersion
+ * @brief Incremented whenever passengers are added, removed or reloaded.
+ */
+unsigned long passengerTableVersion = 0;
 
 /**
  * @brief Initializes the global passenger array by allocating initial memory.
@@ -52,7 +65,7 @@ int globalPassengerCapacity = 0;
  * @return 1 on success, 0 on failure (e.g., memory allocation failed).
  */
 int initializePassengers() {
-    globalPassengers = (Passenger *)malloc(INITIAL_PASSENGER_CAPACITY * sizeof(Passenger));
+    globalPassengers = (Passenger *)trackedMalloc(MEM_PASSENGERS, INITIAL_PASSENGER_CAPACITY * sizeof(Passenger));
     if (globalPassengers == NULL) {
         printf("Error: Could not allocate memory for passengers.\n");
         return 0; // Failure
@@ -63,29 +76,110 @@ int initializePassengers() {
 }
 
 /**
- * @brief Adds a new passenger to the system.
+ * @brief Finds the position of a passenger by passport number.
  *
- * This function prompts the user for passenger details (name, age, passport),
- * validates input, checks for duplicate passport numbers, and dynamically
- * reallocates memory if the passenger list capacity is exceeded.
+ * Unknown passports are usually rejected by the passport filter without a scan.
  *
- * @return 1 on success, 0 on failure (e.g., invalid input, duplicate passport, memory reallocation failed).
+ * @param passport The passport number to look up.
+ * @return The index of the passenger in globalPassengers, or -1 if not found.
  */
-int addPassenger() {
+int findPassengerIndex(const char *passport) {
+    if (!passportMayExist(passport)) {
+        return -1;
+    }
+    for (int i = 0; i < globalPassengerCount; i++) {
+        if (strcmp((globalPassengers + i)->passport, passport) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Appends a passenger after the duplicate check (untimed body of insertPassenger).
+ *
+ * @param passenger A pointer to the passenger to copy into the global array.
+ * @return 1 on success, 0 on failure (e.g., duplicate passport, memory reallocation failed).
+ */
+static int appendPassenger(const Passenger *passenger) {
+    // Corner case: Duplicate check for passport number
+    if (findPassengerIndex(passenger->passport) != -1) {
+        return 0; // Failure
+    }
+
     // Check if reallocation is needed
     if (globalPassengerCount >= globalPassengerCapacity) {
-        int newCapacity = globalPassengerCapacity * 2; // Double the capacity
-        Passenger *temp = (Passenger *)realloc(globalPassengers, newCapacity * sizeof(Passenger));
+        int newCapacity = globalPassengerCapacity > 0 ? globalPassengerCapacity * 2 // Double the capacity
+                                                      : INITIAL_PASSENGER_CAPACITY;
+        Passenger *temp = (Passenger *)trackedRealloc(MEM_PASSENGERS, globalPassengers, newCapacity * sizeof(Passenger));
         if (temp == NULL) {
             printf("Error: Could not reallocate memory for passengers.\n");
             return 0; // Failure
         }
         globalPassengers = temp;
         globalPassengerCapacity = newCapacity;
-        printf("Passenger list capacity increased to %d.\n", globalPassengerCapacity);
     }
 
-    Passenger *p = globalPassengers + globalPassengerCount; // Pointer to new passenger location
+    *(globalPassengers + globalPassengerCount) = *passenger;
+    globalPassengerCount++;
+    bloomPassengerAdded(passenger->passport);
+    pagePassengerAdded();
+    passengerTableVersion++;
+    return 1; // Success
+}
+
+/**
+ * @brief Appends a fully populated passenger without prompting.
+ *
+ * Rejects duplicate passport numbers and doubles the array capacity when it is full.
+ *
+ * @param passenger A pointer to the passenger to copy into the global array.
+ * @return 1 on success, 0 on failure (e.g., duplicate passport, memory reallocation failed).
+ */
+int insertPassenger(const Passenger *passenger) {
+    long long start = nowNanos();
+    int inserted = appendPassenger(passenger);
+    recordLatency(STAT_PASSENGER_ADD, nowNanos() - start);
+    logSessionPassengerAdd(passenger, inserted, start);
+    return inserted;
+}
+
+/**
+ * @brief Removes a passenger by passport number without prompting.
+ *
+ * @param passport The passport number of the passenger to remove.
+ * @return 1 on success, 0 if the passenger was not found.
+ */
+int erasePassenger(const char *passport) {
+    long long start = nowNanos();
+    int foundIndex = findPassengerIndex(passport);
+    if (foundIndex != -1) {
+        pagePassengerRemoved(foundIndex);
+        // Shift elements to fill the gap (using pointer arithmetic)
+        for (int i = foundIndex; i < globalPassengerCount - 1; i++) {
+            *(globalPassengers + i) = *(globalPassengers + i + 1);
+        }
+        globalPassengerCount--;
+        bloomPassengerRemoved();
+        passengerTableVersion++;
+    }
+    recordLatency(STAT_PASSENGER_REMOVE, nowNanos() - start);
+    logSessionPassengerRemove(passport, foundIndex != -1, start);
+    return foundIndex != -1;
+}
+
+/**
+ * @brief Adds a new passenger to the system.
+ *
+ * This function prompts the user for passenger details (name, age, passport),
+ * validates input, checks for duplicate passport numbers, and dynamically
+ * reallocates memory if the passenger list capacity is exceeded.
+ *
+ * @return 1 on success, 0 on failure (e.g., invalid input, duplicate passport, memory reallocation failed).
+ */
+int addPassenger() {
+    Passenger entered;          // Filled from input, then inserted by insertPassenger
+    Passenger *p = &entered;
 
     printf("Enter passenger name: ");
     GET_STRING(p->name, MAX_NAME_LEN);
@@ -102,18 +196,16 @@ int addPassenger() {
     printf("Enter passport number: ");
     GET_STRING(p->passport, sizeof(p->passport));
 
-    // Corner case: Duplicate check for passport number
-    for (int i = 0; i < globalPassengerCount; i++) {
-        if (strcmp((globalPassengers + i)->passport, p->passport) == 0) {
+    p->assignedFlightID = 0; // Initialize, no flight assigned yet
+    p->assignedSeatNo = 0;   // Initialize, no seat assigned yet
+
+    if (!insertPassenger(p)) {
+        if (findPassengerIndex(p->passport) != -1) {
             printf("Error: Passenger with passport number %s already exists!\n", p->passport);
-            return 0; // Failure
         }
+        return 0; // Failure
     }
 
-    p->assignedFlightID = 0; // Initialize, no flight assigned yet
-    p->assignedSeatNo = 0;   // Initialize, no seat assigned yet
-
-    globalPassengerCount++;
     printf("Passenger added successfully. Total passengers: %d\n", globalPassengerCount);
     return 1; // Success
 }
@@ -136,25 +228,11 @@ int removePassenger() {
     printf("Enter passport number of passenger to remove: ");
     GET_STRING(passportToRemove, sizeof(passportToRemove));
 
-    int foundIndex = -1;
-    for (int i = 0; i < globalPassengerCount; i++) {
-        if (strcmp((globalPassengers + i)->passport, passportToRemove) == 0) {
-            foundIndex = i;
-            break;
-        }
-    }
-
-    if (foundIndex == -1) {
+    if (!erasePassenger(passportToRemove)) {
         printf("Passenger with passport number %s not found.\n", passportToRemove);
         return 0; // Failure
     }
 
-    // Shift elements to fill the gap (using pointer arithmetic)
-    for (int i = foundIndex; i < globalPassengerCount - 1; i++) {
-        *(globalPassengers + i) = *(globalPassengers + i + 1);
-    }
-
-    globalPassengerCount--;
     printf("Passenger with passport number %s removed successfully. Total passengers: %d\n",
            passportToRemove, globalPassengerCount);
     return 1; // Success
@@ -174,23 +252,7 @@ int viewPassengers() {
         return 0; // Failure
     }
 
-    printf("\n---- All Registered Passengers ----\n");
-    for (int i = 0; i < globalPassengerCount; i++) {
-        Passenger *p = globalPassengers + i; // Pointer arithmetic
-        printf("Passenger %d:\n", i + 1);
-        printf("  Name       : %s\n", p->name);
-        printf("  Age        : %d\n", p->age);
-        printf("  Passport   : %s\n", p->passport);
-        if (p->assignedFlightID != 0) {
-            printf("  Flight ID  : %d\n", p->assignedFlightID);
-            printf("  Seat No    : %d\n", p->assignedSeatNo);
-        } else {
-            printf("  Flight ID  : Not assigned\n");
-            printf("  Seat No    : Not assigned\n");
-        }
-        printf("----------------------------\n");
-    }
-    return 1; // Success
+    return renderPassengers(stdout, RENDER_PLAIN, globalPassengers, globalPassengerCount);
 }
 
 /**
@@ -200,16 +262,17 @@ int viewPassengers() {
  */
 void cleanupPassengers() {
     if (globalPassengers != NULL) {
-        free(globalPassengers);
+        trackedFree(MEM_PASSENGERS, globalPassengers);
         globalPassengers = NULL;
         globalPassengerCount = 0;
+        passengerTableVersion++;
         globalPassengerCapacity = 0;
         printf("Passenger memory freed.\n");
     }
 }
 
 /**
- * @brief Saves all passenger data to a specified file.
+ * @brief Saves all passenger data to a specified file (untimed body of savePassengers).
  *
  * This function writes the current state of all passengers to a text file.
  * Each passenger's data is written on a new line, with components separated by commas.
@@ -217,7 +280,8 @@ void cleanupPassengers() {
  * @param filename The name of the file to save to.
  * @return 1 on success, 0 on failure (e.g., file cannot be opened).
  */
-int savePassengers(const char *filename) {
+static int writePassengersFile(const char *filename) {
+    TRACE_SCOPE("savePassengers");
     FILE *fp = fopen(filename, "w");
     if (fp == NULL) {
         printf("Error: Could not open file %s for writing.\n", filename);
@@ -239,7 +303,22 @@ int savePassengers(const char *filename) {
 }
 
 /**
- * @brief Loads passenger data from a specified file.
+ * @brief Saves all passenger data to a specified file.
+ *
+ * Records the latency of the whole call under STAT_SAVE_PASSENGERS.
+ *
+ * @param filename The name of the file to save to.
+ * @return 1 on success, 0 on failure (e.g., file cannot be opened).
+ */
+int savePassengers(const char *filename) {
+    long long start = nowNanos();
+    int result = writePassengersFile(filename);
+    recordLatency(STAT_SAVE_PASSENGERS, nowNanos() - start);
+    return result;
+}
+
+/**
+ * @brief Loads passenger data from a specified file (untimed body of loadPassengers).
  *
  * This function reads passenger data from a text file and populates the
  * global passenger array. It reallocates memory as needed. It expects the first
@@ -248,11 +327,13 @@ int savePassengers(const char *filename) {
  * @param filename The name of the file to load from.
  * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
  */
-int loadPassengers(const char *filename) {
+static int readPassengersFile(const char *filename) {
+    TRACE_SCOPE("loadPassengers");
     FILE *fp = fopen(filename, "r");
     if (fp == NULL) {
         printf("No passenger data file found (%s). Starting with empty passenger list.\n", filename);
         globalPassengerCount = 0; // Ensure count is zero if file doesn't exist
+        passengerTableVersion++;
         return 0; // Not a critical failure, just means no data to load
     }
 
@@ -267,10 +348,10 @@ int loadPassengers(const char *filename) {
     // Reallocate memory for passengers if current capacity is insufficient
     // or if it's the first load
     if (globalPassengers != NULL) {
-        free(globalPassengers);
+        trackedFree(MEM_PASSENGERS, globalPassengers);
         globalPassengers = NULL; // Defensive programming
     }
-    globalPassengers = (Passenger *)malloc(loadedCount * sizeof(Passenger));
+    globalPassengers = (Passenger *)trackedMalloc(MEM_PASSENGERS, loadedCount * sizeof(Passenger));
     if (globalPassengers == NULL) {
         printf("Error: Could not allocate memory for loading passengers.\n");
         fclose(fp);
@@ -279,7 +360,9 @@ int loadPassengers(const char *filename) {
     globalPassengerCapacity = loadedCount; // Set capacity to loaded count for now
 
     globalPassengerCount = 0; // Reset count before loading
+    passengerTableVersion++;
 
+    TRACE_BEGIN("loadPassengers.parse");
     char line_buffer[256]; // Buffer to read each line
     while (globalPassengerCount < loadedCount && fgets(line_buffer, sizeof(line_buffer), fp) != NULL) {
         Passenger *p = globalPassengers + globalPassengerCount; // Pointer to current passenger location
@@ -316,8 +399,25 @@ int loadPassengers(const char *filename) {
 
         globalPassengerCount++;
     }
+    TRACE_END("loadPassengers.parse");
+    rebuildPassportFilter();
 
     fclose(fp);
     printf("Loaded %d passengers from %s.\n", globalPassengerCount, filename);
     return 1; // Success
+}
+
+/**
+ * @brief Loads passenger data from a specified file.
+ *
+ * Records the latency of the whole call under STAT_LOAD_PASSENGERS.
+ *
+ * @param filename The name of the file to load from.
+ * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
+ */
+int loadPassengers(const char *filename) {
+    long long start = nowNanos();
+    int result = readPassengersFile(filename);
+    recordLatency(STAT_LOAD_PASSENGERS, nowNanos() - start);
+    return result;
 }
\ No newline at end of file
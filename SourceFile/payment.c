@@ -10,6 +10,7 @@
 #include <string.h> // For strtok if using GET_STRING
 
 #include "payment.h"
+#include "session.h"
 
 /**
  * @brief Clears the input buffer.
@@ -23,6 +24,19 @@ static void clearInputBuffer() {
     while ((c = getchar()) != '\n' && c != EOF);
 }
 
+/**
+ * @brief Processes a payment without prompting.
+ *
+ * @param method The payment method (e.g., "Cash", "Card", "Online"); must not be empty.
+ * @param amount The amount to pay; must be positive.
+ * @return 1 on success, 0 on failure (e.g., empty method, non-positive amount).
+ */
+int processPayment(const char *method, float amount) {
+    int accepted = method != NULL && method[0] != '\0' && amount > 0.0f;
+    logSessionPayment(method, amount, accepted);
+    return accepted;
+}
+
 /**
  * @brief Handles a payment transaction.
  *
@@ -47,6 +61,10 @@ int handlePayment() {
     }
     clearInputBuffer(); // Consume newline after scanf
 
+    if (!processPayment(method, amount)) {
+        printf("Invalid payment method.\n");
+        return 0; // Failure
+    }
     printf("Payment of %.2f via %s completed successfully.\n", amount, method);
     return 1; // Success
 }
\ No newline at end of file
@@ -0,0 +1,257 @@
+/**
+ * @file perfcounters.c
+ * @brief Implementation of hardware performance counters via perf_event_open.
+ *
+ * The group is read with PERF_FORMAT_GROUP so all counts come from one
+ * consistent snapshot. If the kernel had to multiplex the PMU, each count is
+ * scaled by time_enabled / time_running.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>  // For errno, ENOSYS
+
+#if defined(__linux__)
+#include <unistd.h>             // For syscall, read, close
+#include <sys/ioctl.h>          // For ioctl
+#include <sys/syscall.h>        // For SYS_perf_event_open
+#include <linux/perf_event.h>   // For perf_event_attr
+#endif
+
+#include "perfcounters.h"
+
+/**
+ * @var perfCounterNames
+ * @brief Display names, indexed by PerfCounterKind.
+ */
+static const char *const perfCounterNames[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "cache-misses", "branch-misses"
+};
+
+#if defined(__linux__)
+
+/**
+ * @var perfEventConfigs
+ * @brief perf_event_attr.config of each event, indexed by PerfCounterKind.
+ */
+static const unsigned long long perfEventConfigs[PERF_COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/**
+ * @brief Opens one hardware event for the calling thread on any CPU.
+ *
+ * @param config The PERF_COUNT_HW_* event.
+ * @param groupFd The group leader, or -1 to create a new group.
+ * @return The file descriptor, or -1 on failure.
+ */
+static int openEvent(unsigned long long config, int groupFd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = groupFd == -1; // Members follow the leader
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+/**
+ * @brief Opens the counter group for the calling thread, initially disabled.
+ *
+ * @param counters Receives the group.
+ * @return 1 if at least the cycle counter could be opened, 0 otherwise (errno
+ *         is left as perf_event_open set it).
+ */
+int openPerfCounters(PerfCounters *counters) {
+    counters->members = 0;
+    for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+        counters->fds[k] = -1;
+        counters->groupIndex[k] = -1;
+    }
+
+    int leader = openEvent(perfEventConfigs[PERF_CYCLES], -1);
+    if (leader < 0) {
+        return 0;
+    }
+    counters->fds[PERF_CYCLES] = leader;
+    counters->groupIndex[PERF_CYCLES] = counters->members++;
+
+    for (int k = PERF_CYCLES + 1; k < PERF_COUNTER_COUNT; k++) {
+        int fd = openEvent(perfEventConfigs[k], leader);
+        if (fd >= 0) {
+            counters->fds[k] = fd;
+            counters->groupIndex[k] = counters->members++;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Zeroes every counter in the group.
+ *
+ * @param counters The group.
+ */
+void resetPerfCounters(PerfCounters *counters) {
+    if (counters->fds[PERF_CYCLES] >= 0) {
+        ioctl(counters->fds[PERF_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+/**
+ * @brief Starts counting (all events of the group at once).
+ *
+ * @param counters The group.
+ */
+void enablePerfCounters(PerfCounters *counters) {
+    if (counters->fds[PERF_CYCLES] >= 0) {
+        ioctl(counters->fds[PERF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+/**
+ * @brief Stops counting (all events of the group at once).
+ *
+ * @param counters The group.
+ */
+void disablePerfCounters(PerfCounters *counters) {
+    if (counters->fds[PERF_CYCLES] >= 0) {
+        ioctl(counters->fds[PERF_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+/**
+ * @brief Reads the accumulated counts.
+ *
+ * @param counters The group.
+ * @param values Receives the counts.
+ * @return 1 on success, 0 on failure.
+ */
+int readPerfCounters(const PerfCounters *counters, PerfCounterValues *values) {
+    // Layout for PERF_FORMAT_GROUP without IDs: nr, time_enabled, time_running, value[nr]
+    unsigned long long buffer[3 + PERF_COUNTER_COUNT];
+    for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+        values->values[k] = -1;
+    }
+    if (counters->fds[PERF_CYCLES] < 0) {
+        return 0;
+    }
+    ssize_t expected = (ssize_t)((3 + counters->members) * sizeof(unsigned long long));
+    if (read(counters->fds[PERF_CYCLES], buffer, sizeof(buffer)) < expected) {
+        return 0;
+    }
+
+    unsigned long long enabled = buffer[1];
+    unsigned long long running = buffer[2];
+    double scale = (running > 0 && running < enabled) ? (double)enabled / (double)running : 1.0;
+    for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+        if (counters->groupIndex[k] >= 0) {
+            values->values[k] = (long long)((double)buffer[3 + counters->groupIndex[k]] * scale);
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Closes the group.
+ *
+ * @param counters The group.
+ */
+void closePerfCounters(PerfCounters *counters) {
+    for (int k = PERF_COUNTER_COUNT - 1; k >= 0; k--) { // Members before the leader
+        if (counters->fds[k] >= 0) {
+            close(counters->fds[k]);
+            counters->fds[k] = -1;
+        }
+        counters->groupIndex[k] = -1;
+    }
+    counters->members = 0;
+}
+
+#else // !__linux__
+
+/**
+ * @brief Opens the counter group (unsupported outside Linux).
+ *
+ * @param counters Receives an empty group.
+ * @return 0 always (with errno set to ENOSYS).
+ */
+int openPerfCounters(PerfCounters *counters) {
+    for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+        counters->fds[k] = -1;
+        counters->groupIndex[k] = -1;
+    }
+    counters->members = 0;
+    errno = ENOSYS;
+    return 0;
+}
+
+/**
+ * @brief Zeroes the counters (no-op outside Linux).
+ *
+ * @param counters Unused.
+ */
+void resetPerfCounters(PerfCounters *counters) {
+    (void)counters;
+}
+
+/**
+ * @brief Starts counting (no-op outside Linux).
+ *
+ * @param counters Unused.
+ */
+void enablePerfCounters(PerfCounters *counters) {
+    (void)counters;
+}
+
+/**
+ * @brief Stops counting (no-op outside Linux).
+ *
+ * @param counters Unused.
+ */
+void disablePerfCounters(PerfCounters *counters) {
+    (void)counters;
+}
+
+/**
+ * @brief Reads counts (none outside Linux).
+ *
+ * @param counters Unused.
+ * @param values Receives -1 for every event.
+ * @return 0 always.
+ */
+int readPerfCounters(const PerfCounters *counters, PerfCounterValues *values) {
+    (void)counters;
+    for (int k = 0; k < PERF_COUNTER_COUNT; k++) {
+        values->values[k] = -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Closes the group (no-op outside Linux).
+ *
+ * @param counters Unused.
+ */
+void closePerfCounters(PerfCounters *counters) {
+    (void)counters;
+}
+
+#endif // __linux__
+
+/**
+ * @brief Returns the display name of an event.
+ *
+ * @param kind The event.
+ * @return A constant string such as "cycles".
+ */
+const char *perfCounterName(PerfCounterKind kind) {
+    if (kind < 0 || kind >= PERF_COUNTER_COUNT) {
+        return "unknown";
+    }
+    return perfCounterNames[kind];
+}
@@ -0,0 +1,445 @@
+/**
+ * @file profiler.c
+ * @brief Implementation of the built-in SIGPROF sampling profiler.
+ *
+ * The signal handler is async-signal-safe: it reserves a slot in the sample
+ * buffer with one atomic fetch-and-add, copies the interrupted program
+ * counter and the return addresses found by following saved frame pointers,
+ * then publishes the slot with a release store. Frame pointers are only
+ * followed inside the stack bounds of threads registered with
+ * profilerRegisterThread (the thread that starts the profiler is registered
+ * automatically); other threads contribute their leaf frame only, so a bad
+ * frame pointer can never make the handler read unmapped memory.
+ * Symbolization happens later, outside the handler, in writeFoldedStacks.
+ */
+
+#define _GNU_SOURCE // For REG_RIP/REG_RBP, pthread_getattr_np and dladdr; must precede all system headers
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For calloc, malloc, free, qsort
+#include <string.h>
+#include <stdint.h> // For uintptr_t
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <signal.h>   // For sigaction
+#include <sys/time.h> // For setitimer
+#include <ucontext.h> // For ucontext_t
+#include <dlfcn.h>    // For dladdr
+#include <pthread.h>  // For pthread_getattr_np
+#endif
+
+#include "profiler.h"
+
+#if !defined(_WIN32)
+
+/**
+ * @struct ProfileSample
+ * @brief One captured stack, leaf frame first.
+ */
+typedef struct {
+    int ready;                          /**< Set (with release ordering) once the slot is filled. */
+    int depth;                          /**< Number of valid frames. */
+    void *frames[PROFILE_MAX_DEPTH];    /**< Program counters, leaf first. */
+} ProfileSample;
+
+static ProfileSample *samples = NULL;           /**< Preallocated sample buffer (PROFILE_MAX_SAMPLES slots). */
+static unsigned long long nextSlot = 0;         /**< Slots reserved so far; may exceed the capacity. */
+static unsigned long long droppedSamples = 0;   /**< Samples lost because the buffer was full. */
+static int profilerRunning = 0;                 /**< 1 while the timer is armed. */
+static int handlerInstalled = 0;                /**< The handler stays installed once set, see stopProfiler. */
+
+static _Thread_local uintptr_t stackLow = 0;    /**< Lowest address of the calling thread's stack (0 if unregistered). */
+static _Thread_local uintptr_t stackHigh = 0;   /**< One past the highest address of the calling thread's stack. */
+
+/**
+ * @brief Records the calling thread's stack bounds so samples taken on it include full stacks.
+ *
+ * @return 1 on success, 0 if the bounds could not be determined.
+ */
+int profilerRegisterThread() {
+    pthread_attr_t attr;
+    void *base = NULL;
+    size_t size = 0;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return 0;
+    }
+    int ok = pthread_attr_getstack(&attr, &base, &size) == 0;
+    pthread_attr_destroy(&attr);
+    if (!ok) {
+        return 0;
+    }
+    stackLow = (uintptr_t)base;
+    stackHigh = (uintptr_t)base + size;
+    return 1;
+}
+
+/**
+ * @brief Captures the interrupted stack from a signal context by following frame pointers.
+ *
+ * @param uc The interrupted context.
+ * @param frames Receives program counters, leaf first.
+ * @param maxDepth The capacity of frames.
+ * @return The number of frames captured.
+ */
+static int captureStack(const ucontext_t *uc, void **frames, int maxDepth) {
+    uintptr_t pc, fp, sp;
+#if defined(__x86_64__)
+    pc = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+    fp = (uintptr_t)uc->uc_mcontext.gregs[REG_RBP];
+    sp = (uintptr_t)uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__aarch64__)
+    pc = (uintptr_t)uc->uc_mcontext.pc;
+    fp = (uintptr_t)uc->uc_mcontext.regs[29];
+    sp = (uintptr_t)uc->uc_mcontext.sp;
+#else
+    (void)uc; (void)frames; (void)maxDepth;
+    return 0; // No unwinder for this architecture
+#endif
+
+#if defined(__x86_64__) || defined(__aarch64__)
+    int depth = 0;
+    frames[depth++] = (void *)pc;
+
+    // Each frame record is { saved frame pointer, return address }
+    while (depth < maxDepth && stackHigh != 0) {
+        if (fp < sp || fp < stackLow || fp + 2 * sizeof(uintptr_t) > stackHigh || fp % sizeof(uintptr_t) != 0) {
+            break;
+        }
+        const uintptr_t *record = (const uintptr_t *)fp;
+        uintptr_t next = record[0];
+        uintptr_t ret = record[1];
+        if (ret == 0) {
+            break;
+        }
+        frames[depth++] = (void *)(ret - 1); // Point into the call instruction for symbolization
+        if (next <= fp) {
+            break; // Frames must move towards the stack base
+        }
+        fp = next;
+    }
+    return depth;
+#endif
+}
+
+/**
+ * @brief SIGPROF handler: stores the interrupted stack in the next free slot.
+ *
+ * @param sig The signal number (unused).
+ * @param info Signal details (unused).
+ * @param context The interrupted ucontext_t.
+ */
+static void profileSignalHandler(int sig, siginfo_t *info, void *context) {
+    (void)sig; (void)info;
+    if (!__atomic_load_n(&profilerRunning, __ATOMIC_RELAXED)) {
+        return; // A signal still in flight after stopProfiler
+    }
+    int savedErrno = errno;
+    unsigned long long slot = __atomic_fetch_add(&nextSlot, 1, __ATOMIC_RELAXED);
+    if (slot >= PROFILE_MAX_SAMPLES) {
+        __atomic_fetch_add(&droppedSamples, 1, __ATOMIC_RELAXED);
+    } else {
+        ProfileSample *s = &samples[slot];
+        s->depth = captureStack((const ucontext_t *)context, s->frames, PROFILE_MAX_DEPTH);
+        __atomic_store_n(&s->ready, 1, __ATOMIC_RELEASE);
+    }
+    errno = savedErrno;
+}
+
+/**
+ * @brief Arms (or disarms, with hz 0) the process CPU-time profiling timer.
+ *
+ * @param hz The interrupt rate; 0 disarms the timer.
+ * @return 1 on success, 0 on failure.
+ */
+static int armTimer(int hz) {
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    if (hz > 0) {
+        timer.it_interval.tv_sec = 0;
+        timer.it_interval.tv_usec = hz >= 1000000 ? 1 : 1000000 / hz;
+        timer.it_value = timer.it_interval;
+    }
+    return setitimer(ITIMER_PROF, &timer, NULL) == 0;
+}
+
+/**
+ * @brief Starts sampling the whole process at the given rate of CPU time.
+ *
+ * Samples already in the buffer are kept, so a profile can be paused and resumed.
+ *
+ * @param hz Samples per second of CPU time (values <= 0 use PROFILE_DEFAULT_HZ).
+ * @return 1 on success, 0 on failure (e.g., already running, unsupported platform).
+ */
+int startProfiler(int hz) {
+    if (profilerRunning) {
+        printf("Profiler is already running.\n");
+        return 0;
+    }
+    if (samples == NULL) {
+        samples = (ProfileSample *)calloc(PROFILE_MAX_SAMPLES, sizeof(ProfileSample));
+        if (samples == NULL) {
+            printf("Error: Could not allocate memory for profile samples.\n");
+            return 0;
+        }
+    }
+    if (!handlerInstalled) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = profileSignalHandler;
+        action.sa_flags = SA_SIGINFO | SA_RESTART; // Keep blocking reads (e.g., the menu) working
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, NULL) != 0) {
+            printf("Error: Could not install the SIGPROF handler.\n");
+            return 0;
+        }
+        handlerInstalled = 1;
+    }
+    profilerRegisterThread();
+
+    if (hz <= 0) {
+        hz = PROFILE_DEFAULT_HZ;
+    }
+    __atomic_store_n(&profilerRunning, 1, __ATOMIC_RELAXED);
+    if (!armTimer(hz)) {
+        __atomic_store_n(&profilerRunning, 0, __ATOMIC_RELAXED);
+        printf("Error: Could not start the profiling timer.\n");
+        return 0;
+    }
+    printf("Profiler started at %d Hz.\n", hz);
+    fflush(stdout); // Flush output
+    return 1;
+}
+
+/**
+ * @brief Stops sampling; the collected samples stay in the buffer.
+ *
+ * The handler stays installed: the default action of SIGPROF terminates the
+ * process, and a signal may still be pending when the timer is disarmed.
+ *
+ * @return 1 on success, 0 if the profiler was not running.
+ */
+int stopProfiler() {
+    if (!profilerRunning) {
+        return 0;
+    }
+    armTimer(0);
+    __atomic_store_n(&profilerRunning, 0, __ATOMIC_RELAXED);
+    unsigned long long taken = __atomic_load_n(&nextSlot, __ATOMIC_ACQUIRE);
+    printf("Profiler stopped (%llu samples, %llu dropped).\n",
+           taken < PROFILE_MAX_SAMPLES ? taken : (unsigned long long)PROFILE_MAX_SAMPLES,
+           __atomic_load_n(&droppedSamples, __ATOMIC_RELAXED));
+    fflush(stdout); // Flush output
+    return 1;
+}
+
+/**
+ * @brief Reports whether the profiler is currently sampling.
+ *
+ * @return 1 if running, 0 otherwise.
+ */
+int isProfilerRunning() {
+    return __atomic_load_n(&profilerRunning, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Discards all collected samples. Only allowed while the profiler is stopped.
+ *
+ * @return 1 on success, 0 if the profiler is running.
+ */
+int resetProfiler() {
+    if (profilerRunning) {
+        return 0;
+    }
+    if (samples != NULL) {
+        for (int i = 0; i < PROFILE_MAX_SAMPLES; i++) {
+            samples[i].ready = 0;
+        }
+    }
+    __atomic_store_n(&nextSlot, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&droppedSamples, 0, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/**
+ * @brief Appends the name of one frame to a folded-stack line.
+ *
+ * Uses the symbol name when dladdr finds one, otherwise "module+0xoffset"
+ * (or the raw address if even the module is unknown).
+ *
+ * @param addr The program counter.
+ * @param out The line being built.
+ * @param used Bytes of out already used; updated.
+ * @param size The size of out.
+ */
+static void appendFrameName(void *addr, char *out, size_t *used, size_t size) {
+    Dl_info info;
+    memset(&info, 0, sizeof(info));
+    int n;
+    if (dladdr(addr, &info) != 0 && info.dli_sname != NULL) {
+        n = snprintf(out + *used, size - *used, "%s", info.dli_sname);
+    } else if (info.dli_fname != NULL && info.dli_fbase != NULL) {
+        const char *module = strrchr(info.dli_fname, '/');
+        module = module != NULL ? module + 1 : info.dli_fname;
+        n = snprintf(out + *used, size - *used, "%s+0x%lx", module,
+                     (unsigned long)((uintptr_t)addr - (uintptr_t)info.dli_fbase));
+    } else {
+        n = snprintf(out + *used, size - *used, "0x%lx", (unsigned long)(uintptr_t)addr);
+    }
+    if (n > 0) {
+        *used = *used + (size_t)n < size ? *used + (size_t)n : size - 1;
+    }
+}
+
+/**
+ * @brief qsort comparison of two folded-stack lines.
+ *
+ * @param a Pointer to the first line pointer.
+ * @param b Pointer to the second line pointer.
+ * @return strcmp order of the lines.
+ */
+static int compareLines(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief Writes the collected samples as folded stacks, one unique stack per line with its count.
+ *
+ * Frames are symbolized with dladdr; addresses without a symbol are written as hex.
+ *
+ * @param filename The file to write (e.g., "profile.folded").
+ * @return 1 on success, 0 on failure (e.g., no samples, file cannot be opened).
+ */
+int writeFoldedStacks(const char *filename) {
+    unsigned long long taken = __atomic_load_n(&nextSlot, __ATOMIC_ACQUIRE);
+    int count = (int)(taken < PROFILE_MAX_SAMPLES ? taken : PROFILE_MAX_SAMPLES);
+    if (samples == NULL || count == 0) {
+        printf("No profile samples collected.\n");
+        return 0;
+    }
+
+    const size_t lineSize = PROFILE_MAX_DEPTH * 64;
+    char **lines = (char **)malloc((size_t)count * sizeof(char *));
+    if (lines == NULL) {
+        printf("Error: Could not allocate memory for the profile.\n");
+        return 0;
+    }
+    int lineCount = 0;
+    for (int i = 0; i < count; i++) {
+        const ProfileSample *s = &samples[i];
+        if (!__atomic_load_n(&s->ready, __ATOMIC_ACQUIRE) || s->depth == 0) {
+            continue; // Slot still being written by a handler
+        }
+        char *line = (char *)malloc(lineSize);
+        if (line == NULL) {
+            break;
+        }
+        size_t used = 0;
+        line[0] = '\0';
+        for (int f = s->depth - 1; f >= 0; f--) { // Folded stacks are written root first
+            appendFrameName(s->frames[f], line, &used, lineSize);
+            if (f > 0 && used + 1 < lineSize) {
+                line[used++] = ';';
+                line[used] = '\0';
+            }
+        }
+        lines[lineCount++] = line;
+    }
+
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open file %s for writing.\n", filename);
+        for (int i = 0; i < lineCount; i++) {
+            free(lines[i]);
+        }
+        free(lines);
+        return 0;
+    }
+
+    // Identical stacks become adjacent once sorted; write each with its count
+    qsort(lines, lineCount, sizeof(char *), compareLines);
+    int unique = 0;
+    for (int i = 0; i < lineCount;) {
+        int j = i + 1;
+        while (j < lineCount && strcmp(lines[j], lines[i]) == 0) {
+            j++;
+        }
+        fprintf(fp, "%s %d\n", lines[i], j - i);
+        unique++;
+        i = j;
+    }
+    fclose(fp);
+
+    for (int i = 0; i < lineCount; i++) {
+        free(lines[i]);
+    }
+    free(lines);
+    printf("Wrote %d samples (%d unique stacks) to %s.\n", lineCount, unique, filename);
+    fflush(stdout); // Flush output
+    return 1;
+}
+
+#else // _WIN32
+
+/**
+ * @brief Records the calling thread's stack bounds (unsupported on Windows).
+ *
+ * @return 0 always.
+ */
+int profilerRegisterThread() {
+    return 0;
+}
+
+/**
+ * @brief Starts sampling (unsupported on Windows).
+ *
+ * @param hz Unused.
+ * @return 0 always.
+ */
+int startProfiler(int hz) {
+    (void)hz;
+    printf("The sampling profiler requires SIGPROF and is not available on Windows.\n");
+    return 0;
+}
+
+/**
+ * @brief Stops sampling (unsupported on Windows).
+ *
+ * @return 0 always.
+ */
+int stopProfiler() {
+    return 0;
+}
+
+/**
+ * @brief Reports whether the profiler is running (never on Windows).
+ *
+ * @return 0 always.
+ */
+int isProfilerRunning() {
+    return 0;
+}
+
+/**
+ * @brief Discards samples (nothing to discard on Windows).
+ *
+ * @return 1 always.
+ */
+int resetProfiler() {
+    return 1;
+}
+
+/**
+ * @brief Writes folded stacks (unsupported on Windows).
+ *
+ * @param filename Unused.
+ * @return 0 always.
+ */
+int writeFoldedStacks(const char *filename) {
+    (void)filename;
+    printf("No profile samples collected.\n");
+    return 0;
+}
+
+#endif // _WIN32
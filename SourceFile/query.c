@@ -0,0 +1,1285 @@
+/**
+ * @file query.c
+ * @brief Implementation of the flight filter query engine.
+ *
+ * A query is compiled into range predicates on int columns. The columns are
+ * a copy of the flight table laid out field by field (padded to a multiple of
+ * 64 rows), so one predicate over 64 rows is 8 AVX2 or 16 SSE2 compares and
+ * yields one 64-bit mask. The planner binds string values to dictionary codes,
+ * drops predicates that always hold, detects ones that never hold, and picks
+ * the cheapest access path: the route index, the time index, the status/day
+ * bitmaps of flightindex.c or a full scan. Top-K queries run over the same
+ * access paths with a bounded heap of row numbers.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For qsort, strtol
+#include <string.h>
+#include <ctype.h>  // For isspace, isalpha, tolower
+#include <errno.h>  // For errno, ERANGE
+#include <limits.h> // For INT_MIN, INT_MAX
+#include <stdint.h> // For uint32_t, uint64_t
+#include <time.h>   // For time, localtime
+#include <pthread.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "query.h"
+#include "flight.h"
+#include "flightindex.h"
+#include "inventory.h"
+#include "memstats.h"
+#include "stats.h"
+#include "timing.h"
+
+/**
+ * @def QUERY_BLOCK_ROWS
+ * @brief Rows evaluated together (one bit each in a 64-bit selection mask).
+ */
+#define QUERY_BLOCK_ROWS 64
+
+/**
+ * @def QUERY_MINUTES_PER_DAY
+ * @brief Minute numbers per day number (see dateTimeMinutes and departureDay).
+ */
+#define QUERY_MINUTES_PER_DAY 1440
+
+/**
+ * @struct FlightColumns
+ * @brief The columnar copy of a flight table with its dictionary and indexes.
+ */
+typedef struct {
+    int built;                      /**< 1 once built. */
+    const Flight *table;            /**< Table the columns were built from. */
+    int count;                      /**< Rows (the table's flight count when built). */
+    int capacity;                   /**< Allocated rows per column (a multiple of QUERY_BLOCK_ROWS). */
+    unsigned long version;          /**< flightTableVersion when built. */
+    unsigned long seatVersion;      /**< flightSeatVersion when the seats column was copied. */
+    unsigned long statusVersion;    /**< flightStatusVersion when the status column was copied. */
+    int *columns[QUERY_FIELD_COUNT]; /**< One int column per QueryField. */
+    int *routeOrder;                /**< Rows sorted by origin, destination, row. */
+    int *timeOrder;                 /**< Rows sorted by departure, row. */
+    int *idOrder;                   /**< Rows sorted by flight ID, row (built on first use). */
+    const char **dictionary;        /**< String of each dictionary code (points into the table). */
+    int dictionaryCount;            /**< Codes in use. */
+    int dictionaryCapacity;         /**< Allocated dictionary entries. */
+    int *hashSlots;                 /**< Open-addressing table of code + 1 (0 = empty). */
+    int hashSize;                   /**< Slots in hashSlots (a power of two). */
+} FlightColumns;
+
+static FlightColumns flightColumns;  /**< The columns of the last queried table. */
+static pthread_mutex_t queryLock = PTHREAD_MUTEX_INITIALIZER; /**< Serializes rebuilds and queries. */
+
+/**
+ * @var planNames
+ * @brief Display names, indexed by QueryPlanKind.
+ */
+static const char *const planNames[] = { "full scan", "route index", "time index", "bitmap index", "empty" };
+
+/**
+ * @brief Returns the minute number of a date and time, increasing with time.
+ *
+ * @param dateTime The date and time.
+ * @return Minutes counted from 1900 with 31-day months (only the order is meaningful).
+ */
+int dateTimeMinutes(const DateTime *dateTime) {
+    int months = ((int)dateTime->year - 1900) * 12 + (int)dateTime->month - 1;
+    return ((months * 31 + (int)dateTime->day - 1) * 24 + (int)dateTime->hour) * 60 + (int)dateTime->minute;
+}
+
+/**
+ * @brief Returns the display name of a plan kind.
+ *
+ * @param kind The plan kind.
+ * @return A constant string such as "route index".
+ */
+const char *queryPlanName(QueryPlanKind kind) {
+    return (kind >= QUERY_PLAN_SCAN && kind <= QUERY_PLAN_EMPTY) ? planNames[kind] : "unknown";
+}
+
+/**
+ * @brief Compares two strings ignoring ASCII case.
+ *
+ * @param a The first string.
+ * @param b The second string.
+ * @return 1 if equal ignoring case, 0 otherwise.
+ */
+static int equalsIgnoreCase(const char *a, const char *b) {
+    while (*a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return *a == '\0' && *b == '\0';
+}
+
+/**
+ * @brief Maps a field name to its field.
+ *
+ * @param name The field name.
+ * @return The field, or QUERY_FIELD_COUNT if unknown.
+ */
+static QueryField parseField(const char *name) {
+    static const struct { const char *name; QueryField field; } fields[] = {
+        { "id", QUERY_ID }, { "flightID", QUERY_ID },
+        { "name", QUERY_NAME }, { "flightName", QUERY_NAME },
+        { "origin", QUERY_ORIGIN }, { "destination", QUERY_DESTINATION }, { "dest", QUERY_DESTINATION },
+        { "status", QUERY_STATUS },
+        { "seats", QUERY_SEATS }, { "availableSeats", QUERY_SEATS },
+        { "departure", QUERY_DEPARTURE }, { "dep", QUERY_DEPARTURE }
+    };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (equalsIgnoreCase(name, fields[i].name)) {
+            return fields[i].field;
+        }
+    }
+    return QUERY_FIELD_COUNT;
+}
+
+/**
+ * @brief Returns the number of days in a month.
+ *
+ * @param month The month (1-12).
+ * @param year The year.
+ * @return 28 to 31.
+ */
+static int daysInMonth(int month, int year) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return days[month - 1] + (month == 2 && leap);
+}
+
+/**
+ * @brief Parses a departure value into the range of minutes it denotes.
+ *
+ * @param text "today", "tomorrow", "YYYY-MM-DD" (a whole day), "now" or "YYYY-MM-DDTHH:MM" (one minute).
+ * @param first Receives the first minute.
+ * @param last Receives the last minute.
+ * @return 1 on success, 0 if the value is not a valid date (e.g., 2026-02-30 or 24:00).
+ */
+static int parseDeparture(const char *text, int *first, int *last) {
+    DateTime dt = {0};
+    int year, month, day, hour = 0, minute = 0, consumed = 0;
+    int wholeDay = 1;
+    if (equalsIgnoreCase(text, "today") || equalsIgnoreCase(text, "tomorrow") || equalsIgnoreCase(text, "now")) {
+        time_t now = time(NULL) + (equalsIgnoreCase(text, "tomorrow") ? 24 * 60 * 60 : 0);
+        const struct tm *local = localtime(&now);
+        if (local == NULL) {
+            return 0;
+        }
+        year = local->tm_year + 1900;
+        month = local->tm_mon + 1;
+        day = local->tm_mday;
+        if (equalsIgnoreCase(text, "now")) {
+            hour = local->tm_hour;
+            minute = local->tm_min;
+            wholeDay = 0;
+        }
+    } else {
+        if (sscanf(text, "%4d-%2d-%2d%n", &year, &month, &day, &consumed) != 3) {
+            return 0;
+        }
+        if (text[consumed] == 'T') {
+            int timeConsumed = 0;
+            if (sscanf(text + consumed, "T%2d:%2d%n", &hour, &minute, &timeConsumed) != 2) {
+                return 0;
+            }
+            consumed += timeConsumed;
+            wholeDay = 0;
+        }
+        if (text[consumed] != '\0') {
+            return 0;
+        }
+    }
+    if (year < 0 || year > 4095 || month < 1 || month > 12 || day < 1 || day > daysInMonth(month, year) ||
+        hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        return 0;
+    }
+    dt.year = (unsigned int)year;
+    dt.month = (unsigned int)month;
+    dt.day = (unsigned int)day;
+    dt.hour = (unsigned int)hour;
+    dt.minute = (unsigned int)minute;
+    *first = dateTimeMinutes(&dt);
+    *last = wholeDay ? *first + 24 * 60 - 1 : *first;
+    return 1;
+}
+
+/**
+ * @brief Parses a status value.
+ *
+ * @param text ON_TIME, DELAYED or CANCELLED (any case), or 0, 1 or 2.
+ * @param status Receives the status.
+ * @return 1 on success, 0 if unknown.
+ */
+static int parseStatus(const char *text, int *status) {
+    static const char *const names[] = { "ON_TIME", "DELAYED", "CANCELLED" };
+    for (int i = 0; i < 3; i++) {
+        if (equalsIgnoreCase(text, names[i]) || (text[0] == '0' + i && text[1] == '\0')) {
+            *status = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Turns "field op [first, last]" into the predicate's range.
+ *
+ * A single value has first == last; a day spans its minutes.
+ *
+ * @param predicate Receives lo, hi and negate.
+ * @param op The operator ("=", "!=", "<", "<=", ">", ">=" or "in").
+ * @param first The first value denoted.
+ * @param last The last value denoted.
+ */
+static void setRange(QueryPredicate *predicate, const char *op, long long first, long long last) {
+    long long lo = INT_MIN, hi = INT_MAX;
+    predicate->negate = 0;
+    if (strcmp(op, "=") == 0 || strcmp(op, "in") == 0) {
+        lo = first;
+        hi = last;
+    } else if (strcmp(op, "!=") == 0) {
+        lo = first;
+        hi = last;
+        predicate->negate = 1;
+    } else if (strcmp(op, "<") == 0) {
+        hi = first - 1;
+    } else if (strcmp(op, "<=") == 0) {
+        hi = last;
+    } else if (strcmp(op, ">") == 0) {
+        lo = last + 1;
+    } else { // ">="
+        lo = first;
+    }
+    // Out-of-range bounds become empty ranges (lo > hi), which the planner detects
+    predicate->lo = lo < INT_MIN ? INT_MIN : (lo > INT_MAX ? INT_MAX : (int)lo);
+    predicate->hi = hi > INT_MAX ? INT_MAX : (hi < INT_MIN ? INT_MIN : (int)hi);
+    if (lo > INT_MAX || hi < INT_MIN) {
+        predicate->lo = 1;
+        predicate->hi = 0;
+    }
+}
+
+/**
+ * @brief Compiles query text, printing the reason if it is invalid.
+ *
+ * @param text The query text.
+ * @param query Receives the compiled query.
+ * @return 1 on success, 0 on a syntax error.
+ */
+int compileQuery(const char *text, Query *query) {
+    const char *p = text;
+    memset(query, 0, sizeof(*query));
+    for (;;) {
+        char fieldName[32], op[4], value[MAX_NAME_LEN];
+        size_t length = 0;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') {
+            printf("Query error: expected a predicate%s.\n", query->predicateCount > 0 ? " after AND" : "");
+            return 0;
+        }
+
+        // field
+        while ((isalpha((unsigned char)*p) || *p == '_') && length < sizeof(fieldName) - 1) {
+            fieldName[length++] = *p++;
+        }
+        fieldName[length] = '\0';
+        QueryField field = parseField(fieldName);
+        if (field == QUERY_FIELD_COUNT) {
+            printf("Query error: unknown field '%s'.\n", fieldName);
+            return 0;
+        }
+
+        // operator
+        while (isspace((unsigned char)*p)) p++;
+        length = 0;
+        if ((p[0] == 'i' || p[0] == 'I') && (p[1] == 'n' || p[1] == 'N') && isspace((unsigned char)p[2])) {
+            strcpy(op, "in");
+            p += 2;
+        } else {
+            while (*p != '\0' && strchr("<>=!", *p) != NULL && length < sizeof(op) - 1) {
+                op[length++] = *p++;
+            }
+            op[length] = '\0';
+            if (strcmp(op, "=") != 0 && strcmp(op, "!=") != 0 && strcmp(op, "<") != 0 &&
+                strcmp(op, "<=") != 0 && strcmp(op, ">") != 0 && strcmp(op, ">=") != 0) {
+                printf("Query error: expected an operator after '%s'.\n", fieldName);
+                return 0;
+            }
+        }
+
+        // value
+        while (isspace((unsigned char)*p)) p++;
+        length = 0;
+        while (*p != '\0' && !isspace((unsigned char)*p) && length < sizeof(value) - 1) {
+            value[length++] = *p++;
+        }
+        value[length] = '\0';
+        if (length == 0) {
+            printf("Query error: expected a value after '%s %s'.\n", fieldName, op);
+            return 0;
+        }
+
+        if (query->predicateCount == QUERY_MAX_PREDICATES) {
+            printf("Query error: more than %d predicates.\n", QUERY_MAX_PREDICATES);
+            return 0;
+        }
+        QueryPredicate *predicate = query->predicates + query->predicateCount;
+        predicate->field = field;
+        int isString = field == QUERY_NAME || field == QUERY_ORIGIN || field == QUERY_DESTINATION;
+        if (strcmp(op, "in") == 0 && field != QUERY_DEPARTURE) {
+            printf("Query error: IN applies to departure only.\n");
+            return 0;
+        }
+        if ((isString || field == QUERY_STATUS) && strcmp(op, "=") != 0 && strcmp(op, "!=") != 0) {
+            printf("Query error: %s only supports = and !=.\n", fieldName);
+            return 0;
+        }
+        if (isString) {
+            strcpy(predicate->text, value);
+            setRange(predicate, op, 0, 0); // Bound to the dictionary code when the query runs
+        } else if (field == QUERY_STATUS) {
+            int status;
+            if (!parseStatus(value, &status)) {
+                printf("Query error: unknown status '%s' (use ON_TIME, DELAYED or CANCELLED).\n", value);
+                return 0;
+            }
+            setRange(predicate, op, status, status);
+        } else if (field == QUERY_DEPARTURE) {
+            int first, last;
+            if (!parseDeparture(value, &first, &last)) {
+                printf("Query error: invalid date '%s' (use today, tomorrow, now, YYYY-MM-DD or YYYY-MM-DDTHH:MM).\n", value);
+                return 0;
+            }
+            setRange(predicate, op, first, last);
+        } else {
+            char *end;
+            errno = 0;
+            long long number = strtoll(value, &end, 10);
+            if (end == value || *end != '\0') {
+                printf("Query error: '%s' is not a number.\n", value);
+                return 0;
+            }
+            if (errno == ERANGE) {
+                printf("Query error: '%s' is out of range.\n", value);
+                return 0;
+            }
+            // Any value beyond int behaves like one just beyond it, and first - 1 / last + 1 cannot overflow
+            if (number < INT_MIN - 1LL) number = INT_MIN - 1LL;
+            if (number > INT_MAX + 1LL) number = INT_MAX + 1LL;
+            setRange(predicate, op, number, number);
+        }
+        query->predicateCount++;
+
+        // AND or end
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0') {
+            return 1;
+        }
+        if (!((p[0] == 'a' || p[0] == 'A') && (p[1] == 'n' || p[1] == 'N') && (p[2] == 'd' || p[2] == 'D') &&
+              (isspace((unsigned char)p[3]) || p[3] == '\0'))) {
+            printf("Query error: expected AND before '%s'.\n", p);
+            return 0;
+        }
+        p += 3;
+    }
+}
+
+/**
+ * @brief Hashes a string of at most MAX_NAME_LEN bytes (FNV-1a).
+ *
+ * @param text The string.
+ * @return The hash.
+ */
+static uint32_t hashText(const char *text) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < MAX_NAME_LEN && text[i] != '\0'; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Looks up the dictionary code of a string.
+ *
+ * @param text The string.
+ * @return The code, or -1 if the string does not occur in the table.
+ */
+static int findCode(const char *text) {
+    FlightColumns *c = &flightColumns;
+    if (c->hashSize == 0) {
+        return -1;
+    }
+    for (uint32_t slot = hashText(text) & (uint32_t)(c->hashSize - 1);; slot = (slot + 1) & (uint32_t)(c->hashSize - 1)) {
+        int entry = c->hashSlots[slot];
+        if (entry == 0) {
+            return -1;
+        }
+        if (strncmp(c->dictionary[entry - 1], text, MAX_NAME_LEN) == 0) {
+            return entry - 1;
+        }
+    }
+}
+
+/**
+ * @brief Returns the dictionary code of a string, adding it if new.
+ *
+ * @param text The string (must stay valid while the columns are in use).
+ * @return The code, or -1 if memory allocation failed.
+ */
+static int internCode(const char *text) {
+    FlightColumns *c = &flightColumns;
+    int code = findCode(text);
+    if (code >= 0) {
+        return code;
+    }
+    if (c->dictionaryCount == c->dictionaryCapacity) {
+        int capacity = c->dictionaryCapacity > 0 ? c->dictionaryCapacity * 2 : 64;
+        const char **dictionary = (const char **)trackedRealloc(MEM_OTHER, (void *)c->dictionary, (size_t)capacity * sizeof(char *));
+        int *slots = (int *)trackedMalloc(MEM_OTHER, (size_t)capacity * 2 * sizeof(int));
+        if (dictionary == NULL || slots == NULL) {
+            if (dictionary != NULL) {
+                c->dictionary = dictionary;
+            }
+            trackedFree(MEM_OTHER, slots);
+            return -1;
+        }
+        // Rehash into a table twice the dictionary capacity (load factor <= 1/2)
+        memset(slots, 0, (size_t)capacity * 2 * sizeof(int));
+        for (int i = 0; i < c->dictionaryCount; i++) {
+            uint32_t slot = hashText(dictionary[i]) & (uint32_t)(capacity * 2 - 1);
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & (uint32_t)(capacity * 2 - 1);
+            }
+            slots[slot] = i + 1;
+        }
+        trackedFree(MEM_OTHER, c->hashSlots);
+        c->dictionary = dictionary;
+        c->dictionaryCapacity = capacity;
+        c->hashSlots = slots;
+        c->hashSize = capacity * 2;
+    }
+    code = c->dictionaryCount++;
+    c->dictionary[code] = text;
+    uint32_t slot = hashText(text) & (uint32_t)(c->hashSize - 1);
+    while (c->hashSlots[slot] != 0) {
+        slot = (slot + 1) & (uint32_t)(c->hashSize - 1);
+    }
+    c->hashSlots[slot] = code + 1;
+    return code;
+}
+
+/**
+ * @brief Orders rows by origin code, destination code, then row (qsort callback).
+ *
+ * @param a A pointer to the first row number.
+ * @param b A pointer to the second row number.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareRoutes(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    const int *origin = flightColumns.columns[QUERY_ORIGIN];
+    const int *destination = flightColumns.columns[QUERY_DESTINATION];
+    if (origin[x] != origin[y]) return origin[x] < origin[y] ? -1 : 1;
+    if (destination[x] != destination[y]) return destination[x] < destination[y] ? -1 : 1;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Orders rows by departure, then row (qsort callback).
+ *
+ * @param a A pointer to the first row number.
+ * @param b A pointer to the second row number.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareDepartures(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    const int *departure = flightColumns.columns[QUERY_DEPARTURE];
+    if (departure[x] != departure[y]) return departure[x] < departure[y] ? -1 : 1;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Orders rows by flight ID, then row (qsort callback).
+ *
+ * @param a A pointer to the first row number.
+ * @param b A pointer to the second row number.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareIDs(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    const int *id = flightColumns.columns[QUERY_ID];
+    if (id[x] != id[y]) return id[x] < id[y] ? -1 : 1;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Orders row numbers ascending (qsort callback).
+ *
+ * @param a A pointer to the first row number.
+ * @param b A pointer to the second row number.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareRows(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Frees the query columns and indexes.
+ */
+static void freeColumns() {
+    FlightColumns *c = &flightColumns;
+    for (int i = 0; i < QUERY_FIELD_COUNT; i++) {
+        trackedFree(MEM_OTHER, c->columns[i]);
+    }
+    trackedFree(MEM_OTHER, c->routeOrder);
+    trackedFree(MEM_OTHER, c->timeOrder);
+    trackedFree(MEM_OTHER, c->idOrder);
+    trackedFree(MEM_OTHER, (void *)c->dictionary);
+    trackedFree(MEM_OTHER, c->hashSlots);
+    memset(c, 0, sizeof(*c));
+}
+
+/**
+ * @brief Rebuilds the columns, dictionary and indexes from a flight table.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int buildColumns(const Flight *flights, int flightCount) {
+    FlightColumns *c = &flightColumns;
+    int capacity = (flightCount + QUERY_BLOCK_ROWS - 1) / QUERY_BLOCK_ROWS * QUERY_BLOCK_ROWS;
+    freeColumns();
+    for (int i = 0; i < QUERY_FIELD_COUNT; i++) {
+        // Padding rows stay zero; the tail mask of the last block excludes them
+        c->columns[i] = (int *)trackedMalloc(MEM_OTHER, (size_t)(capacity > 0 ? capacity : 1) * sizeof(int));
+        if (c->columns[i] == NULL) {
+            freeColumns();
+            return 0;
+        }
+        memset(c->columns[i], 0, (size_t)capacity * sizeof(int));
+    }
+    c->routeOrder = (int *)trackedMalloc(MEM_OTHER, (size_t)(flightCount > 0 ? flightCount : 1) * sizeof(int));
+    c->timeOrder = (int *)trackedMalloc(MEM_OTHER, (size_t)(flightCount > 0 ? flightCount : 1) * sizeof(int));
+    if (c->routeOrder == NULL || c->timeOrder == NULL) {
+        freeColumns();
+        return 0;
+    }
+
+    for (int i = 0; i < flightCount; i++) {
+        const Flight *f = flights + i;
+        int name = internCode(f->flightName);
+        int origin = internCode(f->origin);
+        int destination = internCode(f->destination);
+        if (name < 0 || origin < 0 || destination < 0) {
+            freeColumns();
+            return 0;
+        }
+        c->columns[QUERY_ID][i] = f->flightID;
+        c->columns[QUERY_NAME][i] = name;
+        c->columns[QUERY_ORIGIN][i] = origin;
+        c->columns[QUERY_DESTINATION][i] = destination;
+        c->columns[QUERY_STATUS][i] = (int)f->status;
+        c->columns[QUERY_SEATS][i] = f->availableSeats;
+        c->columns[QUERY_DEPARTURE][i] = dateTimeMinutes(&f->departure);
+        c->routeOrder[i] = i;
+        c->timeOrder[i] = i;
+    }
+    qsort(c->routeOrder, (size_t)flightCount, sizeof(int), compareRoutes);
+    qsort(c->timeOrder, (size_t)flightCount, sizeof(int), compareDepartures);
+
+    c->built = 1;
+    c->table = flights;
+    c->count = flightCount;
+    c->capacity = capacity;
+    c->version = flightTableVersion;
+    c->seatVersion = __atomic_load_n(&flightSeatVersion, __ATOMIC_ACQUIRE);
+    c->statusVersion = flightStatusVersion;
+    return 1;
+}
+
+/**
+ * @brief Makes the columns current for a flight table.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int refreshColumns(const Flight *flights, int flightCount) {
+    FlightColumns *c = &flightColumns;
+    if (!c->built || c->table != flights || c->count != flightCount || c->version != flightTableVersion) {
+        return buildColumns(flights, flightCount);
+    }
+    unsigned long seatVersion = __atomic_load_n(&flightSeatVersion, __ATOMIC_ACQUIRE);
+    if (c->seatVersion != seatVersion) {
+        // Bookings change only the seat counts; recopy that column alone
+        for (int i = 0; i < flightCount; i++) {
+            c->columns[QUERY_SEATS][i] = __atomic_load_n(&flights[i].availableSeats, __ATOMIC_RELAXED);
+        }
+        c->seatVersion = seatVersion;
+    }
+    if (c->statusVersion != flightStatusVersion) {
+        // Status changes move no rows either
+        for (int i = 0; i < flightCount; i++) {
+            c->columns[QUERY_STATUS][i] = (int)flights[i].status;
+        }
+        c->statusVersion = flightStatusVersion;
+    }
+    return 1;
+}
+
+/**
+ * @brief Evaluates lo <= column[i] <= hi for 64 consecutive rows.
+ *
+ * The range test is one unsigned compare, (x - lo) <= (hi - lo); SSE2 and
+ * AVX2 only compare signed, so both sides are biased by INT_MIN first.
+ *
+ * @param column The first of 64 values.
+ * @param lo The inclusive lower bound.
+ * @param hi The inclusive upper bound (>= lo).
+ * @return Bit i is set if row i is in range.
+ */
+static uint64_t rangeMask(const int *column, int lo, int hi) {
+    uint32_t span = (uint32_t)hi - (uint32_t)lo;
+    uint64_t mask = 0;
+#if defined(__AVX2__)
+    const __m256i bias = _mm256_set1_epi32(INT_MIN);
+    const __m256i low = _mm256_set1_epi32(lo);
+    const __m256i limit = _mm256_set1_epi32((int)(span ^ 0x80000000u));
+    for (int i = 0; i < QUERY_BLOCK_ROWS; i += 8) {
+        __m256i offset = _mm256_xor_si256(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(column + i)), low), bias);
+        __m256i outside = _mm256_cmpgt_epi32(offset, limit);
+        mask |= (uint64_t)(~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    const __m128i low = _mm_set1_epi32(lo);
+    const __m128i limit = _mm_set1_epi32((int)(span ^ 0x80000000u));
+    for (int i = 0; i < QUERY_BLOCK_ROWS; i += 4) {
+        __m128i offset = _mm_xor_si128(_mm_sub_epi32(_mm_loadu_si128((const __m128i *)(column + i)), low), bias);
+        __m128i outside = _mm_cmpgt_epi32(offset, limit);
+        mask |= (uint64_t)(~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF) << i;
+    }
+#else
+    for (int i = 0; i < QUERY_BLOCK_ROWS; i++) {
+        mask |= (uint64_t)((uint32_t)column[i] - (uint32_t)lo <= span) << i;
+    }
+#endif
+    return mask;
+}
+
+/**
+ * @brief Checks one row against a list of bound predicates.
+ *
+ * @param predicates The predicates.
+ * @param count The number of predicates.
+ * @param row The row.
+ * @return 1 if every predicate holds, 0 otherwise.
+ */
+static int rowMatches(const QueryPredicate *predicates, int count, int row) {
+    for (int i = 0; i < count; i++) {
+        const QueryPredicate *p = predicates + i;
+        int inside = (uint32_t)flightColumns.columns[p->field][row] - (uint32_t)p->lo <= (uint32_t)p->hi - (uint32_t)p->lo;
+        if (inside == p->negate) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Ranks a predicate for the scan order: likely-selective equalities first, negations last.
+ *
+ * @param predicate The predicate.
+ * @return A smaller rank for predicates to evaluate earlier.
+ */
+static int scanRank(const QueryPredicate *predicate) {
+    if (predicate->negate) {
+        return 3;
+    }
+    if (predicate->lo != predicate->hi) {
+        return 2;
+    }
+    return predicate->field == QUERY_STATUS ? 1 : 0; // Status has only three values
+}
+
+/**
+ * @brief Binds a query to the current columns.
+ *
+ * String predicates get their dictionary code; predicates that always hold are
+ * dropped, and the remaining ones are ordered for the scan.
+ *
+ * @param query The compiled query.
+ * @param bound Receives the bound predicates.
+ * @return The number of bound predicates, or -1 if some predicate can never hold.
+ */
+static int bindQuery(const Query *query, QueryPredicate *bound) {
+    int count = 0;
+    for (int i = 0; i < query->predicateCount; i++) {
+        QueryPredicate p = query->predicates[i];
+        if (p.field == QUERY_NAME || p.field == QUERY_ORIGIN || p.field == QUERY_DESTINATION) {
+            int code = findCode(p.text);
+            if (code < 0) {
+                if (p.negate) {
+                    continue; // "!= X" holds for every row when X does not occur
+                }
+                return -1;
+            }
+            p.lo = code;
+            p.hi = code;
+        }
+        if (p.lo > p.hi) {
+            if (p.negate) {
+                continue; // The complement of an empty range is every row
+            }
+            return -1;
+        }
+        if (p.negate && p.lo == INT_MIN && p.hi == INT_MAX) {
+            return -1;
+        }
+        if (!p.negate && p.lo == INT_MIN && p.hi == INT_MAX) {
+            continue;
+        }
+        bound[count++] = p;
+    }
+    // Insertion sort by scan rank (at most QUERY_MAX_PREDICATES entries)
+    for (int i = 1; i < count; i++) {
+        QueryPredicate p = bound[i];
+        int j = i - 1;
+        while (j >= 0 && scanRank(bound + j) > scanRank(&p)) {
+            bound[j + 1] = bound[j];
+            j--;
+        }
+        bound[j + 1] = p;
+    }
+    return count;
+}
+
+/**
+ * @brief Finds the route index range of an origin and, optionally, a destination.
+ *
+ * @param origin The origin code.
+ * @param destination The destination code, or -1 for any destination.
+ * @param first Receives the first position in routeOrder.
+ * @return The number of rows in the range.
+ */
+static int routeRange(int origin, int destination, int *first) {
+    const FlightColumns *c = &flightColumns;
+    const int *o = c->columns[QUERY_ORIGIN];
+    const int *d = c->columns[QUERY_DESTINATION];
+    int bounds[2];
+    for (int upper = 0; upper < 2; upper++) {
+        // Lower bound of (origin, destination) or upper bound; with no destination, of the whole origin
+        int low = 0, high = c->count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            int row = c->routeOrder[mid];
+            int before;
+            if (o[row] != origin) {
+                before = o[row] < origin;
+            } else if (destination < 0) {
+                before = upper;
+            } else if (d[row] != destination) {
+                before = d[row] < destination;
+            } else {
+                before = upper;
+            }
+            if (before) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        bounds[upper] = low;
+    }
+    *first = bounds[0];
+    return bounds[1] - bounds[0];
+}
+
+/**
+ * @brief Finds the time index range of departures in [lo, hi].
+ *
+ * @param lo The first minute.
+ * @param hi The last minute.
+ * @param first Receives the first position in timeOrder.
+ * @return The number of rows in the range.
+ */
+static int timeRange(int lo, int hi, int *first) {
+    const FlightColumns *c = &flightColumns;
+    const int *departure = c->columns[QUERY_DEPARTURE];
+    int bounds[2];
+    for (int upper = 0; upper < 2; upper++) {
+        int low = 0, high = c->count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            int value = departure[c->timeOrder[mid]];
+            if (upper ? value <= hi : value < lo) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        bounds[upper] = low;
+    }
+    *first = bounds[0];
+    return bounds[1] > bounds[0] ? bounds[1] - bounds[0] : 0;
+}
+
+/**
+ * @brief Returns the day number of a minute number (rounding down).
+ *
+ * @param minute The minute number.
+ * @return The day number, INT_MIN or INT_MAX for an unbounded minute.
+ */
+static int dayOfMinute(int minute) {
+    if (minute == INT_MIN || minute == INT_MAX) {
+        return minute;
+    }
+    return minute >= 0 ? minute / QUERY_MINUTES_PER_DAY : -((-minute + QUERY_MINUTES_PER_DAY - 1) / QUERY_MINUTES_PER_DAY);
+}
+
+/**
+ * @brief Turns a bitmap of flight IDs into candidate rows.
+ *
+ * @param ids The FLIGHT_INDEX_KEY values of the flights.
+ * @param rows Receives a trackedMalloc'd array of the rows (every row of an ID if IDs repeat).
+ * @return The number of rows, or -1 if memory allocation failed.
+ */
+static int rowsOfIDs(const Roaring *ids, int **rows) {
+    FlightColumns *c = &flightColumns;
+    if (c->idOrder == NULL) {
+        c->idOrder = (int *)trackedMalloc(MEM_OTHER, (size_t)(c->count > 0 ? c->count : 1) * sizeof(int));
+        if (c->idOrder == NULL) {
+            return -1;
+        }
+        for (int i = 0; i < c->count; i++) {
+            c->idOrder[i] = i;
+        }
+        qsort(c->idOrder, (size_t)c->count, sizeof(int), compareIDs);
+    }
+    int keyCount = (int)roaringCardinality(ids);
+    int capacity = keyCount > 0 ? keyCount : 1;
+    uint32_t *keys = (uint32_t *)trackedMalloc(MEM_OTHER, (size_t)capacity * sizeof(uint32_t));
+    *rows = (int *)trackedMalloc(MEM_OTHER, (size_t)capacity * sizeof(int));
+    if (keys == NULL || *rows == NULL) {
+        trackedFree(MEM_OTHER, keys);
+        trackedFree(MEM_OTHER, *rows);
+        *rows = NULL;
+        return -1;
+    }
+    roaringToArray(ids, keys, keyCount);
+
+    // The keys ascend, so each search starts where the previous one ended
+    const int *id = c->columns[QUERY_ID];
+    int rowCount = 0, low = 0;
+    for (int k = 0; k < keyCount; k++) {
+        int flightID = FLIGHT_INDEX_ID(keys[k]);
+        int high = c->count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (id[c->idOrder[mid]] < flightID) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        for (; low < c->count && id[c->idOrder[low]] == flightID; low++) {
+            if (rowCount == capacity) {
+                // Only a table with repeated IDs has more rows than keys
+                int *grown = (int *)trackedRealloc(MEM_OTHER, *rows, (size_t)capacity * 2 * sizeof(int));
+                if (grown == NULL) {
+                    trackedFree(MEM_OTHER, keys);
+                    trackedFree(MEM_OTHER, *rows);
+                    *rows = NULL;
+                    return -1;
+                }
+                *rows = grown;
+                capacity *= 2;
+            }
+            (*rows)[rowCount++] = c->idOrder[low];
+        }
+    }
+    trackedFree(MEM_OTHER, keys);
+    return rowCount;
+}
+
+/**
+ * @brief Tells whether one row comes before another in a result order.
+ *
+ * @param order The order.
+ * @param a The first row.
+ * @param b The second row.
+ * @return 1 if a sorts before b, 0 otherwise (rows are never equal: ties go by position).
+ */
+static int rowBefore(QueryOrder order, int a, int b) {
+    const int *departure = flightColumns.columns[QUERY_DEPARTURE];
+    if (order == QUERY_ORDER_FULLEST) {
+        const int *seats = flightColumns.columns[QUERY_SEATS];
+        if (seats[a] != seats[b]) return seats[a] < seats[b];
+    }
+    if (departure[a] != departure[b]) return departure[a] < departure[b];
+    return a < b;
+}
+
+/**
+ * @brief Moves a row down from the root of a bounded heap to its place.
+ *
+ * @param heap The heap (the root slot is overwritten).
+ * @param count The rows in the heap.
+ * @param order The result order (the root is the row that sorts last).
+ * @param row The row to place.
+ */
+static void siftDownRow(int *heap, int count, QueryOrder order, int row) {
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && rowBefore(order, heap[child], heap[child + 1])) child++;
+        if (!rowBefore(order, row, heap[child])) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = row;
+}
+
+/**
+ * @struct RowHeap
+ * @brief The best K rows seen so far, as a binary heap whose root sorts last.
+ */
+typedef struct {
+    int *rows;          /**< Heap storage (capacity rows). */
+    int count;          /**< Rows in the heap. */
+    int capacity;       /**< K. */
+    QueryOrder order;   /**< The result order. */
+    int seen;           /**< Rows offered. */
+} RowHeap;
+
+/**
+ * @brief Offers a matching row to a bounded heap (O(log K), O(1) when it is rejected).
+ *
+ * @param heap The heap.
+ * @param row The row.
+ */
+static void offerRow(RowHeap *heap, int row) {
+    int *h = heap->rows;
+    heap->seen++;
+    if (heap->count < heap->capacity) {
+        int i = heap->count++;
+        while (i > 0 && rowBefore(heap->order, h[(i - 1) / 2], row)) {
+            h[i] = h[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        h[i] = row;
+    } else if (rowBefore(heap->order, row, h[0])) {
+        siftDownRow(h, heap->count, heap->order, row);
+    }
+}
+
+/**
+ * @brief Heapsorts a bounded heap in place into result order.
+ *
+ * @param heap The heap; its rows end up best first.
+ * @return The number of rows.
+ */
+static int finishHeap(RowHeap *heap) {
+    int *h = heap->rows;
+    for (int n = heap->count; n > 1; n--) {
+        int last = h[0];
+        siftDownRow(h, n - 1, heap->order, h[n - 1]);
+        h[n - 1] = last;
+    }
+    return heap->count;
+}
+
+/**
+ * @brief Runs the block scan.
+ *
+ * @param bound The bound predicates, in evaluation order.
+ * @param boundCount The number of bound predicates.
+ * @param indexes Receives up to maxIndexes matches (may be NULL).
+ * @param maxIndexes The capacity of indexes.
+ * @param heap Receives every match instead of indexes (may be NULL).
+ * @return The number of matches.
+ */
+static int scanColumns(const QueryPredicate *bound, int boundCount, int *indexes, int maxIndexes, RowHeap *heap) {
+    const FlightColumns *c = &flightColumns;
+    int matches = 0;
+    for (int base = 0; base < c->count; base += QUERY_BLOCK_ROWS) {
+        int rows = c->count - base;
+        uint64_t mask = rows >= QUERY_BLOCK_ROWS ? ~0ULL : (1ULL << rows) - 1;
+        for (int i = 0; i < boundCount && mask != 0; i++) {
+            const QueryPredicate *p = bound + i;
+            uint64_t inside = rangeMask(c->columns[p->field] + base, p->lo, p->hi);
+            mask &= p->negate ? ~inside : inside;
+        }
+        while (mask != 0) {
+            int row = base + __builtin_ctzll(mask);
+            if (heap != NULL) {
+                offerRow(heap, row);
+            } else if (indexes != NULL && matches < maxIndexes) {
+                indexes[matches] = row;
+            }
+            matches++;
+            mask &= mask - 1;
+        }
+    }
+    return matches;
+}
+
+/**
+ * @brief Checks index candidates and returns the matches in array order.
+ *
+ * @param candidates The candidate rows.
+ * @param candidateCount The number of candidates.
+ * @param bound The bound predicates.
+ * @param boundCount The number of bound predicates.
+ * @param indexes Receives up to maxIndexes matches (may be NULL).
+ * @param maxIndexes The capacity of indexes.
+ * @return The number of matches, or -1 if memory allocation failed.
+ */
+static int checkCandidates(const int *candidates, int candidateCount, const QueryPredicate *bound, int boundCount,
+                           int *indexes, int maxIndexes) {
+    int *rows = (int *)trackedMalloc(MEM_OTHER, (size_t)(candidateCount > 0 ? candidateCount : 1) * sizeof(int));
+    if (rows == NULL) {
+        printf("Error: Could not allocate memory for the query.\n");
+        return -1;
+    }
+    int matches = 0, sorted = 1;
+    for (int i = 0; i < candidateCount; i++) {
+        if (rowMatches(bound, boundCount, candidates[i])) {
+            sorted = sorted && (matches == 0 || rows[matches - 1] < candidates[i]);
+            rows[matches++] = candidates[i];
+        }
+    }
+    if (!sorted) {
+        qsort(rows, (size_t)matches, sizeof(int), compareRows);
+    }
+    if (indexes != NULL) {
+        memcpy(indexes, rows, (size_t)(matches < maxIndexes ? matches : maxIndexes) * sizeof(int));
+    }
+    trackedFree(MEM_OTHER, rows);
+    return matches;
+}
+
+/**
+ * @struct AccessPath
+ * @brief The candidates the planner chose for a bound query.
+ */
+typedef struct {
+    QueryPlanKind kind;     /**< Scan, route, time or bitmap index. */
+    const int *candidates;  /**< Candidate rows, or NULL for a scan. */
+    int candidateCount;     /**< Candidates (every row for a scan). */
+    int *ownedCandidates;   /**< trackedMalloc'd bitmap candidates to free (may be NULL). */
+    int timeFirst;          /**< First timeOrder position the departure predicates allow. */
+    int timeRows;           /**< timeOrder positions they allow (every row if there is none). */
+} AccessPath;
+
+/**
+ * @brief Picks the cheapest access path for a bound query.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param bound The bound predicates.
+ * @param boundCount The number of bound predicates.
+ * @param path Receives the path; free path->ownedCandidates when done.
+ */
+static void chooseAccessPath(const Flight *flights, int flightCount, const QueryPredicate *bound, int boundCount,
+                             AccessPath *path) {
+    // Candidate counts of the route and time indexes (exact: both are range lookups)
+    int origin = -1, destination = -1, timeLo = INT_MIN, timeHi = INT_MAX, timed = 0;
+    int statusMask = FLIGHT_STATUS_ALL;
+    for (int i = 0; i < boundCount; i++) {
+        const QueryPredicate *p = bound + i;
+        if (p->field == QUERY_STATUS) {
+            int allowed = 0;
+            for (int s = ON_TIME; s <= CANCELLED; s++) {
+                allowed |= ((s >= p->lo && s <= p->hi) != p->negate) << s;
+            }
+            statusMask &= allowed;
+        }
+        if (p->negate) continue;
+        if (p->field == QUERY_ORIGIN) origin = p->lo;
+        if (p->field == QUERY_DESTINATION) destination = p->lo;
+        if (p->field == QUERY_DEPARTURE) {
+            timeLo = p->lo > timeLo ? p->lo : timeLo;
+            timeHi = p->hi < timeHi ? p->hi : timeHi;
+            timed = 1;
+        }
+    }
+    int routeFirst = 0, timeFirst = 0;
+    int routeRows = origin >= 0 ? routeRange(origin, destination, &routeFirst) : flightCount;
+    int timeRows = timed ? timeRange(timeLo, timeHi, &timeFirst) : flightCount;
+    memset(path, 0, sizeof(*path));
+    path->kind = QUERY_PLAN_SCAN;
+    path->candidateCount = flightCount;
+    path->timeFirst = timeFirst;
+    path->timeRows = timeRows;
+
+    // The bitmaps give an upper bound: the smaller of the status and day counts
+    long long bitmapRows = flightCount;
+    if ((statusMask != FLIGHT_STATUS_ALL || timed) && refreshFlightIndex(flights, flightCount)) {
+        bitmapRows = estimateFlightSelection(statusMask, dayOfMinute(timeLo), dayOfMinute(timeHi));
+    }
+    if (bitmapRows < routeRows && bitmapRows < timeRows && bitmapRows * QUERY_INDEX_FACTOR < flightCount) {
+        Roaring ids;
+        initRoaring(&ids);
+        int rows = -1;
+        if (selectFlights(statusMask, dayOfMinute(timeLo), dayOfMinute(timeHi), &ids)) {
+            rows = rowsOfIDs(&ids, &path->ownedCandidates);
+        }
+        freeRoaring(&ids);
+        if (rows >= 0) {
+            path->kind = QUERY_PLAN_BITMAP_INDEX;
+            path->candidates = path->ownedCandidates;
+            path->candidateCount = rows;
+            return;
+        }
+    }
+    if (routeRows <= timeRows && (long long)routeRows * QUERY_INDEX_FACTOR < flightCount) {
+        path->kind = QUERY_PLAN_ROUTE_INDEX;
+        path->candidates = flightColumns.routeOrder + routeFirst;
+        path->candidateCount = routeRows;
+    } else if ((long long)timeRows * QUERY_INDEX_FACTOR < flightCount) {
+        path->kind = QUERY_PLAN_TIME_INDEX;
+        path->candidates = flightColumns.timeOrder + timeFirst;
+        path->candidateCount = timeRows;
+    }
+}
+
+/**
+ * @brief Runs a compiled query over a flight table.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param query The compiled query.
+ * @param indexes Receives up to maxIndexes matching positions, in array order (may be NULL to only count).
+ * @param maxIndexes The capacity of indexes.
+ * @param plan Receives the plan and counts (may be NULL).
+ * @return The total number of matches (may exceed maxIndexes), or -1 if memory allocation failed.
+ */
+int runQuery(const Flight *flights, int flightCount, const Query *query, int *indexes, int maxIndexes, QueryPlan *plan) {
+    long long start = nowNanos();
+    QueryPredicate bound[QUERY_MAX_PREDICATES];
+    QueryPlan chosen = { QUERY_PLAN_SCAN, flightCount, 0 };
+
+    pthread_mutex_lock(&queryLock);
+    if (!refreshColumns(flights, flightCount)) {
+        pthread_mutex_unlock(&queryLock);
+        printf("Error: Could not allocate memory for the query columns.\n");
+        return -1;
+    }
+    int boundCount = bindQuery(query, bound);
+    if (boundCount < 0) {
+        chosen.kind = QUERY_PLAN_EMPTY;
+        chosen.candidates = 0;
+    } else {
+        AccessPath path;
+        chooseAccessPath(flights, flightCount, bound, boundCount, &path);
+        chosen.kind = path.kind;
+        chosen.candidates = path.candidateCount;
+        chosen.matches = path.candidates != NULL
+                       ? checkCandidates(path.candidates, path.candidateCount, bound, boundCount, indexes, maxIndexes)
+                       : scanColumns(bound, boundCount, indexes, maxIndexes, NULL);
+        trackedFree(MEM_OTHER, path.ownedCandidates);
+    }
+    pthread_mutex_unlock(&queryLock);
+
+    recordLatency(STAT_FLIGHT_QUERY, nowNanos() - start);
+    if (plan != NULL) {
+        *plan = chosen;
+    }
+    return chosen.matches;
+}
+
+/**
+ * @brief Runs a compiled query and returns only its first K matches in a given order.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param query The compiled query.
+ * @param order The result order.
+ * @param indexes Receives up to k matching positions, best first (capacity k).
+ * @param k The number of matches wanted.
+ * @param plan Receives the plan and counts (may be NULL).
+ * @return The number of positions written (at most k), or -1 if the columns could not be built.
+ */
+int runTopKQuery(const Flight *flights, int flightCount, const Query *query, QueryOrder order, int *indexes, int k,
+                 QueryPlan *plan) {
+    long long start = nowNanos();
+    QueryPredicate bound[QUERY_MAX_PREDICATES];
+    QueryPlan chosen = { QUERY_PLAN_SCAN, flightCount, 0 };
+    int found = 0;
+
+    pthread_mutex_lock(&queryLock);
+    if (!refreshColumns(flights, flightCount)) {
+        pthread_mutex_unlock(&queryLock);
+        printf("Error: Could not allocate memory for the query columns.\n");
+        return -1;
+    }
+    int boundCount = bindQuery(query, bound);
+    if (boundCount < 0 || k <= 0) {
+        chosen.kind = QUERY_PLAN_EMPTY;
+        chosen.candidates = 0;
+    } else {
+        AccessPath path;
+        chooseAccessPath(flights, flightCount, bound, boundCount, &path);
+        // Walking the time index until k matches checks about k * flightCount / candidates rows when matches are
+        // spread evenly over time; the heap checks every candidate
+        int walk = order == QUERY_ORDER_DEPARTURE &&
+                   (path.kind == QUERY_PLAN_SCAN || path.kind == QUERY_PLAN_TIME_INDEX ||
+                    (long long)k * flightCount < (long long)path.candidateCount * path.candidateCount);
+        if (walk) {
+            // The time index is already in result order: the first k matches along it are the answer
+            const int *rows = flightColumns.timeOrder + path.timeFirst;
+            int checked = 0;
+            while (checked < path.timeRows && found < k) {
+                int row = rows[checked++];
+                if (rowMatches(bound, boundCount, row)) {
+                    indexes[found++] = row;
+                }
+            }
+            chosen.kind = QUERY_PLAN_TIME_INDEX;
+            chosen.candidates = checked;
+            chosen.matches = found;
+        } else {
+            RowHeap heap = { indexes, 0, k, order, 0 };
+            if (path.candidates != NULL) {
+                for (int i = 0; i < path.candidateCount; i++) {
+                    if (rowMatches(bound, boundCount, path.candidates[i])) {
+                        offerRow(&heap, path.candidates[i]);
+                    }
+                }
+            } else {
+                scanColumns(bound, boundCount, NULL, 0, &heap);
+            }
+            found = finishHeap(&heap);
+            chosen.kind = path.kind;
+            chosen.candidates = path.candidateCount;
+            chosen.matches = heap.seen;
+        }
+        trackedFree(MEM_OTHER, path.ownedCandidates);
+    }
+    pthread_mutex_unlock(&queryLock);
+
+    recordLatency(STAT_FLIGHT_QUERY, nowNanos() - start);
+    if (plan != NULL) {
+        *plan = chosen;
+    }
+    return found;
+}
+
+/**
+ * @brief Frees the query columns and indexes.
+ */
+void cleanupQueryColumns() {
+    pthread_mutex_lock(&queryLock);
+    freeColumns();
+    pthread_mutex_unlock(&queryLock);
+}
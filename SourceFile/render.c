@@ -0,0 +1,603 @@
+/**
+ * @file render.c
+ * @brief Implementation of the buffered table renderer.
+ *
+ * Every record first makes sure RENDER_MAX_RECORD bytes are free in the
+ * buffer (writing the buffer out if not), so the formatting helpers below
+ * append without bounds checks. Integers are formatted two digits at a time
+ * from a lookup table; literals have their lengths computed at compile time.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <string.h>
+
+#include "render.h"
+#include "memstats.h"
+
+/**
+ * @def RENDER_MAX_RECORD
+ * @brief Upper bound on the bytes one record can produce (every string fully escaped).
+ */
+#define RENDER_MAX_RECORD (3 * 6 * MAX_NAME_LEN + 512)
+
+/**
+ * @def PUT_LITERAL(renderer, text)
+ * @brief Appends a string literal without measuring it at run time.
+ */
+#define PUT_LITERAL(renderer, text) putBytes((renderer), (text), sizeof(text) - 1)
+
+/**
+ * @struct StatusText
+ * @brief A status string and its length.
+ */
+typedef struct {
+    const char *text;   /**< The string. */
+    size_t length;      /**< Its length. */
+} StatusText;
+
+/**
+ * @var plainStatus
+ * @brief Status strings of the plain listing, indexed by FlightStatus (the last is for unknown values).
+ */
+static const StatusText plainStatus[] = {
+    { "On Time", 7 }, { "Delayed", 7 }, { "Cancelled", 9 }, { "Unknown", 7 }
+};
+
+/**
+ * @var codeStatus
+ * @brief Status strings of CSV and JSON, indexed by FlightStatus (the last is for unknown values).
+ */
+static const StatusText codeStatus[] = {
+    { "ON_TIME", 7 }, { "DELAYED", 7 }, { "CANCELLED", 9 }, { "UNKNOWN", 7 }
+};
+
+/**
+ * @var digitPairs
+ * @brief "00" to "99", so integers are formatted two digits per step.
+ */
+static const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ * @brief Writes the pending bytes to the output stream.
+ *
+ * @param renderer The listing.
+ */
+static void flushBuffer(Renderer *renderer) {
+    if (renderer->length > 0 && !renderer->failed &&
+        fwrite(renderer->buffer, 1, renderer->length, renderer->out) != renderer->length) {
+        renderer->failed = 1;
+    }
+    renderer->length = 0;
+}
+
+/**
+ * @brief Makes sure a whole record fits in the buffer.
+ *
+ * @param renderer The listing.
+ */
+static void reserveRecord(Renderer *renderer) {
+    if (renderer->length + RENDER_MAX_RECORD > RENDER_BUFFER_SIZE) {
+        flushBuffer(renderer);
+    }
+}
+
+/**
+ * @brief Appends bytes.
+ *
+ * @param renderer The listing.
+ * @param bytes The bytes.
+ * @param length The number of bytes.
+ */
+static void putBytes(Renderer *renderer, const char *bytes, size_t length) {
+    memcpy(renderer->buffer + renderer->length, bytes, length);
+    renderer->length += length;
+}
+
+/**
+ * @brief Appends a NUL-terminated field as is.
+ *
+ * @param renderer The listing.
+ * @param text The field.
+ * @param size The size of the field's array (at most MAX_NAME_LEN).
+ */
+static void putText(Renderer *renderer, const char *text, size_t size) {
+    putBytes(renderer, text, strnlen(text, size));
+}
+
+/**
+ * @brief Appends a decimal integer, left-padded with zeros to a minimum width.
+ *
+ * @param renderer The listing.
+ * @param value The integer.
+ * @param width Minimum number of digits (1 for no padding).
+ */
+static void putInt(Renderer *renderer, long long value, int width) {
+    char digits[24];
+    int count = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    while (magnitude >= 100) {
+        const char *pair = digitPairs + (magnitude % 100) * 2;
+        digits[count++] = pair[1];
+        digits[count++] = pair[0];
+        magnitude /= 100;
+    }
+    if (magnitude >= 10) {
+        digits[count++] = digitPairs[magnitude * 2 + 1];
+        digits[count++] = digitPairs[magnitude * 2];
+    } else {
+        digits[count++] = (char)('0' + magnitude);
+    }
+    while (count < width) {
+        digits[count++] = '0';
+    }
+    char *out = renderer->buffer + renderer->length;
+    if (value < 0) {
+        *out++ = '-';
+    }
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
+    renderer->length = (size_t)(out - renderer->buffer);
+}
+
+/**
+ * @brief Appends a date and time as "DD-MM-YYYY HH:MM" (plain) or "YYYY-MM-DDTHH:MM" (ISO 8601).
+ *
+ * @param renderer The listing.
+ * @param dt The date and time.
+ * @param iso 1 for ISO 8601.
+ */
+static void putDateTime(Renderer *renderer, DateTime dt, int iso) {
+    if (iso) {
+        putInt(renderer, dt.year, 4);
+        PUT_LITERAL(renderer, "-");
+        putInt(renderer, dt.month, 2);
+        PUT_LITERAL(renderer, "-");
+        putInt(renderer, dt.day, 2);
+        PUT_LITERAL(renderer, "T");
+    } else {
+        putInt(renderer, dt.day, 2);
+        PUT_LITERAL(renderer, "-");
+        putInt(renderer, dt.month, 2);
+        PUT_LITERAL(renderer, "-");
+        putInt(renderer, dt.year, 4);
+        PUT_LITERAL(renderer, " ");
+    }
+    putInt(renderer, dt.hour, 2);
+    PUT_LITERAL(renderer, ":");
+    putInt(renderer, dt.minute, 2);
+}
+
+/**
+ * @brief Appends a flight status from one of the status tables.
+ *
+ * @param renderer The listing.
+ * @param table plainStatus or codeStatus.
+ * @param status The status.
+ */
+static void putStatus(Renderer *renderer, const StatusText *table, FlightStatus status) {
+    const StatusText *s = table + ((status >= ON_TIME && status <= CANCELLED) ? (int)status : 3);
+    putBytes(renderer, s->text, s->length);
+}
+
+/**
+ * @brief Appends a CSV field, quoting it only if it contains a separator, quote or line break.
+ *
+ * @param renderer The listing.
+ * @param text The field.
+ * @param size The size of the field's array (at most MAX_NAME_LEN).
+ */
+static void putCsvField(Renderer *renderer, const char *text, size_t size) {
+    size_t length = strnlen(text, size);
+    if (strcspn(text, ",\"\r\n") >= length) {
+        putBytes(renderer, text, length);
+        return;
+    }
+    char *out = renderer->buffer + renderer->length;
+    *out++ = '"';
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '"') {
+            *out++ = '"'; // Quotes are doubled inside a quoted field
+        }
+        *out++ = text[i];
+    }
+    *out++ = '"';
+    renderer->length = (size_t)(out - renderer->buffer);
+}
+
+/**
+ * @brief Appends a JSON string literal, escaping quotes, backslashes and control characters.
+ *
+ * @param renderer The listing.
+ * @param text The string.
+ * @param size The size of the string's array (at most MAX_NAME_LEN).
+ */
+static void putJsonString(Renderer *renderer, const char *text, size_t size) {
+    static const char hex[] = "0123456789abcdef";
+    size_t length = strnlen(text, size);
+    char *out = renderer->buffer + renderer->length;
+    *out++ = '"';
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '"' || c == '\\') {
+            *out++ = '\\';
+            *out++ = (char)c;
+        } else if (c < 0x20) {
+            memcpy(out, "\\u00", 4);
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 0xF];
+            out += 6;
+        } else {
+            *out++ = (char)c;
+        }
+    }
+    *out++ = '"';
+    renderer->length = (size_t)(out - renderer->buffer);
+}
+
+/**
+ * @brief Starts a JSON object, separating it from the previous one.
+ *
+ * @param renderer The listing.
+ */
+static void beginJsonObject(Renderer *renderer) {
+    if (renderer->records > 0) {
+        PUT_LITERAL(renderer, ",\n");
+    }
+    PUT_LITERAL(renderer, "{");
+}
+
+/**
+ * @brief Starts a listing and writes its title (plain), header row (CSV) or opening bracket (JSON).
+ *
+ * @param renderer Receives the listing state.
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param table The kind of records.
+ * @return 1 on success, 0 if the buffer could not be allocated.
+ */
+int beginRender(Renderer *renderer, FILE *out, RenderFormat format, RenderTable table) {
+    renderer->out = out;
+    renderer->format = format;
+    renderer->table = table;
+    renderer->length = 0;
+    renderer->records = 0;
+    renderer->failed = 0;
+    renderer->buffer = (char *)trackedMalloc(MEM_OTHER, RENDER_BUFFER_SIZE);
+    if (renderer->buffer == NULL) {
+        printf("Error: Could not allocate the output buffer.\n");
+        return 0;
+    }
+
+    if (format == RENDER_JSON) {
+        PUT_LITERAL(renderer, "[\n");
+    } else if (format == RENDER_CSV) {
+        switch (table) {
+            case RENDER_FLIGHTS:
+                PUT_LITERAL(renderer, "flightID,flightName,origin,destination,departure,arrival,status,availableSeats\n");
+                break;
+            case RENDER_PASSENGERS:
+                PUT_LITERAL(renderer, "name,age,passport,assignedFlightID,assignedSeatNo\n");
+                break;
+            case RENDER_TICKETS:
+                PUT_LITERAL(renderer, "ticketID,passengerName,flightID,seatNo\n");
+                break;
+        }
+    } else {
+        switch (table) {
+            case RENDER_FLIGHTS:
+                PUT_LITERAL(renderer, "\n---- All Available Flights ----\n");
+                break;
+            case RENDER_PASSENGERS:
+                PUT_LITERAL(renderer, "\n---- All Registered Passengers ----\n");
+                break;
+            case RENDER_TICKETS:
+                PUT_LITERAL(renderer, "\n---- All Booked Tickets ----\n");
+                break;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Appends one flight.
+ *
+ * @param renderer A listing of RENDER_FLIGHTS.
+ * @param flight The flight.
+ */
+void renderFlight(Renderer *renderer, const Flight *flight) {
+    reserveRecord(renderer);
+    switch (renderer->format) {
+        case RENDER_CSV:
+            putInt(renderer, flight->flightID, 1);
+            PUT_LITERAL(renderer, ",");
+            putCsvField(renderer, flight->flightName, sizeof(flight->flightName));
+            PUT_LITERAL(renderer, ",");
+            putCsvField(renderer, flight->origin, sizeof(flight->origin));
+            PUT_LITERAL(renderer, ",");
+            putCsvField(renderer, flight->destination, sizeof(flight->destination));
+            PUT_LITERAL(renderer, ",");
+            putDateTime(renderer, flight->departure, 1);
+            PUT_LITERAL(renderer, ",");
+            putDateTime(renderer, flight->arrival, 1);
+            PUT_LITERAL(renderer, ",");
+            putStatus(renderer, codeStatus, flight->status);
+            PUT_LITERAL(renderer, ",");
+            putInt(renderer, flight->availableSeats, 1);
+            PUT_LITERAL(renderer, "\n");
+            break;
+        case RENDER_JSON:
+            beginJsonObject(renderer);
+            PUT_LITERAL(renderer, "\"flightID\":");
+            putInt(renderer, flight->flightID, 1);
+            PUT_LITERAL(renderer, ",\"flightName\":");
+            putJsonString(renderer, flight->flightName, sizeof(flight->flightName));
+            PUT_LITERAL(renderer, ",\"origin\":");
+            putJsonString(renderer, flight->origin, sizeof(flight->origin));
+            PUT_LITERAL(renderer, ",\"destination\":");
+            putJsonString(renderer, flight->destination, sizeof(flight->destination));
+            PUT_LITERAL(renderer, ",\"departure\":\"");
+            putDateTime(renderer, flight->departure, 1);
+            PUT_LITERAL(renderer, "\",\"arrival\":\"");
+            putDateTime(renderer, flight->arrival, 1);
+            PUT_LITERAL(renderer, "\",\"status\":\"");
+            putStatus(renderer, codeStatus, flight->status);
+            PUT_LITERAL(renderer, "\",\"availableSeats\":");
+            putInt(renderer, flight->availableSeats, 1);
+            PUT_LITERAL(renderer, "}");
+            break;
+        default:
+            PUT_LITERAL(renderer, "\nFlight ID      : ");
+            putInt(renderer, flight->flightID, 1);
+            PUT_LITERAL(renderer, "\nName           : ");
+            putText(renderer, flight->flightName, sizeof(flight->flightName));
+            PUT_LITERAL(renderer, "\nFrom           : ");
+            putText(renderer, flight->origin, sizeof(flight->origin));
+            PUT_LITERAL(renderer, "\nTo             : ");
+            putText(renderer, flight->destination, sizeof(flight->destination));
+            PUT_LITERAL(renderer, "\nDeparture      : ");
+            putDateTime(renderer, flight->departure, 0);
+            PUT_LITERAL(renderer, "\nArrival        : ");
+            putDateTime(renderer, flight->arrival, 0);
+            PUT_LITERAL(renderer, "\nStatus         : ");
+            putStatus(renderer, plainStatus, flight->status);
+            PUT_LITERAL(renderer, "\nSeats Available: ");
+            putInt(renderer, flight->availableSeats, 1);
+            PUT_LITERAL(renderer, "\n");
+            break;
+    }
+    renderer->records++;
+}
+
+/**
+ * @brief Appends one passenger (numbered in plain format).
+ *
+ * @param renderer A listing of RENDER_PASSENGERS.
+ * @param passenger The passenger.
+ */
+void renderPassenger(Renderer *renderer, const Passenger *passenger) {
+    reserveRecord(renderer);
+    switch (renderer->format) {
+        case RENDER_CSV:
+            putCsvField(renderer, passenger->name, sizeof(passenger->name));
+            PUT_LITERAL(renderer, ",");
+            putInt(renderer, passenger->age, 1);
+            PUT_LITERAL(renderer, ",");
+            putCsvField(renderer, passenger->passport, sizeof(passenger->passport));
+            PUT_LITERAL(renderer, ",");
+            putInt(renderer, passenger->assignedFlightID, 1);
+            PUT_LITERAL(renderer, ",");
+            putInt(renderer, passenger->assignedSeatNo, 1);
+            PUT_LITERAL(renderer, "\n");
+            break;
+        case RENDER_JSON:
+            beginJsonObject(renderer);
+            PUT_LITERAL(renderer, "\"name\":");
+            putJsonString(renderer, passenger->name, sizeof(passenger->name));
+            PUT_LITERAL(renderer, ",\"age\":");
+            putInt(renderer, passenger->age, 1);
+            PUT_LITERAL(renderer, ",\"passport\":");
+            putJsonString(renderer, passenger->passport, sizeof(passenger->passport));
+            PUT_LITERAL(renderer, ",\"assignedFlightID\":");
+            putInt(renderer, passenger->assignedFlightID, 1);
+            PUT_LITERAL(renderer, ",\"assignedSeatNo\":");
+            putInt(renderer, passenger->assignedSeatNo, 1);
+            PUT_LITERAL(renderer, "}");
+            break;
+        default:
+            PUT_LITERAL(renderer, "Passenger ");
+            putInt(renderer, renderer->records + 1, 1);
+            PUT_LITERAL(renderer, ":\n  Name       : ");
+            putText(renderer, passenger->name, sizeof(passenger->name));
+            PUT_LITERAL(renderer, "\n  Age        : ");
+            putInt(renderer, passenger->age, 1);
+            PUT_LITERAL(renderer, "\n  Passport   : ");
+            putText(renderer, passenger->passport, sizeof(passenger->passport));
+            if (passenger->assignedFlightID != 0) {
+                PUT_LITERAL(renderer, "\n  Flight ID  : ");
+                putInt(renderer, passenger->assignedFlightID, 1);
+                PUT_LITERAL(renderer, "\n  Seat No    : ");
+                putInt(renderer, passenger->assignedSeatNo, 1);
+            } else {
+                PUT_LITERAL(renderer, "\n  Flight ID  : Not assigned\n  Seat No    : Not assigned");
+            }
+            PUT_LITERAL(renderer, "\n----------------------------\n");
+            break;
+    }
+    renderer->records++;
+}
+
+/**
+ * @brief Appends one ticket.
+ *
+ * @param renderer A listing of RENDER_TICKETS.
+ * @param ticket The ticket.
+ */
+void renderTicket(Renderer *renderer, const Ticket *ticket) {
+    reserveRecord(renderer);
+    switch (renderer->format) {
+        case RENDER_CSV:
+            putInt(renderer, ticket->ticketID, 1);
+            PUT_LITERAL(renderer, ",");
+            putCsvField(renderer, ticket->passengerName, sizeof(ticket->passengerName));
+            PUT_LITERAL(renderer, ",");
+            putInt(renderer, ticket->flightID, 1);
+            PUT_LITERAL(renderer, ",");
+            putInt(renderer, ticket->seatNo, 1);
+            PUT_LITERAL(renderer, "\n");
+            break;
+        case RENDER_JSON:
+            beginJsonObject(renderer);
+            PUT_LITERAL(renderer, "\"ticketID\":");
+            putInt(renderer, ticket->ticketID, 1);
+            PUT_LITERAL(renderer, ",\"passengerName\":");
+            putJsonString(renderer, ticket->passengerName, sizeof(ticket->passengerName));
+            PUT_LITERAL(renderer, ",\"flightID\":");
+            putInt(renderer, ticket->flightID, 1);
+            PUT_LITERAL(renderer, ",\"seatNo\":");
+            putInt(renderer, ticket->seatNo, 1);
+            PUT_LITERAL(renderer, "}");
+            break;
+        default:
+            PUT_LITERAL(renderer, "Ticket ID: ");
+            putInt(renderer, ticket->ticketID, 1);
+            PUT_LITERAL(renderer, " | Passenger: ");
+            putText(renderer, ticket->passengerName, sizeof(ticket->passengerName));
+            PUT_LITERAL(renderer, " | Flight ID: ");
+            putInt(renderer, ticket->flightID, 1);
+            PUT_LITERAL(renderer, " | Seat: ");
+            putInt(renderer, ticket->seatNo, 1);
+            PUT_LITERAL(renderer, "\n");
+            break;
+    }
+    renderer->records++;
+}
+
+/**
+ * @brief Finishes the listing, writes everything pending, flushes the stream and frees the buffer.
+ *
+ * @param renderer The listing.
+ * @return 1 on success, 0 if any write failed.
+ */
+int endRender(Renderer *renderer) {
+    if (renderer->buffer == NULL) {
+        return 0;
+    }
+    if (renderer->format == RENDER_JSON) {
+        reserveRecord(renderer);
+        if (renderer->records > 0) {
+            PUT_LITERAL(renderer, "\n");
+        }
+        PUT_LITERAL(renderer, "]\n");
+    }
+    flushBuffer(renderer);
+    if (fflush(renderer->out) != 0) {
+        renderer->failed = 1;
+    }
+    trackedFree(MEM_OTHER, renderer->buffer);
+    renderer->buffer = NULL;
+    return !renderer->failed;
+}
+
+/**
+ * @brief Renders a whole flight table.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param flights The flights.
+ * @param flightCount The number of flights.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderFlights(FILE *out, RenderFormat format, const Flight *flights, int flightCount) {
+    Renderer renderer;
+    if (!beginRender(&renderer, out, format, RENDER_FLIGHTS)) {
+        return 0;
+    }
+    for (int i = 0; i < flightCount; i++) {
+        renderFlight(&renderer, flights + i);
+    }
+    return endRender(&renderer);
+}
+
+/**
+ * @brief Renders selected flights, e.g. the matches of a query.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param flights The flights.
+ * @param indexes The positions of the flights to render, in order.
+ * @param count The number of positions.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderFlightSelection(FILE *out, RenderFormat format, const Flight *flights, const int *indexes, int count) {
+    Renderer renderer;
+    if (!beginRender(&renderer, out, format, RENDER_FLIGHTS)) {
+        return 0;
+    }
+    if (format == RENDER_PLAIN) {
+        renderer.length = 0; // Replace the whole-table title
+        PUT_LITERAL(&renderer, "\n---- Matching Flights ----\n");
+    }
+    for (int i = 0; i < count; i++) {
+        renderFlight(&renderer, flights + indexes[i]);
+    }
+    return endRender(&renderer);
+}
+
+/**
+ * @brief Renders a whole passenger table.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param passengers The passengers.
+ * @param passengerCount The number of passengers.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderPassengers(FILE *out, RenderFormat format, const Passenger *passengers, int passengerCount) {
+    Renderer renderer;
+    if (!beginRender(&renderer, out, format, RENDER_PASSENGERS)) {
+        return 0;
+    }
+    for (int i = 0; i < passengerCount; i++) {
+        renderPassenger(&renderer, passengers + i);
+    }
+    return endRender(&renderer);
+}
+
+/**
+ * @brief Renders a whole ticket table.
+ *
+ * @param out The destination stream.
+ * @param format The output format.
+ * @param tickets The tickets.
+ * @param ticketCount The number of tickets.
+ * @return 1 on success, 0 on failure (e.g., allocation or write failed).
+ */
+int renderTickets(FILE *out, RenderFormat format, const Ticket *tickets, int ticketCount) {
+    Renderer renderer;
+    if (!beginRender(&renderer, out, format, RENDER_TICKETS)) {
+        return 0;
+    }
+    for (int i = 0; i < ticketCount; i++) {
+        renderTicket(&renderer, tickets + i);
+    }
+    return endRender(&renderer);
+}
+
+/**
+ * @brief Returns the usual file extension of a format.
+ *
+ * @param format The format.
+ * @return "txt", "csv" or "json".
+ */
+const char *renderFormatExtension(RenderFormat format) {
+    switch (format) {
+        case RENDER_CSV: return "csv";
+        case RENDER_JSON: return "json";
+        default: return "txt";
+    }
+}
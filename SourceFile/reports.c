@@ -0,0 +1,596 @@
+/**
+ * @file reports.c
+ * @brief Implementation of the nightly analytics reports.
+ *
+ * The reports are computed in passes over the tables. The flight, ticket and
+ * passenger passes run in parallel over even ranges of records (the calling
+ * thread takes the first range). The grouping of flights by route and day
+ * runs on one thread, over the flat columns the flight pass produced.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For qsort
+#include <string.h>
+#include <stdint.h> // For uint32_t, uint64_t
+#include <pthread.h>
+
+#if !defined(_WIN32)
+#include <unistd.h> // For sysconf
+#endif
+
+#include "reports.h"
+#include "flightindex.h"
+#include "memstats.h"
+
+/**
+ * @def REPORT_CHUNK
+ * @brief Records a worker copies into its local column before aggregating them.
+ */
+#define REPORT_CHUNK 4096
+
+/**
+ * @def REPORT_BUFFER_SIZE
+ * @brief stdio buffer size of each report file.
+ */
+#define REPORT_BUFFER_SIZE (1 << 20)
+
+/**
+ * @struct ReportTask
+ * @brief One worker's range of records and its partial results.
+ */
+typedef struct {
+    int first;                              /**< First record of the range. */
+    int last;                               /**< One past the last record of the range. */
+    long long unmatched;                    /**< Tickets whose flight is not in the table. */
+    long long ages[REPORT_AGE_BANDS + 1];   /**< Passengers per age band; the last counts invalid ages. */
+} ReportTask;
+
+/**
+ * @struct ReportGroup
+ * @brief The flights of one route on one departure day.
+ */
+typedef struct {
+    int route;          /**< Route code. */
+    int day;            /**< Departure day (see departureDay). */
+    int firstRow;       /**< Table position of its first flight (for the route and date text). */
+    int flights;        /**< Flights in the group. */
+    long long booked;   /**< Seats booked on them. */
+    long long capacity; /**< Seats on them (booked plus free). */
+} ReportGroup;
+
+/**
+ * @struct ReportRun
+ * @brief The inputs and flat columns of the report being computed.
+ */
+typedef struct {
+    const Flight *flights;      /**< Flight table. */
+    int flightCount;            /**< Flights. */
+    const Passenger *passengers;/**< Passenger table. */
+    const Ticket *tickets;      /**< Ticket table. */
+    int *booked;                /**< Per flight: seats set in the seat map. */
+    int *capacity;              /**< Per flight: booked plus free seats. */
+    int *days;                  /**< Per flight: departure day. */
+    int *ticketCounts;          /**< Per flight: tickets issued for it. */
+    int *idSlots;               /**< Open-addressing table of flight position + 1 by ID (0 = empty). */
+    uint32_t idMask;            /**< Slots in idSlots minus one. */
+} ReportRun;
+
+static ReportRun run; /**< The report being computed. */
+
+/**
+ * @brief Hashes a flight ID.
+ *
+ * @param flightID The flight ID.
+ * @return The hash.
+ */
+static uint32_t hashID(int flightID) {
+    return (uint32_t)flightID * 2654435761u;
+}
+
+/**
+ * @brief Counts the booked seats in a seat map, eight bytes at a time.
+ *
+ * @param seatMap The seat map (SEAT_MAP_BYTES bytes).
+ * @return The number of bits set.
+ */
+static int countBookedSeats(const unsigned char *seatMap) {
+    int count = 0;
+    int b = 0;
+    for (; b + 8 <= SEAT_MAP_BYTES; b += 8) {
+        uint64_t word;
+        memcpy(&word, seatMap + b, sizeof(word));
+        count += __builtin_popcountll(word);
+    }
+    for (; b < SEAT_MAP_BYTES; b++) {
+        count += __builtin_popcount(seatMap[b]);
+    }
+    return count;
+}
+
+/**
+ * @brief Worker: fills the booked-seats, capacity and departure-day columns for a range of flights.
+ *
+ * @param arg The ReportTask.
+ * @return NULL.
+ */
+static void *flightWorker(void *arg) {
+    const ReportTask *task = (const ReportTask *)arg;
+    for (int i = task->first; i < task->last; i++) {
+        run.booked[i] = countBookedSeats(run.flights[i].seatMap);
+        int available = run.flights[i].availableSeats;
+        if (available < 0) {
+            available = 0;
+        } else if (available > MAX_PASSENGERS_PER_FLIGHT - run.booked[i]) {
+            available = MAX_PASSENGERS_PER_FLIGHT - run.booked[i];
+        }
+        run.capacity[i] = run.booked[i] + available;
+        run.days[i] = departureDay(&run.flights[i].departure);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds the table position of a flight ID.
+ *
+ * @param flightID The flight ID.
+ * @return The position, or -1 if the table has no such flight.
+ */
+static int findRow(int flightID) {
+    for (uint32_t i = hashID(flightID) & run.idMask; run.idSlots[i] != 0; i = (i + 1) & run.idMask) {
+        int row = run.idSlots[i] - 1;
+        if (run.flights[row].flightID == flightID) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Worker: counts the tickets of a range per flight.
+ *
+ * Flight IDs are copied into a local column a chunk at a time, so the hash
+ * probes run over contiguous integers instead of strided ticket records.
+ *
+ * @param arg The ReportTask.
+ * @return NULL.
+ */
+static void *ticketWorker(void *arg) {
+    ReportTask *task = (ReportTask *)arg;
+    int ids[REPORT_CHUNK];
+    for (int start = task->first; start < task->last; start += REPORT_CHUNK) {
+        int n = task->last - start < REPORT_CHUNK ? task->last - start : REPORT_CHUNK;
+        for (int i = 0; i < n; i++) {
+            ids[i] = run.tickets[start + i].flightID;
+        }
+        for (int i = 0; i < n; i++) {
+            int row = findRow(ids[i]);
+            if (row >= 0) {
+                __atomic_fetch_add(&run.ticketCounts[row], 1, __ATOMIC_RELAXED);
+            } else {
+                task->unmatched++;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Worker: counts the passengers of a range per age band.
+ *
+ * @param arg The ReportTask.
+ * @return NULL.
+ */
+static void *passengerWorker(void *arg) {
+    ReportTask *task = (ReportTask *)arg;
+    int ages[REPORT_CHUNK];
+    for (int start = task->first; start < task->last; start += REPORT_CHUNK) {
+        int n = task->last - start < REPORT_CHUNK ? task->last - start : REPORT_CHUNK;
+        for (int i = 0; i < n; i++) {
+            ages[i] = run.passengers[start + i].age;
+        }
+        for (int i = 0; i < n; i++) {
+            int band = ages[i] < 0 ? REPORT_AGE_BANDS : ages[i] / 10;
+            task->ages[band < REPORT_AGE_BANDS ? band : REPORT_AGE_BANDS - 1]++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs a worker over [0, records) split evenly across threads.
+ *
+ * @param worker The worker function.
+ * @param tasks The per-thread tasks (partial results are reset).
+ * @param threads The number of threads.
+ * @param records The number of records.
+ */
+static void runParallel(void *(*worker)(void *), ReportTask *tasks, int threads, int records) {
+    pthread_t handles[REPORT_MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        memset(&tasks[t], 0, sizeof(tasks[t]));
+        tasks[t].first = (int)((long long)records * t / threads);
+        tasks[t].last = (int)((long long)records * (t + 1) / threads);
+    }
+    int started = 0;
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&handles[t], NULL, worker, &tasks[t]) != 0) {
+            break;
+        }
+        started = t;
+    }
+    worker(&tasks[0]);
+    for (int t = 1; t <= started; t++) {
+        pthread_join(handles[t], NULL);
+    }
+    for (int t = started + 1; t < threads; t++) { // Threads that could not be started
+        worker(&tasks[t]);
+    }
+}
+
+/**
+ * @brief Builds the flight ID hash used by the ticket pass (the first flight of a repeated ID wins).
+ *
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int buildIDSlots() {
+    uint32_t slots = 16;
+    while (slots < (uint32_t)run.flightCount * 2 + 2) {
+        slots *= 2;
+    }
+    run.idSlots = (int *)trackedMalloc(MEM_OTHER, (size_t)slots * sizeof(int));
+    if (run.idSlots == NULL) {
+        return 0;
+    }
+    memset(run.idSlots, 0, (size_t)slots * sizeof(int));
+    run.idMask = slots - 1;
+    for (int row = 0; row < run.flightCount; row++) {
+        int flightID = run.flights[row].flightID;
+        uint32_t i = hashID(flightID) & run.idMask;
+        while (run.idSlots[i] != 0 && run.flights[run.idSlots[i] - 1].flightID != flightID) {
+            i = (i + 1) & run.idMask;
+        }
+        if (run.idSlots[i] == 0) {
+            run.idSlots[i] = row + 1;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Hashes a route (FNV-1a over origin, a separator and destination).
+ *
+ * @param f The flight whose route is hashed.
+ * @return The hash.
+ */
+static uint32_t hashRoute(const Flight *f) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = f->origin; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    hash = (hash ^ 0xFFu) * 16777619u;
+    for (const char *p = f->destination; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Groups the flights by route and departure day and sums their booked seats.
+ *
+ * Routes get dense codes through one hash, then (route, day) pairs get group
+ * numbers through another, so the grouping touches each flight's strings
+ * once and everything after that works on integers.
+ *
+ * @param groups Receives the groups (trackedMalloc'd, MEM_OTHER; the caller frees them).
+ * @return The number of groups, or -1 if memory allocation failed.
+ */
+static int groupFlights(ReportGroup **groups) {
+    uint32_t slots = 16;
+    while (slots < (uint32_t)run.flightCount * 2 + 2) {
+        slots *= 2;
+    }
+    uint32_t mask = slots - 1;
+    int *routeSlots = (int *)trackedMalloc(MEM_OTHER, (size_t)slots * sizeof(int));     // First row + 1 of a route
+    int *routeCodes = (int *)trackedMalloc(MEM_OTHER, (size_t)slots * sizeof(int));     // Its code
+    int *groupSlots = (int *)trackedMalloc(MEM_OTHER, (size_t)slots * sizeof(int));     // Group number + 1
+    ReportGroup *list = (ReportGroup *)trackedMalloc(MEM_OTHER, (size_t)(run.flightCount > 0 ? run.flightCount : 1) * sizeof(ReportGroup));
+    int count = -1;
+    if (routeSlots != NULL && routeCodes != NULL && groupSlots != NULL && list != NULL) {
+        memset(routeSlots, 0, (size_t)slots * sizeof(int));
+        memset(groupSlots, 0, (size_t)slots * sizeof(int));
+        int routes = 0;
+        count = 0;
+        for (int row = 0; row < run.flightCount; row++) {
+            const Flight *f = run.flights + row;
+            uint32_t i = hashRoute(f) & mask;
+            while (routeSlots[i] != 0) {
+                const Flight *g = run.flights + routeSlots[i] - 1;
+                if (strcmp(g->origin, f->origin) == 0 && strcmp(g->destination, f->destination) == 0) {
+                    break;
+                }
+                i = (i + 1) & mask;
+            }
+            if (routeSlots[i] == 0) {
+                routeSlots[i] = row + 1;
+                routeCodes[i] = routes++;
+            }
+            int route = routeCodes[i];
+            int day = run.days[row];
+            uint32_t j = (uint32_t)(((uint64_t)(uint32_t)route << 32 | (uint32_t)day) * 0x9E3779B97F4A7C15ull >> 32) & mask;
+            while (groupSlots[j] != 0 && (list[groupSlots[j] - 1].route != route || list[groupSlots[j] - 1].day != day)) {
+                j = (j + 1) & mask;
+            }
+            if (groupSlots[j] == 0) {
+                groupSlots[j] = count + 1;
+                list[count].route = route;
+                list[count].day = day;
+                list[count].firstRow = row;
+                list[count].flights = 0;
+                list[count].booked = 0;
+                list[count].capacity = 0;
+                count++;
+            }
+            ReportGroup *group = list + groupSlots[j] - 1;
+            group->flights++;
+            group->booked += run.booked[row];
+            group->capacity += run.capacity[row];
+        }
+    }
+    trackedFree(MEM_OTHER, routeSlots);
+    trackedFree(MEM_OTHER, routeCodes);
+    trackedFree(MEM_OTHER, groupSlots);
+    if (count < 0) {
+        trackedFree(MEM_OTHER, list);
+        list = NULL;
+    }
+    *groups = list;
+    return count;
+}
+
+/**
+ * @brief Orders groups by origin, destination, then day (qsort callback).
+ *
+ * @param a A pointer to the first ReportGroup.
+ * @param b A pointer to the second ReportGroup.
+ * @return Negative, zero or positive as a sorts before, with or after b.
+ */
+static int compareGroups(const void *a, const void *b) {
+    const ReportGroup *x = (const ReportGroup *)a;
+    const ReportGroup *y = (const ReportGroup *)b;
+    const Flight *fx = run.flights + x->firstRow;
+    const Flight *fy = run.flights + y->firstRow;
+    int order = strcmp(fx->origin, fy->origin);
+    if (order == 0) {
+        order = strcmp(fx->destination, fy->destination);
+    }
+    if (order == 0) {
+        order = (x->day > y->day) - (x->day < y->day);
+    }
+    return order;
+}
+
+/**
+ * @brief Writes a CSV field, quoting it if it contains a comma, quote or line break.
+ *
+ * @param fp The file.
+ * @param text The field text.
+ */
+static void putCsvField(FILE *fp, const char *text) {
+    if (strpbrk(text, ",\"\r\n") == NULL) {
+        fputs(text, fp);
+        return;
+    }
+    fputc('"', fp);
+    for (const char *p = text; *p != '\0'; p++) {
+        if (*p == '"') {
+            fputc('"', fp);
+        }
+        fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+
+/**
+ * @brief Opens one report file in the output directory.
+ *
+ * @param directory The directory.
+ * @param name The file name.
+ * @param header The CSV header row (without the line break).
+ * @return The open file, or NULL if it could not be opened.
+ */
+static FILE *openReport(const char *directory, const char *name, const char *header) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", directory, name);
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open %s for writing.\n", path);
+        return NULL;
+    }
+    setvbuf(fp, NULL, _IOFBF, REPORT_BUFFER_SIZE);
+    fprintf(fp, "%s\n", header);
+    return fp;
+}
+
+/**
+ * @brief Closes a report file, reporting write errors.
+ *
+ * @param fp The file (may be NULL).
+ * @param name The file name (for the error message).
+ * @return 1 if the file was written completely, 0 otherwise.
+ */
+static int closeReport(FILE *fp, const char *name) {
+    if (fp == NULL) {
+        return 0;
+    }
+    int ok = !ferror(fp);
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        printf("Error: Could not write %s.\n", name);
+    }
+    return ok;
+}
+
+/**
+ * @brief Writes the per-flight load factor and tickets-per-flight reports.
+ *
+ * @param directory The output directory.
+ * @return 1 on success, 0 on failure.
+ */
+static int writeFlightReports(const char *directory) {
+    FILE *load = openReport(directory, "report_load_factor.csv",
+                            "flightID,flightName,origin,destination,departure,seatsBooked,seatCapacity,loadFactor");
+    FILE *tickets = openReport(directory, "report_tickets_per_flight.csv", "flightID,tickets");
+    if (load != NULL && tickets != NULL) {
+        for (int i = 0; i < run.flightCount; i++) {
+            const Flight *f = run.flights + i;
+            fprintf(load, "%d,", f->flightID);
+            putCsvField(load, f->flightName);
+            fputc(',', load);
+            putCsvField(load, f->origin);
+            fputc(',', load);
+            putCsvField(load, f->destination);
+            fprintf(load, ",%04u-%02u-%02uT%02u:%02u,%d,%d,%.4f\n",
+                    f->departure.year, f->departure.month, f->departure.day, f->departure.hour, f->departure.minute,
+                    run.booked[i], run.capacity[i],
+                    run.capacity[i] > 0 ? (double)run.booked[i] / run.capacity[i] : 0.0);
+            fprintf(tickets, "%d,%d\n", f->flightID, run.ticketCounts[i]);
+        }
+    }
+    int ok = closeReport(load, "report_load_factor.csv");
+    return closeReport(tickets, "report_tickets_per_flight.csv") && ok;
+}
+
+/**
+ * @brief Writes the per-route-and-day occupancy report.
+ *
+ * @param directory The output directory.
+ * @param groups The groups (sorted here).
+ * @param groupCount The number of groups.
+ * @return 1 on success, 0 on failure.
+ */
+static int writeOccupancyReport(const char *directory, ReportGroup *groups, int groupCount) {
+    qsort(groups, (size_t)groupCount, sizeof(ReportGroup), compareGroups);
+    FILE *fp = openReport(directory, "report_occupancy.csv",
+                          "origin,destination,date,flights,seatsBooked,seatCapacity,occupancy");
+    if (fp != NULL) {
+        for (int g = 0; g < groupCount; g++) {
+            const ReportGroup *group = groups + g;
+            const Flight *f = run.flights + group->firstRow;
+            putCsvField(fp, f->origin);
+            fputc(',', fp);
+            putCsvField(fp, f->destination);
+            fprintf(fp, ",%04u-%02u-%02u,%d,%lld,%lld,%.4f\n",
+                    f->departure.year, f->departure.month, f->departure.day,
+                    group->flights, group->booked, group->capacity,
+                    group->capacity > 0 ? (double)group->booked / (double)group->capacity : 0.0);
+        }
+    }
+    return closeReport(fp, "report_occupancy.csv");
+}
+
+/**
+ * @brief Writes the passenger age distribution report.
+ *
+ * @param directory The output directory.
+ * @param ages Passengers per age band (the last entry counts invalid ages).
+ * @param passengerCount The number of passengers.
+ * @return 1 on success, 0 on failure.
+ */
+static int writeAgeReport(const char *directory, const long long *ages, int passengerCount) {
+    FILE *fp = openReport(directory, "report_ages.csv", "ageBand,passengers,share");
+    if (fp != NULL) {
+        for (int band = 0; band <= REPORT_AGE_BANDS; band++) {
+            double share = passengerCount > 0 ? (double)ages[band] / passengerCount : 0.0;
+            if (band == REPORT_AGE_BANDS) {
+                fprintf(fp, "invalid,%lld,%.4f\n", ages[band], share);
+            } else if (band == REPORT_AGE_BANDS - 1) {
+                fprintf(fp, "%d+,%lld,%.4f\n", band * 10, ages[band], share);
+            } else {
+                fprintf(fp, "%d-%d,%lld,%.4f\n", band * 10, band * 10 + 9, ages[band], share);
+            }
+        }
+    }
+    return closeReport(fp, "report_ages.csv");
+}
+
+/**
+ * @brief Computes the analytics reports and writes them as CSV files.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param passengers The passenger array.
+ * @param passengerCount The number of passengers.
+ * @param tickets The ticket array.
+ * @param ticketCount The number of tickets.
+ * @param directory The directory the files are written to.
+ * @param threads Worker threads (0 for one per online CPU, at most REPORT_MAX_THREADS).
+ * @return 1 on success, 0 on failure (e.g., memory allocation failed, a file could not be written).
+ */
+int writeAnalyticsReports(const Flight *flights, int flightCount, const Passenger *passengers, int passengerCount,
+                          const Ticket *tickets, int ticketCount, const char *directory, int threads) {
+    if (threads <= 0) {
+#if !defined(_WIN32)
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if (threads <= 0) {
+            threads = 1;
+        }
+    }
+    if (threads > REPORT_MAX_THREADS) {
+        threads = REPORT_MAX_THREADS;
+    }
+
+    memset(&run, 0, sizeof(run));
+    run.flights = flights;
+    run.flightCount = flightCount;
+    run.passengers = passengers;
+    run.tickets = tickets;
+    size_t columnBytes = (size_t)(flightCount > 0 ? flightCount : 1) * sizeof(int);
+    run.booked = (int *)trackedMalloc(MEM_OTHER, columnBytes);
+    run.capacity = (int *)trackedMalloc(MEM_OTHER, columnBytes);
+    run.days = (int *)trackedMalloc(MEM_OTHER, columnBytes);
+    run.ticketCounts = (int *)trackedMalloc(MEM_OTHER, columnBytes);
+    ReportTask tasks[REPORT_MAX_THREADS];
+    ReportGroup *groups = NULL;
+    int groupCount = -1;
+    long long unmatched = 0;
+    long long ages[REPORT_AGE_BANDS + 1] = { 0 };
+    int ok = run.booked != NULL && run.capacity != NULL && run.days != NULL && run.ticketCounts != NULL && buildIDSlots();
+    if (ok) {
+        memset(run.ticketCounts, 0, columnBytes);
+        runParallel(flightWorker, tasks, threads, flightCount);
+        runParallel(ticketWorker, tasks, threads, ticketCount);
+        for (int t = 0; t < threads; t++) {
+            unmatched += tasks[t].unmatched;
+        }
+        runParallel(passengerWorker, tasks, threads, passengerCount);
+        for (int t = 0; t < threads; t++) {
+            for (int band = 0; band <= REPORT_AGE_BANDS; band++) {
+                ages[band] += tasks[t].ages[band];
+            }
+        }
+        groupCount = groupFlights(&groups);
+        ok = groupCount >= 0;
+    }
+    if (!ok) {
+        printf("Error: Could not allocate memory for the reports.\n");
+    } else {
+        ok = writeFlightReports(directory);
+        ok = writeOccupancyReport(directory, groups, groupCount) && ok;
+        ok = writeAgeReport(directory, ages, passengerCount) && ok;
+    }
+    if (ok && unmatched > 0) {
+        printf("Note: %lld ticket(s) refer to flights that are not in the table.\n", unmatched);
+    }
+    trackedFree(MEM_OTHER, groups);
+    trackedFree(MEM_OTHER, run.booked);
+    trackedFree(MEM_OTHER, run.capacity);
+    trackedFree(MEM_OTHER, run.days);
+    trackedFree(MEM_OTHER, run.ticketCounts);
+    trackedFree(MEM_OTHER, run.idSlots);
+    memset(&run, 0, sizeof(run));
+    return ok;
+}
@@ -0,0 +1,407 @@
+/**
+ * @file resultcache.c
+ * @brief Implementation of the versioned cache of rendered protocol responses.
+ *
+ * Responses live in a set-associative table: the hash of the normalized
+ * request picks a set of RESULT_CACHE_WAYS entries. Each entry owns a copy of
+ * the response text and the (slot, version) pairs it depends on. Versions are
+ * values of one change counter: bumping a slot stores the next count in it,
+ * so a slot never returns to a value an entry remembers. The hooks follow the
+ * rule of the flight index (flightindex.c): a change is tracked only when the
+ * cache has seen every change before it, otherwise the next lookup starts
+ * over with an empty cache.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h> // For uint32_t
+#include <pthread.h>
+
+#include "resultcache.h"
+#include "flight.h"
+#include "inventory.h"
+#include "memstats.h"
+
+/**
+ * @struct CacheDependency
+ * @brief One version a cached response was computed against.
+ */
+typedef struct {
+    CacheKey slot;          /**< The version slot. */
+    unsigned long version;  /**< Its value when the response was stored. */
+} CacheDependency;
+
+/**
+ * @struct CacheEntry
+ * @brief One cached response.
+ */
+typedef struct {
+    int used;                           /**< 1 if the entry holds a response. */
+    uint32_t hash;                      /**< Hash of the request. */
+    char request[RESULT_CACHE_KEY_LEN]; /**< The normalized request. */
+    char *response;                     /**< The response text (trackedMalloc'd). */
+    size_t length;                      /**< Bytes in response, excluding the terminator. */
+    CacheDependency *dependencies;      /**< What it was computed from (trackedMalloc'd). */
+    int dependencyCount;                /**< Entries in dependencies. */
+    unsigned long lastUse;              /**< useClock at the last hit or store. */
+} CacheEntry;
+
+/**
+ * @struct ResultCache
+ * @brief The cached responses and the versions they are checked against.
+ */
+typedef struct {
+    CacheEntry entries[RESULT_CACHE_SETS][RESULT_CACHE_WAYS]; /**< The responses, by set. */
+    unsigned long versions[RESULT_CACHE_VERSION_SLOTS];        /**< Version of each slot. */
+    unsigned long changes;          /**< Changes seen (the source of new versions and tokens). */
+    unsigned long useClock;         /**< Hits and stores so far (for least recently used). */
+    unsigned long tableVersion;     /**< flightTableVersion the cache has seen. */
+    unsigned long seatVersion;      /**< flightSeatVersion the cache has seen. */
+    unsigned long statusVersion;    /**< flightStatusVersion the cache has seen. */
+    int entryCount;                 /**< Entries in use. */
+    long long hits;                 /**< Lookups answered. */
+    long long misses;               /**< Lookups not answered. */
+} ResultCache;
+
+static ResultCache cache;   /**< The response cache. */
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER; /**< Guards cache. */
+
+/**
+ * @brief Hashes a string (FNV-1a), continuing from a previous hash.
+ *
+ * @param hash The hash so far (2166136261u to start).
+ * @param text The string.
+ * @return The new hash.
+ */
+static uint32_t hashText(uint32_t hash, const char *text) {
+    for (const char *p = text; *p != '\0'; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the key of one flight.
+ *
+ * @param flightID The ID of the flight.
+ * @return Its version slot.
+ */
+CacheKey cacheFlightKey(int flightID) {
+    uint32_t hash = (uint32_t)flightID * 2654435761u; // Fibonacci hashing spreads consecutive IDs
+    return (hash >> 16 ^ hash) & (RESULT_CACHE_VERSION_SLOTS - 1);
+}
+
+/**
+ * @brief Returns the key of one route.
+ *
+ * @param origin The origin.
+ * @param destination The destination.
+ * @return Its version slot.
+ */
+CacheKey cacheRouteKey(const char *origin, const char *destination) {
+    uint32_t hash = hashText(2166136261u, origin);
+    hash = hashText((hash ^ 0xFFu) * 16777619u, destination);
+    return hash & (RESULT_CACHE_VERSION_SLOTS - 1);
+}
+
+/**
+ * @brief Returns the key of a group of flights.
+ *
+ * @param group The group.
+ * @return Its version slot.
+ */
+CacheKey cacheGroupKey(CacheGroup group) {
+    return cacheFlightKey(-1 - (int)group); // Flight IDs are positive, so these never name a flight
+}
+
+/**
+ * @brief Frees one entry and marks it unused.
+ *
+ * @param entry The entry.
+ */
+static void dropEntry(CacheEntry *entry) {
+    if (entry->used) {
+        trackedFree(MEM_OTHER, entry->response);
+        trackedFree(MEM_OTHER, entry->dependencies);
+        memset(entry, 0, sizeof(*entry));
+        cache.entryCount--;
+    }
+}
+
+/**
+ * @brief Drops every entry if some change bypassed the hooks, and catches up with the version counters.
+ */
+static void checkSynced() {
+    unsigned long seatVersion = __atomic_load_n(&flightSeatVersion, __ATOMIC_ACQUIRE);
+    if (cache.tableVersion == flightTableVersion && cache.seatVersion == seatVersion &&
+        cache.statusVersion == flightStatusVersion) {
+        return;
+    }
+    for (int set = 0; set < RESULT_CACHE_SETS; set++) {
+        for (int way = 0; way < RESULT_CACHE_WAYS; way++) {
+            dropEntry(&cache.entries[set][way]);
+        }
+    }
+    cache.tableVersion = flightTableVersion;
+    cache.seatVersion = seatVersion;
+    cache.statusVersion = flightStatusVersion;
+    cache.changes++;
+}
+
+/**
+ * @brief Tells whether an entry's versions are all unchanged.
+ *
+ * @param entry The entry.
+ * @return 1 if it is valid, 0 otherwise.
+ */
+static int entryValid(const CacheEntry *entry) {
+    for (int i = 0; i < entry->dependencyCount; i++) {
+        if (cache.versions[entry->dependencies[i].slot] != entry->dependencies[i].version) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Copies the cached response of a normalized request, if it is still valid.
+ *
+ * @param request The normalized request.
+ * @param response Receives the response text.
+ * @param size The size of response.
+ * @return 1 on a hit, 0 on a miss (not cached, stale or larger than size).
+ */
+int lookupCachedResult(const char *request, char *response, size_t size) {
+    uint32_t hash = hashText(2166136261u, request);
+    int hit = 0;
+    pthread_mutex_lock(&cacheLock);
+    checkSynced();
+    CacheEntry *set = cache.entries[hash & (RESULT_CACHE_SETS - 1)];
+    for (int way = 0; way < RESULT_CACHE_WAYS; way++) {
+        CacheEntry *entry = set + way;
+        if (!entry->used || entry->hash != hash || strcmp(entry->request, request) != 0) {
+            continue;
+        }
+        if (!entryValid(entry)) {
+            dropEntry(entry);
+        } else if (entry->length < size) {
+            memcpy(response, entry->response, entry->length + 1);
+            entry->lastUse = ++cache.useClock;
+            hit = 1;
+        }
+        break;
+    }
+    if (hit) {
+        cache.hits++;
+    } else {
+        cache.misses++;
+    }
+    pthread_mutex_unlock(&cacheLock);
+    return hit;
+}
+
+/**
+ * @brief Returns the token to pass to storeCachedResult; take it before computing the response.
+ *
+ * @return The number of changes seen so far.
+ */
+unsigned long resultCacheToken() {
+    pthread_mutex_lock(&cacheLock);
+    checkSynced();
+    unsigned long token = cache.changes;
+    pthread_mutex_unlock(&cacheLock);
+    return token;
+}
+
+/**
+ * @brief Caches the response of a normalized request.
+ *
+ * @param request The normalized request.
+ * @param response The response text.
+ * @param keys What the response was computed from.
+ * @param keyCount The number of keys.
+ * @param token The value resultCacheToken returned before the response was computed.
+ */
+void storeCachedResult(const char *request, const char *response, const CacheKey *keys, int keyCount,
+                       unsigned long token) {
+    size_t requestLength = strlen(request);
+    if (requestLength >= RESULT_CACHE_KEY_LEN) {
+        return;
+    }
+    size_t length = strlen(response);
+    char *text = (char *)trackedMalloc(MEM_OTHER, length + 1);
+    CacheDependency *dependencies =
+        (CacheDependency *)trackedMalloc(MEM_OTHER, (size_t)(keyCount > 0 ? keyCount : 1) * sizeof(CacheDependency));
+    if (text == NULL || dependencies == NULL) {
+        trackedFree(MEM_OTHER, text);
+        trackedFree(MEM_OTHER, dependencies);
+        return; // Not caching is always correct
+    }
+    memcpy(text, response, length + 1);
+
+    uint32_t hash = hashText(2166136261u, request);
+    pthread_mutex_lock(&cacheLock);
+    checkSynced();
+    if (cache.changes != token) {
+        // Something changed while the response was computed; it may already be stale
+        pthread_mutex_unlock(&cacheLock);
+        trackedFree(MEM_OTHER, text);
+        trackedFree(MEM_OTHER, dependencies);
+        return;
+    }
+    for (int i = 0; i < keyCount; i++) {
+        dependencies[i].slot = keys[i];
+        dependencies[i].version = cache.versions[keys[i]];
+    }
+    // Replace the same request, else a free way, else the least recently used one
+    CacheEntry *set = cache.entries[hash & (RESULT_CACHE_SETS - 1)];
+    CacheEntry *victim = set;
+    for (int way = 0; way < RESULT_CACHE_WAYS; way++) {
+        CacheEntry *entry = set + way;
+        if (entry->used && entry->hash == hash && strcmp(entry->request, request) == 0) {
+            victim = entry;
+            break;
+        }
+        if (victim->used && (!entry->used || entry->lastUse < victim->lastUse)) {
+            victim = entry;
+        }
+    }
+    dropEntry(victim);
+    victim->used = 1;
+    victim->hash = hash;
+    memcpy(victim->request, request, requestLength + 1);
+    victim->response = text;
+    victim->length = length;
+    victim->dependencies = dependencies;
+    victim->dependencyCount = keyCount;
+    victim->lastUse = ++cache.useClock;
+    cache.entryCount++;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * @brief Reads the cache counters.
+ *
+ * @param hits Receives the number of hits.
+ * @param misses Receives the number of misses.
+ * @param entries Receives the number of cached responses.
+ */
+void getResultCacheCounts(long long *hits, long long *misses, int *entries) {
+    pthread_mutex_lock(&cacheLock);
+    *hits = cache.hits;
+    *misses = cache.misses;
+    *entries = cache.entryCount;
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * @brief Bumps a version slot. Call with cacheLock held.
+ *
+ * @param slot The slot.
+ */
+static void bump(CacheKey slot) {
+    cache.versions[slot] = ++cache.changes;
+}
+
+/**
+ * @brief Bumps the versions of a flight, its route and every flight. Call with cacheLock held.
+ *
+ * @param flight The flight.
+ */
+static void bumpFlight(const Flight *flight) {
+    bump(cacheFlightKey(flight->flightID));
+    bump(cacheRouteKey(flight->origin, flight->destination));
+    bump(cacheGroupKey(CACHE_ALL_FLIGHTS));
+}
+
+/**
+ * @brief Hook: a flight was appended. Call before incrementing flightTableVersion.
+ *
+ * @param flight The new flight.
+ */
+void cacheFlightInserted(const Flight *flight) {
+    pthread_mutex_lock(&cacheLock);
+    cache.changes++; // Responses computed meanwhile must not be stored
+    if (cache.tableVersion == flightTableVersion) {
+        bumpFlight(flight);
+        bump(cacheGroupKey(CACHE_MEMBERSHIP));
+        cache.tableVersion = flightTableVersion + 1;
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * @brief Hook: a flight is being removed. Call before incrementing flightTableVersion.
+ *
+ * @param flight The flight being removed.
+ */
+void cacheFlightRemoved(const Flight *flight) {
+    pthread_mutex_lock(&cacheLock);
+    cache.changes++;
+    if (cache.tableVersion == flightTableVersion) {
+        bumpFlight(flight);
+        bump(cacheGroupKey(CACHE_MEMBERSHIP));
+        bump(cacheGroupKey(CACHE_ARRAY_ORDER)); // Later flights shift down one position
+        cache.tableVersion = flightTableVersion + 1;
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * @brief Hook: the flights were reordered. Call before incrementing flightTableVersion.
+ */
+void cacheFlightsReordered() {
+    pthread_mutex_lock(&cacheLock);
+    cache.changes++;
+    if (cache.tableVersion == flightTableVersion) {
+        bump(cacheGroupKey(CACHE_ARRAY_ORDER));
+        cache.tableVersion = flightTableVersion + 1;
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * @brief Hook: the status of a flight changed. Call before incrementing flightStatusVersion.
+ *
+ * @param flight The flight.
+ */
+void cacheFlightStatusChanged(const Flight *flight) {
+    pthread_mutex_lock(&cacheLock);
+    cache.changes++;
+    if (cache.statusVersion == flightStatusVersion) {
+        bumpFlight(flight);
+        cache.statusVersion = flightStatusVersion + 1;
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * @brief Hook: one seat of a flight was booked or cancelled.
+ *
+ * @param flight The flight.
+ * @param seatVersion The value flightSeatVersion was incremented to.
+ */
+void cacheSeatsChanged(const Flight *flight, unsigned long seatVersion) {
+    pthread_mutex_lock(&cacheLock);
+    cache.changes++;
+    if (cache.seatVersion == seatVersion - 1) {
+        // Bumping is safe even for a copy outside the table: it can only cause misses
+        bumpFlight(flight);
+        cache.seatVersion = seatVersion;
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
+
+/**
+ * @brief Frees every cached response.
+ */
+void cleanupResultCache() {
+    pthread_mutex_lock(&cacheLock);
+    for (int set = 0; set < RESULT_CACHE_SETS; set++) {
+        for (int way = 0; way < RESULT_CACHE_WAYS; way++) {
+            dropEntry(&cache.entries[set][way]);
+        }
+    }
+    pthread_mutex_unlock(&cacheLock);
+}
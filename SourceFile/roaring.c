@@ -0,0 +1,586 @@
+/**
+ * @file roaring.c
+ * @brief Implementation of compressed (roaring-style) bitmaps.
+ *
+ * Containers switch representation as they grow and shrink: an array
+ * container becomes a bitmap when it would exceed ROARING_ARRAY_MAX values,
+ * and a bitmap container goes back to an array once it holds no more than
+ * that. A container that becomes empty is removed, so every container in a
+ * bitmap holds at least one value.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <string.h>
+
+#include "roaring.h"
+#include "memstats.h"
+
+/**
+ * @brief Initializes an empty bitmap.
+ *
+ * @param r The bitmap.
+ */
+void initRoaring(Roaring *r) {
+    r->containers = NULL;
+    r->count = 0;
+    r->capacity = 0;
+}
+
+/**
+ * @brief Frees a container's array or bitmap.
+ *
+ * @param c The container.
+ */
+static void freeContainer(RoaringContainer *c) {
+    trackedFree(MEM_OTHER, c->values);
+    trackedFree(MEM_OTHER, c->words);
+    c->values = NULL;
+    c->words = NULL;
+    c->cardinality = 0;
+    c->capacity = 0;
+}
+
+/**
+ * @brief Frees a bitmap's memory and leaves it empty.
+ *
+ * @param r The bitmap.
+ */
+void freeRoaring(Roaring *r) {
+    for (int i = 0; i < r->count; i++) {
+        freeContainer(r->containers + i);
+    }
+    trackedFree(MEM_OTHER, r->containers);
+    initRoaring(r);
+}
+
+/**
+ * @brief Finds the container of a key.
+ *
+ * @param r The bitmap.
+ * @param key The key.
+ * @return The container's position, or -(insertion position) - 1 if absent.
+ */
+static int findContainer(const Roaring *r, uint16_t key) {
+    int low = 0, high = r->count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        uint16_t midKey = r->containers[mid].key;
+        if (midKey == key) {
+            return mid;
+        }
+        if (midKey < key) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -low - 1;
+}
+
+/**
+ * @brief Inserts an empty container at a position.
+ *
+ * @param r The bitmap.
+ * @param position Where the container goes (keeps the keys sorted).
+ * @param key The key.
+ * @return The new container, or NULL if memory allocation failed.
+ */
+static RoaringContainer *insertContainer(Roaring *r, int position, uint16_t key) {
+    if (r->count == r->capacity) {
+        int capacity = r->capacity > 0 ? r->capacity * 2 : 4;
+        RoaringContainer *grown = (RoaringContainer *)trackedRealloc(MEM_OTHER, r->containers,
+                                                                     (size_t)capacity * sizeof(RoaringContainer));
+        if (grown == NULL) {
+            return NULL;
+        }
+        r->containers = grown;
+        r->capacity = capacity;
+    }
+    memmove(r->containers + position + 1, r->containers + position,
+            (size_t)(r->count - position) * sizeof(RoaringContainer));
+    r->count++;
+    RoaringContainer *c = r->containers + position;
+    memset(c, 0, sizeof(*c));
+    c->key = key;
+    return c;
+}
+
+/**
+ * @brief Removes the container at a position.
+ *
+ * @param r The bitmap.
+ * @param position The container's position.
+ */
+static void removeContainer(Roaring *r, int position) {
+    freeContainer(r->containers + position);
+    memmove(r->containers + position, r->containers + position + 1,
+            (size_t)(r->count - position - 1) * sizeof(RoaringContainer));
+    r->count--;
+}
+
+/**
+ * @brief Counts the set bits of a bitmap container.
+ *
+ * @param words The bitmap.
+ * @return The number of set bits.
+ */
+static int countBits(const uint64_t *words) {
+    int bits = 0;
+    for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+        bits += __builtin_popcountll(words[i]);
+    }
+    return bits;
+}
+
+/**
+ * @brief Converts an array container to a bitmap container.
+ *
+ * @param c The container.
+ * @return 1 on success, 0 if memory allocation failed (the container is unchanged).
+ */
+static int toBitmap(RoaringContainer *c) {
+    uint64_t *words = (uint64_t *)trackedMalloc(MEM_OTHER, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    if (words == NULL) {
+        return 0;
+    }
+    memset(words, 0, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    for (int i = 0; i < c->cardinality; i++) {
+        words[c->values[i] >> 6] |= 1ULL << (c->values[i] & 63);
+    }
+    trackedFree(MEM_OTHER, c->values);
+    c->values = NULL;
+    c->capacity = 0;
+    c->words = words;
+    return 1;
+}
+
+/**
+ * @brief Converts a bitmap container back to an array once it is small enough.
+ *
+ * Keeps the bitmap if the array cannot be allocated; both forms are valid.
+ *
+ * @param c The container.
+ */
+static void shrinkToArray(RoaringContainer *c) {
+    if (c->words == NULL || c->cardinality > ROARING_ARRAY_MAX || c->cardinality == 0) {
+        return;
+    }
+    uint16_t *values = (uint16_t *)trackedMalloc(MEM_OTHER, (size_t)c->cardinality * sizeof(uint16_t));
+    if (values == NULL) {
+        return;
+    }
+    int n = 0;
+    for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+        for (uint64_t w = c->words[i]; w != 0; w &= w - 1) {
+            values[n++] = (uint16_t)(i * 64 + __builtin_ctzll(w));
+        }
+    }
+    trackedFree(MEM_OTHER, c->words);
+    c->words = NULL;
+    c->values = values;
+    c->capacity = c->cardinality;
+}
+
+/**
+ * @brief Finds a low half in an array container.
+ *
+ * @param c The array container.
+ * @param low The low half.
+ * @return Its position, or -(insertion position) - 1 if absent.
+ */
+static int findValue(const RoaringContainer *c, uint16_t low) {
+    int lo = 0, hi = c->cardinality - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (c->values[mid] == low) {
+            return mid;
+        }
+        if (c->values[mid] < low) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -lo - 1;
+}
+
+/**
+ * @brief Adds a low half to a container.
+ *
+ * @param c The container.
+ * @param low The low half.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int containerAdd(RoaringContainer *c, uint16_t low) {
+    if (c->words == NULL) {
+        int position = findValue(c, low);
+        if (position >= 0) {
+            return 1;
+        }
+        position = -position - 1;
+        if (c->cardinality == ROARING_ARRAY_MAX) {
+            if (!toBitmap(c)) {
+                return 0;
+            }
+        } else {
+            if (c->cardinality == c->capacity) {
+                int capacity = c->capacity > 0 ? c->capacity * 2 : 4;
+                capacity = capacity < ROARING_ARRAY_MAX ? capacity : ROARING_ARRAY_MAX;
+                uint16_t *grown = (uint16_t *)trackedRealloc(MEM_OTHER, c->values, (size_t)capacity * sizeof(uint16_t));
+                if (grown == NULL) {
+                    return 0;
+                }
+                c->values = grown;
+                c->capacity = capacity;
+            }
+            memmove(c->values + position + 1, c->values + position,
+                    (size_t)(c->cardinality - position) * sizeof(uint16_t));
+            c->values[position] = low;
+            c->cardinality++;
+            return 1;
+        }
+    }
+    uint64_t bit = 1ULL << (low & 63);
+    if ((c->words[low >> 6] & bit) == 0) {
+        c->words[low >> 6] |= bit;
+        c->cardinality++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds a value.
+ *
+ * @param r The bitmap.
+ * @param value The value.
+ * @return 1 on success (also if already present), 0 if memory allocation failed.
+ */
+int roaringAdd(Roaring *r, uint32_t value) {
+    uint16_t key = (uint16_t)(value >> 16);
+    int position = findContainer(r, key);
+    RoaringContainer *c;
+    if (position >= 0) {
+        c = r->containers + position;
+    } else {
+        position = -position - 1;
+        c = insertContainer(r, position, key);
+        if (c == NULL) {
+            return 0;
+        }
+    }
+    int added = containerAdd(c, (uint16_t)value);
+    if (c->cardinality == 0) {
+        removeContainer(r, position); // A new container whose first value could not be stored
+    }
+    return added;
+}
+
+/**
+ * @brief Removes a value if present.
+ *
+ * @param r The bitmap.
+ * @param value The value.
+ */
+void roaringRemove(Roaring *r, uint32_t value) {
+    int position = findContainer(r, (uint16_t)(value >> 16));
+    if (position < 0) {
+        return;
+    }
+    RoaringContainer *c = r->containers + position;
+    uint16_t low = (uint16_t)value;
+    if (c->words != NULL) {
+        uint64_t bit = 1ULL << (low & 63);
+        if ((c->words[low >> 6] & bit) == 0) {
+            return;
+        }
+        c->words[low >> 6] &= ~bit;
+        c->cardinality--;
+        shrinkToArray(c);
+    } else {
+        int at = findValue(c, low);
+        if (at < 0) {
+            return;
+        }
+        memmove(c->values + at, c->values + at + 1, (size_t)(c->cardinality - at - 1) * sizeof(uint16_t));
+        c->cardinality--;
+    }
+    if (c->cardinality == 0) {
+        removeContainer(r, position);
+    }
+}
+
+/**
+ * @brief Tests whether a value is present.
+ *
+ * @param r The bitmap.
+ * @param value The value.
+ * @return 1 if present, 0 otherwise.
+ */
+int roaringContains(const Roaring *r, uint32_t value) {
+    int position = findContainer(r, (uint16_t)(value >> 16));
+    if (position < 0) {
+        return 0;
+    }
+    const RoaringContainer *c = r->containers + position;
+    uint16_t low = (uint16_t)value;
+    if (c->words != NULL) {
+        return (int)((c->words[low >> 6] >> (low & 63)) & 1);
+    }
+    return findValue(c, low) >= 0;
+}
+
+/**
+ * @brief Counts the values.
+ *
+ * @param r The bitmap.
+ * @return The number of values.
+ */
+long long roaringCardinality(const Roaring *r) {
+    long long total = 0;
+    for (int i = 0; i < r->count; i++) {
+        total += r->containers[i].cardinality;
+    }
+    return total;
+}
+
+/**
+ * @brief Copies a container (array or bitmap) into an empty one.
+ *
+ * @param dst The empty container (its key is already set).
+ * @param src The container to copy.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int copyContainer(RoaringContainer *dst, const RoaringContainer *src) {
+    if (src->words != NULL) {
+        dst->words = (uint64_t *)trackedMalloc(MEM_OTHER, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+        if (dst->words == NULL) {
+            return 0;
+        }
+        memcpy(dst->words, src->words, ROARING_BITMAP_WORDS * sizeof(uint64_t));
+    } else {
+        dst->values = (uint16_t *)trackedMalloc(MEM_OTHER, (size_t)src->cardinality * sizeof(uint16_t));
+        if (dst->values == NULL) {
+            return 0;
+        }
+        memcpy(dst->values, src->values, (size_t)src->cardinality * sizeof(uint16_t));
+        dst->capacity = src->cardinality;
+    }
+    dst->cardinality = src->cardinality;
+    return 1;
+}
+
+/**
+ * @brief Adds the values of one container to another with the same key.
+ *
+ * @param c The container to extend.
+ * @param s The container to add.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+static int containerOr(RoaringContainer *c, const RoaringContainer *s) {
+    if (c->words == NULL && s->words == NULL && c->cardinality + s->cardinality <= ROARING_ARRAY_MAX) {
+        // Merge two sorted arrays into a new one
+        uint16_t *merged = (uint16_t *)trackedMalloc(MEM_OTHER, (size_t)(c->cardinality + s->cardinality) * sizeof(uint16_t));
+        if (merged == NULL) {
+            return 0;
+        }
+        int i = 0, j = 0, n = 0;
+        while (i < c->cardinality && j < s->cardinality) {
+            uint16_t a = c->values[i], b = s->values[j];
+            merged[n++] = a <= b ? a : b;
+            i += a <= b;
+            j += b <= a;
+        }
+        while (i < c->cardinality) merged[n++] = c->values[i++];
+        while (j < s->cardinality) merged[n++] = s->values[j++];
+        trackedFree(MEM_OTHER, c->values);
+        c->values = merged;
+        c->capacity = c->cardinality + s->cardinality;
+        c->cardinality = n;
+        return 1;
+    }
+    if (c->words == NULL && !toBitmap(c)) {
+        return 0;
+    }
+    if (s->words != NULL) {
+        for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+            c->words[i] |= s->words[i];
+        }
+        c->cardinality = countBits(c->words);
+    } else {
+        for (int i = 0; i < s->cardinality; i++) {
+            uint16_t low = s->values[i];
+            uint64_t bit = 1ULL << (low & 63);
+            c->cardinality += (c->words[low >> 6] & bit) == 0;
+            c->words[low >> 6] |= bit;
+        }
+    }
+    shrinkToArray(c); // Two overlapping arrays may still fit in one
+    return 1;
+}
+
+/**
+ * @brief Adds every value of src to dst (dst |= src).
+ *
+ * @param dst The bitmap to extend.
+ * @param src The bitmap to add.
+ * @return 1 on success, 0 if memory allocation failed (dst then holds part of the union).
+ */
+int roaringOrInPlace(Roaring *dst, const Roaring *src) {
+    for (int i = 0; i < src->count; i++) {
+        const RoaringContainer *s = src->containers + i;
+        int position = findContainer(dst, s->key);
+        if (position >= 0) {
+            if (!containerOr(dst->containers + position, s)) {
+                return 0;
+            }
+            continue;
+        }
+        position = -position - 1;
+        RoaringContainer *c = insertContainer(dst, position, s->key);
+        if (c == NULL) {
+            return 0;
+        }
+        if (!copyContainer(c, s)) {
+            removeContainer(dst, position);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Keeps the values of one container that are also in another with the same key.
+ *
+ * @param c The container to narrow.
+ * @param s The container to intersect with.
+ */
+static void containerAnd(RoaringContainer *c, const RoaringContainer *s) {
+    if (c->words != NULL && s->words != NULL) {
+        for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+            c->words[i] &= s->words[i];
+        }
+        c->cardinality = countBits(c->words);
+        shrinkToArray(c);
+        return;
+    }
+    if (c->words != NULL) {
+        // The result is a subset of s, so it fits in an array; filter s through c's bits
+        uint16_t *values = (uint16_t *)trackedMalloc(MEM_OTHER, (size_t)s->cardinality * sizeof(uint16_t));
+        if (values != NULL) {
+            int n = 0;
+            for (int i = 0; i < s->cardinality; i++) {
+                uint16_t low = s->values[i];
+                if ((c->words[low >> 6] >> (low & 63)) & 1) {
+                    values[n++] = low;
+                }
+            }
+            trackedFree(MEM_OTHER, c->words);
+            c->words = NULL;
+            c->values = values;
+            c->capacity = s->cardinality;
+            c->cardinality = n;
+            return;
+        }
+        // Out of memory: clear the bits that are not in s instead
+        uint64_t keep[ROARING_BITMAP_WORDS];
+        memset(keep, 0, sizeof(keep));
+        for (int i = 0; i < s->cardinality; i++) {
+            keep[s->values[i] >> 6] |= 1ULL << (s->values[i] & 63);
+        }
+        for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+            c->words[i] &= keep[i];
+        }
+        c->cardinality = countBits(c->words);
+        return;
+    }
+    int n = 0;
+    if (s->words != NULL) {
+        for (int i = 0; i < c->cardinality; i++) {
+            uint16_t low = c->values[i];
+            if ((s->words[low >> 6] >> (low & 63)) & 1) {
+                c->values[n++] = low;
+            }
+        }
+    } else {
+        int j = 0;
+        for (int i = 0; i < c->cardinality && j < s->cardinality; i++) {
+            while (j < s->cardinality && s->values[j] < c->values[i]) {
+                j++;
+            }
+            if (j < s->cardinality && s->values[j] == c->values[i]) {
+                c->values[n++] = c->values[i];
+            }
+        }
+    }
+    c->cardinality = n;
+}
+
+/**
+ * @brief Keeps only the values of dst that are also in src (dst &= src).
+ *
+ * @param dst The bitmap to narrow.
+ * @param src The bitmap to intersect with.
+ */
+void roaringAndInPlace(Roaring *dst, const Roaring *src) {
+    int kept = 0, j = 0;
+    for (int i = 0; i < dst->count; i++) {
+        RoaringContainer *c = dst->containers + i;
+        while (j < src->count && src->containers[j].key < c->key) {
+            j++;
+        }
+        if (j < src->count && src->containers[j].key == c->key) {
+            containerAnd(c, src->containers + j);
+        } else {
+            freeContainer(c);
+        }
+        if (c->cardinality > 0) {
+            dst->containers[kept++] = *c;
+        } else {
+            freeContainer(c);
+        }
+    }
+    dst->count = kept;
+}
+
+/**
+ * @brief Copies the values out in ascending order.
+ *
+ * @param r The bitmap.
+ * @param out Receives up to max values.
+ * @param max The capacity of out.
+ * @return The number of values written.
+ */
+int roaringToArray(const Roaring *r, uint32_t *out, int max) {
+    int n = 0;
+    for (int i = 0; i < r->count && n < max; i++) {
+        const RoaringContainer *c = r->containers + i;
+        uint32_t high = (uint32_t)c->key << 16;
+        if (c->words != NULL) {
+            for (int w = 0; w < ROARING_BITMAP_WORDS && n < max; w++) {
+                for (uint64_t bits = c->words[w]; bits != 0 && n < max; bits &= bits - 1) {
+                    out[n++] = high | (uint32_t)(w * 64 + __builtin_ctzll(bits));
+                }
+            }
+        } else {
+            for (int v = 0; v < c->cardinality && n < max; v++) {
+                out[n++] = high | c->values[v];
+            }
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Returns the bytes a bitmap occupies.
+ *
+ * @param r The bitmap.
+ * @return The bytes of its containers and their arrays or bitmaps.
+ */
+size_t roaringBytes(const Roaring *r) {
+    size_t bytes = (size_t)r->capacity * sizeof(RoaringContainer);
+    for (int i = 0; i < r->count; i++) {
+        const RoaringContainer *c = r->containers + i;
+        bytes += c->words != NULL ? ROARING_BITMAP_WORDS * sizeof(uint64_t) : (size_t)c->capacity * sizeof(uint16_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,613 @@
+/**
+ * @file schedule.c
+ * @brief Implementation of recurring flight schedules that are expanded into dated flights on demand.
+ *
+ * The patterns live in one array sorted by firstFlightID. Their ID ranges
+ * never overlap, so the pattern of a flight ID is found by binary search.
+ * Dates are handled as day numbers (days since 01-01-1970, from
+ * journeyMinutes), which makes weekdays, period checks and the arrival of
+ * overnight flights plain arithmetic. A day's dated flights are built on
+ * the stack; the ones already in the table are found with one batched
+ * flight ID lookup. scheduleAllowsFlight, bound to insertFlight, keeps the
+ * reserved IDs for the dated flights.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For atoi
+#include <string.h>
+#include <limits.h> // For INT_MAX
+
+#include "schedule.h"
+#include "flight.h"
+#include "idindex.h"
+#include "inventory.h" // For inventoryAddFlight
+#include "journey.h" // For journeyMinutes
+#include "memstats.h"
+
+static SchedulePattern *patterns = NULL; /**< Patterns by firstFlightID. */
+static int patternCount = 0;             /**< Patterns in use. */
+static int patternCapacity = 0;          /**< Allocated patterns. */
+
+/**
+ * @var weekdayNames
+ * @brief Short weekday names, Monday first (the bit order of SchedulePattern.weekdays).
+ */
+static const char *weekdayNames[7] = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+
+/**
+ * @brief Returns the day number of a date (days since 01-01-1970).
+ *
+ * @param date The date (time ignored).
+ * @return The day number.
+ */
+static int dayNumber(const DateTime *date) {
+    DateTime midnight = *date;
+    midnight.hour = 0;
+    midnight.minute = 0;
+    return journeyMinutes(&midnight) / 1440;
+}
+
+/**
+ * @brief Returns the date and time of a minute number (the inverse of journeyMinutes).
+ *
+ * @param minutes Minutes since 01-01-1970 00:00 (0 or more).
+ * @return The date and time.
+ */
+static DateTime dateTimeOf(int minutes) {
+    // Civil date from the day number (March-based years put the leap day last)
+    int z = minutes / 1440 + 719468;
+    int era = z / 146097;
+    int dayOfEra = z - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;
+    int month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    DateTime dt;
+    memset(&dt, 0, sizeof(dt));
+    dt.day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    dt.month = month;
+    dt.year = yearOfEra + era * 400 + (month <= 2);
+    dt.hour = minutes % 1440 / 60;
+    dt.minute = minutes % 60;
+    return dt;
+}
+
+/**
+ * @brief Returns the weekday of a day number.
+ *
+ * @param day The day number.
+ * @return 0 for Monday ... 6 for Sunday.
+ */
+static int weekdayOf(int day) {
+    return (day + 3) % 7; // 01-01-1970 was a Thursday
+}
+
+/**
+ * @brief Returns the number of days in a pattern's validity period.
+ *
+ * @param p The pattern.
+ * @return The days from validFrom to validTo, both included.
+ */
+static int periodDays(const SchedulePattern *p) {
+    return dayNumber(&p->validTo) - dayNumber(&p->validFrom) + 1;
+}
+
+/**
+ * @brief Counts the dated flights of a pattern.
+ *
+ * @param p The pattern.
+ * @return The days of its period that fall on one of its weekdays.
+ */
+static int countDatedFlights(const SchedulePattern *p) {
+    int first = dayNumber(&p->validFrom), days = periodDays(p), count = 0;
+    for (int d = 0; d < days; d++) {
+        count += (p->weekdays >> weekdayOf(first + d)) & 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Checks that a date exists (e.g., not 31-02).
+ *
+ * @param date The date (time ignored).
+ * @return 1 if valid, 0 otherwise.
+ */
+static int isValidDate(const DateTime *date) {
+    if (date->year < 1970 || date->month < 1 || date->month > 12 || date->day < 1) {
+        return 0;
+    }
+    DateTime back = dateTimeOf(dayNumber(date) * 1440);
+    return back.day == date->day && back.month == date->month && back.year == date->year;
+}
+
+/**
+ * @brief Finds the pattern whose ID range holds a flight ID.
+ *
+ * @param flightID The flight ID.
+ * @return The pattern's position, or -1 if no pattern reserved that ID.
+ */
+static int findPatternOf(int flightID) {
+    int low = 0, high = patternCount;
+    while (low < high) { // First pattern starting after flightID
+        int mid = low + (high - low) / 2;
+        if (patterns[mid].firstFlightID <= flightID) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0 || flightID - patterns[low - 1].firstFlightID >= periodDays(patterns + low - 1)) {
+        return -1;
+    }
+    return low - 1;
+}
+
+/**
+ * @brief Fills the dated flight of a pattern on one day.
+ *
+ * @param p The pattern.
+ * @param day The day number (must be in the pattern's period).
+ * @param flight Receives the flight.
+ */
+static void buildDatedFlight(const SchedulePattern *p, int day, Flight *flight) {
+    memset(flight, 0, sizeof(*flight));
+    flight->flightID = p->firstFlightID + (day - dayNumber(&p->validFrom));
+    strcpy(flight->flightName, p->flightName);
+    strcpy(flight->origin, p->origin);
+    strcpy(flight->destination, p->destination);
+    flight->departure = dateTimeOf(day * 1440 + p->departureMinute);
+    flight->arrival = dateTimeOf(day * 1440 + p->departureMinute + p->duration);
+    flight->status = ON_TIME;
+    flight->availableSeats = MAX_PASSENGERS_PER_FLIGHT;
+}
+
+/**
+ * @brief Reports whether a flight is the dated flight of a pattern (and not another flight with its ID).
+ *
+ * @param f The flight.
+ * @param expected The dated flight built from the pattern.
+ * @return 1 if name, route and departure match, 0 otherwise.
+ */
+static int isDatedFlight(const Flight *f, const Flight *expected) {
+    return strcmp(f->flightName, expected->flightName) == 0 && strcmp(f->origin, expected->origin) == 0 &&
+           strcmp(f->destination, expected->destination) == 0 &&
+           journeyMinutes(&f->departure) == journeyMinutes(&expected->departure);
+}
+
+/**
+ * @brief Finds the pattern and day of a dated flight ID.
+ *
+ * @param flightID The flight ID.
+ * @param day Receives the day number of its flight.
+ * @return The pattern, or NULL if no pattern operates a flight with that ID (outside every range, or on a weekday it does not fly).
+ */
+static const SchedulePattern *findDatedFlight(int flightID, int *day) {
+    int at = findPatternOf(flightID);
+    if (at < 0) {
+        return NULL;
+    }
+    const SchedulePattern *p = patterns + at;
+    *day = dayNumber(&p->validFrom) + (flightID - p->firstFlightID);
+    if (!((p->weekdays >> weekdayOf(*day)) & 1)) {
+        return NULL; // Not operated that weekday
+    }
+    return p;
+}
+
+/**
+ * @brief Reports whether a flight may be inserted under the IDs the patterns reserve.
+ *
+ * @param flight The flight about to be inserted.
+ * @return 1 if it may be inserted, 0 if its ID is reserved for another flight.
+ */
+int scheduleAllowsFlight(const Flight *flight) {
+    if (findPatternOf(flight->flightID) < 0) {
+        return 1; // Not reserved
+    }
+    int day;
+    const SchedulePattern *p = findDatedFlight(flight->flightID, &day);
+    if (p == NULL) {
+        return 0; // Reserved, but the pattern does not fly that day
+    }
+    Flight dated;
+    buildDatedFlight(p, day, &dated);
+    return isDatedFlight(flight, &dated);
+}
+
+/**
+ * @brief Reports whether a pattern operates a dated flight with an ID.
+ *
+ * @param flightID The flight ID.
+ * @return 1 if it does, 0 otherwise.
+ */
+int isScheduledFlightID(int flightID) {
+    int day;
+    return findDatedFlight(flightID, &day) != NULL;
+}
+
+/**
+ * @brief Adds a recurring flight.
+ *
+ * @param flights The flight array (to allocate IDs above its flights).
+ * @param flightCount The number of flights.
+ * @param pattern The pattern; its firstFlightID is set on success.
+ * @return 1 on success, 0 on failure (e.g., bad period or times, no weekday, memory reallocation failed).
+ */
+int addSchedulePattern(const Flight *flights, int flightCount, SchedulePattern *pattern) {
+    if (pattern->flightName[0] == '\0' || pattern->origin[0] == '\0' || pattern->destination[0] == '\0' ||
+        strchr(pattern->flightName, ',') != NULL || strchr(pattern->origin, ',') != NULL ||
+        strchr(pattern->destination, ',') != NULL) {
+        printf("Error: Flight name, origin and destination must be non-empty and contain no commas.\n");
+        return 0; // Failure
+    }
+    if (!isValidDate(&pattern->validFrom) || !isValidDate(&pattern->validTo) ||
+        periodDays(pattern) < 1 || periodDays(pattern) > SCHEDULE_MAX_DAYS) {
+        printf("Error: The period must be valid dates, at most %d days long.\n", SCHEDULE_MAX_DAYS);
+        return 0; // Failure
+    }
+    if ((pattern->weekdays & SCHEDULE_DAILY) == 0 || (pattern->weekdays & ~SCHEDULE_DAILY) != 0) {
+        printf("Error: A schedule operates on at least one weekday.\n");
+        return 0; // Failure
+    }
+    if (pattern->departureMinute < 0 || pattern->departureMinute >= 1440 ||
+        pattern->duration < 1 || pattern->duration > 2 * 1440) {
+        printf("Error: Departure must be within the day and the flight 1 minute to 48 hours long.\n");
+        return 0; // Failure
+    }
+
+    // Reserve one ID per day above every flight and every other pattern
+    long long next = 1;
+    for (int i = 0; i < flightCount; i++) {
+        if (flights[i].flightID >= next) {
+            next = (long long)flights[i].flightID + 1;
+        }
+    }
+    if (patternCount > 0) {
+        const SchedulePattern *last = patterns + patternCount - 1;
+        if ((long long)last->firstFlightID + periodDays(last) > next) {
+            next = (long long)last->firstFlightID + periodDays(last);
+        }
+    }
+    if (next + periodDays(pattern) > INT_MAX) {
+        printf("Error: No flight IDs left for this schedule.\n");
+        return 0; // Failure
+    }
+    if (patternCount == patternCapacity) {
+        int capacity = patternCapacity > 0 ? patternCapacity * 2 : 16;
+        SchedulePattern *grown = (SchedulePattern *)trackedRealloc(MEM_OTHER, patterns,
+                                                                   (size_t)capacity * sizeof(SchedulePattern));
+        if (grown == NULL) {
+            printf("Error: Could not reallocate memory for schedules.\n");
+            return 0; // Failure
+        }
+        patterns = grown;
+        patternCapacity = capacity;
+    }
+    pattern->firstFlightID = (int)next;
+    patterns[patternCount++] = *pattern; // IDs only grow, so the array stays sorted
+    return 1; // Success
+}
+
+/**
+ * @brief Removes a recurring flight (its dated flights already in the table stay).
+ *
+ * @param firstFlightID The pattern's firstFlightID.
+ * @return 1 on success, 0 if there is no such pattern.
+ */
+int removeSchedulePattern(int firstFlightID) {
+    int at = findPatternOf(firstFlightID);
+    if (at < 0 || patterns[at].firstFlightID != firstFlightID) {
+        return 0; // Failure
+    }
+    memmove(patterns + at, patterns + at + 1, (size_t)(patternCount - at - 1) * sizeof(SchedulePattern));
+    patternCount--;
+    return 1; // Success
+}
+
+/**
+ * @brief Lists the dated flights operating on one day.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param origin The departure airport, or NULL for any.
+ * @param destination The arrival airport, or NULL for any.
+ * @param date The day (time ignored).
+ * @param out Receives the flights, by departure.
+ * @param maxFlights The capacity of out.
+ * @return The number of flights operating that day (may exceed maxFlights), or -1 if the flight ID index could not be built.
+ */
+int findScheduledFlights(const Flight *flights, int flightCount, const char *origin, const char *destination,
+                         const DateTime *date, ScheduledFlight *out, int maxFlights) {
+    int day = dayNumber(date);
+    int weekdayBit = 1 << weekdayOf(day);
+    int total = 0, kept = 0;
+    for (int i = 0; i < patternCount; i++) {
+        const SchedulePattern *p = patterns + i;
+        if (!(p->weekdays & weekdayBit) || (origin != NULL && strcmp(p->origin, origin) != 0) ||
+            (destination != NULL && strcmp(p->destination, destination) != 0)) {
+            continue;
+        }
+        int offset = day - dayNumber(&p->validFrom);
+        if (offset < 0 || offset >= periodDays(p)) {
+            continue;
+        }
+        total++;
+        // Keep the earliest departures, in order
+        int slot = kept;
+        while (slot > 0 && out[slot - 1].pattern->departureMinute > p->departureMinute) {
+            slot--;
+        }
+        if (slot == maxFlights) {
+            continue;
+        }
+        if (kept < maxFlights) {
+            kept++;
+        }
+        memmove(out + slot + 1, out + slot, (size_t)(kept - 1 - slot) * sizeof(ScheduledFlight));
+        ScheduledFlight *s = out + slot;
+        s->flightID = p->firstFlightID + offset;
+        s->pattern = p;
+        s->departure = dateTimeOf(day * 1440 + p->departureMinute);
+        s->arrival = dateTimeOf(day * 1440 + p->departureMinute + p->duration);
+        s->availableSeats = MAX_PASSENGERS_PER_FLIGHT;
+        s->materialized = 0;
+    }
+    if (kept == 0) {
+        return total;
+    }
+
+    // Dates already booked have live seat counts in the table
+    int ids[ID_INDEX_GROUP], positions[ID_INDEX_GROUP];
+    for (int start = 0; start < kept; start += ID_INDEX_GROUP) {
+        int count = kept - start < ID_INDEX_GROUP ? kept - start : ID_INDEX_GROUP;
+        for (int i = 0; i < count; i++) {
+            ids[i] = out[start + i].flightID;
+        }
+        if (findFlightIndexes(flights, flightCount, ids, count, positions) < 0) {
+            return -1;
+        }
+        for (int i = 0; i < count; i++) {
+            ScheduledFlight *s = out + start + i;
+            if (positions[i] < 0) {
+                continue;
+            }
+            Flight expected;
+            buildDatedFlight(s->pattern, day, &expected);
+            if (isDatedFlight(flights + positions[i], &expected)) {
+                s->availableSeats = flights[positions[i]].availableSeats;
+                s->materialized = 1;
+            } else {
+                s->availableSeats = 0; // Its ID is taken by another flight
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Makes sure the dated flight with an ID is in the flight table, inserting it if needed.
+ *
+ * @param flights The flight array (capacity MAX_FLIGHTS).
+ * @param flightCount A pointer to the flight count, incremented if the flight is inserted.
+ * @param flightID The flight ID.
+ * @param shared The shared inventory, or NULL if not in shared mode.
+ * @return Its position in the table; -1 if no pattern operates a flight with that ID; -2 if one does but
+ *         it could not be put in the table (the reason is printed).
+ */
+int materializeScheduledFlight(Flight *flights, int *flightCount, int flightID, SharedInventory *shared) {
+    int day;
+    const SchedulePattern *p = findDatedFlight(flightID, &day);
+    if (p == NULL) {
+        return -1;
+    }
+    Flight dated;
+    buildDatedFlight(p, day, &dated);
+    int position;
+    if (findFlightIndexes(flights, *flightCount, &flightID, 1, &position) < 0) {
+        printf("Error: Could not allocate memory for the flight ID index.\n");
+        return -2;
+    }
+    if (position >= 0) {
+        if (!isDatedFlight(flights + position, &dated)) {
+            printf("Error: Flight ID %d is used by another flight.\n", flightID);
+            return -2;
+        }
+        return position; // Already booked before
+    }
+    if (*flightCount >= MAX_FLIGHTS) {
+        printf("Error: Could not add flight %d (flight limit of %d reached).\n", flightID, MAX_FLIGHTS);
+        return -2;
+    }
+    if (!insertFlight(flights, flightCount, &dated)) {
+        printf("Error: Could not add flight %d.\n", flightID);
+        return -2;
+    }
+    // Another process may have published this date already; bookings go through the segment
+    if (shared != NULL && inventoryFindFlight(shared, flightID) == NULL && !inventoryAddFlight(shared, &dated)) {
+        removeFlight(flights, flightCount, flightID); // Keep the table and the segment in step
+        printf("Error: Could not add flight %d to the shared inventory.\n", flightID);
+        return -2;
+    }
+    return *flightCount - 1;
+}
+
+/**
+ * @brief Lists every pattern with the number of dated flights it stands for.
+ *
+ * @return The number of patterns listed.
+ */
+int listSchedulePatterns() {
+    if (patternCount == 0) {
+        printf("No schedules defined.\n");
+        return 0;
+    }
+    for (int i = 0; i < patternCount; i++) {
+        const SchedulePattern *p = patterns + i;
+        printf("IDs %d-%d: %s %s -> %s %02d:%02d (%dh %02dm),",
+               p->firstFlightID, p->firstFlightID + periodDays(p) - 1, p->flightName, p->origin, p->destination,
+               p->departureMinute / 60, p->departureMinute % 60, p->duration / 60, p->duration % 60);
+        for (int w = 0; w < 7; w++) {
+            if ((p->weekdays >> w) & 1) {
+                printf(" %s", weekdayNames[w]);
+            }
+        }
+        printf(", %02u-%02u-%04u to %02u-%02u-%04u, %d flights\n",
+               p->validFrom.day, p->validFrom.month, p->validFrom.year,
+               p->validTo.day, p->validTo.month, p->validTo.year, countDatedFlights(p));
+    }
+    size_t datedBytes;
+    size_t bytes = scheduleMemory(&datedBytes);
+    printf("%d schedule(s) in %zu bytes stand for %zu dated flights, which would take as many of the %d table "
+           "slots (%zu bytes of flight records) if stored as flights.\n",
+           patternCount, bytes, datedBytes / sizeof(Flight), MAX_FLIGHTS, datedBytes);
+    return patternCount;
+}
+
+/**
+ * @brief Returns the memory the patterns take and the memory their dated flights would take as Flight records.
+ *
+ * @param datedBytes Receives the bytes of one Flight per dated flight.
+ * @return The bytes of the patterns.
+ */
+size_t scheduleMemory(size_t *datedBytes) {
+    size_t dated = 0;
+    for (int i = 0; i < patternCount; i++) {
+        dated += (size_t)countDatedFlights(patterns + i);
+    }
+    *datedBytes = dated * sizeof(Flight);
+    return (size_t)patternCount * sizeof(SchedulePattern);
+}
+
+/**
+ * @brief Saves the patterns to a file.
+ *
+ * Line format: firstFlightID,name,origin,destination,DD MM YYYY,DD MM YYYY,weekdays,departureMinute,duration
+ *
+ * @param filename The name of the file to save to.
+ * @return 1 on success, 0 on failure (e.g., file could not be opened).
+ */
+int saveSchedulePatterns(const char *filename) {
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open file %s for writing.\n", filename);
+        return 0; // Failure
+    }
+    fprintf(fp, "%d\n", patternCount);
+    for (int i = 0; i < patternCount; i++) {
+        const SchedulePattern *p = patterns + i;
+        fprintf(fp, "%d,%s,%s,%s,", p->firstFlightID, p->flightName, p->origin, p->destination);
+        fprintf(fp, "%u %u %u,%u %u %u,", p->validFrom.day, p->validFrom.month, p->validFrom.year,
+                p->validTo.day, p->validTo.month, p->validTo.year);
+        fprintf(fp, "%d,%d,%d\n", p->weekdays, p->departureMinute, p->duration);
+    }
+    fclose(fp);
+    printf("Schedules saved to %s successfully.\n", filename);
+    return 1; // Success
+}
+
+/**
+ * @brief Parses "DD MM YYYY" into a date.
+ *
+ * @param text The text.
+ * @param date Receives the date.
+ * @return 1 on success, 0 on a malformed or invalid date.
+ */
+static int parseDate(const char *text, DateTime *date) {
+    unsigned int day, month, year;
+    if (sscanf(text, "%u %u %u", &day, &month, &year) != 3 || year > 4095 || month > 15 || day > 31) {
+        return 0;
+    }
+    memset(date, 0, sizeof(*date));
+    date->day = day;
+    date->month = month;
+    date->year = year;
+    return isValidDate(date);
+}
+
+/**
+ * @brief Loads the patterns from a file, replacing the current ones.
+ *
+ * @param filename The name of the file to load from.
+ * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
+ */
+int loadSchedulePatterns(const char *filename) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        printf("No schedule file found (%s). Starting with no schedules.\n", filename);
+        return 0; // Not a critical failure, just means no data to load
+    }
+    int loadedCount = 0;
+    if (fscanf(fp, "%d\n", &loadedCount) != 1 || loadedCount < 0) {
+        printf("Error reading schedule count from %s. File might be corrupted.\n", filename);
+        fclose(fp);
+        return 0;
+    }
+    cleanupSchedulePatterns();
+    if (loadedCount > 0) {
+        patterns = (SchedulePattern *)trackedMalloc(MEM_OTHER, (size_t)loadedCount * sizeof(SchedulePattern));
+        if (patterns == NULL) {
+            printf("Error: Could not allocate memory for loading schedules.\n");
+            fclose(fp);
+            return 0;
+        }
+        patternCapacity = loadedCount;
+    }
+
+    char line_buffer[3 * MAX_NAME_LEN + 96]; // Buffer to read each line
+    while (patternCount < loadedCount && fgets(line_buffer, sizeof(line_buffer), fp) != NULL) {
+        SchedulePattern *p = patterns + patternCount;
+        memset(p, 0, sizeof(*p));
+        char *fields[9];
+        char *rest = line_buffer;
+        int n = 0;
+        for (; n < 9; n++) {
+            fields[n] = strtok(rest, n == 8 ? "\n" : ",");
+            rest = NULL; // For subsequent strtok calls on the same line
+            if (fields[n] == NULL) {
+                break;
+            }
+        }
+        if (n < 9 || strlen(fields[1]) >= MAX_NAME_LEN || strlen(fields[2]) >= MAX_NAME_LEN ||
+            strlen(fields[3]) >= MAX_NAME_LEN || !parseDate(fields[4], &p->validFrom) ||
+            !parseDate(fields[5], &p->validTo)) {
+            printf("Error reading schedule %d.\n", patternCount + 1);
+            break;
+        }
+        p->firstFlightID = atoi(fields[0]);
+        strcpy(p->flightName, fields[1]);
+        strcpy(p->origin, fields[2]);
+        strcpy(p->destination, fields[3]);
+        p->weekdays = atoi(fields[6]) & SCHEDULE_DAILY;
+        p->departureMinute = atoi(fields[7]);
+        p->duration = atoi(fields[8]);
+        if (periodDays(p) < 1 || periodDays(p) > SCHEDULE_MAX_DAYS || p->departureMinute < 0 ||
+            p->departureMinute >= 1440 || p->duration < 1) {
+            printf("Error reading schedule %d.\n", patternCount + 1);
+            break;
+        }
+        patternCount++;
+    }
+    fclose(fp);
+
+    // Keep the array sorted by firstFlightID whatever order the file was in
+    for (int i = 1; i < patternCount; i++) {
+        SchedulePattern p = patterns[i];
+        int j = i;
+        for (; j > 0 && patterns[j - 1].firstFlightID > p.firstFlightID; j--) {
+            patterns[j] = patterns[j - 1];
+        }
+        patterns[j] = p;
+    }
+    return 1; // Success
+}
+
+/**
+ * @brief Frees the patterns.
+ */
+void cleanupSchedulePatterns() {
+    trackedFree(MEM_OTHER, patterns);
+    patterns = NULL;
+    patternCount = 0;
+    patternCapacity = 0;
+}
@@ -0,0 +1,476 @@
+/**
+ * @file segment.c
+ * @brief Implementation of multi-leg flights and their origin-destination seat inventory.
+ *
+ * The segmented flights live in one array sorted by flight number, so a
+ * lookup is a binary search. A flight's leg positions are resolved with the
+ * batched flight ID index (findFlightIndexes) and reused until the flight
+ * table changes. The seat maps of the legs travelled are ORed 32 bytes at a
+ * time with AVX2, 16 with SSE2, or 8 otherwise.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For strtol
+#include <string.h>
+#include <stdint.h> // For uint64_t
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "segment.h"
+#include "flight.h"
+#include "idindex.h"
+#include "journey.h" // For journeyMinutes
+#include "ticket.h"
+#include "memstats.h"
+
+static SegmentedFlight *segmentedFlights = NULL; /**< Segmented flights by flight number. */
+static int segmentedCount = 0;                   /**< Segmented flights in use. */
+static int segmentedCapacity = 0;                /**< Allocated segmented flights. */
+
+/**
+ * @brief Finds where a flight number is or would be in the sorted array.
+ *
+ * @param flightNumber The flight number.
+ * @param found Receives 1 if it is there, 0 if not.
+ * @return Its position, or the position it would be inserted at.
+ */
+static int locateSegmented(const char *flightNumber, int *found) {
+    int low = 0, high = segmentedCount;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        int order = strcmp(segmentedFlights[mid].flightNumber, flightNumber);
+        if (order == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *found = 0;
+    return low;
+}
+
+/**
+ * @brief Makes a segmented flight's leg positions current for a flight table.
+ *
+ * @param s The segmented flight.
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return 1 if every leg is in the table, 0 otherwise.
+ */
+static int resolveLegs(SegmentedFlight *s, const Flight *flights, int flightCount) {
+    if (s->table == flights && s->flightCount == flightCount && s->version == flightTableVersion) {
+        return 1;
+    }
+    if (findFlightIndexes(flights, flightCount, s->legIDs, s->legCount, s->positions) != s->legCount) {
+        return 0; // A leg was deleted (or the index could not be built)
+    }
+    s->table = flights;
+    s->flightCount = flightCount;
+    s->version = flightTableVersion;
+    return 1;
+}
+
+/**
+ * @brief Finds the legs a passenger travels from an origin to a destination.
+ *
+ * @param s The segmented flight (legs resolved).
+ * @param flights The flight array.
+ * @param origin The boarding airport.
+ * @param destination The leaving airport.
+ * @param first Receives the first leg travelled.
+ * @param last Receives the last leg travelled.
+ * @return 1 if the flight serves origin to destination, 0 otherwise.
+ */
+static int findLegRange(const SegmentedFlight *s, const Flight *flights, const char *origin,
+                        const char *destination, int *first, int *last) {
+    for (int i = 0; i < s->legCount; i++) {
+        if (strcmp(flights[s->positions[i]].origin, origin) != 0) {
+            continue;
+        }
+        for (int j = i; j < s->legCount; j++) {
+            if (strcmp(flights[s->positions[j]].destination, destination) == 0) {
+                *first = i;
+                *last = j;
+                return 1;
+            }
+        }
+        return 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief ORs the seat maps of a run of legs.
+ *
+ * @param flights The flight array.
+ * @param positions The table positions of the legs.
+ * @param count The number of legs.
+ * @param seatMap Receives the OR.
+ */
+static void orSeatMaps(const Flight *flights, const int *positions, int count, unsigned char *seatMap) {
+    int b = 0;
+#if defined(__AVX2__)
+    for (; b + 32 <= SEAT_MAP_BYTES; b += 32) {
+        __m256i booked = _mm256_setzero_si256();
+        for (int i = 0; i < count; i++) {
+            booked = _mm256_or_si256(booked, _mm256_loadu_si256((const __m256i *)(flights[positions[i]].seatMap + b)));
+        }
+        _mm256_storeu_si256((__m256i *)(seatMap + b), booked);
+    }
+#elif defined(__SSE2__)
+    for (; b + 16 <= SEAT_MAP_BYTES; b += 16) {
+        __m128i booked = _mm_setzero_si128();
+        for (int i = 0; i < count; i++) {
+            booked = _mm_or_si128(booked, _mm_loadu_si128((const __m128i *)(flights[positions[i]].seatMap + b)));
+        }
+        _mm_storeu_si128((__m128i *)(seatMap + b), booked);
+    }
+#endif
+    for (; b + 8 <= SEAT_MAP_BYTES; b += 8) {
+        uint64_t booked = 0;
+        for (int i = 0; i < count; i++) {
+            uint64_t word;
+            memcpy(&word, flights[positions[i]].seatMap + b, sizeof(word));
+            booked |= word;
+        }
+        memcpy(seatMap + b, &booked, sizeof(booked));
+    }
+    for (; b < SEAT_MAP_BYTES; b++) {
+        unsigned char booked = 0;
+        for (int i = 0; i < count; i++) {
+            booked |= flights[positions[i]].seatMap[b];
+        }
+        seatMap[b] = booked;
+    }
+}
+
+/**
+ * @brief Counts the free seats of a seat map.
+ *
+ * @param seatMap The seat map.
+ * @return The seats from 1 to MAX_PASSENGERS_PER_FLIGHT whose bit is clear.
+ */
+static int countFreeSeats(const unsigned char *seatMap) {
+    int booked = 0;
+    int b = 0;
+    for (; (b + 8) * 8 <= MAX_PASSENGERS_PER_FLIGHT; b += 8) {
+        uint64_t word;
+        memcpy(&word, seatMap + b, sizeof(word));
+        booked += __builtin_popcountll(word);
+    }
+    for (int seatNo = b * 8 + 1; seatNo <= MAX_PASSENGERS_PER_FLIGHT; seatNo++) {
+        booked += SEAT_IS_BOOKED(seatMap, seatNo) != 0;
+    }
+    return MAX_PASSENGERS_PER_FLIGHT - booked;
+}
+
+/**
+ * @brief Defines (or redefines) a flight number flown as consecutive legs.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightNumber The flight number.
+ * @param legIDs The flight IDs of the legs, first leg first.
+ * @param legCount The number of legs (2 to SEGMENT_MAX_LEGS).
+ * @return 1 on success, 0 on failure (e.g., missing leg, legs not connected, memory reallocation failed).
+ */
+int defineSegmentedFlight(const Flight *flights, int flightCount, const char *flightNumber,
+                          const int *legIDs, int legCount) {
+    if (flightNumber == NULL || flightNumber[0] == '\0' || strchr(flightNumber, ',') != NULL) {
+        printf("Error: Invalid flight number.\n");
+        return 0; // Failure
+    }
+    if (legCount < 2 || legCount > SEGMENT_MAX_LEGS) {
+        printf("Error: A segmented flight has 2 to %d legs.\n", SEGMENT_MAX_LEGS);
+        return 0; // Failure
+    }
+    SegmentedFlight s;
+    memset(&s, 0, sizeof(s));
+    strncpy(s.flightNumber, flightNumber, MAX_NAME_LEN - 1);
+    s.legCount = legCount;
+    memcpy(s.legIDs, legIDs, (size_t)legCount * sizeof(int));
+    if (!resolveLegs(&s, flights, flightCount)) {
+        printf("Error: Every leg must be an existing flight.\n");
+        return 0; // Failure
+    }
+    for (int i = 1; i < legCount; i++) {
+        const Flight *previous = flights + s.positions[i - 1];
+        const Flight *leg = flights + s.positions[i];
+        if (strcmp(previous->destination, leg->origin) != 0 ||
+            journeyMinutes(&leg->departure) < journeyMinutes(&previous->arrival)) {
+            printf("Error: Flight %d does not continue flight %d.\n", leg->flightID, previous->flightID);
+            return 0; // Failure
+        }
+    }
+
+    int found;
+    int at = locateSegmented(flightNumber, &found);
+    if (!found) {
+        if (segmentedCount == segmentedCapacity) {
+            int capacity = segmentedCapacity > 0 ? segmentedCapacity * 2 : 16;
+            SegmentedFlight *grown = (SegmentedFlight *)trackedRealloc(MEM_OTHER, segmentedFlights,
+                                                                       (size_t)capacity * sizeof(SegmentedFlight));
+            if (grown == NULL) {
+                printf("Error: Could not reallocate memory for segmented flights.\n");
+                return 0; // Failure
+            }
+            segmentedFlights = grown;
+            segmentedCapacity = capacity;
+        }
+        memmove(segmentedFlights + at + 1, segmentedFlights + at, (size_t)(segmentedCount - at) * sizeof(SegmentedFlight));
+        segmentedCount++;
+    }
+    segmentedFlights[at] = s;
+    return 1; // Success
+}
+
+/**
+ * @brief Removes a segmented flight (its leg flights stay).
+ *
+ * @param flightNumber The flight number.
+ * @return 1 on success, 0 if there is no such segmented flight.
+ */
+int removeSegmentedFlight(const char *flightNumber) {
+    int found;
+    int at = locateSegmented(flightNumber, &found);
+    if (!found) {
+        return 0; // Failure
+    }
+    memmove(segmentedFlights + at, segmentedFlights + at + 1, (size_t)(segmentedCount - at - 1) * sizeof(SegmentedFlight));
+    segmentedCount--;
+    return 1; // Success
+}
+
+/**
+ * @brief Finds a segmented flight by flight number.
+ *
+ * @param flightNumber The flight number.
+ * @return A pointer to it (valid until the next define or remove), or NULL if not found.
+ */
+const SegmentedFlight *findSegmentedFlight(const char *flightNumber) {
+    int found;
+    int at = locateSegmented(flightNumber, &found);
+    return found ? segmentedFlights + at : NULL;
+}
+
+/**
+ * @brief Resolves a flight number and an origin-destination to the legs travelled.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightNumber The flight number.
+ * @param origin The boarding airport.
+ * @param destination The leaving airport.
+ * @param first Receives the first leg travelled.
+ * @param last Receives the last leg travelled.
+ * @return The segmented flight (legs resolved), or NULL if it does not serve origin to destination.
+ */
+static SegmentedFlight *findTravelledLegs(const Flight *flights, int flightCount, const char *flightNumber,
+                                        const char *origin, const char *destination, int *first, int *last) {
+    int found;
+    int at = locateSegmented(flightNumber, &found);
+    if (!found) {
+        return NULL;
+    }
+    SegmentedFlight *s = segmentedFlights + at;
+    if (!resolveLegs(s, flights, flightCount) || !findLegRange(s, flights, origin, destination, first, last)) {
+        return NULL;
+    }
+    return s;
+}
+
+/**
+ * @brief Computes the seat map of one origin-destination of a segmented flight.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param flightNumber The flight number.
+ * @param origin The airport the passenger boards at.
+ * @param destination The airport the passenger leaves at (a later stop).
+ * @param seatMap Receives the seat map (a seat is booked if it is booked on any leg travelled).
+ * @return The number of free seats, or -1 if the flight does not serve origin to destination or a leg no longer exists.
+ */
+int segmentSeatMap(const Flight *flights, int flightCount, const char *flightNumber, const char *origin,
+                   const char *destination, unsigned char seatMap[SEAT_MAP_BYTES]) {
+    int first, last;
+    const SegmentedFlight *s = findTravelledLegs(flights, flightCount, flightNumber, origin, destination, &first, &last);
+    if (s == NULL) {
+        return -1;
+    }
+    orSeatMaps(flights, s->positions + first, last - first + 1, seatMap);
+    return countFreeSeats(seatMap);
+}
+
+/**
+ * @brief Books one seat from an origin to a destination of a segmented flight, on every leg in between.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @param passengerName The name of the passenger.
+ * @param flightNumber The flight number.
+ * @param origin The airport the passenger boards at.
+ * @param destination The airport the passenger leaves at.
+ * @param seatNo The 1-based seat number.
+ * @param ticketIDs Receives the ticket IDs, one per leg travelled (SEGMENT_MAX_LEGS entries).
+ * @return The number of tickets issued, or 0 on failure (e.g., no such origin-destination, seat taken on a leg).
+ */
+int bookSegmentSeat(const Flight *flights, int flightCount, const char *passengerName, const char *flightNumber,
+                    const char *origin, const char *destination, int seatNo, int *ticketIDs) {
+    int first, last;
+    const SegmentedFlight *s = findTravelledLegs(flights, flightCount, flightNumber, origin, destination, &first, &last);
+    if (s == NULL) {
+        return 0; // Failure
+    }
+    return issueLegTickets(passengerName, s->legIDs + first, last - first + 1, seatNo, ticketIDs);
+}
+
+/**
+ * @brief Lists every segmented flight with its stops.
+ *
+ * @param flights The flight array.
+ * @param flightCount The number of flights.
+ * @return The number of segmented flights listed.
+ */
+int listSegmentedFlights(const Flight *flights, int flightCount) {
+    if (segmentedCount == 0) {
+        printf("No segmented flights defined.\n");
+        return 0;
+    }
+    for (int i = 0; i < segmentedCount; i++) {
+        SegmentedFlight *s = segmentedFlights + i;
+        printf("%s:", s->flightNumber);
+        if (!resolveLegs(s, flights, flightCount)) {
+            printf(" (a leg no longer exists)\n");
+            continue;
+        }
+        for (int l = 0; l < s->legCount; l++) {
+            const Flight *leg = flights + s->positions[l];
+            printf(" %s%s", l == 0 ? "" : "-> ", leg->origin);
+            printf(" [%d]", leg->flightID);
+        }
+        printf(" -> %s\n", flights[s->positions[s->legCount - 1]].destination);
+    }
+    return segmentedCount;
+}
+
+/**
+ * @brief Saves the segmented flights to a file.
+ *
+ * Line format: flightNumber,legCount,legID legID ...
+ *
+ * @param filename The name of the file to save to.
+ * @return 1 on success, 0 on failure (e.g., file could not be opened).
+ */
+int saveSegmentedFlights(const char *filename) {
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open file %s for writing.\n", filename);
+        return 0; // Failure
+    }
+    fprintf(fp, "%d\n", segmentedCount);
+    for (int i = 0; i < segmentedCount; i++) {
+        const SegmentedFlight *s = segmentedFlights + i;
+        fprintf(fp, "%s,%d,", s->flightNumber, s->legCount);
+        for (int l = 0; l < s->legCount; l++) {
+            fprintf(fp, l == 0 ? "%d" : " %d", s->legIDs[l]);
+        }
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+    printf("Segmented flights saved to %s successfully.\n", filename);
+    return 1; // Success
+}
+
+/**
+ * @brief Loads the segmented flights from a file, replacing the current ones.
+ *
+ * @param filename The name of the file to load from.
+ * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
+ */
+int loadSegmentedFlights(const char *filename) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        printf("No segmented flight file found (%s). Starting with no segmented flights.\n", filename);
+        return 0; // Not a critical failure, just means no data to load
+    }
+    int loadedCount = 0;
+    if (fscanf(fp, "%d\n", &loadedCount) != 1 || loadedCount < 0) {
+        printf("Error reading segmented flight count from %s. File might be corrupted.\n", filename);
+        fclose(fp);
+        return 0;
+    }
+    cleanupSegmentedFlights();
+    if (loadedCount > 0) {
+        segmentedFlights = (SegmentedFlight *)trackedMalloc(MEM_OTHER, (size_t)loadedCount * sizeof(SegmentedFlight));
+        if (segmentedFlights == NULL) {
+            printf("Error: Could not allocate memory for loading segmented flights.\n");
+            fclose(fp);
+            return 0;
+        }
+        segmentedCapacity = loadedCount;
+    }
+
+    char line_buffer[MAX_NAME_LEN + SEGMENT_MAX_LEGS * 12 + 16]; // Buffer to read each line
+    while (segmentedCount < loadedCount && fgets(line_buffer, sizeof(line_buffer), fp) != NULL) {
+        SegmentedFlight *s = segmentedFlights + segmentedCount;
+        memset(s, 0, sizeof(*s));
+        char *comma = strchr(line_buffer, ',');
+        if (comma == NULL || comma == line_buffer || comma - line_buffer >= MAX_NAME_LEN) {
+            printf("Error reading flight number.\n");
+            break;
+        }
+        memcpy(s->flightNumber, line_buffer, (size_t)(comma - line_buffer));
+        char *cursor;
+        s->legCount = (int)strtol(comma + 1, &cursor, 10);
+        if (*cursor != ',' || s->legCount < 2 || s->legCount > SEGMENT_MAX_LEGS) {
+            printf("Error reading leg count of %s.\n", s->flightNumber);
+            break;
+        }
+        cursor++;
+        int l = 0;
+        for (; l < s->legCount; l++) {
+            char *end;
+            s->legIDs[l] = (int)strtol(cursor, &end, 10);
+            if (end == cursor) {
+                break;
+            }
+            cursor = end;
+        }
+        if (l < s->legCount) {
+            printf("Error reading legs of %s.\n", s->flightNumber);
+            break;
+        }
+        segmentedCount++;
+    }
+    fclose(fp);
+
+    // Keep the array sorted whatever order the file was in
+    for (int i = 1; i < segmentedCount; i++) {
+        SegmentedFlight s = segmentedFlights[i];
+        int j = i;
+        for (; j > 0 && strcmp(segmentedFlights[j - 1].flightNumber, s.flightNumber) > 0; j--) {
+            segmentedFlights[j] = segmentedFlights[j - 1];
+        }
+        segmentedFlights[j] = s;
+    }
+    return 1; // Success
+}
+
+/**
+ * @brief Frees the segmented flights.
+ */
+void cleanupSegmentedFlights() {
+    trackedFree(MEM_OTHER, segmentedFlights);
+    segmentedFlights = NULL;
+    segmentedCount = 0;
+    segmentedCapacity = 0;
+}
@@ -0,0 +1,401 @@
+/**
+ * @file server.c
+ * @brief Implementation of the loopback TCP server.
+ *
+ * An accept thread hands every connection to a detached worker thread. The
+ * worker buffers incoming bytes, executes each complete line and writes the
+ * whole response with one send loop. SHUTDOWN clears the running flag and
+ * shuts the listening socket down, which wakes the accept thread, and shuts
+ * the read side of every open connection, so idle clients do not keep the
+ * server alive; requests already read are still answered.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For malloc, free
+#include <string.h>
+#include <errno.h>  // For errno
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>       // For close
+#include <time.h>         // For nanosleep
+#include <sys/socket.h>   // For socket, bind, listen, accept, recv, send
+#include <netinet/in.h>   // For sockaddr_in
+#include <netinet/tcp.h>  // For TCP_NODELAY
+#include <arpa/inet.h>    // For htonl, htons
+#endif
+
+#include "server.h"
+#include "service.h"
+#include "profiler.h"
+
+#if !defined(_WIN32)
+
+/**
+ * @def SERVER_REQUEST_SIZE
+ * @brief Longest request line accepted; a longer line is answered with one error and skipped up to its newline.
+ */
+#define SERVER_REQUEST_SIZE 512
+
+/**
+ * @def SERVER_ACCEPT_BACKOFF_MS
+ * @brief Pause before accepting again when the process or system is out of descriptors or memory.
+ */
+#define SERVER_ACCEPT_BACKOFF_MS 50
+
+/**
+ * @struct Connection
+ * @brief State handed to a connection worker.
+ */
+typedef struct Connection {
+    ServerHandle *server;       /**< The owning server. */
+    int fd;                     /**< The connected socket. */
+    struct Connection *next;    /**< Next open connection. */
+    struct Connection *prev;    /**< Previous open connection. */
+} Connection;
+
+/**
+ * @var openConnections
+ * @brief Every connection being served, so shutdown can wake idle ones.
+ */
+static Connection *openConnections = NULL;
+
+/**
+ * @var serverLock
+ * @brief Guards openConnections and activeConnections.
+ */
+static pthread_mutex_t serverLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @var connectionsDone
+ * @brief Signalled when activeConnections drops to zero or the server stops.
+ */
+static pthread_cond_t connectionsDone = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Sends a whole buffer, retrying short writes.
+ *
+ * @param fd The socket.
+ * @param data The bytes to send.
+ * @param length The number of bytes.
+ * @return 1 on success, 0 if the peer went away.
+ */
+static int sendAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return 0;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 1;
+}
+
+/**
+ * @brief Requests shutdown: clears the running flag and wakes the accept thread.
+ *
+ * @param server The server.
+ */
+static void requestShutdown(ServerHandle *server) {
+    pthread_mutex_lock(&serverLock);
+    if (server->running) {
+        __atomic_store_n(&server->running, 0, __ATOMIC_RELEASE);
+        shutdown(server->listenFd, SHUT_RDWR);
+        for (Connection *c = openConnections; c != NULL; c = c->next) {
+            shutdown(c->fd, SHUT_RD);
+        }
+    }
+    pthread_cond_broadcast(&connectionsDone);
+    pthread_mutex_unlock(&serverLock);
+}
+
+/**
+ * @brief Serves one connection until the peer closes it.
+ *
+ * @param arg The Connection (freed here).
+ * @return NULL.
+ */
+static void *serveConnection(void *arg) {
+    Connection *conn = (Connection *)arg;
+    char *request = (char *)malloc(SERVER_REQUEST_SIZE);
+    char *response = (char *)malloc(SERVICE_RESPONSE_SIZE);
+    size_t buffered = 0;
+    int discarding = 0; // 1 while skipping the rest of a line that was too long
+    int open = request != NULL && response != NULL;
+
+    profilerRegisterThread();
+    while (open) {
+        ssize_t received = recv(conn->fd, request + buffered, SERVER_REQUEST_SIZE - 1 - buffered, 0);
+        if (received <= 0) {
+            break;
+        }
+        buffered += (size_t)received;
+        if (discarding) {
+            // The tail of an overlong line is not a request of its own: drop it up to its newline
+            char *newline = memchr(request, '\n', buffered);
+            if (newline == NULL) {
+                buffered = 0;
+                continue;
+            }
+            buffered -= (size_t)(newline + 1 - request);
+            memmove(request, newline + 1, buffered);
+            discarding = 0;
+        }
+
+        // Execute every complete line in the buffer
+        char *lineStart = request;
+        char *newline;
+        while (open && (newline = memchr(lineStart, '\n', buffered - (size_t)(lineStart - request))) != NULL) {
+            *newline = '\0';
+            int result = executeRequest(lineStart, response, SERVICE_RESPONSE_SIZE);
+            open = sendAll(conn->fd, response, strlen(response));
+            if (result == -1) {
+                requestShutdown(conn->server);
+                open = 0;
+            }
+            lineStart = newline + 1;
+        }
+        buffered -= (size_t)(lineStart - request);
+        memmove(request, lineStart, buffered);
+
+        if (buffered == SERVER_REQUEST_SIZE - 1) {
+            const char *tooLong = "ERR request too long\n";
+            open = sendAll(conn->fd, tooLong, strlen(tooLong));
+            buffered = 0;
+            discarding = 1;
+        }
+    }
+
+    pthread_mutex_lock(&serverLock);
+    if (conn->prev != NULL) conn->prev->next = conn->next;
+    else openConnections = conn->next;
+    if (conn->next != NULL) conn->next->prev = conn->prev;
+    close(conn->fd);
+    conn->server->activeConnections--;
+    pthread_cond_broadcast(&connectionsDone);
+    pthread_mutex_unlock(&serverLock);
+    free(request);
+    free(response);
+    free(conn);
+    return NULL;
+}
+
+/**
+ * @brief Handles a failed accept: retries, backs off, or stops the server.
+ *
+ * Connection-level errors (e.g., EINTR, ECONNABORTED) are retried at once.
+ * Running out of descriptors or memory (EMFILE, ENFILE, ENOBUFS, ENOMEM) is
+ * retried after SERVER_ACCEPT_BACKOFF_MS, so the accept thread does not spin
+ * while open connections finish. Any other error means the listening socket
+ * itself is broken, so the server is shut down.
+ *
+ * @param server The server.
+ * @param error The errno of the failed accept.
+ * @return 1 to keep accepting, 0 to stop.
+ */
+static int acceptFailed(ServerHandle *server, int error) {
+    if (!__atomic_load_n(&server->running, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    switch (error) {
+        case EINTR:
+        case ECONNABORTED:
+        case EPROTO:
+        case EAGAIN:
+            return 1;
+        case EMFILE:
+        case ENFILE:
+        case ENOBUFS:
+        case ENOMEM: {
+            struct timespec pause = { 0, SERVER_ACCEPT_BACKOFF_MS * 1000000L };
+            nanosleep(&pause, NULL);
+            return 1;
+        }
+        default:
+            printf("Error: Could not accept connections (%s); stopping the server.\n", strerror(error));
+            fflush(stdout); // Flush output
+            requestShutdown(server);
+            return 0;
+    }
+}
+
+/**
+ * @brief Accepts connections until shutdown and starts a worker for each.
+ *
+ * @param arg The ServerHandle.
+ * @return NULL.
+ */
+static void *acceptConnections(void *arg) {
+    ServerHandle *server = (ServerHandle *)arg;
+    while (1) {
+        int fd = accept(server->listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (!acceptFailed(server, errno)) {
+                break;
+            }
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Request/response: no Nagle delay
+
+        Connection *conn = (Connection *)malloc(sizeof(Connection));
+        pthread_t thread;
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        conn->server = server;
+        conn->fd = fd;
+        conn->prev = NULL;
+        pthread_mutex_lock(&serverLock);
+        if (!server->running) {
+            pthread_mutex_unlock(&serverLock);
+            close(fd); // Accepted just before shutdown
+            free(conn);
+            break;
+        }
+        conn->next = openConnections;
+        if (openConnections != NULL) openConnections->prev = conn;
+        openConnections = conn;
+        server->activeConnections++;
+        if (pthread_create(&thread, NULL, serveConnection, conn) != 0) {
+            openConnections = conn->next;
+            if (openConnections != NULL) openConnections->prev = NULL;
+            server->activeConnections--;
+            pthread_mutex_unlock(&serverLock);
+            close(fd);
+            free(conn);
+            continue;
+        }
+        pthread_mutex_unlock(&serverLock);
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Starts listening on 127.0.0.1 and accepting connections in a background thread.
+ *
+ * @param server Receives the server state; must stay valid until waitServer or stopServer returns.
+ * @param port The TCP port, or 0 for any free port (read server->port afterwards).
+ * @return 1 on success, 0 on failure (e.g., port in use, unsupported platform).
+ */
+int startServer(ServerHandle *server, int port) {
+    server->listenFd = -1;
+    server->port = 0;
+    server->running = 0;
+    server->activeConnections = 0;
+    server->acceptJoinable = 0;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        printf("Error: Could not create the server socket.\n");
+        return 0;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((unsigned short)port);
+    socklen_t length = sizeof(addr);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SERVER_BACKLOG) != 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &length) != 0) {
+        printf("Error: Could not listen on 127.0.0.1:%d.\n", port);
+        close(fd);
+        return 0;
+    }
+
+    server->listenFd = fd;
+    server->port = ntohs(addr.sin_port);
+    server->running = 1;
+    if (pthread_create(&server->acceptThread, NULL, acceptConnections, server) != 0) {
+        printf("Error: Could not start the accept thread.\n");
+        close(fd);
+        server->listenFd = -1;
+        server->running = 0;
+        return 0;
+    }
+    server->acceptJoinable = 1;
+    return 1;
+}
+
+/**
+ * @brief Blocks until a client sends SHUTDOWN or stopServer is called, then closes the listener.
+ *
+ * @param server The server.
+ */
+void waitServer(ServerHandle *server) {
+    pthread_mutex_lock(&serverLock);
+    while (server->running) {
+        pthread_cond_wait(&connectionsDone, &serverLock);
+    }
+    pthread_mutex_unlock(&serverLock);
+    stopServer(server);
+}
+
+/**
+ * @brief Stops accepting connections and waits for open connections to finish.
+ *
+ * @param server The server.
+ */
+void stopServer(ServerHandle *server) {
+    requestShutdown(server);
+    if (server->acceptJoinable) {
+        pthread_join(server->acceptThread, NULL); // Before closing, so the descriptor cannot be reused under it
+        server->acceptJoinable = 0;
+    }
+    pthread_mutex_lock(&serverLock);
+    while (server->activeConnections > 0) {
+        pthread_cond_wait(&connectionsDone, &serverLock);
+    }
+    if (server->listenFd >= 0) {
+        close(server->listenFd);
+        server->listenFd = -1;
+    }
+    pthread_mutex_unlock(&serverLock);
+}
+
+#else // _WIN32
+
+/**
+ * @brief Starts the server (unsupported on Windows).
+ *
+ * @param server Receives a stopped server.
+ * @param port Unused.
+ * @return 0 always.
+ */
+int startServer(ServerHandle *server, int port) {
+    (void)port;
+    server->listenFd = -1;
+    server->port = 0;
+    server->running = 0;
+    server->activeConnections = 0;
+    server->acceptJoinable = 0;
+    printf("Server mode requires POSIX sockets and is not available on Windows.\n");
+    return 0;
+}
+
+/**
+ * @brief Waits for the server (nothing to wait for on Windows).
+ *
+ * @param server Unused.
+ */
+void waitServer(ServerHandle *server) {
+    (void)server;
+}
+
+/**
+ * @brief Stops the server (nothing to stop on Windows).
+ *
+ * @param server Unused.
+ */
+void stopServer(ServerHandle *server) {
+    (void)server;
+}
+
+#endif // _WIN32
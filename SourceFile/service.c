@@ -0,0 +1,737 @@
+/**
+ * @file service.c
+ * @brief Implementation of the thread-safe service layer and its text protocol.
+ *
+ * One reader-writer lock guards the flight table pointer/count and the global
+ * ticket table. Searches, route lookups, listings and payments only read and
+ * share the lock; booking and cancelling append to or shift the ticket table,
+ * and status changes rewrite a flight, so they take it exclusively.
+ *
+ * ITINERARY looks its tickets and their flights up in batches (idindex.h).
+ *
+ * executeRequest answers repeated SEARCH, ROUTE, AVAIL and LIST requests from
+ * the response cache (resultcache.h). Lookups and stores hold the reader
+ * lock, so they never see a booking or status change half applied.
+ *
+ * Searches do not go through searchFlight (which prints), so this layer
+ * records their latency and session log entry itself, for cached answers too.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For strtol, strtof
+#include <string.h>
+#include <stdarg.h> // For va_list
+#include <pthread.h>
+
+#include "service.h"
+#include "flight.h"
+#include "ticket.h"
+#include "payment.h"
+#include "page.h"
+#include "availability.h"
+#include "aggregates.h"
+#include "resultcache.h"
+#include "idindex.h"
+#include "session.h"
+#include "stats.h"
+#include "timing.h"
+
+static Flight **serviceFlights = NULL;   /**< The bound flight array pointer. */
+static int *serviceFlightCount = NULL;   /**< The bound flight count. */
+static pthread_rwlock_t serviceLock = PTHREAD_RWLOCK_INITIALIZER; /**< Guards the flight and ticket tables. */
+
+/**
+ * @var statusNames
+ * @brief Protocol names of FlightStatus values.
+ */
+static const char *const statusNames[] = { "ON_TIME", "DELAYED", "CANCELLED" };
+
+/**
+ * @brief Returns the protocol name of a flight status.
+ *
+ * @param status The status.
+ * @return A constant string such as "ON_TIME".
+ */
+static const char *statusName(FlightStatus status) {
+    return (status >= ON_TIME && status <= CANCELLED) ? statusNames[status] : "UNKNOWN";
+}
+
+/**
+ * @brief Binds the flight table the service operates on.
+ *
+ * @param flights A pointer to the caller's flight array pointer.
+ * @param flightCount A pointer to the caller's flight count.
+ */
+void bindService(Flight **flights, int *flightCount) {
+    pthread_rwlock_wrlock(&serviceLock);
+    serviceFlights = flights;
+    serviceFlightCount = flightCount;
+    pthread_rwlock_unlock(&serviceLock);
+}
+
+/**
+ * @brief Copies a flight by ID.
+ *
+ * Like searchFlight, the lookup is recorded in the latency statistics and
+ * in the session log.
+ *
+ * @param flightID The ID of the flight.
+ * @param out Receives a copy of the flight.
+ * @return 1 if found, 0 otherwise.
+ */
+int serviceSearchFlight(int flightID, Flight *out) {
+    int found = 0;
+    long long start = nowNanos();
+    pthread_rwlock_rdlock(&serviceLock);
+    if (serviceFlights != NULL) {
+        int index = findFlightIndex(*serviceFlights, *serviceFlightCount, flightID);
+        if (index != -1) {
+            *out = (*serviceFlights)[index];
+            found = 1;
+        }
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    recordLatency(STAT_FLIGHT_SEARCH, nowNanos() - start);
+    logSessionID(SESSION_FLIGHT_SEARCH, flightID, found, start);
+    return found;
+}
+
+/**
+ * @brief Finds the flights on a route.
+ *
+ * @param origin The origin.
+ * @param destination The destination.
+ * @param flightIDs Receives up to maxIDs flight IDs.
+ * @param maxIDs The capacity of flightIDs.
+ * @return The total number of flights on the route.
+ */
+int serviceFindRoute(const char *origin, const char *destination, int *flightIDs, int maxIDs) {
+    int indexes[SERVICE_ROUTE_LIMIT];
+    int matches = 0;
+    if (maxIDs > SERVICE_ROUTE_LIMIT) {
+        maxIDs = SERVICE_ROUTE_LIMIT;
+    }
+    pthread_rwlock_rdlock(&serviceLock);
+    if (serviceFlights != NULL) {
+        matches = findFlightsByRoute(*serviceFlights, *serviceFlightCount, origin, destination, indexes, maxIDs);
+        for (int i = 0; i < matches && i < maxIDs; i++) {
+            flightIDs[i] = (*serviceFlights)[indexes[i]].flightID;
+        }
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return matches;
+}
+
+/**
+ * @brief Finds the flights with at least a number of free seats.
+ *
+ * @param origin The origin, or NULL for every route.
+ * @param destination The destination (ignored if origin is NULL).
+ * @param minSeats The free seats needed.
+ * @param order The order of the returned flights.
+ * @param flightIDs Receives up to maxIDs flight IDs in that order.
+ * @param maxIDs The capacity of flightIDs (capped at SERVICE_ROUTE_LIMIT).
+ * @return The total number of flights with enough seats, or -1 if the index could not be built.
+ */
+int serviceFindAvailable(const char *origin, const char *destination, int minSeats, AvailOrder order,
+                         int *flightIDs, int maxIDs) {
+    int indexes[SERVICE_ROUTE_LIMIT];
+    int matches = 0;
+    if (maxIDs > SERVICE_ROUTE_LIMIT) {
+        maxIDs = SERVICE_ROUTE_LIMIT;
+    }
+    pthread_rwlock_rdlock(&serviceLock);
+    if (serviceFlights != NULL) {
+        matches = findAvailableFlights(*serviceFlights, *serviceFlightCount, origin, destination,
+                                       minSeats, order, indexes, maxIDs);
+        for (int i = 0; i < matches && i < maxIDs; i++) {
+            flightIDs[i] = (*serviceFlights)[indexes[i]].flightID;
+        }
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return matches;
+}
+
+/**
+ * @brief Reads the totals of a route, of a departure day or of every flight.
+ *
+ * @param origin The origin of the route, or NULL.
+ * @param destination The destination of the route (ignored if origin is NULL).
+ * @param day The departure day if origin is NULL, or NULL for every flight.
+ * @param out Receives the totals.
+ * @return 1 on success, 0 if the views could not be rebuilt.
+ */
+int serviceGetAggregate(const char *origin, const char *destination, const DateTime *day, AggregateView *out) {
+    int ok = 0;
+    memset(out, 0, sizeof(*out));
+    pthread_rwlock_rdlock(&serviceLock);
+    if (serviceFlights != NULL) {
+        if (origin != NULL) {
+            ok = getRouteAggregate(*serviceFlights, *serviceFlightCount, origin, destination, out);
+        } else if (day != NULL) {
+            ok = getDayAggregate(*serviceFlights, *serviceFlightCount, day, out);
+        } else {
+            ok = getTotalAggregate(*serviceFlights, *serviceFlightCount, out);
+        }
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return ok;
+}
+
+/**
+ * @brief Renders the next page of flights, one line each, into a buffer.
+ *
+ * Line format: id,name,origin,destination,DD-MM-YYYY HH:MM,status,seats
+ * If buffer fills up, the page ends early and the cursor stays after the
+ * last flight that fit.
+ *
+ * @param order The page order.
+ * @param cursor Where the page starts; advanced past the rendered flights.
+ * @param limit The maximum number of flights (capped at SERVICE_LIST_LIMIT).
+ * @param buffer Receives the lines.
+ * @param size The size of buffer.
+ * @param flightIDs Receives the IDs of the rendered flights (SERVICE_LIST_LIMIT entries, may be NULL).
+ * @return The number of flights rendered, or -1 if the page index could not be built.
+ */
+static int renderFlightPage(PageOrder order, PageCursor *cursor, int limit, char *buffer, size_t size, int *flightIDs) {
+    int indexes[SERVICE_LIST_LIMIT];
+    size_t used = 0;
+    int rendered = 0;
+    if (size == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    if (limit > SERVICE_LIST_LIMIT) {
+        limit = SERVICE_LIST_LIMIT;
+    }
+    pthread_rwlock_rdlock(&serviceLock);
+    int paged = serviceFlights != NULL ? pageFlights(*serviceFlights, *serviceFlightCount, order, cursor, limit, indexes) : 0;
+    for (int i = 0; i < paged; i++) {
+        const Flight *f = *serviceFlights + indexes[i];
+        int n = snprintf(buffer + used, size - used, "%d,%s,%s,%s,%02u-%02u-%04u %02u:%02u,%s,%d\n",
+                         f->flightID, f->flightName, f->origin, f->destination,
+                         f->departure.day, f->departure.month, f->departure.year,
+                         f->departure.hour, f->departure.minute,
+                         statusName(f->status), f->availableSeats);
+        if (n < 0 || (size_t)n >= size - used) {
+            buffer[used] = '\0'; // Drop the partial line and resume after the last full one
+            if (rendered > 0) {
+                const Flight *last = *serviceFlights + indexes[rendered - 1];
+                pageCursorAfter(cursor, order == PAGE_BY_DEPARTURE ? departureKey(&last->departure) : last->flightID,
+                                last->flightID);
+            }
+            break;
+        }
+        used += (size_t)n;
+        if (flightIDs != NULL) {
+            flightIDs[rendered] = f->flightID;
+        }
+        rendered++;
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return paged < 0 ? -1 : rendered;
+}
+
+/**
+ * @brief Renders the next page of flights, one line each, into a buffer.
+ *
+ * @param order The page order.
+ * @param cursor Where the page starts; advanced past the rendered flights.
+ * @param limit The maximum number of flights (capped at SERVICE_LIST_LIMIT).
+ * @param buffer Receives the lines.
+ * @param size The size of buffer.
+ * @return The number of flights rendered, or -1 if the page index could not be built.
+ */
+int serviceListFlights(PageOrder order, PageCursor *cursor, int limit, char *buffer, size_t size) {
+    return renderFlightPage(order, cursor, limit, buffer, size, NULL);
+}
+
+/**
+ * @brief Books a seat on an existing flight.
+ *
+ * @param passengerName The name of the passenger.
+ * @param flightID The ID of the flight.
+ * @param seatNo The 1-based seat number.
+ * @return The new ticket ID, or 0 on failure (e.g., unknown flight, seat taken).
+ */
+int serviceBookTicket(const char *passengerName, int flightID, int seatNo) {
+    int ticketID = 0;
+    if (seatNo < 1 || seatNo > MAX_PASSENGERS_PER_FLIGHT) {
+        return 0;
+    }
+    pthread_rwlock_wrlock(&serviceLock);
+    if (serviceFlights != NULL && findFlightIndex(*serviceFlights, *serviceFlightCount, flightID) != -1) {
+        ticketID = issueTicket(passengerName, flightID, seatNo);
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return ticketID;
+}
+
+/**
+ * @brief Cancels a ticket and releases its seat.
+ *
+ * @param ticketID The ID of the ticket.
+ * @return 1 on success, 0 if the ticket was not found.
+ */
+int serviceCancelTicket(int ticketID) {
+    pthread_rwlock_wrlock(&serviceLock);
+    int cancelled = revokeTicket(ticketID);
+    pthread_rwlock_unlock(&serviceLock);
+    return cancelled;
+}
+
+/**
+ * @brief Changes the status of a flight.
+ *
+ * @param flightID The ID of the flight.
+ * @param status The new status.
+ * @return 1 on success, 0 if the flight was not found.
+ */
+int serviceSetFlightStatus(int flightID, FlightStatus status) {
+    int changed = 0;
+    pthread_rwlock_wrlock(&serviceLock);
+    if (serviceFlights != NULL) {
+        changed = setFlightStatus(*serviceFlights, *serviceFlightCount, flightID, status);
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return changed;
+}
+
+/**
+ * @brief Pays for an existing ticket.
+ *
+ * @param ticketID The ID of the ticket.
+ * @param method The payment method.
+ * @param amount The amount to pay.
+ * @return 1 on success, 0 on failure (e.g., unknown ticket, invalid payment).
+ */
+int servicePay(int ticketID, const char *method, float amount) {
+    pthread_rwlock_rdlock(&serviceLock);
+    int exists = findTicketIndex(ticketID) != -1;
+    pthread_rwlock_unlock(&serviceLock);
+    return exists && processPayment(method, amount);
+}
+
+/**
+ * @brief Renders tickets with their flights, one line each, into a buffer.
+ *
+ * @param ticketIDs The IDs of the tickets.
+ * @param count The number of IDs (at most SERVICE_ITINERARY_LIMIT are used).
+ * @param buffer Receives the lines.
+ * @param size The size of buffer.
+ * @return The number of tickets rendered, or -1 if an ID index could not be built.
+ */
+int serviceGetItinerary(const int *ticketIDs, int count, char *buffer, size_t size) {
+    const Ticket *tickets[SERVICE_ITINERARY_LIMIT];
+    const Flight *flights[SERVICE_ITINERARY_LIMIT];
+    int flightIDs[SERVICE_ITINERARY_LIMIT];
+    size_t used = 0;
+    int rendered = 0, found = 0;
+    if (size == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    if (count > SERVICE_ITINERARY_LIMIT) {
+        count = SERVICE_ITINERARY_LIMIT;
+    }
+    pthread_rwlock_rdlock(&serviceLock);
+    if (serviceFlights != NULL) {
+        found = searchTickets(ticketIDs, count, tickets);
+    }
+    if (found > 0) {
+        int known = 0;
+        for (int i = 0; i < count; i++) {
+            if (tickets[i] != NULL) {
+                tickets[known] = tickets[i];
+                flightIDs[known++] = tickets[i]->flightID;
+            }
+        }
+        found = searchFlights(*serviceFlights, *serviceFlightCount, flightIDs, known, flights);
+        for (int i = 0; i < known && found > 0; i++) {
+            const Flight *f = flights[i];
+            if (f == NULL) {
+                continue;
+            }
+            int n = snprintf(buffer + used, size - used, "%d,%d,%s,%s,%02u-%02u-%04u %02u:%02u,%d\n",
+                             tickets[i]->ticketID, f->flightID, f->origin, f->destination,
+                             f->departure.day, f->departure.month, f->departure.year,
+                             f->departure.hour, f->departure.minute, tickets[i]->seatNo);
+            if (n < 0 || (size_t)n >= size - used) {
+                buffer[used] = '\0'; // Keep only full lines
+                break;
+            }
+            used += (size_t)n;
+            rendered++;
+        }
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return found < 0 ? -1 : rendered;
+}
+
+/**
+ * @brief Formats the normalized form of a request, the key of its cached response.
+ *
+ * @param key Receives the key (RESULT_CACHE_KEY_LEN bytes), or "" if it is too long to cache.
+ * @param format The printf format.
+ * @param ... The format arguments.
+ */
+static void formatRequestKey(char *key, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(key, RESULT_CACHE_KEY_LEN, format, args);
+    va_end(args);
+    if (length < 0 || length >= RESULT_CACHE_KEY_LEN) {
+        key[0] = '\0';
+    }
+}
+
+/**
+ * @brief Answers a request from the response cache.
+ *
+ * @param key The normalized request ("" if it cannot be cached).
+ * @param response Receives the cached response on a hit.
+ * @param size The size of response.
+ * @param token Receives the token for cacheResponse on a miss.
+ * @return 1 on a hit, 0 on a miss.
+ */
+static int cachedResponse(const char *key, char *response, size_t size, unsigned long *token) {
+    if (key[0] == '\0') {
+        return 0;
+    }
+    pthread_rwlock_rdlock(&serviceLock);
+    int hit = lookupCachedResult(key, response, size);
+    if (!hit) {
+        *token = resultCacheToken();
+    }
+    pthread_rwlock_unlock(&serviceLock);
+    return hit;
+}
+
+/**
+ * @brief Stores a computed response in the response cache.
+ *
+ * @param key The normalized request ("" if it cannot be cached).
+ * @param response The response.
+ * @param keys What the response was computed from.
+ * @param keyCount The number of keys.
+ * @param token The token cachedResponse returned with the miss.
+ */
+static void cacheResponse(const char *key, const char *response, const CacheKey *keys, int keyCount,
+                          unsigned long token) {
+    if (key[0] == '\0') {
+        return;
+    }
+    pthread_rwlock_rdlock(&serviceLock);
+    storeCachedResult(key, response, keys, keyCount, token);
+    pthread_rwlock_unlock(&serviceLock);
+}
+
+/**
+ * @brief Executes one protocol request line and writes its response.
+ *
+ * @param request The request line (a trailing newline is ignored).
+ * @param response Receives the response (SERVICE_RESPONSE_SIZE bytes is always enough).
+ * @param size The size of response.
+ * @return 1 if the request succeeded, 0 if it failed, -1 for SHUTDOWN.
+ */
+int executeRequest(const char *request, char *response, size_t size) {
+    char command[16] = "";
+    char key[RESULT_CACHE_KEY_LEN];
+    unsigned long token = 0;
+    int consumed = 0;
+    if (sscanf(request, "%15s%n", command, &consumed) != 1) {
+        snprintf(response, size, "ERR empty request\n");
+        return 0;
+    }
+    const char *args = request + consumed;
+
+    if (strcmp(command, "SEARCH") == 0) {
+        int flightID;
+        Flight f;
+        if (sscanf(args, "%d", &flightID) != 1) {
+            snprintf(response, size, "ERR usage: SEARCH <flightID>\n");
+            return 0;
+        }
+        formatRequestKey(key, "SEARCH %d", flightID);
+        long long start = nowNanos();
+        if (cachedResponse(key, response, size, &token)) {
+            // Only found flights are cached, so a hit is a successful search
+            recordLatency(STAT_FLIGHT_SEARCH, nowNanos() - start);
+            logSessionID(SESSION_FLIGHT_SEARCH, flightID, 1, start);
+            return 1;
+        }
+        if (!serviceSearchFlight(flightID, &f)) {
+            snprintf(response, size, "ERR flight not found\n");
+            return 0;
+        }
+        snprintf(response, size, "OK %d %s %s %d %s\n",
+                 f.flightID, f.origin, f.destination, f.availableSeats, statusName(f.status));
+        CacheKey keys[] = { cacheFlightKey(flightID) };
+        cacheResponse(key, response, keys, 1, token);
+        return 1;
+    }
+
+    if (strcmp(command, "ROUTE") == 0) {
+        char origin[MAX_NAME_LEN], destination[MAX_NAME_LEN];
+        int ids[SERVICE_ROUTE_LIMIT];
+        if (sscanf(args, "%99s %99s", origin, destination) != 2) {
+            snprintf(response, size, "ERR usage: ROUTE <origin> <destination>\n");
+            return 0;
+        }
+        formatRequestKey(key, "ROUTE %s %s", origin, destination);
+        if (cachedResponse(key, response, size, &token)) {
+            return 1;
+        }
+        int matches = serviceFindRoute(origin, destination, ids, SERVICE_ROUTE_LIMIT);
+        size_t used = (size_t)snprintf(response, size, "OK %d", matches);
+        for (int i = 0; i < matches && i < SERVICE_ROUTE_LIMIT && used < size; i++) {
+            used += (size_t)snprintf(response + used, size - used, " %d", ids[i]);
+        }
+        if (used < size) {
+            snprintf(response + used, size - used, "\n");
+        }
+        // The IDs come in array order
+        CacheKey keys[] = { cacheRouteKey(origin, destination), cacheGroupKey(CACHE_ARRAY_ORDER) };
+        cacheResponse(key, response, keys, 2, token);
+        return 1;
+    }
+
+    if (strcmp(command, "AVAIL") == 0) {
+        // AVAIL <origin|*> <destination|*> <minSeats> [SEATS|DEPARTURE] [<k>]
+        char origin[MAX_NAME_LEN], destination[MAX_NAME_LEN], orderName[16] = "SEATS";
+        int minSeats, k = SERVICE_ROUTE_LIMIT;
+        int ids[SERVICE_ROUTE_LIMIT];
+        int parsed = sscanf(args, "%99s %99s %d %15s %d", origin, destination, &minSeats, orderName, &k);
+        int byDeparture = strcmp(orderName, "DEPARTURE") == 0;
+        if (parsed < 3 || (!byDeparture && strcmp(orderName, "SEATS") != 0) || k < 0 ||
+            (strcmp(origin, "*") == 0) != (strcmp(destination, "*") == 0)) {
+            snprintf(response, size, "ERR usage: AVAIL <origin|*> <destination|*> <minSeats> [SEATS|DEPARTURE] [<k>]\n");
+            return 0;
+        }
+        if (k > SERVICE_ROUTE_LIMIT) {
+            k = SERVICE_ROUTE_LIMIT;
+        }
+        formatRequestKey(key, "AVAIL %s %s %d %s %d", origin, destination, minSeats, orderName, k);
+        if (cachedResponse(key, response, size, &token)) {
+            return 1;
+        }
+        int matches = serviceFindAvailable(strcmp(origin, "*") == 0 ? NULL : origin, destination, minSeats,
+                                           byDeparture ? AVAIL_BY_DEPARTURE : AVAIL_BY_SEATS, ids, k);
+        if (matches < 0) {
+            snprintf(response, size, "ERR out of memory\n");
+            return 0;
+        }
+        size_t used = (size_t)snprintf(response, size, "OK %d", matches);
+        for (int i = 0; i < matches && i < k && used < size; i++) {
+            used += (size_t)snprintf(response + used, size - used, " %d", ids[i]);
+        }
+        if (used < size) {
+            snprintf(response + used, size - used, "\n");
+        }
+        CacheKey keys[] = { strcmp(origin, "*") == 0 ? cacheGroupKey(CACHE_ALL_FLIGHTS)
+                                                     : cacheRouteKey(origin, destination) };
+        cacheResponse(key, response, keys, 1, token);
+        return 1;
+    }
+
+    if (strcmp(command, "AGG") == 0) {
+        // AGG ROUTE <origin> <destination> | AGG DAY <YYYY-MM-DD> | AGG ALL
+        char scope[16] = "", origin[MAX_NAME_LEN], destination[MAX_NAME_LEN];
+        unsigned int year, month, day;
+        AggregateView view;
+        int ok;
+        sscanf(args, "%15s", scope);
+        if (strcmp(scope, "ROUTE") == 0 && sscanf(args, "%*s %99s %99s", origin, destination) == 2) {
+            ok = serviceGetAggregate(origin, destination, NULL, &view);
+        } else if (strcmp(scope, "DAY") == 0 && sscanf(args, "%*s %u-%u-%u", &year, &month, &day) == 3) {
+            DateTime date = { 0 };
+            date.day = day;
+            date.month = month;
+            date.year = year;
+            ok = serviceGetAggregate(NULL, NULL, &date, &view);
+        } else if (strcmp(scope, "ALL") == 0) {
+            ok = serviceGetAggregate(NULL, NULL, NULL, &view);
+        } else {
+            snprintf(response, size, "ERR usage: AGG ROUTE <origin> <destination> | AGG DAY <YYYY-MM-DD> | AGG ALL\n");
+            return 0;
+        }
+        if (!ok) {
+            snprintf(response, size, "ERR out of memory\n");
+            return 0;
+        }
+        snprintf(response, size, "OK %d %lld %lld %.4f\n",
+                 view.flights, view.seatsSold, view.seatCapacity, aggregateLoadFactor(&view));
+        return 1;
+    }
+
+    if (strcmp(command, "LIST") == 0) {
+        // LIST [ID|DEPARTURE] [<cursor> [<limit>]]
+        char orderName[16] = "ID", cursorText[PAGE_CURSOR_TEXT_SIZE] = "-";
+        int limit = SERVICE_LIST_LIMIT;
+        PageOrder order = PAGE_BY_ID;
+        PageCursor cursor;
+        if (sscanf(args, "%15s %47s %d", orderName, cursorText, &limit) >= 1) {
+            if (strcmp(orderName, "DEPARTURE") == 0) {
+                order = PAGE_BY_DEPARTURE;
+            } else if (strcmp(orderName, "ID") != 0) {
+                snprintf(response, size, "ERR usage: LIST [ID|DEPARTURE] [<cursor> [<limit>]]\n");
+                return 0;
+            }
+        }
+        if (!parsePageCursor(cursorText, order, &cursor) || limit < 1) {
+            snprintf(response, size, "ERR invalid cursor or limit\n");
+            return 0;
+        }
+        if (limit > SERVICE_LIST_LIMIT) {
+            limit = SERVICE_LIST_LIMIT;
+        }
+        formatPageCursor(&cursor, order, cursorText, sizeof(cursorText));
+        formatRequestKey(key, "LIST %s %s %d", order == PAGE_BY_DEPARTURE ? "DEPARTURE" : "ID", cursorText, limit);
+        if (cachedResponse(key, response, size, &token)) {
+            return 1;
+        }
+
+        // The count line is written after rendering, so reserve room for it first
+        const size_t header = 24 + PAGE_CURSOR_TEXT_SIZE;
+        if (size <= header + 2) {
+            snprintf(response, size, "ERR buffer too small\n");
+            return 0;
+        }
+        int flightIDs[SERVICE_LIST_LIMIT];
+        int rendered = renderFlightPage(order, &cursor, limit, response + header, size - header - 2, flightIDs);
+        if (rendered < 0) {
+            snprintf(response, size, "ERR out of memory\n");
+            return 0;
+        }
+        size_t bodyLength = strlen(response + header);
+        formatPageCursor(&cursor, order, cursorText, sizeof(cursorText));
+        int headerLength = snprintf(response, header, "OK %d %s\n", rendered, cursorText);
+        memmove(response + headerLength, response + header, bodyLength);
+        memcpy(response + headerLength + bodyLength, ".\n", 3);
+
+        // The page changes if a flight is added or removed, or if one of its flights changes
+        CacheKey keys[SERVICE_LIST_LIMIT + 1];
+        keys[0] = cacheGroupKey(CACHE_MEMBERSHIP);
+        for (int i = 0; i < rendered; i++) {
+            keys[i + 1] = cacheFlightKey(flightIDs[i]);
+        }
+        cacheResponse(key, response, keys, rendered + 1, token);
+        return 1;
+    }
+
+    if (strcmp(command, "BOOK") == 0) {
+        int flightID, seatNo, nameStart = 0;
+        if (sscanf(args, "%d %d %n", &flightID, &seatNo, &nameStart) != 2 || nameStart == 0 || args[nameStart] == '\0') {
+            snprintf(response, size, "ERR usage: BOOK <flightID> <seatNo> <name>\n");
+            return 0;
+        }
+        char name[MAX_NAME_LEN];
+        strncpy(name, args + nameStart, MAX_NAME_LEN - 1);
+        name[MAX_NAME_LEN - 1] = '\0';
+        name[strcspn(name, "\r\n")] = '\0';
+        int ticketID = serviceBookTicket(name, flightID, seatNo);
+        if (ticketID == 0) {
+            snprintf(response, size, "ERR seat unavailable\n");
+            return 0;
+        }
+        snprintf(response, size, "OK %d\n", ticketID);
+        return 1;
+    }
+
+    if (strcmp(command, "CANCEL") == 0) {
+        int ticketID;
+        if (sscanf(args, "%d", &ticketID) != 1) {
+            snprintf(response, size, "ERR usage: CANCEL <ticketID>\n");
+            return 0;
+        }
+        if (!serviceCancelTicket(ticketID)) {
+            snprintf(response, size, "ERR ticket not found\n");
+            return 0;
+        }
+        snprintf(response, size, "OK\n");
+        return 1;
+    }
+
+    if (strcmp(command, "STATUS") == 0) {
+        int flightID, status = -1;
+        char name[16];
+        if (sscanf(args, "%d %15s", &flightID, name) == 2) {
+            for (int s = ON_TIME; s <= CANCELLED; s++) {
+                if (strcmp(name, statusNames[s]) == 0) {
+                    status = s;
+                }
+            }
+        }
+        if (status < 0) {
+            snprintf(response, size, "ERR usage: STATUS <flightID> <ON_TIME|DELAYED|CANCELLED>\n");
+            return 0;
+        }
+        if (!serviceSetFlightStatus(flightID, (FlightStatus)status)) {
+            snprintf(response, size, "ERR flight not found\n");
+            return 0;
+        }
+        snprintf(response, size, "OK\n");
+        return 1;
+    }
+
+    if (strcmp(command, "PAY") == 0) {
+        int ticketID;
+        char method[MAX_NAME_LEN];
+        float amount;
+        if (sscanf(args, "%d %99s %f", &ticketID, method, &amount) != 3) {
+            snprintf(response, size, "ERR usage: PAY <ticketID> <method> <amount>\n");
+            return 0;
+        }
+        if (!servicePay(ticketID, method, amount)) {
+            snprintf(response, size, "ERR payment rejected\n");
+            return 0;
+        }
+        snprintf(response, size, "OK\n");
+        return 1;
+    }
+
+    if (strcmp(command, "ITINERARY") == 0) {
+        int ticketIDs[SERVICE_ITINERARY_LIMIT];
+        int count = 0, used = 0;
+        while (count < SERVICE_ITINERARY_LIMIT && sscanf(args, "%d%n", &ticketIDs[count], &used) == 1) {
+            args += used;
+            count++;
+        }
+        if (count == 0) {
+            snprintf(response, size, "ERR usage: ITINERARY <ticketID> [<ticketID> ...]\n");
+            return 0;
+        }
+        const size_t header = 24; // "OK <count>\n" is written after rendering
+        if (size <= header + 2) {
+            snprintf(response, size, "ERR buffer too small\n");
+            return 0;
+        }
+        int rendered = serviceGetItinerary(ticketIDs, count, response + header, size - header - 2);
+        if (rendered < 0) {
+            snprintf(response, size, "ERR out of memory\n");
+            return 0;
+        }
+        size_t bodyLength = strlen(response + header);
+        int headerLength = snprintf(response, header, "OK %d\n", rendered);
+        memmove(response + headerLength, response + header, bodyLength);
+        memcpy(response + headerLength + bodyLength, ".\n", 3);
+        return 1;
+    }
+
+    if (strcmp(command, "CACHE") == 0) {
+        long long hits, misses;
+        int entries;
+        getResultCacheCounts(&hits, &misses, &entries);
+        snprintf(response, size, "OK %lld %lld %d\n", hits, misses, entries);
+        return 1;
+    }
+
+    if (strcmp(command, "SHUTDOWN") == 0) {
+        snprintf(response, size, "OK\n");
+        return -1;
+    }
+
+    snprintf(response, size, "ERR unknown command %s\n", command);
+    return 0;
+}
@@ -0,0 +1,758 @@
+/**
+ * @file session.c
+ * @brief Implementation of session recording and replay.
+ *
+ * Recording hooks are called from every core operation, so the inactive path
+ * is a single atomic load. When active, a record is encoded into a small
+ * buffer and appended to the log under a mutex (server connections may call
+ * the core operations from several threads). Replay reads the whole log into
+ * memory first, so file I/O does not disturb the calls being measured.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For malloc, free
+#include <string.h>
+#include <pthread.h>
+
+#if defined(_WIN32)
+#include <windows.h> // For Sleep
+#else
+#include <time.h>    // For clock_nanosleep
+#endif
+
+#include "session.h"
+#include "flight.h"
+#include "passenger.h"
+#include "ticket.h"
+#include "payment.h"
+#include "stats.h"
+#include "timing.h"
+
+/**
+ * @def SESSION_MAGIC
+ * @brief First bytes of every session log (format version included).
+ */
+#define SESSION_MAGIC "FSSESS01"
+
+/**
+ * @def SESSION_MAGIC_LEN
+ * @brief Length of SESSION_MAGIC.
+ */
+#define SESSION_MAGIC_LEN 8
+
+/**
+ * @def SESSION_MAX_RECORD
+ * @brief Upper bound on the encoded size of one record.
+ */
+#define SESSION_MAX_RECORD (64 + 4 * MAX_NAME_LEN + SEAT_MAP_BYTES)
+
+/**
+ * @struct RecordBuffer
+ * @brief One record being encoded.
+ */
+typedef struct {
+    unsigned char bytes[SESSION_MAX_RECORD]; /**< Encoded bytes. */
+    size_t length;                           /**< Number of bytes used. */
+} RecordBuffer;
+
+/**
+ * @struct LogReader
+ * @brief Cursor over a log loaded into memory.
+ */
+typedef struct {
+    const unsigned char *next;  /**< Next unread byte. */
+    const unsigned char *end;   /**< One past the last byte. */
+    int ok;                     /**< 0 once a read ran past the end. */
+} LogReader;
+
+static FILE *sessionFile = NULL;          /**< The open log, NULL when not recording. */
+static int sessionActive = 0;             /**< 1 while recording (checked without the lock). */
+static long long sessionLastStart = 0;    /**< Start time of the previous record. */
+static long long sessionRecords = 0;      /**< Records written to the open log. */
+static pthread_mutex_t sessionLock = PTHREAD_MUTEX_INITIALIZER; /**< Serializes writers. */
+
+/**
+ * @var sessionOpNames
+ * @brief Display names, indexed by SessionOp.
+ */
+static const char *const sessionOpNames[SESSION_OP_COUNT] = {
+    "insertFlight", "removeFlight", "searchFlight", "sortFlightsByDeparture",
+    "insertPassenger", "erasePassenger", "issueTicket", "revokeTicket", "processPayment",
+    "setFlightStatus"
+};
+
+/**
+ * @brief Appends one byte to a record.
+ *
+ * @param record The record.
+ * @param value The byte.
+ */
+static void putByte(RecordBuffer *record, unsigned char value) {
+    if (record->length < SESSION_MAX_RECORD) {
+        record->bytes[record->length++] = value;
+    }
+}
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ *
+ * @param record The record.
+ * @param value The value.
+ */
+static void putVarint(RecordBuffer *record, unsigned long long value) {
+    while (value >= 0x80) {
+        putByte(record, (unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    putByte(record, (unsigned char)value);
+}
+
+/**
+ * @brief Appends a signed value as a zigzag varint (small magnitudes stay short).
+ *
+ * @param record The record.
+ * @param value The value.
+ */
+static void putSigned(RecordBuffer *record, long long value) {
+    putVarint(record, ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+}
+
+/**
+ * @brief Appends a length-prefixed string.
+ *
+ * @param record The record.
+ * @param text The string (at most MAX_NAME_LEN - 1 bytes are kept).
+ */
+static void putString(RecordBuffer *record, const char *text) {
+    size_t length = strnlen(text, MAX_NAME_LEN - 1);
+    putVarint(record, length);
+    if (record->length + length <= SESSION_MAX_RECORD) {
+        memcpy(record->bytes + record->length, text, length);
+        record->length += length;
+    }
+}
+
+/**
+ * @brief Appends a 32-bit value, little-endian.
+ *
+ * @param record The record.
+ * @param value The value.
+ */
+static void putU32(RecordBuffer *record, unsigned int value) {
+    for (int i = 0; i < 4; i++) {
+        putByte(record, (unsigned char)(value >> (8 * i)));
+    }
+}
+
+/**
+ * @brief Packs a DateTime into its 32 bits.
+ *
+ * @param dt The date and time.
+ * @return The packed value.
+ */
+static unsigned int packDateTime(DateTime dt) {
+    return dt.day | dt.month << 5 | (unsigned int)dt.year << 9 |
+           (unsigned int)dt.hour << 21 | (unsigned int)dt.minute << 26;
+}
+
+/**
+ * @brief Unpacks a DateTime packed by packDateTime.
+ *
+ * @param value The packed value.
+ * @return The date and time.
+ */
+static DateTime unpackDateTime(unsigned int value) {
+    DateTime dt;
+    dt.day = value & 0x1F;
+    dt.month = (value >> 5) & 0xF;
+    dt.year = (value >> 9) & 0xFFF;
+    dt.hour = (value >> 21) & 0x1F;
+    dt.minute = (value >> 26) & 0x3F;
+    return dt;
+}
+
+/**
+ * @brief Starts a record: op byte, start-time delta and result.
+ *
+ * Must be called with sessionLock held.
+ *
+ * @param record The record to start.
+ * @param op The operation.
+ * @param result The call's return value.
+ * @param start When the call started.
+ */
+static void beginRecord(RecordBuffer *record, SessionOp op, int result, long long start) {
+    record->length = 0;
+    putByte(record, (unsigned char)op);
+    putSigned(record, start - sessionLastStart); // Calls overlapping on other threads give negative deltas
+    putSigned(record, result);
+    sessionLastStart = start;
+}
+
+/**
+ * @brief Appends a finished record to the log.
+ *
+ * Must be called with sessionLock held.
+ *
+ * @param record The record.
+ */
+static void writeRecord(const RecordBuffer *record) {
+    if (fwrite(record->bytes, 1, record->length, sessionFile) == record->length) {
+        sessionRecords++;
+    }
+}
+
+/**
+ * @brief Locks the log if a recording is running.
+ *
+ * @return 1 with sessionLock held, 0 (not locked) if not recording.
+ */
+static int lockSession(void) {
+    if (!__atomic_load_n(&sessionActive, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    pthread_mutex_lock(&sessionLock);
+    if (sessionFile == NULL) {
+        pthread_mutex_unlock(&sessionLock);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Starts recording to a new log file.
+ *
+ * @param filename The log file (overwritten).
+ * @param flightCount Flights loaded when recording starts.
+ * @param passengerCount Passengers loaded when recording starts.
+ * @param ticketCount Tickets loaded when recording starts.
+ * @return 1 on success, 0 on failure (e.g., already recording, file cannot be opened).
+ */
+int startSessionRecording(const char *filename, int flightCount, int passengerCount, int ticketCount) {
+    pthread_mutex_lock(&sessionLock);
+    if (sessionFile != NULL) {
+        pthread_mutex_unlock(&sessionLock);
+        printf("A session is already being recorded.\n");
+        return 0;
+    }
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        pthread_mutex_unlock(&sessionLock);
+        printf("Error: Could not open %s for writing.\n", filename);
+        return 0;
+    }
+    RecordBuffer header;
+    header.length = 0;
+    memcpy(header.bytes, SESSION_MAGIC, SESSION_MAGIC_LEN);
+    header.length = SESSION_MAGIC_LEN;
+    putVarint(&header, (unsigned long long)flightCount);
+    putVarint(&header, (unsigned long long)passengerCount);
+    putVarint(&header, (unsigned long long)ticketCount);
+    fwrite(header.bytes, 1, header.length, fp);
+
+    sessionFile = fp;
+    sessionRecords = 0;
+    sessionLastStart = nowNanos();
+    __atomic_store_n(&sessionActive, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&sessionLock);
+    printf("Recording session to %s.\n", filename);
+    return 1;
+}
+
+/**
+ * @brief Stops recording and closes the log.
+ *
+ * @return 1 on success, 0 if no recording was running.
+ */
+int stopSessionRecording() {
+    pthread_mutex_lock(&sessionLock);
+    if (sessionFile == NULL) {
+        pthread_mutex_unlock(&sessionLock);
+        return 0;
+    }
+    __atomic_store_n(&sessionActive, 0, __ATOMIC_RELEASE);
+    fclose(sessionFile);
+    sessionFile = NULL;
+    long long records = sessionRecords;
+    pthread_mutex_unlock(&sessionLock);
+    printf("Session recording stopped (%lld operations).\n", records);
+    return 1;
+}
+
+/**
+ * @brief Reports whether a recording is running.
+ *
+ * @return 1 if recording, 0 otherwise.
+ */
+int isSessionRecording() {
+    return __atomic_load_n(&sessionActive, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Records an insertFlight call.
+ *
+ * @param flight The flight passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionFlightAdd(const Flight *flight, int result, long long start) {
+    if (!lockSession()) {
+        return;
+    }
+    RecordBuffer record;
+    beginRecord(&record, SESSION_FLIGHT_ADD, result, start);
+    putSigned(&record, flight->flightID);
+    putString(&record, flight->flightName);
+    putString(&record, flight->origin);
+    putString(&record, flight->destination);
+    putU32(&record, packDateTime(flight->departure));
+    putU32(&record, packDateTime(flight->arrival));
+    putByte(&record, (unsigned char)flight->status);
+    putSigned(&record, flight->availableSeats);
+
+    // New flights usually have an empty seat map; only a non-empty one is stored
+    int hasSeats = 0;
+    for (int i = 0; i < SEAT_MAP_BYTES && !hasSeats; i++) {
+        hasSeats = flight->seatMap[i] != 0;
+    }
+    putByte(&record, (unsigned char)hasSeats);
+    if (hasSeats) {
+        memcpy(record.bytes + record.length, flight->seatMap, SEAT_MAP_BYTES);
+        record.length += SEAT_MAP_BYTES;
+    }
+    writeRecord(&record);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+/**
+ * @brief Records a call that takes only an ID (delete, search, cancel) or nothing (sort).
+ *
+ * @param op SESSION_FLIGHT_DELETE, SESSION_FLIGHT_SEARCH, SESSION_TICKET_CANCEL or SESSION_FLIGHT_SORT.
+ * @param id The flight or ticket ID (ignored for SESSION_FLIGHT_SORT).
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionID(SessionOp op, int id, int result, long long start) {
+    if (!lockSession()) {
+        return;
+    }
+    RecordBuffer record;
+    beginRecord(&record, op, result, start);
+    if (op != SESSION_FLIGHT_SORT) {
+        putSigned(&record, id);
+    }
+    writeRecord(&record);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+/**
+ * @brief Records an insertPassenger call.
+ *
+ * @param passenger The passenger passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionPassengerAdd(const struct Passenger *passenger, int result, long long start) {
+    if (!lockSession()) {
+        return;
+    }
+    RecordBuffer record;
+    beginRecord(&record, SESSION_PASSENGER_ADD, result, start);
+    putString(&record, passenger->name);
+    putSigned(&record, passenger->age);
+    putString(&record, passenger->passport);
+    putSigned(&record, passenger->assignedFlightID);
+    putSigned(&record, passenger->assignedSeatNo);
+    writeRecord(&record);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+/**
+ * @brief Records an erasePassenger call.
+ *
+ * @param passport The passport passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionPassengerRemove(const char *passport, int result, long long start) {
+    if (!lockSession()) {
+        return;
+    }
+    RecordBuffer record;
+    beginRecord(&record, SESSION_PASSENGER_REMOVE, result, start);
+    putString(&record, passport);
+    writeRecord(&record);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+/**
+ * @brief Records an issueTicket call.
+ *
+ * @param passengerName The name passed in.
+ * @param flightID The flight ID passed in.
+ * @param seatNo The seat number passed in.
+ * @param ticketID The issued ticket ID, or 0.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionTicketBook(const char *passengerName, int flightID, int seatNo, int ticketID, long long start) {
+    if (!lockSession()) {
+        return;
+    }
+    RecordBuffer record;
+    beginRecord(&record, SESSION_TICKET_BOOK, ticketID, start);
+    putString(&record, passengerName);
+    putSigned(&record, flightID);
+    putSigned(&record, seatNo);
+    writeRecord(&record);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+/**
+ * @brief Records a processPayment call (stamped with the current time).
+ *
+ * @param method The method passed in.
+ * @param amount The amount passed in.
+ * @param result The call's return value.
+ */
+void logSessionPayment(const char *method, float amount, int result) {
+    if (!lockSession()) {
+        return;
+    }
+    unsigned int bits;
+    memcpy(&bits, &amount, sizeof(bits));
+    RecordBuffer record;
+    beginRecord(&record, SESSION_PAYMENT, result, nowNanos());
+    putString(&record, method != NULL ? method : "");
+    putU32(&record, bits);
+    writeRecord(&record);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+/**
+ * @brief Records a setFlightStatus call.
+ *
+ * @param flightID The flight ID passed in.
+ * @param status The status passed in.
+ * @param result The call's return value.
+ * @param start When the call started (nowNanos).
+ */
+void logSessionFlightStatus(int flightID, FlightStatus status, int result, long long start) {
+    if (!lockSession()) {
+        return;
+    }
+    RecordBuffer record;
+    beginRecord(&record, SESSION_FLIGHT_STATUS, result, start);
+    putSigned(&record, flightID);
+    putByte(&record, (unsigned char)status);
+    writeRecord(&record);
+    pthread_mutex_unlock(&sessionLock);
+}
+
+/**
+ * @brief Reads one byte.
+ *
+ * @param reader The cursor.
+ * @return The byte, or 0 past the end (reader->ok is cleared).
+ */
+static unsigned char getByte(LogReader *reader) {
+    if (reader->next >= reader->end) {
+        reader->ok = 0;
+        return 0;
+    }
+    return *reader->next++;
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ *
+ * @param reader The cursor.
+ * @return The value.
+ */
+static unsigned long long getVarint(LogReader *reader) {
+    unsigned long long value = 0;
+    for (int shift = 0; shift < 64 && reader->ok; shift += 7) {
+        unsigned char byte = getByte(reader);
+        value |= (unsigned long long)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    reader->ok = 0;
+    return 0;
+}
+
+/**
+ * @brief Reads a zigzag-encoded signed varint.
+ *
+ * @param reader The cursor.
+ * @return The value.
+ */
+static long long getSigned(LogReader *reader) {
+    unsigned long long value = getVarint(reader);
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+/**
+ * @brief Reads a length-prefixed string.
+ *
+ * @param reader The cursor.
+ * @param text Receives the string, NUL-terminated.
+ * @param size The size of text.
+ */
+static void getString(LogReader *reader, char *text, size_t size) {
+    unsigned long long length = getVarint(reader);
+    if (!reader->ok || length >= size || length > (unsigned long long)(reader->end - reader->next)) {
+        reader->ok = 0;
+        text[0] = '\0';
+        return;
+    }
+    memcpy(text, reader->next, (size_t)length);
+    text[length] = '\0';
+    reader->next += length;
+}
+
+/**
+ * @brief Reads a little-endian 32-bit value.
+ *
+ * @param reader The cursor.
+ * @return The value.
+ */
+static unsigned int getU32(LogReader *reader) {
+    unsigned int value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (unsigned int)getByte(reader) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Sleeps until a nowNanos timestamp.
+ *
+ * @param when The wake-up time.
+ */
+static void sleepUntilNanos(long long when) {
+    long long remaining = when - nowNanos();
+    if (remaining <= 0) {
+        return;
+    }
+#if defined(_WIN32)
+    Sleep((DWORD)(remaining / 1000000));
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)(remaining / 1000000000LL);
+    ts.tv_nsec = (long)(remaining % 1000000000LL);
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/**
+ * @brief Loads a whole file into memory.
+ *
+ * @param filename The file.
+ * @param length Receives its length.
+ * @return The bytes (free with free), or NULL on failure.
+ */
+static unsigned char *readWholeFile(const char *filename, size_t *length) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        printf("Error: Could not open %s.\n", filename);
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    unsigned char *bytes = size >= 0 ? (unsigned char *)malloc((size_t)size + 1) : NULL;
+    if (bytes == NULL || fread(bytes, 1, (size_t)size, fp) != (size_t)size) {
+        printf("Error: Could not read %s.\n", filename);
+        free(bytes);
+        fclose(fp);
+        return NULL;
+    }
+    fclose(fp);
+    *length = (size_t)size;
+    return bytes;
+}
+
+/**
+ * @brief Re-executes a recorded session against the core API.
+ *
+ * @param filename The log file.
+ * @param flights The flight table.
+ * @param flightCount The number of flights, updated by adds and deletes.
+ * @param paced 1 to wait between calls as recorded, 0 to replay as fast as possible.
+ * @param stats Receives the outcome.
+ * @return 1 on success, 0 if the log cannot be read or is not a session log.
+ */
+int replaySession(const char *filename, Flight *flights, int *flightCount, int paced, SessionReplayStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    size_t length = 0;
+    unsigned char *log = readWholeFile(filename, &length);
+    if (log == NULL) {
+        return 0;
+    }
+    if (length < SESSION_MAGIC_LEN || memcmp(log, SESSION_MAGIC, SESSION_MAGIC_LEN) != 0) {
+        printf("Error: %s is not a session log.\n", filename);
+        free(log);
+        return 0;
+    }
+
+    LogReader reader = { log + SESSION_MAGIC_LEN, log + length, 1 };
+    long long startFlights = (long long)getVarint(&reader);
+    long long startPassengers = (long long)getVarint(&reader);
+    long long startTickets = (long long)getVarint(&reader);
+    if (startFlights != *flightCount || startPassengers != globalPassengerCount || startTickets != globalTicketCount) {
+        printf("Warning: the session started with %lld flights, %lld passengers and %lld tickets; "
+               "replaying against %d, %d and %d, so results may diverge.\n",
+               startFlights, startPassengers, startTickets, *flightCount, globalPassengerCount, globalTicketCount);
+    }
+
+    long long recordedTime = 0;     // Start of the current call relative to the first one
+    long long replayStart = nowNanos();
+    int first = 1;
+    while (reader.ok && reader.next < reader.end) {
+        SessionOp op = (SessionOp)getByte(&reader);
+        long long delta = getSigned(&reader);
+        long long expected = getSigned(&reader);
+        if (first) {
+            first = 0; // The first delta is the idle time before the first call
+        } else {
+            recordedTime += delta;
+        }
+
+        // Decode the arguments before waiting, so pacing is not skewed by decoding
+        Flight flight;
+        Passenger passenger;
+        char text[MAX_NAME_LEN];
+        int id = 0;
+        int seatNo = 0;
+        float amount = 0.0f;
+        FlightStatus status = ON_TIME;
+        switch (op) {
+            case SESSION_FLIGHT_ADD:
+                memset(&flight, 0, sizeof(flight));
+                flight.flightID = (int)getSigned(&reader);
+                getString(&reader, flight.flightName, MAX_NAME_LEN);
+                getString(&reader, flight.origin, MAX_NAME_LEN);
+                getString(&reader, flight.destination, MAX_NAME_LEN);
+                flight.departure = unpackDateTime(getU32(&reader));
+                flight.arrival = unpackDateTime(getU32(&reader));
+                flight.status = (FlightStatus)getByte(&reader);
+                flight.availableSeats = (int)getSigned(&reader);
+                if (getByte(&reader)) {
+                    for (int i = 0; i < SEAT_MAP_BYTES; i++) {
+                        flight.seatMap[i] = getByte(&reader);
+                    }
+                }
+                break;
+            case SESSION_FLIGHT_DELETE:
+            case SESSION_FLIGHT_SEARCH:
+            case SESSION_TICKET_CANCEL:
+                id = (int)getSigned(&reader);
+                break;
+            case SESSION_FLIGHT_SORT:
+                break;
+            case SESSION_PASSENGER_ADD:
+                memset(&passenger, 0, sizeof(passenger));
+                getString(&reader, passenger.name, MAX_NAME_LEN);
+                passenger.age = (int)getSigned(&reader);
+                getString(&reader, passenger.passport, sizeof(passenger.passport));
+                passenger.assignedFlightID = (int)getSigned(&reader);
+                passenger.assignedSeatNo = (int)getSigned(&reader);
+                break;
+            case SESSION_PASSENGER_REMOVE:
+                getString(&reader, text, sizeof(text));
+                break;
+            case SESSION_TICKET_BOOK:
+                getString(&reader, text, sizeof(text));
+                id = (int)getSigned(&reader);
+                seatNo = (int)getSigned(&reader);
+                break;
+            case SESSION_PAYMENT: {
+                getString(&reader, text, sizeof(text));
+                unsigned int bits = getU32(&reader);
+                memcpy(&amount, &bits, sizeof(amount));
+                break;
+            }
+            case SESSION_FLIGHT_STATUS:
+                id = (int)getSigned(&reader);
+                status = (FlightStatus)getByte(&reader);
+                break;
+            default:
+                reader.ok = 0; // Unknown op: the rest of the log cannot be decoded
+                break;
+        }
+        if (!reader.ok) {
+            break;
+        }
+        if (paced) {
+            sleepUntilNanos(replayStart + recordedTime);
+        }
+
+        long long result = 0;
+        switch (op) {
+            case SESSION_FLIGHT_ADD:
+                result = insertFlight(flights, flightCount, &flight);
+                break;
+            case SESSION_FLIGHT_DELETE:
+                result = removeFlight(flights, flightCount, id);
+                break;
+            case SESSION_FLIGHT_SEARCH: {
+                // searchFlight without its "not found" message
+                long long start = nowNanos();
+                result = findFlightIndex(flights, *flightCount, id) != -1;
+                recordLatency(STAT_FLIGHT_SEARCH, nowNanos() - start);
+                break;
+            }
+            case SESSION_FLIGHT_SORT:
+                result = sortFlightsByDeparture(flights, *flightCount);
+                break;
+            case SESSION_PASSENGER_ADD:
+                result = insertPassenger(&passenger);
+                break;
+            case SESSION_PASSENGER_REMOVE:
+                result = erasePassenger(text);
+                break;
+            case SESSION_TICKET_BOOK:
+                result = issueTicket(text, id, seatNo);
+                break;
+            case SESSION_TICKET_CANCEL:
+                result = revokeTicket(id);
+                break;
+            case SESSION_PAYMENT:
+                result = processPayment(text, amount);
+                break;
+            case SESSION_FLIGHT_STATUS:
+                result = setFlightStatus(flights, *flightCount, id, status);
+                break;
+            default:
+                break;
+        }
+        stats->operations[op]++;
+        if (result != expected) {
+            stats->diverged[op]++;
+        }
+    }
+
+    stats->elapsedNs = nowNanos() - replayStart;
+    stats->recordedNs = recordedTime;
+    stats->complete = reader.ok;
+    if (!reader.ok) {
+        printf("Warning: %s ends in a truncated or corrupt record; replayed the operations before it.\n", filename);
+    }
+    free(log);
+    return 1;
+}
+
+/**
+ * @brief Returns the display name of an operation.
+ *
+ * @param op The operation.
+ * @return A constant string such as "issueTicket".
+ */
+const char *sessionOpName(SessionOp op) {
+    if (op < 0 || op >= SESSION_OP_COUNT) {
+        return "unknown";
+    }
+    return sessionOpNames[op];
+}
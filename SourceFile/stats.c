@@ -0,0 +1,370 @@
+/**
+ * @file stats.c
+ * @brief Implementation of per-operation latency histograms.
+ *
+ * Histograms use HDR-style log-linear buckets: values below
+ * 2^STAT_SUB_BUCKET_BITS nanoseconds are exact, and every larger power of two
+ * is split into 2^STAT_SUB_BUCKET_BITS linear sub-buckets. Each thread lazily
+ * allocates its own histogram set and registers it once in a global list;
+ * after that, recording touches only thread-local memory. Merging walks the
+ * list and sums the buckets with relaxed atomic loads. When a thread exits,
+ * a thread-specific key destructor adds its counts to one retired set and
+ * frees its histograms, so short-lived threads (e.g., one per server
+ * connection) do not accumulate memory.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For calloc, free
+#include <pthread.h>
+
+#include "stats.h"
+
+/**
+ * @struct ThreadHistograms
+ * @brief One thread's histograms for every operation.
+ */
+typedef struct ThreadHistograms {
+    long long buckets[STAT_OP_COUNT][STAT_BUCKETS]; /**< Per-operation bucket counts. */
+    struct ThreadHistograms *next;                  /**< Next registered set. */
+} ThreadHistograms;
+
+/**
+ * @var localHistograms
+ * @brief The calling thread's histogram set (NULL until its first recording).
+ */
+static _Thread_local ThreadHistograms *localHistograms = NULL;
+
+/**
+ * @var registeredHistograms
+ * @brief Head of the list of every running thread's histogram set.
+ */
+static ThreadHistograms *registeredHistograms = NULL;
+
+/**
+ * @var retiredBuckets
+ * @brief Summed counts of every thread that has exited, so they remain part of the merged view.
+ */
+static long long retiredBuckets[STAT_OP_COUNT][STAT_BUCKETS];
+
+/**
+ * @var registryLock
+ * @brief Guards registration, retirement and retiredBuckets; recording never takes it.
+ */
+static pthread_mutex_t registryLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @var histogramKey
+ * @brief Thread-specific key whose destructor retires an exiting thread's set.
+ */
+static pthread_key_t histogramKey;
+
+/**
+ * @var histogramKeyReady
+ * @brief 1 if histogramKey was created (otherwise sets are simply kept until exit).
+ */
+static int histogramKeyReady = 0;
+
+/**
+ * @var histogramKeyOnce
+ * @brief Creates histogramKey on the first registration.
+ */
+static pthread_once_t histogramKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @var statOpNames
+ * @brief Display names, indexed by StatOp.
+ */
+static const char *const statOpNames[STAT_OP_COUNT] = {
+    "addFlight", "searchFlight", "deleteFlight", "sortFlights", "queryFlights", "setFlightStatus",
+    "addPassenger", "removePassenger", "bookTicket", "cancelTicket",
+    "loadFlights", "loadPassengers", "loadTickets",
+    "saveFlights", "savePassengers", "saveTickets"
+};
+
+/**
+ * @brief Maps a latency to its bucket index.
+ *
+ * @param nanos The latency in nanoseconds.
+ * @return The bucket index (0 to STAT_BUCKETS - 1).
+ */
+static int bucketIndex(long long nanos) {
+    const unsigned long long subBuckets = 1ULL << STAT_SUB_BUCKET_BITS;
+    unsigned long long value = nanos > 0 ? (unsigned long long)nanos : 0;
+    if (value < subBuckets) {
+        return (int)value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > STAT_MAX_EXPONENT) {
+        return STAT_BUCKETS - 1;
+    }
+    int mantissa = (int)(value >> (exponent - STAT_SUB_BUCKET_BITS)); // In [subBuckets, 2 * subBuckets)
+    return ((exponent - STAT_SUB_BUCKET_BITS + 1) << STAT_SUB_BUCKET_BITS) + mantissa - (int)subBuckets;
+}
+
+/**
+ * @brief Returns the largest latency that maps to a bucket.
+ *
+ * @param index The bucket index.
+ * @return The bucket's inclusive upper bound in nanoseconds.
+ */
+static long long bucketUpperBound(int index) {
+    const int subBuckets = 1 << STAT_SUB_BUCKET_BITS;
+    if (index < subBuckets) {
+        return index;
+    }
+    int exponent = (index >> STAT_SUB_BUCKET_BITS) + STAT_SUB_BUCKET_BITS - 1;
+    long long mantissa = subBuckets + (index & (subBuckets - 1));
+    return ((mantissa + 1) << (exponent - STAT_SUB_BUCKET_BITS)) - 1;
+}
+
+/**
+ * @brief Retires an exiting thread's set: adds its counts to retiredBuckets, unlinks and frees it.
+ *
+ * @param arg The ThreadHistograms of the exiting thread.
+ */
+static void retireHistograms(void *arg) {
+    ThreadHistograms *h = (ThreadHistograms *)arg;
+    pthread_mutex_lock(&registryLock);
+    for (int op = 0; op < STAT_OP_COUNT; op++) {
+        for (int i = 0; i < STAT_BUCKETS; i++) {
+            retiredBuckets[op][i] += h->buckets[op][i];
+        }
+    }
+    ThreadHistograms **link = &registeredHistograms;
+    while (*link != NULL && *link != h) {
+        link = &(*link)->next;
+    }
+    if (*link != NULL) {
+        *link = h->next;
+    }
+    pthread_mutex_unlock(&registryLock);
+    localHistograms = NULL; // The destructor runs on the exiting thread
+    free(h);
+}
+
+/**
+ * @brief Creates histogramKey (run once through pthread_once).
+ */
+static void createHistogramKey() {
+    histogramKeyReady = pthread_key_create(&histogramKey, retireHistograms) == 0;
+}
+
+/**
+ * @brief Records one operation's latency in the calling thread's histogram.
+ *
+ * @param op The operation.
+ * @param nanos The latency in nanoseconds.
+ */
+void recordLatency(StatOp op, long long nanos) {
+    if (op < 0 || op >= STAT_OP_COUNT) {
+        return;
+    }
+    ThreadHistograms *h = localHistograms;
+    if (h == NULL) {
+        h = (ThreadHistograms *)calloc(1, sizeof(ThreadHistograms));
+        if (h == NULL) {
+            return; // Statistics are best effort
+        }
+        pthread_mutex_lock(&registryLock);
+        h->next = registeredHistograms;
+        __atomic_store_n(&registeredHistograms, h, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&registryLock);
+        localHistograms = h;
+        pthread_once(&histogramKeyOnce, createHistogramKey);
+        if (histogramKeyReady) {
+            pthread_setspecific(histogramKey, h); // Retired by retireHistograms when the thread exits
+        }
+    }
+
+    // Single writer: a relaxed load/store pair is enough and avoids a locked add
+    long long *bucket = &h->buckets[op][bucketIndex(nanos)];
+    __atomic_store_n(bucket, __atomic_load_n(bucket, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Computes percentiles from bucket counts.
+ *
+ * @param buckets STAT_BUCKETS counts.
+ * @param summary Receives the counts and percentiles.
+ * @return 1 if there is at least one value, 0 otherwise.
+ */
+static int summarizeBuckets(const long long *buckets, LatencySummary *summary) {
+    summary->count = summary->p50 = summary->p90 = summary->p99 = summary->p999 = summary->max = 0;
+    long long total = 0;
+    for (int i = 0; i < STAT_BUCKETS; i++) {
+        total += buckets[i];
+    }
+    if (total > 0) {
+        // Rank of each percentile (1-based, rounded up)
+        const long long ranks[4] = { (total * 500 + 999) / 1000, (total * 900 + 999) / 1000,
+                                     (total * 990 + 999) / 1000, (total * 999 + 999) / 1000 };
+        long long *targets[4] = { &summary->p50, &summary->p90, &summary->p99, &summary->p999 };
+        long long seen = 0;
+        int next = 0;
+        for (int i = 0; i < STAT_BUCKETS; i++) {
+            if (buckets[i] == 0) {
+                continue;
+            }
+            seen += buckets[i];
+            while (next < 4 && seen >= ranks[next]) {
+                *targets[next++] = bucketUpperBound(i);
+            }
+            summary->max = bucketUpperBound(i);
+        }
+    }
+    summary->count = total;
+    return total > 0;
+}
+
+/**
+ * @brief Merges every thread's histogram of an operation and computes its percentiles.
+ *
+ * @param op The operation.
+ * @param summary Receives the merged counts and percentiles.
+ * @return 1 if the operation was recorded at least once, 0 otherwise.
+ */
+int summarizeLatency(StatOp op, LatencySummary *summary) {
+    static long long merged[STAT_BUCKETS]; // Guarded by registryLock
+    if (op < 0 || op >= STAT_OP_COUNT) {
+        summary->count = summary->p50 = summary->p90 = summary->p99 = summary->p999 = summary->max = 0;
+        return 0;
+    }
+
+    pthread_mutex_lock(&registryLock);
+    for (int i = 0; i < STAT_BUCKETS; i++) {
+        merged[i] = retiredBuckets[op][i];
+    }
+    for (ThreadHistograms *h = __atomic_load_n(&registeredHistograms, __ATOMIC_ACQUIRE);
+         h != NULL; h = h->next) {
+        for (int i = 0; i < STAT_BUCKETS; i++) {
+            merged[i] += __atomic_load_n(&h->buckets[op][i], __ATOMIC_RELAXED);
+        }
+    }
+    int recorded = summarizeBuckets(merged, summary);
+    pthread_mutex_unlock(&registryLock);
+    return recorded;
+}
+
+/**
+ * @brief Clears every thread's histograms.
+ *
+ * Counts recorded concurrently may survive the reset; call it while no other
+ * thread is recording for an exact restart.
+ */
+void resetLatencyStats() {
+    pthread_mutex_lock(&registryLock);
+    for (int op = 0; op < STAT_OP_COUNT; op++) {
+        for (int i = 0; i < STAT_BUCKETS; i++) {
+            retiredBuckets[op][i] = 0;
+        }
+    }
+    for (ThreadHistograms *h = __atomic_load_n(&registeredHistograms, __ATOMIC_ACQUIRE);
+         h != NULL; h = h->next) {
+        for (int op = 0; op < STAT_OP_COUNT; op++) {
+            for (int i = 0; i < STAT_BUCKETS; i++) {
+                __atomic_store_n(&h->buckets[op][i], 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    pthread_mutex_unlock(&registryLock);
+}
+
+/**
+ * @brief Adds one latency to a standalone histogram (not thread-safe).
+ *
+ * @param histogram The histogram.
+ * @param nanos The latency in nanoseconds.
+ */
+void histogramRecord(LatencyHistogram *histogram, long long nanos) {
+    histogram->buckets[bucketIndex(nanos)]++;
+}
+
+/**
+ * @brief Adds every count of one histogram into another.
+ *
+ * @param into The histogram receiving the counts.
+ * @param from The histogram to add.
+ */
+void histogramMerge(LatencyHistogram *into, const LatencyHistogram *from) {
+    for (int i = 0; i < STAT_BUCKETS; i++) {
+        into->buckets[i] += from->buckets[i];
+    }
+}
+
+/**
+ * @brief Computes count and percentiles of a standalone histogram.
+ *
+ * @param histogram The histogram.
+ * @param summary Receives the counts and percentiles.
+ * @return 1 if the histogram holds at least one value, 0 otherwise.
+ */
+int histogramSummarize(const LatencyHistogram *histogram, LatencySummary *summary) {
+    return summarizeBuckets(histogram->buckets, summary);
+}
+
+/**
+ * @brief Returns the display name of an operation.
+ *
+ * @param op The operation.
+ * @return A constant string such as "bookTicket".
+ */
+const char *statOpName(StatOp op) {
+    if (op < 0 || op >= STAT_OP_COUNT) {
+        return "unknown";
+    }
+    return statOpNames[op];
+}
+
+/**
+ * @brief Formats a latency with a readable unit (ns, us, ms or s).
+ *
+ * @param nanos The latency in nanoseconds.
+ * @param out Receives the text.
+ * @param size The size of out.
+ */
+static void formatLatency(long long nanos, char *out, size_t size) {
+    if (nanos < 1000) {
+        snprintf(out, size, "%lldns", nanos);
+    } else if (nanos < 1000000) {
+        snprintf(out, size, "%.1fus", nanos / 1e3);
+    } else if (nanos < 1000000000) {
+        snprintf(out, size, "%.1fms", nanos / 1e6);
+    } else {
+        snprintf(out, size, "%.2fs", nanos / 1e9);
+    }
+}
+
+/**
+ * @brief Prints count and p50/p90/p99/p999 for every recorded operation.
+ *
+ * @return 1 on success, 0 if nothing has been recorded yet.
+ */
+int printLatencyStats() {
+    int printed = 0;
+    for (int op = 0; op < STAT_OP_COUNT; op++) {
+        LatencySummary s;
+        if (!summarizeLatency((StatOp)op, &s)) {
+            continue;
+        }
+        if (!printed) {
+            printf("\n---- Operation Latency Statistics ----\n");
+            printf("%-16s %10s %10s %10s %10s %10s %10s\n",
+                   "Operation", "Count", "p50", "p90", "p99", "p999", "max");
+            printed = 1;
+        }
+        char p50[24], p90[24], p99[24], p999[24], max[24];
+        formatLatency(s.p50, p50, sizeof(p50));
+        formatLatency(s.p90, p90, sizeof(p90));
+        formatLatency(s.p99, p99, sizeof(p99));
+        formatLatency(s.p999, p999, sizeof(p999));
+        formatLatency(s.max, max, sizeof(max));
+        printf("%-16s %10lld %10s %10s %10s %10s %10s\n",
+               statOpName((StatOp)op), s.count, p50, p90, p99, p999, max);
+    }
+    if (!printed) {
+        printf("No operations recorded yet.\n");
+    }
+    fflush(stdout); // Flush output
+    return printed;
+}
@@ -10,10 +10,24 @@
 
 #include "common.h" // MUST BE FIRST for shared macros/definitions
 #include <stdio.h>
-#include <stdlib.h> // For malloc, realloc, free
+#include <stdlib.h> // For atoi
 #include <string.h>
 
+#if !defined(_WIN32)
+#include <fcntl.h>    // For open
+#include <sys/file.h> // For flock
+#include <unistd.h>   // For ftruncate, close
+#endif
+
 #include "ticket.h"
+#include "stats.h"
+#include "timing.h"
+#include "trace.h"
+#include "memstats.h"
+#include "session.h"
+#include "render.h"
+#include "bloom.h"
+#include "page.h"
 
 /**
  * @brief Clears the input buffer.
@@ -42,6 +56,103 @@ int globalTicketCount = 0;
  * @brief Maximum capacity of the globalTickets array before reallocation is needed.
  */
 int globalTicketCapacity = 0;
+/**
+ * @var ticketTableVersion
+ * @brief Incremented whenever tickets are issued, revoked or reloaded.
+ */
+unsigned long ticketTableVersion = 0;
+
+/**
+ * @var boundFlights
+ * @brief Pointer to the caller's Flight array pointer, or NULL if no inventory is bound.
+ */
+static Flight **boundFlights = NULL;
+/**
+ * @var boundFlightCount
+ * @brief Pointer to the caller's flight count, or NULL if no inventory is bound.
+ */
+static int *boundFlightCount = NULL;
+/**
+ * @var boundShared
+ * @brief Attached shared inventory used for seat claims, or NULL for the local table.
+ */
+static SharedInventory *boundShared = NULL;
+/**
+ * @var nextTicketID
+ * @brief ID handed to the next booked ticket; kept above every loaded ID so IDs stay unique after cancellations.
+ */
+static int nextTicketID = 1;
+/**
+ * @var sharedBooked
+ * @brief IDs of the tickets this process booked since it loaded tickets.txt (shared inventory only).
+ */
+static int *sharedBooked = NULL;
+static int sharedBookedCount = 0;    /**< Entries in sharedBooked. */
+static int sharedBookedCapacity = 0; /**< Allocated entries of sharedBooked. */
+/**
+ * @var sharedRevoked
+ * @brief IDs of the tickets this process cancelled since it loaded tickets.txt (shared inventory only).
+ */
+static int *sharedRevoked = NULL;
+static int sharedRevokedCount = 0;    /**< Entries in sharedRevoked. */
+static int sharedRevokedCapacity = 0; /**< Allocated entries of sharedRevoked. */
+
+/**
+ * @brief Binds the ticket system to the flight inventory it books against.
+ *
+ * @param flights A pointer to the caller's Flight array pointer (may be reallocated by loadFlights).
+ * @param flightCount A pointer to the caller's flight count.
+ * @param shared A pointer to an attached shared inventory, or NULL for a process-local inventory.
+ */
+void bindTicketInventory(Flight **flights, int *flightCount, SharedInventory *shared) {
+    boundFlights = flights;
+    boundFlightCount = flightCount;
+    boundShared = shared;
+    if (shared != NULL) {
+        seedInventoryTicketIDs(shared, nextTicketID); // Shared IDs start above every loaded ticket
+    }
+}
+
+/**
+ * @brief Remembers a ticket ID booked or cancelled by this process, for saveSharedTickets.
+ *
+ * @param ids A pointer to the ID array.
+ * @param count A pointer to its entry count.
+ * @param capacity A pointer to its allocated entry count.
+ * @param ticketID The ticket ID.
+ */
+static void rememberSharedChange(int **ids, int *count, int *capacity, int ticketID) {
+    if (*count == *capacity) {
+        int newCapacity = *capacity > 0 ? *capacity * 2 : 64;
+        int *grown = (int *)trackedRealloc(MEM_TICKETS, *ids, (size_t)newCapacity * sizeof(int));
+        if (grown == NULL) {
+            printf("Error: Could not remember ticket %d for the shared ticket file.\n", ticketID);
+            return;
+        }
+        *ids = grown;
+        *capacity = newCapacity;
+    }
+    (*ids)[(*count)++] = ticketID;
+}
+
+/**
+ * @brief Finds the flight a ticket books against in the bound inventory.
+ *
+ * @param flightID The ID of the flight.
+ * @return A pointer to the Flight (local or in the shared segment), or NULL if not found.
+ */
+static Flight *findBoundFlight(int flightID) {
+    if (boundShared != NULL) {
+        return inventoryFindFlight(boundShared, flightID);
+    }
+    for (int i = 0; i < *boundFlightCount; i++) {
+        Flight *f = *boundFlights + i;
+        if (f->flightID == flightID) {
+            return f;
+        }
+    }
+    return NULL;
+}
 
 /**
  * @brief Initializes the global ticket array by allocating initial memory.
@@ -52,7 +163,7 @@ int globalTicketCapacity = 0;
  * @return 1 on success, 0 on failure (e.g., memory allocation failed).
  */
 int initializeTickets() {
-    globalTickets = (Ticket *)malloc(INITIAL_TICKET_CAPACITY * sizeof(Ticket));
+    globalTickets = (Ticket *)trackedMalloc(MEM_TICKETS, INITIAL_TICKET_CAPACITY * sizeof(Ticket));
     if (globalTickets == NULL) {
         printf("Error: Could not allocate memory for tickets.\n");
         return 0; // Failure
@@ -63,36 +174,252 @@ int initializeTickets() {
 }
 
 /**
- * @brief Books a new ticket for a passenger on a specific flight and seat.
+ * @brief Finds the position of a ticket by its ID.
  *
- * This function prompts for passenger name, flight ID, and seat number.
- * It assigns a unique ticket ID and dynamically reallocates memory if needed.
+ * Unknown IDs are usually rejected by the ticket filter without a scan.
  *
- * @return 1 on success, 0 on failure (e.g., ticket limit reached, invalid input, memory reallocation failed).
+ * @param ticketID The ID of the ticket to look up.
+ * @return The index of the ticket in globalTickets, or -1 if not found.
  */
-int bookTicket() {
-    // Check if reallocation is needed
-    if (globalTicketCount >= globalTicketCapacity) {
-        int newCapacity = globalTicketCapacity * 2; // Double the capacity
-        Ticket *temp = (Ticket *)realloc(globalTickets, newCapacity * sizeof(Ticket));
-        if (temp == NULL) {
-            printf("Error: Could not reallocate memory for tickets.\n");
-            return 0; // Failure
+int findTicketIndex(int ticketID) {
+    if (!ticketMayExist(ticketID)) {
+        return -1;
+    }
+    for (int i = 0; i < globalTicketCount; i++) {
+        if ((globalTickets + i)->ticketID == ticketID) {
+            return i;
         }
-        globalTickets = temp;
-        globalTicketCapacity = newCapacity;
-        printf("Ticket list capacity increased to %d.\n", globalTicketCapacity);
     }
+    return -1;
+}
+
+/**
+ * @brief Makes room for more tickets, doubling the capacity as often as needed.
+ *
+ * @param extra The number of tickets about to be appended.
+ * @return 1 on success, 0 if memory reallocation failed.
+ */
+static int reserveTickets(int extra) {
+    if (globalTicketCount + extra <= globalTicketCapacity) {
+        return 1;
+    }
+    TRACE_SCOPE("bookTicket.grow");
+    int newCapacity = globalTicketCapacity > 0 ? globalTicketCapacity : INITIAL_TICKET_CAPACITY;
+    while (newCapacity < globalTicketCount + extra) {
+        newCapacity *= 2; // Double the capacity
+    }
+    Ticket *temp = (Ticket *)trackedRealloc(MEM_TICKETS, globalTickets, newCapacity * sizeof(Ticket));
+    if (temp == NULL) {
+        printf("Error: Could not reallocate memory for tickets.\n");
+        return 0; // Failure
+    }
+    globalTickets = temp;
+    globalTicketCapacity = newCapacity;
+    return 1;
+}
 
+/**
+ * @brief Records a ticket whose seat is already held (capacity must be reserved).
+ *
+ * @param passengerName The name of the passenger holding the ticket.
+ * @param flightID The ID of the flight.
+ * @param flight The flight the seat was claimed on, or NULL if no inventory is bound.
+ * @param seatNo The 1-based seat number.
+ * @return The new ticket ID.
+ */
+static int recordTicket(const char *passengerName, int flightID, Flight *flight, int seatNo) {
     Ticket *t = globalTickets + globalTicketCount; // Pointer to new ticket location
-    t->ticketID = globalTicketCount + 1; // Simple ID generation
+    if (boundShared != NULL) {
+        t->ticketID = takeInventoryTicketID(boundShared); // Unique across processes
+        inventorySetSeatOwner(boundShared, flight, seatNo, t->ticketID);
+        rememberSharedChange(&sharedBooked, &sharedBookedCount, &sharedBookedCapacity, t->ticketID);
+    } else {
+        t->ticketID = nextTicketID++;
+    }
+    strncpy(t->passengerName, passengerName, MAX_NAME_LEN - 1);
+    t->passengerName[MAX_NAME_LEN - 1] = '\0';
+    t->flightID = flightID;
+    t->seatNo = seatNo;
+
+    globalTicketCount++;
+    bloomTicketAdded(t->ticketID);
+    pageTicketAdded();
+    ticketTableVersion++;
+    return t->ticketID; // Success
+}
+
+/**
+ * @brief Claims the seat and appends the ticket (untimed body of issueTicket).
+ *
+ * @param passengerName The name of the passenger holding the ticket.
+ * @param flightID The ID of the flight to book on.
+ * @param seatNo The 1-based seat number to book.
+ * @return The new ticket ID on success, 0 on failure.
+ */
+static int appendTicket(const char *passengerName, int flightID, int seatNo) {
+    TRACE_SCOPE("bookTicket");
+    if (!reserveTickets(1)) {
+        return 0; // Failure
+    }
+
+    // Claim the seat atomically so concurrent front-ends cannot double book it
+    Flight *flight = NULL;
+    if (boundFlights != NULL) {
+        TRACE_SCOPE("bookTicket.claimSeat");
+        flight = findBoundFlight(flightID);
+        if (seatNo > MAX_PASSENGERS_PER_FLIGHT || !claimFlightSeat(flight, seatNo)) {
+            return 0; // Failure
+        }
+    }
+    return recordTicket(passengerName, flightID, flight, seatNo);
+}
+
+/**
+ * @brief Books a ticket without prompting.
+ *
+ * If an inventory is bound, the flight must exist and the seat is claimed
+ * atomically before the ticket is recorded.
+ *
+ * @param passengerName The name of the passenger holding the ticket.
+ * @param flightID The ID of the flight to book on.
+ * @param seatNo The 1-based seat number to book.
+ * @return The new ticket ID on success, 0 on failure (e.g., seat unavailable, memory reallocation failed).
+ */
+int issueTicket(const char *passengerName, int flightID, int seatNo) {
+    long long start = nowNanos();
+    int ticketID = appendTicket(passengerName, flightID, seatNo);
+    recordLatency(STAT_TICKET_BOOK, nowNanos() - start);
+    logSessionTicketBook(passengerName, flightID, seatNo, ticketID, start);
+    return ticketID;
+}
+
+/**
+ * @brief Books the same seat on several flights (the legs of one trip) without prompting, one ticket per flight.
+ *
+ * Room for every ticket is made before any seat is claimed, so once the
+ * seat is held on all flights the tickets are recorded without failing.
+ * Each ticket is logged to the session as its own booking; a call that
+ * fails changes nothing and is not logged.
+ *
+ * @param passengerName The name of the passenger holding the tickets.
+ * @param flightIDs The IDs of the flights.
+ * @param count The number of flights.
+ * @param seatNo The 1-based seat number to book.
+ * @param ticketIDs Receives the new ticket IDs, one per flight.
+ * @return count on success, 0 on failure (e.g., seat unavailable on a flight, memory reallocation failed).
+ */
+int issueLegTickets(const char *passengerName, const int *flightIDs, int count, int seatNo, int *ticketIDs) {
+    long long start = nowNanos();
+    if (count <= 0 || seatNo <= 0 || seatNo > MAX_PASSENGERS_PER_FLIGHT || !reserveTickets(count)) {
+        return 0; // Failure
+    }
+    Flight **legs = NULL;
+    if (boundFlights != NULL) {
+        legs = (Flight **)trackedMalloc(MEM_OTHER, (size_t)count * sizeof(Flight *));
+        if (legs == NULL) {
+            printf("Error: Could not allocate memory for the flights to book.\n");
+            return 0; // Failure
+        }
+        for (int i = 0; i < count; i++) {
+            legs[i] = findBoundFlight(flightIDs[i]);
+        }
+        if (!claimFlightSeats(legs, count, seatNo)) {
+            trackedFree(MEM_OTHER, legs);
+            recordLatency(STAT_TICKET_BOOK, nowNanos() - start);
+            return 0; // Failure: taken on some flight, none held
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        ticketIDs[i] = recordTicket(passengerName, flightIDs[i], legs != NULL ? legs[i] : NULL, seatNo);
+    }
+    trackedFree(MEM_OTHER, legs);
+    recordLatency(STAT_TICKET_BOOK, nowNanos() - start);
+    for (int i = 0; i < count; i++) {
+        logSessionTicketBook(passengerName, flightIDs[i], seatNo, ticketIDs[i], start);
+    }
+    return count;
+}
+
+/**
+ * @brief Cancels a ticket by its ID without prompting.
+ *
+ * If an inventory is bound, the seat is released back to the flight. With a
+ * shared inventory, another process may have cancelled its own copy of the
+ * ticket already (every process loads the same tickets.txt): the seat is
+ * then left to whoever holds it now, and only the stale copy is dropped.
+ *
+ * @param ticketID The ID of the ticket to cancel.
+ * @return 1 on success, 0 if the ticket was not found or was already cancelled by another process.
+ */
+int revokeTicket(int ticketID) {
+    long long start = nowNanos();
+    int foundIndex = findTicketIndex(ticketID);
+    int cancelled = foundIndex != -1;
+    if (foundIndex != -1) {
+        // Give the seat back to the inventory before the ticket disappears
+        if (boundFlights != NULL) {
+            const Ticket *t = globalTickets + foundIndex;
+            Flight *flight = findBoundFlight(t->flightID);
+            if (boundShared == NULL) {
+                releaseFlightSeat(flight, t->seatNo);
+            } else if (flight != NULL && !inventoryReleaseSeat(boundShared, flight, t->seatNo, ticketID)) {
+                cancelled = 0; // Stale copy: the seat is no longer this ticket's
+            }
+        }
+        if (boundShared != NULL) {
+            rememberSharedChange(&sharedRevoked, &sharedRevokedCount, &sharedRevokedCapacity, ticketID);
+        }
+
+        pageTicketRemoved(foundIndex);
+        // Shift elements to fill the gap (using pointer arithmetic)
+        for (int i = foundIndex; i < globalTicketCount - 1; i++) {
+            *(globalTickets + i) = *(globalTickets + i + 1);
+        }
+        globalTicketCount--;
+        bloomTicketRemoved();
+        ticketTableVersion++;
+    }
+    recordLatency(STAT_TICKET_CANCEL, nowNanos() - start);
+    logSessionID(SESSION_TICKET_CANCEL, ticketID, cancelled, start);
+    return cancelled;
+}
+
+/**
+ * @brief Counts the tickets booked on a flight.
+ *
+ * @param flightID The ID of the flight.
+ * @return The number of tickets whose flightID matches.
+ */
+int countFlightTickets(int flightID) {
+    int count = 0;
+    for (int i = 0; i < globalTicketCount; i++) {
+        if ((globalTickets + i)->flightID == flightID) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Books a new ticket for a passenger on a specific flight and seat.
+ *
+ * This function prompts for passenger name, flight ID, and seat number.
+ * It assigns a unique ticket ID and dynamically reallocates memory if needed.
+ * If an inventory is bound, the seat is claimed atomically on the flight.
+ *
+ * @return 1 on success, 0 on failure (e.g., invalid input, seat unavailable, memory reallocation failed).
+ */
+int bookTicket() {
+    char passengerName[MAX_NAME_LEN];
+    int flightID;
+    int seatNo;
 
     printf("Enter passenger name for ticket: ");
-    GET_STRING(t->passengerName, MAX_NAME_LEN);
+    GET_STRING(passengerName, MAX_NAME_LEN);
 
     printf("Enter flight ID for ticket: ");
     // Corner case: invalid integer input
-    if (scanf("%d", &t->flightID) != 1 || t->flightID <= 0) {
+    if (scanf("%d", &flightID) != 1 || flightID <= 0) {
         printf("Invalid Flight ID. Please enter a positive number.\n");
         clearInputBuffer();
         return 0; // Failure
@@ -101,18 +428,25 @@ int bookTicket() {
 
     printf("Enter seat number for ticket: ");
     // Corner case: invalid integer input or negative seat number
-    if (scanf("%d", &t->seatNo) != 1 || t->seatNo <= 0) {
+    if (scanf("%d", &seatNo) != 1 || seatNo <= 0) {
         printf("Invalid seat number. Please enter a positive number.\n");
         clearInputBuffer();
         return 0; // Failure
     }
     clearInputBuffer(); // Consume newline after scanf
 
-    // In a real system, you would check if the flight exists and if the seat is available
-    // For now, assume it's valid.
+    if (boundFlights != NULL && findBoundFlight(flightID) == NULL) {
+        printf("Flight ID %d does not exist.\n", flightID);
+        return 0; // Failure
+    }
 
-    globalTicketCount++;
-    printf("Ticket booked successfully. Ticket ID: %d\n", t->ticketID);
+    int ticketID = issueTicket(passengerName, flightID, seatNo);
+    if (ticketID == 0) {
+        printf("Seat %d on Flight %d is not available.\n", seatNo, flightID);
+        return 0; // Failure
+    }
+
+    printf("Ticket booked successfully. Ticket ID: %d\n", ticketID);
     return 1; // Success
 }
 
@@ -140,25 +474,16 @@ int cancelTicket() {
     }
     clearInputBuffer(); // Consume newline after scanf
 
-    int foundIndex = -1;
-    for (int i = 0; i < globalTicketCount; i++) {
-        if ((globalTickets + i)->ticketID == ticketID) {
-            foundIndex = i;
-            break;
+    int known = findTicketIndex(ticketID) != -1;
+    if (!revokeTicket(ticketID)) {
+        if (known) {
+            printf("Ticket ID %d was already cancelled by another process.\n", ticketID);
+        } else {
+            printf("Ticket ID %d not found.\n", ticketID);
         }
-    }
-
-    if (foundIndex == -1) {
-        printf("Ticket ID %d not found.\n", ticketID);
         return 0; // Failure
     }
 
-    // Shift elements to fill the gap (using pointer arithmetic)
-    for (int i = foundIndex; i < globalTicketCount - 1; i++) {
-        *(globalTickets + i) = *(globalTickets + i + 1);
-    }
-
-    globalTicketCount--;
     printf("Ticket ID %d cancelled successfully. Total tickets: %d\n", ticketID, globalTicketCount);
     return 1; // Success
 }
@@ -176,14 +501,7 @@ int showAllTickets() {
         return 0; // Failure
     }
 
-    printf("\n---- All Booked Tickets ----\n");
-    for (int i = 0; i < globalTicketCount; i++) {
-        Ticket *t = globalTickets + i; // Pointer arithmetic
-        printf("Ticket ID: %d | Passenger: %s | Flight ID: %d | Seat: %d\n",
-               t->ticketID, t->passengerName,
-               t->flightID, t->seatNo);
-    }
-    return 1; // Success
+    return renderTickets(stdout, RENDER_PLAIN, globalTickets, globalTicketCount);
 }
 
 /**
@@ -227,16 +545,21 @@ int seatManagement() {
  */
 void cleanupTickets() {
     if (globalTickets != NULL) {
-        free(globalTickets);
+        trackedFree(MEM_TICKETS, globalTickets);
         globalTickets = NULL;
         globalTicketCount = 0;
+        ticketTableVersion++;
         globalTicketCapacity = 0;
         printf("Ticket memory freed.\n");
     }
+    trackedFree(MEM_TICKETS, sharedBooked);
+    trackedFree(MEM_TICKETS, sharedRevoked);
+    sharedBooked = sharedRevoked = NULL;
+    sharedBookedCount = sharedBookedCapacity = sharedRevokedCount = sharedRevokedCapacity = 0;
 }
 
 /**
- * @brief Saves all ticket data to a specified file.
+ * @brief Saves all ticket data to a specified file (untimed body of saveTickets).
  *
  * This function writes the current state of all tickets to a text file.
  * Each ticket's data is written on a new line, with components separated by commas.
@@ -244,7 +567,8 @@ void cleanupTickets() {
  * @param filename The name of the file to save to.
  * @return 1 on success, 0 on failure (e.g., file cannot be opened).
  */
-int saveTickets(const char *filename) {
+static int writeTicketsFile(const char *filename) {
+    TRACE_SCOPE("saveTickets");
     FILE *fp = fopen(filename, "w");
     if (fp == NULL) {
         printf("Error: Could not open file %s for writing.\n", filename);
@@ -266,7 +590,154 @@ int saveTickets(const char *filename) {
 }
 
 /**
- * @brief Loads ticket data from a specified file.
+ * @brief Saves all ticket data to a specified file.
+ *
+ * Records the latency of the whole call under STAT_SAVE_TICKETS.
+ *
+ * @param filename The name of the file to save to.
+ * @return 1 on success, 0 on failure (e.g., file cannot be opened).
+ */
+int saveTickets(const char *filename) {
+    long long start = nowNanos();
+    int result = writeTicketsFile(filename);
+    recordLatency(STAT_SAVE_TICKETS, nowNanos() - start);
+    return result;
+}
+
+/**
+ * @brief Parses one "ticketID,passengerName,flightID,seatNo" line of a ticket file.
+ *
+ * @param line The line (modified by strtok).
+ * @param t Receives the ticket.
+ * @return 1 on success, 0 if a field is missing.
+ */
+static int parseTicketLine(char *line, Ticket *t) {
+    char *token;
+    char *rest = line;
+
+    // ticketID
+    token = strtok(rest, ",");
+    if (token == NULL) { printf("Error reading ticketID.\n"); return 0; }
+    t->ticketID = atoi(token);
+    rest = NULL; // For subsequent strtok calls on the same line
+
+    // passengerName
+    token = strtok(rest, ",");
+    if (token == NULL) { printf("Error reading passengerName.\n"); return 0; }
+    strncpy(t->passengerName, token, MAX_NAME_LEN - 1);
+    t->passengerName[MAX_NAME_LEN - 1] = '\0';
+
+    // flightID
+    token = strtok(rest, ",");
+    if (token == NULL) { printf("Error reading flightID.\n"); return 0; }
+    t->flightID = atoi(token);
+
+    // seatNo
+    token = strtok(rest, "\n"); // Read till newline
+    if (token == NULL) { printf("Error reading seatNo.\n"); return 0; }
+    t->seatNo = atoi(token);
+    return 1;
+}
+
+/**
+ * @brief Comparison function for qsort and bsearch over ticket IDs.
+ */
+static int compareTicketIDs(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Merges this process's bookings and cancellations into a ticket file other processes also save to.
+ *
+ * With a shared inventory every process holds only the tickets it loaded
+ * plus its own changes, so saving its whole table would drop the tickets
+ * other processes booked (whose seats stay claimed in the segment). Instead
+ * the file is locked and re-read, the tickets this process cancelled are
+ * taken out, the ones it booked are appended, and the result is written
+ * back before the lock is released.
+ *
+ * @param filename The name of the shared ticket file.
+ * @return 1 on success, 0 on failure (e.g., file cannot be opened or locked, memory allocation error).
+ */
+int saveSharedTickets(const char *filename) {
+#if defined(_WIN32)
+    return saveTickets(filename); // No advisory locks: fall back to a plain save
+#else
+    long long start = nowNanos();
+    int fd = open(filename, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || flock(fd, LOCK_EX) != 0) {
+        printf("Error: Could not open and lock %s for writing.\n", filename);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 0; // Failure
+    }
+    FILE *fp = fdopen(fd, "r+");
+    if (fp == NULL) {
+        printf("Error: Could not open file %s for writing.\n", filename);
+        close(fd);
+        return 0; // Failure
+    }
+
+    // Tickets on file now, then every ticket this process booked
+    int fileCount = 0;
+    if (fscanf(fp, "%d\n", &fileCount) != 1 || fileCount < 0) {
+        fileCount = 0; // New or empty file
+    }
+    Ticket *merged = (Ticket *)trackedMalloc(MEM_TICKETS,
+                                             ((size_t)fileCount + (size_t)sharedBookedCount + 1) * sizeof(Ticket));
+    if (merged == NULL) {
+        printf("Error: Could not allocate memory for merging tickets.\n");
+        fclose(fp); // Also releases the lock
+        return 0; // Failure
+    }
+    if (sharedRevokedCount > 1) {
+        qsort(sharedRevoked, (size_t)sharedRevokedCount, sizeof(int), compareTicketIDs);
+    }
+    int mergedCount = 0;
+    char line_buffer[256]; // Buffer to read each line
+    for (int i = 0; i < fileCount && fgets(line_buffer, sizeof(line_buffer), fp) != NULL; i++) {
+        Ticket *t = merged + mergedCount;
+        if (!parseTicketLine(line_buffer, t)) {
+            break;
+        }
+        if (sharedRevokedCount == 0 || bsearch(&t->ticketID, sharedRevoked, (size_t)sharedRevokedCount,
+                                               sizeof(int), compareTicketIDs) == NULL) {
+            mergedCount++; // Not cancelled here
+        }
+    }
+    for (int i = 0; i < sharedBookedCount; i++) {
+        int index = findTicketIndex(sharedBooked[i]);
+        if (index != -1) { // Booked and not cancelled again
+            merged[mergedCount++] = globalTickets[index];
+        }
+    }
+
+    rewind(fp);
+    int ok = ftruncate(fd, 0) == 0;
+    fprintf(fp, "%d\n", mergedCount);
+    for (int i = 0; i < mergedCount; i++) {
+        const Ticket *t = merged + i;
+        fprintf(fp, "%d,%s,%d,%d\n", t->ticketID, t->passengerName, t->flightID, t->seatNo);
+    }
+    ok = fflush(fp) == 0 && ok;
+    fclose(fp); // Also releases the lock
+    trackedFree(MEM_TICKETS, merged);
+    if (ok) {
+        sharedBookedCount = sharedRevokedCount = 0; // Saved; a second save must not apply them twice
+        printf("Tickets merged into %s successfully (%d on file).\n", filename, mergedCount);
+    } else {
+        printf("Error: Could not write %s.\n", filename);
+    }
+    recordLatency(STAT_SAVE_TICKETS, nowNanos() - start);
+    return ok;
+#endif
+}
+
+/**
+ * @brief Loads ticket data from a specified file (untimed body of loadTickets).
  *
  * This function reads ticket data from a text file and populates the
  * global ticket array. It reallocates memory as needed. It expects the first
@@ -275,11 +746,13 @@ int saveTickets(const char *filename) {
  * @param filename The name of the file to load from.
  * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
  */
-int loadTickets(const char *filename) {
+static int readTicketsFile(const char *filename) {
+    TRACE_SCOPE("loadTickets");
     FILE *fp = fopen(filename, "r");
     if (fp == NULL) {
         printf("No ticket data file found (%s). Starting with empty ticket list.\n", filename);
         globalTicketCount = 0; // Ensure count is zero if file doesn't exist
+        ticketTableVersion++;
         return 0; // Not a critical failure, just means no data to load
     }
 
@@ -293,10 +766,10 @@ int loadTickets(const char *filename) {
 
     // Reallocate memory for tickets if current capacity is insufficient
     if (globalTickets != NULL) {
-        free(globalTickets);
+        trackedFree(MEM_TICKETS, globalTickets);
         globalTickets = NULL; // Defensive programming
     }
-    globalTickets = (Ticket *)malloc(loadedCount * sizeof(Ticket));
+    globalTickets = (Ticket *)trackedMalloc(MEM_TICKETS, loadedCount * sizeof(Ticket));
     if (globalTickets == NULL) {
         printf("Error: Could not allocate memory for loading tickets.\n");
         fclose(fp);
@@ -305,39 +778,39 @@ int loadTickets(const char *filename) {
     globalTicketCapacity = loadedCount; // Set capacity to loaded count for now
 
     globalTicketCount = 0; // Reset count before loading
+    ticketTableVersion++;
 
+    TRACE_BEGIN("loadTickets.parse");
     char line_buffer[256]; // Buffer to read each line
     while (globalTicketCount < loadedCount && fgets(line_buffer, sizeof(line_buffer), fp) != NULL) {
         Ticket *t = globalTickets + globalTicketCount; // Pointer to current ticket location
-        char *token;
-        char *rest = line_buffer;
-
-        // ticketID
-        token = strtok(rest, ",");
-        if (token == NULL) { printf("Error reading ticketID.\n"); break; }
-        t->ticketID = atoi(token);
-        rest = NULL; // For subsequent strtok calls on the same line
-
-        // passengerName
-        token = strtok(rest, ",");
-        if (token == NULL) { printf("Error reading passengerName.\n"); break; }
-        strncpy(t->passengerName, token, MAX_NAME_LEN - 1);
-        t->passengerName[MAX_NAME_LEN - 1] = '\0';
-
-        // flightID
-        token = strtok(rest, ",");
-        if (token == NULL) { printf("Error reading flightID.\n"); break; }
-        t->flightID = atoi(token);
-
-        // seatNo
-        token = strtok(rest, "\n"); // Read till newline
-        if (token == NULL) { printf("Error reading seatNo.\n"); break; }
-        t->seatNo = atoi(token);
-
+        if (!parseTicketLine(line_buffer, t)) {
+            break;
+        }
+        if (t->ticketID >= nextTicketID) {
+            nextTicketID = t->ticketID + 1;
+        }
         globalTicketCount++;
     }
+    TRACE_END("loadTickets.parse");
+    rebuildTicketFilter();
 
     fclose(fp);
     printf("Loaded %d tickets from %s.\n", globalTicketCount, filename);
     return 1; // Success
+}
+
+/**
+ * @brief Loads ticket data from a specified file.
+ *
+ * Records the latency of the whole call under STAT_LOAD_TICKETS.
+ *
+ * @param filename The name of the file to load from.
+ * @return 1 on success, 0 on failure (e.g., file not found, read error, memory allocation error).
+ */
+int loadTickets(const char *filename) {
+    long long start = nowNanos();
+    int result = readTicketsFile(filename);
+    recordLatency(STAT_LOAD_TICKETS, nowNanos() - start);
+    return result;
 }
\ No newline at end of file
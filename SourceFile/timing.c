@@ -0,0 +1,39 @@
+/**
+ * @file timing.c
+ * @brief Implementation of the monotonic clock used by benchmarks and instrumentation.
+ *
+ * Uses QueryPerformanceCounter on Windows and clock_gettime(CLOCK_MONOTONIC)
+ * everywhere else.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "timing.h"
+
+/**
+ * @brief Reads a monotonic clock.
+ *
+ * @return The current reading in nanoseconds.
+ */
+long long nowNanos(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency; // Ticks per second, queried once
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (long long)(counter.QuadPart / frequency.QuadPart) * 1000000000LL +
+           (long long)(counter.QuadPart % frequency.QuadPart) * 1000000000LL / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
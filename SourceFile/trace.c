@@ -0,0 +1,227 @@
+/**
+ * @file trace.c
+ * @brief Implementation of hot-path tracing with Chrome Trace Event export.
+ *
+ * Each thread owns a ring of TRACE_RING_EVENTS events, allocated on its first
+ * event and registered once in a global list. Recording writes only to the
+ * thread's own ring. The write position is published with release ordering,
+ * so dumpTrace can snapshot rings of running threads; events overwritten while
+ * a dump is in progress may appear truncated, which Chrome tolerates. When a
+ * thread exits, a thread-specific key destructor moves its events into one
+ * retired ring shared by every exited thread and frees its ring, so
+ * short-lived threads (e.g., one per server connection) do not accumulate
+ * memory.
+ */
+
+#include "common.h" // MUST BE FIRST for shared macros/definitions
+#include <stdio.h>
+#include <stdlib.h> // For calloc, free
+#include <pthread.h>
+
+#include "trace.h"
+#include "timing.h"
+
+/**
+ * @struct TraceEvent
+ * @brief One begin or end event.
+ */
+typedef struct {
+    const char *name;   /**< Region name (string literal). */
+    long long nanos;    /**< Timestamp from nowNanos(). */
+    char phase;         /**< 'B' for begin, 'E' for end. */
+} TraceEvent;
+
+/**
+ * @struct TraceRing
+ * @brief One thread's event ring.
+ */
+typedef struct TraceRing {
+    TraceEvent events[TRACE_RING_EVENTS]; /**< Event storage. */
+    unsigned long long written;           /**< Total events ever written (position = written % size). */
+    int threadID;                         /**< Small sequential ID used as "tid" in the export. */
+    struct TraceRing *next;               /**< Next registered ring. */
+} TraceRing;
+
+/**
+ * @struct RetiredEvent
+ * @brief An event of a thread that has exited, with the ID of that thread.
+ */
+typedef struct {
+    TraceEvent event;   /**< The event. */
+    int threadID;       /**< The "tid" of the thread that recorded it. */
+} RetiredEvent;
+
+static _Thread_local TraceRing *localRing = NULL; /**< The calling thread's ring. */
+static TraceRing *registeredRings = NULL;         /**< Every running thread's ring. */
+static RetiredEvent *retiredEvents = NULL;        /**< The most recent TRACE_RING_EVENTS events of exited threads. */
+static unsigned long long retiredWritten = 0;     /**< Total events ever moved into retiredEvents. */
+static int nextThreadID = 1;                      /**< ID handed to the next registering thread. */
+static pthread_mutex_t ringLock = PTHREAD_MUTEX_INITIALIZER; /**< Guards registration, retirement and dumping. */
+static pthread_key_t ringKey;                     /**< Thread-specific key whose destructor retires a ring. */
+static int ringKeyReady = 0;                      /**< 1 if ringKey was created (otherwise rings are kept until exit). */
+static pthread_once_t ringKeyOnce = PTHREAD_ONCE_INIT; /**< Creates ringKey on the first registration. */
+
+/**
+ * @brief Retires an exiting thread's ring: moves its events into retiredEvents, unlinks and frees it.
+ *
+ * @param arg The TraceRing of the exiting thread.
+ */
+static void retireRing(void *arg) {
+    TraceRing *ring = (TraceRing *)arg;
+    pthread_mutex_lock(&ringLock);
+    if (retiredEvents == NULL) {
+        retiredEvents = (RetiredEvent *)calloc(TRACE_RING_EVENTS, sizeof(RetiredEvent)); // Events are dropped if NULL
+    }
+    unsigned long long written = ring->written;
+    unsigned long long first = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+    for (unsigned long long i = first; retiredEvents != NULL && i < written; i++) {
+        RetiredEvent *r = &retiredEvents[retiredWritten++ % TRACE_RING_EVENTS];
+        r->event = ring->events[i % TRACE_RING_EVENTS];
+        r->threadID = ring->threadID;
+    }
+    TraceRing **link = &registeredRings;
+    while (*link != NULL && *link != ring) {
+        link = &(*link)->next;
+    }
+    if (*link != NULL) {
+        *link = ring->next;
+    }
+    pthread_mutex_unlock(&ringLock);
+    localRing = NULL; // The destructor runs on the exiting thread
+    free(ring);
+}
+
+/**
+ * @brief Creates ringKey (run once through pthread_once).
+ */
+static void createRingKey() {
+    ringKeyReady = pthread_key_create(&ringKey, retireRing) == 0;
+}
+
+/**
+ * @brief Appends an event to the calling thread's ring, registering the ring on first use.
+ *
+ * @param name The region name.
+ * @param phase 'B' or 'E'.
+ */
+static void traceRecord(const char *name, char phase) {
+    TraceRing *ring = localRing;
+    if (ring == NULL) {
+        ring = (TraceRing *)calloc(1, sizeof(TraceRing));
+        if (ring == NULL) {
+            return; // Tracing is best effort
+        }
+        pthread_mutex_lock(&ringLock);
+        ring->threadID = nextThreadID++;
+        ring->next = registeredRings;
+        registeredRings = ring;
+        pthread_mutex_unlock(&ringLock);
+        localRing = ring;
+        pthread_once(&ringKeyOnce, createRingKey);
+        if (ringKeyReady) {
+            pthread_setspecific(ringKey, ring); // Retired by retireRing when the thread exits
+        }
+    }
+
+    unsigned long long position = ring->written;
+    TraceEvent *e = &ring->events[position % TRACE_RING_EVENTS];
+    e->name = name;
+    e->nanos = nowNanos();
+    e->phase = phase;
+    __atomic_store_n(&ring->written, position + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Records a begin event for the calling thread.
+ *
+ * @param name A string literal naming the traced region.
+ */
+void traceBegin(const char *name) {
+    traceRecord(name, 'B');
+}
+
+/**
+ * @brief Records an end event for the calling thread.
+ *
+ * @param name The same string literal passed to traceBegin.
+ */
+void traceEnd(const char *name) {
+    traceRecord(name, 'E');
+}
+
+/**
+ * @brief Cleanup handler closing a TRACE_SCOPE region when its variable goes out of scope.
+ *
+ * @param name A pointer to the scope variable holding the region name.
+ */
+void traceScopeEnd(const char *const *name) {
+    traceRecord(*name, 'E');
+}
+
+/**
+ * @brief Writes every thread's recorded events as Chrome Trace Event JSON.
+ *
+ * Timestamps are converted to microseconds relative to the oldest event kept.
+ *
+ * @param filename The file to write (e.g., "trace.json").
+ * @return 1 on success, 0 on failure (e.g., tracing not compiled in, file cannot be opened).
+ */
+int dumpTrace(const char *filename) {
+#ifndef ENABLE_TRACE
+    printf("Tracing is not compiled in (rebuild with -DENABLE_TRACE).\n");
+    (void)filename;
+    return 0;
+#else
+    FILE *fp = fopen(filename, "w");
+    if (fp == NULL) {
+        printf("Error: Could not open file %s for writing.\n", filename);
+        return 0;
+    }
+
+    pthread_mutex_lock(&ringLock);
+
+    // Oldest timestamp still held in any ring becomes time zero
+    long long origin = -1;
+    for (TraceRing *ring = registeredRings; ring != NULL; ring = ring->next) {
+        unsigned long long written = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+        unsigned long long first = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+        if (written > first) {
+            long long t = ring->events[first % TRACE_RING_EVENTS].nanos;
+            if (origin < 0 || t < origin) origin = t;
+        }
+    }
+    // The retired ring interleaves threads, so its oldest event may be anywhere in it
+    unsigned long long retiredFirst = retiredWritten > TRACE_RING_EVENTS ? retiredWritten - TRACE_RING_EVENTS : 0;
+    for (unsigned long long i = retiredFirst; i < retiredWritten; i++) {
+        long long t = retiredEvents[i % TRACE_RING_EVENTS].event.nanos;
+        if (origin < 0 || t < origin) origin = t;
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    long long total = 0;
+    for (TraceRing *ring = registeredRings; ring != NULL; ring = ring->next) {
+        unsigned long long written = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+        unsigned long long first = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+        for (unsigned long long i = first; i < written; i++) {
+            const TraceEvent *e = &ring->events[i % TRACE_RING_EVENTS];
+            fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"fms\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                    total > 0 ? ",\n" : "", e->name, e->phase, (e->nanos - origin) / 1000.0, ring->threadID);
+            total++;
+        }
+    }
+    for (unsigned long long i = retiredFirst; i < retiredWritten; i++) {
+        const RetiredEvent *r = &retiredEvents[i % TRACE_RING_EVENTS];
+        fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"fms\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                total > 0 ? ",\n" : "", r->event.name, r->event.phase, (r->event.nanos - origin) / 1000.0,
+                r->threadID);
+        total++;
+    }
+    fprintf(fp, "\n]}\n");
+
+    pthread_mutex_unlock(&ringLock);
+    fclose(fp);
+    printf("Wrote %lld trace events to %s.\n", total, filename);
+    fflush(stdout); // Flush output
+    return 1;
+#endif
+}